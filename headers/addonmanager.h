@@ -2,6 +2,7 @@
 #define _ADDONMANAGER_H_
 
 #include "gpaddon.h"
+#include "loopstats.h"
 
 #include <vector>
 
@@ -15,6 +16,7 @@ enum ADDON_PROCESS {
 struct AddonBlock {
     GPAddon * ptr;
     ADDON_PROCESS process;
+    LoopAddonStats * stats;     // nullptr unless loop stats are compiled in
 };
 
 class AddonManager {
@@ -6,6 +6,7 @@
 #include "BoardConfig.h"
 #include "enums.pb.h"
 #include "types.h"
+#include "peripheral_adc.h"
 
 #ifndef ANALOG_INPUT_ENABLED
 #define ANALOG_INPUT_ENABLED 0
@@ -99,33 +100,48 @@
 #define ANALOG_ERROR2 1000
 #endif
 
+// Use integer math for the stick pipeline; the RP2040 has no FPU
+#ifndef ANALOG_FIXED_POINT
+#define ANALOG_FIXED_POINT 1
+#endif
+
 // Analog Module Name
 #define AnalogName "Analog"
 
 #define ADC_COUNT 2
 
+#if ANALOG_FIXED_POINT
+// Fixed point: stick values, magnitude and deadzones are ADC codes x4096 (0xFFF000 full
+// scale) and the EMA state keeps 6 more fractional bits. Error rate is a Q16 coefficient,
+// the smoothing factor and deadzone reciprocal Q24.
+typedef int32_t analog_value_t;
+#else
+typedef float analog_value_t;
+#endif
+
 typedef struct
 {
     Pin_t x_pin;
     Pin_t y_pin;
     Pin_t x_pin_adc;
     Pin_t y_pin_adc;
-    float x_value;
-    float y_value;
+    analog_value_t x_value;
+    analog_value_t y_value;
     uint16_t x_center;
     uint16_t y_center;
-    float xy_magnitude;
-    float x_magnitude;
-    float y_magnitude;
+    analog_value_t xy_magnitude;
+    analog_value_t x_magnitude;
+    analog_value_t y_magnitude;
     InvertMode analog_invert;
     DpadMode analog_dpad;
-    float x_ema;
-    float y_ema;
+    analog_value_t x_ema;
+    analog_value_t y_ema;
     bool ema_option;
-    float ema_smoothing;
-    float error_rate;
-    float in_deadzone;
-    float out_deadzone;
+    analog_value_t ema_smoothing;
+    analog_value_t error_rate;
+    analog_value_t in_deadzone;
+    analog_value_t out_deadzone;
+    uint32_t deadzone_scale;
     bool auto_calibration;
     bool forced_circularity;
 } adc_instance;
@@ -140,12 +156,13 @@ public:
     virtual void reinit() {}
     virtual std::string name() { return AnalogName; }
 private:
-    float readPin(int stick_num, Pin_t pin, uint16_t center);
-    float emaCalculation(int stick_num, float ema_value, float ema_previous);
+    analog_value_t readPin(int stick_num, Pin_t pin, uint16_t center);
+    analog_value_t emaCalculation(int stick_num, analog_value_t ema_value, analog_value_t & ema_previous);
     uint16_t map(uint16_t x, uint16_t in_min, uint16_t in_max, uint16_t out_min, uint16_t out_max);
-    float magnitudeCalculation(int stick_num, adc_instance & adc_inst);
+    analog_value_t magnitudeCalculation(int stick_num, adc_instance & adc_inst);
     void radialDeadzone(int stick_num, adc_instance & adc_inst);
     adc_instance adc_pairs[ADC_COUNT];
+    PeripheralADC * adc;
 };
 
 #endif  // _Analog_H_
\ No newline at end of file
@@ -56,10 +56,10 @@ public:
     virtual std::string name() { return DRV8833RumbleName; }
 private:
     uint32_t pwmSetFreqDuty(uint slice, uint channel, uint32_t frequency, float duty);
-    bool compareRumbleState(Gamepad * gamepad);
-    void setRumbleState(Gamepad * gamepad);
+    bool compareRumbleState(const GamepadAuxHaptics & haptics);
+    void setRumbleState(const GamepadAuxHaptics & haptics);
     void disableMotors();
-    void enableMotors(Gamepad * gamepad);
+    void enableMotors(const GamepadAuxHaptics & haptics);
     uint8_t leftMotorPin;
     uint8_t rightMotorPin;
     uint8_t motorSleepPin;
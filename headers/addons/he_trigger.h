@@ -2,6 +2,7 @@
 #define _HE_Trigger_H
 
 #include "gpaddon.h"
+#include "peripheral_adc.h"
 
 #define HETRIGGER_COUNT 32
 
@@ -47,6 +48,11 @@
 #define HETRIGGER_SMOOTHING_FACTOR 5
 #endif
 
+// Mux channels sampled per loop, 0 = every channel each loop
+#ifndef HETRIGGER_MUX_CHANNELS_PER_LOOP
+#define HETRIGGER_MUX_CHANNELS_PER_LOOP 0
+#endif
+
 #ifndef HETRIGGER_DEFAULT_IDLE
 #define HETRIGGER_DEFAULT_IDLE 150
 #endif
@@ -548,6 +554,16 @@
 // HETrigger Module Name
 #define HETriggerAddonName "Hall Effect Trigger"
 
+// Gamepad state a trigger applies while active, resolved from its GpioAction at setup
+typedef struct {
+    uint32_t buttons;
+    uint8_t dpad;
+    uint16_t aux;
+    uint16_t GamepadState::* axis;
+    uint16_t axisValue;
+    GpioAction menuAction;
+} HETriggerAction;
+
 class HETriggerAddon : public GPAddon {
 public:
     virtual bool available();
@@ -558,13 +574,27 @@ public:
     virtual void reinit() {}
     virtual std::string name() { return HETriggerAddonName; }
 private:
+    void buildActionTable(const HETriggerOptions & options);
     void selectChannel(uint8_t channel);
+    void sampleChannel(const HETriggerOptions & options);
     uint16_t emaSmoothing(uint16_t value, uint16_t previous);
+    int muxChannels;
     int muxTotal;
     int selectPins;
     Pin_t muxPinArray[4];
+    int8_t muxInputArray[4];
     Pin_t selectPinArray[4];
-    Pin_t lastADCSelected;
+    uint32_t selectPinMask;
+    uint32_t selectPinValues[16];
+    PeripheralADC * adc;
+
+    HETriggerAction actionTable[HETRIGGER_COUNT];
+    uint32_t activeTriggers;
+
+    // Scan scheduling across loop iterations
+    int32_t scanChannelsPerLoop;
+    uint32_t scanChannel;
+    uint32_t scanMarker;
 
     uint16_t emaSmoothingReads[32];
     float emaSmoothingFactor;
@@ -106,15 +106,16 @@ public:
     } EncoderPinMap;
 
     typedef struct {
-        bool pinA = false;
-        bool pinB = false;
-        bool prevA = false;
-        bool prevB = false;
-        uint32_t updateTime = 0;
+        volatile int32_t count = 0;     // quadrature steps counted by the pin IRQ
+        volatile uint8_t levels = 0;    // A:B levels seen by the last pin IRQ
+        int32_t appliedCount = 0;       // steps already added to the encoder value
         uint32_t changeTime = 0;
-        uint8_t delay = 1;
     } EncoderPinState;
 private:
+    static RotaryEncoderInput * instance;
+    static void encoderIRQ();
+    uint8_t readLevels(uint8_t index, uint32_t pins);
+
     EncoderPinState encoderState[MAX_ENCODERS];
     int32_t encoderValues[MAX_ENCODERS];
     int32_t prevValues[MAX_ENCODERS];
@@ -28,6 +28,11 @@
 #define SNES_PAD_DATA_PIN -1
 #endif
 
+// Background reader poll interval, 0 bit-bangs the pad from process() instead
+#ifndef SNES_PAD_POLL_INTERVAL_US
+#define SNES_PAD_POLL_INTERVAL_US 1000
+#endif
+
 class SNESpadInput : public GPAddon {
 public:
     virtual bool available();
@@ -39,8 +44,6 @@ public:
     virtual std::string name() { return SNESpadName; }
 private:
     SNESpad * snes;
-    uint32_t uIntervalMS;
-    uint32_t nextTimer;
 
     bool buttonA = false;
     bool buttonB = false;
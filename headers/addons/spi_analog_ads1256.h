@@ -29,6 +29,18 @@
 #define SPI_ANALOG1256_SPEED 5000000
 #endif
 
+// Data rate of the stick (0-3) and trigger (4-5) channels
+#ifndef SPI_ANALOG1256_STICK_DRATE
+#define SPI_ANALOG1256_STICK_DRATE ADS1256_DRATE_30000SPS
+#endif
+
+#ifndef SPI_ANALOG1256_TRIGGER_DRATE
+#define SPI_ANALOG1256_TRIGGER_DRATE ADS1256_DRATE_30000SPS
+#endif
+
+// Readings are scaled by a 32.32 reciprocal of the AVDD reading, worked out once in setup()
+#define SPI_ANALOG1256_SCALE_SHIFT 32
+
 // Analog Module Name
 #define SPIAnalog1256Name "SPIAnalogADS1256"
 
@@ -42,14 +54,15 @@ public:
     virtual void reinit() {}
     virtual std::string name() { return SPIAnalog1256Name; }
 private:
-    uint8_t convert24to8bit(float voltage);
-    uint16_t convert24to16bit(float voltage);
+    uint8_t convert24to8bit(uint32_t code);
+    uint16_t convert24to16bit(uint32_t code);
 
     ADS1256 * ads;
-    float values[ADS1256_CHANNEL_COUNT]; // Cache for latest read values
     bool enableTriggers;
     uint8_t readChannelCount; // Number of channels to read from the ADC
-    float analogMax = ADS1256_MAX_3V;
+    uint32_t analogMaxCode;   // Reading at AVDD, the top of the axis range
+    uint64_t scale16;         // 0xFFFF / analogMaxCode, shifted up by SPI_ANALOG1256_SCALE_SHIFT
+    uint64_t scale8;          // 0xFF / analogMaxCode, shifted up by SPI_ANALOG1256_SCALE_SHIFT
 };
 
 #endif  // SPI_ANALOG_ADS1256_H_
@@ -7,6 +7,7 @@
 #include "gpaddon.h"
 #include "gamepad.h"
 #include "storagemanager.h"
+#include "pico/time.h"
 
 // TG16pad Module Name
 #define TG16padName "TG16pad"
@@ -36,18 +37,39 @@
 #define TG16_PAD_DATA_PIN3 -1
 #endif
 
+// Settle time between each OE/SELECT change and the following read
+#ifndef TG16_PAD_STEP_US
+#define TG16_PAD_STEP_US 1000
+#endif
+
+typedef enum {
+    TG16_READ_OE,
+    TG16_READ_SELECT_HIGH,
+    TG16_READ_FIRST,
+    TG16_READ_SECOND,
+} TG16ReadStep;
+
 class TG16padInput : public GPAddon {
 public:
     virtual bool available();
     virtual void setup();       // TG16pad Setup
     virtual void process();     // TG16pad Process
-    virtual void preprocess() {}
+    virtual void preprocess();  // TG16pad Pre-Process (steps the read when the timer isn't running)
     virtual void postprocess(bool sent) {}
     virtual void reinit() {}
     virtual std::string name() { return TG16padName; }
 private:
-    uint32_t uIntervalMS;
-    uint32_t nextTimer;
+    Pin_t oePin;
+    Pin_t selectPin;
+    Pin_t dataPins[4];
+
+    repeating_timer_t readTimer;
+    bool readTimerRunning;
+    absolute_time_t nextReadStep;   // polled fallback when no timer was available
+    TG16ReadStep readStep;
+    uint8_t readNibbles[3];
+    bool extraFrame;                // this OE cycle is a 6-button pad's III-VI frame
+    volatile uint16_t latestData;
 
     bool buttonI = false;
     bool buttonII = false;
@@ -64,7 +86,10 @@ private:
     uint16_t rightY = 0;
 
     uint16_t map(uint16_t x, uint16_t in_min, uint16_t in_max, uint16_t out_min, uint16_t out_max);
-    uint8_t readController();
+    static bool readTimerCallback(repeating_timer_t * rt);
+    void readStepController();
+    uint8_t readNibble();
+    void finishRead();
     void updateButtons(uint16_t data);
 };
 
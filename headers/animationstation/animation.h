@@ -5,11 +5,44 @@
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <math.h>
 #include "pico/stdlib.h"
 #include <vector>
 #include "NeoPico.h"
 #include <map>
 
+// Brightness scales are 8.8 fixed point so channels can be scaled without float math
+#define BRIGHTNESS_SCALE_SHIFT 8
+#define BRIGHTNESS_SCALE_ONE (1 << BRIGHTNESS_SCALE_SHIFT)
+
+// Gamma applied by brightness tables, 0 keeps the linear response
+#ifndef LED_BRIGHTNESS_GAMMA
+#define LED_BRIGHTNESS_GAMMA 0
+#endif
+
+inline uint16_t brightnessScale(float brightnessX) {
+  if (brightnessX <= 0.0F)
+    return 0;
+  if (brightnessX >= 1.0F)
+    return BRIGHTNESS_SCALE_ONE;
+  return (uint16_t)(brightnessX * BRIGHTNESS_SCALE_ONE + 0.5F);
+}
+
+// Channel value lookup for one brightness level, rebuilt only when the level changes
+struct BrightnessTable {
+  uint8_t level[256];
+
+  // Scale every channel value by numerator / 255
+  void setup(uint8_t numerator) {
+    for (uint32_t c = 0; c < 256; c++) {
+      uint32_t value = c;
+      if (LED_BRIGHTNESS_GAMMA > 0)
+        value = (uint32_t)(powf(c / 255.0F, (float)LED_BRIGHTNESS_GAMMA) * 255.0F + 0.5F);
+      level[c] = (value * numerator) / 255;
+    }
+  }
+};
+
 struct RGB {
   // defaults allows trivial constructor, avoiding compiler complaints and avoiding unnessecary initialization
   // animation always memsets the frame before use, to this is safe.
@@ -44,37 +77,44 @@ struct RGB {
   }
 
   inline uint32_t value(LEDFormat format, float brightnessX = 1.0F) const {
+    return scaledValue(format, brightnessScale(brightnessX));
+  }
+
+  // Pack for the LED chain with an 8.8 fixed point brightness (BRIGHTNESS_SCALE_ONE = full)
+  inline uint32_t scaledValue(LEDFormat format, uint16_t scale) const {
+    return pack(format, (r * scale) >> BRIGHTNESS_SCALE_SHIFT, (g * scale) >> BRIGHTNESS_SCALE_SHIFT,
+      (b * scale) >> BRIGHTNESS_SCALE_SHIFT, (w * scale) >> BRIGHTNESS_SCALE_SHIFT);
+  }
+
+  // Pack for the LED chain through a precomputed brightness table
+  inline uint32_t value(LEDFormat format, const BrightnessTable &table) const {
+    return pack(format, table.level[r], table.level[g], table.level[b], table.level[w]);
+  }
+
+private:
+  // Channels are already scaled, the grey check for the white channel uses the source color
+  inline uint32_t pack(LEDFormat format, uint8_t sr, uint8_t sg, uint8_t sb, uint8_t sw) const {
     switch (format) {
       case LED_FORMAT_GRB:
-        return ((uint32_t)(g * brightnessX) << 16)
-            | ((uint32_t)(r * brightnessX) << 8)
-            | (uint32_t)(b * brightnessX);
+        return ((uint32_t)sg << 16) | ((uint32_t)sr << 8) | (uint32_t)sb;
 
       case LED_FORMAT_RGB:
-        return ((uint32_t)(r * brightnessX) << 16)
-            | ((uint32_t)(g * brightnessX) << 8)
-            | (uint32_t)(b * brightnessX);
+        return ((uint32_t)sr << 16) | ((uint32_t)sg << 8) | (uint32_t)sb;
 
       case LED_FORMAT_GRBW:
       {
         if ((r == g) && (r == b))
-          return (uint32_t)(r * brightnessX);
+          return (uint32_t)sr;
 
-        return ((uint32_t)(g * brightnessX) << 24)
-            | ((uint32_t)(r * brightnessX) << 16)
-            | ((uint32_t)(b * brightnessX) << 8)
-            | (uint32_t)(w * brightnessX);
+        return ((uint32_t)sg << 24) | ((uint32_t)sr << 16) | ((uint32_t)sb << 8) | (uint32_t)sw;
       }
 
       case LED_FORMAT_RGBW:
       {
         if ((r == g) && (r == b))
-          return (uint32_t)(r * brightnessX);
+          return (uint32_t)sr;
 
-        return ((uint32_t)(r * brightnessX) << 24)
-            | ((uint32_t)(g * brightnessX) << 16)
-            | ((uint32_t)(b * brightnessX) << 8)
-            | (uint32_t)(w * brightnessX);
+        return ((uint32_t)sr << 24) | ((uint32_t)sg << 16) | ((uint32_t)sb << 8) | (uint32_t)sw;
       }
     }
 
@@ -111,13 +151,13 @@ inline const std::vector<RGB> colors {
 class Animation {
 public:
   Animation(PixelMatrix &matrix);
-  virtual void UpdatePixels(std::vector<Pixel> pixels);
+  virtual void UpdatePixels(uint32_t pressedMask);
   void ClearPixels();
   virtual ~Animation(){};
 
   static LEDFormat format;
 
-  bool notInFilter(Pixel pixel);
+  bool notInFilter(const Pixel &pixel) const;
   virtual bool Animate(RGB (&frame)[100]) = 0;
   void UpdateTime();
   void UpdatePresses(RGB (&frame)[100]);
@@ -132,11 +172,11 @@ public:
   RGB BlendColor(RGB start, RGB end, uint32_t frame);
 
 protected:
-/* We track both the full matrix as well as individual pixels here to support
+/* We track both the full matrix as well as the pressed buttons here to support
 button press changes. Rather than adjusting the matrix to represent a subset of pixels,
-we provide a subset of pixels to use as a filter. */
+we provide the pressed button masks to use as a filter. */
   PixelMatrix *matrix;
-  std::vector<Pixel> pixels;
+  uint32_t pressedMask = 0;
   bool filtered = false;
 
   // Color fade 
@@ -34,13 +34,13 @@ public:
     void ChangeAnimation(int changeSize);
     void ApplyBrightness(uint32_t *frameValue);
     uint16_t AdjustIndex(int changeSize);
-    void HandlePressed(std::vector<Pixel> pressed);
+    void HandlePressed(uint32_t pressedMask);
     void ClearPressed();
     void SetMode(uint8_t mode);
     void SetMatrix(PixelMatrix matrix);
     void ConfigureBrightness(uint8_t max, uint8_t steps);
-    float GetBrightnessX();
-    float GetLinkageModeOfBrightnessX();
+    uint16_t GetBrightnessScale();
+    const BrightnessTable & GetLinkageBrightnessTable() { return linkageBrightnessTable; }
     uint8_t GetBrightness();
     void SetBrightness(uint8_t brightness);
     void DecreaseBrightness();
@@ -53,7 +53,7 @@ public:
 private:
     Animation* baseAnimation;
     Animation* buttonAnimation;
-    std::vector<Pixel> lastPressed;
+    uint32_t lastPressed = 0;
     absolute_time_t nextChange;
     uint8_t effectCount;
     RGB frame[100];
@@ -69,10 +69,13 @@ private:
     bool alCustomLinkageModeFlag = false;
     uint8_t getBrightnessStepSize() { return (brightnessMax / brightnessSteps); }
     uint8_t getLinkageModeOfBrightnessStepSize() { return (255 / brightnessSteps); }
-    float linkageModeOfBrightnessX;
+    void SetBrightnessLevel(uint32_t level);
     uint8_t brightnessMax;
     uint8_t brightnessSteps;
-    float brightnessX;
+    uint8_t brightnessLevel;        // brightness as a fraction of 255
+    uint8_t linkageBrightnessLevel;
+    BrightnessTable brightnessTable;
+    BrightnessTable linkageBrightnessTable;
     PixelMatrix matrix;
 
     bool isEffectAvailable(AnimationEffects effect);
@@ -9,14 +9,13 @@
 class CustomThemePressed : public Animation {
 public:
   CustomThemePressed(PixelMatrix &matrix);
-  CustomThemePressed(PixelMatrix &matrix, std::vector<Pixel> &pixels);
-  ~CustomThemePressed() { pixels = nullptr; };
+  CustomThemePressed(PixelMatrix &matrix, uint32_t pressedMask);
+  ~CustomThemePressed() { };
   bool HasTheme();
   bool Animate(RGB (&frame)[100]);
   void ParameterUp() { }
   void ParameterDown() { }
 protected:
-  std::vector<Pixel> *pixels;
   RGB defaultColor = ColorBlack;
   std::map<uint32_t, RGB> theme;
 };
@@ -35,6 +35,7 @@ private:
     std::vector<GridButton> gridButtons;
     std::vector<GridPresetCell> presetBCells;
     std::map<uint32_t, std::vector<uint8_t>> leverPositions;
+    std::set<uint32_t> pixelMasks;
     absolute_time_t nextRunTime = nil_time;
     float globalPhase = 0.0f;
 
@@ -44,10 +45,10 @@ private:
     GridGradientSpeed resolveSpeed(int32_t value) const;
     uint32_t getIntervalMs(GridGradientSpeed speed) const;
     uint32_t getColumnDurationMs(GridGradientSpeed speed) const;
-    bool isMaskPressed(uint32_t mask, const std::set<uint32_t> &pressedMasks) const;
+    bool isMaskPressed(uint32_t mask, uint32_t pressedMask) const;
     RGB interpolate(const RGB &from, const RGB &to, float t) const;
     RGB columnColor(float t, const RGB &colorA, const RGB &colorB, const RGB &colorC, const RGB &colorD) const;
-    void renderCaseLeds(RGB (&frame)[100], const std::set<uint32_t> &pressedMasks, const RGB &caseNormal, const RGB &casePress);
+    void renderCaseLeds(RGB (&frame)[100], uint32_t pressedMask, const RGB &caseNormal, const RGB &casePress);
 };
 
 #endif
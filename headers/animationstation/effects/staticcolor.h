@@ -10,7 +10,7 @@
 class StaticColor : public Animation {
 public:
   StaticColor(PixelMatrix &matrix);
-  StaticColor(PixelMatrix &matrix, std::vector<Pixel> &pixels);
+  StaticColor(PixelMatrix &matrix, uint32_t pressedMask);
   ~StaticColor() { };
 
   bool Animate(RGB (&frame)[100]);
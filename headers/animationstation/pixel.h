@@ -22,10 +22,26 @@ struct PixelMatrix {
   PixelMatrix() { }
 
   std::vector<std::vector<Pixel>> pixels;
+  std::vector<Pixel> buttonPixels; // Flat list of the pixels bound to a button mask
+  uint32_t buttonMask = 0;         // Every mask with at least one pixel bound to it
   uint8_t ledsPerPixel;
   void setup(std::vector<std::vector<Pixel>> pixels, int ledsPerPixel = -1) {
     this->pixels = pixels;
     this->ledsPerPixel = ledsPerPixel;
+
+    buttonPixels.clear();
+    buttonMask = 0;
+    for (auto &col : this->pixels)
+      for (auto &pixel : col)
+        if (pixel.index != NO_PIXEL.index && pixel.mask != 0 && !pixel.positions.empty()) {
+          buttonPixels.push_back(pixel);
+          buttonMask |= pixel.mask;
+        }
+  }
+
+  // Pressed button masks that light at least one pixel
+  inline uint32_t getPressedMask(uint32_t buttonState) const {
+    return buttonState & buttonMask;
   }
 
   inline int getLedCount() {
@@ -7,6 +7,9 @@
 namespace ConfigUtils {
     void load(Config& config);
     bool save(Config& config);
+
+    // Persist the options hotkeys change as a small overlay on the last full save, falls back to a full save
+    bool saveHotOptions(Config& config);
     
     void initUnsetPropertiesWithDefaults(Config& config);
 
@@ -11,6 +11,8 @@ class GPGFX {
         GPGFX();
 
         void init(GPGFX_DisplayTypeOptions options);
+        // Render through a driver the caller created instead of the one for options.displayType
+        void init(GPGFX_DisplayTypeOptions options, GPGFX_DisplayBase* driver);
 
         GPGFX_DisplayTypeOptions getAvailableDisplay(GPGFX_DisplayType displayType);
 
@@ -21,6 +23,14 @@ class GPGFX {
         void render(uint8_t pages = 0);
         void resetPartialState() { this->displayDriver->resetPartialState(); }
 
+        // region methods, see GPGFX_DisplayBase
+        bool supportsRegions() { return this->displayDriver->supportsRegions(); }
+        void clearRegion(GPGFX_Rect region) { this->displayDriver->clearRegion(region); }
+        void setClip(GPGFX_Rect clip) { this->displayDriver->setClip(clip); }
+        void resetClip() { this->displayDriver->resetClip(); }
+        void resetBounds() { this->displayDriver->resetBounds(); }
+        GPGFX_Rect getBounds() { return this->displayDriver->getBounds(); }
+
         uint32_t getPixel(uint16_t x, uint16_t y);
         void drawPixel(uint16_t x, uint16_t y, uint32_t color);
         void drawText(uint16_t x, uint16_t y, std::string text, uint8_t invert = 0);
@@ -2,6 +2,7 @@
 #define _GPGFX_TYPES_H_
 
 #include <map>
+#include <stdint.h>
 #include "peripheral_i2c.h"
 #include "peripheral_spi.h"
 
@@ -34,6 +35,33 @@ typedef struct {
     uint16_t depth; // bits per pixel
 } GPGFX_DisplayMetrics;
 
+// Inclusive pixel rectangle, empty when right < left
+typedef struct {
+    int16_t left;
+    int16_t top;
+    int16_t right;
+    int16_t bottom;
+} GPGFX_Rect;
+
+static inline GPGFX_Rect gpgfxEmptyRect() { return {INT16_MAX, INT16_MAX, INT16_MIN, INT16_MIN}; }
+static inline bool gpgfxRectIsEmpty(const GPGFX_Rect& rect) { return (rect.right < rect.left) || (rect.bottom < rect.top); }
+
+static inline void gpgfxRectUnion(GPGFX_Rect& rect, const GPGFX_Rect& other) {
+    if (gpgfxRectIsEmpty(other)) return;
+    if (other.left < rect.left) rect.left = other.left;
+    if (other.top < rect.top) rect.top = other.top;
+    if (other.right > rect.right) rect.right = other.right;
+    if (other.bottom > rect.bottom) rect.bottom = other.bottom;
+}
+
+static inline bool gpgfxRectIntersects(const GPGFX_Rect& a, const GPGFX_Rect& b) {
+    return !gpgfxRectIsEmpty(a) && !gpgfxRectIsEmpty(b) && (a.left <= b.right) && (b.left <= a.right) && (a.top <= b.bottom) && (b.top <= a.bottom);
+}
+
+static inline bool gpgfxRectContains(const GPGFX_Rect& outer, const GPGFX_Rect& inner) {
+    return gpgfxRectIsEmpty(inner) || ((inner.left >= outer.left) && (inner.right <= outer.right) && (inner.top >= outer.top) && (inner.bottom <= outer.bottom));
+}
+
 typedef struct {
     GPGFX_DisplayType displayType;
     PeripheralI2C* i2c;
@@ -9,6 +9,7 @@
 class GPButton : public GPWidget {
     public:
         void draw();
+        void refresh();
         GPButton* setSize(uint16_t sizeX, uint16_t sizeY) { this->_sizeX = sizeX; this->_sizeY = sizeY; return this; }
         GPButton* setInputMask(int16_t inputMask) { this->_inputMask = inputMask; return this; }
         GPButton* setInputDirection(bool inputDirection) { this->_inputDirection = inputDirection; return this; }
@@ -27,6 +28,10 @@ class GPButton : public GPWidget {
         bool _inputDirection = false;
         GPElement _inputType = GP_ELEMENT_BTN_BUTTON;
         GPShape_Type _shape = GP_SHAPE_ELLIPSE;
+
+        // last input state read by refresh()
+        uint16_t _state = 0;
+        bool _turboState = false;
 };
 
 #endif
\ No newline at end of file
@@ -6,6 +6,7 @@
 class GPLabel : public GPWidget {
     public:
         void draw();
+        void refresh();
 
         void setWidth(uint16_t width) { this->_width = width; }
         uint16_t getWidth() { return this->_width; }
@@ -26,6 +27,9 @@ class GPLabel : public GPWidget {
         uint32_t _lastScrollTime = 0;
 
         std::string _delimiter = "";
+
+        // text drawn by the last refresh()
+        std::string _displayText = "";
 };
 
 #endif
\ No newline at end of file
@@ -6,10 +6,11 @@
 class GPLever : public GPWidget {
     public:
         void draw();
+        void refresh();
         void setRadius(uint16_t radius) { this->_radius = radius; }
         void setInputType(uint16_t inputType) { this->_inputType = inputType; }
-        void setShowCardinal(bool show) { this->_showCardinal = show; }
-        void setShowOrdinal(bool show) { this->_showOrdinal = show; }
+        void setShowCardinal(bool show) { this->_showCardinal = show; invalidate(); }
+        void setShowOrdinal(bool show) { this->_showOrdinal = show; invalidate(); }
         void setDirectionMasks(int32_t upMask, int32_t downMask, int32_t leftMask, int32_t rightMask);
     private:
         uint16_t _radius = 0;
@@ -20,6 +21,14 @@ class GPLever : public GPWidget {
         int32_t _downMask = -1;
         int32_t _leftMask = -1;
         int32_t _rightMask = -1;
+
+        // positions computed by refresh()
+        int _baseX = 0;
+        int _baseY = 0;
+        int _leverX = 0;
+        int _leverY = 0;
+        int _baseRadius = 0;
+        int _leverRadius = 0;
 };
 
 #endif
\ No newline at end of file
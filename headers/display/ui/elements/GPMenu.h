@@ -8,6 +8,7 @@
 class GPMenu : public GPShape {
     public:
         void draw();
+        void refresh() { invalidate(); }
         GPMenu* setMenuSize(uint16_t sizeX, uint16_t sizeY) { this->menuSizeX = sizeX; this->menuSizeY = sizeY; return this; }
 
         uint16_t getDataSize() { return this->menuEntryData->size(); };
@@ -16,9 +16,16 @@ class GPScreen : public GPWidget {
         virtual void shutdown() = 0;
     protected:
         virtual void drawScreen() = 0;
+
+        // Retained screens only redraw the widgets that were invalidated, plus whatever overlaps them.
+        // refreshScreen() returns whether the content drawn by drawScreen() changed.
+        void setRetained(bool retained) { this->retained = retained; this->fullRedraw = true; }
+        virtual bool refreshScreen() { return true; }
+
         GPWidget * addElement(GPWidget* element) {
             displayList.push_back(element);
             element->setID(displayList.size()-1);
+            fullRedraw = true;
             return element;
         }
         void clearElements() {
@@ -26,9 +33,17 @@ class GPScreen : public GPWidget {
                 delete (*it);
             }
             displayList.clear();
+            fullRedraw = true;
         }
     private:
         std::vector<GPWidget*> displayList;
+
+        bool retained = false;
+        bool fullRedraw = true;
+        GPGFX_Rect screenBounds = gpgfxEmptyRect();
+
+        void drawAll();
+        bool drawRegion(GPGFX_Rect region, bool screenChanged);
 };
 
 #endif
\ No newline at end of file
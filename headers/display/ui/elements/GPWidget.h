@@ -12,10 +12,21 @@ class GPWidget : public GPGFX_UI {
         virtual void draw() {}
         virtual int8_t update() { return 0; }
 
-        void setPosition(uint16_t x, uint16_t y) { this->x = x; this->y = y; }
+        // Called before every draw: read the widget's inputs and invalidate() it if what it draws changed
+        virtual void refresh() {}
 
-        void setStrokeColor(uint16_t color) { this->strokeColor = color; }
-        void setFillColor(uint16_t color) { this->fillColor = color; }
+        void invalidate() { this->_invalid = true; }
+        void validate() { this->_invalid = false; }
+        bool isInvalid() { return this->_invalid; }
+
+        // Area covered by everything this widget has drawn so far
+        GPGFX_Rect getBounds() { return this->_bounds; }
+        void addBounds(GPGFX_Rect bounds) { gpgfxRectUnion(this->_bounds, bounds); }
+
+        void setPosition(uint16_t x, uint16_t y) { this->x = x; this->y = y; invalidate(); }
+
+        void setStrokeColor(uint16_t color) { this->strokeColor = color; invalidate(); }
+        void setFillColor(uint16_t color) { this->fillColor = color; invalidate(); }
 
         void setID(uint16_t id) { this->_ID = id; }
         uint16_t getID() { return this->_ID; }
@@ -23,14 +34,14 @@ class GPWidget : public GPGFX_UI {
         void setPriority(uint16_t priority) { this->_priority = priority; }
         uint16_t getPriority() { return this->_priority; }
 
-        void setViewport(uint16_t top, uint16_t left, uint16_t bottom, uint16_t right) { this->_viewport.top = top; this->_viewport.left = left; this->_viewport.bottom = bottom; this->_viewport.right = right; }
-        void setViewport(GPViewport viewport) { this->_viewport = viewport; }
+        void setViewport(uint16_t top, uint16_t left, uint16_t bottom, uint16_t right) { this->_viewport.top = top; this->_viewport.left = left; this->_viewport.bottom = bottom; this->_viewport.right = right; invalidate(); }
+        void setViewport(GPViewport viewport) { this->_viewport = viewport; invalidate(); }
         GPViewport getViewport() { return this->_viewport; }
 
         double getScaleX() { return ((double)(this->getViewport().right - this->getViewport().left) / (double)(getRenderer()->getDriver()->getMetrics()->width)); }
         double getScaleY() { return ((double)(this->getViewport().bottom - this->getViewport().top) / (double)(getRenderer()->getDriver()->getMetrics()->height)); }
 
-        void setVisibility(bool visible) { this->_visibility = visible; }
+        void setVisibility(bool visible) { this->_visibility = visible; invalidate(); }
         bool getVisibility() { return this->_visibility; }
     protected:
         uint16_t x = 0;
@@ -41,6 +52,8 @@ class GPWidget : public GPGFX_UI {
         uint16_t _ID;
         uint16_t _priority = 0;
         bool _visibility = true;
+        bool _invalid = true;
+        GPGFX_Rect _bounds = gpgfxEmptyRect();
 
         GPViewport _viewport;
 };
@@ -118,6 +118,7 @@ class ButtonLayoutScreen : public GPScreen {
         void handleUSB(GPEvent* e);
     protected:
         virtual void drawScreen();
+        virtual bool refreshScreen();
     private:
         // new layout methods
         GPLever* addLever(uint16_t startX, uint16_t startY, uint16_t sizeX, uint16_t sizeY, uint16_t strokeColor, uint16_t fillColor, uint16_t inputType);
@@ -151,6 +152,11 @@ class ButtonLayoutScreen : public GPScreen {
         std::string statusBar;
         std::string footer;
 
+        // header and footer as last drawn
+        std::string drawnStatusBar;
+        std::string drawnFooter;
+        bool drawnBannerDisplay = false;
+
         bool isInputHistoryEnabled = false;
         uint16_t inputHistoryX = 0;
         uint16_t inputHistoryY = 0;
@@ -6,6 +6,7 @@
 #include "enums.pb.h"
 #include "animationstation.h"
 #include "eventmanager.h"
+#include "loopstats.h"
 
 #define INPUT_MODE_XINPUT_NAME "XInput"
 #define INPUT_MODE_SWITCH_NAME "Nintendo Switch"
@@ -71,6 +72,8 @@ class MainMenuScreen : public GPScreen {
         void selectTurboMode();
         int32_t currentTurboMode();
 
+        void showLoopStats();
+
         void updateMenuNavigation(GpioAction action);
         void updateEventMenuNavigation(GpioAction action);
         void chooseAndReturn();
@@ -158,6 +161,9 @@ class MainMenuScreen : public GPScreen {
             {"Profile",    NULL, &profilesMenu,  std::bind(&MainMenuScreen::modeValue, this), std::bind(&MainMenuScreen::testMenu, this)},
             /*{"Focus Mode", NULL, &focusModeMenu, std::bind(&MainMenuScreen::modeValue, this), std::bind(&MainMenuScreen::testMenu, this)},*/
             {"Turbo",      NULL, &turboModeMenu, std::bind(&MainMenuScreen::modeValue, this), std::bind(&MainMenuScreen::testMenu, this)},
+#if LOOP_STATS_ENABLED
+            {"Loop Stats", NULL, nullptr,        std::bind(&MainMenuScreen::modeValue, this), std::bind(&MainMenuScreen::showLoopStats, this)},
+#endif
             {"Exit",       NULL, &saveMenu,      std::bind(&MainMenuScreen::modeValue, this), std::bind(&MainMenuScreen::testMenu, this)},
         };
 
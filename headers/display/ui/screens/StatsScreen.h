@@ -2,6 +2,7 @@
 #define _STATSSCREEN_H_
 
 #include "GPGFX_UI_widgets.h"
+#include "loopstats.h"
 
 class StatsScreen : public GPScreen {
     public:
@@ -13,7 +14,12 @@ class StatsScreen : public GPScreen {
         virtual void shutdown();
     protected:
         virtual void drawScreen();
+        void showInfoPage();
+        void showLoopPage();
+        void updateLoopPage();
         uint16_t prevButtonState = 0;
+        bool loopPage = false;
+        absolute_time_t nextLoopRefresh = nil_time;
 
         GPLabel* header;
         GPLabel* version;
@@ -22,6 +28,7 @@ class StatsScreen : public GPScreen {
         GPLabel* boardType;
         GPLabel* arch;
         GPLabel* exit;
+        GPLabel* loopLines[LOOP_STAGE_POSTPROCESS + 1];
 };
 
 #endif
\ No newline at end of file
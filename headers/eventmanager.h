@@ -27,7 +27,7 @@
 class EventManager {
     public:
         typedef std::function<void(GPEvent* event)> EventFunction;
-        typedef std::pair<GPEventType, std::vector<EventFunction>> EventEntry;
+        typedef std::vector<EventFunction> EventHandlers;
 
         EventManager(EventManager const&) = delete;
         void operator=(EventManager const&)  = delete;
@@ -42,11 +42,13 @@ class EventManager {
 
         void registerEventHandler(GPEventType eventType, EventFunction handler);
         void unregisterEventHandler(GPEventType eventType, EventFunction handler);
-        void triggerEvent(GPEvent* event);
+        void triggerEvent(GPEvent* event);  // dispatches, then deletes the heap-allocated event
+        void triggerEvent(GPEvent& event);  // dispatches a caller-owned (e.g. stack) event, no allocation
     private:
         EventManager(){}
 
-        std::vector<EventEntry> eventList;
+        // handlers indexed directly by GPEventType
+        std::array<EventHandlers, _GPEventType_ARRAYSIZE> eventHandlers;
 };
 
 #endif
\ No newline at end of file
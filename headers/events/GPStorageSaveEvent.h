@@ -6,9 +6,10 @@
 class GPStorageSaveEvent : public GPEvent {
     public:
         GPStorageSaveEvent() {}
-        GPStorageSaveEvent(bool force, bool restart = false) {
+        GPStorageSaveEvent(bool force, bool restart = false, bool hotOptions = false) {
             this->forceSave = force;
             this->restartAfterSave = restart;
+            this->hotOptionsOnly = hotOptions;
         }
         virtual ~GPStorageSaveEvent() {}
 
@@ -16,6 +17,7 @@ class GPStorageSaveEvent : public GPEvent {
 
         bool forceSave = false;
         bool restartAfterSave = false;
+        bool hotOptionsOnly = false; // only hotkey driven options changed, see ConfigUtils::saveHotOptions
     private:
         GPEventType _eventType = GP_EVENT_STORAGE_SAVE;
 };
@@ -29,6 +29,39 @@ struct GamepadButtonMapping
 	const uint32_t buttonMask;
 };
 
+// Modifier bits carried alongside the button/dpad masks in the pin lookup table
+#define PIN_LOOKUP_FUNCTION      (1U << 0)
+#define PIN_LOOKUP_DPAD_MODE_DP  (1U << 1)
+#define PIN_LOOKUP_DPAD_MODE_LS  (1U << 2)
+#define PIN_LOOKUP_DPAD_MODE_RS  (1U << 3)
+#define PIN_LOOKUP_4_8_WAY_MODE  (1U << 4)
+#define PIN_LOOKUP_LS_X_NEG      (1U << 5)
+#define PIN_LOOKUP_LS_X_POS      (1U << 6)
+#define PIN_LOOKUP_LS_Y_NEG      (1U << 7)
+#define PIN_LOOKUP_LS_Y_POS      (1U << 8)
+#define PIN_LOOKUP_RS_X_NEG      (1U << 9)
+#define PIN_LOOKUP_RS_X_POS      (1U << 10)
+#define PIN_LOOKUP_RS_Y_NEG      (1U << 11)
+#define PIN_LOOKUP_RS_Y_POS      (1U << 12)
+
+// GPIO state is looked up one nibble at a time: 8 tables of 16 entries cover all bank 0 pins
+#define PIN_LOOKUP_BITS          4
+#define PIN_LOOKUP_ENTRIES       (1U << PIN_LOOKUP_BITS)
+#define PIN_LOOKUP_TABLES        ((NUM_BANK0_GPIOS + PIN_LOOKUP_BITS - 1) / PIN_LOOKUP_BITS)
+
+/**
+ * @brief Everything a group of GPIO pins contributes to the gamepad state.
+ *
+ * Entries are precompiled from the button mappings in setup(), so read() only
+ * has to OR one entry per nibble of GPIO state together.
+ */
+struct GamepadPinLookup
+{
+	uint32_t buttons;
+	uint16_t modifiers;
+	uint8_t dpad;
+};
+
 class Gamepad {
 public:
 	Gamepad();
@@ -139,56 +172,56 @@ public:
 	GamepadState state;
 	GamepadState turboState;
 	GamepadAuxState auxState;
-	GamepadButtonMapping *mapDpadUp;
-	GamepadButtonMapping *mapDpadDown;
-	GamepadButtonMapping *mapDpadLeft;
-	GamepadButtonMapping *mapDpadRight;
-	GamepadButtonMapping *mapButtonB1;
-	GamepadButtonMapping *mapButtonB2;
-	GamepadButtonMapping *mapButtonB3;
-	GamepadButtonMapping *mapButtonB4;
-	GamepadButtonMapping *mapButtonL1;
-	GamepadButtonMapping *mapButtonR1;
-	GamepadButtonMapping *mapButtonL2;
-	GamepadButtonMapping *mapButtonR2;
-	GamepadButtonMapping *mapButtonS1;
-	GamepadButtonMapping *mapButtonS2;
-	GamepadButtonMapping *mapButtonL3;
-	GamepadButtonMapping *mapButtonR3;
-	GamepadButtonMapping *mapButtonA1;
-	GamepadButtonMapping *mapButtonA2;
-	GamepadButtonMapping *mapButtonA3;
-	GamepadButtonMapping *mapButtonA4;
-	GamepadButtonMapping *mapButtonE1;
-	GamepadButtonMapping *mapButtonE2;
-	GamepadButtonMapping *mapButtonE3;
-	GamepadButtonMapping *mapButtonE4;
-	GamepadButtonMapping *mapButtonE5;
-	GamepadButtonMapping *mapButtonE6;
-	GamepadButtonMapping *mapButtonE7;
-	GamepadButtonMapping *mapButtonE8;
-	GamepadButtonMapping *mapButtonE9;
-	GamepadButtonMapping *mapButtonE10;
-	GamepadButtonMapping *mapButtonE11;
-	GamepadButtonMapping *mapButtonE12;
-	GamepadButtonMapping *mapButtonFn;
-	GamepadButtonMapping *mapButtonDP;
-	GamepadButtonMapping *mapButtonLS;
-	GamepadButtonMapping *mapButtonRS;
-	GamepadButtonMapping *mapDigitalUp;
-	GamepadButtonMapping *mapDigitalDown;
-	GamepadButtonMapping *mapDigitalLeft;
-	GamepadButtonMapping *mapDigitalRight;
-	GamepadButtonMapping *mapAnalogLSXNeg;
-	GamepadButtonMapping *mapAnalogLSXPos;
-	GamepadButtonMapping *mapAnalogLSYNeg;
-	GamepadButtonMapping *mapAnalogLSYPos;
-	GamepadButtonMapping *mapAnalogRSXNeg;
-	GamepadButtonMapping *mapAnalogRSXPos;
-	GamepadButtonMapping *mapAnalogRSYNeg;
-	GamepadButtonMapping *mapAnalogRSYPos;
-	GamepadButtonMapping *map48WayMode;
-	GamepadButtonMapping *mapFocusMode;
+	GamepadButtonMapping *mapDpadUp = nullptr;
+	GamepadButtonMapping *mapDpadDown = nullptr;
+	GamepadButtonMapping *mapDpadLeft = nullptr;
+	GamepadButtonMapping *mapDpadRight = nullptr;
+	GamepadButtonMapping *mapButtonB1 = nullptr;
+	GamepadButtonMapping *mapButtonB2 = nullptr;
+	GamepadButtonMapping *mapButtonB3 = nullptr;
+	GamepadButtonMapping *mapButtonB4 = nullptr;
+	GamepadButtonMapping *mapButtonL1 = nullptr;
+	GamepadButtonMapping *mapButtonR1 = nullptr;
+	GamepadButtonMapping *mapButtonL2 = nullptr;
+	GamepadButtonMapping *mapButtonR2 = nullptr;
+	GamepadButtonMapping *mapButtonS1 = nullptr;
+	GamepadButtonMapping *mapButtonS2 = nullptr;
+	GamepadButtonMapping *mapButtonL3 = nullptr;
+	GamepadButtonMapping *mapButtonR3 = nullptr;
+	GamepadButtonMapping *mapButtonA1 = nullptr;
+	GamepadButtonMapping *mapButtonA2 = nullptr;
+	GamepadButtonMapping *mapButtonA3 = nullptr;
+	GamepadButtonMapping *mapButtonA4 = nullptr;
+	GamepadButtonMapping *mapButtonE1 = nullptr;
+	GamepadButtonMapping *mapButtonE2 = nullptr;
+	GamepadButtonMapping *mapButtonE3 = nullptr;
+	GamepadButtonMapping *mapButtonE4 = nullptr;
+	GamepadButtonMapping *mapButtonE5 = nullptr;
+	GamepadButtonMapping *mapButtonE6 = nullptr;
+	GamepadButtonMapping *mapButtonE7 = nullptr;
+	GamepadButtonMapping *mapButtonE8 = nullptr;
+	GamepadButtonMapping *mapButtonE9 = nullptr;
+	GamepadButtonMapping *mapButtonE10 = nullptr;
+	GamepadButtonMapping *mapButtonE11 = nullptr;
+	GamepadButtonMapping *mapButtonE12 = nullptr;
+	GamepadButtonMapping *mapButtonFn = nullptr;
+	GamepadButtonMapping *mapButtonDP = nullptr;
+	GamepadButtonMapping *mapButtonLS = nullptr;
+	GamepadButtonMapping *mapButtonRS = nullptr;
+	GamepadButtonMapping *mapDigitalUp = nullptr;
+	GamepadButtonMapping *mapDigitalDown = nullptr;
+	GamepadButtonMapping *mapDigitalLeft = nullptr;
+	GamepadButtonMapping *mapDigitalRight = nullptr;
+	GamepadButtonMapping *mapAnalogLSXNeg = nullptr;
+	GamepadButtonMapping *mapAnalogLSXPos = nullptr;
+	GamepadButtonMapping *mapAnalogLSYNeg = nullptr;
+	GamepadButtonMapping *mapAnalogLSYPos = nullptr;
+	GamepadButtonMapping *mapAnalogRSXNeg = nullptr;
+	GamepadButtonMapping *mapAnalogRSXPos = nullptr;
+	GamepadButtonMapping *mapAnalogRSYNeg = nullptr;
+	GamepadButtonMapping *mapAnalogRSYPos = nullptr;
+	GamepadButtonMapping *map48WayMode = nullptr;
+	GamepadButtonMapping *mapFocusMode = nullptr;
 
 	// gamepad specific proxy of debounced buttons --- 1 = active (inverse of the raw GPIO)
 	// see GP2040::debounceGpioGetAll for details
@@ -208,12 +241,15 @@ public:
 
 private:
 	void processHotkeyAction(GamepadHotkey action);
+	void compilePinLookup();
 
 	GamepadOptions & options;
 	DpadMode activeDpadMode;
 	bool map48WayModeToggle;
 	const HotkeyOptions & hotkeyOptions;
 
+	GamepadPinLookup pinLookup[PIN_LOOKUP_TABLES][PIN_LOOKUP_ENTRIES];
+
 	HotkeyEntry hotkeys[16];
 	GamepadHotkey lastAction = HOTKEY_NONE;
 
@@ -0,0 +1,55 @@
+/*
+ * SPDX-License-Identifier: MIT
+ * SPDX-FileCopyrightText: Copyright (c) 2024 OpenStickCommunity (gp2040-ce.info)
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <string.h>
+#include <atomic>
+
+/**
+ * @brief Single-producer seqlock used to hand gamepad state from Core0 to Core1.
+ *
+ * The writer bumps the sequence to an odd value, copies the payload and bumps it
+ * back to even. Readers copy the payload and retry if the sequence was odd or
+ * changed underneath them, so a reader can never observe a half-written state.
+ * Only plain 32-bit loads/stores are used, which the M0+ performs atomically.
+ */
+template <typename T>
+class GamepadSnapshot {
+public:
+	GamepadSnapshot() : sequence(0), data() {}
+
+	// Must only ever be called from a single core
+	void publish(const T & value) {
+		uint32_t seq = sequence.load(std::memory_order_relaxed);
+		sequence.store(seq + 1, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_release);
+		memcpy(&data, &value, sizeof(T));
+		std::atomic_thread_fence(std::memory_order_release);
+		sequence.store(seq + 2, std::memory_order_relaxed);
+	}
+
+	// Returns the number of retries needed to obtain a consistent copy
+	uint32_t read(T & value) const {
+		uint32_t retries = 0;
+		uint32_t before;
+		uint32_t after;
+		while (true) {
+			before = sequence.load(std::memory_order_acquire);
+			if ((before & 1) == 0) {
+				memcpy(&value, &data, sizeof(T));
+				std::atomic_thread_fence(std::memory_order_acquire);
+				after = sequence.load(std::memory_order_relaxed);
+				if (before == after)
+					return retries;
+			}
+			retries++;
+		}
+	}
+private:
+	std::atomic<uint32_t> sequence;
+	T data;
+};
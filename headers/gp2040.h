@@ -22,13 +22,17 @@ public:
     ~GP2040(){}
     void setup();           // setup core0
     void run();             // loop core0
+    void runOnce();         // single iteration of the core0 loop
 private:
     Gamepad snapshot;
     AddonManager addons;
+    GamepadState processedState; // last state handed to Core1
     // GPIO debouncer
     void debounceGpioGetAll();
     Mask_t buttonGpios;
-    uint32_t gpioDebounceTime[NUM_BANK0_GPIOS];
+    Mask_t gpioDebounceActive;                    // pins that must be revisited on the next pass
+    uint32_t gpioDebounceTime[NUM_BANK0_GPIOS];   // microseconds, see debounceGpioGetAll
+    uint32_t gpioDebounceLevel[NUM_BANK0_GPIOS];  // integrator accumulator in microseconds
 
     struct RebootHotkeys {
         RebootHotkeys();
@@ -73,8 +77,8 @@ private:
     void deinitializeStandardGpio();
 
     // event handling checking
-    void checkRawState(GamepadState prevState, GamepadState currState);
-    void checkProcessedState(GamepadState prevState, GamepadState currState);
+    void checkRawState(const GamepadState& prevState, const GamepadState& currState);
+    void checkProcessedState(const GamepadState& prevState, const GamepadState& currState);
 
     // input mask, action
     std::map<uint32_t, int32_t> bootActions;
@@ -82,9 +86,13 @@ private:
     void checkSaveRebootState();
     bool saveRequested = false;
     bool forceSave = false;
+    bool saveHotOptionsOnly = false;
     bool saveSuccessful = false;
     void handleStorageSave(GPEvent* e);
 
+    void checkFlashCommit(bool inputChanged);
+    uint32_t lastInputChange = 0;           // ms since boot
+
     bool rebootRequested = false;
     void handleSystemReboot(GPEvent* e);
 
@@ -39,6 +39,8 @@ public:
     virtual const uint8_t * get_descriptor_device_qualifier_cb() = 0;
     virtual uint16_t GetJoystickMidValue() = 0;
     const usbd_class_driver_t * get_class_driver() { return &class_driver; }
+    // Route SOF interrupts to a handler; must be set before tud_init() picks up the class driver
+    void set_sof_callback(void (*sof)(uint8_t rhport, uint32_t frame_count)) { class_driver.sof = sof; }
     virtual USBListener * get_usb_auth_listener() = 0;
 protected:
     usbd_class_driver_t class_driver;
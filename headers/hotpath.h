@@ -0,0 +1,33 @@
+/*
+ * SPDX-License-Identifier: MIT
+ * SPDX-FileCopyrightText: Copyright (c) 2024 OpenStickCommunity (gp2040-ce.info)
+ */
+
+#ifndef _HOTPATH_H_
+#define _HOTPATH_H_
+
+#include "pico/platform.h"
+
+/**
+ * Placing the Core0 input loop in SRAM is opt-in: configure with GP2040_HOT_PATH_IN_RAM=ON
+ * (CMake variable or environment) to build with HOT_PATH_IN_RAM 1.
+ *
+ * Code in flash runs through the XIP cache, which is shared with Core1, so LED and display
+ * work can evict the loop and cost it cache misses at random points. Functions defined with
+ * HOT_PATH_FUNC are copied to SRAM at boot instead, trading RAM for a steadier loop time.
+ * Only code that runs on every Core0 iteration while playing belongs here: the loop itself,
+ * gamepad read/process, input add-on preprocess/process and the drivers' process().
+ *
+ * Build with LOOP_STATS_ENABLED to compare the XIP cache counters and loop timing of both.
+ */
+#ifndef HOT_PATH_IN_RAM
+#define HOT_PATH_IN_RAM 0
+#endif
+
+#if HOT_PATH_IN_RAM
+#define HOT_PATH_FUNC(func_name) __time_critical_func(func_name)
+#else
+#define HOT_PATH_FUNC(func_name) func_name
+#endif
+
+#endif
@@ -42,6 +42,15 @@ class GPGFX_DisplayBase : public I2CDeviceBase {
         virtual void drawBuffer(uint8_t *pBuffer, uint8_t pages) { drawBuffer(pBuffer); }
         virtual void resetPartialState() {}
 
+        // Region support for retained screens: drawing can be clipped to a rectangle and the
+        // driver reports the on-screen area touched since the last resetBounds()
+        virtual bool supportsRegions() { return false; }
+        virtual void clearRegion(GPGFX_Rect region) {}
+        virtual void setClip(GPGFX_Rect clip) {}
+        virtual void resetClip() {}
+        virtual void resetBounds() {}
+        virtual GPGFX_Rect getBounds() { return gpgfxEmptyRect(); }
+
         void setMetrics(GPGFX_DisplayMetrics* metrics) { this->_metrics = metrics; }
         GPGFX_DisplayMetrics* getMetrics() { return this->_metrics; }
 
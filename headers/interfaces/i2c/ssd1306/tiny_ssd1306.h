@@ -40,6 +40,16 @@ class GPGFX_TinySSD1306 : public GPGFX_DisplayBase {
         void drawBuffer(uint8_t *pBuffer, uint8_t pages);
         void resetPartialState() override { framePage = 0; }
 
+        // Forget what the panel is showing so the next renders resend every page in full
+        void invalidate();
+
+        bool supportsRegions() override { return true; }
+        void clearRegion(GPGFX_Rect region) override;
+        void setClip(GPGFX_Rect clip) override { this->clip = clip; this->clipEnabled = true; }
+        void resetClip() override { this->clipEnabled = false; }
+        void resetBounds() override { this->bounds = gpgfxEmptyRect(); }
+        GPGFX_Rect getBounds() override { return this->bounds; }
+
         bool isSH1106(int detectedDisplay);
 
         std::vector<uint8_t> getDeviceAddresses() const override {
@@ -99,11 +109,23 @@ class GPGFX_TinySSD1306 : public GPGFX_DisplayBase {
         uint8_t frameBuffer[MAX_SCREEN_SIZE];
         uint8_t framePage = 0;
 
+        // Last contents sent to the panel, drawBuffer() only transmits the columns that differ
+        uint8_t panelBuffer[MAX_SCREEN_SIZE];
+        // Bit per page whose panelBuffer copy matches the panel
+        uint8_t panelPages = 0;
+
+        GPGFX_Rect clip;
+        bool clipEnabled = false;
+        GPGFX_Rect bounds = gpgfxEmptyRect();
+
         uint8_t screenType;
         bool _isSPI = false;
         bool _isI2C = true;
 
         void rotatePoint(double cx, double cy, double &x, double &y, double angle);
+
+        void drawHorizontalLine(int16_t x1, int16_t x2, int16_t y, uint32_t color);
+        void fillPolygon(const int16_t* xVertices, const int16_t* yVertices, uint16_t count, uint32_t color);
 };
 
 #endif
@@ -0,0 +1,164 @@
+/*
+ * SPDX-License-Identifier: MIT
+ * SPDX-FileCopyrightText: Copyright (c) 2024 OpenStickCommunity (gp2040-ce.info)
+ */
+
+#ifndef _LOOPSTATS_H_
+#define _LOOPSTATS_H_
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include "hardware/timer.h"
+
+/**
+ * Loop timing is opt-in: define LOOP_STATS_ENABLED 1 in the board config to compile the
+ * timers in. When disabled every hook below folds away to nothing.
+ */
+#ifndef LOOP_STATS_ENABLED
+#define LOOP_STATS_ENABLED 0
+#endif
+
+// Clock the timers read, the host build swaps in a nanosecond one
+#ifndef LOOP_STATS_TIME
+#define LOOP_STATS_TIME time_us_32
+#endif
+
+// Number of most recent Core0 loop durations kept for inspection
+#ifndef LOOP_STATS_HISTORY
+#define LOOP_STATS_HISTORY 64
+#endif
+
+// Histogram: 8 exact microsecond buckets, then 4 buckets per power of two up to ~8ms
+#define LOOP_STATS_LINEAR_BUCKETS 8
+#define LOOP_STATS_BUCKETS 48
+
+typedef enum {
+	LOOP_STAGE_TOTAL,       // whole GP2040::runOnce
+	LOOP_STAGE_INPUT,       // debounce + gamepad read
+	LOOP_STAGE_PREPROCESS,  // add-on preprocess
+	LOOP_STAGE_PROCESS,     // hotkeys, gamepad process and add-on process
+	LOOP_STAGE_DRIVER,      // input driver report generation
+	LOOP_STAGE_USB,         // tud_task
+	LOOP_STAGE_POSTPROCESS, // add-on postprocess
+	LOOP_STAGE_CORE1,       // whole GP2040Aux loop iteration
+	LOOP_STAGE_COUNT
+} LoopStage;
+
+typedef enum {
+	LOOP_ADDON_PREPROCESS,
+	LOOP_ADDON_PROCESS,
+	LOOP_ADDON_POSTPROCESS,
+	LOOP_ADDON_COUNT
+} LoopAddonStage;
+
+/**
+ * @brief Running min/avg/max and a log-linear histogram of durations in microseconds.
+ *
+ * Percentiles are resolved to the upper edge of their histogram bucket, which keeps
+ * them within 25% of the true value while using a fixed amount of memory.
+ */
+class LoopStageStats {
+public:
+	LoopStageStats() { reset(); }
+	void reset();
+	void record(uint32_t duration);
+	uint32_t percentile(uint32_t pct) const;
+
+	uint32_t getCount() const { return count; }
+	uint32_t getMin() const { return count ? min : 0; }
+	uint32_t getMax() const { return max; }
+	uint32_t getAverage() const { return count ? (uint32_t)(total / count) : 0; }
+private:
+	uint32_t count;
+	uint32_t min;
+	uint32_t max;
+	uint64_t total;
+	uint32_t histogram[LOOP_STATS_BUCKETS];
+};
+
+struct LoopAddonStats {
+	std::string name;
+	uint8_t core;
+	LoopStageStats stages[LOOP_ADDON_COUNT];
+};
+
+class LoopStats {
+public:
+	LoopStats(LoopStats const&) = delete;
+	void operator=(LoopStats const&) = delete;
+	static LoopStats& getInstance() {
+		static LoopStats instance;
+		return instance;
+	}
+
+	static constexpr bool enabled() { return LOOP_STATS_ENABLED; }
+
+	// Current timestamp for the start of a measured section
+	static inline uint32_t now() {
+#if LOOP_STATS_ENABLED
+		return LOOP_STATS_TIME();
+#else
+		return 0;
+#endif
+	}
+
+	// Record the section started at `start` and return the current timestamp for the next one
+	inline uint32_t mark(LoopStage stage, uint32_t start) {
+#if LOOP_STATS_ENABLED
+		uint32_t end = LOOP_STATS_TIME();
+		stages[stage].record(end - start);
+		if (stage == LOOP_STAGE_TOTAL) {
+			history[historyIndex] = end - start;
+			historyIndex = (historyIndex + 1) % LOOP_STATS_HISTORY;
+			recordXipCache();
+		}
+		return end;
+#else
+		(void)stage;
+		(void)start;
+		return 0;
+#endif
+	}
+
+	static inline void mark(LoopAddonStats * addon, LoopAddonStage stage, uint32_t start) {
+#if LOOP_STATS_ENABLED
+		if (addon != nullptr)
+			addon->stages[stage].record(LOOP_STATS_TIME() - start);
+#else
+		(void)addon;
+		(void)stage;
+		(void)start;
+#endif
+	}
+
+	LoopAddonStats * registerAddon(const std::string & name);
+	void reset();
+
+	static const char * getStageName(LoopStage stage);
+	static const char * getAddonStageName(LoopAddonStage stage);
+	const LoopStageStats & getStage(LoopStage stage) const { return stages[stage]; }
+	const std::vector<LoopAddonStats*> & getAddons() const { return addons; }
+
+	// Copy the recent loop durations, oldest first; returns the number copied
+	uint32_t getHistory(uint32_t * out, uint32_t size) const;
+
+	// XIP (flash) cache counters, sampled once per Core0 loop. The cache is shared with Core1,
+	// so these cover both cores over the span of each loop.
+	const LoopStageStats & getXipMisses() const { return xipMisses; }
+	uint32_t getXipHitPermille() const;
+private:
+	LoopStats() : historyIndex(0), history(), xipHits(0), xipAccesses(0) {}
+	void recordXipCache();
+
+	LoopStageStats stages[LOOP_STAGE_COUNT];
+	std::vector<LoopAddonStats*> addons;
+	uint32_t historyIndex;
+	uint32_t history[LOOP_STATS_HISTORY];
+	LoopStageStats xipMisses;   // misses per loop
+	uint64_t xipHits;
+	uint64_t xipAccesses;
+};
+
+#endif
@@ -1,6 +1,7 @@
 #ifndef _PERIPHERALMANAGER_H_
 #define _PERIPHERALMANAGER_H_
 
+#include "peripheral_adc.h"
 #include "peripheral_i2c.h"
 #include "peripheral_spi.h"
 #include "peripheral_usb.h"
@@ -26,6 +27,7 @@ public:
     PeripheralI2C* getI2C(uint8_t block);
     PeripheralSPI* getSPI(uint8_t block);
     PeripheralUSB* getUSB(uint8_t block);
+    PeripheralADC* getADC() { return &blockADC; }
 
     void initUSB();
     void initI2C();
@@ -46,6 +48,8 @@ private:
     PeripheralSPI blockSPI1;
 
     PeripheralUSB blockUSB0;
+
+    PeripheralADC blockADC;
 };
 
 #endif
\ No newline at end of file
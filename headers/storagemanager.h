@@ -13,6 +13,7 @@
 #include "enums.h"
 #include "helper.h"
 #include "gamepad.h"
+#include "gamepad/GamepadSnapshot.h"
 
 #include "config.pb.h"
 #include <atomic>
@@ -49,6 +50,7 @@ public:
 	void init();
 	bool save();
 	bool save(const bool force);
+	bool saveHotOptions(const bool force);
 
 	void SetGamepad(Gamepad *); 		// MPGS Gamepad Get/Set
 	Gamepad * GetGamepad();
@@ -56,6 +58,13 @@ public:
 	void SetProcessedGamepad(Gamepad *); // MPGS Processed Gamepad Get/Set
 	Gamepad * GetProcessedGamepad();
 
+	// Core0 -> Core1 handoff of the processed gamepad. Core0 publishes once per loop and
+	// Core1 syncs once per loop, after which the processed gamepad state and
+	// GetProcessedAuxState() are a consistent (never torn) copy owned by Core1.
+	void PublishProcessedGamepad(const GamepadState & state);
+	void SyncProcessedGamepad();
+	const GamepadAuxState & GetProcessedAuxState() { return processedAuxState; }
+
 	bool setProfile(const uint32_t);		// profile support for multiple mappings
 	void nextProfile();
 	void previousProfile();
@@ -68,9 +77,13 @@ public:
 
 private:
 	Storage() {}
+	bool canSave(const bool force);
 	bool CONFIG_MODE = false; 			// Config mode (boot)
 	Gamepad * gamepad = nullptr;    		// Gamepad data
 	Gamepad * processedGamepad = nullptr; // Gamepad with ONLY processed data
+	GamepadSnapshot<GamepadState> processedStateSnapshot;
+	GamepadSnapshot<GamepadAuxState> processedAuxStateSnapshot;
+	GamepadAuxState processedAuxState;      // Core1 copy of the processed aux state
 	uint8_t featureData[32]; // USB X-Input Feature Data
 	Config config;
 	GpioMappingInfo functionalPinMappings[NUM_BANK0_GPIOS];
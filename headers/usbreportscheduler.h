@@ -0,0 +1,97 @@
+/*
+ * SPDX-License-Identifier: MIT
+ * SPDX-FileCopyrightText: Copyright (c) 2024 OpenStickCommunity (gp2040-ce.info)
+ */
+
+#ifndef _USBREPORTSCHEDULER_H_
+#define _USBREPORTSCHEDULER_H_
+
+#include <stdint.h>
+
+// Full-speed USB frame length
+#define USB_FRAME_US 1000
+
+// Completions needed before the poll model is trusted
+#define USB_SCHEDULER_MIN_SAMPLES 8
+
+// Lead time before the predicted IN token at which sampling starts, adapted at runtime
+#define USB_SCHEDULER_GUARD_START_US 250
+#define USB_SCHEDULER_GUARD_MIN_US 40
+#define USB_SCHEDULER_GUARD_MAX_US 800
+#define USB_SCHEDULER_GUARD_MISS_STEP_US 50
+#define USB_SCHEDULER_GUARD_DECAY_HITS 8
+
+// Longest Core0 will spin waiting for the send window; earlier than that the loop keeps running
+#define USB_SCHEDULER_MAX_SPIN_US 100
+
+/**
+ * @brief Aligns the Core0 input loop to the host's interrupt IN polling.
+ *
+ * Drivers arm their IN endpoint as soon as a report is ready, so input sampled just after
+ * a transfer waits for a whole polling interval. When enabled, the scheduler timestamps
+ * every SOF (via the class driver sof slot) and every completion of the report endpoint
+ * (via tud_event_hook_cb) to learn the host's polling interval and the phase of its IN token
+ * within the frame. Core0 then holds off building the report until shortly before the next
+ * predicted IN token, so the report the host picks up carries the freshest possible input.
+ * The rest of the loop keeps running meanwhile; Core0 only spins for the last stretch.
+ *
+ * The lead time adapts: a report that misses its predicted frame widens it, while reports
+ * that make it slowly tighten it again.
+ */
+class USBReportScheduler {
+public:
+	USBReportScheduler(USBReportScheduler const&) = delete;
+	void operator=(USBReportScheduler const&) = delete;
+	static USBReportScheduler& getInstance() {
+		static USBReportScheduler instance;
+		return instance;
+	}
+
+	void start(uint8_t rhport, const uint8_t * configuration);  // Core0, after tud_init
+	bool isEnabled() { return enabled; }
+	bool isSynced();                // enough samples and the bus is running
+	bool waitForSendWindow();       // Core0: true once it is time to sample and build the report
+	void reportQueued();            // Core0: the driver armed its IN endpoint
+	bool isReportPending();         // an armed report is still waiting for the host
+
+	// ISR context
+	static void sofCallback(uint8_t rhport, uint32_t frame_count);
+	void transferComplete();
+
+	uint32_t getPollInterval() { return pollInterval; }
+	uint32_t getPollPhase() { return pollPhase; }
+	uint32_t getGuard() { return guard; }
+	uint32_t getMisses() { return misses; }
+private:
+	USBReportScheduler();
+	void updateModel();
+	void readFrame(uint32_t & frame, uint32_t & time);
+
+	bool enabled;
+	uint8_t rhport;
+	uint8_t reportEndpoint;     // endpoint number the driver sends reports on
+
+	// written from the USB interrupt
+	volatile uint32_t sofCount;
+	volatile uint32_t sofTime;
+	volatile bool transferPending;
+	volatile bool transferDone;
+	volatile uint32_t completeFrame;
+	volatile uint32_t completePhase;
+
+	// poll model, Core0 only
+	uint32_t samples;
+	uint32_t pollInterval;      // frames between IN tokens
+	uint32_t pollPhase;         // microseconds from SOF to IN token
+	uint32_t lastPollFrame;
+	uint32_t intervalWindow;    // smallest completion spacing seen in the current window
+	uint32_t intervalSamples;
+	uint32_t targetFrame;       // frame the current window is aimed at
+	uint32_t servedFrame;       // last frame a window was opened for
+	uint32_t queuedTarget;      // frame the report in flight was aimed at
+	uint32_t guard;
+	uint32_t hits;              // reports on time since the guard last moved
+	uint32_t misses;
+};
+
+#endif
@@ -0,0 +1,159 @@
+/*
+ * SPDX-License-Identifier: MIT
+ * SPDX-FileCopyrightText: Copyright (c) 2024 OpenStickCommunity (gp2040-ce.info)
+ */
+
+// Replays recorded GPIO traces through GP2040::runOnce on the host and reports what each loop stage
+// costs on this machine, with the loop rate.
+//
+// usage: bench_input_replay [--step-us N] <trace or directory>...
+//
+// A trace is a text file of "<time us> <pressed GPIO mask, hex>" lines in time order, '#' starts a
+// comment. Pressed pins read low, like buttons to ground. The simulated clock moves on by the step
+// (25us by default, about what a Pico loop takes) after every iteration, so the replay follows the
+// trace's timing however fast the host is; stage times are host nanoseconds.
+
+#include <dirent.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "hostsim.h"
+
+#include "gp2040.h"
+#include "loopstats.h"
+#include "drivermanager.h"
+#include "storagemanager.h"
+#include "usbreportscheduler.h"
+#include "tusb.h"
+
+struct TraceEvent {
+	uint64_t timeUs;
+	uint32_t pressed;
+};
+
+static bool loadTrace(const std::string & path, std::vector<TraceEvent> & events) {
+	FILE * file = fopen(path.c_str(), "r");
+	if (file == nullptr)
+		return false;
+	char line[256];
+	while (fgets(line, sizeof(line), file) != nullptr) {
+		char * comment = strchr(line, '#');
+		if (comment != nullptr)
+			*comment = 0;
+		unsigned long long timeUs;
+		unsigned int pressed;
+		if (sscanf(line, "%llu %x", &timeUs, &pressed) == 2)
+			events.push_back({ timeUs, pressed });
+	}
+	fclose(file);
+	return !events.empty();
+}
+
+static void collectTraces(const std::string & path, std::vector<std::string> & traces) {
+	DIR * dir = opendir(path.c_str());
+	if (dir == nullptr) {
+		traces.push_back(path);
+		return;
+	}
+	std::vector<std::string> found;
+	while (struct dirent * entry = readdir(dir)) {
+		std::string name = entry->d_name;
+		if (name.size() > 6 && name.compare(name.size() - 6, 6, ".trace") == 0)
+			found.push_back(path + "/" + name);
+	}
+	closedir(dir);
+	std::sort(found.begin(), found.end());
+	traces.insert(traces.end(), found.begin(), found.end());
+}
+
+int main(int argc, char * argv[]) {
+	uint32_t stepUs = 25;
+	std::vector<std::string> traces;
+	for (int i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "--step-us") == 0 && i + 1 < argc)
+			stepUs = std::max(1, atoi(argv[++i]));
+		else
+			collectTraces(argv[i], traces);
+	}
+	if (traces.empty()) {
+		fprintf(stderr, "usage: %s [--step-us N] <trace or directory>...\n", argv[0]);
+		return 2;
+	}
+
+	hostTimeSetManual(true);
+	hostGpioSetInputs(0xffffffff);
+
+	// Same bring-up as GP2040::run(), which never returns
+	GP2040 * gp2040 = new GP2040();
+	gp2040->setup();
+	bool sofSync = Storage::getInstance().getGamepadOptions().usbSofSync;
+	if (sofSync)
+		DriverManager::getInstance().getDriver()->set_sof_callback(USBReportScheduler::sofCallback);
+	tud_init(TUD_OPT_RHPORT);
+	if (sofSync)
+		USBReportScheduler::getInstance().start(TUD_OPT_RHPORT, DriverManager::getInstance().getDriver()->get_descriptor_configuration_cb(0));
+
+	int failures = 0;
+	for (const std::string & path : traces) {
+		std::vector<TraceEvent> events;
+		if (!loadTrace(path, events)) {
+			fprintf(stderr, "%s: no events\n", path.c_str());
+			failures++;
+			continue;
+		}
+
+		// Settle on the first state before measuring
+		hostGpioSetInputs(~events[0].pressed);
+		for (int i = 0; i < 1000; i++) {
+			gp2040->runOnce();
+			hostTimeAdvanceUs(stepUs);
+		}
+		LoopStats::getInstance().reset();
+
+		uint64_t startUs = hostTimeNs() / 1000;
+		uint64_t reportsBefore = hostUSBReportCount();
+		uint64_t iterations = 0;
+		uint64_t busyNs = 0;
+		bool changes = false;
+		size_t next = 1;
+		uint64_t endUs = events.back().timeUs - events.front().timeUs;
+		while (true) {
+			uint64_t elapsedUs = hostTimeNs() / 1000 - startUs;
+			while (next < events.size() && events[next].timeUs - events.front().timeUs <= elapsedUs) {
+				changes |= events[next].pressed != events[next - 1].pressed;
+				hostGpioSetInputs(~events[next].pressed);
+				next++;
+			}
+			if (elapsedUs >= endUs)
+				break;
+			uint64_t before = hostClockNs();
+			gp2040->runOnce();
+			busyNs += hostClockNs() - before;
+			iterations++;
+			hostTimeAdvanceUs(stepUs);
+		}
+		uint64_t reports = hostUSBReportCount() - reportsBefore;
+
+		const char * name = strrchr(path.c_str(), '/');
+		printf("%s: %zu events, %llu iterations, %.0f iterations/sec, %llu reports\n", name ? name + 1 : path.c_str(),
+			events.size(), (unsigned long long)iterations, busyNs ? iterations * 1e9 / busyNs : 0.0, (unsigned long long)reports);
+		printf("  %-12s %10s %10s %10s %10s\n", "stage", "avg ns", "p50 ns", "p99 ns", "max ns");
+		for (int stage = LOOP_STAGE_TOTAL; stage < LOOP_STAGE_CORE1; stage++) {
+			const LoopStageStats & stats = LoopStats::getInstance().getStage((LoopStage)stage);
+			printf("  %-12s %10u %10u %10u %10u\n", LoopStats::getStageName((LoopStage)stage),
+				stats.getAverage(), stats.percentile(50), stats.percentile(99), stats.getMax());
+		}
+
+		// Any change in the inputs has to reach the host
+		if (changes && reports == 0) {
+			fprintf(stderr, "%s: inputs changed but no report was sent\n", path.c_str());
+			failures++;
+		}
+	}
+	return failures ? 1 : 0;
+}
@@ -0,0 +1,174 @@
+/*
+ * SPDX-License-Identifier: MIT
+ * SPDX-FileCopyrightText: Copyright (c) 2024 OpenStickCommunity (gp2040-ce.info)
+ */
+
+#ifndef _HOSTSIM_H_
+#define _HOSTSIM_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <vector>
+
+#include "pico.h"
+#include "hardware/i2c.h"
+#include "hardware/spi.h"
+#include "hardware/pio.h"
+
+/*
+	Simulated RP2040 behind the host stubs.
+
+	Everything runs on one thread. Time is either the host's monotonic clock, or virtual and only moved by
+	hostTimeAdvanceUs() (plus a small step on every read, so timeout loops in the firmware still end). Alarms,
+	repeating timers, DMA transfers and the interrupts they raise are serviced whenever the firmware reads the
+	time or spins in tight_loop_contents(), as long as interrupts aren't disabled; an interrupt raised while they
+	are is held until they are restored.
+
+	Peripherals are paced: DMA moves one element per byte/word time of the SPI, I2C or PIO endpoint it is tied
+	to, and the ADC converts one sample every 2us while running.
+*/
+
+// Time
+void hostTimeSetManual(bool manual);
+bool hostTimeIsManual();
+void hostTimeAdvanceUs(uint64_t us);
+void hostTimeAdvanceNs(uint64_t ns);
+uint64_t hostTimeNs();
+// Host monotonic nanoseconds, for measurements independent of the simulated clock
+uint64_t hostClockNs();
+void hostPoll();
+// Devices with timing of their own: the callback runs from the simulation once the clock reaches atNs
+typedef void (*HostEventCallback)(void * context);
+void hostScheduleAt(uint64_t atNs, HostEventCallback callback, void * context);
+
+// GPIO, levels are one bit per pin. Unconnected inputs read their pull, high by default.
+void hostGpioSetInputs(uint32_t levels);
+void hostGpioSetInput(uint gpio, bool level);
+uint32_t hostGpioInputs();
+uint32_t hostGpioOutputs();
+uint32_t hostGpioOutputEnables();
+// Called after the firmware changes an output level, with the new output levels
+typedef void (*HostGpioOutputHook)(uint32_t outputs, void * context);
+void hostGpioSetOutputHook(HostGpioOutputHook hook, void * context);
+
+// ADC, values for input 0-4 (GPIO26-29 and the temperature sensor)
+void hostAdcSetInput(uint input, uint16_t value);
+uint32_t hostAdcConversions();
+// Flag a FIFO overflow, as if conversions had been dropped
+void hostAdcForceOverrun();
+
+// Flash, the XIP window reads the image directly
+struct HostFlashStats {
+	uint32_t eraseCalls;
+	uint32_t programCalls;
+	uint32_t sectorsErased;
+	uint32_t pagesProgrammed;
+	uint64_t bytesErased;
+	uint64_t bytesProgrammed;
+	uint64_t busyUs;        // modelled time the flash was busy
+	uint64_t worstCallUs;   // longest single erase or program call
+};
+
+// Typical W25Q16JV timings
+#define HOST_FLASH_SECTOR_ERASE_US 45000
+#define HOST_FLASH_PAGE_PROGRAM_US 400
+
+struct HostFlashPowerCut {
+	uint32_t operation;
+};
+
+void hostFlashErase(uint8_t fill = 0xff);
+const HostFlashStats & hostFlashStats();
+void hostFlashResetStats();
+// Times the sector holding flash_offs has been erased since the stats were reset
+uint32_t hostFlashSectorErases(uint32_t flash_offs);
+// Cut the power during the given erase/program operation (sector erase or page program, counting from 0
+// after this call): the operation is left half done and HostFlashPowerCut is thrown. Negative disables.
+void hostFlashSetPowerCut(int64_t operation);
+uint64_t hostFlashOperations();
+// Whether erases and programs advance the simulated clock by their modelled time
+void hostFlashSetTimed(bool timed);
+
+// I2C, a device answers for one address. Returning false NAKs the address byte.
+class HostI2CDevice {
+public:
+	virtual ~HostI2CDevice() {}
+	virtual bool start(bool read) { (void)read; return true; }
+	virtual void write(uint8_t data) { (void)data; }
+	virtual uint8_t read() { return 0xff; }
+	virtual void stop() {}
+};
+
+struct HostI2CTransfer {
+	uint8_t block;
+	uint8_t address;
+	bool read;
+	bool nak;
+	uint64_t startNs;
+	uint64_t endNs;
+	std::vector<uint8_t> data;
+};
+
+void hostI2CAttach(i2c_inst_t * i2c, uint8_t address, HostI2CDevice * device);
+void hostI2CDetach(i2c_inst_t * i2c, uint8_t address);
+// Every address phase on the bus, in order, with the bytes written or read behind it
+std::vector<HostI2CTransfer> & hostI2CLog();
+void hostI2CSetLogging(bool enabled);
+
+// SPI, full duplex byte exchange with the device on the block
+class HostSPIDevice {
+public:
+	virtual ~HostSPIDevice() {}
+	virtual uint8_t transfer(uint8_t data) = 0;
+};
+
+void hostSPIAttach(spi_inst_t * spi, HostSPIDevice * device);
+uint64_t hostSPIBytes(spi_inst_t * spi);
+
+// PIO, the device stands in for the state machine program
+class HostPIODevice {
+public:
+	virtual ~HostPIODevice() {}
+	// Word taken from the TX FIFO
+	virtual void put(uint32_t data) { (void)data; }
+	// Nanoseconds the program needs per TX word, paces DMA into the FIFO
+	virtual uint32_t wordNs() { return 0; }
+	// Catch up to the given time while the state machine is enabled, for programs that run on their own
+	virtual void run(uint64_t nowNs) { (void)nowNs; }
+};
+
+void hostPIOAttach(PIO pio, uint sm, HostPIODevice * device);
+void hostPIOPushRx(PIO pio, uint sm, uint32_t data);
+uint64_t hostPIOTxWords(PIO pio, uint sm);
+
+// USB device, reports from the HID class end up here
+struct HostUSBReport {
+	uint8_t instance;
+	uint8_t reportId;
+	uint64_t queuedNs;      // armed on the endpoint
+	uint64_t timeNs;        // taken by the host's IN token
+	std::vector<uint8_t> data;
+};
+
+void hostUSBSetMounted(bool mounted);
+// Microseconds between IN token polls, the endpoint is busy from a report until the next poll
+void hostUSBSetPollIntervalUs(uint32_t us);
+// IN tokens every intervalFrames frames (bInterval), phaseUs after the SOF plus up to jitterUs more that varies
+// from frame to frame; hostUSBSetPollIntervalUs goes back to the plain interval
+void hostUSBSetPollSchedule(uint32_t intervalFrames, uint32_t phaseUs, uint32_t jitterUs);
+uint64_t hostUSBReportCount();
+const HostUSBReport & hostUSBLastReport();
+void hostUSBSetLogging(bool enabled);
+std::vector<HostUSBReport> & hostUSBLog();
+
+// Interrupts
+void hostIrqRaise(uint num);
+bool hostIrqMasked();
+
+// Thrown by watchdog_reboot() and reset_usb_boot(), the firmware never returns from either
+struct HostReboot {};
+
+// Put every simulated peripheral, the clock and the flash image back to the power-on state
+void hostReset();
+
+#endif
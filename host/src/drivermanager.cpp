@@ -0,0 +1,31 @@
+#include "drivermanager.h"
+
+#include "drivers/hid/HIDDriver.h"
+#include "drivers/ps4/PS4Driver.h"
+#include "drivers/xbone/XBOneDriver.h"
+#include "drivers/xinput/XInputDriver.h"
+
+// Host build: only the generic HID driver is compiled in. Every other mode, web config
+// included, runs it too and reports itself as generic so the loop stays on the gamepad path.
+void DriverManager::setup(InputMode mode) {
+    (void)mode;
+    driver = new HIDDriver();
+
+    // Initialize our chosen driver
+    driver->initialize();
+    inputMode = INPUT_MODE_GENERIC;
+}
+
+// Storage asks before saving in PS4/PS5 mode, which the host never reports
+bool PS4Driver::getDongleAuthRequired() {
+    return false;
+}
+
+// The button layout header asks the console drivers about auth, they never run on the host
+bool XBOneDriver::getAuthSent() {
+    return false;
+}
+
+bool XInputDriver::getAuthSent() {
+    return false;
+}
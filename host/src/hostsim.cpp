@@ -0,0 +1,2742 @@
+/*
+ * SPDX-License-Identifier: MIT
+ * SPDX-FileCopyrightText: Copyright (c) 2024 OpenStickCommunity (gp2040-ce.info)
+ */
+
+#include "hostsim.h"
+
+#include <chrono>
+#include <deque>
+#include <map>
+#include <vector>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "pico/stdlib.h"
+#include "pico/time.h"
+#include "pico/bootrom.h"
+#include "pico/multicore.h"
+#include "pico/mutex.h"
+#include "pico/critical_section.h"
+#include "pico/unique_id.h"
+#include "hardware/adc.h"
+#include "hardware/clocks.h"
+#include "hardware/dma.h"
+#include "hardware/flash.h"
+#include "hardware/gpio.h"
+#include "hardware/i2c.h"
+#include "hardware/irq.h"
+#include "hardware/pio.h"
+#include "hardware/pwm.h"
+#include "hardware/spi.h"
+#include "hardware/sync.h"
+#include "hardware/timer.h"
+#include "hardware/watchdog.h"
+#include "hardware/structs/ioqspi.h"
+#include "hardware/structs/sio.h"
+#include "hardware/structs/usb.h"
+#include "hardware/structs/xip_ctrl.h"
+#include "tusb.h"
+#include "device/usbd_pvt.h"
+#include "host/usbh_pvt.h"
+#include "rndis.h"
+
+// Every time read moves the virtual clock on by this much, so polling loops with a timeout still end
+#define HOST_TIME_READ_STEP_NS 100
+
+// Longest catch-up the ADC does in one go, older conversions are skipped
+#define HOST_ADC_MAX_CATCHUP 4096
+
+// Same as PICO_TIME_DEFAULT_ALARM_POOL_MAX_TIMERS
+#define HOST_ALARM_POOL_SIZE 16
+
+#define HOST_USB_FRAME_NS 1000000ull
+
+// DMA CTRL_TRIG fields
+#define DMA_CTRL_EN_BITS          0x00000001u
+#define DMA_CTRL_DATA_SIZE_LSB    2u
+#define DMA_CTRL_DATA_SIZE_BITS   0x0000000cu
+#define DMA_CTRL_INCR_READ_BITS   0x00000010u
+#define DMA_CTRL_INCR_WRITE_BITS  0x00000020u
+#define DMA_CTRL_RING_SIZE_LSB    6u
+#define DMA_CTRL_RING_SIZE_BITS   0x000003c0u
+#define DMA_CTRL_RING_SEL_BITS    0x00000400u
+#define DMA_CTRL_CHAIN_TO_LSB     11u
+#define DMA_CTRL_CHAIN_TO_BITS    0x00007800u
+#define DMA_CTRL_TREQ_SEL_LSB     15u
+#define DMA_CTRL_TREQ_SEL_BITS    0x001f8000u
+#define DMA_CTRL_IRQ_QUIET_BITS   0x00200000u
+#define DMA_CTRL_BSWAP_BITS       0x00400000u
+#define DMA_CTRL_BUSY_BITS        0x01000000u
+
+#define ADC_CS_AINSEL_LSB 12u
+#define ADC_CS_RROBIN_LSB 16u
+#define ADC_FCS_EN_BITS 0x00000001u
+#define ADC_FCS_FULL_BITS 0x00000200u
+
+//--------------------------------------------------------------------+
+// Register blocks
+//--------------------------------------------------------------------+
+
+// The register structs have read-only members, so the blocks are plain storage viewed through them
+#define REGISTER_BLOCK(type, name) alignas(type) static uint8_t name[sizeof(type)]
+
+struct spi_inst {
+	alignas(spi_hw_t) uint8_t regs[sizeof(spi_hw_t)];
+};
+
+struct i2c_inst {
+	alignas(i2c_hw_t) uint8_t regs[sizeof(i2c_hw_t)];
+	bool restart_on_next;
+};
+
+REGISTER_BLOCK(sio_hw_t, sioBlock);
+REGISTER_BLOCK(timer_hw_t, timerBlock);
+REGISTER_BLOCK(watchdog_hw_t, watchdogBlock);
+REGISTER_BLOCK(adc_hw_t, adcBlock);
+REGISTER_BLOCK(dma_hw_t, dmaBlock);
+REGISTER_BLOCK(xip_ctrl_hw_t, xipCtrlBlock);
+REGISTER_BLOCK(ioqspi_hw_t, ioqspiBlock);
+REGISTER_BLOCK(usb_device_dpram_t, usbDpramBlock);
+REGISTER_BLOCK(usb_hw_t, usbBlock);
+REGISTER_BLOCK(pio_hw_t, pio0Block);
+REGISTER_BLOCK(pio_hw_t, pio1Block);
+static spi_inst spiBlocks[NUM_SPIS];
+static i2c_inst i2cBlocks[NUM_I2CS];
+
+extern "C" {
+sio_hw_t * sio_hw = reinterpret_cast<sio_hw_t *>(sioBlock);
+timer_hw_t * timer_hw = reinterpret_cast<timer_hw_t *>(timerBlock);
+watchdog_hw_t * watchdog_hw = reinterpret_cast<watchdog_hw_t *>(watchdogBlock);
+adc_hw_t * adc_hw = reinterpret_cast<adc_hw_t *>(adcBlock);
+dma_hw_t * dma_hw = reinterpret_cast<dma_hw_t *>(dmaBlock);
+xip_ctrl_hw_t * xip_ctrl_hw = reinterpret_cast<xip_ctrl_hw_t *>(xipCtrlBlock);
+ioqspi_hw_t * ioqspi_hw = reinterpret_cast<ioqspi_hw_t *>(ioqspiBlock);
+usb_device_dpram_t * usb_dpram = reinterpret_cast<usb_device_dpram_t *>(usbDpramBlock);
+usb_hw_t * usb_hw = reinterpret_cast<usb_hw_t *>(usbBlock);
+spi_inst_t * const spi0 = &spiBlocks[0];
+spi_inst_t * const spi1 = &spiBlocks[1];
+i2c_inst_t * const i2c0 = &i2cBlocks[0];
+i2c_inst_t * const i2c1 = &i2cBlocks[1];
+pio_hw_t * const pio0 = reinterpret_cast<pio_hw_t *>(pio0Block);
+pio_hw_t * const pio1 = reinterpret_cast<pio_hw_t *>(pio1Block);
+uint8_t hostFlashImage[PICO_FLASH_SIZE_BYTES];
+}
+
+static inline spi_hw_t * spiHw(uint block) {
+	return reinterpret_cast<spi_hw_t *>(spiBlocks[block].regs);
+}
+
+static inline i2c_hw_t * i2cHw(uint block) {
+	return reinterpret_cast<i2c_hw_t *>(i2cBlocks[block].regs);
+}
+
+static inline pio_hw_t * pioHw(uint block) {
+	return block ? pio1 : pio0;
+}
+
+// Read-only registers are updated by the simulation
+template <typename T>
+static inline void setReg(const volatile T & reg, T value) {
+	const_cast<volatile T &>(reg) = value;
+}
+
+//--------------------------------------------------------------------+
+// Simulation state
+//--------------------------------------------------------------------+
+
+struct Alarm {
+	alarm_id_t id;
+	uint64_t atNs;
+	alarm_callback_t callback;
+	void * userData;
+	repeating_timer_t * timer;
+};
+
+struct DeviceEvent {
+	uint64_t atNs;
+	HostEventCallback callback;
+	void * context;
+};
+
+struct IrqLine {
+	bool enabled;
+	bool pending;
+	std::vector<irq_handler_t> handlers;
+};
+
+struct DmaChannel {
+	bool claimed;
+	bool busy;
+	uint32_t ctrl;
+	uint32_t reload;
+	uint64_t nextNs;
+};
+
+// A received byte is only in the RX FIFO once its last clock is out
+struct SpiRxByte {
+	uint8_t value;
+	uint64_t readyNs;
+};
+
+struct SpiState {
+	uint baudrate;
+	HostSPIDevice * device;
+	std::deque<SpiRxByte> rx;
+	uint64_t bytes;
+};
+
+struct I2CState {
+	uint baudrate;
+	std::map<uint8_t, HostI2CDevice *> devices;
+	HostI2CDevice * device;
+	bool active;
+	bool reading;
+	bool aborted;
+	std::deque<uint8_t> rx;
+	uint32_t pendingStat;
+	int logIndex;
+};
+
+struct PioStateMachine {
+	bool claimed;
+	HostPIODevice * device;
+	std::deque<uint32_t> rx;
+	uint64_t txWords;
+};
+
+struct PioState {
+	uint usedInstructions;
+	PioStateMachine sm[NUM_PIO_STATE_MACHINES];
+};
+
+struct AdcState {
+	uint16_t input[NUM_ADC_CHANNELS];
+	uint selected;
+	uint roundRobin;
+	bool running;
+	bool fifoEnabled;
+	bool dreqEnabled;
+	bool over;
+	bool under;
+	std::deque<uint16_t> fifo;
+	uint64_t periodNs;
+	uint64_t nextSampleNs;
+	uint32_t conversions;
+};
+
+struct UsbState {
+	bool inited;
+	bool mounted;
+	bool sofEnabled;
+	uint32_t pollIntervalUs;
+	uint32_t pollFrames;        // IN tokens every pollFrames frames when set, instead of every pollIntervalUs
+	uint32_t pollPhaseUs;
+	uint32_t pollJitterUs;
+	uint64_t frameBaseNs;       // start of frame 0
+	uint64_t nextFrameNs;
+	uint64_t nextPollNs;
+	uint32_t frame;
+	uint8_t inEndpoint;
+	bool busy;
+	bool completePending;
+	HostUSBReport pending;
+	HostUSBReport last;
+	uint64_t reportCount;
+	bool logging;
+	std::vector<HostUSBReport> log;
+	const usbd_class_driver_t * driver;
+};
+
+static bool timeManual = false;
+static uint64_t virtualNs = 0;
+static int64_t realOffsetNs = 0;
+static const std::chrono::steady_clock::time_point clockStart = std::chrono::steady_clock::now();
+
+static std::vector<Alarm> alarms;
+static std::vector<DeviceEvent> deviceEvents;
+static alarm_id_t nextAlarmId = 1;
+static irq_handler_t hardwareAlarmCallbacks[NUM_ALARMS];
+static uint64_t hardwareAlarmTargets[NUM_ALARMS];
+static uint32_t hardwareAlarmArmed = 0;
+static uint32_t timerAlarmSeen[NUM_ALARMS];
+
+static IrqLine irqLines[IRQ_COUNT];
+static bool interruptsMasked = false;
+static int irqDepth = 0;
+static bool progressing = false;
+static bool alarmsPending = false;
+static bool usbEventsPending = false;
+
+static volatile uint32_t spinLocks[NUM_SPIN_LOCKS];
+static uint32_t spinLocksClaimed = 0;
+
+static uint32_t gpioDriven = 0;
+static uint32_t gpioDrivenLevels = 0;
+static uint32_t gpioPullUps = 0;
+static uint32_t gpioPullDowns = 0;
+static uint32_t gpioLevels = 0;
+static uint32_t gpioIrqEnabled[NUM_BANK0_GPIOS];
+static uint32_t gpioIrqEvents[NUM_BANK0_GPIOS];
+static gpio_irq_callback_t gpioCallback = nullptr;
+static gpio_function_t gpioFunctions[NUM_BANK0_GPIOS];
+static HostGpioOutputHook gpioOutputHook = nullptr;
+static void * gpioOutputHookContext = nullptr;
+
+static DmaChannel dmaChannels[NUM_DMA_CHANNELS];
+static SpiState spiStates[NUM_SPIS];
+static I2CState i2cStates[NUM_I2CS];
+static PioState pioStates[NUM_PIOS];
+static AdcState adc;
+static UsbState usb;
+
+static std::vector<HostI2CTransfer> i2cLog;
+static bool i2cLogging = false;
+
+static HostFlashStats flashStats;
+static uint32_t flashSectorErases[PICO_FLASH_SIZE_BYTES / FLASH_SECTOR_SIZE];
+static int64_t flashPowerCut = -1;
+static uint64_t flashOperations = 0;
+static bool flashTimed = false;
+
+static bool watchdogReboot = false;
+
+static void progress();
+static void deliverIrqs();
+static void dmaTrigger(uint channel);
+
+//--------------------------------------------------------------------+
+// Time
+//--------------------------------------------------------------------+
+
+uint64_t hostClockNs() {
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - clockStart).count();
+}
+
+extern "C" uint32_t hostClockNs32(void) {
+	return (uint32_t)hostClockNs();
+}
+
+uint64_t hostTimeNs() {
+	if (!timeManual) {
+		uint64_t now = hostClockNs() + realOffsetNs;
+		if (now > virtualNs)
+			virtualNs = now;
+	}
+	return virtualNs;
+}
+
+void hostTimeSetManual(bool manual) {
+	uint64_t now = hostTimeNs();
+	timeManual = manual;
+	if (!manual)
+		realOffsetNs = (int64_t)now - (int64_t)hostClockNs();
+}
+
+bool hostTimeIsManual() {
+	return timeManual;
+}
+
+static void syncTimer() {
+	uint64_t us = virtualNs / 1000;
+	setReg(timer_hw->timerawl, (uint32_t)us);
+	setReg(timer_hw->timerawh, (uint32_t)(us >> 32));
+	setReg(timer_hw->timelr, (uint32_t)us);
+	setReg(timer_hw->timehr, (uint32_t)(us >> 32));
+}
+
+// Soonest time anything in the simulation has to happen
+static uint64_t nextEventNs() {
+	uint64_t next = UINT64_MAX;
+	for (const Alarm & alarm : alarms)
+		if (alarm.atNs < next) next = alarm.atNs;
+	for (const DeviceEvent & event : deviceEvents)
+		if (event.atNs < next) next = event.atNs;
+	for (uint i = 0; i < NUM_ALARMS; i++)
+		if ((hardwareAlarmArmed & (1u << i)) && hardwareAlarmTargets[i] < next) next = hardwareAlarmTargets[i];
+	// a channel already due is waiting on its DREQ, the endpoint's own event moves it on
+	for (uint i = 0; i < NUM_DMA_CHANNELS; i++)
+		if (dmaChannels[i].busy && dmaChannels[i].nextNs > virtualNs && dmaChannels[i].nextNs < next) next = dmaChannels[i].nextNs;
+	for (uint i = 0; i < NUM_SPIS; i++)
+		if (!spiStates[i].rx.empty() && spiStates[i].rx.front().readyNs > virtualNs && spiStates[i].rx.front().readyNs < next)
+			next = spiStates[i].rx.front().readyNs;
+	if (adc.running && adc.nextSampleNs < next) next = adc.nextSampleNs;
+	if (usb.inited) {
+		if (usb.nextFrameNs < next) next = usb.nextFrameNs;
+		if (usb.busy && usb.nextPollNs < next) next = usb.nextPollNs;
+	}
+	return next;
+}
+
+void hostTimeAdvanceNs(uint64_t ns) {
+	uint64_t target = hostTimeNs() + ns;
+	// Stop at every event on the way so alarms and interrupts see the time they were due at
+	while (true) {
+		uint64_t now = hostTimeNs();
+		uint64_t next = nextEventNs();
+		if (next <= now) next = now + 1;
+		if (next > target) next = target;
+		if (timeManual) virtualNs = next;
+		else realOffsetNs += (int64_t)(next - now);
+		hostPoll();
+		if (next >= target) break;
+	}
+}
+
+void hostTimeAdvanceUs(uint64_t us) {
+	hostTimeAdvanceNs(us * 1000);
+}
+
+void hostScheduleAt(uint64_t atNs, HostEventCallback callback, void * context) {
+	deviceEvents.push_back({ atNs, callback, context });
+}
+
+// Device events due by now, in time order; a callback may schedule more
+static void progressDeviceEvents(uint64_t now) {
+	while (true) {
+		auto due = deviceEvents.end();
+		for (auto it = deviceEvents.begin(); it != deviceEvents.end(); ++it)
+			if (it->atNs <= now && (due == deviceEvents.end() || it->atNs < due->atNs)) due = it;
+		if (due == deviceEvents.end())
+			break;
+		DeviceEvent event = *due;
+		deviceEvents.erase(due);
+		event.callback(event.context);
+	}
+}
+
+// Blocking peripheral calls take their transfer time off the virtual clock, without servicing anything
+static void spendNs(uint64_t ns) {
+	if (timeManual)
+		virtualNs += ns;
+}
+
+static inline void timeRead() {
+	if (timeManual)
+		virtualNs += HOST_TIME_READ_STEP_NS;
+	hostPoll();
+}
+
+void hostPoll() {
+	hostTimeNs();
+	syncTimer();
+	progress();
+	deliverIrqs();
+}
+
+extern "C" {
+
+void tight_loop_contents(void) {
+	timeRead();
+}
+
+absolute_time_t get_absolute_time(void) {
+	timeRead();
+	return virtualNs / 1000;
+}
+
+uint64_t time_us_64(void) {
+	timeRead();
+	return virtualNs / 1000;
+}
+
+uint32_t time_us_32(void) {
+	timeRead();
+	return (uint32_t)(virtualNs / 1000);
+}
+
+void busy_wait_until(absolute_time_t t) {
+	if (timeManual) {
+		uint64_t now = hostTimeNs();
+		if (t * 1000 > now)
+			hostTimeAdvanceNs(t * 1000 - now);
+		hostPoll();
+		return;
+	}
+	while (get_absolute_time() < t) {}
+}
+
+void busy_wait_us(uint64_t delay_us) {
+	busy_wait_until(get_absolute_time() + delay_us);
+}
+
+void busy_wait_us_32(uint32_t delay_us) {
+	busy_wait_us(delay_us);
+}
+
+void busy_wait_ms(uint32_t delay_ms) {
+	busy_wait_us(delay_ms * 1000ull);
+}
+
+void sleep_until(absolute_time_t target) {
+	busy_wait_until(target);
+}
+
+void sleep_us(uint64_t us) {
+	busy_wait_us(us);
+}
+
+void sleep_ms(uint32_t ms) {
+	busy_wait_us(ms * 1000ull);
+}
+
+bool best_effort_wfe_or_timeout(absolute_time_t timeout_timestamp) {
+	return time_reached(timeout_timestamp);
+}
+
+alarm_id_t add_alarm_at(absolute_time_t time, alarm_callback_t callback, void * user_data, bool fire_if_past) {
+	uint64_t now = hostTimeNs();
+	if (time * 1000 <= now && !fire_if_past)
+		return 0;
+	if (alarms.size() >= HOST_ALARM_POOL_SIZE)
+		return -1;
+	Alarm alarm = { nextAlarmId++, time * 1000, callback, user_data, nullptr };
+	if (nextAlarmId <= 0) nextAlarmId = 1;
+	alarms.push_back(alarm);
+	return alarm.id;
+}
+
+alarm_id_t add_alarm_in_us(uint64_t us, alarm_callback_t callback, void * user_data, bool fire_if_past) {
+	return add_alarm_at(hostTimeNs() / 1000 + us, callback, user_data, fire_if_past);
+}
+
+alarm_id_t add_alarm_in_ms(uint32_t ms, alarm_callback_t callback, void * user_data, bool fire_if_past) {
+	return add_alarm_in_us(ms * 1000ull, callback, user_data, fire_if_past);
+}
+
+bool cancel_alarm(alarm_id_t alarm_id) {
+	for (auto it = alarms.begin(); it != alarms.end(); ++it) {
+		if (it->id == alarm_id) {
+			alarms.erase(it);
+			return true;
+		}
+	}
+	return false;
+}
+
+bool add_repeating_timer_us(int64_t delay_us, repeating_timer_callback_t callback, void * user_data, repeating_timer_t * out) {
+	if (delay_us == 0) delay_us = 1;
+	if (alarms.size() >= HOST_ALARM_POOL_SIZE)
+		return false;
+	uint64_t delay = delay_us < 0 ? -delay_us : delay_us;
+	out->delay_us = delay_us;
+	out->callback = callback;
+	out->user_data = user_data;
+	out->pool = nullptr;
+	out->alarm_id = nextAlarmId++;
+	Alarm alarm = { out->alarm_id, hostTimeNs() + delay * 1000, nullptr, nullptr, out };
+	alarms.push_back(alarm);
+	return true;
+}
+
+bool add_repeating_timer_ms(int32_t delay_ms, repeating_timer_callback_t callback, void * user_data, repeating_timer_t * out) {
+	return add_repeating_timer_us(delay_ms * 1000ll, callback, user_data, out);
+}
+
+bool cancel_repeating_timer(repeating_timer_t * timer) {
+	bool cancelled = cancel_alarm(timer->alarm_id);
+	timer->alarm_id = 0;
+	return cancelled;
+}
+
+void hardware_alarm_claim(uint alarm_num) { (void)alarm_num; }
+int hardware_alarm_claim_unused(bool required) { (void)required; return 0; }
+void hardware_alarm_unclaim(uint alarm_num) { hardwareAlarmArmed &= ~(1u << alarm_num); }
+
+void hardware_alarm_set_callback(uint alarm_num, void (*callback)(uint alarm_num)) {
+	hardwareAlarmCallbacks[alarm_num] = (irq_handler_t)(void *)callback;
+}
+
+bool hardware_alarm_set_target(uint alarm_num, absolute_time_t t) {
+	if (t * 1000 <= hostTimeNs())
+		return true;
+	hardwareAlarmTargets[alarm_num] = t * 1000;
+	hardwareAlarmArmed |= 1u << alarm_num;
+	return false;
+}
+
+void hardware_alarm_cancel(uint alarm_num) {
+	hardwareAlarmArmed &= ~(1u << alarm_num);
+}
+
+}
+
+// Alarm pool callbacks run from the timer interrupt, one pass over everything that is due
+static void runAlarms() {
+	uint64_t now = hostTimeNs();
+	bool ran = true;
+	while (ran) {
+		ran = false;
+		for (size_t i = 0; i < alarms.size(); i++) {
+			if (alarms[i].atNs > now)
+				continue;
+			Alarm alarm = alarms[i];
+			alarms.erase(alarms.begin() + i);
+			ran = true;
+			if (alarm.timer != nullptr) {
+				repeating_timer_t * timer = alarm.timer;
+				if (timer->callback(timer) && timer->alarm_id == alarm.id) {
+					uint64_t delay = (timer->delay_us < 0 ? -timer->delay_us : timer->delay_us) * 1000;
+					alarm.atNs = (timer->delay_us < 0) ? alarm.atNs + delay : hostTimeNs() + delay;
+					alarms.push_back(alarm);
+				}
+			} else {
+				int64_t result = alarm.callback(alarm.id, alarm.userData);
+				if (result != 0) {
+					alarm.atNs = (result < 0) ? alarm.atNs + (uint64_t)(-result) * 1000 : hostTimeNs() + (uint64_t)result * 1000;
+					alarms.push_back(alarm);
+				}
+			}
+			break;
+		}
+	}
+}
+
+static void progressTimer() {
+	uint64_t now = virtualNs;
+	for (const Alarm & alarm : alarms) {
+		if (alarm.atNs <= now) {
+			alarmsPending = true;
+			break;
+		}
+	}
+
+	// Alarms armed through the registers, as WiiExtension does
+	uint32_t nowUs = (uint32_t)(now / 1000);
+	for (uint i = 0; i < NUM_ALARMS; i++) {
+		uint32_t target = timer_hw->alarm[i];
+		if (target != timerAlarmSeen[i]) {
+			timerAlarmSeen[i] = target;
+			hardwareAlarmTargets[i] = (now / 1000 + (uint32_t)(target - nowUs)) * 1000;
+			hardwareAlarmArmed |= 1u << i;
+		}
+		if ((hardwareAlarmArmed & (1u << i)) && hardwareAlarmTargets[i] <= now) {
+			hardwareAlarmArmed &= ~(1u << i);
+			timer_hw->intr |= 1u << i;
+			if ((timer_hw->inte & (1u << i)) || hardwareAlarmCallbacks[i] != nullptr)
+				hostIrqRaise(TIMER_IRQ_0 + i);
+		}
+	}
+}
+
+//--------------------------------------------------------------------+
+// Interrupts
+//--------------------------------------------------------------------+
+
+static void runUsbEvents();
+static void i2cIrqEnter(uint block);
+static void i2cIrqExit(uint block);
+
+void hostIrqRaise(uint num) {
+	if (num >= IRQ_COUNT)
+		return;
+	irqLines[num].pending = true;
+	deliverIrqs();
+}
+
+bool hostIrqMasked() {
+	return interruptsMasked;
+}
+
+static void runIrq(uint num) {
+	IrqLine & line = irqLines[num];
+	line.pending = false;
+	irqDepth++;
+	if (num == I2C0_IRQ || num == I2C1_IRQ)
+		i2cIrqEnter(num - I2C0_IRQ);
+	if (num <= TIMER_IRQ_3 && hardwareAlarmCallbacks[num - TIMER_IRQ_0] != nullptr) {
+		timer_hw->intr &= ~(1u << (num - TIMER_IRQ_0));
+		((void (*)(uint))(void *)hardwareAlarmCallbacks[num - TIMER_IRQ_0])(num - TIMER_IRQ_0);
+	}
+	// By index, a handler may add or remove handlers (and the tests count heap use around interrupts)
+	for (size_t i = 0; i < line.handlers.size(); i++)
+		line.handlers[i]();
+	if (num == I2C0_IRQ || num == I2C1_IRQ)
+		i2cIrqExit(num - I2C0_IRQ);
+	irqDepth--;
+}
+
+// Interrupts raised while the hardware is being stepped wait for the step to finish, a handler
+// spinning on a DMA channel has to see it move
+static void deliverIrqs() {
+	if (interruptsMasked || irqDepth > 0 || progressing)
+		return;
+	bool ran = true;
+	while (ran) {
+		ran = false;
+		if (alarmsPending) {
+			alarmsPending = false;
+			irqDepth++;
+			runAlarms();
+			irqDepth--;
+			ran = true;
+		}
+		if (usbEventsPending) {
+			usbEventsPending = false;
+			irqDepth++;
+			runUsbEvents();
+			irqDepth--;
+			ran = true;
+		}
+		for (uint num = 0; num < IRQ_COUNT; num++) {
+			if (irqLines[num].pending && (irqLines[num].enabled || (num <= TIMER_IRQ_3 && hardwareAlarmCallbacks[num] != nullptr))) {
+				runIrq(num);
+				ran = true;
+			}
+		}
+		if (ran) {
+			// handlers can start transfers that finish straight away
+			progress();
+		}
+	}
+}
+
+extern "C" {
+
+void irq_set_enabled(uint num, bool enabled) {
+	irqLines[num].enabled = enabled;
+	if (enabled) deliverIrqs();
+}
+
+bool irq_is_enabled(uint num) {
+	return irqLines[num].enabled;
+}
+
+void irq_set_priority(uint num, uint8_t hardware_priority) {
+	(void)num;
+	(void)hardware_priority;
+}
+
+void irq_set_exclusive_handler(uint num, irq_handler_t handler) {
+	irqLines[num].handlers.clear();
+	irqLines[num].handlers.push_back(handler);
+}
+
+void irq_add_shared_handler(uint num, irq_handler_t handler, uint8_t order_priority) {
+	(void)order_priority;
+	irqLines[num].handlers.push_back(handler);
+}
+
+void irq_remove_handler(uint num, irq_handler_t handler) {
+	std::vector<irq_handler_t> & handlers = irqLines[num].handlers;
+	for (auto it = handlers.begin(); it != handlers.end(); ++it) {
+		if (*it == handler) {
+			handlers.erase(it);
+			return;
+		}
+	}
+}
+
+irq_handler_t irq_get_exclusive_handler(uint num) {
+	return irqLines[num].handlers.size() == 1 ? irqLines[num].handlers[0] : nullptr;
+}
+
+void irq_set_pending(uint num) {
+	hostIrqRaise(num);
+}
+
+uint32_t save_and_disable_interrupts(void) {
+	uint32_t status = interruptsMasked ? 1 : 0;
+	interruptsMasked = true;
+	return status;
+}
+
+void restore_interrupts(uint32_t status) {
+	interruptsMasked = status != 0;
+	if (!interruptsMasked)
+		deliverIrqs();
+}
+
+spin_lock_t * spin_lock_instance(uint lock_num) {
+	return &spinLocks[lock_num];
+}
+
+uint spin_lock_get_num(spin_lock_t * lock) {
+	return (uint)(lock - spinLocks);
+}
+
+// One thread, so a lock is never contended; holding one masks interrupts as on the device
+uint32_t spin_lock_blocking(spin_lock_t * lock) {
+	uint32_t status = save_and_disable_interrupts();
+	*lock = 1;
+	return status;
+}
+
+void spin_unlock(spin_lock_t * lock, uint32_t saved_irq) {
+	*lock = 0;
+	restore_interrupts(saved_irq);
+}
+
+bool is_spin_locked(spin_lock_t * lock) {
+	return *lock != 0;
+}
+
+void spin_lock_unsafe_blocking(spin_lock_t * lock) {
+	*lock = 1;
+}
+
+void spin_unlock_unsafe(spin_lock_t * lock) {
+	*lock = 0;
+}
+
+spin_lock_t * spin_lock_init(uint lock_num) {
+	spinLocks[lock_num] = 0;
+	return &spinLocks[lock_num];
+}
+
+void spin_lock_claim(uint lock_num) {
+	spinLocksClaimed |= 1u << lock_num;
+}
+
+void spin_lock_unclaim(uint lock_num) {
+	spinLocksClaimed &= ~(1u << lock_num);
+}
+
+int spin_lock_claim_unused(bool required) {
+	// The SDK hands out the striped locks 16-23 first
+	for (uint lock = 16; lock < NUM_SPIN_LOCKS + 16; lock++) {
+		uint num = lock % NUM_SPIN_LOCKS;
+		if (!(spinLocksClaimed & (1u << num))) {
+			spinLocksClaimed |= 1u << num;
+			return num;
+		}
+	}
+	if (required) {
+		fprintf(stderr, "hostsim: no spin lock free\n");
+		abort();
+	}
+	return -1;
+}
+
+uint next_striped_spin_lock_num(void) {
+	static uint next = 16;
+	uint num = next;
+	next = (next == 23) ? 16 : next + 1;
+	return num;
+}
+
+void critical_section_init(critical_section_t * crit_sec) {
+	crit_sec->spin_lock = spin_lock_instance(next_striped_spin_lock_num());
+}
+
+void critical_section_init_with_lock_num(critical_section_t * crit_sec, uint lock_num) {
+	crit_sec->spin_lock = spin_lock_instance(lock_num);
+}
+
+void critical_section_enter_blocking(critical_section_t * crit_sec) {
+	crit_sec->save = spin_lock_blocking(crit_sec->spin_lock);
+}
+
+void critical_section_exit(critical_section_t * crit_sec) {
+	spin_unlock(crit_sec->spin_lock, crit_sec->save);
+}
+
+void critical_section_deinit(critical_section_t * crit_sec) {
+	crit_sec->spin_lock = nullptr;
+}
+
+void mutex_init(mutex_t * mtx) { mtx->owner = -1; }
+void mutex_enter_blocking(mutex_t * mtx) { mtx->owner = 0; }
+bool mutex_try_enter(mutex_t * mtx, uint32_t * owner_out) {
+	if (mtx->owner >= 0) {
+		if (owner_out != nullptr) *owner_out = mtx->owner;
+		return false;
+	}
+	mtx->owner = 0;
+	return true;
+}
+void mutex_exit(mutex_t * mtx) { mtx->owner = -1; }
+void recursive_mutex_init(recursive_mutex_t * mtx) { mtx->owner = -1; mtx->enter_count = 0; }
+void recursive_mutex_enter_blocking(recursive_mutex_t * mtx) { mtx->owner = 0; mtx->enter_count++; }
+void recursive_mutex_exit(recursive_mutex_t * mtx) { if (mtx->enter_count > 0 && --mtx->enter_count == 0) mtx->owner = -1; }
+
+void hw_set_bits(io_rw_32 * addr, uint32_t mask) {
+	if (addr == &adc_hw->fcs) {
+		// OVER and UNDER are write-one-to-clear
+		if (mask & ADC_FCS_OVER_BITS) adc.over = false;
+		if (mask & ADC_FCS_UNDER_BITS) adc.under = false;
+		mask &= ~(ADC_FCS_OVER_BITS | ADC_FCS_UNDER_BITS);
+	} else if (addr == &timer_hw->intr) {
+		*addr &= ~mask;
+		return;
+	}
+	*addr |= mask;
+}
+
+void hw_clear_bits(io_rw_32 * addr, uint32_t mask) {
+	*addr &= ~mask;
+}
+
+void hw_xor_bits(io_rw_32 * addr, uint32_t mask) {
+	*addr ^= mask;
+}
+
+void hw_write_masked(io_rw_32 * addr, uint32_t values, uint32_t write_mask) {
+	*addr = (*addr & ~write_mask) | (values & write_mask);
+}
+
+}
+
+//--------------------------------------------------------------------+
+// GPIO
+//--------------------------------------------------------------------+
+
+static uint32_t gpioComputeLevels() {
+	uint32_t outputs = sio_hw->gpio_out & sio_hw->gpio_oe;
+	uint32_t undriven = ~(gpioDriven | sio_hw->gpio_oe);
+	uint32_t levels = outputs | (gpioDrivenLevels & gpioDriven & ~sio_hw->gpio_oe) | (undriven & ~gpioPullDowns);
+	return levels & ((1u << NUM_BANK0_GPIOS) - 1);
+}
+
+// Latch edges on every pin that changed and raise the bank interrupt for enabled ones
+static void gpioUpdate() {
+	uint32_t levels = gpioComputeLevels();
+	uint32_t changed = levels ^ gpioLevels;
+	gpioLevels = levels;
+	setReg(sio_hw->gpio_in, levels);
+
+	bool raise = false;
+	for (uint pin = 0; pin < NUM_BANK0_GPIOS; pin++) {
+		uint32_t events = (levels & (1u << pin)) ? GPIO_IRQ_LEVEL_HIGH : GPIO_IRQ_LEVEL_LOW;
+		if (changed & (1u << pin))
+			events |= (levels & (1u << pin)) ? GPIO_IRQ_EDGE_RISE : GPIO_IRQ_EDGE_FALL;
+		gpioIrqEvents[pin] = (gpioIrqEvents[pin] & (GPIO_IRQ_EDGE_RISE | GPIO_IRQ_EDGE_FALL)) | events;
+		if (gpioIrqEnabled[pin] & events & ((changed & (1u << pin)) ? 0xf : (GPIO_IRQ_LEVEL_LOW | GPIO_IRQ_LEVEL_HIGH)))
+			raise = true;
+	}
+	if (raise)
+		hostIrqRaise(IO_IRQ_BANK0);
+}
+
+static void gpioOutputsChanged(uint32_t previous) {
+	gpioUpdate();
+	if (gpioOutputHook != nullptr && previous != sio_hw->gpio_out)
+		gpioOutputHook(sio_hw->gpio_out, gpioOutputHookContext);
+}
+
+void hostGpioSetInputs(uint32_t levels) {
+	gpioDriven = (1u << NUM_BANK0_GPIOS) - 1;
+	gpioDrivenLevels = levels;
+	gpioUpdate();
+}
+
+void hostGpioSetInput(uint gpio, bool level) {
+	gpioDriven |= 1u << gpio;
+	if (level) gpioDrivenLevels |= 1u << gpio;
+	else gpioDrivenLevels &= ~(1u << gpio);
+	gpioUpdate();
+}
+
+uint32_t hostGpioInputs() {
+	return gpioLevels;
+}
+
+uint32_t hostGpioOutputs() {
+	return sio_hw->gpio_out;
+}
+
+uint32_t hostGpioOutputEnables() {
+	return sio_hw->gpio_oe;
+}
+
+void hostGpioSetOutputHook(HostGpioOutputHook hook, void * context) {
+	gpioOutputHook = hook;
+	gpioOutputHookContext = context;
+}
+
+// SDK dispatcher for gpio_set_irq_callback(): acknowledge the edges and report each pin with events
+static void gpioDefaultIrqHandler() {
+	for (uint pin = 0; pin < NUM_BANK0_GPIOS; pin++) {
+		uint32_t events = gpioIrqEvents[pin] & gpioIrqEnabled[pin];
+		if (events) {
+			gpioIrqEvents[pin] &= ~(events & (GPIO_IRQ_EDGE_RISE | GPIO_IRQ_EDGE_FALL));
+			if (gpioCallback != nullptr)
+				gpioCallback(pin, events);
+		}
+	}
+}
+
+extern "C" {
+
+void gpio_init(uint gpio) {
+	sio_hw->gpio_oe &= ~(1u << gpio);
+	sio_hw->gpio_out &= ~(1u << gpio);
+	gpioFunctions[gpio] = GPIO_FUNC_SIO;
+	gpioUpdate();
+}
+
+void gpio_deinit(uint gpio) {
+	gpioFunctions[gpio] = GPIO_FUNC_NULL;
+}
+
+void gpio_init_mask(uint gpio_mask) {
+	for (uint pin = 0; pin < NUM_BANK0_GPIOS; pin++)
+		if (gpio_mask & (1u << pin)) gpio_init(pin);
+}
+
+void gpio_set_function(uint gpio, gpio_function_t fn) { gpioFunctions[gpio] = fn; }
+gpio_function_t gpio_get_function(uint gpio) { return gpioFunctions[gpio]; }
+
+void gpio_set_pulls(uint gpio, bool up, bool down) {
+	if (up) gpioPullUps |= 1u << gpio; else gpioPullUps &= ~(1u << gpio);
+	if (down) gpioPullDowns |= 1u << gpio; else gpioPullDowns &= ~(1u << gpio);
+	gpioUpdate();
+}
+
+void gpio_pull_up(uint gpio) { gpio_set_pulls(gpio, true, false); }
+void gpio_pull_down(uint gpio) { gpio_set_pulls(gpio, false, true); }
+void gpio_disable_pulls(uint gpio) { gpio_set_pulls(gpio, false, false); }
+bool gpio_is_pulled_up(uint gpio) { return gpioPullUps & (1u << gpio); }
+bool gpio_is_pulled_down(uint gpio) { return gpioPullDowns & (1u << gpio); }
+void gpio_set_input_enabled(uint gpio, bool enabled) { (void)gpio; (void)enabled; }
+void gpio_set_input_hysteresis_enabled(uint gpio, bool enabled) { (void)gpio; (void)enabled; }
+void gpio_set_slew_rate(uint gpio, enum gpio_slew_rate slew) { (void)gpio; (void)slew; }
+void gpio_set_drive_strength(uint gpio, enum gpio_drive_strength drive) { (void)gpio; (void)drive; }
+void gpio_set_outover(uint gpio, uint value) { (void)gpio; (void)value; }
+void gpio_set_inover(uint gpio, uint value) { (void)gpio; (void)value; }
+
+void gpio_set_dir(uint gpio, bool out) {
+	gpio_set_dir_masked(1u << gpio, out ? (1u << gpio) : 0);
+}
+
+bool gpio_is_dir_out(uint gpio) { return sio_hw->gpio_oe & (1u << gpio); }
+uint gpio_get_dir(uint gpio) { return gpio_is_dir_out(gpio) ? GPIO_OUT : GPIO_IN; }
+void gpio_set_dir_out_masked(uint32_t mask) { gpio_set_dir_masked(mask, mask); }
+void gpio_set_dir_in_masked(uint32_t mask) { gpio_set_dir_masked(mask, 0); }
+
+void gpio_set_dir_masked(uint32_t mask, uint32_t value) {
+	uint32_t previous = sio_hw->gpio_out;
+	sio_hw->gpio_oe = (sio_hw->gpio_oe & ~mask) | (value & mask);
+	gpioOutputsChanged(previous);
+}
+
+void gpio_set_dir_all_bits(uint32_t values) { gpio_set_dir_masked(0xffffffffu, values); }
+
+bool gpio_get(uint gpio) {
+	return gpio_get_all() & (1u << gpio);
+}
+
+uint32_t gpio_get_all(void) {
+	return gpioLevels;
+}
+
+bool gpio_get_out_level(uint gpio) { return sio_hw->gpio_out & (1u << gpio); }
+
+void gpio_put_masked(uint32_t mask, uint32_t value) {
+	uint32_t previous = sio_hw->gpio_out;
+	sio_hw->gpio_out = (previous & ~mask) | (value & mask);
+	gpioOutputsChanged(previous);
+}
+
+void gpio_put(uint gpio, bool value) { gpio_put_masked(1u << gpio, value ? (1u << gpio) : 0); }
+void gpio_put_all(uint32_t value) { gpio_put_masked(0xffffffffu, value); }
+void gpio_set_mask(uint32_t mask) { gpio_put_masked(mask, mask); }
+void gpio_clr_mask(uint32_t mask) { gpio_put_masked(mask, 0); }
+void gpio_xor_mask(uint32_t mask) { gpio_put_masked(mask, ~sio_hw->gpio_out); }
+
+void gpio_set_irq_enabled(uint gpio, uint32_t event_mask, bool enabled) {
+	// Enabling an edge drops one latched before, as the SDK does
+	gpioIrqEvents[gpio] &= ~(event_mask & (GPIO_IRQ_EDGE_RISE | GPIO_IRQ_EDGE_FALL));
+	if (enabled) gpioIrqEnabled[gpio] |= event_mask;
+	else gpioIrqEnabled[gpio] &= ~event_mask;
+}
+
+void gpio_set_irq_callback(gpio_irq_callback_t callback) {
+	gpioCallback = callback;
+	irq_remove_handler(IO_IRQ_BANK0, gpioDefaultIrqHandler);
+	irq_add_shared_handler(IO_IRQ_BANK0, gpioDefaultIrqHandler, PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY);
+}
+
+void gpio_set_irq_enabled_with_callback(uint gpio, uint32_t event_mask, bool enabled, gpio_irq_callback_t callback) {
+	gpio_set_irq_enabled(gpio, event_mask, enabled);
+	gpio_set_irq_callback(callback);
+	if (enabled) irq_set_enabled(IO_IRQ_BANK0, true);
+}
+
+void gpio_set_dormant_irq_enabled(uint gpio, uint32_t event_mask, bool enabled) {
+	(void)gpio; (void)event_mask; (void)enabled;
+}
+
+uint32_t gpio_get_irq_event_mask(uint gpio) {
+	return gpioIrqEvents[gpio] & gpioIrqEnabled[gpio];
+}
+
+void gpio_acknowledge_irq(uint gpio, uint32_t event_mask) {
+	gpioIrqEvents[gpio] &= ~(event_mask & (GPIO_IRQ_EDGE_RISE | GPIO_IRQ_EDGE_FALL));
+}
+
+void gpio_add_raw_irq_handler_with_order_priority_masked(uint32_t gpio_mask, irq_handler_t handler, uint8_t order_priority) {
+	(void)gpio_mask;
+	irq_add_shared_handler(IO_IRQ_BANK0, handler, order_priority);
+}
+
+void gpio_add_raw_irq_handler_with_order_priority(uint gpio, irq_handler_t handler, uint8_t order_priority) {
+	gpio_add_raw_irq_handler_with_order_priority_masked(1u << gpio, handler, order_priority);
+}
+
+void gpio_add_raw_irq_handler_masked(uint32_t gpio_mask, irq_handler_t handler) {
+	gpio_add_raw_irq_handler_with_order_priority_masked(gpio_mask, handler, PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY);
+}
+
+void gpio_add_raw_irq_handler(uint gpio, irq_handler_t handler) {
+	gpio_add_raw_irq_handler_masked(1u << gpio, handler);
+}
+
+void gpio_remove_raw_irq_handler_masked(uint32_t gpio_mask, irq_handler_t handler) {
+	(void)gpio_mask;
+	irq_remove_handler(IO_IRQ_BANK0, handler);
+}
+
+void gpio_remove_raw_irq_handler(uint gpio, irq_handler_t handler) {
+	gpio_remove_raw_irq_handler_masked(1u << gpio, handler);
+}
+
+}
+
+//--------------------------------------------------------------------+
+// ADC
+//--------------------------------------------------------------------+
+
+static void adcSync() {
+	uint32_t cs = adc_hw->cs & ~(ADC_CS_START_MANY_BITS | (7u << ADC_CS_AINSEL_LSB) | (0x1fu << ADC_CS_RROBIN_LSB));
+	cs |= (adc.running ? ADC_CS_START_MANY_BITS : 0) | (adc.selected << ADC_CS_AINSEL_LSB) | (adc.roundRobin << ADC_CS_RROBIN_LSB);
+	adc_hw->cs = cs;
+	uint32_t level = adc.fifo.size();
+	adc_hw->fcs = (adc.fifoEnabled ? ADC_FCS_EN_BITS : 0) | (level == 0 ? ADC_FCS_EMPTY_BITS : 0) | (level >= 4 ? ADC_FCS_FULL_BITS : 0)
+		| (adc.over ? ADC_FCS_OVER_BITS : 0) | (adc.under ? ADC_FCS_UNDER_BITS : 0) | (level << ADC_FCS_LEVEL_LSB);
+	setReg(adc_hw->fifo, adc.fifo.empty() ? 0u : (uint32_t)adc.fifo.front());
+}
+
+static uint16_t adcConvert() {
+	uint16_t value = adc.input[adc.selected] & 0xfff;
+	adc.conversions++;
+	if (adc.roundRobin != 0) {
+		// next enabled input above the current one, wrapping round
+		for (uint step = 1; step <= NUM_ADC_CHANNELS; step++) {
+			uint input = (adc.selected + step) % NUM_ADC_CHANNELS;
+			if (adc.roundRobin & (1u << input)) {
+				adc.selected = input;
+				break;
+			}
+		}
+	}
+	return value;
+}
+
+void hostAdcSetInput(uint input, uint16_t value) {
+	adc.input[input] = value;
+}
+
+uint32_t hostAdcConversions() {
+	return adc.conversions;
+}
+
+void hostAdcForceOverrun() {
+	adc.over = true;
+	adcSync();
+}
+
+extern "C" {
+
+void adc_init(void) {
+	adc.running = false;
+	adc.fifo.clear();
+	adc.periodNs = 2000;
+	adcSync();
+}
+
+void adc_gpio_init(uint gpio) {
+	gpio_set_function(gpio, GPIO_FUNC_NULL);
+	gpio_disable_pulls(gpio);
+}
+
+void adc_select_input(uint input) {
+	adc.selected = input;
+	adcSync();
+}
+
+uint adc_get_selected_input(void) {
+	return adc.selected;
+}
+
+void adc_set_round_robin(uint input_mask) {
+	adc.roundRobin = input_mask;
+	adcSync();
+}
+
+void adc_set_temp_sensor_enabled(bool enable) {
+	(void)enable;
+}
+
+uint16_t adc_read(void) {
+	spendNs(adc.periodNs);
+	return adcConvert();
+}
+
+void adc_run(bool run) {
+	if (run && !adc.running)
+		adc.nextSampleNs = hostTimeNs() + adc.periodNs;
+	adc.running = run;
+	adcSync();
+}
+
+void adc_set_clkdiv(float clkdiv) {
+	// one conversion takes 96 cycles of the 48MHz ADC clock at least
+	float cycles = (clkdiv + 1.0f) < 96.0f ? 96.0f : (clkdiv + 1.0f);
+	adc.periodNs = (uint64_t)(cycles * 1000.0f / 48.0f);
+}
+
+void adc_fifo_setup(bool en, bool dreq_en, uint16_t dreq_thresh, bool err_in_fifo, bool byte_shift) {
+	(void)dreq_thresh;
+	(void)err_in_fifo;
+	(void)byte_shift;
+	adc.fifoEnabled = en;
+	adc.dreqEnabled = dreq_en;
+	adcSync();
+}
+
+bool adc_fifo_is_empty(void) {
+	return adc.fifo.empty();
+}
+
+uint8_t adc_fifo_get_level(void) {
+	return adc.fifo.size();
+}
+
+uint16_t adc_fifo_get(void) {
+	if (adc.fifo.empty()) {
+		adc.under = true;
+		adcSync();
+		return 0;
+	}
+	uint16_t value = adc.fifo.front();
+	adc.fifo.pop_front();
+	adcSync();
+	return value;
+}
+
+uint16_t adc_fifo_get_blocking(void) {
+	while (adc.fifo.empty() && adc.running)
+		tight_loop_contents();
+	return adc_fifo_get();
+}
+
+void adc_fifo_drain(void) {
+	adc.fifo.clear();
+	adcSync();
+}
+
+void adc_irq_set_enabled(bool enabled) {
+	(void)enabled;
+}
+
+}
+
+//--------------------------------------------------------------------+
+// DMA
+//--------------------------------------------------------------------+
+
+enum EndpointType {
+	ENDPOINT_MEMORY,
+	ENDPOINT_SPI,
+	ENDPOINT_I2C,
+	ENDPOINT_ADC,
+	ENDPOINT_PIO_TX,
+	ENDPOINT_PIO_RX,
+	ENDPOINT_DMA,
+};
+
+struct Endpoint {
+	EndpointType type;
+	uint index;
+	uint sm;
+};
+
+static Endpoint classify(uintptr_t address) {
+	for (uint i = 0; i < NUM_SPIS; i++)
+		if (address == (uintptr_t)&spiHw(i)->dr) return { ENDPOINT_SPI, i, 0 };
+	for (uint i = 0; i < NUM_I2CS; i++)
+		if (address == (uintptr_t)&i2cHw(i)->data_cmd) return { ENDPOINT_I2C, i, 0 };
+	if (address == (uintptr_t)&adc_hw->fifo)
+		return { ENDPOINT_ADC, 0, 0 };
+	for (uint i = 0; i < NUM_PIOS; i++) {
+		for (uint sm = 0; sm < NUM_PIO_STATE_MACHINES; sm++) {
+			if (address == (uintptr_t)&pioHw(i)->txf[sm]) return { ENDPOINT_PIO_TX, i, sm };
+			if (address == (uintptr_t)&pioHw(i)->rxf[sm]) return { ENDPOINT_PIO_RX, i, sm };
+		}
+	}
+	if (address >= (uintptr_t)&dma_hw->ch[0] && address < (uintptr_t)&dma_hw->ch[NUM_DMA_CHANNELS])
+		return { ENDPOINT_DMA, (uint)((address - (uintptr_t)&dma_hw->ch[0]) / sizeof(dma_channel_hw_t)), 0 };
+	return { ENDPOINT_MEMORY, 0, 0 };
+}
+
+static uint64_t spiByteNs(uint block) {
+	uint baudrate = spiStates[block].baudrate ? spiStates[block].baudrate : 1000000;
+	return 8000000000ull / baudrate;
+}
+
+static uint64_t i2cByteNs(uint block) {
+	uint baudrate = i2cStates[block].baudrate ? i2cStates[block].baudrate : 100000;
+	return 9000000000ull / baudrate;
+}
+
+static bool spiRxReady(uint block) {
+	const SpiState & state = spiStates[block];
+	return !state.rx.empty() && state.rx.front().readyNs <= virtualNs;
+}
+
+static uint8_t spiExchange(uint block, uint8_t data) {
+	SpiState & state = spiStates[block];
+	state.bytes++;
+	return (state.device != nullptr) ? state.device->transfer(data) : 0xff;
+}
+
+static uint64_t i2cCommand(uint block, uint32_t command);
+
+// Whether the source has an element ready
+static bool dmaSourceReady(const Endpoint & source) {
+	switch (source.type) {
+		case ENDPOINT_SPI: return spiRxReady(source.index);
+		case ENDPOINT_I2C: return !i2cStates[source.index].rx.empty();
+		case ENDPOINT_ADC: return !adc.fifo.empty();
+		case ENDPOINT_PIO_RX: return !pioStates[source.index].sm[source.sm].rx.empty();
+		default: return true;
+	}
+}
+
+static uint32_t dmaRead(const Endpoint & source, uintptr_t address, uint size) {
+	uint32_t value = 0;
+	switch (source.type) {
+		case ENDPOINT_SPI:
+			value = spiStates[source.index].rx.front().value;
+			spiStates[source.index].rx.pop_front();
+			break;
+		case ENDPOINT_I2C:
+			value = i2cStates[source.index].rx.front();
+			i2cStates[source.index].rx.pop_front();
+			setReg(i2cHw(source.index)->rxflr, (uint32_t)i2cStates[source.index].rx.size());
+			break;
+		case ENDPOINT_ADC:
+			value = adc.fifo.front();
+			adc.fifo.pop_front();
+			adcSync();
+			break;
+		case ENDPOINT_PIO_RX:
+			value = pioStates[source.index].sm[source.sm].rx.front();
+			pioStates[source.index].sm[source.sm].rx.pop_front();
+			break;
+		default:
+			memcpy(&value, (const void *)address, size);
+			break;
+	}
+	return value;
+}
+
+static void dmaWriteRegister(uint channel, uintptr_t address, uint32_t value) {
+	dma_channel_hw_t * hw = &dma_hw->ch[channel];
+	if (address == (uintptr_t)&hw->al2_write_addr_trig || address == (uintptr_t)&hw->write_addr || address == (uintptr_t)&hw->al1_write_addr || address == (uintptr_t)&hw->al3_write_addr) {
+		// a 32-bit transfer carries the low half of a host pointer, keep the high half
+		hw->write_addr = (hw->write_addr & ~(uintptr_t)0xffffffffu) | value;
+	} else if (address == (uintptr_t)&hw->al3_read_addr_trig || address == (uintptr_t)&hw->read_addr || address == (uintptr_t)&hw->al1_read_addr || address == (uintptr_t)&hw->al2_read_addr) {
+		hw->read_addr = (hw->read_addr & ~(uintptr_t)0xffffffffu) | value;
+	} else if (address == (uintptr_t)&hw->transfer_count || address == (uintptr_t)&hw->al1_transfer_count_trig || address == (uintptr_t)&hw->al2_transfer_count || address == (uintptr_t)&hw->al3_transfer_count) {
+		dmaChannels[channel].reload = value;
+	} else if (address == (uintptr_t)&hw->ctrl_trig || address == (uintptr_t)&hw->al1_ctrl || address == (uintptr_t)&hw->al2_ctrl || address == (uintptr_t)&hw->al3_ctrl) {
+		dmaChannels[channel].ctrl = value;
+	}
+	if (address == (uintptr_t)&hw->al2_write_addr_trig || address == (uintptr_t)&hw->al3_read_addr_trig ||
+		address == (uintptr_t)&hw->al1_transfer_count_trig || address == (uintptr_t)&hw->ctrl_trig)
+		dmaTrigger(channel);
+}
+
+// Store an element and return the time the sink takes for it
+static uint64_t dmaWrite(const Endpoint & sink, uintptr_t address, uint32_t value, uint size, uint64_t atNs) {
+	switch (sink.type) {
+		case ENDPOINT_SPI:
+			spiStates[sink.index].rx.push_back({ spiExchange(sink.index, value & 0xff), atNs + spiByteNs(sink.index) });
+			return spiByteNs(sink.index);
+		case ENDPOINT_I2C:
+			return i2cCommand(sink.index, value);
+		case ENDPOINT_PIO_TX: {
+			PioStateMachine & sm = pioStates[sink.index].sm[sink.sm];
+			sm.txWords++;
+			if (sm.device != nullptr) {
+				sm.device->put(value);
+				return sm.device->wordNs();
+			}
+			return 0;
+		}
+		case ENDPOINT_DMA:
+			dmaWriteRegister(sink.index, address, value);
+			return 0;
+		default:
+			memcpy((void *)address, &value, size);
+			return 0;
+	}
+}
+
+static void dmaComplete(uint channel) {
+	DmaChannel & state = dmaChannels[channel];
+	state.busy = false;
+	dma_hw->ch[channel].ctrl_trig = state.ctrl & ~DMA_CTRL_BUSY_BITS;
+	if (!(state.ctrl & DMA_CTRL_IRQ_QUIET_BITS)) {
+		setReg(dma_hw->intr, dma_hw->intr | (1u << channel));
+		if (dma_hw->inte0 & (1u << channel)) {
+			dma_hw->ints0 |= 1u << channel;
+			hostIrqRaise(DMA_IRQ_0);
+		}
+		if (dma_hw->inte1 & (1u << channel)) {
+			dma_hw->ints1 |= 1u << channel;
+			hostIrqRaise(DMA_IRQ_1);
+		}
+	}
+	uint chainTo = (state.ctrl & DMA_CTRL_CHAIN_TO_BITS) >> DMA_CTRL_CHAIN_TO_LSB;
+	if (chainTo != channel)
+		dmaTrigger(chainTo);
+}
+
+static void i2cReset(uint block);
+
+static void dmaTrigger(uint channel) {
+	DmaChannel & state = dmaChannels[channel];
+	if (!(state.ctrl & DMA_CTRL_EN_BITS))
+		return;
+	dma_channel_hw_t * hw = &dma_hw->ch[channel];
+	Endpoint sink = classify(hw->write_addr);
+	if (sink.type == ENDPOINT_I2C)
+		i2cReset(sink.index);
+	hw->transfer_count = state.reload;
+	state.busy = true;
+	state.nextNs = virtualNs;
+	hw->ctrl_trig = state.ctrl | DMA_CTRL_BUSY_BITS;
+	if (state.reload == 0)
+		dmaComplete(channel);
+}
+
+static inline uintptr_t dmaAdvance(uintptr_t address, uint size, uint ringBits) {
+	if (ringBits == 0)
+		return address + size;
+	uintptr_t mask = ((uintptr_t)1 << ringBits) - 1;
+	return (address & ~mask) | ((address + size) & mask);
+}
+
+// Move what each busy channel can move by now, returns whether anything moved
+static bool dmaStep(uint64_t now) {
+	bool moved = false;
+	for (uint channel = 0; channel < NUM_DMA_CHANNELS; channel++) {
+		DmaChannel & state = dmaChannels[channel];
+		dma_channel_hw_t * hw = &dma_hw->ch[channel];
+		if (!state.busy)
+			continue;
+		Endpoint source = classify(hw->read_addr);
+		Endpoint sink = classify(hw->write_addr);
+		uint size = 1u << ((state.ctrl & DMA_CTRL_DATA_SIZE_BITS) >> DMA_CTRL_DATA_SIZE_LSB);
+		uint ringBits = (state.ctrl & DMA_CTRL_RING_SIZE_BITS) >> DMA_CTRL_RING_SIZE_LSB;
+		bool ringWrite = state.ctrl & DMA_CTRL_RING_SEL_BITS;
+		while (state.busy && hw->transfer_count > 0 && state.nextNs <= now && dmaSourceReady(source)) {
+			uint32_t value = dmaRead(source, hw->read_addr, size);
+			if ((state.ctrl & DMA_CTRL_BSWAP_BITS) && size > 1)
+				value = (size == 2) ? __builtin_bswap16(value) : __builtin_bswap32(value);
+			state.nextNs += dmaWrite(sink, hw->write_addr, value, size, state.nextNs);
+			moved = true;
+			// a register write may have retriggered this channel
+			if (sink.type == ENDPOINT_DMA && sink.index == channel)
+				break;
+			if (state.ctrl & DMA_CTRL_INCR_READ_BITS)
+				hw->read_addr = dmaAdvance(hw->read_addr, size, ringWrite ? 0 : ringBits);
+			if (state.ctrl & DMA_CTRL_INCR_WRITE_BITS)
+				hw->write_addr = dmaAdvance(hw->write_addr, size, ringWrite ? ringBits : 0);
+			hw->transfer_count = hw->transfer_count - 1;
+			if (hw->transfer_count == 0)
+				dmaComplete(channel);
+		}
+	}
+	return moved;
+}
+
+extern "C" {
+
+void dma_channel_claim(uint channel) { dmaChannels[channel].claimed = true; }
+void dma_claim_mask(uint32_t channel_mask) {
+	for (uint i = 0; i < NUM_DMA_CHANNELS; i++)
+		if (channel_mask & (1u << i)) dma_channel_claim(i);
+}
+void dma_channel_unclaim(uint channel) { dmaChannels[channel].claimed = false; }
+void dma_unclaim_mask(uint32_t channel_mask) {
+	for (uint i = 0; i < NUM_DMA_CHANNELS; i++)
+		if (channel_mask & (1u << i)) dma_channel_unclaim(i);
+}
+
+int dma_claim_unused_channel(bool required) {
+	for (uint i = 0; i < NUM_DMA_CHANNELS; i++) {
+		if (!dmaChannels[i].claimed) {
+			dmaChannels[i].claimed = true;
+			return i;
+		}
+	}
+	if (required) {
+		fprintf(stderr, "hostsim: no DMA channel free\n");
+		abort();
+	}
+	return -1;
+}
+
+bool dma_channel_is_claimed(uint channel) { return dmaChannels[channel].claimed; }
+
+dma_channel_config dma_channel_get_default_config(uint channel) {
+	dma_channel_config config = { 0 };
+	config.ctrl = DMA_CTRL_EN_BITS | DMA_CTRL_INCR_READ_BITS | (DMA_SIZE_32 << DMA_CTRL_DATA_SIZE_LSB)
+		| (channel << DMA_CTRL_CHAIN_TO_LSB) | (DREQ_FORCE << DMA_CTRL_TREQ_SEL_LSB);
+	return config;
+}
+
+dma_channel_config dma_get_channel_config(uint channel) {
+	dma_channel_config config = { dmaChannels[channel].ctrl };
+	return config;
+}
+
+static inline void setCtrl(dma_channel_config * c, uint32_t bits, bool set) {
+	c->ctrl = set ? (c->ctrl | bits) : (c->ctrl & ~bits);
+}
+
+void channel_config_set_read_increment(dma_channel_config * c, bool incr) { setCtrl(c, DMA_CTRL_INCR_READ_BITS, incr); }
+void channel_config_set_write_increment(dma_channel_config * c, bool incr) { setCtrl(c, DMA_CTRL_INCR_WRITE_BITS, incr); }
+void channel_config_set_dreq(dma_channel_config * c, uint dreq) {
+	c->ctrl = (c->ctrl & ~DMA_CTRL_TREQ_SEL_BITS) | (dreq << DMA_CTRL_TREQ_SEL_LSB);
+}
+void channel_config_set_chain_to(dma_channel_config * c, uint chain_to) {
+	c->ctrl = (c->ctrl & ~DMA_CTRL_CHAIN_TO_BITS) | (chain_to << DMA_CTRL_CHAIN_TO_LSB);
+}
+void channel_config_set_transfer_data_size(dma_channel_config * c, enum dma_channel_transfer_size size) {
+	c->ctrl = (c->ctrl & ~DMA_CTRL_DATA_SIZE_BITS) | ((uint32_t)size << DMA_CTRL_DATA_SIZE_LSB);
+}
+void channel_config_set_ring(dma_channel_config * c, bool write, uint size_bits) {
+	c->ctrl = (c->ctrl & ~(DMA_CTRL_RING_SIZE_BITS | DMA_CTRL_RING_SEL_BITS)) | (size_bits << DMA_CTRL_RING_SIZE_LSB) | (write ? DMA_CTRL_RING_SEL_BITS : 0);
+}
+void channel_config_set_bswap(dma_channel_config * c, bool bswap) { setCtrl(c, DMA_CTRL_BSWAP_BITS, bswap); }
+void channel_config_set_irq_quiet(dma_channel_config * c, bool irq_quiet) { setCtrl(c, DMA_CTRL_IRQ_QUIET_BITS, irq_quiet); }
+void channel_config_set_high_priority(dma_channel_config * c, bool high_priority) { (void)c; (void)high_priority; }
+void channel_config_set_enable(dma_channel_config * c, bool enable) { setCtrl(c, DMA_CTRL_EN_BITS, enable); }
+void channel_config_set_sniff_enable(dma_channel_config * c, bool sniff_enable) { (void)c; (void)sniff_enable; }
+
+void dma_channel_set_config(uint channel, const dma_channel_config * config, bool trigger) {
+	dmaChannels[channel].ctrl = config->ctrl;
+	dma_hw->ch[channel].al1_ctrl = config->ctrl;
+	if (trigger) dmaTrigger(channel);
+}
+
+void dma_channel_set_read_addr(uint channel, const volatile void * read_addr, bool trigger) {
+	dma_hw->ch[channel].read_addr = (uintptr_t)read_addr;
+	if (trigger) dmaTrigger(channel);
+}
+
+void dma_channel_set_write_addr(uint channel, volatile void * write_addr, bool trigger) {
+	dma_hw->ch[channel].write_addr = (uintptr_t)write_addr;
+	if (trigger) dmaTrigger(channel);
+}
+
+void dma_channel_set_trans_count(uint channel, uint32_t trans_count, bool trigger) {
+	dmaChannels[channel].reload = trans_count;
+	if (!dmaChannels[channel].busy)
+		dma_hw->ch[channel].transfer_count = trans_count;
+	if (trigger) dmaTrigger(channel);
+}
+
+void dma_channel_configure(uint channel, const dma_channel_config * config, volatile void * write_addr,
+                           const volatile void * read_addr, uint transfer_count, bool trigger) {
+	dma_channel_set_read_addr(channel, read_addr, false);
+	dma_channel_set_write_addr(channel, write_addr, false);
+	dma_channel_set_trans_count(channel, transfer_count, false);
+	dma_channel_set_config(channel, config, trigger);
+	hostPoll();
+}
+
+void dma_channel_transfer_from_buffer_now(uint channel, const volatile void * read_addr, uint32_t transfer_count) {
+	dma_hw->ch[channel].read_addr = (uintptr_t)read_addr;
+	dmaChannels[channel].reload = transfer_count;
+	dmaTrigger(channel);
+	hostPoll();
+}
+
+void dma_channel_transfer_to_buffer_now(uint channel, volatile void * write_addr, uint32_t transfer_count) {
+	dma_hw->ch[channel].write_addr = (uintptr_t)write_addr;
+	dmaChannels[channel].reload = transfer_count;
+	dmaTrigger(channel);
+	hostPoll();
+}
+
+void dma_start_channel_mask(uint32_t chan_mask) {
+	for (uint i = 0; i < NUM_DMA_CHANNELS; i++)
+		if (chan_mask & (1u << i)) dmaTrigger(i);
+	hostPoll();
+}
+
+void dma_channel_start(uint channel) {
+	dma_start_channel_mask(1u << channel);
+}
+
+void dma_channel_abort(uint channel) {
+	dmaChannels[channel].busy = false;
+	dma_hw->ch[channel].ctrl_trig = dmaChannels[channel].ctrl & ~DMA_CTRL_BUSY_BITS;
+}
+
+bool dma_channel_is_busy(uint channel) {
+	// the DMA runs on while the CPU spins, even inside an interrupt handler
+	if (dmaChannels[channel].busy) {
+		if (timeManual) virtualNs += HOST_TIME_READ_STEP_NS;
+		hostTimeNs();
+		progress();
+		deliverIrqs();
+	}
+	return dmaChannels[channel].busy;
+}
+
+void dma_channel_wait_for_finish_blocking(uint channel) {
+	while (dma_channel_is_busy(channel)) {}
+}
+
+void dma_channel_set_irq0_enabled(uint channel, bool enabled) {
+	if (enabled) dma_hw->inte0 |= 1u << channel; else dma_hw->inte0 &= ~(1u << channel);
+}
+
+void dma_set_irq0_channel_mask_enabled(uint32_t channel_mask, bool enabled) {
+	if (enabled) dma_hw->inte0 |= channel_mask; else dma_hw->inte0 &= ~channel_mask;
+}
+
+void dma_channel_set_irq1_enabled(uint channel, bool enabled) {
+	if (enabled) dma_hw->inte1 |= 1u << channel; else dma_hw->inte1 &= ~(1u << channel);
+}
+
+void dma_set_irq1_channel_mask_enabled(uint32_t channel_mask, bool enabled) {
+	if (enabled) dma_hw->inte1 |= channel_mask; else dma_hw->inte1 &= ~channel_mask;
+}
+
+bool dma_channel_get_irq0_status(uint channel) { return dma_hw->ints0 & (1u << channel); }
+bool dma_channel_get_irq1_status(uint channel) { return dma_hw->ints1 & (1u << channel); }
+
+void dma_channel_acknowledge_irq0(uint channel) {
+	dma_hw->ints0 &= ~(1u << channel);
+	setReg(dma_hw->intr, dma_hw->intr & ~(1u << channel));
+}
+
+void dma_channel_acknowledge_irq1(uint channel) {
+	dma_hw->ints1 &= ~(1u << channel);
+	setReg(dma_hw->intr, dma_hw->intr & ~(1u << channel));
+}
+
+}
+
+//--------------------------------------------------------------------+
+// SPI
+//--------------------------------------------------------------------+
+
+void hostSPIAttach(spi_inst_t * spi, HostSPIDevice * device) {
+	spiStates[spi_get_index(spi)].device = device;
+}
+
+uint64_t hostSPIBytes(spi_inst_t * spi) {
+	return spiStates[spi_get_index(spi)].bytes;
+}
+
+extern "C" {
+
+uint spi_get_index(const spi_inst_t * spi) {
+	return (spi == spi1) ? 1 : 0;
+}
+
+spi_hw_t * spi_get_hw(spi_inst_t * spi) {
+	return reinterpret_cast<spi_hw_t *>(spi->regs);
+}
+
+uint spi_init(spi_inst_t * spi, uint baudrate) {
+	spiStates[spi_get_index(spi)].rx.clear();
+	return spi_set_baudrate(spi, baudrate);
+}
+
+void spi_deinit(spi_inst_t * spi) {
+	spiStates[spi_get_index(spi)].rx.clear();
+}
+
+uint spi_set_baudrate(spi_inst_t * spi, uint baudrate) {
+	spiStates[spi_get_index(spi)].baudrate = baudrate;
+	return baudrate;
+}
+
+uint spi_get_baudrate(const spi_inst_t * spi) {
+	return spiStates[spi_get_index(spi)].baudrate;
+}
+
+void spi_set_format(spi_inst_t * spi, uint data_bits, spi_cpol_t cpol, spi_cpha_t cpha, spi_order_t order) {
+	(void)spi; (void)data_bits; (void)cpol; (void)cpha; (void)order;
+}
+
+bool spi_is_writable(const spi_inst_t * spi) { (void)spi; return true; }
+bool spi_is_readable(const spi_inst_t * spi) { return spiRxReady(spi_get_index(spi)); }
+bool spi_is_busy(const spi_inst_t * spi) { (void)spi; return false; }
+
+int spi_write_read_blocking(spi_inst_t * spi, const uint8_t * src, uint8_t * dst, size_t len) {
+	uint block = spi_get_index(spi);
+	for (size_t i = 0; i < len; i++)
+		dst[i] = spiExchange(block, src[i]);
+	spendNs(len * spiByteNs(block));
+	return len;
+}
+
+int spi_write_blocking(spi_inst_t * spi, const uint8_t * src, size_t len) {
+	uint block = spi_get_index(spi);
+	for (size_t i = 0; i < len; i++)
+		spiExchange(block, src[i]);
+	spendNs(len * spiByteNs(block));
+	return len;
+}
+
+int spi_read_blocking(spi_inst_t * spi, uint8_t repeated_tx_data, uint8_t * dst, size_t len) {
+	uint block = spi_get_index(spi);
+	for (size_t i = 0; i < len; i++)
+		dst[i] = spiExchange(block, repeated_tx_data);
+	spendNs(len * spiByteNs(block));
+	return len;
+}
+
+int spi_write16_read16_blocking(spi_inst_t * spi, const uint16_t * src, uint16_t * dst, size_t len) {
+	uint block = spi_get_index(spi);
+	for (size_t i = 0; i < len; i++) {
+		uint8_t high = spiExchange(block, src[i] >> 8);
+		dst[i] = (high << 8) | spiExchange(block, src[i] & 0xff);
+	}
+	spendNs(2 * len * spiByteNs(block));
+	return len;
+}
+
+int spi_write16_blocking(spi_inst_t * spi, const uint16_t * src, size_t len) {
+	uint block = spi_get_index(spi);
+	for (size_t i = 0; i < len; i++) {
+		spiExchange(block, src[i] >> 8);
+		spiExchange(block, src[i] & 0xff);
+	}
+	spendNs(2 * len * spiByteNs(block));
+	return len;
+}
+
+int spi_read16_blocking(spi_inst_t * spi, uint16_t repeated_tx_data, uint16_t * dst, size_t len) {
+	uint block = spi_get_index(spi);
+	for (size_t i = 0; i < len; i++) {
+		uint8_t high = spiExchange(block, repeated_tx_data >> 8);
+		dst[i] = (high << 8) | spiExchange(block, repeated_tx_data & 0xff);
+	}
+	spendNs(2 * len * spiByteNs(block));
+	return len;
+}
+
+}
+
+//--------------------------------------------------------------------+
+// I2C
+//--------------------------------------------------------------------+
+
+void hostI2CAttach(i2c_inst_t * i2c, uint8_t address, HostI2CDevice * device) {
+	i2cStates[i2c_hw_index(i2c)].devices[address & 0x7f] = device;
+}
+
+void hostI2CDetach(i2c_inst_t * i2c, uint8_t address) {
+	i2cStates[i2c_hw_index(i2c)].devices.erase(address & 0x7f);
+}
+
+std::vector<HostI2CTransfer> & hostI2CLog() {
+	return i2cLog;
+}
+
+void hostI2CSetLogging(bool enabled) {
+	i2cLogging = enabled;
+}
+
+static void i2cRaise(uint block, uint32_t bits) {
+	I2CState & state = i2cStates[block];
+	state.pendingStat |= bits;
+	if (i2cHw(block)->intr_mask & bits)
+		hostIrqRaise(I2C0_IRQ + block);
+}
+
+// The interrupt sees the status gathered since the last one; reading the clear registers is a no-op here
+static void i2cIrqEnter(uint block) {
+	I2CState & state = i2cStates[block];
+	i2c_hw_t & hw = *i2cHw(block);
+	setReg(hw.raw_intr_stat, state.pendingStat);
+	setReg(hw.intr_stat, state.pendingStat & hw.intr_mask);
+	state.pendingStat = 0;
+}
+
+static void i2cIrqExit(uint block) {
+	i2c_hw_t & hw = *i2cHw(block);
+	setReg(hw.raw_intr_stat, 0u);
+	setReg(hw.intr_stat, 0u);
+	if (i2cStates[block].pendingStat & hw.intr_mask)
+		irqLines[I2C0_IRQ + block].pending = true;
+}
+
+// A new transfer is being set up, drop what an abort left behind
+static void i2cReset(uint block) {
+	I2CState & state = i2cStates[block];
+	state.aborted = false;
+	if (!state.active) {
+		state.rx.clear();
+		setReg(i2cHw(block)->rxflr, 0u);
+	}
+}
+
+static void i2cLogEnd(I2CState & state) {
+	if (state.logIndex >= 0) {
+		i2cLog[state.logIndex].endNs = virtualNs;
+		state.logIndex = -1;
+	}
+}
+
+// Run one IC_DATA_CMD entry and return the bus time it took
+static uint64_t i2cCommand(uint block, uint32_t command) {
+	I2CState & state = i2cStates[block];
+	if (state.aborted)
+		return 0;
+
+	uint64_t cost = i2cByteNs(block);
+	bool read = command & I2C_IC_DATA_CMD_CMD_BITS;
+	if (!state.active || (command & I2C_IC_DATA_CMD_RESTART_BITS) || read != state.reading) {
+		i2cLogEnd(state);
+		uint8_t address = i2cHw(block)->tar & 0x7f;
+		auto it = state.devices.find(address);
+		state.device = (it != state.devices.end()) ? it->second : nullptr;
+		bool ack = state.device != nullptr && state.device->start(read);
+		if (i2cLogging) {
+			HostI2CTransfer transfer = { (uint8_t)block, address, read, !ack, virtualNs, virtualNs, {} };
+			i2cLog.push_back(transfer);
+			state.logIndex = i2cLog.size() - 1;
+		}
+		cost += i2cByteNs(block);
+		if (!ack) {
+			// NAK: the controller flushes its FIFO and sends a stop
+			if (state.active && state.device != nullptr)
+				state.device->stop();
+			state.active = false;
+			state.aborted = true;
+			state.rx.clear();
+			setReg(i2cHw(block)->rxflr, 0u);
+			i2cLogEnd(state);
+			i2cRaise(block, I2C_IC_RAW_INTR_STAT_TX_ABRT_BITS | I2C_IC_RAW_INTR_STAT_STOP_DET_BITS);
+			return cost;
+		}
+		state.active = true;
+		state.reading = read;
+	}
+
+	uint8_t data;
+	if (read) {
+		data = state.device->read();
+		state.rx.push_back(data);
+		setReg(i2cHw(block)->rxflr, (uint32_t)state.rx.size());
+	} else {
+		data = command & I2C_IC_DATA_CMD_DAT_BITS;
+		state.device->write(data);
+	}
+	if (state.logIndex >= 0)
+		i2cLog[state.logIndex].data.push_back(data);
+
+	if (command & I2C_IC_DATA_CMD_STOP_BITS) {
+		state.device->stop();
+		state.active = false;
+		i2cLogEnd(state);
+		i2cRaise(block, I2C_IC_RAW_INTR_STAT_STOP_DET_BITS);
+	}
+	return cost;
+}
+
+static int i2cBlockingTransfer(i2c_inst_t * i2c, uint8_t addr, uint8_t * data, size_t len, bool nostop, bool read) {
+	uint block = i2c_hw_index(i2c);
+	if (len == 0)
+		return PICO_ERROR_GENERIC;
+	i2cHw(block)->tar = addr;
+	i2cReset(block);
+	uint64_t cost = 0;
+	for (size_t i = 0; i < len; i++) {
+		uint32_t command = read ? I2C_IC_DATA_CMD_CMD_BITS : data[i];
+		if (i == 0 && i2c->restart_on_next)
+			command |= I2C_IC_DATA_CMD_RESTART_BITS;
+		if (i == len - 1 && !nostop)
+			command |= I2C_IC_DATA_CMD_STOP_BITS;
+		cost += i2cCommand(block, command);
+		if (i2cStates[block].aborted) {
+			i2cStates[block].pendingStat = 0;
+			i2c->restart_on_next = false;
+			spendNs(cost);
+			return PICO_ERROR_GENERIC;
+		}
+		if (read) {
+			data[i] = i2cStates[block].rx.front();
+			i2cStates[block].rx.pop_front();
+		}
+	}
+	setReg(i2cHw(block)->rxflr, (uint32_t)i2cStates[block].rx.size());
+	i2cStates[block].pendingStat = 0;
+	i2c->restart_on_next = nostop;
+	spendNs(cost);
+	return len;
+}
+
+extern "C" {
+
+uint i2c_hw_index(i2c_inst_t * i2c) {
+	return (i2c == i2c1) ? 1 : 0;
+}
+
+i2c_hw_t * i2c_get_hw(i2c_inst_t * i2c) {
+	return reinterpret_cast<i2c_hw_t *>(i2c->regs);
+}
+
+uint i2c_init(i2c_inst_t * i2c, uint baudrate) {
+	i2c->restart_on_next = false;
+	i2c_get_hw(i2c)->enable = 1;
+	return i2c_set_baudrate(i2c, baudrate);
+}
+
+void i2c_deinit(i2c_inst_t * i2c) {
+	i2c_get_hw(i2c)->enable = 0;
+}
+
+uint i2c_set_baudrate(i2c_inst_t * i2c, uint baudrate) {
+	i2cStates[i2c_hw_index(i2c)].baudrate = baudrate;
+	return baudrate;
+}
+
+int i2c_write_blocking_until(i2c_inst_t * i2c, uint8_t addr, const uint8_t * src, size_t len, bool nostop, absolute_time_t until) {
+	(void)until;
+	return i2cBlockingTransfer(i2c, addr, const_cast<uint8_t *>(src), len, nostop, false);
+}
+
+int i2c_read_blocking_until(i2c_inst_t * i2c, uint8_t addr, uint8_t * dst, size_t len, bool nostop, absolute_time_t until) {
+	(void)until;
+	return i2cBlockingTransfer(i2c, addr, dst, len, nostop, true);
+}
+
+int i2c_write_timeout_us(i2c_inst_t * i2c, uint8_t addr, const uint8_t * src, size_t len, bool nostop, uint timeout_us) {
+	(void)timeout_us;
+	return i2cBlockingTransfer(i2c, addr, const_cast<uint8_t *>(src), len, nostop, false);
+}
+
+int i2c_read_timeout_us(i2c_inst_t * i2c, uint8_t addr, uint8_t * dst, size_t len, bool nostop, uint timeout_us) {
+	(void)timeout_us;
+	return i2cBlockingTransfer(i2c, addr, dst, len, nostop, true);
+}
+
+int i2c_write_blocking(i2c_inst_t * i2c, uint8_t addr, const uint8_t * src, size_t len, bool nostop) {
+	return i2cBlockingTransfer(i2c, addr, const_cast<uint8_t *>(src), len, nostop, false);
+}
+
+int i2c_read_blocking(i2c_inst_t * i2c, uint8_t addr, uint8_t * dst, size_t len, bool nostop) {
+	return i2cBlockingTransfer(i2c, addr, dst, len, nostop, true);
+}
+
+}
+
+//--------------------------------------------------------------------+
+// PIO
+//--------------------------------------------------------------------+
+
+void hostPIOAttach(PIO pio, uint sm, HostPIODevice * device) {
+	pioStates[pio_get_index(pio)].sm[sm].device = device;
+}
+
+void hostPIOPushRx(PIO pio, uint sm, uint32_t data) {
+	std::deque<uint32_t> & rx = pioStates[pio_get_index(pio)].sm[sm].rx;
+	// a full RX FIFO stalls the program, the word is lost here
+	if (rx.size() < 4)
+		rx.push_back(data);
+}
+
+uint64_t hostPIOTxWords(PIO pio, uint sm) {
+	return pioStates[pio_get_index(pio)].sm[sm].txWords;
+}
+
+extern "C" {
+
+bool pio_can_add_program(PIO pio, const pio_program_t * program) {
+	return pioStates[pio_get_index(pio)].usedInstructions + program->length <= 32;
+}
+
+int pio_add_program(PIO pio, const pio_program_t * program) {
+	PioState & state = pioStates[pio_get_index(pio)];
+	if (state.usedInstructions + program->length > 32)
+		return PICO_ERROR_GENERIC;
+	int offset = state.usedInstructions;
+	state.usedInstructions += program->length;
+	return offset;
+}
+
+void pio_remove_program(PIO pio, const pio_program_t * program, uint loaded_offset) {
+	(void)pio; (void)program; (void)loaded_offset;
+}
+
+void pio_sm_claim(PIO pio, uint sm) { pioStates[pio_get_index(pio)].sm[sm].claimed = true; }
+void pio_sm_unclaim(PIO pio, uint sm) { pioStates[pio_get_index(pio)].sm[sm].claimed = false; }
+bool pio_sm_is_claimed(PIO pio, uint sm) { return pioStates[pio_get_index(pio)].sm[sm].claimed; }
+
+int pio_claim_unused_sm(PIO pio, bool required) {
+	for (uint sm = 0; sm < NUM_PIO_STATE_MACHINES; sm++) {
+		if (!pio_sm_is_claimed(pio, sm)) {
+			pio_sm_claim(pio, sm);
+			return sm;
+		}
+	}
+	if (required) {
+		fprintf(stderr, "hostsim: no PIO state machine free\n");
+		abort();
+	}
+	return -1;
+}
+
+pio_sm_config pio_get_default_sm_config(void) {
+	pio_sm_config config = { 1u << 16, 0x1fu << 12, 0, 0 };
+	return config;
+}
+
+void sm_config_set_out_pins(pio_sm_config * c, uint out_base, uint out_count) { (void)c; (void)out_base; (void)out_count; }
+void sm_config_set_set_pins(pio_sm_config * c, uint set_base, uint set_count) { (void)c; (void)set_base; (void)set_count; }
+void sm_config_set_in_pins(pio_sm_config * c, uint in_base) { (void)c; (void)in_base; }
+void sm_config_set_sideset_pins(pio_sm_config * c, uint sideset_base) { (void)c; (void)sideset_base; }
+void sm_config_set_sideset(pio_sm_config * c, uint bit_count, bool optional, bool pindirs) { (void)c; (void)bit_count; (void)optional; (void)pindirs; }
+void sm_config_set_clkdiv(pio_sm_config * c, float div) { c->clkdiv = (uint32_t)(div * 256.0f) << 8; }
+void sm_config_set_clkdiv_int_frac(pio_sm_config * c, uint16_t div_int, uint8_t div_frac) { c->clkdiv = ((uint32_t)div_int << 16) | ((uint32_t)div_frac << 8); }
+void sm_config_set_wrap(pio_sm_config * c, uint wrap_target, uint wrap) { c->execctrl = (c->execctrl & ~0x1ff80u) | (wrap_target << 7) | (wrap << 12); }
+void sm_config_set_jmp_pin(pio_sm_config * c, uint pin) { (void)c; (void)pin; }
+void sm_config_set_in_shift(pio_sm_config * c, bool shift_right, bool autopush, uint push_threshold) { (void)c; (void)shift_right; (void)autopush; (void)push_threshold; }
+void sm_config_set_out_shift(pio_sm_config * c, bool shift_right, bool autopull, uint pull_threshold) { (void)c; (void)shift_right; (void)autopull; (void)pull_threshold; }
+void sm_config_set_fifo_join(pio_sm_config * c, enum pio_fifo_join join) { (void)c; (void)join; }
+
+void pio_gpio_init(PIO pio, uint pin) {
+	gpio_set_function(pin, pio_get_index(pio) ? GPIO_FUNC_PIO1 : GPIO_FUNC_PIO0);
+}
+
+int pio_sm_init(PIO pio, uint sm, uint initial_pc, const pio_sm_config * config) {
+	(void)initial_pc; (void)config;
+	pio_sm_clear_fifos(pio, sm);
+	return PICO_OK;
+}
+
+void pio_sm_set_enabled(PIO pio, uint sm, bool enabled) {
+	if (enabled) pio->ctrl |= 1u << sm; else pio->ctrl &= ~(1u << sm);
+}
+
+void pio_sm_restart(PIO pio, uint sm) { (void)pio; (void)sm; }
+void pio_sm_clear_fifos(PIO pio, uint sm) { pioStates[pio_get_index(pio)].sm[sm].rx.clear(); }
+void pio_sm_exec(PIO pio, uint sm, uint instr) { (void)pio; (void)sm; (void)instr; }
+void pio_sm_set_pins(PIO pio, uint sm, uint32_t pin_values) { (void)pio; (void)sm; (void)pin_values; }
+void pio_sm_set_pins_with_mask(PIO pio, uint sm, uint32_t pin_values, uint32_t pin_mask) { (void)pio; (void)sm; (void)pin_values; (void)pin_mask; }
+void pio_sm_set_pindirs_with_mask(PIO pio, uint sm, uint32_t pin_dirs, uint32_t pin_mask) { (void)pio; (void)sm; (void)pin_dirs; (void)pin_mask; }
+int pio_sm_set_consecutive_pindirs(PIO pio, uint sm, uint pin_base, uint pin_count, bool is_out) { (void)pio; (void)sm; (void)pin_base; (void)pin_count; (void)is_out; return PICO_OK; }
+
+void pio_sm_put(PIO pio, uint sm, uint32_t data) {
+	PioStateMachine & state = pioStates[pio_get_index(pio)].sm[sm];
+	state.txWords++;
+	if (state.device != nullptr)
+		state.device->put(data);
+}
+
+void pio_sm_put_blocking(PIO pio, uint sm, uint32_t data) {
+	PioStateMachine & state = pioStates[pio_get_index(pio)].sm[sm];
+	if (state.device != nullptr)
+		spendNs(state.device->wordNs());
+	pio_sm_put(pio, sm, data);
+}
+
+uint32_t pio_sm_get(PIO pio, uint sm) {
+	std::deque<uint32_t> & rx = pioStates[pio_get_index(pio)].sm[sm].rx;
+	if (rx.empty())
+		return 0;
+	uint32_t data = rx.front();
+	rx.pop_front();
+	return data;
+}
+
+uint32_t pio_sm_get_blocking(PIO pio, uint sm) {
+	// nothing may ever arrive without a device, give up after a simulated second
+	for (uint32_t spins = 0; pio_sm_is_rx_fifo_empty(pio, sm) && spins < 10000000; spins++)
+		tight_loop_contents();
+	return pio_sm_get(pio, sm);
+}
+
+bool pio_sm_is_rx_fifo_full(PIO pio, uint sm) { return pioStates[pio_get_index(pio)].sm[sm].rx.size() >= 4; }
+bool pio_sm_is_rx_fifo_empty(PIO pio, uint sm) { return pioStates[pio_get_index(pio)].sm[sm].rx.empty(); }
+uint pio_sm_get_rx_fifo_level(PIO pio, uint sm) { return pioStates[pio_get_index(pio)].sm[sm].rx.size(); }
+// The program takes words as they are written
+bool pio_sm_is_tx_fifo_full(PIO pio, uint sm) { (void)pio; (void)sm; return false; }
+bool pio_sm_is_tx_fifo_empty(PIO pio, uint sm) { (void)pio; (void)sm; return true; }
+uint pio_sm_get_tx_fifo_level(PIO pio, uint sm) { (void)pio; (void)sm; return 0; }
+void pio_sm_drain_tx_fifo(PIO pio, uint sm) { (void)pio; (void)sm; }
+
+}
+
+//--------------------------------------------------------------------+
+// PWM, clocks, watchdog, misc
+//--------------------------------------------------------------------+
+
+extern "C" {
+
+pwm_config pwm_get_default_config(void) {
+	pwm_config config = { 0, 1u << 4, 0xffff };
+	return config;
+}
+void pwm_config_set_clkdiv(pwm_config * c, float div) { c->div = (uint32_t)(div * 16.0f); }
+void pwm_config_set_clkdiv_int_frac(pwm_config * c, uint8_t integer, uint8_t fract) { c->div = ((uint32_t)integer << 4) | fract; }
+void pwm_config_set_wrap(pwm_config * c, uint16_t wrap) { c->top = wrap; }
+void pwm_init(uint slice_num, pwm_config * c, bool start) { (void)slice_num; (void)c; (void)start; }
+void pwm_set_wrap(uint slice_num, uint16_t wrap) { (void)slice_num; (void)wrap; }
+void pwm_set_chan_level(uint slice_num, uint chan, uint16_t level) { (void)slice_num; (void)chan; (void)level; }
+void pwm_set_both_levels(uint slice_num, uint16_t level_a, uint16_t level_b) { (void)slice_num; (void)level_a; (void)level_b; }
+void pwm_set_gpio_level(uint gpio, uint16_t level) { (void)gpio; (void)level; }
+void pwm_set_enabled(uint slice_num, bool enabled) { (void)slice_num; (void)enabled; }
+void pwm_set_clkdiv(uint slice_num, float divider) { (void)slice_num; (void)divider; }
+void pwm_set_clkdiv_int_frac(uint slice_num, uint8_t integer, uint8_t fract) { (void)slice_num; (void)integer; (void)fract; }
+
+static uint32_t sysClockKhz = 125000;
+
+uint32_t clock_get_hz(clock_handle_t clock) {
+	switch (clock) {
+		case clk_sys: return sysClockKhz * 1000;
+		case clk_peri: return sysClockKhz * 1000;
+		case clk_usb:
+		case clk_adc: return 48000000;
+		case clk_ref: return 12000000;
+		default: return 0;
+	}
+}
+
+bool set_sys_clock_khz(uint32_t freq_khz, bool required) {
+	(void)required;
+	sysClockKhz = freq_khz;
+	return true;
+}
+
+bool stdio_init_all(void) {
+	return true;
+}
+
+void watchdog_reboot(uint32_t pc, uint32_t sp, uint32_t delay_ms) {
+	(void)pc; (void)sp; (void)delay_ms;
+	watchdogReboot = true;
+	throw HostReboot();
+}
+
+bool watchdog_caused_reboot(void) {
+	return watchdogReboot;
+}
+
+bool watchdog_enable_caused_reboot(void) {
+	return watchdogReboot;
+}
+
+void watchdog_enable(uint32_t delay_ms, bool pause_on_debug) {
+	(void)delay_ms; (void)pause_on_debug;
+}
+
+void watchdog_update(void) {}
+
+void reset_usb_boot(uint32_t usb_activity_gpio_pin_mask, uint32_t disable_interface_mask) {
+	(void)usb_activity_gpio_pin_mask; (void)disable_interface_mask;
+	throw HostReboot();
+}
+
+void multicore_launch_core1(void (*entry)(void)) { (void)entry; }
+void multicore_reset_core1(void) {}
+void multicore_lockout_victim_init(void) {}
+bool multicore_lockout_victim_is_initialized(uint core_num) { (void)core_num; return false; }
+void multicore_lockout_start_blocking(void) {}
+bool multicore_lockout_start_timeout_us(uint64_t timeout_us) { (void)timeout_us; return true; }
+void multicore_lockout_end_blocking(void) {}
+bool multicore_lockout_end_timeout_us(uint64_t timeout_us) { (void)timeout_us; return true; }
+
+void pico_get_unique_board_id(pico_unique_board_id_t * id_out) {
+	static const uint8_t id[PICO_UNIQUE_BOARD_ID_SIZE_BYTES] = { 0xe6, 0x60, 0x58, 0x38, 0x83, 0x1b, 0x2a, 0x31 };
+	memcpy(id_out->id, id, sizeof(id));
+}
+
+void pico_get_unique_board_id_string(char * id_out, uint len) {
+	pico_unique_board_id_t id;
+	pico_get_unique_board_id(&id);
+	uint i = 0;
+	for (; i < 2 * PICO_UNIQUE_BOARD_ID_SIZE_BYTES && i + 1 < len; i++) {
+		uint nibble = (id.id[i / 2] >> ((i & 1) ? 0 : 4)) & 0xf;
+		id_out[i] = nibble < 10 ? '0' + nibble : 'A' + nibble - 10;
+	}
+	if (len > 0) id_out[i] = 0;
+}
+
+int rndis_init(void) { return 0; }
+void rndis_task(void) {}
+
+}
+
+//--------------------------------------------------------------------+
+// Flash
+//--------------------------------------------------------------------+
+
+void hostFlashErase(uint8_t fill) {
+	memset(hostFlashImage, fill, sizeof(hostFlashImage));
+}
+
+const HostFlashStats & hostFlashStats() {
+	return flashStats;
+}
+
+void hostFlashResetStats() {
+	memset(&flashStats, 0, sizeof(flashStats));
+	memset(flashSectorErases, 0, sizeof(flashSectorErases));
+	flashOperations = 0;
+}
+
+uint32_t hostFlashSectorErases(uint32_t flash_offs) {
+	return flashSectorErases[(flash_offs % PICO_FLASH_SIZE_BYTES) / FLASH_SECTOR_SIZE];
+}
+
+void hostFlashSetPowerCut(int64_t operation) {
+	flashPowerCut = (operation < 0) ? -1 : (int64_t)flashOperations + operation;
+}
+
+uint64_t hostFlashOperations() {
+	return flashOperations;
+}
+
+void hostFlashSetTimed(bool timed) {
+	flashTimed = timed;
+}
+
+static void flashOperation(uint8_t * target, const uint8_t * data, size_t length) {
+	bool cut = flashPowerCut >= 0 && (int64_t)flashOperations == flashPowerCut;
+	uint64_t operation = flashOperations++;
+	// an interrupted operation gets through half of its bytes
+	size_t done = cut ? length / 2 : length;
+	for (size_t i = 0; i < done; i++)
+		target[i] = data ? (target[i] & data[i]) : 0xff;
+	if (cut) {
+		flashPowerCut = -1;
+		throw HostFlashPowerCut{ (uint32_t)operation };
+	}
+}
+
+static void flashCall(uint64_t us) {
+	flashStats.busyUs += us;
+	if (us > flashStats.worstCallUs)
+		flashStats.worstCallUs = us;
+	if (flashTimed)
+		spendNs(us * 1000);
+}
+
+extern "C" {
+
+void flash_range_erase(uint32_t flash_offs, size_t count) {
+	if ((flash_offs % FLASH_SECTOR_SIZE) || (count % FLASH_SECTOR_SIZE) || flash_offs + count > PICO_FLASH_SIZE_BYTES) {
+		fprintf(stderr, "hostsim: bad flash erase %08x+%zx\n", flash_offs, count);
+		abort();
+	}
+	flashStats.eraseCalls++;
+	uint64_t us = 0;
+	for (size_t offset = 0; offset < count; offset += FLASH_SECTOR_SIZE) {
+		flashStats.sectorsErased++;
+		flashSectorErases[(flash_offs + offset) / FLASH_SECTOR_SIZE]++;
+		flashStats.bytesErased += FLASH_SECTOR_SIZE;
+		us += HOST_FLASH_SECTOR_ERASE_US;
+		try {
+			flashOperation(hostFlashImage + flash_offs + offset, nullptr, FLASH_SECTOR_SIZE);
+		} catch (...) {
+			flashCall(us);
+			throw;
+		}
+	}
+	flashCall(us);
+}
+
+void flash_range_program(uint32_t flash_offs, const uint8_t * data, size_t count) {
+	if ((flash_offs % FLASH_PAGE_SIZE) || (count % FLASH_PAGE_SIZE) || flash_offs + count > PICO_FLASH_SIZE_BYTES) {
+		fprintf(stderr, "hostsim: bad flash program %08x+%zx\n", flash_offs, count);
+		abort();
+	}
+	flashStats.programCalls++;
+	uint64_t us = 0;
+	for (size_t offset = 0; offset < count; offset += FLASH_PAGE_SIZE) {
+		flashStats.pagesProgrammed++;
+		flashStats.bytesProgrammed += FLASH_PAGE_SIZE;
+		us += HOST_FLASH_PAGE_PROGRAM_US;
+		try {
+			flashOperation(hostFlashImage + flash_offs + offset, data + offset, FLASH_PAGE_SIZE);
+		} catch (...) {
+			flashCall(us);
+			throw;
+		}
+	}
+	flashCall(us);
+}
+
+void flash_get_unique_id(uint8_t * id_out) {
+	pico_unique_board_id_t id;
+	pico_get_unique_board_id(&id);
+	memcpy(id_out, id.id, FLASH_UNIQUE_ID_SIZE_BYTES);
+}
+
+void flash_do_cmd(const uint8_t * txbuf, uint8_t * rxbuf, size_t count) {
+	memset(rxbuf, 0, count);
+	// JEDEC ID: Winbond, W25Q, capacity as a power of two
+	if (count >= 4 && txbuf[0] == 0x9f) {
+		rxbuf[1] = 0xef;
+		rxbuf[2] = 0x40;
+		rxbuf[3] = __builtin_ctz(PICO_FLASH_SIZE_BYTES);
+	}
+}
+
+}
+
+//--------------------------------------------------------------------+
+// USB device
+//--------------------------------------------------------------------+
+
+void hostUSBSetMounted(bool mounted) {
+	if (usb.mounted == mounted)
+		return;
+	usb.mounted = mounted;
+	if (usb.inited) {
+		if (mounted) tud_mount_cb();
+		else tud_umount_cb();
+	}
+}
+
+void hostUSBSetPollIntervalUs(uint32_t us) {
+	usb.pollIntervalUs = us ? us : 1;
+	usb.pollFrames = 0;
+}
+
+void hostUSBSetPollSchedule(uint32_t intervalFrames, uint32_t phaseUs, uint32_t jitterUs) {
+	usb.pollFrames = intervalFrames;
+	usb.pollPhaseUs = phaseUs;
+	usb.pollJitterUs = jitterUs;
+}
+
+// IN token of a polled frame, the jitter is fixed per frame so the token doesn't move while a report waits for it
+static uint64_t usbPollTokenNs(uint64_t frame) {
+	uint64_t jitterNs = 0;
+	if (usb.pollJitterUs != 0)
+		jitterNs = (uint32_t)(frame * 2654435761u) % (usb.pollJitterUs * 1000 + 1);
+	return usb.frameBaseNs + frame * HOST_USB_FRAME_NS + usb.pollPhaseUs * 1000ull + jitterNs;
+}
+
+uint64_t hostUSBReportCount() {
+	return usb.reportCount;
+}
+
+const HostUSBReport & hostUSBLastReport() {
+	return usb.last;
+}
+
+void hostUSBSetLogging(bool enabled) {
+	usb.logging = enabled;
+}
+
+std::vector<HostUSBReport> & hostUSBLog() {
+	return usb.log;
+}
+
+// Frames and IN tokens, raised as USB interrupt events
+static void progressUsb(uint64_t now) {
+	if (!usb.inited)
+		return;
+	while (usb.nextFrameNs <= now) {
+		usb.nextFrameNs += HOST_USB_FRAME_NS;
+		usb.frame++;
+		if (usb.sofEnabled)
+			usbEventsPending = true;
+	}
+	if (usb.busy && usb.nextPollNs <= now) {
+		usb.busy = false;
+		usb.completePending = true;
+		usb.pending.timeNs = usb.nextPollNs;
+		usb.last = usb.pending;
+		usb.reportCount++;
+		if (usb.logging)
+			usb.log.push_back(usb.pending);
+		usb_dpram->ep_buf_ctrl[usb.inEndpoint].in &= ~USB_BUF_CTRL_AVAIL;
+		usbEventsPending = true;
+	}
+}
+
+static uint32_t usbSofFrame = 0;
+
+static void runUsbEvents() {
+	if (usb.sofEnabled && usbSofFrame != usb.frame) {
+		usbSofFrame = usb.frame;
+		if (usb.driver != nullptr && usb.driver->sof != nullptr)
+			usb.driver->sof(0, usb.frame & 0x7ff);
+	}
+	if (usb.completePending) {
+		usb.completePending = false;
+		tud_event_hook_cb(0, DCD_EVENT_XFER_COMPLETE, true);
+		tud_hid_report_complete_cb(usb.pending.instance, usb.pending.data.data(), usb.pending.data.size());
+	}
+}
+
+extern "C" {
+
+TU_ATTR_WEAK usbd_class_driver_t const * usbd_app_driver_get_cb(uint8_t * driver_count) {
+	*driver_count = 0;
+	return nullptr;
+}
+
+TU_ATTR_WEAK uint16_t tud_hid_get_report_cb(uint8_t instance, uint8_t report_id, hid_report_type_t report_type, uint8_t * buffer, uint16_t reqlen) {
+	(void)instance; (void)report_id; (void)report_type; (void)buffer; (void)reqlen;
+	return 0;
+}
+
+TU_ATTR_WEAK void tud_hid_set_report_cb(uint8_t instance, uint8_t report_id, hid_report_type_t report_type, uint8_t const * buffer, uint16_t bufsize) {
+	(void)instance; (void)report_id; (void)report_type; (void)buffer; (void)bufsize;
+}
+
+TU_ATTR_WEAK void tud_hid_report_complete_cb(uint8_t instance, uint8_t const * report, uint16_t len) {
+	(void)instance; (void)report; (void)len;
+}
+
+TU_ATTR_WEAK void tud_event_hook_cb(uint8_t rhport, uint32_t eventid, bool in_isr) {
+	(void)rhport; (void)eventid; (void)in_isr;
+}
+
+TU_ATTR_WEAK void tud_mount_cb(void) {}
+TU_ATTR_WEAK void tud_umount_cb(void) {}
+TU_ATTR_WEAK void tud_suspend_cb(bool remote_wakeup_en) { (void)remote_wakeup_en; }
+TU_ATTR_WEAK void tud_resume_cb(void) {}
+
+TU_ATTR_WEAK uint8_t const * tud_descriptor_configuration_cb(uint8_t index) {
+	(void)index;
+	return nullptr;
+}
+
+bool tud_init(uint8_t rhport) {
+	(void)rhport;
+	uint8_t count = 0;
+	const usbd_class_driver_t * driver = usbd_app_driver_get_cb(&count);
+	usb.driver = (count > 0) ? driver : nullptr;
+	if (usb.driver != nullptr && usb.driver->init != nullptr)
+		usb.driver->init();
+
+	// Reports go out on the first interrupt IN endpoint of the configuration
+	usb.inEndpoint = 1;
+	const uint8_t * desc = tud_descriptor_configuration_cb(0);
+	if (desc != nullptr) {
+		const uint8_t * end = desc + tu_le16toh(((const tusb_desc_configuration_t *)desc)->wTotalLength);
+		for (; desc < end; desc = tu_desc_next(desc)) {
+			if (tu_desc_type(desc) != TUSB_DESC_ENDPOINT)
+				continue;
+			const tusb_desc_endpoint_t * endpoint = (const tusb_desc_endpoint_t *)desc;
+			if (endpoint->bmAttributes.xfer == TUSB_XFER_INTERRUPT && tu_edpt_dir(endpoint->bEndpointAddress) == TUSB_DIR_IN) {
+				usb.inEndpoint = tu_edpt_number(endpoint->bEndpointAddress);
+				break;
+			}
+		}
+	}
+
+	usb.inited = true;
+	usb.frame = 0;
+	usb.frameBaseNs = hostTimeNs();
+	usb.nextFrameNs = usb.frameBaseNs + HOST_USB_FRAME_NS;
+	if (usb.mounted)
+		tud_mount_cb();
+	return true;
+}
+
+bool tud_inited(void) { return usb.inited; }
+void tud_task(void) { hostPoll(); }
+bool tud_task_event_ready(void) { return false; }
+bool tud_mounted(void) { return usb.inited && usb.mounted; }
+bool tud_ready(void) { return tud_mounted(); }
+bool tud_suspended(void) { return false; }
+bool tud_remote_wakeup(void) { return false; }
+bool tud_disconnect(void) { return true; }
+bool tud_connect(void) { return true; }
+tusb_speed_t tud_speed_get(void) { return TUSB_SPEED_FULL; }
+
+bool tud_control_xfer(uint8_t rhport, tusb_control_request_t const * request, void * buffer, uint16_t len) {
+	(void)rhport; (void)request; (void)buffer; (void)len;
+	return true;
+}
+
+bool tud_control_status(uint8_t rhport, tusb_control_request_t const * request) {
+	(void)rhport; (void)request;
+	return true;
+}
+
+bool tud_hid_n_ready(uint8_t instance) {
+	(void)instance;
+	return tud_ready() && !usb.busy;
+}
+
+// The endpoint holds the report until the host's next IN token
+bool tud_hid_n_report(uint8_t instance, uint8_t report_id, void const * report, uint16_t len) {
+	if (!tud_hid_n_ready(instance))
+		return false;
+	usb.pending.instance = instance;
+	usb.pending.reportId = report_id;
+	usb.pending.timeNs = 0;
+	usb.pending.data.clear();
+	if (report_id != 0)
+		usb.pending.data.push_back(report_id);
+	usb.pending.data.insert(usb.pending.data.end(), (const uint8_t *)report, (const uint8_t *)report + len);
+	usb.busy = true;
+	uint64_t now = hostTimeNs();
+	usb.pending.queuedNs = now;
+	if (usb.pollFrames != 0) {
+		uint64_t frame = (now - usb.frameBaseNs) / HOST_USB_FRAME_NS;
+		frame -= frame % usb.pollFrames;
+		while (usbPollTokenNs(frame) <= now)
+			frame += usb.pollFrames;
+		usb.nextPollNs = usbPollTokenNs(frame);
+	} else {
+		uint64_t interval = usb.pollIntervalUs * 1000ull;
+		usb.nextPollNs = (now / interval + 1) * interval;
+	}
+	usb_dpram->ep_buf_ctrl[usb.inEndpoint].in |= USB_BUF_CTRL_AVAIL;
+	return true;
+}
+
+void hidd_init(void) {}
+bool hidd_deinit(void) { return true; }
+void hidd_reset(uint8_t rhport) { (void)rhport; }
+uint16_t hidd_open(uint8_t rhport, tusb_desc_interface_t const * desc_itf, uint16_t max_len) {
+	(void)rhport; (void)desc_itf; (void)max_len;
+	return 0;
+}
+bool hidd_control_xfer_cb(uint8_t rhport, uint8_t stage, tusb_control_request_t const * request) {
+	(void)rhport; (void)stage; (void)request;
+	return true;
+}
+bool hidd_xfer_cb(uint8_t rhport, uint8_t ep_addr, xfer_result_t event, uint32_t xferred_bytes) {
+	(void)rhport; (void)ep_addr; (void)event; (void)xferred_bytes;
+	return true;
+}
+
+void usbd_sof_enable(uint8_t rhport, sof_consumer_t consumer, bool en) {
+	(void)rhport; (void)consumer;
+	usb.sofEnabled = en;
+}
+
+bool usbd_open_edpt_pair(uint8_t rhport, uint8_t const * p_desc, uint8_t ep_count, uint8_t xfer_type, uint8_t * ep_out, uint8_t * ep_in) {
+	(void)rhport; (void)p_desc; (void)ep_count; (void)xfer_type; (void)ep_out; (void)ep_in;
+	return true;
+}
+void usbd_defer_func(void (*func)(void *), void * param, bool in_isr) { (void)in_isr; func(param); }
+bool usbd_edpt_open(uint8_t rhport, tusb_desc_endpoint_t const * desc_ep) { (void)rhport; (void)desc_ep; return true; }
+void usbd_edpt_close(uint8_t rhport, uint8_t ep_addr) { (void)rhport; (void)ep_addr; }
+bool usbd_edpt_xfer(uint8_t rhport, uint8_t ep_addr, uint8_t * buffer, uint16_t total_bytes) { (void)rhport; (void)ep_addr; (void)buffer; (void)total_bytes; return true; }
+bool usbd_edpt_claim(uint8_t rhport, uint8_t ep_addr) { (void)rhport; (void)ep_addr; return true; }
+bool usbd_edpt_release(uint8_t rhport, uint8_t ep_addr) { (void)rhport; (void)ep_addr; return true; }
+bool usbd_edpt_busy(uint8_t rhport, uint8_t ep_addr) { (void)rhport; (void)ep_addr; return false; }
+void usbd_edpt_stall(uint8_t rhport, uint8_t ep_addr) { (void)rhport; (void)ep_addr; }
+void usbd_edpt_clear_stall(uint8_t rhport, uint8_t ep_addr) { (void)rhport; (void)ep_addr; }
+bool usbd_edpt_stalled(uint8_t rhport, uint8_t ep_addr) { (void)rhport; (void)ep_addr; return false; }
+
+//--------------------------------------------------------------------+
+// USB host, nothing is ever plugged in
+//--------------------------------------------------------------------+
+
+bool tuh_configure(uint8_t rhport, uint32_t cfg_id, const void * cfg_param) { (void)rhport; (void)cfg_id; (void)cfg_param; return true; }
+bool tuh_init(uint8_t rhport) { (void)rhport; return true; }
+bool tuh_deinit(uint8_t rhport) { (void)rhport; return true; }
+bool tuh_inited(void) { return true; }
+void tuh_task(void) {}
+bool tuh_mounted(uint8_t daddr) { (void)daddr; return false; }
+bool tuh_ready(uint8_t daddr) { (void)daddr; return false; }
+bool tuh_vid_pid_get(uint8_t daddr, uint16_t * vid, uint16_t * pid) { (void)daddr; *vid = 0; *pid = 0; return false; }
+bool tuh_control_xfer(tuh_xfer_t * xfer) { (void)xfer; return false; }
+bool tuh_edpt_open(uint8_t daddr, tusb_desc_endpoint_t const * desc_ep) { (void)daddr; (void)desc_ep; return false; }
+
+uint8_t tuh_hid_instance_count(uint8_t dev_addr) { (void)dev_addr; return 0; }
+bool tuh_hid_mounted(uint8_t dev_addr, uint8_t idx) { (void)dev_addr; (void)idx; return false; }
+uint8_t tuh_hid_interface_protocol(uint8_t dev_addr, uint8_t idx) { (void)dev_addr; (void)idx; return 0; }
+uint8_t tuh_hid_parse_report_descriptor(tuh_hid_report_info_t * reports_info_arr, uint8_t arr_count, uint8_t const * desc_report, uint16_t desc_len) {
+	(void)reports_info_arr; (void)arr_count; (void)desc_report; (void)desc_len;
+	return 0;
+}
+bool tuh_hid_get_report(uint8_t dev_addr, uint8_t idx, uint8_t report_id, uint8_t report_type, void * report, uint16_t len) {
+	(void)dev_addr; (void)idx; (void)report_id; (void)report_type; (void)report; (void)len;
+	return false;
+}
+bool tuh_hid_set_report(uint8_t dev_addr, uint8_t idx, uint8_t report_id, uint8_t report_type, void * report, uint16_t len) {
+	(void)dev_addr; (void)idx; (void)report_id; (void)report_type; (void)report; (void)len;
+	return false;
+}
+bool tuh_hid_receive_report(uint8_t dev_addr, uint8_t idx) { (void)dev_addr; (void)idx; return false; }
+bool tuh_hid_send_report(uint8_t dev_addr, uint8_t idx, uint8_t report_id, const void * report, uint16_t len) {
+	(void)dev_addr; (void)idx; (void)report_id; (void)report; (void)len;
+	return false;
+}
+
+void usbh_driver_set_config_complete(uint8_t dev_addr, uint8_t itf_num) { (void)dev_addr; (void)itf_num; }
+bool usbh_edpt_xfer_with_callback(uint8_t dev_addr, uint8_t ep_addr, uint8_t * buffer, uint16_t total_bytes, tuh_xfer_cb_t complete_cb, uintptr_t user_data) {
+	(void)dev_addr; (void)ep_addr; (void)buffer; (void)total_bytes; (void)complete_cb; (void)user_data;
+	return false;
+}
+bool usbh_edpt_claim(uint8_t dev_addr, uint8_t ep_addr) { (void)dev_addr; (void)ep_addr; return false; }
+bool usbh_edpt_release(uint8_t dev_addr, uint8_t ep_addr) { (void)dev_addr; (void)ep_addr; return true; }
+bool usbh_edpt_busy(uint8_t dev_addr, uint8_t ep_addr) { (void)dev_addr; (void)ep_addr; return false; }
+
+}
+
+//--------------------------------------------------------------------+
+// Scheduling
+//--------------------------------------------------------------------+
+
+// Hardware that runs on its own: timers, device models, the ADC, DMA, PIO programs and the USB controller
+static void progress() {
+	if (progressing)
+		return;
+	progressing = true;
+	uint64_t now = virtualNs;
+
+	progressTimer();
+	progressDeviceEvents(now);
+
+	if (adc.running) {
+		if (now > adc.nextSampleNs + HOST_ADC_MAX_CATCHUP * adc.periodNs)
+			adc.nextSampleNs = now - HOST_ADC_MAX_CATCHUP * adc.periodNs;
+		while (adc.nextSampleNs <= now) {
+			uint16_t value = adcConvert();
+			if (adc.fifoEnabled) {
+				if (adc.fifo.size() >= 4) adc.over = true;
+				else adc.fifo.push_back(value);
+			}
+			adcSync();
+			// the DMA keeps up with each conversion
+			dmaStep(adc.nextSampleNs);
+			adc.nextSampleNs += adc.periodNs;
+		}
+	}
+
+	while (dmaStep(now)) {}
+
+	for (uint i = 0; i < NUM_PIOS; i++) {
+		PIO pio = i ? pio1 : pio0;
+		for (uint sm = 0; sm < NUM_PIO_STATE_MACHINES; sm++) {
+			if (pioStates[i].sm[sm].device != nullptr && (pio->ctrl & (1u << sm)))
+				pioStates[i].sm[sm].device->run(now);
+		}
+	}
+
+	progressUsb(now);
+	progressing = false;
+}
+
+void hostReset() {
+	alarms.clear();
+	deviceEvents.clear();
+	nextAlarmId = 1;
+	memset(hardwareAlarmCallbacks, 0, sizeof(hardwareAlarmCallbacks));
+	hardwareAlarmArmed = 0;
+	for (uint i = 0; i < IRQ_COUNT; i++) {
+		irqLines[i].enabled = false;
+		irqLines[i].pending = false;
+		irqLines[i].handlers.clear();
+	}
+	interruptsMasked = false;
+	irqDepth = 0;
+	alarmsPending = false;
+	usbEventsPending = false;
+	spinLocksClaimed = 0;
+
+	memset(&sioBlock, 0, sizeof(sioBlock));
+	memset(&timerBlock, 0, sizeof(timerBlock));
+	memset(timerAlarmSeen, 0, sizeof(timerAlarmSeen));
+	memset(&adcBlock, 0, sizeof(adcBlock));
+	memset(&dmaBlock, 0, sizeof(dmaBlock));
+	memset(&usbDpramBlock, 0, sizeof(usbDpramBlock));
+	for (uint i = 0; i < NUM_SPIS; i++) {
+		memset(spiBlocks[i].regs, 0, sizeof(spiBlocks[i].regs));
+		spiStates[i].baudrate = 0;
+		spiStates[i].device = nullptr;
+		spiStates[i].rx.clear();
+		spiStates[i].bytes = 0;
+	}
+	for (uint i = 0; i < NUM_I2CS; i++) {
+		memset(i2cBlocks[i].regs, 0, sizeof(i2cBlocks[i].regs));
+		i2cBlocks[i].restart_on_next = false;
+		i2cStates[i].baudrate = 0;
+		i2cStates[i].devices.clear();
+		i2cStates[i].device = nullptr;
+		i2cStates[i].active = false;
+		i2cStates[i].aborted = false;
+		i2cStates[i].rx.clear();
+		i2cStates[i].pendingStat = 0;
+		i2cStates[i].logIndex = -1;
+	}
+	for (uint i = 0; i < NUM_PIOS; i++) {
+		memset((void *)pioHw(i), 0, sizeof(pio_hw_t));
+		pioStates[i].usedInstructions = 0;
+		for (uint sm = 0; sm < NUM_PIO_STATE_MACHINES; sm++) {
+			pioStates[i].sm[sm].claimed = false;
+			pioStates[i].sm[sm].device = nullptr;
+			pioStates[i].sm[sm].rx.clear();
+			pioStates[i].sm[sm].txWords = 0;
+		}
+	}
+	for (uint i = 0; i < NUM_DMA_CHANNELS; i++)
+		dmaChannels[i] = DmaChannel();
+	i2cLog.clear();
+
+	gpioDriven = 0;
+	gpioDrivenLevels = 0;
+	gpioPullUps = 0;
+	gpioPullDowns = 0;
+	memset(gpioIrqEnabled, 0, sizeof(gpioIrqEnabled));
+	memset(gpioIrqEvents, 0, sizeof(gpioIrqEvents));
+	gpioCallback = nullptr;
+	gpioOutputHook = nullptr;
+	gpioLevels = gpioComputeLevels();
+	setReg(sio_hw->gpio_in, gpioLevels);
+	// QSPI CS is pulled up, BOOTSEL not pressed
+	setReg(sio_hw->gpio_hi_in, 0x02u);
+
+	adc.fifo.clear();
+	memset(adc.input, 0, sizeof(adc.input));
+	adc.selected = 0;
+	adc.roundRobin = 0;
+	adc.running = false;
+	adc.fifoEnabled = false;
+	adc.dreqEnabled = false;
+	adc.over = false;
+	adc.under = false;
+	adc.periodNs = 2000;
+	adc.conversions = 0;
+
+	usb.inited = false;
+	usb.mounted = true;
+	usb.sofEnabled = false;
+	usb.pollIntervalUs = 1000;
+	usb.pollFrames = 0;
+	usb.busy = false;
+	usb.completePending = false;
+	usb.reportCount = 0;
+	usb.logging = false;
+	usb.log.clear();
+	usb.driver = nullptr;
+
+	hostFlashErase();
+	hostFlashResetStats();
+	flashPowerCut = -1;
+	flashTimed = false;
+	watchdogReboot = false;
+}
+
+// Power-on state before main() runs
+static struct HostSimInit {
+	HostSimInit() {
+		usb.mounted = true;
+		usb.pollIntervalUs = 1000;
+		adc.periodNs = 2000;
+		for (uint i = 0; i < NUM_I2CS; i++)
+			i2cStates[i].logIndex = -1;
+		gpioLevels = gpioComputeLevels();
+		setReg(sio_hw->gpio_in, gpioLevels);
+		setReg(sio_hw->gpio_hi_in, 0x02u);
+		hostFlashErase();
+	}
+} hostSimInit;
@@ -0,0 +1,77 @@
+#include "system.h"
+
+#include "usbhostmanager.h"
+#include "FlashPROM.h"
+
+#include <hardware/flash.h>
+#include <hardware/watchdog.h>
+#include <pico/multicore.h>
+
+#include <malloc.h>
+
+// Host build: there is no linker map to measure, so the sizes describe the simulated board
+// (see host/src/hostsim.cpp). Reboots end up in watchdog_reboot(), which throws HostReboot.
+
+uint32_t System::getTotalFlash() {
+    return PICO_FLASH_SIZE_BYTES;
+}
+
+uint32_t System::getUsedFlash() {
+    return 0;
+}
+
+#define FLASH_STORAGE_CMD 0x9f
+#define FLASH_STORAGE_DATA_BYTES 3
+#define FLASH_STORAGE_TOTAL_BYTES (1 + FLASH_STORAGE_DATA_BYTES)
+
+uint32_t System::getPhysicalFlash() {
+    uint8_t txbuf[FLASH_STORAGE_TOTAL_BYTES] = {0};
+    uint8_t rxbuf[FLASH_STORAGE_TOTAL_BYTES] = {0};
+    txbuf[0] = FLASH_STORAGE_CMD;
+    flash_do_cmd(txbuf, rxbuf, FLASH_STORAGE_TOTAL_BYTES);
+    return 1 << rxbuf[3];
+}
+
+uint32_t System::getStaticAllocs() {
+    return 0;
+}
+
+uint32_t System::getTotalHeap() {
+    return 264 * 1024;
+}
+
+uint32_t System::getUsedHeap() {
+    return mallinfo2().uordblks;
+}
+
+void System::reboot(BootMode bootMode) {
+    // Write out any config change still waiting for the inputs to go idle
+    EEPROM.flush();
+
+    // Halt all running USB instances
+    USBHostManager::getInstance().shutdown();
+
+    multicore_lockout_start_timeout_us(0xfffffffffffffff);
+
+    watchdog_hw->scratch[5] = static_cast<uint32_t>(bootMode);
+
+    watchdog_reboot(0, 0, 0);
+}
+
+System::BootMode System::takeBootMode() {
+    // If the boot was not caused by software we don't enter any of the special modes
+    if (!watchdog_caused_reboot()) {
+        return BootMode::DEFAULT;
+    }
+
+    BootMode bootMode = static_cast<BootMode>(watchdog_hw->scratch[5]);
+    if (bootMode != BootMode::GAMEPAD && bootMode != BootMode::WEBCONFIG && bootMode != BootMode::USB) {
+        bootMode = BootMode::DEFAULT;
+    }
+
+    // Reset the scratch register
+    // Subsequent reboots should revert to BootMode::DEFAULT
+    watchdog_hw->scratch[5] = static_cast<uint32_t>(BootMode::DEFAULT);
+
+    return bootMode;
+}
@@ -0,0 +1,33 @@
+#ifndef _HOST_TUSB_HID_DEVICE_H_
+#define _HOST_TUSB_HID_DEVICE_H_
+
+#include "tusb.h"
+#include "class/hid/hid.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Reports end up in the host USB sink, see hostUsbLastReport()
+bool tud_hid_n_ready(uint8_t instance);
+bool tud_hid_n_report(uint8_t instance, uint8_t report_id, void const * report, uint16_t len);
+static inline bool tud_hid_ready(void) { return tud_hid_n_ready(0); }
+static inline bool tud_hid_report(uint8_t report_id, void const * report, uint16_t len) { return tud_hid_n_report(0, report_id, report, len); }
+
+// Class driver entry points, the GP2040 drivers put these in their usbd_class_driver_t
+void hidd_init(void);
+bool hidd_deinit(void);
+void hidd_reset(uint8_t rhport);
+uint16_t hidd_open(uint8_t rhport, tusb_desc_interface_t const * desc_itf, uint16_t max_len);
+bool hidd_control_xfer_cb(uint8_t rhport, uint8_t stage, tusb_control_request_t const * request);
+bool hidd_xfer_cb(uint8_t rhport, uint8_t ep_addr, xfer_result_t event, uint32_t xferred_bytes);
+
+void tud_hid_report_complete_cb(uint8_t instance, uint8_t const * report, uint16_t len);
+uint16_t tud_hid_get_report_cb(uint8_t instance, uint8_t report_id, hid_report_type_t report_type, uint8_t * buffer, uint16_t reqlen);
+void tud_hid_set_report_cb(uint8_t instance, uint8_t report_id, hid_report_type_t report_type, uint8_t const * buffer, uint16_t bufsize);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,29 @@
+#ifndef _HOST_TUSB_HID_HOST_H_
+#define _HOST_TUSB_HID_HOST_H_
+
+#include "tusb.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+	uint8_t report_id;
+	uint8_t usage;
+	uint16_t usage_page;
+} tuh_hid_report_info_t;
+
+uint8_t tuh_hid_instance_count(uint8_t dev_addr);
+bool tuh_hid_mounted(uint8_t dev_addr, uint8_t idx);
+uint8_t tuh_hid_interface_protocol(uint8_t dev_addr, uint8_t idx);
+uint8_t tuh_hid_parse_report_descriptor(tuh_hid_report_info_t * reports_info_arr, uint8_t arr_count, uint8_t const * desc_report, uint16_t desc_len);
+bool tuh_hid_get_report(uint8_t dev_addr, uint8_t idx, uint8_t report_id, uint8_t report_type, void * report, uint16_t len);
+bool tuh_hid_set_report(uint8_t dev_addr, uint8_t idx, uint8_t report_id, uint8_t report_type, void * report, uint16_t len);
+bool tuh_hid_receive_report(uint8_t dev_addr, uint8_t idx);
+bool tuh_hid_send_report(uint8_t dev_addr, uint8_t idx, uint8_t report_id, const void * report, uint16_t len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,56 @@
+#ifndef _HOST_HARDWARE_ADC_H_
+#define _HOST_HARDWARE_ADC_H_
+
+#include "pico.h"
+#include "hardware/address_mapped.h"
+
+#define DREQ_ADC 36
+
+#define ADC_CS_START_MANY_BITS 0x00000008u
+#define ADC_FCS_OVER_BITS 0x00000800u
+#define ADC_FCS_UNDER_BITS 0x00000400u
+#define ADC_FCS_EMPTY_BITS 0x00000100u
+#define ADC_FCS_LEVEL_BITS 0x000f0000u
+#define ADC_FCS_LEVEL_LSB 16u
+
+typedef struct {
+	io_rw_32 cs;
+	io_ro_32 result;
+	io_rw_32 fcs;
+	io_ro_32 fifo;
+	io_rw_32 div;
+	io_ro_32 intr;
+	io_rw_32 inte;
+	io_rw_32 intf;
+	io_ro_32 ints;
+} adc_hw_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+extern adc_hw_t * adc_hw;
+
+// Conversions return the level set with hostAdcSetInput() for the selected channel
+void adc_init(void);
+void adc_gpio_init(uint gpio);
+void adc_select_input(uint input);
+uint adc_get_selected_input(void);
+void adc_set_round_robin(uint input_mask);
+void adc_set_temp_sensor_enabled(bool enable);
+uint16_t adc_read(void);
+void adc_run(bool run);
+void adc_set_clkdiv(float clkdiv);
+void adc_fifo_setup(bool en, bool dreq_en, uint16_t dreq_thresh, bool err_in_fifo, bool byte_shift);
+bool adc_fifo_is_empty(void);
+uint8_t adc_fifo_get_level(void);
+uint16_t adc_fifo_get(void);
+uint16_t adc_fifo_get_blocking(void);
+void adc_fifo_drain(void);
+void adc_irq_set_enabled(bool enabled);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,27 @@
+#ifndef _HOST_HARDWARE_ADDRESS_MAPPED_H_
+#define _HOST_HARDWARE_ADDRESS_MAPPED_H_
+
+#include "pico.h"
+
+typedef volatile uint32_t io_rw_32;
+typedef const volatile uint32_t io_ro_32;
+typedef volatile uint32_t io_wo_32;
+typedef volatile uint16_t io_rw_16;
+typedef volatile uint8_t io_rw_8;
+
+// The register blocks are plain memory on the host. The atomic aliases go through hostsim so the registers with
+// write-one-to-clear bits (ADC FCS, timer INTR) behave as on the device.
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void hw_set_bits(io_rw_32 * addr, uint32_t mask);
+void hw_clear_bits(io_rw_32 * addr, uint32_t mask);
+void hw_xor_bits(io_rw_32 * addr, uint32_t mask);
+void hw_write_masked(io_rw_32 * addr, uint32_t values, uint32_t write_mask);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,31 @@
+#ifndef _HOST_HARDWARE_CLOCKS_H_
+#define _HOST_HARDWARE_CLOCKS_H_
+
+#include "pico.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+enum clock_num_rp2040 {
+	clk_gpout0 = 0,
+	clk_gpout1 = 1,
+	clk_gpout2 = 2,
+	clk_gpout3 = 3,
+	clk_ref = 4,
+	clk_sys = 5,
+	clk_peri = 6,
+	clk_usb = 7,
+	clk_adc = 8,
+	clk_rtc = 9,
+	CLK_COUNT
+};
+typedef enum clock_num_rp2040 clock_handle_t;
+
+uint32_t clock_get_hz(clock_handle_t clock);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,121 @@
+#ifndef _HOST_HARDWARE_DMA_H_
+#define _HOST_HARDWARE_DMA_H_
+
+#include "pico.h"
+#include "hardware/address_mapped.h"
+
+#define DREQ_PIO0_TX0 0
+#define DREQ_PIO0_RX0 4
+#define DREQ_PIO1_TX0 8
+#define DREQ_PIO1_RX0 12
+#define DREQ_SPI0_TX 16
+#define DREQ_SPI0_RX 17
+#define DREQ_SPI1_TX 18
+#define DREQ_SPI1_RX 19
+#define DREQ_I2C0_TX 32
+#define DREQ_I2C0_RX 33
+#define DREQ_I2C1_TX 34
+#define DREQ_I2C1_RX 35
+#define DREQ_FORCE 0x3f
+
+enum dma_channel_transfer_size {
+	DMA_SIZE_8 = 0,
+	DMA_SIZE_16 = 1,
+	DMA_SIZE_32 = 2
+};
+
+typedef struct {
+	uint32_t ctrl;
+} dma_channel_config;
+
+// Addresses are pointer sized on the host, everything else mirrors the RP2040 layout
+typedef struct {
+	volatile uintptr_t read_addr;
+	volatile uintptr_t write_addr;
+	io_rw_32 transfer_count;
+	io_rw_32 ctrl_trig;
+	io_rw_32 al1_ctrl;
+	volatile uintptr_t al1_read_addr;
+	volatile uintptr_t al1_write_addr;
+	io_rw_32 al1_transfer_count_trig;
+	io_rw_32 al2_ctrl;
+	io_rw_32 al2_transfer_count;
+	volatile uintptr_t al2_read_addr;
+	volatile uintptr_t al2_write_addr_trig;
+	io_rw_32 al3_ctrl;
+	volatile uintptr_t al3_write_addr;
+	io_rw_32 al3_transfer_count;
+	volatile uintptr_t al3_read_addr_trig;
+} dma_channel_hw_t;
+
+typedef struct {
+	dma_channel_hw_t ch[NUM_DMA_CHANNELS];
+	io_ro_32 intr;
+	io_rw_32 inte0;
+	io_rw_32 intf0;
+	io_rw_32 ints0;
+	io_rw_32 inte1;
+	io_rw_32 intf1;
+	io_rw_32 ints1;
+	io_wo_32 multi_channel_trigger;
+	io_rw_32 abort;
+} dma_hw_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+extern dma_hw_t * dma_hw;
+
+static inline dma_channel_hw_t * dma_channel_hw_addr(uint channel) { return &dma_hw->ch[channel]; }
+
+void dma_channel_claim(uint channel);
+void dma_claim_mask(uint32_t channel_mask);
+void dma_channel_unclaim(uint channel);
+void dma_unclaim_mask(uint32_t channel_mask);
+int dma_claim_unused_channel(bool required);
+bool dma_channel_is_claimed(uint channel);
+
+dma_channel_config dma_channel_get_default_config(uint channel);
+dma_channel_config dma_get_channel_config(uint channel);
+void channel_config_set_read_increment(dma_channel_config * c, bool incr);
+void channel_config_set_write_increment(dma_channel_config * c, bool incr);
+void channel_config_set_dreq(dma_channel_config * c, uint dreq);
+void channel_config_set_chain_to(dma_channel_config * c, uint chain_to);
+void channel_config_set_transfer_data_size(dma_channel_config * c, enum dma_channel_transfer_size size);
+void channel_config_set_ring(dma_channel_config * c, bool write, uint size_bits);
+void channel_config_set_bswap(dma_channel_config * c, bool bswap);
+void channel_config_set_irq_quiet(dma_channel_config * c, bool irq_quiet);
+void channel_config_set_high_priority(dma_channel_config * c, bool high_priority);
+void channel_config_set_enable(dma_channel_config * c, bool enable);
+void channel_config_set_sniff_enable(dma_channel_config * c, bool sniff_enable);
+
+// Transfers are handed to hostsim, which completes them when the paced peripheral is serviced
+void dma_channel_set_config(uint channel, const dma_channel_config * config, bool trigger);
+void dma_channel_set_read_addr(uint channel, const volatile void * read_addr, bool trigger);
+void dma_channel_set_write_addr(uint channel, volatile void * write_addr, bool trigger);
+void dma_channel_set_trans_count(uint channel, uint32_t trans_count, bool trigger);
+void dma_channel_configure(uint channel, const dma_channel_config * config, volatile void * write_addr,
+                           const volatile void * read_addr, uint transfer_count, bool trigger);
+void dma_channel_transfer_from_buffer_now(uint channel, const volatile void * read_addr, uint32_t transfer_count);
+void dma_channel_transfer_to_buffer_now(uint channel, volatile void * write_addr, uint32_t transfer_count);
+void dma_start_channel_mask(uint32_t chan_mask);
+void dma_channel_start(uint channel);
+void dma_channel_abort(uint channel);
+bool dma_channel_is_busy(uint channel);
+void dma_channel_wait_for_finish_blocking(uint channel);
+
+void dma_channel_set_irq0_enabled(uint channel, bool enabled);
+void dma_set_irq0_channel_mask_enabled(uint32_t channel_mask, bool enabled);
+void dma_channel_set_irq1_enabled(uint channel, bool enabled);
+void dma_set_irq1_channel_mask_enabled(uint32_t channel_mask, bool enabled);
+bool dma_channel_get_irq0_status(uint channel);
+bool dma_channel_get_irq1_status(uint channel);
+void dma_channel_acknowledge_irq0(uint channel);
+void dma_channel_acknowledge_irq1(uint channel);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
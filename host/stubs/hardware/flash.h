@@ -0,0 +1,33 @@
+#ifndef _HOST_HARDWARE_FLASH_H_
+#define _HOST_HARDWARE_FLASH_H_
+
+#include "pico.h"
+
+#define FLASH_PAGE_SIZE (1u << 8)
+#define FLASH_SECTOR_SIZE (1u << 12)
+#define FLASH_BLOCK_SIZE (1u << 16)
+#define FLASH_UNIQUE_ID_SIZE_BYTES 8
+
+#ifndef PICO_FLASH_SIZE_BYTES
+#define PICO_FLASH_SIZE_BYTES (2 * 1024 * 1024)
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// The XIP window maps onto an in-memory flash image, so reading through XIP_BASE works as on the device
+extern uint8_t hostFlashImage[PICO_FLASH_SIZE_BYTES];
+
+#define XIP_BASE ((uintptr_t)hostFlashImage)
+
+void flash_range_erase(uint32_t flash_offs, size_t count);
+void flash_range_program(uint32_t flash_offs, const uint8_t * data, size_t count);
+void flash_get_unique_id(uint8_t * id_out);
+void flash_do_cmd(const uint8_t * txbuf, uint8_t * rxbuf, size_t count);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
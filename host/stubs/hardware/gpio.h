@@ -0,0 +1,99 @@
+#ifndef _HOST_HARDWARE_GPIO_H_
+#define _HOST_HARDWARE_GPIO_H_
+
+#include "pico.h"
+#include "hardware/address_mapped.h"
+#include "hardware/structs/sio.h"
+#include "hardware/irq.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define GPIO_OUT 1
+#define GPIO_IN 0
+
+enum gpio_function_rp2040 {
+	GPIO_FUNC_XIP = 0,
+	GPIO_FUNC_SPI = 1,
+	GPIO_FUNC_UART = 2,
+	GPIO_FUNC_I2C = 3,
+	GPIO_FUNC_PWM = 4,
+	GPIO_FUNC_SIO = 5,
+	GPIO_FUNC_PIO0 = 6,
+	GPIO_FUNC_PIO1 = 7,
+	GPIO_FUNC_GPCK = 8,
+	GPIO_FUNC_USB = 9,
+	GPIO_FUNC_NULL = 0x1f,
+};
+typedef enum gpio_function_rp2040 gpio_function_t;
+
+enum gpio_irq_level {
+	GPIO_IRQ_LEVEL_LOW = 0x1u,
+	GPIO_IRQ_LEVEL_HIGH = 0x2u,
+	GPIO_IRQ_EDGE_FALL = 0x4u,
+	GPIO_IRQ_EDGE_RISE = 0x8u,
+};
+
+enum gpio_slew_rate { GPIO_SLEW_RATE_SLOW = 0, GPIO_SLEW_RATE_FAST = 1 };
+enum gpio_override { GPIO_OVERRIDE_NORMAL = 0, GPIO_OVERRIDE_INVERT = 1, GPIO_OVERRIDE_LOW = 2, GPIO_OVERRIDE_HIGH = 3 };
+enum gpio_drive_strength { GPIO_DRIVE_STRENGTH_2MA = 0, GPIO_DRIVE_STRENGTH_4MA = 1, GPIO_DRIVE_STRENGTH_8MA = 2, GPIO_DRIVE_STRENGTH_12MA = 3 };
+
+typedef void (*gpio_irq_callback_t)(uint gpio, uint32_t event_mask);
+typedef void (*irq_handler_t)(void);
+
+void gpio_init(uint gpio);
+void gpio_deinit(uint gpio);
+void gpio_init_mask(uint gpio_mask);
+void gpio_set_function(uint gpio, gpio_function_t fn);
+gpio_function_t gpio_get_function(uint gpio);
+void gpio_set_pulls(uint gpio, bool up, bool down);
+void gpio_pull_up(uint gpio);
+void gpio_pull_down(uint gpio);
+void gpio_disable_pulls(uint gpio);
+bool gpio_is_pulled_up(uint gpio);
+bool gpio_is_pulled_down(uint gpio);
+void gpio_set_input_enabled(uint gpio, bool enabled);
+void gpio_set_input_hysteresis_enabled(uint gpio, bool enabled);
+void gpio_set_slew_rate(uint gpio, enum gpio_slew_rate slew);
+void gpio_set_drive_strength(uint gpio, enum gpio_drive_strength drive);
+void gpio_set_outover(uint gpio, uint value);
+void gpio_set_inover(uint gpio, uint value);
+
+void gpio_set_dir(uint gpio, bool out);
+bool gpio_is_dir_out(uint gpio);
+uint gpio_get_dir(uint gpio);
+void gpio_set_dir_out_masked(uint32_t mask);
+void gpio_set_dir_in_masked(uint32_t mask);
+void gpio_set_dir_masked(uint32_t mask, uint32_t value);
+void gpio_set_dir_all_bits(uint32_t values);
+
+// Input levels come from the host GPIO bank, see hostGpioSetInputs()
+bool gpio_get(uint gpio);
+uint32_t gpio_get_all(void);
+bool gpio_get_out_level(uint gpio);
+void gpio_put(uint gpio, bool value);
+void gpio_put_masked(uint32_t mask, uint32_t value);
+void gpio_put_all(uint32_t value);
+void gpio_set_mask(uint32_t mask);
+void gpio_clr_mask(uint32_t mask);
+void gpio_xor_mask(uint32_t mask);
+
+void gpio_set_irq_enabled(uint gpio, uint32_t event_mask, bool enabled);
+void gpio_set_irq_callback(gpio_irq_callback_t callback);
+void gpio_set_irq_enabled_with_callback(uint gpio, uint32_t event_mask, bool enabled, gpio_irq_callback_t callback);
+void gpio_set_dormant_irq_enabled(uint gpio, uint32_t event_mask, bool enabled);
+uint32_t gpio_get_irq_event_mask(uint gpio);
+void gpio_acknowledge_irq(uint gpio, uint32_t event_mask);
+void gpio_add_raw_irq_handler_with_order_priority_masked(uint32_t gpio_mask, irq_handler_t handler, uint8_t order_priority);
+void gpio_add_raw_irq_handler_with_order_priority(uint gpio, irq_handler_t handler, uint8_t order_priority);
+void gpio_add_raw_irq_handler_masked(uint32_t gpio_mask, irq_handler_t handler);
+void gpio_add_raw_irq_handler(uint gpio, irq_handler_t handler);
+void gpio_remove_raw_irq_handler_masked(uint32_t gpio_mask, irq_handler_t handler);
+void gpio_remove_raw_irq_handler(uint gpio, irq_handler_t handler);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,86 @@
+#ifndef _HOST_HARDWARE_I2C_H_
+#define _HOST_HARDWARE_I2C_H_
+
+#include "pico.h"
+#include "pico/time.h"
+#include "hardware/address_mapped.h"
+
+#define I2C_IC_DATA_CMD_RESTART_BITS 0x00000400u
+#define I2C_IC_DATA_CMD_STOP_BITS 0x00000200u
+#define I2C_IC_DATA_CMD_CMD_BITS 0x00000100u
+#define I2C_IC_DATA_CMD_DAT_BITS 0x000000ffu
+#define I2C_IC_INTR_MASK_M_STOP_DET_BITS 0x00000200u
+#define I2C_IC_INTR_MASK_M_TX_ABRT_BITS 0x00000040u
+#define I2C_IC_INTR_STAT_R_STOP_DET_BITS 0x00000200u
+#define I2C_IC_INTR_STAT_R_TX_ABRT_BITS 0x00000040u
+#define I2C_IC_RAW_INTR_STAT_STOP_DET_BITS 0x00000200u
+#define I2C_IC_RAW_INTR_STAT_TX_ABRT_BITS 0x00000040u
+
+typedef struct {
+	io_rw_32 con;
+	io_rw_32 tar;
+	io_rw_32 sar;
+	uint32_t _pad0;
+	io_rw_32 data_cmd;
+	io_rw_32 ss_scl_hcnt;
+	io_rw_32 ss_scl_lcnt;
+	io_rw_32 fs_scl_hcnt;
+	io_rw_32 fs_scl_lcnt;
+	uint32_t _pad1[2];
+	io_ro_32 intr_stat;
+	io_rw_32 intr_mask;
+	io_ro_32 raw_intr_stat;
+	io_rw_32 rx_tl;
+	io_rw_32 tx_tl;
+	io_ro_32 clr_intr;
+	io_ro_32 clr_rx_under;
+	io_ro_32 clr_rx_over;
+	io_ro_32 clr_tx_over;
+	io_ro_32 clr_rd_req;
+	io_ro_32 clr_tx_abrt;
+	io_ro_32 clr_rx_done;
+	io_ro_32 clr_activity;
+	io_ro_32 clr_stop_det;
+	io_ro_32 clr_start_det;
+	io_ro_32 clr_gen_call;
+	io_rw_32 enable;
+	io_ro_32 status;
+	io_ro_32 txflr;
+	io_ro_32 rxflr;
+	io_rw_32 sda_hold;
+	io_ro_32 tx_abrt_source;
+	io_rw_32 slv_data_nack_only;
+	io_rw_32 dma_cr;
+	io_rw_32 dma_tdlr;
+	io_rw_32 dma_rdlr;
+} i2c_hw_t;
+
+typedef struct i2c_inst i2c_inst_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+extern i2c_inst_t * const i2c0;
+extern i2c_inst_t * const i2c1;
+
+uint i2c_hw_index(i2c_inst_t * i2c);
+i2c_hw_t * i2c_get_hw(i2c_inst_t * i2c);
+static inline uint i2c_get_dreq(i2c_inst_t * i2c, bool is_tx) { return 32u + i2c_hw_index(i2c) * 2u + (is_tx ? 0u : 1u); }
+
+// Transfers go to the devices registered with hostI2cAttach(), other addresses are NAKed
+uint i2c_init(i2c_inst_t * i2c, uint baudrate);
+void i2c_deinit(i2c_inst_t * i2c);
+uint i2c_set_baudrate(i2c_inst_t * i2c, uint baudrate);
+int i2c_write_blocking_until(i2c_inst_t * i2c, uint8_t addr, const uint8_t * src, size_t len, bool nostop, absolute_time_t until);
+int i2c_read_blocking_until(i2c_inst_t * i2c, uint8_t addr, uint8_t * dst, size_t len, bool nostop, absolute_time_t until);
+int i2c_write_timeout_us(i2c_inst_t * i2c, uint8_t addr, const uint8_t * src, size_t len, bool nostop, uint timeout_us);
+int i2c_read_timeout_us(i2c_inst_t * i2c, uint8_t addr, uint8_t * dst, size_t len, bool nostop, uint timeout_us);
+int i2c_write_blocking(i2c_inst_t * i2c, uint8_t addr, const uint8_t * src, size_t len, bool nostop);
+int i2c_read_blocking(i2c_inst_t * i2c, uint8_t addr, uint8_t * dst, size_t len, bool nostop);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,106 @@
+#ifndef _HOST_HARDWARE_PIO_H_
+#define _HOST_HARDWARE_PIO_H_
+
+#include "pico.h"
+#include "hardware/address_mapped.h"
+#include "hardware/gpio.h"
+
+typedef struct pio_hw {
+	io_rw_32 ctrl;
+	io_ro_32 fstat;
+	io_rw_32 fdebug;
+	io_ro_32 flevel;
+	io_wo_32 txf[NUM_PIO_STATE_MACHINES];
+	io_ro_32 rxf[NUM_PIO_STATE_MACHINES];
+	io_rw_32 irq;
+	io_wo_32 irq_force;
+} pio_hw_t;
+
+typedef pio_hw_t * PIO;
+
+typedef struct {
+	uint32_t clkdiv;
+	uint32_t execctrl;
+	uint32_t shiftctrl;
+	uint32_t pinctrl;
+} pio_sm_config;
+
+typedef struct pio_program {
+	const uint16_t * instructions;
+	uint8_t length;
+	int8_t origin;
+	uint8_t pio_version;
+} pio_program_t;
+
+enum pio_fifo_join {
+	PIO_FIFO_JOIN_NONE = 0,
+	PIO_FIFO_JOIN_TX = 1,
+	PIO_FIFO_JOIN_RX = 2,
+};
+
+enum pio_mov_status_type {
+	STATUS_TX_LESSTHAN = 0,
+	STATUS_RX_LESSTHAN = 1
+};
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+extern pio_hw_t * const pio0;
+extern pio_hw_t * const pio1;
+
+static inline uint pio_get_index(PIO pio) { return pio == pio1 ? 1u : 0u; }
+static inline uint pio_get_dreq(PIO pio, uint sm, bool is_tx) { return pio_get_index(pio) * 8u + sm + (is_tx ? 0u : 4u); }
+
+bool pio_can_add_program(PIO pio, const pio_program_t * program);
+int pio_add_program(PIO pio, const pio_program_t * program);
+void pio_remove_program(PIO pio, const pio_program_t * program, uint loaded_offset);
+void pio_sm_claim(PIO pio, uint sm);
+void pio_sm_unclaim(PIO pio, uint sm);
+int pio_claim_unused_sm(PIO pio, bool required);
+bool pio_sm_is_claimed(PIO pio, uint sm);
+
+pio_sm_config pio_get_default_sm_config(void);
+void sm_config_set_out_pins(pio_sm_config * c, uint out_base, uint out_count);
+void sm_config_set_set_pins(pio_sm_config * c, uint set_base, uint set_count);
+void sm_config_set_in_pins(pio_sm_config * c, uint in_base);
+void sm_config_set_sideset_pins(pio_sm_config * c, uint sideset_base);
+void sm_config_set_sideset(pio_sm_config * c, uint bit_count, bool optional, bool pindirs);
+void sm_config_set_clkdiv(pio_sm_config * c, float div);
+void sm_config_set_clkdiv_int_frac(pio_sm_config * c, uint16_t div_int, uint8_t div_frac);
+void sm_config_set_wrap(pio_sm_config * c, uint wrap_target, uint wrap);
+void sm_config_set_jmp_pin(pio_sm_config * c, uint pin);
+void sm_config_set_in_shift(pio_sm_config * c, bool shift_right, bool autopush, uint push_threshold);
+void sm_config_set_out_shift(pio_sm_config * c, bool shift_right, bool autopull, uint pull_threshold);
+void sm_config_set_fifo_join(pio_sm_config * c, enum pio_fifo_join join);
+
+void pio_gpio_init(PIO pio, uint pin);
+int pio_sm_init(PIO pio, uint sm, uint initial_pc, const pio_sm_config * config);
+void pio_sm_set_enabled(PIO pio, uint sm, bool enabled);
+void pio_sm_restart(PIO pio, uint sm);
+void pio_sm_clear_fifos(PIO pio, uint sm);
+void pio_sm_exec(PIO pio, uint sm, uint instr);
+void pio_sm_set_pins(PIO pio, uint sm, uint32_t pin_values);
+void pio_sm_set_pins_with_mask(PIO pio, uint sm, uint32_t pin_values, uint32_t pin_mask);
+void pio_sm_set_pindirs_with_mask(PIO pio, uint sm, uint32_t pin_dirs, uint32_t pin_mask);
+int pio_sm_set_consecutive_pindirs(PIO pio, uint sm, uint pin_base, uint pin_count, bool is_out);
+
+// The FIFOs are queues in hostsim; tests stand in for the state machine through hostPio*()
+void pio_sm_put(PIO pio, uint sm, uint32_t data);
+void pio_sm_put_blocking(PIO pio, uint sm, uint32_t data);
+uint32_t pio_sm_get(PIO pio, uint sm);
+uint32_t pio_sm_get_blocking(PIO pio, uint sm);
+bool pio_sm_is_rx_fifo_full(PIO pio, uint sm);
+bool pio_sm_is_rx_fifo_empty(PIO pio, uint sm);
+uint pio_sm_get_rx_fifo_level(PIO pio, uint sm);
+bool pio_sm_is_tx_fifo_full(PIO pio, uint sm);
+bool pio_sm_is_tx_fifo_empty(PIO pio, uint sm);
+uint pio_sm_get_tx_fifo_level(PIO pio, uint sm);
+void pio_sm_drain_tx_fifo(PIO pio, uint sm);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,27 @@
+#ifndef _HOST_HARDWARE_PLATFORM_DEFS_H_
+#define _HOST_HARDWARE_PLATFORM_DEFS_H_
+
+#define NUM_CORES 2u
+#define NUM_DMA_CHANNELS 12u
+#define NUM_DMA_TIMERS 4u
+#define NUM_DMA_IRQS 2u
+#define NUM_IRQS 32u
+#define NUM_USER_IRQS 6u
+#define NUM_PIOS 2u
+#define NUM_PIO_STATE_MACHINES 4u
+#define NUM_PWM_SLICES 8u
+#define NUM_SPIN_LOCKS 32u
+#define NUM_UARTS 2u
+#define NUM_I2CS 2u
+#define NUM_SPIS 2u
+#define NUM_GENERIC_TIMERS 1u
+#define NUM_ALARMS 4u
+#define NUM_ADC_CHANNELS 5u
+#define NUM_RESETS 24u
+#define NUM_BANK0_GPIOS 30u
+#define NUM_QSPI_GPIOS 6u
+
+#define SRAM_BASE 0x20000000u
+#define SRAM_END 0x20042000u
+
+#endif
@@ -0,0 +1,57 @@
+#ifndef _HOST_HARDWARE_SPI_H_
+#define _HOST_HARDWARE_SPI_H_
+
+#include "pico.h"
+#include "hardware/address_mapped.h"
+
+typedef struct {
+	io_rw_32 cr0;
+	io_rw_32 cr1;
+	io_rw_32 dr;
+	io_ro_32 sr;
+	io_rw_32 cpsr;
+	io_rw_32 imsc;
+	io_ro_32 ris;
+	io_ro_32 mis;
+	io_rw_32 icr;
+	io_rw_32 dmacr;
+} spi_hw_t;
+
+typedef struct spi_inst spi_inst_t;
+
+typedef enum { SPI_CPHA_0 = 0, SPI_CPHA_1 = 1 } spi_cpha_t;
+typedef enum { SPI_CPOL_0 = 0, SPI_CPOL_1 = 1 } spi_cpol_t;
+typedef enum { SPI_LSB_FIRST = 0, SPI_MSB_FIRST = 1 } spi_order_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+extern spi_inst_t * const spi0;
+extern spi_inst_t * const spi1;
+
+uint spi_get_index(const spi_inst_t * spi);
+spi_hw_t * spi_get_hw(spi_inst_t * spi);
+static inline uint spi_get_dreq(spi_inst_t * spi, bool is_tx) { return 16u + spi_get_index(spi) * 2u + (is_tx ? 0u : 1u); }
+
+// Transfers go to the device registered with hostSpiAttach(), reads return 0xff without one
+uint spi_init(spi_inst_t * spi, uint baudrate);
+void spi_deinit(spi_inst_t * spi);
+uint spi_set_baudrate(spi_inst_t * spi, uint baudrate);
+uint spi_get_baudrate(const spi_inst_t * spi);
+void spi_set_format(spi_inst_t * spi, uint data_bits, spi_cpol_t cpol, spi_cpha_t cpha, spi_order_t order);
+bool spi_is_writable(const spi_inst_t * spi);
+bool spi_is_readable(const spi_inst_t * spi);
+bool spi_is_busy(const spi_inst_t * spi);
+int spi_write_read_blocking(spi_inst_t * spi, const uint8_t * src, uint8_t * dst, size_t len);
+int spi_write_blocking(spi_inst_t * spi, const uint8_t * src, size_t len);
+int spi_read_blocking(spi_inst_t * spi, uint8_t repeated_tx_data, uint8_t * dst, size_t len);
+int spi_write16_read16_blocking(spi_inst_t * spi, const uint16_t * src, uint16_t * dst, size_t len);
+int spi_write16_blocking(spi_inst_t * spi, const uint16_t * src, size_t len);
+int spi_read16_blocking(spi_inst_t * spi, uint16_t repeated_tx_data, uint16_t * dst, size_t len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
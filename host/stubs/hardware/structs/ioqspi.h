@@ -0,0 +1,28 @@
+#ifndef _HOST_HARDWARE_STRUCTS_IOQSPI_H_
+#define _HOST_HARDWARE_STRUCTS_IOQSPI_H_
+
+#include "hardware/address_mapped.h"
+
+#define IO_QSPI_GPIO_QSPI_SS_CTRL_OEOVER_LSB 12u
+#define IO_QSPI_GPIO_QSPI_SS_CTRL_OEOVER_BITS 0x00003000u
+
+typedef struct {
+	io_ro_32 status;
+	io_rw_32 ctrl;
+} ioqspi_status_ctrl_hw_t;
+
+typedef struct {
+	ioqspi_status_ctrl_hw_t io[NUM_QSPI_GPIOS];
+} ioqspi_hw_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+extern ioqspi_hw_t * ioqspi_hw;
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,31 @@
+#ifndef _HOST_HARDWARE_STRUCTS_SIO_H_
+#define _HOST_HARDWARE_STRUCTS_SIO_H_
+
+#include "hardware/address_mapped.h"
+
+typedef struct {
+	io_ro_32 cpuid;
+	io_ro_32 gpio_in;
+	io_ro_32 gpio_hi_in;
+	uint32_t _pad0;
+	io_rw_32 gpio_out;
+	io_wo_32 gpio_set;
+	io_wo_32 gpio_clr;
+	io_wo_32 gpio_togl;
+	io_rw_32 gpio_oe;
+	io_wo_32 gpio_oe_set;
+	io_wo_32 gpio_oe_clr;
+	io_wo_32 gpio_oe_togl;
+} sio_hw_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+extern sio_hw_t * sio_hw;
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
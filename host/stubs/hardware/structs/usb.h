@@ -0,0 +1,71 @@
+#ifndef _HOST_HARDWARE_STRUCTS_USB_H_
+#define _HOST_HARDWARE_STRUCTS_USB_H_
+
+#include "hardware/address_mapped.h"
+
+#define USB_NUM_ENDPOINTS 16
+
+#define USB_BUF_CTRL_FULL 0x00008000u
+#define USB_BUF_CTRL_LAST 0x00004000u
+#define USB_BUF_CTRL_DATA0_PID 0x00000000u
+#define USB_BUF_CTRL_DATA1_PID 0x00002000u
+#define USB_BUF_CTRL_SEL 0x00001000u
+#define USB_BUF_CTRL_STALL 0x00000800u
+#define USB_BUF_CTRL_AVAIL 0x00000400u
+#define USB_BUF_CTRL_LEN_MASK 0x000003FFu
+
+typedef struct {
+	volatile uint8_t setup_packet[8];
+	struct usb_device_dpram_ep_ctrl {
+		io_rw_32 in;
+		io_rw_32 out;
+	} ep_ctrl[USB_NUM_ENDPOINTS - 1];
+	struct usb_device_dpram_ep_buf_ctrl {
+		io_rw_32 in;
+		io_rw_32 out;
+	} ep_buf_ctrl[USB_NUM_ENDPOINTS];
+	uint8_t ep0_buf_a[0x40];
+	uint8_t ep0_buf_b[0x40];
+	uint8_t epx_data[4096 - 0x180];
+} usb_device_dpram_t;
+
+typedef struct {
+	io_rw_32 dev_addr_ctrl;
+	io_rw_32 int_ep_addr_ctrl[USB_NUM_ENDPOINTS - 1];
+	io_rw_32 main_ctrl;
+	io_rw_32 sof_wr;
+	io_ro_32 sof_rd;
+	io_rw_32 sie_ctrl;
+	io_rw_32 sie_status;
+	io_rw_32 int_ep_ctrl;
+	io_rw_32 buf_status;
+	io_ro_32 buf_cpu_should_handle;
+	io_rw_32 abort;
+	io_rw_32 abort_done;
+	io_rw_32 ep_stall_arm;
+	io_rw_32 nak_poll;
+	io_rw_32 ep_nak_stall_status;
+	io_rw_32 muxing;
+	io_rw_32 pwr;
+	io_rw_32 phy_direct;
+	io_rw_32 phy_direct_override;
+	io_rw_32 phy_trim;
+	uint32_t _pad0;
+	io_rw_32 intr;
+	io_rw_32 inte;
+	io_rw_32 intf;
+	io_ro_32 ints;
+} usb_hw_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+extern usb_device_dpram_t * usb_dpram;
+extern usb_hw_t * usb_hw;
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,27 @@
+#ifndef _HOST_HARDWARE_STRUCTS_XIP_CTRL_H_
+#define _HOST_HARDWARE_STRUCTS_XIP_CTRL_H_
+
+#include "hardware/address_mapped.h"
+
+typedef struct {
+	io_rw_32 ctrl;
+	io_wo_32 flush;
+	io_ro_32 stat;
+	io_rw_32 ctr_hit;
+	io_rw_32 ctr_acc;
+	io_rw_32 stream_addr;
+	io_rw_32 stream_ctr;
+	io_ro_32 stream_fifo;
+} xip_ctrl_hw_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+extern xip_ctrl_hw_t * xip_ctrl_hw;
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
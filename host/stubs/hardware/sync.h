@@ -0,0 +1,44 @@
+#ifndef _HOST_HARDWARE_SYNC_H_
+#define _HOST_HARDWARE_SYNC_H_
+
+#include "pico.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef volatile uint32_t spin_lock_t;
+
+static inline void __sev(void) {}
+static inline void __wfe(void) {}
+static inline void __wfi(void) {}
+static inline void __nop(void) {}
+static inline void __dmb(void) { __sync_synchronize(); }
+static inline void __dsb(void) { __sync_synchronize(); }
+static inline void __isb(void) { __sync_synchronize(); }
+static inline void __mem_fence_acquire(void) { __sync_synchronize(); }
+static inline void __mem_fence_release(void) { __sync_synchronize(); }
+static inline void __compiler_memory_barrier(void) { __asm__ volatile ("" : : : "memory"); }
+
+uint32_t save_and_disable_interrupts(void);
+void restore_interrupts(uint32_t status);
+static inline void restore_interrupts_from_disabled(uint32_t status) { restore_interrupts(status); }
+
+spin_lock_t * spin_lock_instance(uint lock_num);
+uint spin_lock_get_num(spin_lock_t * lock);
+uint32_t spin_lock_blocking(spin_lock_t * lock);
+void spin_unlock(spin_lock_t * lock, uint32_t saved_irq);
+bool is_spin_locked(spin_lock_t * lock);
+void spin_lock_unsafe_blocking(spin_lock_t * lock);
+void spin_unlock_unsafe(spin_lock_t * lock);
+spin_lock_t * spin_lock_init(uint lock_num);
+void spin_lock_claim(uint lock_num);
+void spin_lock_unclaim(uint lock_num);
+int spin_lock_claim_unused(bool required);
+uint next_striped_spin_lock_num(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,52 @@
+#ifndef _HOST_HARDWARE_TIMER_H_
+#define _HOST_HARDWARE_TIMER_H_
+
+#include "pico.h"
+#include "hardware/address_mapped.h"
+#include "hardware/irq.h"
+
+typedef struct {
+	io_wo_32 timehw;
+	io_wo_32 timelw;
+	io_ro_32 timehr;
+	io_ro_32 timelr;
+	io_rw_32 alarm[NUM_ALARMS];
+	io_rw_32 armed;
+	io_ro_32 timerawh;
+	io_ro_32 timerawl;
+	io_rw_32 dbgpause;
+	io_rw_32 pause;
+	io_rw_32 intr;
+	io_rw_32 inte;
+	io_rw_32 intf;
+	io_ro_32 ints;
+} timer_hw_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+extern timer_hw_t * timer_hw;
+
+uint64_t time_us_64(void);
+uint32_t time_us_32(void);
+void busy_wait_us(uint64_t delay_us);
+void busy_wait_us_32(uint32_t delay_us);
+void busy_wait_ms(uint32_t delay_ms);
+void busy_wait_until(absolute_time_t t);
+
+// Host monotonic clock in nanoseconds, LoopStats uses it on the host so stage timings resolve below 1us
+uint32_t hostClockNs32(void);
+
+void hardware_alarm_claim(uint alarm_num);
+int hardware_alarm_claim_unused(bool required);
+void hardware_alarm_unclaim(uint alarm_num);
+void hardware_alarm_set_callback(uint alarm_num, void (*callback)(uint alarm_num));
+bool hardware_alarm_set_target(uint alarm_num, absolute_time_t t);
+void hardware_alarm_cancel(uint alarm_num);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,8 @@
+#ifndef _HOST_HARDWARE_UART_H_
+#define _HOST_HARDWARE_UART_H_
+
+#include "pico.h"
+
+typedef struct uart_inst uart_inst_t;
+
+#endif
@@ -0,0 +1,31 @@
+#ifndef _HOST_HARDWARE_WATCHDOG_H_
+#define _HOST_HARDWARE_WATCHDOG_H_
+
+#include "pico.h"
+#include "hardware/address_mapped.h"
+
+typedef struct {
+	io_rw_32 ctrl;
+	io_wo_32 load;
+	io_ro_32 reason;
+	io_rw_32 scratch[8];
+	io_rw_32 tick;
+} watchdog_hw_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+extern watchdog_hw_t * watchdog_hw;
+
+void watchdog_reboot(uint32_t pc, uint32_t sp, uint32_t delay_ms);
+bool watchdog_caused_reboot(void);
+bool watchdog_enable_caused_reboot(void);
+void watchdog_enable(uint32_t delay_ms, bool pause_on_debug);
+void watchdog_update(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,6 @@
+#ifndef _HOST_TUSB_USBH_H_
+#define _HOST_TUSB_USBH_H_
+
+#include "tusb.h"
+
+#endif
@@ -0,0 +1,35 @@
+#ifndef _HOST_TUSB_USBH_PVT_H_
+#define _HOST_TUSB_USBH_PVT_H_
+
+#include "host/usbh.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+	char const * name;
+	bool (*init)(void);
+	bool (*deinit)(void);
+	bool (*open)(uint8_t rhport, uint8_t dev_addr, tusb_desc_interface_t const * itf_desc, uint16_t max_len);
+	bool (*set_config)(uint8_t dev_addr, uint8_t itf_num);
+	bool (*xfer_cb)(uint8_t dev_addr, uint8_t ep_addr, xfer_result_t result, uint32_t xferred_bytes);
+	void (*close)(uint8_t dev_addr);
+} usbh_class_driver_t;
+
+usbh_class_driver_t const * usbh_app_driver_get_cb(uint8_t * driver_count);
+
+void usbh_driver_set_config_complete(uint8_t dev_addr, uint8_t itf_num);
+bool usbh_edpt_xfer_with_callback(uint8_t dev_addr, uint8_t ep_addr, uint8_t * buffer, uint16_t total_bytes, tuh_xfer_cb_t complete_cb, uintptr_t user_data);
+static inline bool usbh_edpt_xfer(uint8_t dev_addr, uint8_t ep_addr, uint8_t * buffer, uint16_t total_bytes) {
+	return usbh_edpt_xfer_with_callback(dev_addr, ep_addr, buffer, total_bytes, NULL, 0);
+}
+bool usbh_edpt_claim(uint8_t dev_addr, uint8_t ep_addr);
+bool usbh_edpt_release(uint8_t dev_addr, uint8_t ep_addr);
+bool usbh_edpt_busy(uint8_t dev_addr, uint8_t ep_addr);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
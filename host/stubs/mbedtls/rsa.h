@@ -0,0 +1,26 @@
+#ifndef _HOST_MBEDTLS_RSA_H_
+#define _HOST_MBEDTLS_RSA_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Only the types the config and PS4 auth headers name; no RSA is done on the host
+typedef uint32_t mbedtls_mpi_uint;
+
+typedef struct mbedtls_mpi {
+	int s;
+	size_t n;
+	mbedtls_mpi_uint * p;
+} mbedtls_mpi;
+
+struct mbedtls_rsa_context {
+	int ver;
+	size_t len;
+	mbedtls_mpi N, E, D, P, Q, DP, DQ, QP, RN, RP, RQ, Vi, Vf;
+	int padding;
+	int hash_id;
+};
+
+typedef struct mbedtls_rsa_context mbedtls_rsa_context;
+
+#endif
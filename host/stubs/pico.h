@@ -0,0 +1,61 @@
+/*
+ * SPDX-License-Identifier: MIT
+ * SPDX-FileCopyrightText: Copyright (c) 2024 OpenStickCommunity (gp2040-ce.info)
+ */
+
+// Host stand-ins for the parts of the Pico SDK the firmware uses. Only the declarations and
+// register layouts the sources touch are provided; behaviour lives in host/src/hostsim.cpp.
+
+#ifndef _HOST_PICO_H_
+#define _HOST_PICO_H_
+
+#include "pico/types.h"
+#include "pico/platform.h"
+#include "hardware/platform_defs.h"
+
+#define PICO_SDK_VERSION_MAJOR 2
+#define PICO_SDK_VERSION_MINOR 1
+#define PICO_SDK_VERSION_REVISION 1
+#define PICO_RP2040 1
+
+#define PICO_OK 0
+#define PICO_ERROR_NONE 0
+#define PICO_ERROR_GENERIC -1
+#define PICO_ERROR_TIMEOUT -2
+#define PICO_ERROR_NO_DATA -3
+
+#ifndef count_of
+#define count_of(a) (sizeof(a)/sizeof((a)[0]))
+#endif
+
+#ifndef MIN
+#define MIN(a, b) ((b) < (a) ? (b) : (a))
+#endif
+
+#ifndef MAX
+#define MAX(a, b) ((a) < (b) ? (b) : (a))
+#endif
+
+#define __not_in_flash(group)
+#define __not_in_flash_func(func_name) func_name
+#define __time_critical_func(func_name) func_name
+#define __no_inline_not_in_flash_func(func_name) __attribute__((noinline)) func_name
+#define __scratch_x(group)
+#define __scratch_y(group)
+#define __in_flash(group)
+#define __uninitialized_ram(var) var
+#define __isr
+#define __force_inline inline __attribute__((always_inline))
+#ifndef __unused
+#define __unused __attribute__((unused))
+#endif
+#ifndef __packed
+#define __packed __attribute__((packed))
+#endif
+#ifndef __aligned
+#define __aligned(x) __attribute__((aligned(x)))
+#endif
+
+#define _u(x) x ## u
+
+#endif
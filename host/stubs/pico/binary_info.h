@@ -0,0 +1,10 @@
+#ifndef _HOST_PICO_BINARY_INFO_H_
+#define _HOST_PICO_BINARY_INFO_H_
+
+#define bi_decl(_decl)
+#define bi_decl_if_func_used(_decl)
+#define bi_program_feature(feature) 0
+#define bi_program_name(name) 0
+#define bi_program_version_string(version) 0
+
+#endif
@@ -0,0 +1,6 @@
+#ifndef _HOST_PICO_BINARY_INFO_CODE_H_
+#define _HOST_PICO_BINARY_INFO_CODE_H_
+
+#include "pico/binary_info.h"
+
+#endif
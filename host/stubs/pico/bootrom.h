@@ -0,0 +1,16 @@
+#ifndef _HOST_PICO_BOOTROM_H_
+#define _HOST_PICO_BOOTROM_H_
+
+#include "pico.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void reset_usb_boot(uint32_t usb_activity_gpio_pin_mask, uint32_t disable_interface_mask);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,7 @@
+#ifndef _HOST_PICO_LOCK_CORE_H_
+#define _HOST_PICO_LOCK_CORE_H_
+
+#include "pico.h"
+#include "hardware/sync.h"
+
+#endif
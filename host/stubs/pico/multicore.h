@@ -0,0 +1,24 @@
+#ifndef _HOST_PICO_MULTICORE_H_
+#define _HOST_PICO_MULTICORE_H_
+
+#include "pico.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Core1 is never started on the host; tests call the Core1 code directly
+void multicore_launch_core1(void (*entry)(void));
+void multicore_reset_core1(void);
+void multicore_lockout_victim_init(void);
+bool multicore_lockout_victim_is_initialized(uint core_num);
+void multicore_lockout_start_blocking(void);
+bool multicore_lockout_start_timeout_us(uint64_t timeout_us);
+void multicore_lockout_end_blocking(void);
+bool multicore_lockout_end_timeout_us(uint64_t timeout_us);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
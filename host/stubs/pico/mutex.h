@@ -0,0 +1,26 @@
+#ifndef _HOST_PICO_MUTEX_H_
+#define _HOST_PICO_MUTEX_H_
+
+#include "pico/lock_core.h"
+#include "pico/time.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct { int8_t owner; } mutex_t;
+typedef struct { int8_t owner; uint8_t enter_count; } recursive_mutex_t;
+
+void mutex_init(mutex_t * mtx);
+void mutex_enter_blocking(mutex_t * mtx);
+bool mutex_try_enter(mutex_t * mtx, uint32_t * owner_out);
+void mutex_exit(mutex_t * mtx);
+void recursive_mutex_init(recursive_mutex_t * mtx);
+void recursive_mutex_enter_blocking(recursive_mutex_t * mtx);
+void recursive_mutex_exit(recursive_mutex_t * mtx);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
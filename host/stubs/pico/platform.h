@@ -0,0 +1,22 @@
+#ifndef _HOST_PICO_PLATFORM_H_
+#define _HOST_PICO_PLATFORM_H_
+
+#include "pico.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// The host runs everything on one thread, which stands in for Core0
+static inline uint get_core_num(void) { return 0; }
+
+// Busy-wait loops call this, so the simulated peripherals and interrupts make progress while the firmware spins
+void tight_loop_contents(void);
+
+static inline void __breakpoint(void) {}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
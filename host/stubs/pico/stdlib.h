@@ -0,0 +1,25 @@
+#ifndef _HOST_PICO_STDLIB_H_
+#define _HOST_PICO_STDLIB_H_
+
+#include <stdio.h>
+#include <string.h>
+
+#include "pico.h"
+#include "pico/time.h"
+#include "hardware/gpio.h"
+#include "hardware/uart.h"
+
+#define PICO_DEFAULT_LED_PIN 25
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+bool set_sys_clock_khz(uint32_t freq_khz, bool required);
+bool stdio_init_all(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,60 @@
+#ifndef _HOST_PICO_TIME_H_
+#define _HOST_PICO_TIME_H_
+
+#include "pico.h"
+#include "hardware/timer.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Time since "boot" in microseconds, see hostTimeSetManual() for a clock the tests drive
+absolute_time_t get_absolute_time(void);
+
+static inline uint64_t to_us_since_boot(absolute_time_t t) { return t; }
+static inline uint32_t to_ms_since_boot(absolute_time_t t) { return (uint32_t)(t / 1000); }
+static inline void update_us_since_boot(absolute_time_t * t, uint64_t us) { *t = us; }
+static inline absolute_time_t from_us_since_boot(uint64_t us) { return us; }
+static inline bool is_nil_time(absolute_time_t t) { return t == nil_time; }
+static inline bool is_at_the_end_of_time(absolute_time_t t) { return t == at_the_end_of_time; }
+static inline int64_t absolute_time_diff_us(absolute_time_t from, absolute_time_t to) { return (int64_t)(to - from); }
+static inline absolute_time_t absolute_time_min(absolute_time_t a, absolute_time_t b) { return a < b ? a : b; }
+static inline absolute_time_t delayed_by_us(absolute_time_t t, uint64_t us) { return t + us; }
+static inline absolute_time_t delayed_by_ms(absolute_time_t t, uint32_t ms) { return t + ms * 1000ull; }
+static inline absolute_time_t make_timeout_time_us(uint64_t us) { return get_absolute_time() + us; }
+static inline absolute_time_t make_timeout_time_ms(uint32_t ms) { return get_absolute_time() + ms * 1000ull; }
+static inline bool time_reached(absolute_time_t t) { return get_absolute_time() >= t; }
+
+void sleep_until(absolute_time_t target);
+void sleep_us(uint64_t us);
+void sleep_ms(uint32_t ms);
+bool best_effort_wfe_or_timeout(absolute_time_t timeout_timestamp);
+
+typedef int32_t alarm_id_t;
+typedef int64_t (*alarm_callback_t)(alarm_id_t id, void * user_data);
+
+alarm_id_t add_alarm_at(absolute_time_t time, alarm_callback_t callback, void * user_data, bool fire_if_past);
+alarm_id_t add_alarm_in_us(uint64_t us, alarm_callback_t callback, void * user_data, bool fire_if_past);
+alarm_id_t add_alarm_in_ms(uint32_t ms, alarm_callback_t callback, void * user_data, bool fire_if_past);
+bool cancel_alarm(alarm_id_t alarm_id);
+
+typedef struct repeating_timer repeating_timer_t;
+typedef bool (*repeating_timer_callback_t)(repeating_timer_t * rt);
+
+struct repeating_timer {
+	int64_t delay_us;
+	void * pool;
+	alarm_id_t alarm_id;
+	repeating_timer_callback_t callback;
+	void * user_data;
+};
+
+bool add_repeating_timer_us(int64_t delay_us, repeating_timer_callback_t callback, void * user_data, repeating_timer_t * out);
+bool add_repeating_timer_ms(int32_t delay_ms, repeating_timer_callback_t callback, void * user_data, repeating_timer_t * out);
+bool cancel_repeating_timer(repeating_timer_t * timer);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
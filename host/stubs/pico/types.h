@@ -0,0 +1,16 @@
+#ifndef _HOST_PICO_TYPES_H_
+#define _HOST_PICO_TYPES_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <assert.h>
+
+typedef unsigned int uint;
+
+typedef uint64_t absolute_time_t;
+
+#define nil_time ((absolute_time_t)0)
+#define at_the_end_of_time ((absolute_time_t)0x7fffffffffffffffull)
+
+#endif
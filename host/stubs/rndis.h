@@ -0,0 +1,17 @@
+#ifndef _HOST_RNDIS_H_
+#define _HOST_RNDIS_H_
+
+// Web config is not part of the host build, these do nothing
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+int rndis_init(void);
+void rndis_task(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
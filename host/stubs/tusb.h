@@ -0,0 +1,329 @@
+/*
+ * SPDX-License-Identifier: MIT
+ * SPDX-FileCopyrightText: Copyright (c) 2024 OpenStickCommunity (gp2040-ce.info)
+ */
+
+// Host stand-in for the TinyUSB API the firmware uses. The device stack is reduced to a report
+// sink that tests can inspect (see hostUsb*() in hostsim.h); the host stack never mounts anything.
+
+#ifndef _HOST_TUSB_H_
+#define _HOST_TUSB_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+
+#include "tusb_option.h"
+#include "tusb_config.h"
+
+#define TU_ATTR_PACKED __attribute__((packed))
+#define TU_ATTR_ALIGNED(x) __attribute__((aligned(x)))
+#define TU_ATTR_WEAK __attribute__((weak))
+#define TU_ATTR_ALWAYS_INLINE __attribute__((always_inline))
+#define TU_ATTR_UNUSED __attribute__((unused))
+#define TU_ATTR_SECTION(sec_name) __attribute__((section(#sec_name)))
+
+#define TU_U16(high, low) ((uint16_t)((((uint16_t)(high)) << 8) | (low)))
+#define TU_U16_HIGH(u16) ((uint8_t)(((u16) >> 8) & 0x00ff))
+#define TU_U16_LOW(u16) ((uint8_t)((u16) & 0x00ff))
+#define U16_TO_U8S_LE(u16) TU_U16_LOW(u16), TU_U16_HIGH(u16)
+#define TU_MIN(a, b) ((a) < (b) ? (a) : (b))
+#define TU_MAX(a, b) ((a) > (b) ? (a) : (b))
+#define TU_ARRAY_SIZE(a) (sizeof(a) / sizeof((a)[0]))
+#define TU_BIT(n) (1UL << (n))
+
+// As in TinyUSB: a failed check returns false, or the second argument when there is one
+#define TU_GET_3RD_ARG(arg1, arg2, arg3, ...) arg3
+#define TU_VERIFY_1ARGS(cond) do { if (!(cond)) return false; } while (0)
+#define TU_VERIFY_2ARGS(cond, ret) do { if (!(cond)) return ret; } while (0)
+#define TU_VERIFY(...) TU_GET_3RD_ARG(__VA_ARGS__, TU_VERIFY_2ARGS, TU_VERIFY_1ARGS, _)(__VA_ARGS__)
+#define TU_ASSERT(...) TU_VERIFY(__VA_ARGS__)
+#define TU_LOG1(...)
+#define TU_LOG2(...)
+#define TU_LOG_DRV(...)
+
+#define TUD_OPT_RHPORT BOARD_TUD_RHPORT
+#define TUH_CFGID_RPI_PIO_USB_CONFIGURATION 100
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum {
+	TUSB_SPEED_FULL = 0,
+	TUSB_SPEED_LOW = 1,
+	TUSB_SPEED_HIGH = 2,
+	TUSB_SPEED_INVALID = 0xff,
+} tusb_speed_t;
+
+typedef enum {
+	TUSB_XFER_CONTROL = 0,
+	TUSB_XFER_ISOCHRONOUS,
+	TUSB_XFER_BULK,
+	TUSB_XFER_INTERRUPT
+} tusb_xfer_type_t;
+
+typedef enum {
+	TUSB_DIR_OUT = 0,
+	TUSB_DIR_IN = 1,
+	TUSB_DIR_IN_MASK = 0x80
+} tusb_dir_t;
+
+typedef enum {
+	TUSB_DESC_DEVICE = 0x01,
+	TUSB_DESC_CONFIGURATION = 0x02,
+	TUSB_DESC_STRING = 0x03,
+	TUSB_DESC_INTERFACE = 0x04,
+	TUSB_DESC_ENDPOINT = 0x05,
+	TUSB_DESC_DEVICE_QUALIFIER = 0x06,
+	TUSB_DESC_OTHER_SPEED_CONFIG = 0x07,
+	TUSB_DESC_INTERFACE_POWER = 0x08,
+	TUSB_DESC_OTG = 0x09,
+	TUSB_DESC_DEBUG = 0x0A,
+	TUSB_DESC_INTERFACE_ASSOCIATION = 0x0B,
+	TUSB_DESC_BOS = 0x0F,
+	TUSB_DESC_DEVICE_CAPABILITY = 0x10,
+	TUSB_DESC_CS_DEVICE = 0x21,
+	TUSB_DESC_CS_CONFIGURATION = 0x22,
+	TUSB_DESC_CS_STRING = 0x23,
+	TUSB_DESC_CS_INTERFACE = 0x24,
+	TUSB_DESC_CS_ENDPOINT = 0x25,
+} tusb_desc_type_t;
+
+typedef enum {
+	TUSB_REQ_GET_STATUS = 0,
+	TUSB_REQ_CLEAR_FEATURE = 1,
+	TUSB_REQ_SET_FEATURE = 3,
+	TUSB_REQ_SET_ADDRESS = 5,
+	TUSB_REQ_GET_DESCRIPTOR = 6,
+	TUSB_REQ_SET_DESCRIPTOR = 7,
+	TUSB_REQ_GET_CONFIGURATION = 8,
+	TUSB_REQ_SET_CONFIGURATION = 9,
+	TUSB_REQ_GET_INTERFACE = 10,
+	TUSB_REQ_SET_INTERFACE = 11,
+	TUSB_REQ_SYNCH_FRAME = 12
+} tusb_request_code_t;
+
+typedef enum {
+	TUSB_REQ_TYPE_STANDARD = 0,
+	TUSB_REQ_TYPE_CLASS,
+	TUSB_REQ_TYPE_VENDOR,
+	TUSB_REQ_TYPE_INVALID
+} tusb_request_type_t;
+
+typedef enum {
+	TUSB_REQ_RCPT_DEVICE = 0,
+	TUSB_REQ_RCPT_INTERFACE,
+	TUSB_REQ_RCPT_ENDPOINT,
+	TUSB_REQ_RCPT_OTHER
+} tusb_request_recipient_t;
+
+typedef enum {
+	TUSB_CLASS_UNSPECIFIED = 0,
+	TUSB_CLASS_AUDIO = 1,
+	TUSB_CLASS_CDC = 2,
+	TUSB_CLASS_HID = 3,
+	TUSB_CLASS_RESERVED_4 = 4,
+	TUSB_CLASS_PHYSICAL = 5,
+	TUSB_CLASS_IMAGE = 6,
+	TUSB_CLASS_PRINTER = 7,
+	TUSB_CLASS_MSC = 8,
+	TUSB_CLASS_HUB = 9,
+	TUSB_CLASS_CDC_DATA = 10,
+	TUSB_CLASS_SMART_CARD = 11,
+	TUSB_CLASS_RESERVED_12 = 12,
+	TUSB_CLASS_CONTENT_SECURITY = 13,
+	TUSB_CLASS_VIDEO = 14,
+	TUSB_CLASS_PERSONAL_HEALTHCARE = 15,
+	TUSB_CLASS_AUDIO_VIDEO = 16,
+	TUSB_CLASS_DIAGNOSTIC = 0xDC,
+	TUSB_CLASS_WIRELESS_CONTROLLER = 0xE0,
+	TUSB_CLASS_MISC = 0xEF,
+	TUSB_CLASS_APPLICATION_SPECIFIC = 0xFE,
+	TUSB_CLASS_VENDOR_SPECIFIC = 0xFF
+} tusb_class_code_t;
+
+typedef enum {
+	XFER_RESULT_SUCCESS = 0,
+	XFER_RESULT_FAILED,
+	XFER_RESULT_STALLED,
+	XFER_RESULT_TIMEOUT,
+	XFER_RESULT_INVALID
+} xfer_result_t;
+
+enum {
+	CONTROL_STAGE_IDLE = 0,
+	CONTROL_STAGE_SETUP,
+	CONTROL_STAGE_DATA,
+	CONTROL_STAGE_ACK
+};
+
+enum {
+	TUSB_DESC_CONFIG_ATT_REMOTE_WAKEUP = 1u << 5,
+	TUSB_DESC_CONFIG_ATT_SELF_POWERED = 1u << 6,
+};
+
+#define TUSB_DESC_CONFIG_POWER_MA(x) ((x) / 2)
+
+typedef struct TU_ATTR_PACKED {
+	uint8_t bLength;
+	uint8_t bDescriptorType;
+	uint16_t bcdUSB;
+	uint8_t bDeviceClass;
+	uint8_t bDeviceSubClass;
+	uint8_t bDeviceProtocol;
+	uint8_t bMaxPacketSize0;
+	uint16_t idVendor;
+	uint16_t idProduct;
+	uint16_t bcdDevice;
+	uint8_t iManufacturer;
+	uint8_t iProduct;
+	uint8_t iSerialNumber;
+	uint8_t bNumConfigurations;
+} tusb_desc_device_t;
+
+typedef struct TU_ATTR_PACKED {
+	uint8_t bLength;
+	uint8_t bDescriptorType;
+	uint16_t wTotalLength;
+	uint8_t bNumInterfaces;
+	uint8_t bConfigurationValue;
+	uint8_t iConfiguration;
+	uint8_t bmAttributes;
+	uint8_t bMaxPower;
+} tusb_desc_configuration_t;
+
+typedef struct TU_ATTR_PACKED {
+	uint8_t bLength;
+	uint8_t bDescriptorType;
+	uint8_t bInterfaceNumber;
+	uint8_t bAlternateSetting;
+	uint8_t bNumEndpoints;
+	uint8_t bInterfaceClass;
+	uint8_t bInterfaceSubClass;
+	uint8_t bInterfaceProtocol;
+	uint8_t iInterface;
+} tusb_desc_interface_t;
+
+typedef struct TU_ATTR_PACKED {
+	uint8_t bLength;
+	uint8_t bDescriptorType;
+	uint8_t bEndpointAddress;
+	struct TU_ATTR_PACKED {
+		uint8_t xfer : 2;
+		uint8_t sync : 2;
+		uint8_t usage : 2;
+		uint8_t : 2;
+	} bmAttributes;
+	uint16_t wMaxPacketSize;
+	uint8_t bInterval;
+} tusb_desc_endpoint_t;
+
+typedef struct TU_ATTR_PACKED {
+	union {
+		struct TU_ATTR_PACKED {
+			uint8_t recipient : 5;
+			uint8_t type : 2;
+			uint8_t direction : 1;
+		} bmRequestType_bit;
+		uint8_t bmRequestType;
+	};
+	uint8_t bRequest;
+	uint16_t wValue;
+	uint16_t wIndex;
+	uint16_t wLength;
+} tusb_control_request_t;
+
+static inline uint16_t tu_le16toh(uint16_t v) { return v; }
+static inline uint16_t tu_htole16(uint16_t v) { return v; }
+static inline uint8_t const * tu_desc_next(void const * desc) { return (uint8_t const *)desc + ((uint8_t const *)desc)[0]; }
+static inline uint8_t tu_desc_type(void const * desc) { return ((uint8_t const *)desc)[1]; }
+static inline uint8_t tu_desc_len(void const * desc) { return ((uint8_t const *)desc)[0]; }
+static inline tusb_dir_t tu_edpt_dir(uint8_t addr) { return (addr & TUSB_DIR_IN_MASK) ? TUSB_DIR_IN : TUSB_DIR_OUT; }
+static inline uint8_t tu_edpt_number(uint8_t addr) { return (uint8_t)(addr & (~TUSB_DIR_IN_MASK)); }
+static inline uint8_t tu_edpt_addr(uint8_t num, uint8_t dir) { return (uint8_t)(num | (dir ? TUSB_DIR_IN_MASK : 0)); }
+static inline uint16_t tu_edpt_packet_size(tusb_desc_endpoint_t const * desc_ep) { return tu_le16toh(desc_ep->wMaxPacketSize) & 0x7FF; }
+static inline void tu_memclr(void * buffer, size_t size) { memset(buffer, 0, size); }
+
+//--------------------------------------------------------------------+
+// Device stack
+//--------------------------------------------------------------------+
+
+bool tud_init(uint8_t rhport);
+bool tud_inited(void);
+void tud_task(void);
+bool tud_task_event_ready(void);
+bool tud_mounted(void);
+bool tud_ready(void);
+bool tud_suspended(void);
+bool tud_remote_wakeup(void);
+bool tud_disconnect(void);
+bool tud_connect(void);
+tusb_speed_t tud_speed_get(void);
+bool tud_control_xfer(uint8_t rhport, tusb_control_request_t const * request, void * buffer, uint16_t len);
+bool tud_control_status(uint8_t rhport, tusb_control_request_t const * request);
+
+typedef enum {
+	DCD_EVENT_INVALID = 0,
+	DCD_EVENT_BUS_RESET,
+	DCD_EVENT_UNPLUGGED,
+	DCD_EVENT_SOF,
+	DCD_EVENT_SUSPEND,
+	DCD_EVENT_RESUME,
+	DCD_EVENT_SETUP_RECEIVED,
+	DCD_EVENT_XFER_COMPLETE,
+	USBD_EVENT_FUNC_CALL,
+	DCD_EVENT_COUNT
+} dcd_eventid_t;
+
+// Application callbacks, weak defaults live in hostsim
+void tud_event_hook_cb(uint8_t rhport, uint32_t eventid, bool in_isr);
+void tud_mount_cb(void);
+void tud_umount_cb(void);
+void tud_suspend_cb(bool remote_wakeup_en);
+void tud_resume_cb(void);
+
+//--------------------------------------------------------------------+
+// Host stack
+//--------------------------------------------------------------------+
+
+struct tuh_xfer_s;
+typedef struct tuh_xfer_s tuh_xfer_t;
+typedef void (*tuh_xfer_cb_t)(tuh_xfer_t * xfer);
+
+struct tuh_xfer_s {
+	uint8_t daddr;
+	uint8_t ep_addr;
+	uint8_t reserved;
+	xfer_result_t result;
+	uint32_t actual_len;
+	union {
+		tusb_control_request_t const * setup;
+		uint32_t buflen;
+	};
+	uint8_t * buffer;
+	tuh_xfer_cb_t complete_cb;
+	uintptr_t user_data;
+};
+
+bool tuh_configure(uint8_t rhport, uint32_t cfg_id, const void * cfg_param);
+bool tuh_init(uint8_t rhport);
+bool tuh_deinit(uint8_t rhport);
+bool tuh_inited(void);
+void tuh_task(void);
+bool tuh_mounted(uint8_t daddr);
+bool tuh_ready(uint8_t daddr);
+bool tuh_vid_pid_get(uint8_t daddr, uint16_t * vid, uint16_t * pid);
+bool tuh_control_xfer(tuh_xfer_t * xfer);
+bool tuh_edpt_open(uint8_t daddr, tusb_desc_endpoint_t const * desc_ep);
+
+#ifdef __cplusplus
+}
+#endif
+
+#include "class/hid/hid.h"
+#include "class/hid/hid_device.h"
+#include "class/hid/hid_host.h"
+
+#endif
@@ -0,0 +1,26 @@
+#ifndef _HOST_TUSB_OPTION_H_
+#define _HOST_TUSB_OPTION_H_
+
+#define TUSB_VERSION_MAJOR 0
+#define TUSB_VERSION_MINOR 17
+#define TUSB_VERSION_REVISION 0
+
+#define OPT_MCU_RP2040 1800
+
+#define OPT_OS_NONE 1
+#define OPT_OS_FREERTOS 2
+#define OPT_OS_MYNEWT 3
+#define OPT_OS_CUSTOM 4
+#define OPT_OS_PICO 5
+
+#define OPT_MODE_NONE 0x0000
+#define OPT_MODE_DEVICE 0x0001
+#define OPT_MODE_HOST 0x0002
+#define OPT_MODE_FULL_SPEED 0x0000
+#define OPT_MODE_LOW_SPEED 0x0100
+#define OPT_MODE_HIGH_SPEED 0x0200
+#define OPT_MODE_DEFAULT_SPEED 0x0000
+
+#include "tusb_config.h"
+
+#endif
@@ -0,0 +1,17 @@
+/*
+ * SPDX-License-Identifier: MIT
+ * SPDX-FileCopyrightText: Copyright (c) 2024 OpenStickCommunity (gp2040-ce.info)
+ */
+
+// The float stick pipeline (ANALOG_FIXED_POINT=0) under its own name, the reference for
+// test_analog_parity. gp2040_host builds the fixed-point one.
+
+#define ANALOG_FIXED_POINT 0
+#define AnalogInput AnalogInputFloat
+#define adc_instance adc_instance_float
+
+#include "../../src/addons/analog.cpp"
+
+GPAddon * createFloatAnalogInput() {
+	return new AnalogInputFloat();
+}
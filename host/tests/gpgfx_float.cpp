@@ -0,0 +1,291 @@
+/*
+ * SPDX-License-Identifier: MIT
+ * SPDX-FileCopyrightText: Copyright (c) 2024 OpenStickCommunity (gp2040-ce.info)
+ */
+
+// The double precision shape rasterizer the tiny SSD1306 driver had before it moved to integer math, kept
+// as the reference for test_gpgfx_raster. Everything but arcs, rectangles, polygons and pills is the
+// driver's own. The pill keeps one fix: both round ends use the same angle offset, the horizontal one
+// used to bend them inward.
+
+#include <math.h>
+
+#include "tiny_ssd1306.h"
+
+class GPGFX_FloatShapes : public GPGFX_TinySSD1306 {
+    public:
+        void drawArc(uint16_t x, uint16_t y, uint32_t radiusX, uint32_t radiusY, uint32_t color, uint8_t filled, double startAngle, double endAngle, uint8_t closed) override;
+        void drawRectangle(uint16_t x, uint16_t y, uint16_t width, uint16_t height, uint32_t color, uint8_t filled, double rotationAngle = 0) override;
+        void drawPolygon(uint16_t x, uint16_t y, uint16_t radius, uint16_t sides, uint32_t color, uint8_t filled, double rotation = 0) override;
+        void drawPill(uint16_t x, uint16_t y, uint16_t width, uint16_t height, uint32_t color, uint8_t filled, double rotationAngle = 0) override;
+};
+
+void GPGFX_FloatShapes::drawArc(uint16_t x, uint16_t y, uint32_t radiusX, uint32_t radiusY, uint32_t color, uint8_t filled, double startAngle, double endAngle, uint8_t closed) {
+    // Convert degrees to radians
+    startAngle = startAngle * M_PI / 180.0;
+    endAngle = endAngle * M_PI / 180.0;
+
+    // Angle step based on the resolution you want
+    double angleStep = 0.01; // Adjust as needed for smoother arcs
+
+    for (double angle = startAngle; angle < endAngle; angle += angleStep) {
+        int xPos = x + static_cast<int>(radiusX * cos(angle));
+        int yPos = y + static_cast<int>(radiusY * sin(angle));
+        drawPixel(xPos, yPos, color);
+    }
+
+    // Draw the last point
+    int xPos = x + static_cast<int>(radiusX * cos(endAngle));
+    int yPos = y + static_cast<int>(radiusY * sin(endAngle));
+    drawPixel(xPos, yPos, color);
+
+    if (closed) {
+        drawLine(x, y, (x + static_cast<int>(radiusX * cos(startAngle))), (y + static_cast<int>(radiusY * sin(startAngle))), color, filled);
+        drawLine(x, y, (x + static_cast<int>(radiusX * cos(endAngle))), (y + static_cast<int>(radiusY * sin(endAngle))), color, filled);
+    }
+
+    // If filled is true, fill the arc
+    if (filled) {
+        // Draw lines to fill the arc
+        for (double angle = startAngle; angle <= endAngle; angle += angleStep) {
+            int xPosStart = x;
+            int yPosStart = y;
+            int xPosEnd = x + static_cast<int>(radiusX * cos(angle));
+            int yPosEnd = y + static_cast<int>(radiusY * sin(angle));
+            // Draw line from center to arc point
+            // You may replace this with your actual line drawing function
+            //drawPixel(xPosStart, yPosStart, color);
+            //drawPixel(xPosEnd, yPosEnd, color);
+            drawLine(xPosStart, yPosStart, xPosEnd, yPosEnd, color, filled);
+        }
+    }
+}
+
+void GPGFX_FloatShapes::drawRectangle(uint16_t x, uint16_t y, uint16_t width, uint16_t height, uint32_t color, uint8_t filled, double rotationAngle) {
+    // Calculate center point of the rectangle
+    double centerX = (x + width) / 2.0;
+    double centerY = (y + height) / 2.0;
+
+    // Calculate half width and half height for easier calculations
+    double halfWidth = (width - x) / 2.0;
+    double halfHeight = (height - y) / 2.0;
+
+    // Convert rotation angle to radians
+    double angleRad = rotationAngle * M_PI / 180.0;
+
+    // Pre-calculate sine and cosine of the rotation angle
+    double cosA = cos(angleRad);
+    double sinA = sin(angleRad);
+
+    // Calculate rotated coordinates for each corner of the rectangle
+    double x0 = centerX + cosA * (-halfWidth) - sinA * (-halfHeight);
+    double y0 = centerY + sinA * (-halfWidth) + cosA * (-halfHeight);
+
+    double x1 = centerX + cosA * (halfWidth) - sinA * (-halfHeight);
+    double y1 = centerY + sinA * (halfWidth) + cosA * (-halfHeight);
+
+    double x2 = centerX + cosA * (halfWidth) - sinA * (halfHeight);
+    double y2 = centerY + sinA * (halfWidth) + cosA * (halfHeight);
+
+    double x3 = centerX + cosA * (-halfWidth) - sinA * (halfHeight);
+    double y3 = centerY + sinA * (-halfWidth) + cosA * (halfHeight);
+
+    // Round coordinates to nearest integer
+    uint16_t x0_rounded = (uint16_t)round(x0);
+    uint16_t y0_rounded = (uint16_t)round(y0);
+    uint16_t x1_rounded = (uint16_t)round(x1);
+    uint16_t y1_rounded = (uint16_t)round(y1);
+    uint16_t x2_rounded = (uint16_t)round(x2);
+    uint16_t y2_rounded = (uint16_t)round(y2);
+    uint16_t x3_rounded = (uint16_t)round(x3);
+    uint16_t y3_rounded = (uint16_t)round(y3);
+
+    // Draw lines between rotated coordinates
+    drawLine(x0_rounded, y0_rounded, x1_rounded, y1_rounded, color, filled);
+    drawLine(x1_rounded, y1_rounded, x2_rounded, y2_rounded, color, filled);
+    drawLine(x2_rounded, y2_rounded, x3_rounded, y3_rounded, color, filled);
+    drawLine(x3_rounded, y3_rounded, x0_rounded, y0_rounded, color, filled);
+
+	if (filled) {
+        // Calculate the number of lines needed for the filling
+        uint16_t numLines = (uint16_t)round(sqrt(halfWidth * halfWidth + halfHeight * halfHeight) * 2);
+
+        for (uint16_t i = 0; i <= numLines; i++) {
+            double t = (double)i / numLines;
+            double xStart = (1 - t) * x0 + t * x3;
+            double yStart = (1 - t) * y0 + t * y3;
+            double xEnd = (1 - t) * x1 + t * x2;
+            double yEnd = (1 - t) * y1 + t * y2;
+
+            drawLine((uint16_t)round(xStart), (uint16_t)round(yStart), (uint16_t)round(xEnd), (uint16_t)round(yEnd), color, filled);
+        }
+	}
+}
+
+void GPGFX_FloatShapes::drawPolygon(uint16_t x, uint16_t y, uint16_t radius, uint16_t sides, uint32_t color, uint8_t filled, double rotation) {
+    // Calculate the angle increment between each vertex
+    double angleIncrement = 2 * M_PI / sides;
+
+    // Calculate vertices
+    uint16_t xVertices[sides];
+    uint16_t yVertices[sides];
+    for (int i = 0; i < sides; i++) {
+        double angle = i * angleIncrement + rotation;
+        xVertices[i] = x + round(radius * cos(angle));
+        yVertices[i] = y + round(radius * sin(angle));
+    }
+
+    // Draw lines between vertices
+    for (int i = 0; i < sides - 1; i++) {
+        drawLine(xVertices[i], yVertices[i], xVertices[i + 1], yVertices[i + 1], color, false);
+    }
+    drawLine(xVertices[sides - 1], yVertices[sides - 1], xVertices[0], yVertices[0], color, false);
+
+    if (filled) {
+        // Find the minimum and maximum y coordinates to scan
+        uint16_t minY = yVertices[0], maxY = yVertices[0];
+        for (int i = 1; i < sides; i++) {
+            if (yVertices[i] < minY) minY = yVertices[i];
+            if (yVertices[i] > maxY) maxY = yVertices[i];
+        }
+
+        // Scan horizontally and draw lines between intersections
+        for (int scanY = minY + 1; scanY < maxY; scanY++) {
+            int intersections = 0;
+            double intersectPoints[sides];
+
+            for (int i = 0; i < sides; i++) {
+                int next = (i + 1) % sides;
+                if ((yVertices[i] < scanY && yVertices[next] >= scanY) || (yVertices[next] < scanY && yVertices[i] >= scanY)) {
+                    intersectPoints[intersections++] = xVertices[i] + (scanY - yVertices[i]) * (xVertices[next] - xVertices[i]) / (yVertices[next] - yVertices[i]);
+                }
+            }
+
+            // Sort the intersection points by x coordinate
+            for (int i = 0; i < intersections - 1; i++) {
+                for (int j = 0; j < intersections - i - 1; j++) {
+                    if (intersectPoints[j] > intersectPoints[j + 1]) {
+                        double temp = intersectPoints[j];
+                        intersectPoints[j] = intersectPoints[j + 1];
+                        intersectPoints[j + 1] = temp;
+                    }
+                }
+            }
+
+            // Draw lines between pairs of intersection points
+            for (int i = 0; i < intersections; i += 2) {
+                drawLine(intersectPoints[i], scanY, intersectPoints[i + 1], scanY, color, false);
+            }
+        }
+    }
+}
+
+void GPGFX_FloatShapes::drawPill(uint16_t x, uint16_t y, uint16_t width, uint16_t height, uint32_t color, uint8_t filled, double rotationAngle) {
+    bool horizontal = (width - x) >= (height - y);
+
+    // Center of the rectangle
+    double centerX = (x + width) / 2.0;
+    double centerY = (y + height) / 2.0;
+
+    // Half dimensions
+    double halfWidth  = (width - x) / 2.0;
+    double halfHeight = (height - y) / 2.0;
+
+    // Pill radius = half of the short axis
+    double radius = horizontal ? halfHeight : halfWidth;
+
+    // Rectangle half-lengths along long and short axes
+    double rectHalfLong  = (horizontal ? halfWidth : halfHeight) - radius;
+    double rectHalfShort = horizontal ? halfHeight : halfWidth;
+
+    // Rotation
+    double angleRad = rotationAngle * M_PI / 180.0;
+    double cosA = cos(angleRad);
+    double sinA = sin(angleRad);
+
+    // Long and short axis vectors
+    double longX = horizontal ? 1.0 : 0.0;
+    double longY = horizontal ? 0.0 : 1.0;
+    double shortX = -longY; // perpendicular to long axis
+    double shortY = longX;
+
+    // Rectangle corners
+    double corners[4][2] = {
+        {-rectHalfLong * longX - rectHalfShort * shortX, -rectHalfLong * longY - rectHalfShort * shortY},
+        { rectHalfLong * longX - rectHalfShort * shortX,  rectHalfLong * longY - rectHalfShort * shortY},
+        { rectHalfLong * longX + rectHalfShort * shortX,  rectHalfLong * longY + rectHalfShort * shortY},
+        {-rectHalfLong * longX + rectHalfShort * shortX, -rectHalfLong * longY + rectHalfShort * shortY}
+    };
+
+    // Rotate rectangle corners
+    uint16_t rx[4], ry[4];
+    for(int i=0; i<4; i++){
+        double xr = centerX + cosA * corners[i][0] - sinA * corners[i][1];
+        double yr = centerY + sinA * corners[i][0] + cosA * corners[i][1];
+        rx[i] = (uint16_t)round(xr);
+        ry[i] = (uint16_t)round(yr);
+    }
+
+    drawLine(rx[0], ry[0], rx[1], ry[1], color, filled); // top
+    drawLine(rx[2], ry[2], rx[3], ry[3], color, filled); // bottom
+
+    if (filled) {
+        double longVecX = cosA * longX - sinA * longY;
+        double longVecY = sinA * longX + cosA * longY;
+        double shortVecX = cosA * shortX - sinA * shortY;
+        double shortVecY = sinA * shortX + cosA * shortY;
+
+        int steps = (int)ceil(2.0 * rectHalfLong * 8.0);
+        if (steps < 1) steps = 1;
+
+        double shortExtra = 0.5;
+
+        for (int k = -steps; k <= steps; k++) {
+            double t = (double)k / steps;
+
+            double baseX = centerX + t * rectHalfLong * longVecX;
+            double baseY = centerY + t * rectHalfLong * longVecY;
+
+            double sx = rectHalfShort * shortVecX + shortExtra * (shortVecX >= 0 ? 1 : -1);
+            double sy = rectHalfShort * shortVecY + shortExtra * (shortVecY >= 0 ? 1 : -1);
+
+            drawLine((uint16_t)round(baseX - sx), (uint16_t)round(baseY - sy), (uint16_t)round(baseX + sx), (uint16_t)round(baseY + sy), color, 1);
+        }
+    }
+
+    int steps = 32;
+    for(int side=-1; side<=1; side+=2){
+        double cx = side * rectHalfLong * longX;
+        double cy = side * rectHalfLong * longY;
+
+        double prevX = 0, prevY = 0;
+        for(int i=0; i<=steps; i++){
+            double t = (double)i / steps;
+            double theta = -M_PI/2 + t * M_PI;
+            if(side == -1) theta = M_PI/2 + t * M_PI;
+
+            double thetaOffset = M_PI/2;
+            double arcLocalX = cx + radius * cos(theta + thetaOffset) * shortX + radius * sin(theta + thetaOffset) * longX;
+            double arcLocalY = cy + radius * cos(theta + thetaOffset) * shortY + radius * sin(theta + thetaOffset) * longY;
+
+            double rotatedX = centerX + cosA * arcLocalX - sinA * arcLocalY;
+            double rotatedY = centerY + sinA * arcLocalX + cosA * arcLocalY;
+
+            if(i>0){
+                drawLine((uint16_t)round(rotatedX), (uint16_t)round(rotatedY), (uint16_t)round(prevX), (uint16_t)round(prevY), color, filled);
+
+                if (filled) {
+                    double capCenterX = centerX + cosA * cx - sinA * cy;
+                    double capCenterY = centerY + sinA * cx + cosA * cy;
+                    drawLine((uint16_t)round(rotatedX), (uint16_t)round(rotatedY), (uint16_t)round(capCenterX), (uint16_t)round(capCenterY), color, 1);
+                }
+            }
+            prevX = rotatedX;
+            prevY = rotatedY;
+        }
+    }
+}
+
+GPGFX_DisplayBase * createFloatShapesDisplay() {
+    return new GPGFX_FloatShapes();
+}
@@ -0,0 +1,38 @@
+/*
+ * SPDX-License-Identifier: MIT
+ * SPDX-FileCopyrightText: Copyright (c) 2024 OpenStickCommunity (gp2040-ce.info)
+ */
+
+#ifndef _HOSTTEST_H_
+#define _HOSTTEST_H_
+
+#include <stdio.h>
+
+// Minimal checks for the host tests: failures are counted and reported, the test keeps going
+static int hostTestFailures = 0;
+
+#define CHECK(cond) do { \
+	if (!(cond)) { \
+		fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+		hostTestFailures++; \
+	} \
+} while (0)
+
+#define CHECK_EQ(a, b) do { \
+	long long _a = (long long)(a); \
+	long long _b = (long long)(b); \
+	if (_a != _b) { \
+		fprintf(stderr, "%s:%d: CHECK_EQ(%s, %s) failed: %lld != %lld\n", __FILE__, __LINE__, #a, #b, _a, _b); \
+		hostTestFailures++; \
+	} \
+} while (0)
+
+static inline int hostTestResult(const char * name) {
+	if (hostTestFailures)
+		printf("%s: %d check(s) failed\n", name, hostTestFailures);
+	else
+		printf("%s: passed\n", name);
+	return hostTestFailures ? 1 : 0;
+}
+
+#endif
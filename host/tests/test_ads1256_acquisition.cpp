@@ -0,0 +1,421 @@
+/*
+ * SPDX-License-Identifier: MIT
+ * SPDX-FileCopyrightText: Copyright (c) 2024 OpenStickCommunity (gp2040-ce.info)
+ */
+
+// ADS1256 background acquisition: a model of the converter answers the SPI commands and drives DRDY,
+// finishing each conversion the settling time of its data rate after SYNC/WAKEUP and free-running after
+// that. Channel inputs change at random while the DRDY/DMA engine cycles them; every result has to be
+// its own channel's input (never a neighbour's or a stale register), each channel has to convert at its
+// own rate, and t6 has to be kept before every data phase. The addon then has to scale the readings the
+// same as the float conversion it replaced, within 1 LSB, without touching the bus in process().
+
+#include <stdlib.h>
+#include <math.h>
+#include <algorithm>
+#include <vector>
+
+#include "hosttest.h"
+#include "hostsim.h"
+
+#include "ADS1256.h"
+#include "addons/spi_analog_ads1256.h"
+#include "gamepad.h"
+#include "storagemanager.h"
+#include "peripheralmanager.h"
+
+#define DRDY_PIN 20
+#define CS_PIN 17
+#define LOOP_US 10
+#define RUN_US 300000
+#define T6_MIN_NS 6510
+#define PARITY_ROUNDS 400
+#define AVDD 3.3f
+
+// DRATE codes with their settling time after SYNC/WAKEUP (t18, 7.68MHz clock)
+static const struct {
+	uint8_t drate;
+	uint32_t sps;
+	uint32_t settleUs;
+} drates[] = {
+	{ ADS1256_DRATE_30000SPS, 30000, 210 },
+	{ ADS1256_DRATE_15000SPS, 15000, 250 },
+	{ ADS1256_DRATE_7500SPS, 7500, 310 },
+	{ ADS1256_DRATE_3750SPS, 3750, 440 },
+	{ ADS1256_DRATE_2000SPS, 2000, 680 },
+	{ ADS1256_DRATE_1000SPS, 1000, 1180 },
+	{ ADS1256_DRATE_500SPS, 500, 2180 },
+	{ ADS1256_DRATE_100SPS, 100, 10180 },
+};
+
+static int drateIndex(uint8_t drate) {
+	for (size_t i = 0; i < sizeof(drates) / sizeof(drates[0]); i++)
+		if (drates[i].drate == drate) return i;
+	return 0;
+}
+
+static uint64_t spiByteNs() {
+	return 8000000000ull / ADS1256_SPI_SPEED_HZ;
+}
+
+class Ads1256Model : public HostSPIDevice {
+public:
+	int32_t inputs[ADS1256_CHANNEL_COUNT] = {};
+	uint8_t expectedRate[ADS1256_CHANNEL_COUNT] = {};
+	bool checkRates = false;
+
+	uint64_t conversions = 0;
+	uint64_t reads = 0;
+	uint64_t staleReads = 0;
+	uint64_t rateErrors = 0;
+	uint64_t t6Violations = 0;
+	uint64_t t6MinNs = UINT64_MAX;
+
+	Ads1256Model() {
+		regs[ADS1256_REG_STATUS] = 0x30;
+		regs[ADS1256_REG_MUX] = 0x01;
+		regs[ADS1256_REG_ADCON] = 0x20;
+		regs[ADS1256_REG_DRATE] = ADS1256_DRATE_30000SPS;
+		hostGpioSetInput(DRDY_PIN, 0);
+		startConversion(hostTimeNs(), periodNs(regs[ADS1256_REG_DRATE]));
+	}
+
+	uint8_t transfer(uint8_t data) override {
+		uint64_t now = hostTimeNs();
+		if (dataLeft > 0) {
+			if (dataLeft == 3) {
+				uint64_t t6 = now - rdataNs - spiByteNs();
+				t6MinNs = std::min(t6MinNs, t6);
+				if (t6 < T6_MIN_NS)
+					t6Violations++;
+			}
+			dataLeft--;
+			if (dataLeft == 0)
+				hostGpioSetInput(DRDY_PIN, 1);
+			return (readValue >> (8 * dataLeft)) & 0xff;
+		}
+		switch (state) {
+			case COUNT:
+				count = (data & 0x0f) + 1;
+				state = writing ? WRITE : READ;
+				return 0;
+			case WRITE:
+				if (address < sizeof(regs)) regs[address] = data;
+				address++;
+				if (--count == 0) state = COMMAND;
+				return 0;
+			case READ: {
+				uint8_t value = address < sizeof(regs) ? regs[address] : 0;
+				address++;
+				if (--count == 0) state = COMMAND;
+				return value;
+			}
+			default:
+				break;
+		}
+		if ((data & 0xf0) == ADS1256_CMD_WREG || (data & 0xf0) == ADS1256_CMD_RREG) {
+			writing = (data & 0xf0) == ADS1256_CMD_WREG;
+			address = data & 0x0f;
+			state = COUNT;
+		} else if (data == ADS1256_CMD_RDATA) {
+			rdata(now);
+		} else if (data == ADS1256_CMD_SYNC) {
+			halted = true;
+			dueNs = UINT64_MAX;
+			hostGpioSetInput(DRDY_PIN, 1);
+		} else if ((data == ADS1256_CMD_WAKEUP || data == 0x00) && halted) {
+			// the conversion starts on the last clock of WAKEUP and needs its full settling time
+			halted = false;
+			startConversion(now + spiByteNs(), drates[drateIndex(regs[ADS1256_REG_DRATE])].settleUs * 1000ull);
+		}
+		return 0;
+	}
+
+	void complete() {
+		if (hostTimeNs() < dueNs)
+			return;
+		dataValue = inputs[channel] & 0xffffff;
+		dataChannel = channel;
+		dataRate = rate;
+		dataId++;
+		conversions++;
+		hostGpioSetInput(DRDY_PIN, 1);
+		hostGpioSetInput(DRDY_PIN, 0);
+		// free-running from here, on whatever the MUX selects by then
+		startConversion(dueNs, periodNs(regs[ADS1256_REG_DRATE]));
+	}
+
+private:
+	enum { COMMAND, COUNT, WRITE, READ } state = COMMAND;
+	uint8_t regs[11] = {};
+	bool writing = false;
+	uint8_t address = 0;
+	uint8_t count = 0;
+
+	bool halted = false;
+	uint8_t channel = 0;
+	uint8_t rate = 0;
+	uint64_t dueNs = UINT64_MAX;
+
+	uint32_t dataValue = 0;
+	uint8_t dataChannel = 0;
+	uint8_t dataRate = 0;
+	uint64_t dataId = 0;
+	uint64_t lastReadId = 0;
+
+	uint32_t readValue = 0;
+	uint8_t dataLeft = 0;
+	uint64_t rdataNs = 0;
+
+	static uint64_t periodNs(uint8_t drate) {
+		return 1000000000ull / drates[drateIndex(drate)].sps;
+	}
+
+	static void conversionEvent(void * context) {
+		((Ads1256Model *)context)->complete();
+	}
+
+	void startConversion(uint64_t startNs, uint64_t lengthNs) {
+		channel = regs[ADS1256_REG_MUX] >> 4;
+		rate = regs[ADS1256_REG_DRATE];
+		dueNs = startNs + lengthNs;
+		hostScheduleAt(dueNs, conversionEvent, this);
+	}
+
+	void rdata(uint64_t now) {
+		rdataNs = now;
+		readValue = dataValue;
+		dataLeft = 3;
+		reads++;
+		if (dataId == lastReadId)
+			staleReads++;
+		else if (checkRates && dataRate != expectedRate[dataChannel])
+			rateErrors++;
+		lastReadId = dataId;
+	}
+};
+
+static Ads1256Model * model;
+
+static int32_t randomCode() {
+	return ((rand() << 8) ^ rand()) & 0x7fffff;
+}
+
+static void waitForDRDY() {
+	while (hostGpioInputs() & (1u << DRDY_PIN))
+		hostTimeAdvanceUs(1);
+}
+
+struct AcquisitionResult {
+	double sweepsPerSec;
+	double expectedPerSec;
+	uint64_t changes;
+	uint64_t latencyMaxUs;
+	uint64_t late;
+	uint64_t wrong;
+};
+
+static AcquisitionResult runAcquisition(ADS1256 * ads, const std::vector<uint8_t> & rates) {
+	uint8_t channels = rates.size();
+	// a sweep is every channel's settling time plus its command up to WAKEUP, the read overlaps the next conversion
+	double sweepUs = 0;
+	for (uint8_t c = 0; c < channels; c++) {
+		ads->setChannelRate(c, rates[c]);
+		model->expectedRate[c] = rates[c];
+		uint8_t previous = (c == 0 ? channels : c) - 1;
+		uint32_t commandBytes = rates[c] != rates[previous] ? 8 : 6;
+		sweepUs += drates[drateIndex(rates[c])].settleUs + (commandBytes - 1) * spiByteNs() / 1000.0;
+	}
+	uint64_t boundUs = 2 * sweepUs + LOOP_US + 50;
+
+	int32_t previous[ADS1256_CHANNEL_COUNT];
+	uint64_t changeUs[ADS1256_CHANNEL_COUNT];
+	uint64_t nextChangeUs[ADS1256_CHANNEL_COUNT];
+	bool caughtUp[ADS1256_CHANNEL_COUNT];
+	for (uint8_t c = 0; c < channels; c++) {
+		previous[c] = model->inputs[c] = randomCode();
+		changeUs[c] = 0;
+		nextChangeUs[c] = 10000 + rand() % 20000;
+		caughtUp[c] = true;
+	}
+
+	waitForDRDY();
+	model->checkRates = true;
+	ads->startAcquisition(channels);
+
+	AcquisitionResult result = {};
+	uint64_t startUs = hostTimeNs() / 1000;
+	uint32_t sweepsBefore = ads->getSweepCount();
+	while (true) {
+		uint64_t us = hostTimeNs() / 1000 - startUs;
+		if (us >= RUN_US)
+			break;
+		for (uint8_t c = 0; c < channels; c++) {
+			if (us >= nextChangeUs[c]) {
+				previous[c] = model->inputs[c];
+				model->inputs[c] = randomCode();
+				changeUs[c] = us;
+				nextChangeUs[c] = us + 10000 + rand() % 20000;
+				caughtUp[c] = false;
+				result.changes++;
+			}
+		}
+
+		uint32_t values[ADS1256_CHANNEL_COUNT];
+		ads->getResults(values, channels);
+		for (uint8_t c = 0; c < channels && ads->getSweepCount() - sweepsBefore >= 2; c++) {
+			if ((int32_t)values[c] != model->inputs[c] && (int32_t)values[c] != previous[c])
+				result.wrong++;
+			if (!caughtUp[c] && (int32_t)values[c] == model->inputs[c]) {
+				caughtUp[c] = true;
+				result.latencyMaxUs = std::max(result.latencyMaxUs, us - changeUs[c]);
+			}
+			if (!caughtUp[c] && us - changeUs[c] > boundUs) {
+				caughtUp[c] = true;
+				result.late++;
+			}
+		}
+		hostTimeAdvanceUs(LOOP_US);
+	}
+
+	uint64_t elapsedUs = hostTimeNs() / 1000 - startUs;
+	result.sweepsPerSec = (double)(ads->getSweepCount() - sweepsBefore) * 1e6 / elapsedUs;
+	result.expectedPerSec = 1e6 / sweepUs;
+	ads->stopAcquisition();
+	model->checkRates = false;
+	return result;
+}
+
+// The float scaling the addon used before, as the reference
+static float referenceVoltage(uint32_t code) {
+	int32_t raw = code;
+	if (raw >> 23 == 1)
+		raw -= 16777216;
+	return ((2 * ADS1256_VREF_VOLTAGE) / 8388607) * raw / pow(2, ADS1256_PGA_1);
+}
+
+static uint16_t reference16(uint32_t code) {
+	return (uint16_t)(65535.f * (std::clamp(referenceVoltage(code), 0.0f, AVDD) / AVDD));
+}
+
+static uint8_t reference8(uint32_t code) {
+	return (uint8_t)(255.f * (std::clamp(referenceVoltage(code), 0.0f, AVDD) / AVDD));
+}
+
+int main() {
+	srand(13);
+	hostTimeSetManual(true);
+	Storage::getInstance().init();
+	Storage::getInstance().SetGamepad(new Gamepad());
+
+	PeripheralOptions_SPIOptions & spiOptions = Storage::getInstance().getPeripheralOptions().blockSPI0;
+	spiOptions.enabled = true;
+	spiOptions.rx = 16;
+	spiOptions.cs = CS_PIN;
+	spiOptions.sck = 18;
+	spiOptions.tx = 19;
+	PeripheralManager::getInstance().initSPI();
+	model = new Ads1256Model();
+	hostSPIAttach(spi0, model);
+
+	// Engine on its own: per channel rates, with and without DRATE rewrites between channels
+	const struct {
+		const char * name;
+		std::vector<uint8_t> rates;
+	} configs[] = {
+		{ "4 x 30000", { ADS1256_DRATE_30000SPS, ADS1256_DRATE_30000SPS, ADS1256_DRATE_30000SPS, ADS1256_DRATE_30000SPS } },
+		{ "4 x 30000 + 2 x 2000", { ADS1256_DRATE_30000SPS, ADS1256_DRATE_30000SPS, ADS1256_DRATE_30000SPS,
+			ADS1256_DRATE_30000SPS, ADS1256_DRATE_2000SPS, ADS1256_DRATE_2000SPS } },
+		{ "15000/3750 x 3", { ADS1256_DRATE_15000SPS, ADS1256_DRATE_3750SPS, ADS1256_DRATE_15000SPS,
+			ADS1256_DRATE_3750SPS, ADS1256_DRATE_15000SPS, ADS1256_DRATE_3750SPS } },
+	};
+	ADS1256 * ads = new ADS1256(PeripheralManager::getInstance().getSPI(0), DRDY_PIN, -1, -1, CS_PIN, ADS1256_VREF_VOLTAGE);
+	ads->init(ADS1256_DRATE_30000SPS, ADS1256_PGA_1, true);
+
+	printf("%dus loop, %.0fkHz SPI, inputs change every 10 to 30ms\n", LOOP_US, ADS1256_SPI_SPEED_HZ / 1000.0);
+	printf("  %-22s %9s %9s %8s %12s %6s %6s\n", "rates", "sweeps/s", "expected", "changes", "latency max",
+		"late", "wrong");
+	for (const auto & config : configs) {
+		AcquisitionResult result = runAcquisition(ads, config.rates);
+		printf("  %-22s %9.0f %9.0f %8llu %10lluus %6llu %6llu\n", config.name, result.sweepsPerSec,
+			result.expectedPerSec, (unsigned long long)result.changes, (unsigned long long)result.latencyMaxUs,
+			(unsigned long long)result.late, (unsigned long long)result.wrong);
+
+		CHECK(result.changes > 0);
+		CHECK_EQ(result.wrong, 0);
+		CHECK_EQ(result.late, 0);
+		// each channel settles at its own rate, so the sweep takes as long as the sum of them
+		CHECK(result.sweepsPerSec > result.expectedPerSec * 0.9);
+		CHECK(result.sweepsPerSec < result.expectedPerSec * 1.05);
+	}
+	printf("%llu conversions, %llu reads, %llu stale, %llu at the wrong rate, t6 min %lluns\n",
+		(unsigned long long)model->conversions, (unsigned long long)model->reads,
+		(unsigned long long)model->staleReads, (unsigned long long)model->rateErrors,
+		(unsigned long long)model->t6MinNs);
+	CHECK_EQ(model->staleReads, 0);
+	CHECK_EQ(model->rateErrors, 0);
+	CHECK_EQ(model->t6Violations, 0);
+
+	// The addon: scaling against the float reference, and process() only copies the last sweep
+	AnalogADS1256Options & options = Storage::getInstance().getAddonOptions().analogADS1256Options;
+	options.enabled = true;
+	options.spiBlock = 0;
+	options.csPin = CS_PIN;
+	options.drdyPin = DRDY_PIN;
+	options.avdd = AVDD;
+	options.enableTriggers = true;
+	SPIAnalog1256Input * addon = new SPIAnalog1256Input();
+	CHECK(addon->available());
+	waitForDRDY();
+	addon->setup();
+
+	Gamepad * gamepad = Storage::getInstance().GetGamepad();
+	int32_t maxCode = ads->convertToCode(AVDD);
+	uint32_t worst16 = 0;
+	uint32_t worst8 = 0;
+	uint64_t worstCallNs = 0;
+	uint64_t busBytes = 0;
+	uint64_t hostNs = 0;
+	for (int round = 0; round < PARITY_ROUNDS; round++) {
+		for (int c = 0; c < 6; c++) {
+			switch (rand() % 4) {
+				case 0: model->inputs[c] = rand() % 2 ? maxCode + rand() % 16 - 8 : rand() % 16 - 8; break;
+				case 1: model->inputs[c] = -(randomCode() >> (rand() % 20)); break;
+				default: model->inputs[c] = randomCode() % (maxCode + 1000); break;
+			}
+		}
+		// two full sweeps at 30000SPS
+		hostTimeAdvanceUs(4000);
+
+		uint64_t bytesBefore = hostSPIBytes(spi0);
+		uint64_t before = hostTimeNs();
+		uint64_t hostBefore = hostClockNs();
+		addon->process();
+		hostNs += hostClockNs() - hostBefore;
+		worstCallNs = std::max(worstCallNs, hostTimeNs() - before);
+		busBytes += hostSPIBytes(spi0) - bytesBefore;
+
+		const uint16_t axes[4] = { gamepad->state.lx, gamepad->state.ly, gamepad->state.rx, gamepad->state.ry };
+		for (int c = 0; c < 4; c++) {
+			uint32_t difference = abs(axes[c] - reference16(model->inputs[c] & 0xffffff));
+			worst16 = std::max(worst16, difference);
+			if (difference > 1)
+				printf("axis %d code %d: %u, float %u\n", c, model->inputs[c], axes[c], reference16(model->inputs[c] & 0xffffff));
+		}
+		const uint8_t triggers[2] = { gamepad->state.lt, gamepad->state.rt };
+		for (int c = 0; c < 2; c++) {
+			uint32_t difference = abs(triggers[c] - reference8(model->inputs[4 + c] & 0xffffff));
+			worst8 = std::max(worst8, difference);
+		}
+	}
+	printf("%d readings per axis, worst difference %u LSB (16-bit) %u LSB (8-bit); process() %llu simulated ns, "
+		"%llu bus bytes, %.0f ns (host)\n", PARITY_ROUNDS, worst16, worst8, (unsigned long long)worstCallNs,
+		(unsigned long long)busBytes, (double)hostNs / PARITY_ROUNDS);
+	CHECK(worst16 <= 1);
+	CHECK(worst8 <= 1);
+	// the old process() read every channel over SPI, waiting on DRDY each time
+	CHECK_EQ(busBytes, 0);
+	CHECK(worstCallNs < 1000);
+
+	return hostTestResult("test_ads1256_acquisition");
+}
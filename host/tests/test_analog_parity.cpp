@@ -0,0 +1,146 @@
+/*
+ * SPDX-License-Identifier: MIT
+ * SPDX-FileCopyrightText: Copyright (c) 2024 OpenStickCommunity (gp2040-ce.info)
+ */
+
+// Analog stick pipeline: the fixed-point AnalogInput the firmware builds has to give the same stick
+// outputs as the float one within 1 LSB, across deadzones, error rates, forced circularity, inversion
+// and smoothing. Inputs are random jumps, slow drifts and steady holds so the EMA is compared both in
+// transients and once it has settled. Time per process() is printed for both; on the host the float
+// path has an FPU, so it says nothing about the RP2040.
+
+#include <stdlib.h>
+#include <algorithm>
+
+#include "hosttest.h"
+#include "hostsim.h"
+
+#include "addons/analog.h"
+#include "gamepad.h"
+#include "storagemanager.h"
+
+GPAddon * createFloatAnalogInput();
+
+#define SAMPLES 4000
+#define BENCH_SAMPLES 200000
+
+struct StickSample {
+	uint16_t x;
+	uint16_t y;
+};
+
+static StickSample nextSample(int i, StickSample last) {
+	switch ((i / 250) % 3) {
+		case 0:
+			// jumps anywhere
+			return { (uint16_t)(rand() % 4096), (uint16_t)(rand() % 4096) };
+		case 1:
+			// slow drift
+			return { (uint16_t)std::clamp((int)last.x + rand() % 9 - 4, 0, 4095),
+				(uint16_t)std::clamp((int)last.y + rand() % 9 - 4, 0, 4095) };
+		default:
+			// held still, with a code of noise
+			return { (uint16_t)(last.x ^ (rand() & 1)), (uint16_t)(last.y ^ (rand() & 1)) };
+	}
+}
+
+static void processSample(GPAddon * addon, StickSample sample, uint16_t & x, uint16_t & y) {
+	hostAdcSetInput(0, sample.x);
+	hostAdcSetInput(1, sample.y);
+	addon->process();
+	Gamepad * gamepad = Storage::getInstance().GetGamepad();
+	x = gamepad->state.lx;
+	y = gamepad->state.ly;
+}
+
+int main() {
+	srand(8);
+	Storage::getInstance().init();
+	Storage::getInstance().SetGamepad(new Gamepad());
+
+	AnalogOptions & options = Storage::getInstance().getAddonOptions().analogOptions;
+	options.enabled = true;
+	options.analogAdc1PinX = 26;
+	options.analogAdc1PinY = 27;
+	options.analogAdc1Mode = DPAD_MODE_LEFT_ANALOG;
+	options.analogAdc2PinX = -1;
+	options.analogAdc2PinY = -1;
+	options.auto_calibrate = false;
+
+	const uint32_t innerDeadzones[] = { 0, 5, 20 };
+	const uint32_t outerDeadzones[] = { 95, 100, 60 };
+	const uint32_t errorRates[] = { 1000, 946, 890 };
+	const float smoothingFactors[] = { 0.0f, 1.0f, 2.5f, 5.0f, 20.0f, 100.0f };
+	const InvertMode inverts[] = { INVERT_NONE, INVERT_XY };
+
+	uint64_t compared = 0;
+	uint32_t configs = 0;
+	uint32_t worst = 0;
+	uint32_t worstSmoothed = 0;
+	for (uint32_t inner : innerDeadzones)
+	for (uint32_t outer : outerDeadzones)
+	for (uint32_t error : errorRates)
+	for (float smoothing : smoothingFactors)
+	for (int circularity = 0; circularity < 2; circularity++) {
+		options.inner_deadzone = inner;
+		options.outer_deadzone = outer;
+		options.analog_error = error;
+		options.analog_smoothing = smoothing != 0.0f;
+		options.smoothing_factor = smoothing;
+		options.forced_circularity = circularity;
+		options.analogAdc1Invert = inverts[configs++ % 2];
+
+		GPAddon * fixed = new AnalogInput();
+		GPAddon * reference = createFloatAnalogInput();
+		fixed->setup();
+		reference->setup();
+
+		StickSample sample = { 2048, 2048 };
+		for (int i = 0; i < SAMPLES; i++) {
+			sample = nextSample(i, sample);
+			uint16_t fx, fy, rx, ry;
+			processSample(fixed, sample, fx, fy);
+			processSample(reference, sample, rx, ry);
+			uint32_t difference = std::max(abs(fx - rx), abs(fy - ry));
+			if (options.analog_smoothing)
+				worstSmoothed = std::max(worstSmoothed, difference);
+			else
+				worst = std::max(worst, difference);
+			if (difference > 1)
+				printf("in %u out %u error %u smoothing %.1f circularity %d: adc %u,%u fixed %u,%u float %u,%u\n",
+					inner, outer, error, smoothing, circularity, sample.x, sample.y, fx, fy, rx, ry);
+			compared++;
+		}
+		delete fixed;
+		delete reference;
+	}
+
+	printf("%llu samples compared, worst difference %u LSB unsmoothed, %u LSB smoothed\n",
+		(unsigned long long)compared, worst, worstSmoothed);
+	CHECK(worst <= 1);
+	CHECK(worstSmoothed <= 1);
+
+	// Time per process() with smoothing and a deadzone, over the same inputs
+	options.inner_deadzone = 5;
+	options.outer_deadzone = 95;
+	options.analog_error = 1000;
+	options.analog_smoothing = true;
+	options.smoothing_factor = 5.0f;
+	options.forced_circularity = false;
+	options.analogAdc1Invert = INVERT_NONE;
+	GPAddon * addons[] = { new AnalogInput(), createFloatAnalogInput() };
+	const char * names[] = { "fixed", "float" };
+	for (int i = 0; i < 2; i++) {
+		addons[i]->setup();
+		srand(80);
+		uint64_t start = hostClockNs();
+		for (int j = 0; j < BENCH_SAMPLES; j++) {
+			hostAdcSetInput(0, rand() % 4096);
+			hostAdcSetInput(1, rand() % 4096);
+			addons[i]->process();
+		}
+		printf("%s: %.1f ns/process (host)\n", names[i], (double)(hostClockNs() - start) / BENCH_SAMPLES);
+	}
+
+	return hostTestResult("test_analog_parity");
+}
@@ -0,0 +1,207 @@
+/*
+ * SPDX-License-Identifier: MIT
+ * SPDX-FileCopyrightText: Copyright (c) 2024 OpenStickCommunity (gp2040-ce.info)
+ */
+
+// Debouncer: synthetic bounce traces are fed through GP2040::runOnce for each debounce mode. Every
+// press and release has to come out as exactly one debounced edge, and the latency each mode adds
+// over the first raw edge is reported. A lone short glitch is fed too: eager mode passes it by design,
+// defer and integrator have to reject it.
+
+#include <stdlib.h>
+#include <algorithm>
+#include <vector>
+
+#include "hosttest.h"
+#include "hostsim.h"
+
+#include "gp2040.h"
+#include "gamepad.h"
+#include "storagemanager.h"
+#include "tusb.h"
+
+#define TEST_PIN 6           // B1 on the Pico board config
+#define STEP_US 10           // loop period in simulated time
+#define PRESSES 20
+#define BOUNCE_MAX_US 2000   // contacts chatter for up to this long after an edge
+#define HOLD_US 30000
+#define DELAY_MS 5
+
+struct TraceEdge {
+	uint64_t us;
+	bool pressed;
+};
+
+struct Trace {
+	std::vector<TraceEdge> edges;
+	std::vector<uint64_t> pressUs;    // first raw edge of every press
+	std::vector<uint64_t> releaseUs;  // first raw edge of every release
+	uint64_t endUs;
+};
+
+// An edge followed by a random burst of chatter that settles on the new level
+static void addBouncyEdge(Trace & trace, uint64_t us, bool pressed) {
+	uint64_t bounceUs = 200 + rand() % (BOUNCE_MAX_US - 200);
+	trace.edges.push_back({ us, pressed });
+	bool level = pressed;
+	uint64_t t = us;
+	while (true) {
+		t += 20 + rand() % 200;
+		if (t >= us + bounceUs)
+			break;
+		level = !level;
+		trace.edges.push_back({ t, level });
+	}
+	if (level != pressed)
+		trace.edges.push_back({ t, pressed });
+}
+
+static Trace makeBounceTrace() {
+	Trace trace;
+	uint64_t us = 1000;
+	for (int i = 0; i < PRESSES; i++) {
+		trace.pressUs.push_back(us);
+		addBouncyEdge(trace, us, true);
+		us += HOLD_US;
+		trace.releaseUs.push_back(us);
+		addBouncyEdge(trace, us, false);
+		us += HOLD_US;
+	}
+	trace.endUs = us;
+	return trace;
+}
+
+static Trace makeGlitchTrace() {
+	Trace trace;
+	trace.edges.push_back({ 1000, true });
+	trace.edges.push_back({ 1150, false });
+	trace.endUs = 1000 + HOLD_US;
+	return trace;
+}
+
+// Debounced edges of the test pin, in simulated microseconds from the start of the trace
+static std::vector<TraceEdge> replay(GP2040 * gp2040, const Trace & trace) {
+	Gamepad * gamepad = Storage::getInstance().GetGamepad();
+	std::vector<TraceEdge> out;
+	uint64_t startUs = hostTimeNs() / 1000;
+	size_t next = 0;
+	bool pressed = false;
+	bool debounced = (gamepad->debouncedGpio >> TEST_PIN) & 1;
+	while (true) {
+		uint64_t us = hostTimeNs() / 1000 - startUs;
+		if (us >= trace.endUs)
+			break;
+		while (next < trace.edges.size() && trace.edges[next].us <= us)
+			pressed = trace.edges[next++].pressed;
+		hostGpioSetInput(TEST_PIN, !pressed);
+		gp2040->runOnce();
+		bool now = (gamepad->debouncedGpio >> TEST_PIN) & 1;
+		if (now != debounced)
+			out.push_back({ us, now });
+		debounced = now;
+		hostTimeAdvanceUs(STEP_US);
+	}
+	return out;
+}
+
+struct Latency {
+	uint64_t avgUs;
+	uint64_t maxUs;
+	uint64_t minUs;
+};
+
+static Latency latency(const std::vector<uint64_t> & raw, const std::vector<uint64_t> & debounced) {
+	Latency result = { 0, 0, UINT64_MAX };
+	for (size_t i = 0; i < raw.size() && i < debounced.size(); i++) {
+		uint64_t us = debounced[i] - raw[i];
+		result.avgUs += us;
+		result.maxUs = std::max(result.maxUs, us);
+		result.minUs = std::min(result.minUs, us);
+	}
+	if (!raw.empty())
+		result.avgUs /= raw.size();
+	return result;
+}
+
+int main() {
+	srand(5);
+	hostTimeSetManual(true);
+	hostGpioSetInputs(0xffffffff);
+
+	GP2040 * gp2040 = new GP2040();
+	gp2040->setup();
+	tud_init(TUD_OPT_RHPORT);
+	for (int i = 0; i < 1000; i++) {
+		gp2040->runOnce();
+		hostTimeAdvanceUs(STEP_US);
+	}
+
+	GamepadOptions & options = Storage::getInstance().getGamepadOptions();
+	options.debounceDelay = DELAY_MS;
+	options.debounceReleaseDelay = DELAY_MS;
+
+	const struct {
+		DebounceMode mode;
+		const char * name;
+	} modes[] = {
+		{ DEBOUNCE_MODE_EAGER, "eager" },
+		{ DEBOUNCE_MODE_DEFER, "defer" },
+		{ DEBOUNCE_MODE_INTEGRATOR, "integrator" },
+	};
+
+	printf("%d presses, up to %dus of bounce per edge, %dms delay, %dus loop\n", PRESSES, BOUNCE_MAX_US, DELAY_MS, STEP_US);
+	printf("  %-10s %8s %10s %10s %11s %11s %8s\n", "mode", "edges", "press avg", "press max", "release avg", "release max", "glitch");
+	for (const auto & mode : modes) {
+		options.debounceMode = mode.mode;
+
+		Trace trace = makeBounceTrace();
+		std::vector<TraceEdge> edges = replay(gp2040, trace);
+		std::vector<uint64_t> pressUs;
+		std::vector<uint64_t> releaseUs;
+		bool alternates = true;
+		for (size_t i = 0; i < edges.size(); i++) {
+			alternates &= edges[i].pressed == ((i & 1) == 0);
+			(edges[i].pressed ? pressUs : releaseUs).push_back(edges[i].us);
+		}
+		Latency press = latency(trace.pressUs, pressUs);
+		Latency release = latency(trace.releaseUs, releaseUs);
+
+		Trace glitch = makeGlitchTrace();
+		std::vector<TraceEdge> glitchEdges = replay(gp2040, glitch);
+
+		printf("  %-10s %8zu %8lluus %8lluus %9lluus %9lluus %8s\n", mode.name, edges.size(),
+			(unsigned long long)press.avgUs, (unsigned long long)press.maxUs,
+			(unsigned long long)release.avgUs, (unsigned long long)release.maxUs,
+			glitchEdges.empty() ? "rejected" : "passed");
+
+		// one debounced edge per raw press and release, no chatter and nothing missed
+		CHECK_EQ(edges.size(), 2 * PRESSES);
+		CHECK(alternates);
+
+		switch (mode.mode) {
+			case DEBOUNCE_MODE_EAGER:
+				// the first raw edge goes straight through
+				CHECK(press.maxUs <= 2 * STEP_US);
+				CHECK(release.maxUs <= 2 * STEP_US);
+				break;
+			case DEBOUNCE_MODE_DEFER:
+				// the level has to hold for the whole delay after the last bounce
+				CHECK(press.minUs >= DELAY_MS * 1000);
+				CHECK(press.maxUs <= DELAY_MS * 1000 + BOUNCE_MAX_US + 2 * STEP_US);
+				CHECK(release.minUs >= DELAY_MS * 1000);
+				CHECK(glitchEdges.empty());
+				break;
+			case DEBOUNCE_MODE_INTEGRATOR:
+				// time back in the old level counts down, so never faster than the delay
+				CHECK(press.minUs >= DELAY_MS * 1000);
+				CHECK(press.maxUs <= DELAY_MS * 1000 + 2 * BOUNCE_MAX_US + 2 * STEP_US);
+				CHECK(release.minUs >= DELAY_MS * 1000);
+				CHECK(glitchEdges.empty());
+				break;
+			default:
+				break;
+		}
+	}
+
+	return hostTestResult("test_debounce");
+}
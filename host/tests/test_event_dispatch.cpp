@@ -0,0 +1,95 @@
+/*
+ * SPDX-License-Identifier: MIT
+ * SPDX-FileCopyrightText: Copyright (c) 2024 OpenStickCommunity (gp2040-ce.info)
+ */
+
+// EventManager dispatch: stack events reach every handler without touching the heap, with the
+// dispatch rate and worst single dispatch next to the old heap-allocated path.
+
+#include <stdlib.h>
+#include <new>
+
+#include "hosttest.h"
+#include "hostsim.h"
+
+#include "eventmanager.h"
+
+static size_t allocations = 0;
+
+void * operator new(size_t size) {
+	allocations++;
+	void * p = malloc(size ? size : 1);
+	if (p == nullptr)
+		throw std::bad_alloc();
+	return p;
+}
+
+void operator delete(void * p) noexcept { free(p); }
+void operator delete(void * p, size_t) noexcept { free(p); }
+
+#define DISPATCHES 1000000
+
+static uint32_t downCount = 0;
+static uint32_t upCount = 0;
+static uint32_t lastButtons = 0;
+
+struct DispatchTiming {
+	double eventsPerSec;
+	uint64_t worstNs;
+	size_t allocations;
+};
+
+template <typename Trigger>
+static DispatchTiming measure(Trigger trigger) {
+	uint64_t worst = 0;
+	size_t allocationsBefore = allocations;
+	uint64_t start = hostClockNs();
+	for (uint32_t i = 0; i < DISPATCHES; i++) {
+		uint64_t before = hostClockNs();
+		trigger(i);
+		uint64_t took = hostClockNs() - before;
+		if (took > worst)
+			worst = took;
+	}
+	uint64_t total = hostClockNs() - start;
+	return { DISPATCHES * 1e9 / total, worst, allocations - allocationsBefore };
+}
+
+int main() {
+	EventManager::getInstance().init();
+	// the handler lists grow here, not while dispatching
+	for (int i = 0; i < 3; i++) {
+		EventManager::getInstance().registerEventHandler(GP_EVENT_BUTTON_DOWN, [](GPEvent * event) {
+			downCount++;
+			lastButtons = ((GPButtonDownEvent *)event)->state.buttons;
+		});
+	}
+	EventManager::getInstance().registerEventHandler(GP_EVENT_BUTTON_UP, [](GPEvent *) { upCount++; });
+
+	// Every handler for the type runs, and only those
+	GPButtonDownEvent down(0, 0x1234, 0);
+	EventManager::getInstance().triggerEvent(down);
+	CHECK_EQ(downCount, 3);
+	CHECK_EQ(upCount, 0);
+	CHECK_EQ(lastButtons, 0x1234);
+
+	downCount = 0;
+	DispatchTiming stack = measure([](uint32_t i) {
+		GPButtonDownEvent event(0, i & 0xffff, 0);
+		EventManager::getInstance().triggerEvent(event);
+	});
+	CHECK_EQ(downCount, 3 * DISPATCHES);
+	CHECK_EQ(stack.allocations, 0);
+
+	DispatchTiming heap = measure([](uint32_t i) {
+		EventManager::getInstance().triggerEvent(new GPButtonDownEvent(0, i & 0xffff, 0));
+	});
+	CHECK_EQ(heap.allocations, DISPATCHES);
+
+	printf("stack events: %.0f events/sec, worst dispatch %llu ns, %zu allocations\n",
+		stack.eventsPerSec, (unsigned long long)stack.worstNs, stack.allocations);
+	printf("heap events:  %.0f events/sec, worst dispatch %llu ns, %zu allocations\n",
+		heap.eventsPerSec, (unsigned long long)heap.worstNs, heap.allocations);
+
+	return hostTestResult("test_event_dispatch");
+}
@@ -0,0 +1,257 @@
+/*
+ * SPDX-License-Identifier: MIT
+ * SPDX-FileCopyrightText: Copyright (c) 2024 OpenStickCommunity (gp2040-ce.info)
+ */
+
+// FlashPROM record log on the simulated flash. Random base and overlay commits, some coalescing in the queue,
+// are flushed with the power cut part way through an erase or program in one flush out of four. After every
+// flush, cut or not, the store is started again from flash and has to read back exactly what was flushed. A cut
+// save leaves either the one before it or, when the cut only hit bytes past the end of the record, itself;
+// never anything else.
+//
+// Then hotkey style saves (small overlays on a config sized base, a full save now and then) are timed on the
+// flash model, with the bytes erased and programmed per save and the longest stall, against the old erase and
+// rewrite of the whole 32k area it used to have. The erases over a long run have to be spread across every sector.
+
+#include <stdlib.h>
+#include <algorithm>
+#include <vector>
+
+#include "hosttest.h"
+#include "hostsim.h"
+
+#include "FlashPROM.h"
+
+#define FUZZ_SAVES 20000
+#define CUT_ONE_IN 4
+#define CUT_OPERATIONS 16
+#define HOTKEY_SAVES 5000
+#define FULL_ONE_IN 20
+#define CONFIG_BYTES 3000
+#define STALL_SLACK_US 100      // each clock read inside flush() moves the simulated time a little
+#define EEPROM_OFFSET (EEPROM_ADDRESS_START - XIP_BASE)
+#define LEGACY_OFFSET (EEPROM_LEGACY_ADDRESS_START - XIP_BASE)
+#define LEGACY_SIZE_BYTES 0x8000
+
+typedef std::vector<uint8_t> Bytes;
+
+static Bytes randomBytes(size_t size) {
+	Bytes bytes(size);
+	for (uint8_t & byte : bytes)
+		byte = rand();
+	return bytes;
+}
+
+// What the store holds, a base and the overlay on top of it
+struct StoreState {
+	Bytes base;
+	Bytes overlay;
+
+	bool operator==(const StoreState & other) const { return base == other.base && overlay == other.overlay; }
+};
+
+static StoreState readBack() {
+	StoreState state;
+	uint32_t size = 0;
+	const uint8_t * data = EEPROM.read(size);
+	if (data != nullptr)
+		state.base.assign(data, data + size);
+	data = EEPROM.readOverlay(size);
+	if (data != nullptr)
+		state.overlay.assign(data, data + size);
+	return state;
+}
+
+static void commitBase(const Bytes & base) {
+	memcpy(FlashPROM::writeCache, base.data(), base.size());
+	CHECK(EEPROM.commit(base.size()));
+}
+
+// Power comes back, the store indexes flash again
+static void reboot() {
+	EEPROM.start();
+}
+
+static void powerCutFuzz() {
+	StoreState flushed;
+	StoreState queued;
+	uint32_t mismatches = 0;
+	uint32_t cuts = 0;
+	uint32_t cutsLanded = 0;
+	uint32_t overlays = 0;
+	uint32_t overlayFallbacks = 0;
+	bool queueHeld = false;
+
+	for (int save = 0; save < FUZZ_SAVES; save++) {
+		if (!queueHeld)
+			queued = flushed;
+
+		if (!flushed.base.empty() && rand() % 10 != 0) {
+			Bytes overlay = randomBytes((rand() % 9) * 8);
+			if (EEPROM.commitOverlay(overlay.data(), overlay.size())) {
+				queued.overlay = overlay;
+				overlays++;
+			} else {
+				// No room behind the base, a full commit instead
+				queued.base = randomBytes(200 + rand() % 3000);
+				queued.overlay.clear();
+				commitBase(queued.base);
+				overlayFallbacks++;
+			}
+		} else {
+			// Mostly config sized, now and then up to the whole record
+			size_t limit = (save % 50 == 0) ? EEPROM_RECORD_MAX_BYTES - 200 : (save % 7 == 0) ? 9000 : 3000;
+			queued.base = randomBytes(200 + rand() % limit);
+			queued.overlay.clear();
+			commitBase(queued.base);
+		}
+		queueHeld = true;
+
+		// Let the next request coalesce into the queue now and then
+		if (rand() % 3 == 0)
+			continue;
+
+		bool cut = false;
+		if (rand() % CUT_ONE_IN == 0)
+			hostFlashSetPowerCut(rand() % CUT_OPERATIONS);
+		try {
+			EEPROM.flush();
+		} catch (const HostFlashPowerCut &) {
+			// flush() held the flash lock with interrupts off
+			restore_interrupts(0);
+			cut = true;
+			cuts++;
+		}
+		hostFlashSetPowerCut(-1);
+		if (!cut)
+			flushed = queued;
+		queueHeld = false;
+
+		reboot();
+		if (cut && !(readBack() == flushed) && readBack() == queued) {
+			flushed = queued;
+			cutsLanded++;
+		}
+		if (!(readBack() == flushed)) {
+			if (mismatches++ < 5)
+				printf("save %d%s: read back a base of %zu bytes, expected %zu\n", save, cut ? " (cut)" : "",
+					readBack().base.size(), flushed.base.size());
+			flushed = readBack();
+		}
+	}
+
+	printf("power cut fuzz: %d saves, %u overlays, %u overlay fallbacks, %u cuts (%u still landed), %u mismatches\n",
+		FUZZ_SAVES, overlays, overlayFallbacks, cuts, cutsLanded, mismatches);
+	CHECK(cuts > 0);
+	CHECK(overlays > 0);
+	CHECK_EQ(mismatches, 0);
+
+	// A record bigger than a half is refused and leaves the queue alone
+	EEPROM.flush();
+	CHECK(!EEPROM.commit(EEPROM_RECORD_MAX_BYTES + 1));
+	CHECK(!EEPROM.isPending());
+}
+
+struct SaveCost {
+	uint32_t saves = 0;
+	uint64_t bytesErased = 0;
+	uint64_t bytesProgrammed = 0;
+	uint64_t stallUs = 0;
+	uint64_t worstStallUs = 0;
+
+	void add(const HostFlashStats & before, const HostFlashStats & after, uint64_t us) {
+		saves++;
+		bytesErased += after.bytesErased - before.bytesErased;
+		bytesProgrammed += after.bytesProgrammed - before.bytesProgrammed;
+		stallUs += us;
+		worstStallUs = std::max(worstStallUs, us);
+	}
+
+	void print(const char * name) const {
+		printf("  %-22s %6u %12.0f %14.0f %12.1f %14.1f\n", name, saves, (double)bytesErased / saves,
+			(double)bytesProgrammed / saves, stallUs / 1000.0 / saves, worstStallUs / 1000.0);
+	}
+};
+
+// The whole area erased and reprogrammed on every save, as writeToFlash did
+static void referenceSave(SaveCost & cost) {
+	static uint8_t image[LEGACY_SIZE_BYTES];
+	HostFlashStats before = hostFlashStats();
+	uint64_t start = hostTimeNs();
+	flash_range_erase(LEGACY_OFFSET, LEGACY_SIZE_BYTES);
+	flash_range_program(LEGACY_OFFSET, image, LEGACY_SIZE_BYTES);
+	cost.add(before, hostFlashStats(), (hostTimeNs() - start) / 1000);
+}
+
+static void hotkeySaves() {
+	hostFlashSetTimed(true);
+	hostFlashErase();
+	reboot();
+	hostFlashResetStats();
+
+	SaveCost overlaySaves;
+	SaveCost fullSaves;
+	SaveCost referenceSaves;
+	Bytes config = randomBytes(CONFIG_BYTES);
+	commitBase(config);
+	EEPROM.flush();
+
+	for (int save = 0; save < HOTKEY_SAVES; save++) {
+		HostFlashStats before = hostFlashStats();
+		bool full = rand() % FULL_ONE_IN == 0;
+		if (!full) {
+			// A hotkey changes a field or two
+			Bytes overlay = randomBytes(8 + (rand() % 4) * 8);
+			full = !EEPROM.commitOverlay(overlay.data(), overlay.size());
+		}
+		if (full) {
+			config[rand() % CONFIG_BYTES] ^= 1 + rand() % 255;
+			commitBase(config);
+		}
+		EEPROM.flush();
+		(full ? fullSaves : overlaySaves).add(before, hostFlashStats(), EEPROM.getStats().lastDuration);
+	}
+
+	// Erases spread over every sector of the area
+	uint32_t fewest = UINT32_MAX;
+	uint32_t most = 0;
+	for (uint32_t sector = 0; sector < EEPROM_SECTOR_COUNT; sector++) {
+		uint32_t erases = hostFlashSectorErases(EEPROM_OFFSET + sector * FLASH_SECTOR_SIZE);
+		fewest = std::min(fewest, erases);
+		most = std::max(most, erases);
+	}
+
+	for (int save = 0; save < 20; save++)
+		referenceSave(referenceSaves);
+	hostFlashSetTimed(false);
+
+	printf("%d hotkey saves on a %d byte config, one full save in %d\n", HOTKEY_SAVES, CONFIG_BYTES, FULL_ONE_IN);
+	printf("  %-22s %6s %12s %14s %12s %14s\n", "save", "count", "erased/save", "programmed/save", "ms/save",
+		"worst ms");
+	overlaySaves.print("overlay");
+	fullSaves.print("full");
+	referenceSaves.print("erase and rewrite 32k");
+	printf("sector erases: fewest %u, most %u (%u sectors)\n", fewest, most, (uint32_t)EEPROM_SECTOR_COUNT);
+
+	CHECK(overlaySaves.saves > 0);
+	CHECK(fullSaves.saves > 0);
+	// An overlay is one page, a full save at most erases the sectors the record runs into
+	CHECK_EQ(overlaySaves.bytesProgrammed, (uint64_t)overlaySaves.saves * FLASH_PAGE_SIZE);
+	CHECK(overlaySaves.worstStallUs <= HOST_FLASH_SECTOR_ERASE_US + HOST_FLASH_PAGE_PROGRAM_US + STALL_SLACK_US);
+	CHECK(fullSaves.worstStallUs < referenceSaves.worstStallUs / 4);
+	CHECK(overlaySaves.bytesErased + fullSaves.bytesErased < (overlaySaves.saves + fullSaves.saves) * (uint64_t)EEPROM_SIZE_BYTES / 20);
+	CHECK(fewest > 0);
+	CHECK(most <= fewest + 1);
+}
+
+int main() {
+	srand(22);
+	hostTimeSetManual(true);
+	hostFlashErase();
+	reboot();
+
+	powerCutFuzz();
+	hotkeySaves();
+
+	return hostTestResult("test_flash_store");
+}
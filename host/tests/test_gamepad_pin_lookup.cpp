@@ -0,0 +1,157 @@
+/*
+ * SPDX-License-Identifier: MIT
+ * SPDX-FileCopyrightText: Copyright (c) 2024 OpenStickCommunity (gp2040-ce.info)
+ */
+
+// Gamepad::read pin lookup: over randomized pin maps, the nibble tables compiled in setup() give the
+// same state as evaluating every GamepadButtonMapping the way read() used to, and the time per read
+// for both.
+
+#include <stdlib.h>
+#include <vector>
+
+#include "hosttest.h"
+#include "hostsim.h"
+
+#include "gamepad.h"
+#include "storagemanager.h"
+
+#define PIN_MAPS 200
+#define READS_PER_MAP 2000
+#define BENCH_READS 1000000
+
+// Gamepad::read() before the lookup tables
+static void referenceRead(const Gamepad * gamepad, Mask_t values, GamepadState & state) {
+	state.aux = (values & gamepad->mapButtonFn->pinMask) ? gamepad->mapButtonFn->buttonMask : 0;
+
+	state.dpad = 0
+		| ((values & gamepad->mapDpadUp->pinMask)       ? gamepad->mapDpadUp->buttonMask              : 0)
+		| ((values & gamepad->mapDpadDown->pinMask)     ? gamepad->mapDpadDown->buttonMask            : 0)
+		| ((values & gamepad->mapDpadLeft->pinMask)     ? gamepad->mapDpadLeft->buttonMask            : 0)
+		| ((values & gamepad->mapDpadRight->pinMask)    ? gamepad->mapDpadRight->buttonMask           : 0)
+		| ((values & gamepad->mapDigitalUp->pinMask)    ? (gamepad->mapDigitalUp->buttonMask << 4)    : 0)
+		| ((values & gamepad->mapDigitalDown->pinMask)  ? (gamepad->mapDigitalDown->buttonMask << 4)  : 0)
+		| ((values & gamepad->mapDigitalLeft->pinMask)  ? (gamepad->mapDigitalLeft->buttonMask << 4)  : 0)
+		| ((values & gamepad->mapDigitalRight->pinMask) ? (gamepad->mapDigitalRight->buttonMask << 4) : 0)
+	;
+
+	state.buttons = 0
+		| ((values & gamepad->mapButtonB1->pinMask)  ? gamepad->mapButtonB1->buttonMask  : 0)
+		| ((values & gamepad->mapButtonB2->pinMask)  ? gamepad->mapButtonB2->buttonMask  : 0)
+		| ((values & gamepad->mapButtonB3->pinMask)  ? gamepad->mapButtonB3->buttonMask  : 0)
+		| ((values & gamepad->mapButtonB4->pinMask)  ? gamepad->mapButtonB4->buttonMask  : 0)
+		| ((values & gamepad->mapButtonL1->pinMask)  ? gamepad->mapButtonL1->buttonMask  : 0)
+		| ((values & gamepad->mapButtonR1->pinMask)  ? gamepad->mapButtonR1->buttonMask  : 0)
+		| ((values & gamepad->mapButtonL2->pinMask)  ? gamepad->mapButtonL2->buttonMask  : 0)
+		| ((values & gamepad->mapButtonR2->pinMask)  ? gamepad->mapButtonR2->buttonMask  : 0)
+		| ((values & gamepad->mapButtonS1->pinMask)  ? gamepad->mapButtonS1->buttonMask  : 0)
+		| ((values & gamepad->mapButtonS2->pinMask)  ? gamepad->mapButtonS2->buttonMask  : 0)
+		| ((values & gamepad->mapButtonL3->pinMask)  ? gamepad->mapButtonL3->buttonMask  : 0)
+		| ((values & gamepad->mapButtonR3->pinMask)  ? gamepad->mapButtonR3->buttonMask  : 0)
+		| ((values & gamepad->mapButtonA1->pinMask)  ? gamepad->mapButtonA1->buttonMask  : 0)
+		| ((values & gamepad->mapButtonA2->pinMask)  ? gamepad->mapButtonA2->buttonMask  : 0)
+		| ((values & gamepad->mapButtonA3->pinMask)  ? gamepad->mapButtonA3->buttonMask  : 0)
+		| ((values & gamepad->mapButtonA4->pinMask)  ? gamepad->mapButtonA4->buttonMask  : 0)
+		| ((values & gamepad->mapButtonE1->pinMask)  ? gamepad->mapButtonE1->buttonMask  : 0)
+		| ((values & gamepad->mapButtonE2->pinMask)  ? gamepad->mapButtonE2->buttonMask  : 0)
+		| ((values & gamepad->mapButtonE3->pinMask)  ? gamepad->mapButtonE3->buttonMask  : 0)
+		| ((values & gamepad->mapButtonE4->pinMask)  ? gamepad->mapButtonE4->buttonMask  : 0)
+		| ((values & gamepad->mapButtonE5->pinMask)  ? gamepad->mapButtonE5->buttonMask  : 0)
+		| ((values & gamepad->mapButtonE6->pinMask)  ? gamepad->mapButtonE6->buttonMask  : 0)
+		| ((values & gamepad->mapButtonE7->pinMask)  ? gamepad->mapButtonE7->buttonMask  : 0)
+		| ((values & gamepad->mapButtonE8->pinMask)  ? gamepad->mapButtonE8->buttonMask  : 0)
+		| ((values & gamepad->mapButtonE9->pinMask)  ? gamepad->mapButtonE9->buttonMask  : 0)
+		| ((values & gamepad->mapButtonE10->pinMask) ? gamepad->mapButtonE10->buttonMask : 0)
+		| ((values & gamepad->mapButtonE11->pinMask) ? gamepad->mapButtonE11->buttonMask : 0)
+		| ((values & gamepad->mapButtonE12->pinMask) ? gamepad->mapButtonE12->buttonMask : 0)
+	;
+
+	const auto axis = [values](const GamepadButtonMapping * neg, const GamepadButtonMapping * pos) -> uint16_t {
+		if (values & neg->pinMask)
+			return GAMEPAD_JOYSTICK_MIN;
+		else if (values & pos->pinMask)
+			return GAMEPAD_JOYSTICK_MAX;
+		return GAMEPAD_JOYSTICK_MID;
+	};
+	state.lx = axis(gamepad->mapAnalogLSXNeg, gamepad->mapAnalogLSXPos);
+	state.ly = axis(gamepad->mapAnalogLSYNeg, gamepad->mapAnalogLSYPos);
+	state.rx = axis(gamepad->mapAnalogRSXNeg, gamepad->mapAnalogRSXPos);
+	state.ry = axis(gamepad->mapAnalogRSYNeg, gamepad->mapAnalogRSYPos);
+}
+
+// Every pin gets a random action, with random masks for custom combos
+static void randomizePinMappings() {
+	GpioMappingInfo * pinMappings = Storage::getInstance().getProfilePinMappings();
+	for (Pin_t pin = 0; pin < (Pin_t)NUM_BANK0_GPIOS; pin++) {
+		pinMappings[pin].action = (GpioAction)(rand() % (GpioAction::SUSTAIN_4_8_WAY_MODE + 1));
+		pinMappings[pin].customDpadMask = rand() & 0x0f;
+		pinMappings[pin].customButtonMask = rand() & 0x3fff;
+	}
+}
+
+static Mask_t randomGpio() {
+	return ((Mask_t)rand() << 16) ^ (Mask_t)rand();
+}
+
+int main() {
+	srand(2040);
+	Storage::getInstance().init();
+	Gamepad * gamepad = new Gamepad();
+	Storage::getInstance().SetGamepad(gamepad);
+	gamepad->setup();
+
+	// Same state for every pin map and GPIO value
+	uint32_t mismatches = 0;
+	for (int map = 0; map < PIN_MAPS; map++) {
+		randomizePinMappings();
+		gamepad->reinit();
+		for (int i = 0; i < READS_PER_MAP; i++) {
+			Mask_t values = randomGpio();
+			// a few pins at a time too, the random word has about half of them set
+			if (i & 1)
+				values &= randomGpio() & randomGpio();
+			gamepad->debouncedGpio = values;
+			gamepad->read();
+			GamepadState expected;
+			referenceRead(gamepad, values, expected);
+			if (gamepad->state.dpad != expected.dpad || gamepad->state.buttons != expected.buttons ||
+				gamepad->state.aux != expected.aux || gamepad->state.lx != expected.lx ||
+				gamepad->state.ly != expected.ly || gamepad->state.rx != expected.rx ||
+				gamepad->state.ry != expected.ry)
+				mismatches++;
+		}
+	}
+	CHECK_EQ(mismatches, 0);
+
+	// Time both paths over the same GPIO values on one random map
+	randomizePinMappings();
+	gamepad->reinit();
+	std::vector<Mask_t> values(BENCH_READS);
+	for (Mask_t & value : values)
+		value = randomGpio();
+
+	uint32_t sink = 0;
+	uint64_t start = hostClockNs();
+	for (Mask_t value : values) {
+		gamepad->debouncedGpio = value;
+		gamepad->read();
+		sink += gamepad->state.buttons + gamepad->state.dpad;
+	}
+	uint64_t lookupNs = hostClockNs() - start;
+
+	GamepadState state;
+	start = hostClockNs();
+	for (Mask_t value : values) {
+		referenceRead(gamepad, value, state);
+		sink -= state.buttons + state.dpad;
+	}
+	uint64_t referenceNs = hostClockNs() - start;
+	CHECK_EQ(sink, 0);
+
+	printf("%d pin maps x %d reads compared, %u mismatches\n", PIN_MAPS, READS_PER_MAP, mismatches);
+	printf("lookup read():     %.1f ns/read (whole read(), analog and dpad mode included)\n",
+		(double)lookupNs / BENCH_READS);
+	printf("per-mapping masks: %.1f ns/read (mask evaluation only)\n", (double)referenceNs / BENCH_READS);
+
+	return hostTestResult("test_gamepad_pin_lookup");
+}
@@ -0,0 +1,108 @@
+/*
+ * SPDX-License-Identifier: MIT
+ * SPDX-FileCopyrightText: Copyright (c) 2024 OpenStickCommunity (gp2040-ce.info)
+ */
+
+// GamepadSnapshot stress: one thread publishes states whose fields all derive from a counter while
+// another reads them back, as Core0 and Core1 do. Every read has to be one whole published state.
+// A plain memcpy of the same buffer is run alongside as a control for how often tearing shows up.
+
+#include <string.h>
+#include <atomic>
+#include <thread>
+
+#include "hosttest.h"
+#include "hostsim.h"
+
+#include "gamepad/GamepadState.h"
+#include "gamepad/GamepadSnapshot.h"
+
+#define PUBLISHES 4000000
+
+static GamepadState makeState(uint32_t n) {
+	GamepadState state;
+	state.buttons = n;
+	state.dpad = n & 0x0f;
+	state.dpadOriginal = ~n & 0x0f;
+	state.aux = (n * 7) & 0xffff;
+	state.lx = n & 0xffff;
+	state.ly = ~n & 0xffff;
+	state.rx = n >> 16;
+	state.ry = ~(n >> 16) & 0xffff;
+	state.lt = n & 0xff;
+	state.rt = ~n & 0xff;
+	state.ema_1_x = (float)(n & 0xffff);
+	state.ema_1_y = (float)(n >> 16);
+	state.ema_2_x = -(float)(n & 0xffff);
+	state.ema_2_y = -(float)(n >> 16);
+	return state;
+}
+
+static bool isWhole(const GamepadState & state) {
+	// field by field, the padding after dpadOriginal isn't part of the state
+	GamepadState expected = makeState(state.buttons);
+	return state.dpad == expected.dpad && state.dpadOriginal == expected.dpadOriginal &&
+		state.aux == expected.aux && state.lx == expected.lx && state.ly == expected.ly &&
+		state.rx == expected.rx && state.ry == expected.ry && state.lt == expected.lt &&
+		state.rt == expected.rt && state.ema_1_x == expected.ema_1_x && state.ema_1_y == expected.ema_1_y &&
+		state.ema_2_x == expected.ema_2_x && state.ema_2_y == expected.ema_2_y;
+}
+
+static GamepadSnapshot<GamepadState> snapshot;
+static GamepadState plain;
+static std::atomic<bool> done(false);
+
+int main() {
+	std::thread writer([]() {
+		for (uint32_t n = 1; n <= PUBLISHES; n++) {
+			GamepadState state = makeState(n);
+			snapshot.publish(state);
+			memcpy(&plain, &state, sizeof(GamepadState));
+		}
+		done.store(true);
+	});
+
+	uint64_t reads = 0;
+	uint64_t retries = 0;
+	uint64_t torn = 0;
+	uint64_t backwards = 0;
+	uint64_t plainTorn = 0;
+	uint64_t worstReadNs = 0;
+	uint32_t last = 0;
+	GamepadState state;
+	while (!done.load()) {
+		uint64_t before = hostClockNs();
+		retries += snapshot.read(state);
+		uint64_t took = hostClockNs() - before;
+		if (took > worstReadNs)
+			worstReadNs = took;
+		reads++;
+		if (!isWhole(state) && state.buttons != 0)
+			torn++;
+		// a single producer only ever moves forward
+		if (state.buttons < last)
+			backwards++;
+		last = state.buttons;
+
+		GamepadState copy;
+		memcpy(&copy, &plain, sizeof(GamepadState));
+		if (!isWhole(copy) && copy.buttons != 0)
+			plainTorn++;
+	}
+	writer.join();
+
+	snapshot.read(state);
+	CHECK_EQ(state.buttons, PUBLISHES);
+	CHECK(isWhole(state));
+	CHECK_EQ(torn, 0);
+	CHECK_EQ(backwards, 0);
+	CHECK(reads > 0);
+
+	printf("%d publishes, %llu reads, %llu retries (%.3f per read), worst read %llu ns\n", PUBLISHES,
+		(unsigned long long)reads, (unsigned long long)retries, reads ? (double)retries / reads : 0.0,
+		(unsigned long long)worstReadNs);
+	printf("seqlock torn reads: %llu, unsynchronised memcpy torn reads: %llu\n",
+		(unsigned long long)torn, (unsigned long long)plainTorn);
+
+	return hostTestResult("test_gamepad_snapshot");
+}
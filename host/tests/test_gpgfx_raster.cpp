@@ -0,0 +1,360 @@
+/*
+ * SPDX-License-Identifier: MIT
+ * SPDX-FileCopyrightText: Copyright (c) 2024 OpenStickCommunity (gp2040-ce.info)
+ */
+
+// GPGFX shapes: the integer rasterizer of the tiny SSD1306 driver against the double precision one it
+// replaced (tests/gpgfx_float.cpp). A sweep of rotated rectangles, polygons, pills and arcs, then every
+// left and right button layout drawn by ButtonLayoutScreen with nothing and everything pressed, are
+// rasterized by both. Rounding may move an edge by a pixel, but nothing either one draws may be further
+// than a pixel from what the other drew. Each layout's shapes are then replayed on both to compare draw
+// times.
+
+#include <math.h>
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+#include "hosttest.h"
+#include "hostsim.h"
+
+#include "GPGFX.h"
+#include "GPGFX_UI.h"
+#include "tiny_ssd1306.h"
+#include "ButtonLayoutScreen.h"
+#include "layoutmanager.h"
+#include "gamepad.h"
+#include "peripheralmanager.h"
+#include "storagemanager.h"
+
+#define DISPLAY_ADDRESS 0x3C
+#define WIDTH 128
+#define HEIGHT 64
+#define BENCH_REPEATS 200
+
+GPGFX_DisplayBase * createFloatShapesDisplay();
+
+enum ShapeKind {
+	SHAPE_LINE,
+	SHAPE_ARC,
+	SHAPE_ELLIPSE,
+	SHAPE_RECTANGLE,
+	SHAPE_POLYGON,
+	SHAPE_PILL,
+	SHAPE_KINDS
+};
+
+static const char * shapeNames[SHAPE_KINDS] = { "line", "arc", "ellipse", "rectangle", "polygon", "pill" };
+
+struct ShapeCall {
+	ShapeKind kind;
+	uint16_t x, y;
+	uint32_t a, b;          // far corner, radii or radius and sides
+	uint32_t color;
+	uint8_t filled;
+	double angle, angleEnd;
+	uint8_t closed;
+};
+
+// Keeps the shapes a screen asks for, but not the lines they are drawn with, and never touches the bus
+class RecordingDisplay : public GPGFX_TinySSD1306 {
+public:
+	std::vector<ShapeCall> calls;
+
+	void drawLine(uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2, uint32_t color, uint8_t filled) override {
+		record({ SHAPE_LINE, x1, y1, x2, y2, color, filled, 0, 0, 0 });
+		depth++;
+		GPGFX_TinySSD1306::drawLine(x1, y1, x2, y2, color, filled);
+		depth--;
+	}
+	void drawArc(uint16_t x, uint16_t y, uint32_t radiusX, uint32_t radiusY, uint32_t color, uint8_t filled,
+		double startAngle, double endAngle, uint8_t closed) override {
+		record({ SHAPE_ARC, x, y, radiusX, radiusY, color, filled, startAngle, endAngle, closed });
+		depth++;
+		GPGFX_TinySSD1306::drawArc(x, y, radiusX, radiusY, color, filled, startAngle, endAngle, closed);
+		depth--;
+	}
+	void drawEllipse(uint16_t x, uint16_t y, uint32_t radiusX, uint32_t radiusY, uint32_t color, uint8_t filled) override {
+		record({ SHAPE_ELLIPSE, x, y, radiusX, radiusY, color, filled, 0, 0, 0 });
+		depth++;
+		GPGFX_TinySSD1306::drawEllipse(x, y, radiusX, radiusY, color, filled);
+		depth--;
+	}
+	void drawRectangle(uint16_t x, uint16_t y, uint16_t width, uint16_t height, uint32_t color, uint8_t filled,
+		double rotationAngle) override {
+		record({ SHAPE_RECTANGLE, x, y, width, height, color, filled, rotationAngle, 0, 0 });
+		depth++;
+		GPGFX_TinySSD1306::drawRectangle(x, y, width, height, color, filled, rotationAngle);
+		depth--;
+	}
+	void drawPolygon(uint16_t x, uint16_t y, uint16_t radius, uint16_t sides, uint32_t color, uint8_t filled,
+		double rotation) override {
+		record({ SHAPE_POLYGON, x, y, radius, sides, color, filled, rotation, 0, 0 });
+		depth++;
+		GPGFX_TinySSD1306::drawPolygon(x, y, radius, sides, color, filled, rotation);
+		depth--;
+	}
+	void drawPill(uint16_t x, uint16_t y, uint16_t width, uint16_t height, uint32_t color, uint8_t filled,
+		double rotationAngle) override {
+		record({ SHAPE_PILL, x, y, width, height, color, filled, rotationAngle, 0, 0 });
+		depth++;
+		GPGFX_TinySSD1306::drawPill(x, y, width, height, color, filled, rotationAngle);
+		depth--;
+	}
+	void drawBuffer(uint8_t *) override {}
+	void drawBuffer(uint8_t *, uint8_t) override {}
+
+private:
+	void record(const ShapeCall & call) {
+		if (depth == 0)
+			calls.push_back(call);
+	}
+
+	int depth = 0;
+};
+
+static void replay(GPGFX_DisplayBase * display, const std::vector<ShapeCall> & calls) {
+	for (const ShapeCall & call : calls) {
+		switch (call.kind) {
+			case SHAPE_LINE:
+				display->drawLine(call.x, call.y, call.a, call.b, call.color, call.filled);
+				break;
+			case SHAPE_ARC:
+				display->drawArc(call.x, call.y, call.a, call.b, call.color, call.filled, call.angle, call.angleEnd,
+					call.closed);
+				break;
+			case SHAPE_ELLIPSE:
+				display->drawEllipse(call.x, call.y, call.a, call.b, call.color, call.filled);
+				break;
+			case SHAPE_RECTANGLE:
+				display->drawRectangle(call.x, call.y, call.a, call.b, call.color, call.filled, call.angle);
+				break;
+			case SHAPE_POLYGON:
+				display->drawPolygon(call.x, call.y, call.a, call.b, call.color, call.filled, call.angle);
+				break;
+			case SHAPE_PILL:
+				display->drawPill(call.x, call.y, call.a, call.b, call.color, call.filled, call.angle);
+				break;
+			default:
+				break;
+		}
+	}
+}
+
+typedef std::vector<uint8_t> Image;
+
+static Image rasterize(GPGFX_DisplayBase * display, const std::vector<ShapeCall> & calls) {
+	display->clear();
+	replay(display, calls);
+	Image image(WIDTH * HEIGHT);
+	for (uint8_t y = 0; y < HEIGHT; y++) {
+		for (uint8_t x = 0; x < WIDTH; x++)
+			image[y * WIDTH + x] = display->getPixel(x, y) != 0;
+	}
+	return image;
+}
+
+static bool litNear(const Image & image, int x, int y) {
+	for (int ny = std::max(y - 1, 0); ny <= std::min(y + 1, HEIGHT - 1); ny++) {
+		for (int nx = std::max(x - 1, 0); nx <= std::min(x + 1, WIDTH - 1); nx++) {
+			if (image[ny * WIDTH + nx])
+				return true;
+		}
+	}
+	return false;
+}
+
+struct Difference {
+	uint32_t lit;           // pixels the reference lights
+	uint32_t differ;        // pixels that differ
+	uint32_t far;           // pixels lit in one image with nothing lit within a pixel in the other
+};
+
+static Difference compare(const Image & image, const Image & reference) {
+	Difference result = {};
+	for (int y = 0; y < HEIGHT; y++) {
+		for (int x = 0; x < WIDTH; x++) {
+			bool lit = image[y * WIDTH + x];
+			bool expected = reference[y * WIDTH + x];
+			result.lit += expected;
+			if (lit == expected)
+				continue;
+			result.differ++;
+			if (lit ? !litNear(reference, x, y) : !litNear(image, x, y))
+				result.far++;
+		}
+	}
+	return result;
+}
+
+static void accumulate(Difference & total, const Difference & difference) {
+	total.lit += difference.lit;
+	total.differ += difference.differ;
+	total.far += difference.far;
+}
+
+// Rotations and sizes beyond what the layouts use, one shape per image
+static std::vector<ShapeCall> shapeSweep(ShapeKind kind) {
+	std::vector<ShapeCall> calls;
+	for (uint8_t filled = 0; filled < 2; filled++) {
+		if (kind == SHAPE_RECTANGLE) {
+			for (int angle = 0; angle < 360; angle += 15) {
+				calls.push_back({ SHAPE_RECTANGLE, 44, 22, 84, 42, 1, filled, (double)angle, 0, 0 });
+				calls.push_back({ SHAPE_RECTANGLE, 58, 26, 67, 37, 1, filled, (double)angle, 0, 0 });
+			}
+		} else if (kind == SHAPE_POLYGON) {
+			for (uint16_t sides = 3; sides <= 8; sides++) {
+				for (int step = 0; step < 12; step++)
+					calls.push_back({ SHAPE_POLYGON, 64, 32, 20, sides, 1, filled, step * M_PI / 12, 0, 0 });
+			}
+		} else if (kind == SHAPE_PILL) {
+			for (int angle = 0; angle < 360; angle += 15) {
+				calls.push_back({ SHAPE_PILL, 40, 24, 88, 40, 1, filled, (double)angle, 0, 0 });
+				calls.push_back({ SHAPE_PILL, 58, 12, 70, 52, 1, filled, (double)angle, 0, 0 });
+			}
+		} else if (kind == SHAPE_ARC) {
+			for (int start = 0; start < 360; start += 30) {
+				for (int sweep = 30; sweep <= 360; sweep += 60) {
+					for (uint8_t closed = 0; closed < 2; closed++)
+						calls.push_back({ SHAPE_ARC, 64, 32, 24, 16, 1, filled, (double)start, (double)(start + sweep), closed });
+				}
+			}
+		}
+	}
+	return calls;
+}
+
+// A button shows filled when the processed state has it and its pins read low
+static void setPressed(bool pressed) {
+	hostGpioSetInputs(pressed ? 0 : 0xffffffff);
+	Gamepad * processed = Storage::getInstance().GetProcessedGamepad();
+	processed->state.dpad = pressed ? GAMEPAD_MASK_DPAD : 0;
+	processed->state.buttons = pressed ? 0x3ffff : 0;
+}
+
+// Every shape ButtonLayoutScreen draws for the current layouts, released and then pressed
+static void recordLayout(GPGFX * gfx, RecordingDisplay * recorder, std::vector<ShapeCall> frames[2]) {
+	for (int pressed = 0; pressed < 2; pressed++) {
+		setPressed(pressed);
+		recorder->calls.clear();
+		ButtonLayoutScreen * screen = new ButtonLayoutScreen(gfx);
+		screen->init();
+		screen->update();
+		screen->draw(0);
+		screen->shutdown();
+		delete screen;
+		frames[pressed] = recorder->calls;
+	}
+	setPressed(false);
+}
+
+static double drawUs(GPGFX_DisplayBase * display, const std::vector<ShapeCall> & calls) {
+	auto start = std::chrono::steady_clock::now();
+	for (int i = 0; i < BENCH_REPEATS; i++) {
+		display->clear();
+		replay(display, calls);
+	}
+	auto elapsed = std::chrono::steady_clock::now() - start;
+	return std::chrono::duration<double, std::micro>(elapsed).count() / BENCH_REPEATS;
+}
+
+struct LayoutResult {
+	size_t shapes;
+	Difference difference;
+	double integerUs;
+	double floatUs;
+};
+
+static LayoutResult runLayout(GPGFX * gfx, RecordingDisplay * recorder, GPGFX_DisplayBase * integer,
+	GPGFX_DisplayBase * reference) {
+	LayoutResult result = {};
+	std::vector<ShapeCall> frames[2];
+	recordLayout(gfx, recorder, frames);
+	std::vector<ShapeCall> calls = frames[0];
+	calls.insert(calls.end(), frames[1].begin(), frames[1].end());
+	result.shapes = calls.size();
+	for (const std::vector<ShapeCall> & frame : frames)
+		accumulate(result.difference, compare(rasterize(integer, frame), rasterize(reference, frame)));
+	result.integerUs = drawUs(integer, calls);
+	result.floatUs = drawUs(reference, calls);
+	return result;
+}
+
+int main() {
+	hostTimeSetManual(true);
+	Storage::getInstance().init();
+	Storage::getInstance().SetGamepad(new Gamepad());
+	Storage::getInstance().SetProcessedGamepad(new Gamepad());
+	Storage::getInstance().setFunctionalPinMappings();
+	hostGpioSetInputs(0xffffffff);
+	Storage::getInstance().GetGamepad()->setup();
+
+	PeripheralOptions_I2COptions & i2cOptions = Storage::getInstance().getPeripheralOptions().blockI2C0;
+	i2cOptions.enabled = true;
+	i2cOptions.sda = 0;
+	i2cOptions.scl = 1;
+	i2cOptions.speed = 400000;
+	PeripheralManager::getInstance().initI2C();
+	HostI2CDevice panel;
+	hostI2CAttach(i2c0, DISPLAY_ADDRESS, &panel);
+
+	GPGFX_DisplayTypeOptions options = {};
+	options.displayType = GPGFX_DisplayType::DISPLAY_TYPE_SSD1306;
+	options.i2c = PeripheralManager::getInstance().getI2C(0);
+	options.address = DISPLAY_ADDRESS;
+	options.size = GPGFX_DisplaySize::SIZE_128x64;
+	options.font.fontData = GP_Font_Standard;
+	options.font.width = 6;
+	options.font.height = 8;
+
+	GPGFX_DisplayBase * integer = new GPGFX_TinySSD1306();
+	GPGFX_DisplayBase * reference = createFloatShapesDisplay();
+	integer->init(options);
+	reference->init(options);
+
+	printf("shape sweep, integer against double precision\n");
+	printf("  %-10s %7s %9s %9s %9s\n", "shape", "shapes", "lit", "differ", "far");
+	for (ShapeKind kind : { SHAPE_RECTANGLE, SHAPE_POLYGON, SHAPE_PILL, SHAPE_ARC }) {
+		std::vector<ShapeCall> calls = shapeSweep(kind);
+		Difference total = {};
+		for (const ShapeCall & call : calls) {
+			std::vector<ShapeCall> one = { call };
+			accumulate(total, compare(rasterize(integer, one), rasterize(reference, one)));
+		}
+		printf("  %-10s %7zu %9u %9u %9u\n", shapeNames[kind], calls.size(), total.lit, total.differ, total.far);
+		CHECK(total.lit > 0);
+		CHECK_EQ(total.far, 0);
+	}
+
+	RecordingDisplay * recorder = new RecordingDisplay();
+	GPGFX * gfx = new GPGFX();
+	gfx->init(options, recorder);
+
+	DisplayOptions & displayOptions = Storage::getInstance().getDisplayOptions();
+	printf("button layouts, released and pressed, %d draws each\n", BENCH_REPEATS);
+	printf("  %-40s %7s %9s %9s %6s %11s %11s\n", "layout", "shapes", "lit", "differ", "far", "integer us",
+		"double us");
+	double integerTotalUs = 0;
+	double floatTotalUs = 0;
+	for (int side = 0; side < 2; side++) {
+		int last = side ? _ButtonLayoutRight_MAX : _ButtonLayout_MAX;
+		for (int layout = 0; layout <= last; layout++) {
+			// the other half stays blank so each row is one layout
+			displayOptions.buttonLayout = side ? BUTTON_LAYOUT_BLANKA : (ButtonLayout)layout;
+			displayOptions.buttonLayoutRight = side ? (ButtonLayoutRight)layout : BUTTON_LAYOUT_BLANKB;
+			LayoutResult result = runLayout(gfx, recorder, integer, reference);
+			std::string name = side ? LayoutManager::getInstance().getLayoutBName() :
+				LayoutManager::getInstance().getLayoutAName();
+			printf("  %-40s %7zu %9u %9u %6u %11.1f %11.1f\n", name.c_str(), result.shapes, result.difference.lit,
+				result.difference.differ, result.difference.far, result.integerUs, result.floatUs);
+			integerTotalUs += result.integerUs;
+			floatTotalUs += result.floatUs;
+			CHECK_EQ(result.difference.far, 0);
+		}
+	}
+	printf("  %-40s %7s %9s %9s %6s %11.1f %11.1f\n", "all layouts", "", "", "", "", integerTotalUs, floatTotalUs);
+
+	delete gfx;
+	delete reference;
+	return hostTestResult("test_gpgfx_raster");
+}
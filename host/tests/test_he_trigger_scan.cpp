@@ -0,0 +1,247 @@
+/*
+ * SPDX-License-Identifier: MIT
+ * SPDX-FileCopyrightText: Copyright (c) 2024 OpenStickCommunity (gp2040-ce.info)
+ */
+
+// HE trigger mux scan: 32 Hall effect keys behind two 16 channel muxes, with the ADC ring running as
+// on Core0. The mux follows the select pins, so a sample converted before a switch reads the previous
+// channel. Keys are pressed and released at random; for each muxChannelsPerLoop setting the test reports
+// how often every key is sampled and how late presses and releases reach the gamepad state, and checks
+// that no key ever shows up on another key's bit.
+
+#include <stdlib.h>
+#include <algorithm>
+
+#include "hosttest.h"
+#include "hostsim.h"
+
+#include "addons/he_trigger.h"
+#include "gamepad.h"
+#include "storagemanager.h"
+#include "peripheralmanager.h"
+
+#define KEYS 32
+#define MUX_CHANNELS 16
+#define LOOP_US 25           // rest of the Core0 loop between two preprocess() calls
+#define RUN_US 2000000
+#define KEY_IDLE 600
+#define KEY_PRESSED 3400
+#define KEY_ACTIVE 2000
+
+static const int selectPins[4] = { 2, 3, 4, 5 };
+
+// Every key owns one bit of the state, so crosstalk is visible
+static const struct {
+	GpioAction action;
+	uint8_t dpad;
+	uint32_t buttons;
+} keyActions[KEYS] = {
+	{ GpioAction::BUTTON_PRESS_UP, GAMEPAD_MASK_UP, 0 },
+	{ GpioAction::BUTTON_PRESS_DOWN, GAMEPAD_MASK_DOWN, 0 },
+	{ GpioAction::BUTTON_PRESS_LEFT, GAMEPAD_MASK_LEFT, 0 },
+	{ GpioAction::BUTTON_PRESS_RIGHT, GAMEPAD_MASK_RIGHT, 0 },
+	{ GpioAction::BUTTON_PRESS_B1, 0, GAMEPAD_MASK_B1 },
+	{ GpioAction::BUTTON_PRESS_B2, 0, GAMEPAD_MASK_B2 },
+	{ GpioAction::BUTTON_PRESS_B3, 0, GAMEPAD_MASK_B3 },
+	{ GpioAction::BUTTON_PRESS_B4, 0, GAMEPAD_MASK_B4 },
+	{ GpioAction::BUTTON_PRESS_L1, 0, GAMEPAD_MASK_L1 },
+	{ GpioAction::BUTTON_PRESS_R1, 0, GAMEPAD_MASK_R1 },
+	{ GpioAction::BUTTON_PRESS_L2, 0, GAMEPAD_MASK_L2 },
+	{ GpioAction::BUTTON_PRESS_R2, 0, GAMEPAD_MASK_R2 },
+	{ GpioAction::BUTTON_PRESS_S1, 0, GAMEPAD_MASK_S1 },
+	{ GpioAction::BUTTON_PRESS_S2, 0, GAMEPAD_MASK_S2 },
+	{ GpioAction::BUTTON_PRESS_L3, 0, GAMEPAD_MASK_L3 },
+	{ GpioAction::BUTTON_PRESS_R3, 0, GAMEPAD_MASK_R3 },
+	{ GpioAction::BUTTON_PRESS_A1, 0, GAMEPAD_MASK_A1 },
+	{ GpioAction::BUTTON_PRESS_A2, 0, GAMEPAD_MASK_A2 },
+	{ GpioAction::BUTTON_PRESS_A3, 0, GAMEPAD_MASK_A3 },
+	{ GpioAction::BUTTON_PRESS_A4, 0, GAMEPAD_MASK_A4 },
+	{ GpioAction::BUTTON_PRESS_E1, 0, GAMEPAD_MASK_E1 },
+	{ GpioAction::BUTTON_PRESS_E2, 0, GAMEPAD_MASK_E2 },
+	{ GpioAction::BUTTON_PRESS_E3, 0, GAMEPAD_MASK_E3 },
+	{ GpioAction::BUTTON_PRESS_E4, 0, GAMEPAD_MASK_E4 },
+	{ GpioAction::BUTTON_PRESS_E5, 0, GAMEPAD_MASK_E5 },
+	{ GpioAction::BUTTON_PRESS_E6, 0, GAMEPAD_MASK_E6 },
+	{ GpioAction::BUTTON_PRESS_E7, 0, GAMEPAD_MASK_E7 },
+	{ GpioAction::BUTTON_PRESS_E8, 0, GAMEPAD_MASK_E8 },
+	{ GpioAction::BUTTON_PRESS_E9, 0, GAMEPAD_MASK_E9 },
+	{ GpioAction::BUTTON_PRESS_E10, 0, GAMEPAD_MASK_E10 },
+	{ GpioAction::BUTTON_PRESS_E11, 0, GAMEPAD_MASK_E11 },
+	{ GpioAction::BUTTON_PRESS_E12, 0, GAMEPAD_MASK_E12 },
+};
+
+// The two muxes, driven by the select pins
+static struct {
+	bool pressed[KEYS];
+	uint32_t channel;
+	uint64_t switches;
+} mux;
+
+static void muxUpdate() {
+	for (int m = 0; m < KEYS / MUX_CHANNELS; m++)
+		hostAdcSetInput(m, mux.pressed[m * MUX_CHANNELS + mux.channel] ? KEY_PRESSED : KEY_IDLE);
+}
+
+static void muxSelectHook(uint32_t outputs, void *) {
+	uint32_t channel = 0;
+	for (int i = 0; i < 4; i++)
+		channel |= ((outputs >> selectPins[i]) & 1) << i;
+	if (channel != mux.channel) {
+		mux.channel = channel;
+		mux.switches++;
+		muxUpdate();
+	}
+}
+
+static uint32_t stateKeys(const GamepadState & state) {
+	uint32_t keys = 0;
+	for (int key = 0; key < KEYS; key++) {
+		if ((state.dpad & keyActions[key].dpad) || (state.buttons & keyActions[key].buttons))
+			keys |= 1u << key;
+	}
+	return keys;
+}
+
+struct ScanResult {
+	double keySampleHz;
+	uint64_t pressAvgUs;
+	uint64_t pressMaxUs;
+	uint64_t releaseMaxUs;
+	uint64_t presses;
+	uint64_t missed;
+	uint64_t phantom;
+	uint64_t loopAvgUs;
+};
+
+static ScanResult runScan(int32_t channelsPerLoop) {
+	HETriggerOptions & options = Storage::getInstance().getAddonOptions().heTriggerOptions;
+	options.muxChannelsPerLoop = channelsPerLoop;
+	memset(&mux, 0, sizeof(mux));
+	muxUpdate();
+
+	HETriggerAddon * addon = new HETriggerAddon();
+	addon->setup();
+	PeripheralManager::getInstance().getADC()->start();
+
+	Gamepad * gamepad = Storage::getInstance().GetGamepad();
+	uint64_t changeUs[KEYS] = {};
+	uint64_t nextChangeUs[KEYS];
+	for (int key = 0; key < KEYS; key++)
+		nextChangeUs[key] = 1000 + rand() % 20000;
+	uint32_t seen = 0;
+	uint64_t pressTotalUs = 0;
+	ScanResult result = {};
+
+	// A change has to show within a full scan of every channel plus a loop of slack
+	int32_t loopsPerScan = (MUX_CHANNELS + channelsPerLoop - 1) / channelsPerLoop;
+	uint64_t boundUs = (loopsPerScan + 1) * (LOOP_US + 30);
+
+	uint64_t startUs = hostTimeNs() / 1000;
+	uint64_t switchesBefore = mux.switches;
+	uint64_t loops = 0;
+	while (true) {
+		uint64_t us = hostTimeNs() / 1000 - startUs;
+		if (us >= RUN_US)
+			break;
+		for (int key = 0; key < KEYS; key++) {
+			if (us >= nextChangeUs[key]) {
+				mux.pressed[key] = !mux.pressed[key];
+				changeUs[key] = us;
+				// holds of 2 to 30ms, gaps of up to 60ms
+				nextChangeUs[key] = us + (mux.pressed[key] ? 2000 + rand() % 28000 : 1000 + rand() % 60000);
+				if (mux.pressed[key])
+					result.presses++;
+			}
+		}
+		muxUpdate();
+
+		gamepad->state.dpad = 0;
+		gamepad->state.buttons = 0;
+		addon->preprocess();
+		loops++;
+		uint64_t doneUs = hostTimeNs() / 1000 - startUs;
+		uint32_t keys = stateKeys(gamepad->state);
+
+		for (int key = 0; key < KEYS; key++) {
+			uint32_t bit = 1u << key;
+			bool shown = keys & bit;
+			if (shown != ((seen & bit) != 0)) {
+				// first loop showing the change
+				uint64_t lateUs = doneUs - changeUs[key];
+				if (shown) {
+					pressTotalUs += lateUs;
+					result.pressMaxUs = std::max(result.pressMaxUs, lateUs);
+				} else {
+					result.releaseMaxUs = std::max(result.releaseMaxUs, lateUs);
+				}
+			}
+			// shown without being held or still missing well after the change
+			if (shown != mux.pressed[key] && doneUs - changeUs[key] > boundUs) {
+				if (shown)
+					result.phantom++;
+				else
+					result.missed++;
+			}
+		}
+		seen = keys;
+		hostTimeAdvanceUs(LOOP_US);
+	}
+
+	uint64_t elapsedUs = hostTimeNs() / 1000 - startUs;
+	result.keySampleHz = (double)(mux.switches - switchesBefore) / MUX_CHANNELS * 1e6 / elapsedUs;
+	result.pressAvgUs = result.presses ? pressTotalUs / result.presses : 0;
+	result.loopAvgUs = elapsedUs / loops;
+
+	PeripheralManager::getInstance().getADC()->stop();
+	delete addon;
+	return result;
+}
+
+int main() {
+	srand(10);
+	hostTimeSetManual(true);
+	Storage::getInstance().init();
+	Storage::getInstance().SetGamepad(new Gamepad());
+
+	HETriggerOptions & options = Storage::getInstance().getAddonOptions().heTriggerOptions;
+	options.enabled = true;
+	options.muxChannels = MUX_CHANNELS;
+	options.selectPin0 = selectPins[0];
+	options.selectPin1 = selectPins[1];
+	options.selectPin2 = selectPins[2];
+	options.selectPin3 = selectPins[3];
+	options.muxADCPin0 = 26;
+	options.muxADCPin1 = 27;
+	options.muxADCPin2 = -1;
+	options.muxADCPin3 = -1;
+	options.emaSmoothing = false;
+	for (int key = 0; key < KEYS; key++) {
+		options.triggers[key].action = keyActions[key].action;
+		options.triggers[key].active = KEY_ACTIVE;
+	}
+	hostGpioSetOutputHook(muxSelectHook, nullptr);
+
+	printf("%d keys on 2x%d channel muxes, %dus of loop besides the scan, %ds of random presses\n",
+		KEYS, MUX_CHANNELS, LOOP_US, RUN_US / 1000000);
+	printf("  %-16s %10s %12s %12s %12s %12s %8s %8s\n", "channels/loop", "loop us", "key rate Hz",
+		"press avg us", "press max us", "release max", "missed", "phantom");
+	for (int32_t channelsPerLoop : { 16, 8, 4, 2, 1 }) {
+		ScanResult result = runScan(channelsPerLoop);
+		printf("  %-16d %10llu %12.0f %12llu %12llu %12llu %8llu %8llu\n", channelsPerLoop,
+			(unsigned long long)result.loopAvgUs, result.keySampleHz, (unsigned long long)result.pressAvgUs,
+			(unsigned long long)result.pressMaxUs, (unsigned long long)result.releaseMaxUs,
+			(unsigned long long)result.missed, (unsigned long long)result.phantom);
+
+		// every key is seen on its own bit within a scan, and only while it is held
+		CHECK(result.presses > 0);
+		CHECK_EQ(result.missed, 0);
+		CHECK_EQ(result.phantom, 0);
+		int32_t loopsPerScan = MUX_CHANNELS / channelsPerLoop;
+		CHECK(result.pressMaxUs <= (uint64_t)(loopsPerScan + 1) * (result.loopAvgUs + LOOP_US));
+		// one scan of every channel per loopsPerScan loops
+		double expectedHz = 1e6 / (loopsPerScan * result.loopAvgUs);
+		CHECK(result.keySampleHz > expectedHz * 0.8);
+	}
+
+	return hostTestResult("test_he_trigger_scan");
+}
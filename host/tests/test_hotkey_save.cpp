@@ -0,0 +1,262 @@
+/*
+ * SPDX-License-Identifier: MIT
+ * SPDX-FileCopyrightText: Copyright (c) 2024 OpenStickCommunity (gp2040-ce.info)
+ */
+
+// Hotkey saves: the options hotkeys flip (SOCD, dpad mode, axis inversion, 4-way, profile, focus mode) are
+// changed one at a time and saved, once through the full ConfigUtils::save and once through the hot option
+// overlay, from the same flash image. Each save is timed (host time to encode and queue it) and flushed to the
+// flash model, for the bytes programmed and erased and the stall. Every so often the device reboots: flash is
+// indexed again, the config loaded, and the overlay folded into a new base; the hot options have to come back
+// as they were set.
+//
+// A config with every field at its longest has to fit a record and read back byte for byte,
+// and a save that fails to encode must not touch the full save still waiting in the queue.
+
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <vector>
+
+#include "hosttest.h"
+#include "hostsim.h"
+
+#include "config_utils.h"
+#include "FlashPROM.h"
+#include "storagemanager.h"
+
+#include "pb_common.h"
+#include "pb_encode.h"
+
+#define HOTKEYS 2000
+#define REBOOT_EVERY 25
+#define PROFILES 4
+
+struct HotOptions {
+	DpadMode dpadMode;
+	SOCDMode socdMode;
+	bool invertXAxis;
+	bool invertYAxis;
+	bool fourWayMode;
+	uint32_t profileNumber;
+	bool ddiFourWayMode;
+	bool focusOverride;
+
+	bool operator==(const HotOptions & other) const {
+		return dpadMode == other.dpadMode && socdMode == other.socdMode && invertXAxis == other.invertXAxis &&
+			invertYAxis == other.invertYAxis && fourWayMode == other.fourWayMode &&
+			profileNumber == other.profileNumber && ddiFourWayMode == other.ddiFourWayMode &&
+			focusOverride == other.focusOverride;
+	}
+};
+
+static HotOptions hotOptions(const Config & config) {
+	return {
+		config.gamepadOptions.dpadMode,
+		config.gamepadOptions.socdMode,
+		config.gamepadOptions.invertXAxis,
+		config.gamepadOptions.invertYAxis,
+		config.gamepadOptions.fourWayMode,
+		config.gamepadOptions.profileNumber,
+		config.addonOptions.dualDirectionalOptions.fourWayMode,
+		config.addonOptions.focusModeOptions.overrideEnabled,
+	};
+}
+
+// One hotkey press, as Gamepad::processHotkeyAction would change the option
+static void pressHotkey(Config & config, int hotkey) {
+	GamepadOptions & options = config.gamepadOptions;
+	switch (hotkey % 8) {
+		case 0: options.dpadMode = (DpadMode)((options.dpadMode + 1) % 3); break;
+		case 1: options.socdMode = (SOCDMode)((options.socdMode + 1) % 5); break;
+		case 2: options.invertXAxis = !options.invertXAxis; break;
+		case 3: options.invertYAxis = !options.invertYAxis; break;
+		case 4: options.fourWayMode = !options.fourWayMode; break;
+		case 5: options.profileNumber = options.profileNumber % PROFILES + 1; break;
+		case 6: config.addonOptions.dualDirectionalOptions.fourWayMode = !config.addonOptions.dualDirectionalOptions.fourWayMode; break;
+		default: config.addonOptions.focusModeOptions.overrideEnabled = !config.addonOptions.focusModeOptions.overrideEnabled; break;
+	}
+}
+
+// Power cycle: the store indexes flash, the config is loaded and its full save written, as at boot
+static void reboot(Config & config) {
+	EEPROM.start();
+	ConfigUtils::load(config);
+	EEPROM.flush();
+}
+
+struct SaveRun {
+	uint32_t saves = 0;
+	uint64_t encodeNs = 0;
+	uint64_t worstEncodeNs = 0;
+	uint64_t bytesProgrammed = 0;
+	uint64_t bytesErased = 0;
+	uint64_t stallUs = 0;
+	uint64_t worstStallUs = 0;
+	uint32_t fullSaves = 0;         // full base records written
+	uint32_t mismatches = 0;
+
+	void print(const char * name) const {
+		printf("  %-8s %6u %12.0f %12.0f %12.0f %12.0f %10.2f %10.2f %6u\n", name, saves, (double)encodeNs / saves,
+			(double)worstEncodeNs, (double)bytesProgrammed / saves, (double)bytesErased / saves,
+			stallUs / 1000.0 / saves, worstStallUs / 1000.0, fullSaves);
+	}
+};
+
+static SaveRun runHotkeys(bool overlay) {
+	// Same flash and config to start from on both runs
+	hostFlashErase();
+	Config & config = Storage::getInstance().getConfig();
+	srand(23);
+	reboot(config);
+	hostFlashResetStats();
+
+	SaveRun run;
+	for (int hotkey = 0; hotkey < HOTKEYS; hotkey++) {
+		pressHotkey(config, rand());
+		HotOptions expected = hotOptions(config);
+
+		HostFlashStats before = hostFlashStats();
+		uint64_t start = hostClockNs();
+		bool saved = overlay ? ConfigUtils::saveHotOptions(config) : ConfigUtils::save(config);
+		uint64_t encodeNs = hostClockNs() - start;
+		EEPROM.flush();
+		HostFlashStats after = hostFlashStats();
+		CHECK(saved);
+
+		run.saves++;
+		run.encodeNs += encodeNs;
+		run.worstEncodeNs = std::max(run.worstEncodeNs, encodeNs);
+		run.bytesProgrammed += after.bytesProgrammed - before.bytesProgrammed;
+		run.bytesErased += after.bytesErased - before.bytesErased;
+		run.stallUs += EEPROM.getStats().lastDuration;
+		run.worstStallUs = std::max<uint64_t>(run.worstStallUs, EEPROM.getStats().lastDuration);
+		if (after.bytesProgrammed - before.bytesProgrammed > FLASH_PAGE_SIZE)
+			run.fullSaves++;
+
+		if (hotkey % REBOOT_EVERY == REBOOT_EVERY - 1) {
+			reboot(config);
+			if (!(hotOptions(config) == expected))
+				run.mismatches++;
+		}
+	}
+	return run;
+}
+
+// Every field present, every repeated field full and every string, byte array and number at its longest. Enums get
+// -1 too, which encodes longer than Config_size allows for them, so this is more than any real config.
+static void fillMaximal(const pb_msgdesc_t * fields, void * message) {
+	pb_field_iter_t iter;
+	if (!pb_field_iter_begin(&iter, fields, message))
+		return;
+
+	do {
+		pb_size_t count = 1;
+		if (PB_HTYPE(iter.type) == PB_HTYPE_OPTIONAL)
+			*reinterpret_cast<bool *>(iter.pSize) = true;
+		else if (PB_HTYPE(iter.type) == PB_HTYPE_REPEATED)
+			*reinterpret_cast<pb_size_t *>(iter.pSize) = count = iter.array_size;
+
+		uint8_t * item = reinterpret_cast<uint8_t *>(iter.pData);
+		for (pb_size_t i = 0; i < count; i++, item += iter.data_size) {
+			switch (PB_LTYPE(iter.type)) {
+				case PB_LTYPE_BOOL: *reinterpret_cast<bool *>(item) = true; break;
+				case PB_LTYPE_STRING: memset(item, 'x', iter.data_size - 1); item[iter.data_size - 1] = 0; break;
+				case PB_LTYPE_SUBMESSAGE: fillMaximal(iter.submsg_desc, item); break;
+				case PB_LTYPE_BYTES: {
+					pb_bytes_array_t * bytes = reinterpret_cast<pb_bytes_array_t *>(item);
+					bytes->size = iter.data_size - offsetof(pb_bytes_array_t, bytes);
+					memset(bytes->bytes, 0xa5, bytes->size);
+					break;
+				}
+				case PB_LTYPE_SVARINT: memset(item, 0, iter.data_size); item[iter.data_size - 1] = 0x80; break;
+				default: memset(item, 0xff, iter.data_size); break;     // -1 signed, the longest varint
+			}
+		}
+	} while (pb_field_iter_next(&iter));
+}
+
+static std::vector<uint8_t> encode(const Config & config) {
+	std::vector<uint8_t> bytes(EEPROM_RECORD_MAX_BYTES);
+	pb_ostream_t stream = pb_ostream_from_buffer(bytes.data(), bytes.size());
+	CHECK(pb_encode(&stream, Config_fields, &config));
+	bytes.resize(stream.bytes_written);
+	return bytes;
+}
+
+static std::vector<uint8_t> flashBase() {
+	uint32_t size = 0;
+	const uint8_t * data = EEPROM.read(size);
+	return data != nullptr ? std::vector<uint8_t>(data, data + size) : std::vector<uint8_t>();
+}
+
+static void maximalConfig() {
+	hostFlashErase();
+	EEPROM.start();
+	static Config config;
+	config = Config Config_init_zero;
+	fillMaximal(Config_fields, &config);
+
+	CHECK(ConfigUtils::save(config));
+	EEPROM.flush();
+	EEPROM.start();
+	std::vector<uint8_t> expected = encode(config);
+	printf("largest config: %zu bytes, Config_size %u, record max %u\n", expected.size(), (uint32_t)Config_size,
+		(uint32_t)EEPROM_RECORD_MAX_BYTES);
+	CHECK(expected.size() >= Config_size);
+	CHECK(flashBase() == expected);
+}
+
+static void failedEncode() {
+	hostFlashErase();
+	Config & config = Storage::getInstance().getConfig();
+	reboot(config);
+
+	// A full save waits in the queue when a different, broken config (one more grid index than fits) is saved after it
+	pressHotkey(config, 0);
+	CHECK(ConfigUtils::save(config));
+	std::vector<uint8_t> queued = encode(config);
+
+	static Config broken;
+	broken = config;
+	pressHotkey(broken, 1);
+	broken.animationOptions.gridCaseUpIndices_count = pb_arraysize(AnimationOptions, gridCaseUpIndices) + 1;
+	CHECK(!ConfigUtils::save(broken));
+	CHECK(EEPROM.isPending());
+
+	EEPROM.flush();
+	EEPROM.start();
+	CHECK(flashBase() == queued);
+}
+
+int main() {
+	hostTimeSetManual(true);
+	hostFlashSetTimed(true);
+	Storage::getInstance().init();
+
+	uint32_t size = 0;
+	EEPROM.flush();
+	CHECK(EEPROM.read(size) != nullptr);
+	printf("config record %u bytes\n", size);
+
+	SaveRun full = runHotkeys(false);
+	SaveRun overlay = runHotkeys(true);
+
+	printf("%d hotkey saves, a reboot every %d\n", HOTKEYS, REBOOT_EVERY);
+	printf("  %-8s %6s %12s %12s %12s %12s %10s %10s %6s\n", "path", "saves", "encode ns", "worst ns",
+		"programmed", "erased", "stall ms", "worst ms", "bases");
+	full.print("full");
+	overlay.print("overlay");
+
+	CHECK_EQ(full.mismatches, 0);
+	CHECK_EQ(overlay.mismatches, 0);
+	// An overlay save is one page, the full config only goes out when the log runs into the base's half
+	CHECK(overlay.bytesProgrammed * 4 < full.bytesProgrammed);
+	CHECK(overlay.fullSaves * 10 < (uint32_t)HOTKEYS);
+	CHECK(overlay.encodeNs * 4 < full.encodeNs);
+
+	maximalConfig();
+	failedEncode();
+
+	return hostTestResult("test_hotkey_save");
+}
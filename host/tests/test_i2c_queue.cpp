@@ -0,0 +1,312 @@
+/*
+ * SPDX-License-Identifier: MIT
+ * SPDX-FileCopyrightText: Copyright (c) 2024 OpenStickCommunity (gp2040-ce.info)
+ */
+
+// I2C transaction queue: mock devices sit on a simulated bus behind PeripheralI2C. A batch of mixed
+// priority transactions, one of them to an address nobody answers, has to come out on the wire in the
+// order the scheduler promises (high first, a low one after every burst), each one whole, with its
+// repeated start and the bytes its device sent. Then a display flushes pages back to back while a
+// nunchuk is polled at random points of its page writes: a poll may only ever wait for the one page in
+// flight. With input traffic saturating the bus the display still has to get its turn after every burst.
+
+#include <stdlib.h>
+#include <algorithm>
+#include <deque>
+#include <vector>
+
+#include "hosttest.h"
+#include "hostsim.h"
+
+#include "peripheralmanager.h"
+#include "storagemanager.h"
+
+#define NUNCHUK_ADDRESS 0x52
+#define EXPANDER_ADDRESS 0x20
+#define DISPLAY_ADDRESS 0x3C
+#define ABSENT_ADDRESS 0x11
+#define I2C_SPEED 400000
+#define PAGE_BYTES 129             // control byte and one 128 column page
+#define POLL_US 4000               // plus up to a page of jitter
+#define LOOP_US 20
+#define RUN_US 1000000
+#define BATCH 40
+
+// Answers every read with a running count, so each read is told apart on the wire
+class MockDevice : public HostI2CDevice {
+public:
+	explicit MockDevice(uint8_t address) : counter(address) {}
+	uint8_t read() override { return counter++; }
+private:
+	uint8_t counter;
+};
+
+struct Job {
+	PeripheralI2CTransaction transaction;
+	uint8_t tx[PAGE_BYTES];
+	uint8_t rx[8];
+	uint64_t submitNs;
+	uint64_t doneNs;
+};
+
+static std::vector<int> completed;
+
+static void recordCompletion(PeripheralI2CTransaction * transaction) {
+	completed.push_back((int)(intptr_t)transaction->userData);
+}
+
+static void makeJob(Job & job, uint8_t address, uint16_t txLen, uint16_t rxLen, PeripheralI2CPriority priority) {
+	job.transaction = PeripheralI2CTransaction();
+	job.transaction.address = address;
+	for (uint16_t i = 0; i < txLen; i++)
+		job.tx[i] = rand();
+	job.transaction.tx = txLen ? job.tx : nullptr;
+	job.transaction.txLen = txLen;
+	job.transaction.rx = rxLen ? job.rx : nullptr;
+	job.transaction.rxLen = rxLen;
+	job.transaction.priority = priority;
+}
+
+static void runUntilDone(PeripheralI2CTransaction * transaction) {
+	while (!transaction->isDone())
+		hostTimeAdvanceUs(LOOP_US);
+}
+
+// The scheduler's promise: high priority first, a queued low one after I2C_HIGH_PRIORITY_BURST highs in a row
+static std::vector<int> expectedOrder(const std::vector<Job> & jobs, int first, int highBurst) {
+	std::deque<int> queues[I2C_PRIORITY_COUNT];
+	for (int i = first; i < (int)jobs.size(); i++)
+		queues[jobs[i].transaction.priority].push_back(i);
+	std::vector<int> order;
+	while (!queues[I2C_PRIORITY_HIGH].empty() || !queues[I2C_PRIORITY_LOW].empty()) {
+		bool low = queues[I2C_PRIORITY_HIGH].empty() ||
+			(!queues[I2C_PRIORITY_LOW].empty() && highBurst >= I2C_HIGH_PRIORITY_BURST);
+		std::deque<int> & queue = queues[low ? I2C_PRIORITY_LOW : I2C_PRIORITY_HIGH];
+		order.push_back(queue.front());
+		queue.pop_front();
+		highBurst = low ? 0 : std::min(highBurst + 1, I2C_HIGH_PRIORITY_BURST);
+	}
+	return order;
+}
+
+static void runOrdering(PeripheralI2C * bus) {
+	std::vector<Job> jobs(BATCH + 1);
+	// a page starts on the idle bus, everything behind it queues
+	makeJob(jobs[0], DISPLAY_ADDRESS, PAGE_BYTES, 0, I2C_PRIORITY_LOW);
+	for (int i = 1; i <= BATCH; i++) {
+		switch (rand() % 4) {
+			case 0: makeJob(jobs[i], NUNCHUK_ADDRESS, 1, 6, I2C_PRIORITY_HIGH); break;
+			case 1: makeJob(jobs[i], EXPANDER_ADDRESS, rand() % 2 ? 2 : 0, 2, I2C_PRIORITY_HIGH); break;
+			default: makeJob(jobs[i], DISPLAY_ADDRESS, 1 + rand() % PAGE_BYTES, 0, I2C_PRIORITY_LOW); break;
+		}
+		if (jobs[i].transaction.txLen == 0 && jobs[i].transaction.rxLen == 0)
+			jobs[i].transaction.rxLen = 1;
+	}
+	makeJob(jobs[BATCH / 2], ABSENT_ADDRESS, 1, 2, I2C_PRIORITY_HIGH);
+
+	completed.clear();
+	hostI2CLog().clear();
+	hostI2CSetLogging(true);
+	for (int i = 0; i <= BATCH; i++) {
+		jobs[i].transaction.callback = recordCompletion;
+		jobs[i].transaction.userData = (void *)(intptr_t)i;
+		CHECK(bus->submit(&jobs[i].transaction));
+	}
+	for (Job & job : jobs)
+		runUntilDone(&job.transaction);
+	hostI2CSetLogging(false);
+
+	std::vector<int> order = expectedOrder(jobs, 1, 0);
+	order.insert(order.begin(), 0);
+	CHECK(completed == order);
+
+	// every transaction whole and in that order on the wire: its write, then its read behind a repeated start
+	const std::vector<HostI2CTransfer> & log = hostI2CLog();
+	size_t entry = 0;
+	uint32_t mismatches = 0;
+	for (int i : order) {
+		const PeripheralI2CTransaction & transaction = jobs[i].transaction;
+		if (transaction.address == ABSENT_ADDRESS) {
+			mismatches += !(entry < log.size() && log[entry].nak && log[entry].address == ABSENT_ADDRESS);
+			CHECK(transaction.result < 0);
+			CHECK(transaction.status == I2C_TRANSACTION_ERROR);
+			entry++;
+			continue;
+		}
+		if (transaction.txLen > 0) {
+			bool match = entry < log.size() && !log[entry].read && log[entry].address == transaction.address &&
+				std::equal(log[entry].data.begin(), log[entry].data.end(), transaction.tx, transaction.tx + transaction.txLen) &&
+				log[entry].data.size() == transaction.txLen;
+			mismatches += !match;
+			entry++;
+		}
+		if (transaction.rxLen > 0) {
+			bool match = entry < log.size() && log[entry].read && log[entry].address == transaction.address &&
+				std::equal(log[entry].data.begin(), log[entry].data.end(), transaction.rx, transaction.rx + transaction.rxLen) &&
+				log[entry].data.size() == transaction.rxLen;
+			mismatches += !match;
+			entry++;
+		}
+		CHECK_EQ(transaction.result, transaction.rxLen > 0 ? transaction.rxLen : transaction.txLen);
+	}
+	CHECK_EQ(entry, log.size());
+	CHECK_EQ(mismatches, 0);
+	printf("%d queued transactions behind a page, %zu address phases on the wire, %u out of place\n",
+		BATCH, log.size(), mismatches);
+}
+
+// Keeps its job on the bus for as long as it runs: every completion submits it again
+struct Flood {
+	PeripheralI2C * bus;
+	Job job;
+	bool running;
+	uint64_t completions;
+};
+
+static void floodCompletion(PeripheralI2CTransaction * transaction) {
+	Flood * flood = (Flood *)transaction->userData;
+	flood->completions++;
+	if (flood->running)
+		flood->bus->submit(transaction);
+}
+
+static void startFlood(Flood & flood, PeripheralI2C * bus, uint8_t address, uint16_t txLen, uint16_t rxLen,
+	PeripheralI2CPriority priority) {
+	flood.bus = bus;
+	flood.running = true;
+	flood.completions = 0;
+	makeJob(flood.job, address, txLen, rxLen, priority);
+	flood.job.transaction.callback = floodCompletion;
+	flood.job.transaction.userData = &flood;
+	bus->submit(&flood.job.transaction);
+}
+
+static void stopFlood(Flood & flood) {
+	flood.running = false;
+	runUntilDone(&flood.job.transaction);
+}
+
+struct FairnessResult {
+	uint64_t polls;
+	uint64_t pollAvgUs;
+	uint64_t pollMaxUs;
+	double pagesPerSec;
+	double highPerSec;
+	uint32_t longestHighRun;
+};
+
+// A display flushing pages back to back against a nunchuk poll, optionally with an expander flooding the bus
+static FairnessResult runFairness(PeripheralI2C * bus, bool saturate) {
+	FairnessResult result = {};
+	Flood display;
+	Flood expander;
+	hostI2CLog().clear();
+	hostI2CSetLogging(true);
+	startFlood(display, bus, DISPLAY_ADDRESS, PAGE_BYTES, 0, I2C_PRIORITY_LOW);
+	if (saturate)
+		startFlood(expander, bus, EXPANDER_ADDRESS, 1, 2, I2C_PRIORITY_HIGH);
+
+	Job poll;
+	makeJob(poll, NUNCHUK_ADDRESS, 1, 6, I2C_PRIORITY_HIGH);
+	uint64_t latencyTotalUs = 0;
+	uint64_t startUs = hostTimeNs() / 1000;
+	uint64_t nextPollUs = startUs;
+	bool polling = false;
+	while (hostTimeNs() / 1000 - startUs < RUN_US) {
+		uint64_t us = hostTimeNs() / 1000;
+		if (polling && poll.transaction.isDone()) {
+			polling = false;
+			CHECK_EQ(poll.transaction.result, 6);
+			uint64_t latencyUs = us - poll.submitNs / 1000;
+			latencyTotalUs += latencyUs;
+			result.pollMaxUs = std::max(result.pollMaxUs, latencyUs);
+			result.polls++;
+		}
+		if (!polling && us >= nextPollUs) {
+			poll.submitNs = hostTimeNs();
+			CHECK(bus->submit(&poll.transaction));
+			polling = true;
+			nextPollUs = us + POLL_US + rand() % 3000;
+		}
+		hostTimeAdvanceUs(LOOP_US);
+	}
+	if (polling)
+		runUntilDone(&poll.transaction);
+	stopFlood(display);
+	if (saturate)
+		stopFlood(expander);
+	hostI2CSetLogging(false);
+
+	// high priority address phases between two display pages, a write+read pair counts once
+	uint32_t run = 0;
+	for (const HostI2CTransfer & transfer : hostI2CLog()) {
+		if (transfer.address == DISPLAY_ADDRESS) {
+			result.longestHighRun = std::max(result.longestHighRun, run);
+			run = 0;
+		} else if (!transfer.read || transfer.address == NUNCHUK_ADDRESS) {
+			run += !transfer.read;
+		}
+	}
+	double seconds = RUN_US / 1e6;
+	result.pollAvgUs = result.polls ? latencyTotalUs / result.polls : 0;
+	result.pagesPerSec = display.completions / seconds;
+	result.highPerSec = (result.polls + (saturate ? expander.completions : 0)) / seconds;
+	return result;
+}
+
+int main() {
+	srand(14);
+	hostTimeSetManual(true);
+	Storage::getInstance().init();
+
+	PeripheralOptions_I2COptions & i2cOptions = Storage::getInstance().getPeripheralOptions().blockI2C0;
+	i2cOptions.enabled = true;
+	i2cOptions.sda = 0;
+	i2cOptions.scl = 1;
+	i2cOptions.speed = I2C_SPEED;
+	PeripheralManager::getInstance().initI2C();
+	PeripheralI2C * bus = PeripheralManager::getInstance().getI2C(0);
+	CHECK(PeripheralManager::getInstance().isI2CEnabled(0));
+	bus->setPriority(DISPLAY_ADDRESS, I2C_PRIORITY_LOW);
+
+	MockDevice nunchuk(NUNCHUK_ADDRESS);
+	MockDevice expander(EXPANDER_ADDRESS);
+	MockDevice display(DISPLAY_ADDRESS);
+	hostI2CAttach(i2c0, NUNCHUK_ADDRESS, &nunchuk);
+	hostI2CAttach(i2c0, EXPANDER_ADDRESS, &expander);
+	hostI2CAttach(i2c0, DISPLAY_ADDRESS, &display);
+
+	runOrdering(bus);
+
+	// A byte is 9 clocks; the page in flight plus the poll's own write and read, each with its address
+	double byteUs = 9e6 / I2C_SPEED;
+	double pageUs = (PAGE_BYTES + 1) * byteUs;
+	double pollUs = (1 + 1 + 1 + 6) * byteUs;
+	uint64_t boundUs = pageUs + pollUs + 2 * LOOP_US;
+
+	printf("%dkHz bus, %d byte pages back to back, nunchuk polled every %d to %dus, %d high priority in a row\n",
+		I2C_SPEED / 1000, PAGE_BYTES, POLL_US, POLL_US + 3000, I2C_HIGH_PRIORITY_BURST);
+	printf("  %-18s %7s %10s %10s %9s %9s %9s\n", "traffic", "polls", "poll avg", "poll max", "pages/s", "input/s",
+		"high run");
+	for (bool saturate : { false, true }) {
+		FairnessResult result = runFairness(bus, saturate);
+		printf("  %-18s %7llu %8lluus %8lluus %9.0f %9.0f %9u\n", saturate ? "+ expander flood" : "display + nunchuk",
+			(unsigned long long)result.polls, (unsigned long long)result.pollAvgUs,
+			(unsigned long long)result.pollMaxUs, result.pagesPerSec, result.highPerSec, result.longestHighRun);
+
+		CHECK(result.polls > 0);
+		if (!saturate) {
+			// a poll never waits for more than the page already on the wire, on average half of it
+			CHECK(result.pollMaxUs <= boundUs);
+			CHECK(result.pollAvgUs < pageUs * 0.7 + pollUs);
+			// and the display still gets the rest of the bus
+			CHECK(result.pagesPerSec > 0.9 * (1e6 - result.polls * pollUs) / pageUs);
+		} else {
+			// the display gets a page in after every burst however busy the inputs keep the bus
+			CHECK(result.longestHighRun <= I2C_HIGH_PRIORITY_BURST);
+			CHECK(result.pagesPerSec > 0.8 * 1e6 / (pageUs + I2C_HIGH_PRIORITY_BURST * (pollUs + byteUs)));
+		}
+	}
+
+	return hostTestResult("test_i2c_queue");
+}
@@ -0,0 +1,183 @@
+/*
+ * SPDX-License-Identifier: MIT
+ * SPDX-FileCopyrightText: Copyright (c) 2024 OpenStickCommunity (gp2040-ce.info)
+ */
+
+// LED brightness: the lookup tables and 8.8 fixed point scales RGB and AnimationStation pack with now,
+// against the float multiply RGB::value used to do. Every channel value goes through every brightness
+// AnimationStation can be set to (each maximum, step count and step, for the main and linkage levels),
+// the float value() overload, and the player LED level blend, in every LED format. Each channel has to
+// stay within 1 of the float result. A 100 pixel frame is then packed both ways and timed; on the host
+// the float path has an FPU, so it says nothing about the RP2040.
+
+#include <stdlib.h>
+#include <algorithm>
+
+#include "hosttest.h"
+#include "hostsim.h"
+
+#include "animationstation.h"
+#include "playerleds.h"
+#include "storagemanager.h"
+
+#define FRAME_PIXELS 100
+#define BENCH_FRAMES 20000
+#define PLED_LEVEL_STEP 257
+
+static const LEDFormat formats[] = { LED_FORMAT_GRB, LED_FORMAT_RGB, LED_FORMAT_GRBW, LED_FORMAT_RGBW };
+static const char * formatNames[] = { "GRB", "RGB", "GRBW", "RGBW" };
+
+// RGB::value as it was, a float multiply per channel
+static uint32_t referenceValue(const RGB & color, LEDFormat format, float brightnessX) {
+	switch (format) {
+		case LED_FORMAT_GRB:
+			return ((uint32_t)(color.g * brightnessX) << 16) | ((uint32_t)(color.r * brightnessX) << 8)
+				| (uint32_t)(color.b * brightnessX);
+		case LED_FORMAT_RGB:
+			return ((uint32_t)(color.r * brightnessX) << 16) | ((uint32_t)(color.g * brightnessX) << 8)
+				| (uint32_t)(color.b * brightnessX);
+		case LED_FORMAT_GRBW:
+			if ((color.r == color.g) && (color.r == color.b))
+				return (uint32_t)(color.r * brightnessX);
+			return ((uint32_t)(color.g * brightnessX) << 24) | ((uint32_t)(color.r * brightnessX) << 16)
+				| ((uint32_t)(color.b * brightnessX) << 8) | (uint32_t)(color.w * brightnessX);
+		case LED_FORMAT_RGBW:
+			if ((color.r == color.g) && (color.r == color.b))
+				return (uint32_t)(color.r * brightnessX);
+			return ((uint32_t)(color.r * brightnessX) << 24) | ((uint32_t)(color.g * brightnessX) << 16)
+				| ((uint32_t)(color.b * brightnessX) << 8) | (uint32_t)(color.w * brightnessX);
+	}
+	return 0;
+}
+
+// Largest difference between any two channels of packed values, bytes compared one by one
+static uint32_t channelDifference(uint32_t a, uint32_t b) {
+	uint32_t worst = 0;
+	for (int shift = 0; shift < 32; shift += 8)
+		worst = std::max(worst, (uint32_t)abs((int)((a >> shift) & 0xff) - (int)((b >> shift) & 0xff)));
+	return worst;
+}
+
+// Every channel value, as a grey (the white shortcut) and in colors where each channel differs
+static RGB testColor(uint32_t c, int kind) {
+	switch (kind) {
+		case 0: return RGB(c, c, c, c);
+		case 1: return RGB(c, 255 - c, c / 2, c ^ 0x55);
+		default: return RGB(255 - c, c ^ 0xaa, c, (c * 7) & 0xff);
+	}
+}
+
+struct Comparison {
+	uint64_t compared = 0;
+	uint32_t worst = 0;
+
+	void check(uint32_t value, uint32_t reference) {
+		worst = std::max(worst, channelDifference(value, reference));
+		compared++;
+	}
+};
+
+int main() {
+	Storage::getInstance().init();
+
+	Comparison tables;
+	Comparison floats;
+	Comparison linkage;
+	Comparison pled;
+	uint32_t configs = 0;
+	AnimationStation as;
+	const uint8_t maximums[] = { 5, 25, 50, 100, 128, 200, 254, 255 };
+	for (uint8_t maximum : maximums)
+	for (uint8_t steps = 1; steps <= 10; steps++) {
+		as.ConfigureBrightness(maximum, steps);
+		for (uint8_t step = 0; step <= steps; step++) {
+			as.SetBrightness(step);
+			configs++;
+			// The float levels SetBrightness used to keep
+			float brightnessX = std::min((step * (maximum / steps)) / 255.0F, 1.0F);
+			float linkageX = std::min((step * (255 / steps)) / 255.0F, 1.0F);
+
+			// ApplyBrightness packs through the table for this level
+			BrightnessTable table;
+			table.setup(std::min(step * (maximum / steps), 255));
+			uint16_t scale = as.GetBrightnessScale();
+			const BrightnessTable & linkageTable = as.GetLinkageBrightnessTable();
+
+			for (int f = 0; f < 4; f++)
+			for (int kind = 0; kind < 3; kind++)
+			for (uint32_t c = 0; c < 256; c++) {
+				RGB color = testColor(c, kind);
+				tables.check(color.value(formats[f], table), referenceValue(color, formats[f], brightnessX));
+				floats.check(color.value(formats[f], brightnessX), referenceValue(color, formats[f], brightnessX));
+				linkage.check(color.value(formats[f], linkageTable), referenceValue(color, formats[f], linkageX));
+			}
+
+			// Player LED level blend, sampled over the PWM range
+			for (uint32_t ledLevel = 0; ledLevel <= PLED_MAX_LEVEL; ledLevel += PLED_LEVEL_STEP) {
+				uint32_t level = PLED_MAX_LEVEL - ledLevel;
+				uint16_t pledScale = (scale * level + PLED_MAX_LEVEL / 2) / PLED_MAX_LEVEL;
+				float pledX = brightnessX * (static_cast<float>(level) / static_cast<float>(PLED_MAX_LEVEL));
+				for (int f = 0; f < 4; f++)
+				for (uint32_t c = 0; c < 256; c += 5) {
+					RGB color = testColor(c, 1);
+					pled.check(color.scaledValue(formats[f], pledScale), referenceValue(color, formats[f], pledX));
+				}
+			}
+		}
+	}
+
+	printf("%u brightness settings\n", configs);
+	printf("  %-22s %12s %10s\n", "path", "compared", "worst");
+	printf("  %-22s %12llu %10u\n", "brightness table", (unsigned long long)tables.compared, tables.worst);
+	printf("  %-22s %12llu %10u\n", "float value() overload", (unsigned long long)floats.compared, floats.worst);
+	printf("  %-22s %12llu %10u\n", "linkage table", (unsigned long long)linkage.compared, linkage.worst);
+	printf("  %-22s %12llu %10u\n", "player LED blend", (unsigned long long)pled.compared, pled.worst);
+	CHECK(tables.worst <= 1);
+	CHECK(floats.worst <= 1);
+	CHECK(linkage.worst <= 1);
+	CHECK(pled.worst <= 1);
+
+	// Full brightness and off are exact
+	BrightnessTable full;
+	BrightnessTable off;
+	full.setup(255);
+	off.setup(0);
+	for (uint32_t c = 0; c < 256; c++) {
+		CHECK_EQ(full.level[c], c);
+		CHECK_EQ(off.level[c], 0);
+	}
+
+	// One frame packed both ways, as ApplyBrightness does
+	RGB frame[FRAME_PIXELS];
+	uint32_t frameValue[FRAME_PIXELS];
+	for (int i = 0; i < FRAME_PIXELS; i++)
+		frame[i] = testColor(rand() & 0xff, i % 3);
+	BrightnessTable table;
+	table.setup(153);
+	volatile float brightnessX = 153 / 255.0F;
+	printf("  %-6s %14s %14s\n", "format", "float ns/frame", "table ns/frame");
+	for (int f = 0; f < 4; f++) {
+		uint64_t start = hostClockNs();
+		uint32_t floatSum = 0;
+		for (int n = 0; n < BENCH_FRAMES; n++) {
+			for (int i = 0; i < FRAME_PIXELS; i++)
+				frameValue[i] = referenceValue(frame[i], formats[f], brightnessX);
+			floatSum += frameValue[n % FRAME_PIXELS];
+		}
+		uint64_t floatNs = hostClockNs() - start;
+
+		start = hostClockNs();
+		uint32_t tableSum = 0;
+		for (int n = 0; n < BENCH_FRAMES; n++) {
+			for (int i = 0; i < FRAME_PIXELS; i++)
+				frameValue[i] = frame[i].value(formats[f], table);
+			tableSum += frameValue[n % FRAME_PIXELS];
+		}
+		uint64_t tableNs = hostClockNs() - start;
+
+		printf("  %-6s %14.1f %14.1f\n", formatNames[f], (double)floatNs / BENCH_FRAMES, (double)tableNs / BENCH_FRAMES);
+		CHECK(floatSum != 0 && tableSum != 0);
+	}
+
+	return hostTestResult("test_led_brightness");
+}
@@ -0,0 +1,297 @@
+/*
+ * SPDX-License-Identifier: MIT
+ * SPDX-FileCopyrightText: Copyright (c) 2024 OpenStickCommunity (gp2040-ce.info)
+ */
+
+// LED frame path: the pressed pixel tracking NeoPicoLEDAddon::process used to do (every matrix pixel copied
+// into a fresh list, the list copied again into AnimationStation and both effects, each effect pixel looked
+// up in it) against the button bitmask it does now. Random button states run through both; a pressed effect
+// has to light the same pixels either way, and the bitmask path may not touch the heap. Then process() runs
+// every effect for a few thousand frames, timed and with its heap allocations counted.
+
+#include <stdlib.h>
+#include <new>
+#include <vector>
+
+#include "hosttest.h"
+#include "hostsim.h"
+
+#include "addons/neopicoleds.h"
+#include "animationstation.h"
+#include "effects/staticcolor.h"
+#include "gamepad.h"
+#include "storagemanager.h"
+
+#define LED_PIN 28
+#define LEDS_PER_BUTTON 3
+#define PRESSED_FRAMES 20000
+#define ADDON_FRAMES 3000
+#define FRAME_US 10000
+
+static uint64_t allocations = 0;
+
+// Called through a pointer, so the compiler does not pair malloc with the library's sized delete
+static void * (* volatile heapAlloc)(size_t) = malloc;
+
+void * operator new(size_t size) {
+	allocations++;
+	void * memory = heapAlloc(size ? size : 1);
+	if (memory == nullptr)
+		throw std::bad_alloc();
+	return memory;
+}
+
+void operator delete(void * memory) noexcept { free(memory); }
+
+// Buttons in stickless order, dpad masks sit above the button masks as in process()
+static const uint32_t ledButtonMasks[] = {
+	GAMEPAD_MASK_LEFT << 16, GAMEPAD_MASK_DOWN << 16, GAMEPAD_MASK_RIGHT << 16, GAMEPAD_MASK_UP << 16,
+	GAMEPAD_MASK_B3, GAMEPAD_MASK_B1, GAMEPAD_MASK_B4, GAMEPAD_MASK_B2,
+	GAMEPAD_MASK_R1, GAMEPAD_MASK_R2, GAMEPAD_MASK_L1, GAMEPAD_MASK_L2,
+	GAMEPAD_MASK_S1, GAMEPAD_MASK_S2, GAMEPAD_MASK_L3, GAMEPAD_MASK_R3,
+	GAMEPAD_MASK_A1, GAMEPAD_MASK_A2,
+};
+#define BUTTONS (sizeof(ledButtonMasks) / sizeof(ledButtonMasks[0]))
+
+// Four buttons per column with gaps, as the generated layouts have
+static PixelMatrix buildMatrix() {
+	std::vector<std::vector<Pixel>> columns;
+	for (size_t button = 0; button < BUTTONS; button++) {
+		if (button % 4 == 0)
+			columns.push_back({});
+		if (button % 7 == 3)
+			columns.back().push_back(NO_PIXEL);
+		std::vector<uint8_t> positions;
+		for (int i = 0; i < LEDS_PER_BUTTON; i++)
+			positions.push_back(button * LEDS_PER_BUTTON + i);
+		columns.back().push_back(Pixel(button, ledButtonMasks[button], positions));
+	}
+	PixelMatrix matrix;
+	matrix.setup(columns, LEDS_PER_BUTTON);
+	return matrix;
+}
+
+// What process() and the effects did with a std::vector<Pixel> per frame
+struct ReferencePressed {
+	std::vector<Pixel> lastPressed;
+	std::vector<Pixel> basePixels;
+	std::vector<Pixel> buttonPixels;
+
+	void process(const PixelMatrix & matrix, uint32_t buttonState) {
+		std::vector<Pixel> pressed;
+		for (auto row : matrix.pixels) {
+			for (auto pixel : row) {
+				if (buttonState & pixel.mask)
+					pressed.push_back(pixel);
+			}
+		}
+		if (pressed.size() > 0)
+			handlePressed(pressed);
+		else
+			clearPressed();
+	}
+
+	void handlePressed(std::vector<Pixel> pressed) {
+		lastPressed = pressed;
+		updatePixels(basePixels, pressed);
+		updatePixels(buttonPixels, pressed);
+	}
+
+	static void updatePixels(std::vector<Pixel> & target, std::vector<Pixel> inpixels) {
+		target = inpixels;
+	}
+
+	void clearPressed() {
+		buttonPixels.clear();
+		basePixels.clear();
+		lastPressed.clear();
+	}
+
+	bool notInFilter(Pixel pixel) const {
+		for (size_t i = 0; i < buttonPixels.size(); i++) {
+			if (pixel == buttonPixels.at(i))
+				return false;
+		}
+		return true;
+	}
+};
+
+// Mostly idle, a few buttons held at a time, never S1 and S2 together so no LED hotkey fires
+static uint32_t nextButtonState(uint32_t state) {
+	int roll = rand() % 100;
+	if (roll < 60)
+		return state;
+	if (roll < 70)
+		return 0;
+	state ^= ledButtonMasks[rand() % BUTTONS];
+	if ((state & GAMEPAD_MASK_S1) && (state & GAMEPAD_MASK_S2))
+		state &= ~GAMEPAD_MASK_S2;
+	return state;
+}
+
+// Pixels the filtered effect lights, one bit per pixel index
+static uint32_t referenceLit(const PixelMatrix & matrix, const ReferencePressed & reference) {
+	uint32_t lit = 0;
+	for (size_t r = 0; r != matrix.pixels.size(); r++) {
+		for (size_t c = 0; c != matrix.pixels[r].size(); c++) {
+			const Pixel & pixel = matrix.pixels[r][c];
+			if (pixel.index != NO_PIXEL.index && !reference.notInFilter(pixel))
+				lit |= 1u << pixel.index;
+		}
+	}
+	return lit;
+}
+
+static uint32_t effectLit(const PixelMatrix & matrix, const Animation & effect) {
+	uint32_t lit = 0;
+	for (size_t r = 0; r != matrix.pixels.size(); r++) {
+		for (size_t c = 0; c != matrix.pixels[r].size(); c++) {
+			const Pixel & pixel = matrix.pixels[r][c];
+			if (pixel.index != NO_PIXEL.index && !effect.notInFilter(pixel))
+				lit |= 1u << pixel.index;
+		}
+	}
+	return lit;
+}
+
+static void comparePressedPaths() {
+	PixelMatrix matrix = buildMatrix();
+	std::vector<uint32_t> states(PRESSED_FRAMES);
+	uint32_t state = 0;
+	for (uint32_t & frameState : states)
+		frameState = state = nextButtonState(state);
+
+	// Same pixels lit for every frame
+	ReferencePressed reference;
+	StaticColor effect(matrix, 0u);
+	uint32_t mismatches = 0;
+	for (uint32_t frameState : states) {
+		reference.process(matrix, frameState);
+		uint32_t pressedMask = matrix.getPressedMask(frameState);
+		if (pressedMask != 0)
+			effect.UpdatePixels(pressedMask);
+		else
+			effect.ClearPixels();
+		if (referenceLit(matrix, reference) != effectLit(matrix, effect))
+			mismatches++;
+	}
+
+	// Then each path on its own, timed, with what it allocates
+	ReferencePressed timedReference;
+	uint64_t referenceAllocations = allocations;
+	uint64_t start = hostClockNs();
+	uint32_t referenceSum = 0;
+	for (uint32_t frameState : states) {
+		timedReference.process(matrix, frameState);
+		referenceSum += referenceLit(matrix, timedReference);
+	}
+	uint64_t referenceNs = hostClockNs() - start;
+	referenceAllocations = allocations - referenceAllocations;
+
+	StaticColor timedEffect(matrix, 0u);
+	uint64_t maskAllocations = allocations;
+	start = hostClockNs();
+	uint32_t maskSum = 0;
+	for (uint32_t frameState : states) {
+		uint32_t pressedMask = matrix.getPressedMask(frameState);
+		if (pressedMask != 0)
+			timedEffect.UpdatePixels(pressedMask);
+		else
+			timedEffect.ClearPixels();
+		maskSum += effectLit(matrix, timedEffect);
+	}
+	uint64_t maskNs = hostClockNs() - start;
+	maskAllocations = allocations - maskAllocations;
+
+	printf("pressed tracking, %u buttons, %u LEDs each, %u frames\n", (unsigned)BUTTONS, LEDS_PER_BUTTON, PRESSED_FRAMES);
+	printf("  %-14s %12s %16s\n", "path", "ns/frame", "allocations/frame");
+	printf("  %-14s %12.1f %16.2f\n", "pixel vectors", (double)referenceNs / PRESSED_FRAMES, (double)referenceAllocations / PRESSED_FRAMES);
+	printf("  %-14s %12.1f %16.2f\n", "button mask", (double)maskNs / PRESSED_FRAMES, (double)maskAllocations / PRESSED_FRAMES);
+
+	CHECK_EQ(mismatches, 0);
+	CHECK_EQ(referenceSum, maskSum);
+	CHECK(referenceAllocations > 0);
+	CHECK_EQ(maskAllocations, 0);
+	CHECK(maskNs < referenceNs);
+}
+
+static void configureLeds(AnimationEffects effect) {
+	LEDOptions & ledOptions = Storage::getInstance().getLedOptions();
+	ledOptions.dataPin = LED_PIN;
+	ledOptions.ledFormat = static_cast<LEDFormat_Proto>(LED_FORMAT_GRB);
+	ledOptions.ledLayout = BUTTON_LAYOUT_STICKLESS;
+	ledOptions.ledsPerButton = LEDS_PER_BUTTON;
+	ledOptions.brightnessMaximum = 255;
+	ledOptions.brightnessSteps = 5;
+	ledOptions.pledType = PLED_TYPE_NONE;
+	ledOptions.caseRGBType = CASE_RGB_TYPE_NONE;
+	int32_t * indexes[] = {
+		&ledOptions.indexLeft, &ledOptions.indexDown, &ledOptions.indexRight, &ledOptions.indexUp,
+		&ledOptions.indexB3, &ledOptions.indexB1, &ledOptions.indexB4, &ledOptions.indexB2,
+		&ledOptions.indexR1, &ledOptions.indexR2, &ledOptions.indexL1, &ledOptions.indexL2,
+		&ledOptions.indexS1, &ledOptions.indexS2, &ledOptions.indexL3, &ledOptions.indexR3,
+		&ledOptions.indexA1, &ledOptions.indexA2,
+	};
+	for (size_t i = 0; i < sizeof(indexes) / sizeof(indexes[0]); i++)
+		*indexes[i] = i;
+
+	AnimationOptions & animationOptions = Storage::getInstance().getAnimationOptions();
+	animationOptions.baseAnimationIndex = effect;
+	animationOptions.brightness = 3;
+	animationOptions.hasCustomTheme = true;
+}
+
+static void runAddon() {
+	static const struct {
+		AnimationEffects effect;
+		const char * name;
+	} effects[] = {
+		{ EFFECT_STATIC_COLOR, "static color" },
+		{ EFFECT_RAINBOW, "rainbow" },
+		{ EFFECT_CHASE, "chase" },
+		{ EFFECT_STATIC_THEME, "static theme" },
+		{ EFFECT_CUSTOM_THEME, "custom theme" },
+		{ EFFECT_GRID_GRADIENT, "grid gradient" },
+	};
+
+	printf("NeoPicoLEDAddon::process, %u frames\n", ADDON_FRAMES);
+	printf("  %-14s %12s %16s\n", "effect", "ns/frame", "allocations/frame");
+	Gamepad * processed = Storage::getInstance().GetProcessedGamepad();
+	for (const auto & entry : effects) {
+		hostReset();
+		hostTimeSetManual(true);
+		configureLeds(entry.effect);
+		NeoPicoLEDAddon * addon = new NeoPicoLEDAddon();
+		addon->setup();
+
+		uint32_t state = 0;
+		uint64_t frameAllocations = 0;
+		uint64_t frameNs = 0;
+		for (int frame = 0; frame < ADDON_FRAMES; frame++) {
+			state = nextButtonState(state);
+			processed->state.dpad = state >> 16;
+			processed->state.buttons = state & 0xffff;
+			uint64_t before = allocations;
+			uint64_t start = hostClockNs();
+			addon->process();
+			frameNs += hostClockNs() - start;
+			frameAllocations += allocations - before;
+			hostTimeAdvanceUs(FRAME_US);
+		}
+		printf("  %-14s %12.1f %16.2f\n", entry.name, (double)frameNs / ADDON_FRAMES, (double)frameAllocations / ADDON_FRAMES);
+		CHECK_EQ(frameAllocations, 0);
+		CHECK_EQ(Storage::getInstance().getAnimationOptions().baseAnimationIndex, entry.effect);
+	}
+}
+
+int main() {
+	hostTimeSetManual(true);
+	Storage::getInstance().init();
+	Storage::getInstance().SetGamepad(new Gamepad());
+	Storage::getInstance().SetProcessedGamepad(new Gamepad());
+
+	comparePressedPaths();
+	runAddon();
+
+	return hostTestResult("test_led_frame_path");
+}
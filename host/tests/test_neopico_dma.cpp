@@ -0,0 +1,219 @@
+/*
+ * SPDX-License-Identifier: MIT
+ * SPDX-FileCopyrightText: Copyright (c) 2024 OpenStickCommunity (gp2040-ce.info)
+ */
+
+// NeoPico: a WS2812 strip model stands in for the state machine. It shifts each word out at 1.25us per bit
+// behind the 8 word joined TX FIFO, and latches what it received once the line has been low for the reset
+// time. A low gap that is neither zero nor a full reset would run two frames together or cut one short, so
+// there must be none. Frames are shown every 10ms as NeoPicoLEDAddon does, then as fast as the loop can go.
+// Every frame latched must be a whole frame from a single Show(), in order, ending with the last one shown,
+// and Show() must return without waiting on the strip. The old pio_sm_put_blocking loop is timed on the
+// same model for comparison.
+
+#include <algorithm>
+#include <vector>
+
+#include "hosttest.h"
+#include "hostsim.h"
+
+#include "NeoPico.h"
+
+#define LED_PIN 28
+#define BIT_NS 1250
+#define FIFO_WORDS 8
+#define ADDON_TICK_US 10000     // NeoPicoLEDAddon::intervalMS
+#define FAST_TICK_US 100
+#define RUN_US 1000000
+#define REFERENCE_FRAMES 20
+
+class StripModel : public HostPIODevice {
+public:
+	struct Frame {
+		std::vector<uint32_t> words;
+		uint64_t latchNs;
+	};
+
+	StripModel(uint bits) : bits(bits) {}
+
+	void put(uint32_t data) override {
+		uint64_t now = hostTimeNs();
+		uint64_t start = std::max(now, lineFreeNs);
+		if (!current.empty() && start > lineFreeNs) {
+			if (start - lineFreeNs >= resetNs())
+				latch();
+			else
+				shortGaps++;
+		}
+		current.push_back(bits == 32 ? data : data >> 8);
+		lineFreeNs = start + bits * BIT_NS;
+	}
+
+	// Time until the FIFO has room again, the shift register holds one word on top of it
+	uint32_t wordNs() override {
+		uint64_t now = hostTimeNs();
+		uint64_t queuedNs = lineFreeNs > now ? lineFreeNs - now : 0;
+		uint64_t fullNs = (uint64_t)FIFO_WORDS * bits * BIT_NS;
+		return queuedNs > fullNs ? (uint32_t)(queuedNs - fullNs) : 0;
+	}
+
+	// Latch a frame that has been followed by a full reset time
+	void settle() {
+		if (!current.empty() && hostTimeNs() >= lineFreeNs + resetNs())
+			latch();
+	}
+
+	uint64_t resetNs() const { return NEO_PICO_RESET_US * 1000ull; }
+
+	std::vector<Frame> frames;
+	uint32_t shortGaps = 0;
+
+private:
+	void latch() {
+		frames.push_back({ current, lineFreeNs + resetNs() });
+		current.clear();
+	}
+
+	uint bits;
+	uint64_t lineFreeNs = 0;
+	std::vector<uint32_t> current;
+};
+
+// Pixel values carry the frame number so a latched frame can be traced back to its Show()
+static uint32_t pixelValue(uint32_t frame, int pixel, bool rgbw) {
+	uint32_t value = (frame << 8) | (uint32_t)pixel;
+	return rgbw ? value : value & 0xffffff;
+}
+
+struct RunResult {
+	uint32_t shown;
+	uint32_t latched;
+	uint32_t torn;              // frames of the wrong length, or mixing pixels of several frames
+	uint32_t outOfOrder;
+	uint32_t shortGaps;
+	bool lastShownLatched;
+	uint64_t showBlockedNs;     // simulated time spent inside Show()
+	uint64_t showHostNs;        // host time spent inside Show()
+	double framesPerSecond;     // latched frames over the run
+};
+
+static RunResult runShow(int leds, LEDFormat format, uint32_t tickUs) {
+	bool rgbw = (format == LED_FORMAT_GRBW) || (format == LED_FORMAT_RGBW);
+	hostReset();
+	hostTimeSetManual(true);
+	StripModel strip(rgbw ? 32 : 24);
+	hostPIOAttach(pio1, 0, &strip);
+	NeoPico neopico;
+	neopico.Setup(LED_PIN, leds, format, pio1, 0);
+	neopico.Wait();
+	hostTimeAdvanceUs(NEO_PICO_RESET_US);
+	strip.settle();
+	strip.frames.clear();
+
+	RunResult result = {};
+	uint32_t frame[NEO_PICO_MAX_PIXELS];
+	uint64_t startNs = hostTimeNs();
+	while (hostTimeNs() - startNs < RUN_US * 1000ull) {
+		result.shown++;
+		for (int i = 0; i < leds; i++)
+			frame[i] = pixelValue(result.shown, i, rgbw);
+		neopico.SetFrame(frame);
+		uint64_t simNs = hostTimeNs();
+		uint64_t hostNs = hostClockNs();
+		neopico.Show();
+		result.showHostNs += hostClockNs() - hostNs;
+		result.showBlockedNs += hostTimeNs() - simNs;
+		hostTimeAdvanceUs(tickUs);
+		strip.settle();
+	}
+	uint64_t endNs = hostTimeNs();
+	neopico.Wait();
+	hostTimeAdvanceUs(NEO_PICO_RESET_US);
+	strip.settle();
+
+	uint32_t previous = 0;
+	for (const StripModel::Frame & latched : strip.frames) {
+		uint32_t number = latched.words[0] >> 8;
+		bool whole = (int)latched.words.size() == leds;
+		for (int i = 0; whole && i < leds; i++)
+			whole = latched.words[i] == pixelValue(number, i, rgbw);
+		if (!whole)
+			result.torn++;
+		if (number <= previous)
+			result.outOfOrder++;
+		previous = number;
+		if (latched.latchNs <= endNs)
+			result.latched++;
+	}
+	result.shortGaps = strip.shortGaps;
+	result.lastShownLatched = previous == result.shown;
+	result.framesPerSecond = result.latched * 1e9 / (endNs - startNs);
+	return result;
+}
+
+// The loop Show() used to run, one pio_sm_put_blocking per pixel, on an idle strip
+static uint64_t referenceShowNs(int leds, bool rgbw) {
+	hostReset();
+	hostTimeSetManual(true);
+	StripModel strip(rgbw ? 32 : 24);
+	hostPIOAttach(pio1, 0, &strip);
+	uint64_t total = 0;
+	for (int n = 0; n < REFERENCE_FRAMES; n++) {
+		uint64_t start = hostTimeNs();
+		for (int i = 0; i < leds; i++) {
+			uint32_t pixel = pixelValue(n, i, rgbw);
+			pio_sm_put_blocking(pio1, 0, rgbw ? pixel : pixel << 8u);
+		}
+		total += hostTimeNs() - start;
+		hostTimeAdvanceUs(leds * (rgbw ? 32 : 24) * BIT_NS / 1000 + NEO_PICO_RESET_US);
+	}
+	return total / REFERENCE_FRAMES;
+}
+
+int main() {
+	static const struct {
+		int leds;
+		LEDFormat format;
+	} strips[] = {
+		{ 16, LED_FORMAT_GRB },
+		{ 64, LED_FORMAT_GRB },
+		{ 100, LED_FORMAT_GRB },
+		{ 100, LED_FORMAT_GRBW },
+	};
+
+	printf("  %4s %5s %6s %14s %12s %14s %11s %11s %11s %13s\n", "leds", "bits", "tick", "blocking show",
+		"dma show", "dma show host", "shown", "latched", "frames/s", "strip limit");
+	for (const auto & config : strips) {
+		bool rgbw = config.format == LED_FORMAT_GRBW;
+		uint32_t bits = rgbw ? 32 : 24;
+		uint64_t blockingNs = referenceShowNs(config.leds, rgbw);
+		// Best the strip can do: every bit back to back, one reset between frames
+		double limit = 1e9 / ((double)config.leds * bits * BIT_NS + NEO_PICO_RESET_US * 1000.0);
+
+		for (uint32_t tickUs : { ADDON_TICK_US, FAST_TICK_US }) {
+			RunResult result = runShow(config.leds, config.format, tickUs);
+			printf("  %4d %5u %4uus %12.1fus %10.2fus %12.0fns %11u %11u %11.1f %13.1f\n", config.leds, bits, tickUs,
+				blockingNs / 1000.0, result.showBlockedNs / 1000.0 / result.shown, (double)result.showHostNs / result.shown,
+				result.shown, result.latched, result.framesPerSecond, limit);
+
+			CHECK(result.latched > 0);
+			CHECK_EQ(result.torn, 0);
+			CHECK_EQ(result.outOfOrder, 0);
+			CHECK_EQ(result.shortGaps, 0);
+			CHECK(result.lastShownLatched);
+			// Show() only converts the frame and starts or queues the transfer
+			CHECK_EQ(result.showBlockedNs, 0);
+			if (tickUs == ADDON_TICK_US) {
+				// Every addon frame makes it to the strip
+				CHECK(result.latched + 1 >= result.shown);
+			} else {
+				// Frames go out back to back, apart from the FIFO drain margin the latch alarm allows for
+				CHECK(result.framesPerSecond >= limit * 0.9);
+			}
+		}
+		// The old loop held the caller for the whole frame but the last FIFO load
+		CHECK(blockingNs >= (uint64_t)(config.leds - FIFO_WORDS - 1) * bits * BIT_NS);
+	}
+
+	return hostTestResult("test_neopico_dma");
+}
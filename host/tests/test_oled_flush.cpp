@@ -0,0 +1,393 @@
+/*
+ * SPDX-License-Identifier: MIT
+ * SPDX-FileCopyrightText: Copyright (c) 2024 OpenStickCommunity (gp2040-ce.info)
+ */
+
+// OLED flush: a model of an SSD1306 (and of an SH1106) panel sits on the simulated I2C bus, parses the
+// control bytes, addressing commands and RAM writes, and answers the status and read-modify-write reads
+// of the detection probe. ButtonLayoutScreen renders every 8ms while buttons are pressed at random; after
+// every render the panel RAM has to show exactly what the framebuffer holds. The test reports the bytes
+// and bus time each render costs for typical updates against resending the whole frame. A render the panel
+// NAKs has to be made good by the next one.
+
+#include <stdlib.h>
+#include <algorithm>
+
+#include "hosttest.h"
+#include "hostsim.h"
+
+#include "GPGFX.h"
+#include "GPGFX_UI.h"
+#include "tiny_ssd1306.h"
+#include "ButtonLayoutScreen.h"
+#include "gamepad.h"
+#include "peripheralmanager.h"
+#include "storagemanager.h"
+
+#define DISPLAY_ADDRESS 0x3C
+#define I2C_SPEED 400000
+#define RENDER_US 8000          // renderIntervalUs of the display addon
+#define FRAMES 400
+#define FULL_FRAMES 25         // the whole frame costs the same every time
+#define PANEL_COLUMNS 132
+#define PANEL_PAGES 8
+
+class PanelModel : public HostI2CDevice {
+public:
+	explicit PanelModel(bool sh1106) : sh1106(sh1106) {}
+
+	bool start(bool read) override {
+		if (!read && nakWrites)
+			return false;
+		expectControl = !read;
+		dummyRead = true;
+		return true;
+	}
+
+	void write(uint8_t data) override {
+		if (expectControl) {
+			continuation = !(data & 0x80);
+			dataMode = data & 0x40;
+			expectControl = false;
+			return;
+		}
+		if (dataMode) {
+			writeRam(data);
+		} else {
+			command(data);
+		}
+		// a control byte with Co set covers only the byte behind it
+		if (!continuation)
+			expectControl = true;
+	}
+
+	uint8_t read() override {
+		// the SSD1306 only ever returns its status, the SH1106 reads RAM behind a dummy byte in data mode
+		if (!sh1106 || !dataMode)
+			return (displayOn ? 0x00 : 0x40) | (sh1106 ? 0x00 : 0x03);
+		if (dummyRead) {
+			dummyRead = false;
+			return 0;
+		}
+		uint8_t value = ram[page][column];
+		if (!readModifyWrite)
+			advance();
+		return value;
+	}
+
+	uint8_t pixelByte(uint8_t x, uint8_t p) const { return ram[p][x]; }
+	bool isOn() const { return displayOn; }
+	// Drop off the bus for writes, as a panel with a loose connector would
+	void setNakWrites(bool nak) { nakWrites = nak; }
+
+private:
+	void command(uint8_t data) {
+		if (argsLeft > 0) {
+			args[argCount++] = data;
+			if (--argsLeft == 0)
+				commandDone();
+			return;
+		}
+		op = data;
+		argCount = 0;
+		switch (data) {
+			case 0x20: case 0x81: case 0x8D: case 0xA8: case 0xD3: case 0xD5: case 0xD9: case 0xDA: case 0xDB:
+				argsLeft = sh1106 && (data == 0x20 || data == 0x8D) ? 0 : 1;
+				break;
+			case 0x21: case 0x22:
+				argsLeft = sh1106 ? 0 : 2;
+				break;
+			default:
+				argsLeft = 0;
+				break;
+		}
+		if (argsLeft == 0)
+			commandDone();
+	}
+
+	void commandDone() {
+		if (op <= 0x0F) {
+			column = (column & 0xF0) | op;
+		} else if (op <= 0x1F) {
+			column = (column & 0x0F) | ((op & 0x0F) << 4);
+		} else if (op == 0x20 && !sh1106) {
+			horizontal = (args[0] & 0x03) == 0;
+		} else if (op == 0x21 && !sh1106) {
+			columnStart = args[0] & 0x7F;
+			columnEnd = args[1] & 0x7F;
+			column = columnStart;
+		} else if (op == 0x22 && !sh1106) {
+			pageStart = args[0] & 0x07;
+			pageEnd = args[1] & 0x07;
+			page = pageStart;
+		} else if (op == 0xAE || op == 0xAF) {
+			displayOn = op == 0xAF;
+		} else if (op >= 0xB0 && op <= 0xB7) {
+			page = op & 0x07;
+		} else if (op == 0xE0 && sh1106) {
+			readModifyWrite = true;
+			modifyColumn = column;
+		} else if (op == 0xEE && sh1106) {
+			readModifyWrite = false;
+			column = modifyColumn;
+		}
+	}
+
+	void writeRam(uint8_t data) {
+		if (column < PANEL_COLUMNS)
+			ram[page][column] = data;
+		advance();
+	}
+
+	void advance() {
+		if (sh1106 || !horizontal) {
+			if (column < (sh1106 ? PANEL_COLUMNS - 1 : 127))
+				column++;
+			return;
+		}
+		if (column < columnEnd) {
+			column++;
+			return;
+		}
+		column = columnStart;
+		page = (page < pageEnd) ? page + 1 : pageStart;
+	}
+
+	bool sh1106;
+	bool nakWrites = false;
+	uint8_t ram[PANEL_PAGES][PANEL_COLUMNS] = {};
+	bool expectControl = true;
+	bool continuation = false;
+	bool dataMode = false;
+	bool dummyRead = true;
+	bool displayOn = false;
+	bool horizontal = false;
+	bool readModifyWrite = false;
+	uint8_t op = 0;
+	uint8_t args[2] = {};
+	uint8_t argCount = 0;
+	uint8_t argsLeft = 0;
+	uint8_t column = 0;
+	uint8_t modifyColumn = 0;
+	uint8_t page = 0;
+	uint8_t columnStart = 0;
+	uint8_t columnEnd = 127;
+	uint8_t pageStart = 0;
+	uint8_t pageEnd = 7;
+};
+
+// Pixels of the panel that differ from the framebuffer; the SH1106 shows RAM column 2 as x = 0
+static uint32_t panelMismatches(PanelModel & panel, GPGFX * gfx, bool sh1106) {
+	uint8_t offset = sh1106 ? 2 : 0;
+	uint32_t mismatches = 0;
+	for (uint8_t y = 0; y < 64; y++) {
+		for (uint8_t x = 0; x + offset < 128; x++) {
+			bool lit = (panel.pixelByte(x + offset, y / 8) >> (y % 8)) & 1;
+			if (lit != (gfx->getPixel(x, y) != 0))
+				mismatches++;
+		}
+	}
+	return mismatches;
+}
+
+enum Traffic {
+	TRAFFIC_IDLE,           // nothing pressed
+	TRAFFIC_ONE_BUTTON,     // one button toggled every render
+	TRAFFIC_RANDOM,         // a few buttons and the d-pad change every few renders
+	TRAFFIC_FULL_FRAME,     // the panel is forgotten before every render, the old cost of a frame
+	TRAFFIC_COUNT
+};
+
+static const char * trafficNames[TRAFFIC_COUNT] = { "idle", "one button", "random presses", "full frame" };
+
+struct FlushResult {
+	uint64_t frames;
+	uint64_t bytes;
+	uint64_t transfers;
+	uint64_t busNs;
+	uint64_t worstBytes;
+	uint64_t mismatchedFrames;
+};
+
+// A button shows filled when the processed state has it and one of its pins reads low
+static void setInput(uint8_t dpad, uint32_t buttons) {
+	Gamepad * gamepad = Storage::getInstance().GetGamepad();
+	const GamepadButtonMapping * dpadMaps[] = { gamepad->mapDpadUp, gamepad->mapDpadDown, gamepad->mapDpadLeft,
+		gamepad->mapDpadRight };
+	const GamepadButtonMapping * buttonMaps[] = { gamepad->mapButtonB1, gamepad->mapButtonB2, gamepad->mapButtonB3,
+		gamepad->mapButtonB4, gamepad->mapButtonL1, gamepad->mapButtonR1, gamepad->mapButtonL2, gamepad->mapButtonR2 };
+	uint32_t levels = 0xffffffff;
+	for (const GamepadButtonMapping * map : dpadMaps) {
+		if (dpad & map->buttonMask)
+			levels &= ~map->pinMask;
+	}
+	for (const GamepadButtonMapping * map : buttonMaps) {
+		if (buttons & map->buttonMask)
+			levels &= ~map->pinMask;
+	}
+	hostGpioSetInputs(levels);
+	Gamepad * processed = Storage::getInstance().GetProcessedGamepad();
+	processed->state.dpad = dpad;
+	processed->state.buttons = buttons;
+}
+
+static void randomInput() {
+	static const uint8_t dpads[] = { 0, GAMEPAD_MASK_UP, GAMEPAD_MASK_DOWN, GAMEPAD_MASK_LEFT, GAMEPAD_MASK_RIGHT,
+		GAMEPAD_MASK_UP | GAMEPAD_MASK_LEFT, GAMEPAD_MASK_DOWN | GAMEPAD_MASK_RIGHT };
+	setInput(dpads[rand() % 7], rand() & (GAMEPAD_MASK_B1 | GAMEPAD_MASK_B2 | GAMEPAD_MASK_B3 | GAMEPAD_MASK_B4 |
+		GAMEPAD_MASK_L1 | GAMEPAD_MASK_R1 | GAMEPAD_MASK_L2 | GAMEPAD_MASK_R2));
+}
+
+static FlushResult runFlush(GPScreen * screen, GPGFX * gfx, PanelModel & panel, bool sh1106, Traffic traffic,
+	uint8_t pageLimit) {
+	GPGFX_TinySSD1306 * driver = static_cast<GPGFX_TinySSD1306 *>(gfx->getDriver());
+	FlushResult result = {};
+	uint32_t sinceChange = 0;
+	int frames = (traffic == TRAFFIC_FULL_FRAME) ? FULL_FRAMES : FRAMES;
+	for (int frame = 0; frame < frames; frame++) {
+		if (traffic == TRAFFIC_ONE_BUTTON) {
+			setInput(0, (frame & 1) ? GAMEPAD_MASK_B1 : 0);
+			sinceChange = 0;
+		} else if (traffic == TRAFFIC_RANDOM && (rand() % 4) == 0) {
+			randomInput();
+			sinceChange = 0;
+		} else if (traffic == TRAFFIC_FULL_FRAME) {
+			driver->invalidate();
+		}
+
+		hostI2CLog().clear();
+		screen->update();
+		screen->draw(pageLimit);
+		uint64_t bytes = 0;
+		for (const HostI2CTransfer & transfer : hostI2CLog()) {
+			if (transfer.address != DISPLAY_ADDRESS)
+				continue;
+			// the address byte goes on the wire too
+			bytes += transfer.data.size() + 1;
+			result.busNs += transfer.endNs - transfer.startNs;
+			result.transfers++;
+		}
+		result.bytes += bytes;
+		result.worstBytes = std::max(result.worstBytes, bytes);
+		result.frames++;
+
+		// with a page budget a change may take a few renders to reach every page
+		uint32_t catchUp = pageLimit ? (PANEL_PAGES + pageLimit - 1) / pageLimit : 1;
+		if (++sinceChange >= catchUp && panelMismatches(panel, gfx, sh1106) != 0)
+			result.mismatchedFrames++;
+		hostTimeAdvanceUs(RENDER_US);
+	}
+	setInput(0, 0);
+	return result;
+}
+
+static void runPanel(bool sh1106) {
+	PanelModel panel(sh1106);
+	hostI2CAttach(i2c0, DISPLAY_ADDRESS, &panel);
+
+	GPGFX * gfx = new GPGFX();
+	GPGFX_DisplayTypeOptions options = gfx->getAvailableDisplay(GPGFX_DisplayType::DISPLAY_TYPE_NONE);
+	CHECK_EQ(options.displayType, GPGFX_DisplayType::DISPLAY_TYPE_SSD1306);
+	CHECK_EQ(options.address, DISPLAY_ADDRESS);
+	options.size = GPGFX_DisplaySize::SIZE_128x64;
+	options.orientation = 0;
+	options.inverted = false;
+	options.font.fontData = GP_Font_Standard;
+	options.font.width = 6;
+	options.font.height = 8;
+	gfx->init(options);
+	CHECK(panel.isOn());
+	// init sends a blank frame over whatever the detection probe left in RAM
+	CHECK_EQ(panelMismatches(panel, gfx, sh1106), 0);
+
+	GPScreen * screen = new ButtonLayoutScreen(gfx);
+	screen->init();
+
+	// Wire bytes of the old flush: a write per addressing command (six, or three on the SH1106), then the
+	// control byte and the page (two columns more on the SH1106), each write behind its address byte
+	double byteUs = 9e6 / I2C_SPEED;
+	uint64_t oldFrameBytes = sh1106 ? PANEL_PAGES * (3 * (1 + 2) + (1 + 1 + 130)) :
+		PANEL_PAGES * (6 * (1 + 2) + (1 + 1 + 128));
+
+	printf("%s panel, %dkHz bus, render every %dus, old full frame %llu bytes (%.0fus)\n", sh1106 ? "SH1106" : "SSD1306",
+		I2C_SPEED / 1000, RENDER_US, (unsigned long long)oldFrameBytes, oldFrameBytes * byteUs);
+	printf("  %-16s %6s %12s %12s %12s %14s %11s\n", "updates", "pages", "bytes/frame", "worst frame",
+		"writes/frame", "bus us/frame", "mismatched");
+	// the whole frame first, then the same updates with every page allowed and with the 2 page budget
+	static const struct {
+		Traffic traffic;
+		uint8_t pageLimit;
+	} runs[] = {
+		{ TRAFFIC_FULL_FRAME, 0 }, { TRAFFIC_IDLE, 0 }, { TRAFFIC_ONE_BUTTON, 0 }, { TRAFFIC_RANDOM, 0 },
+		{ TRAFFIC_IDLE, 2 }, { TRAFFIC_ONE_BUTTON, 2 }, { TRAFFIC_RANDOM, 2 },
+	};
+	FlushResult full = {};
+	for (const auto & run : runs) {
+		FlushResult result = runFlush(screen, gfx, panel, sh1106, run.traffic, run.pageLimit);
+		printf("  %-16s %6s %12.1f %12llu %12.1f %14.0f %11llu\n", trafficNames[run.traffic],
+			run.pageLimit ? "2" : "all", (double)result.bytes / result.frames, (unsigned long long)result.worstBytes,
+			(double)result.transfers / result.frames, (double)result.busNs / 1000 / result.frames,
+			(unsigned long long)result.mismatchedFrames);
+
+		CHECK_EQ(result.mismatchedFrames, 0);
+		if (run.traffic == TRAFFIC_FULL_FRAME) {
+			full = result;
+			// one command and one data write per page, never more bytes than the old flush
+			CHECK_EQ(result.transfers, result.frames * PANEL_PAGES * 2);
+			CHECK(result.bytes <= result.frames * oldFrameBytes);
+		} else if (run.traffic == TRAFFIC_IDLE) {
+			CHECK(result.bytes < result.frames * oldFrameBytes / 50);
+		} else {
+			// a button redraw only resends the columns it touched
+			CHECK(result.bytes > 0);
+			CHECK(result.bytes * full.frames * 4 < full.bytes * result.frames);
+			CHECK(result.worstBytes <= full.worstBytes);
+		}
+	}
+
+	// A render the panel NAKs changes nothing on it; the next one has to resend those pages even though
+	// the framebuffer hasn't changed since
+	screen->draw(0);
+	panel.setNakWrites(true);
+	setInput(0, GAMEPAD_MASK_B1 | GAMEPAD_MASK_B4);
+	screen->update();
+	screen->draw(0);
+	uint32_t lost = panelMismatches(panel, gfx, sh1106);
+	panel.setNakWrites(false);
+	screen->update();
+	screen->draw(0);
+	printf("  NAKed render: %u pixels lost, %u left after the next render\n", lost, panelMismatches(panel, gfx, sh1106));
+	CHECK(lost > 0);
+	CHECK_EQ(panelMismatches(panel, gfx, sh1106), 0);
+	setInput(0, 0);
+
+	// drain whatever a budgeted render left behind before the next panel
+	screen->draw(0);
+	delete screen;
+	delete gfx;
+	hostI2CDetach(i2c0, DISPLAY_ADDRESS);
+}
+
+int main() {
+	srand(15);
+	hostTimeSetManual(true);
+	Storage::getInstance().init();
+	Storage::getInstance().SetGamepad(new Gamepad());
+	Storage::getInstance().SetProcessedGamepad(new Gamepad());
+	hostGpioSetInputs(0xffffffff);
+	Storage::getInstance().setFunctionalPinMappings();
+	Storage::getInstance().GetGamepad()->setup();
+
+	PeripheralOptions_I2COptions & i2cOptions = Storage::getInstance().getPeripheralOptions().blockI2C0;
+	i2cOptions.enabled = true;
+	i2cOptions.sda = 0;
+	i2cOptions.scl = 1;
+	i2cOptions.speed = I2C_SPEED;
+	PeripheralManager::getInstance().initI2C();
+	hostI2CSetLogging(true);
+
+	runPanel(false);
+	runPanel(true);
+
+	return hostTestResult("test_oled_flush");
+}
@@ -0,0 +1,359 @@
+/*
+ * SPDX-License-Identifier: MIT
+ * SPDX-FileCopyrightText: Copyright (c) 2024 OpenStickCommunity (gp2040-ce.info)
+ */
+
+// Rotary encoder: A/B traces are replayed onto the pins while the Core0 loop calls process() every
+// millisecond. Traces cover a bouncing detent knob, a spinner, a turntable swept up to 150k edges per
+// second, the loop stalling for 50ms at a time, and two encoders turning at once. Every edge holds the
+// interrupt off for an ISR entry latency, so edges closer than that reach the handler together, as they
+// do on the device. The value process() reports (half quadrature cycles, read back from the stick axis)
+// must end on the trace, give or take the odd step a half cycle can't show. The old decoder, sampling the
+// pins once per loop, is run on the same traces for comparison.
+//
+// A flash save holds interrupts off for its whole write. A knob that moves at most one state during it
+// loses nothing; a turntable spinning through a save loses what it moved past that, which is printed.
+
+#include <stdlib.h>
+#include <algorithm>
+#include <vector>
+
+#include "hosttest.h"
+#include "hostsim.h"
+
+#include "addons/rotaryencoder.h"
+#include "gamepad.h"
+#include "storagemanager.h"
+
+#define ONE_PIN_A 2
+#define ONE_PIN_B 3
+#define TWO_PIN_A 4
+#define TWO_PIN_B 5
+// One half quadrature cycle per unit of the encoder value, (ENCODER_RADIUS * ENCODER_PRECISION) pulses
+#define UNIT_PPR 23040
+#define LOOP_US 1000
+#define TRACE_US 1000000
+#define IRQ_LATENCY_NS 2000
+#define STALL_EVERY_US 250000
+#define STALL_US 50000
+#define SAVE_EVERY_US 100000
+#define SAVE_US (2 * HOST_FLASH_PAGE_PROGRAM_US)
+
+// A:B levels through one quadrature cycle, each step forward counts +1
+static const uint8_t QUADRATURE_CYCLE[4] = { 0b00, 0b10, 0b11, 0b01 };
+
+struct Edge {
+	uint64_t ns;
+	uint8_t encoder;
+	uint8_t levels;
+};
+
+struct Trace {
+	std::vector<Edge> edges;
+	int32_t steps[2] = { 0, 0 };
+	uint32_t phase[2] = { 0, 0 };
+
+	void step(uint64_t ns, uint8_t encoder, int direction) {
+		phase[encoder] = (phase[encoder] + (direction > 0 ? 1 : 3)) % 4;
+		steps[encoder] += direction > 0 ? 1 : -1;
+		edges.push_back({ ns, encoder, QUADRATURE_CYCLE[phase[encoder]] });
+	}
+
+	// The pin that just changed chatters back to where it was and forward again
+	void bounce(uint64_t ns, uint8_t encoder, uint32_t glitches, uint32_t spacingNs) {
+		uint8_t levels = QUADRATURE_CYCLE[phase[encoder]];
+		uint8_t previous = QUADRATURE_CYCLE[(phase[encoder] + 3) % 4];
+		for (uint32_t i = 0; i < glitches; i++) {
+			edges.push_back({ ns + (2 * i + 1) * spacingNs, encoder, previous });
+			edges.push_back({ ns + (2 * i + 2) * spacingNs, encoder, levels });
+		}
+	}
+
+	// Steps at a rate in edges per second over [startUs, endUs), turning round every turnUs
+	void spin(uint8_t encoder, uint64_t startUs, uint64_t endUs, uint32_t (*rate)(uint64_t us), uint64_t turnUs) {
+		uint64_t ns = startUs * 1000;
+		int direction = 1;
+		uint64_t nextTurn = (startUs + turnUs) * 1000;
+		while (ns < endUs * 1000) {
+			uint32_t perSecond = rate(ns / 1000);
+			// 20% jitter, encoder phases are never evenly spaced
+			uint64_t period = 1000000000ull / perSecond;
+			ns += period - period / 10 + rand() % (period / 5 + 1);
+			if (ns >= nextTurn) {
+				direction = -direction;
+				nextTurn += turnUs * 1000;
+			}
+			step(ns, encoder, direction);
+		}
+	}
+
+	void sort() {
+		std::stable_sort(edges.begin(), edges.end(), [](const Edge & a, const Edge & b) { return a.ns < b.ns; });
+	}
+};
+
+static uint32_t spinnerRate(uint64_t) { return 12000; }
+static uint32_t stalledRate(uint64_t) { return 40000; }
+static uint32_t pairRate(uint64_t) { return 60000; }
+// Sweeps up to 150k edges per second and back
+static uint32_t turntableRate(uint64_t us) {
+	uint64_t position = us % 500000;
+	uint64_t ramp = position < 250000 ? position : 500000 - position;
+	return 5000 + (uint32_t)(ramp * 145000 / 250000);
+}
+
+// A 24 detent knob turned by hand, a few detents at a time with contact bounce on every edge
+static void knobTrace(Trace & trace) {
+	uint64_t ns = 1000000;
+	while (ns < (TRACE_US - 20000) * 1000ull) {
+		int direction = (rand() % 2) ? 1 : -1;
+		int detents = 1 + rand() % 6;
+		for (int i = 0; i < detents * 4; i++) {
+			ns += (1000 + rand() % 4000) * 1000ull;
+			trace.step(ns, 0, direction);
+			trace.bounce(ns, 0, 1 + rand() % 3, 20000 + rand() % 60000);
+		}
+		ns += (20000 + rand() % 80000) * 1000ull;
+	}
+}
+
+// The pin sampling process() used to do, once per loop after the per-encoder delay
+struct ReferenceDecoder {
+	bool pinA = false;
+	bool pinB = false;
+	bool prevA = false;
+	bool prevB = false;
+	uint32_t updateTime = 0;
+	uint8_t delay = 1;
+	int32_t value = 0;
+
+	void sample(uint32_t now, bool pinAValue, bool pinBValue) {
+		if (now - updateTime < delay)
+			return;
+		if (pinA != pinAValue || pinB != pinBValue) {
+			if ((pinA == prevA) && (pinB == prevB)) {
+				if ((pinA && !pinB && pinBValue) || (!pinA && pinB && !pinBValue))
+					value++;
+				else if ((!pinA && pinB && pinBValue) || (pinA && !pinB && !pinBValue))
+					value--;
+			}
+		}
+		pinA = prevA = pinAValue;
+		pinB = prevB = pinBValue;
+		updateTime = now;
+	}
+};
+
+struct RunResult {
+	uint32_t edges;
+	int32_t steps[2];           // quadrature steps the trace moved
+	int32_t counted[2];         // half cycles, from process()
+	int32_t reference[2];       // half cycles, from the old decoder
+	uint32_t worstLag;          // half cycles behind the trace at any process()
+};
+
+static void setPins(uint8_t encoder, uint8_t levels) {
+	hostGpioSetInput(encoder ? TWO_PIN_A : ONE_PIN_A, levels & 0b10);
+	hostGpioSetInput(encoder ? TWO_PIN_B : ONE_PIN_B, levels & 0b01);
+}
+
+// process() reports the value through the stick axis, wrapped to 16 bits
+static uint16_t rawValue(uint8_t encoder) {
+	Gamepad * gamepad = Storage::getInstance().GetGamepad();
+	return (uint16_t)-(encoder ? gamepad->state.rx : gamepad->state.lx);
+}
+
+static RunResult replay(Trace & trace, bool stalls, bool saves) {
+	trace.sort();
+	hostReset();
+	hostTimeSetManual(true);
+	hostGpioSetInputs(0);
+	RotaryEncoderInput encoder;
+	encoder.setup();
+	encoder.process();
+
+	// hostReset() leaves the clock running, the trace starts from here
+	uint64_t baseNs = hostTimeNs();
+	RunResult result = {};
+	result.edges = trace.edges.size();
+	ReferenceDecoder reference[2];
+	uint16_t lastRaw[2] = { rawValue(0), rawValue(1) };
+	int32_t truth[2] = { 0, 0 };
+	uint8_t truthPhase[2] = { 0, 0 };
+	size_t next = 0;
+	bool masked = false;
+	uint32_t interrupts = 0;
+	uint64_t unmaskNs = 0;
+	uint64_t nextLoopNs = baseNs;
+	uint64_t endNs = baseNs + (TRACE_US + 10000) * 1000ull;
+
+	while (hostTimeNs() < endNs) {
+		uint64_t edgeNs = next < trace.edges.size() ? baseNs + trace.edges[next].ns : UINT64_MAX;
+		uint64_t atNs = std::min(edgeNs, nextLoopNs);
+		if (masked)
+			atNs = std::min(atNs, unmaskNs);
+		if (atNs > hostTimeNs())
+			hostTimeAdvanceNs(atNs - hostTimeNs());
+
+		if (masked && hostTimeNs() >= unmaskNs) {
+			masked = false;
+			restore_interrupts(interrupts);
+			continue;
+		}
+
+		if (next < trace.edges.size() && hostTimeNs() >= edgeNs) {
+			const Edge & edge = trace.edges[next++];
+			// Half cycles the trace has moved, a full step back and forth through bounce nets to zero
+			for (int s = 0; s < 4; s++) {
+				if (QUADRATURE_CYCLE[(truthPhase[edge.encoder] + s) % 4] == edge.levels) {
+					truth[edge.encoder] += (s == 1) ? 1 : (s == 3) ? -1 : 0;
+					truthPhase[edge.encoder] = (truthPhase[edge.encoder] + s) % 4;
+					break;
+				}
+			}
+			if (!masked) {
+				// The handler samples the pins once it has been entered
+				interrupts = save_and_disable_interrupts();
+				masked = true;
+				unmaskNs = hostTimeNs() + IRQ_LATENCY_NS;
+			}
+			setPins(edge.encoder, edge.levels);
+			continue;
+		}
+
+		uint64_t nowUs = (hostTimeNs() - baseNs) / 1000;
+		if (saves && nowUs % SAVE_EVERY_US < LOOP_US && nowUs > LOOP_US) {
+			// FlashPROM::flush holds the flash lock, interrupts are off for the whole write
+			if (!masked) {
+				interrupts = save_and_disable_interrupts();
+				masked = true;
+			}
+			unmaskNs = std::max<uint64_t>(unmaskNs, hostTimeNs() + SAVE_US * 1000ull);
+			nextLoopNs = unmaskNs + LOOP_US * 1000ull;
+			continue;
+		}
+		if (stalls && nowUs % STALL_EVERY_US < LOOP_US && nowUs > LOOP_US) {
+			// A blocking addon or a long display update, the pin IRQ keeps running
+			nextLoopNs = hostTimeNs() + STALL_US * 1000ull;
+			continue;
+		}
+
+		encoder.process();
+		uint32_t pins = gpio_get_all();
+		uint32_t now = (uint32_t)(hostTimeNs() / 1000000);
+		reference[0].sample(now, pins & (1u << ONE_PIN_A), pins & (1u << ONE_PIN_B));
+		reference[1].sample(now, pins & (1u << TWO_PIN_A), pins & (1u << TWO_PIN_B));
+		for (uint8_t e = 0; e < 2; e++) {
+			uint16_t raw = rawValue(e);
+			result.counted[e] += (int16_t)(raw - lastRaw[e]);
+			lastRaw[e] = raw;
+			// Half cycles, an odd step waits for the next one
+			uint32_t lag = abs(truth[e] / 2 - result.counted[e]);
+			if (!masked)
+				result.worstLag = std::max(result.worstLag, lag);
+		}
+		nextLoopNs = hostTimeNs() + LOOP_US * 1000ull;
+	}
+	if (masked)
+		restore_interrupts(interrupts);
+
+	for (uint8_t e = 0; e < 2; e++) {
+		result.steps[e] = trace.steps[e];
+		result.reference[e] = reference[e].value;
+	}
+	return result;
+}
+
+static void setupOptions() {
+	RotaryOptions & options = Storage::getInstance().getAddonOptions().rotaryOptions;
+	options.enabled = true;
+	RotaryPinOptions * encoders[] = { &options.encoderOne, &options.encoderTwo };
+	const int32_t pins[][2] = { { ONE_PIN_A, ONE_PIN_B }, { TWO_PIN_A, TWO_PIN_B } };
+	const RotaryEncoderPinMode modes[] = { ENCODER_MODE_LEFT_ANALOG_X, ENCODER_MODE_RIGHT_ANALOG_X };
+	for (int i = 0; i < 2; i++) {
+		encoders[i]->enabled = true;
+		encoders[i]->pinA = pins[i][0];
+		encoders[i]->pinB = pins[i][1];
+		encoders[i]->mode = modes[i];
+		encoders[i]->pulsesPerRevolution = UNIT_PPR;
+		encoders[i]->resetAfter = 0;
+		encoders[i]->allowWrapAround = true;
+		encoders[i]->multiplier = 1;
+	}
+}
+
+// Steps the decoder is short of the trace, an odd step left over can't show in half cycles
+static int32_t missedSteps(int32_t steps, int32_t halfCycles) {
+	int32_t missed = steps - 2 * halfCycles;
+	return abs(missed) <= 1 ? 0 : missed;
+}
+
+static void printResult(const char * name, const RunResult & result) {
+	for (int e = 0; e < 2; e++) {
+		if (result.steps[e] == 0 && result.counted[e] == 0)
+			continue;
+		printf("  %-20s %3d %8u %10d %10d %10d %8u\n", name, e, result.edges, result.steps[e],
+			missedSteps(result.steps[e], result.counted[e]), missedSteps(result.steps[e], result.reference[e]), result.worstLag);
+	}
+}
+
+int main() {
+	srand(21);
+	Storage::getInstance().init();
+	Storage::getInstance().SetGamepad(new Gamepad());
+	setupOptions();
+
+	printf("  %-20s %3s %8s %10s %10s %10s %8s\n", "trace", "enc", "edges", "steps", "irq missed",
+		"old missed", "worst lag");
+
+	Trace knob;
+	knobTrace(knob);
+	RunResult result = replay(knob, false, false);
+	printResult("knob", result);
+	CHECK_EQ(missedSteps(result.steps[0], result.counted[0]), 0);
+	CHECK(result.worstLag <= 1);
+
+	Trace spinner;
+	spinner.spin(0, 1000, TRACE_US, spinnerRate, 200000);
+	result = replay(spinner, false, false);
+	printResult("spinner", result);
+	CHECK_EQ(missedSteps(result.steps[0], result.counted[0]), 0);
+	CHECK(result.worstLag <= 1);
+
+	Trace turntable;
+	turntable.spin(0, 1000, TRACE_US, turntableRate, 300000);
+	result = replay(turntable, false, false);
+	printResult("turntable", result);
+	CHECK_EQ(missedSteps(result.steps[0], result.counted[0]), 0);
+	CHECK(result.worstLag <= 1);
+
+	Trace stalled;
+	stalled.spin(0, 1000, TRACE_US, stalledRate, 400000);
+	result = replay(stalled, true, false);
+	printResult("turntable, stalls", result);
+	CHECK_EQ(missedSteps(result.steps[0], result.counted[0]), 0);
+
+	Trace pair;
+	pair.spin(0, 1000, TRACE_US, pairRate, 150000);
+	pair.spin(1, 1000, TRACE_US, pairRate, 350000);
+	result = replay(pair, false, false);
+	printResult("two encoders", result);
+	CHECK_EQ(missedSteps(result.steps[0], result.counted[0]), 0);
+	CHECK_EQ(missedSteps(result.steps[1], result.counted[1]), 0);
+	CHECK(result.worstLag <= 1);
+
+	Trace savedKnob;
+	knobTrace(savedKnob);
+	result = replay(savedKnob, false, true);
+	printResult("knob, flash saves", result);
+	CHECK_EQ(missedSteps(result.steps[0], result.counted[0]), 0);
+
+	Trace savedTurntable;
+	savedTurntable.spin(0, 1000, TRACE_US, stalledRate, 400000);
+	result = replay(savedTurntable, false, true);
+	printResult("turntable, saves", result);
+	// Not counted while interrupts are off, but never more than was moved then
+	CHECK(abs(missedSteps(result.steps[0], result.counted[0])) <= (int32_t)(TRACE_US / SAVE_EVERY_US * SAVE_US * 40000ull / 1000000));
+
+	return hostTestResult("test_rotary_encoder");
+}
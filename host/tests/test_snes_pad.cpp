@@ -0,0 +1,545 @@
+/*
+ * SPDX-License-Identifier: MIT
+ * SPDX-FileCopyrightText: Copyright (c) 2024 OpenStickCommunity (gp2040-ce.info)
+ */
+
+// SNESpad: a line level model of SNES pads, NES pads and mice (one that follows the speed pulses and a
+// Hyperkin style one that doesn't) is read both by the bit-banged path and by snespad.pio, which is
+// assembled from the source and run here by a small interpreter in place of the state machine. Both
+// paths replay the same presses and have to decode the same settled states; the test also reports the
+// time poll() takes from the Core0 loop on each path and checks the PIO read period is the poll interval.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <deque>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "hosttest.h"
+#include "hostsim.h"
+
+#include "SNESpad.h"
+
+#define CLOCK_PIN 2
+#define LATCH_PIN 3
+#define DATA_PIN 4
+#define POLL_INTERVAL_US 1000
+#define LOOP_US 100           // Core0 loop, with a 1kHz report rate
+#define KIND_US 400000
+#define UNPLUGGED_US 20000    // between two devices, so the mouse speed state starts over
+
+//--------------------------------------------------------------------+
+// Devices on the port
+//--------------------------------------------------------------------+
+
+enum PadKind { PAD_UNPLUGGED, PAD_SNES, PAD_NES, PAD_MOUSE, PAD_STUCK_MOUSE };
+
+static const char * kindNames[] = { "unplugged", "snes", "nes", "mouse", "stuck mouse" };
+
+static struct {
+	PadKind kind;
+	uint32_t held;            // SNES: SNES_ bits, NES: A, B, Select, Start, Up, Down, Left, Right in bits 0-7
+	bool mouseLeft;
+	bool mouseRight;
+	int dx;
+	int dy;
+	uint8_t speed;            // speed code in the report, steps on a clock pulse while latched
+	uint32_t speedPulses;
+	bool latch;
+	bool clock;
+	uint32_t report;          // 1 = line pulled low
+	uint32_t bit;             // bits clocked out since the latch fell
+} pad;
+
+// 7 bit magnitude, most significant bit first
+static uint32_t mouseAxis(int d) {
+	uint32_t magnitude = std::min(abs(d), 127);
+	uint32_t bits = d < 0 ? 1 : 0;
+	for (int i = 0; i < 7; i++)
+		bits |= ((magnitude >> (6 - i)) & 1) << (i + 1);
+	return bits;
+}
+
+static uint32_t padReport() {
+	switch (pad.kind) {
+		case PAD_SNES:
+			// the id nibble reads 0, the line stays low after the 16 bits
+			return (pad.held & 0x0fff) | 0xffff0000;
+		case PAD_NES:
+			// the line stays low after the 8 bits
+			return (pad.held & 0xff) | 0xffffff00;
+		case PAD_MOUSE:
+		case PAD_STUCK_MOUSE:
+			return (pad.mouseLeft ? SNES_A : 0) | (pad.mouseRight ? SNES_X : 0) | ((uint32_t)pad.speed << 10) |
+				(SNES_MOUSE_ID << 12) | (mouseAxis(pad.dy) << 16) | (mouseAxis(pad.dx) << 24);
+		default:
+			return 0;
+	}
+}
+
+// Data line level, connected devices hold it low outside a read
+static bool padData() {
+	if (pad.kind == PAD_UNPLUGGED)
+		return true;
+	if (pad.latch)
+		return !(padReport() & 1);
+	if (pad.bit >= 32)
+		return false;
+	return !((pad.report >> pad.bit) & 1);
+}
+
+static void padLines(bool latch, bool clock) {
+	bool rising = clock && !pad.clock;
+	if (latch) {
+		if (rising && pad.kind == PAD_MOUSE)
+			pad.speed = (pad.speed + 1) % 3;
+		if (rising)
+			pad.speedPulses++;
+		pad.bit = 0;
+	} else if (pad.latch) {
+		// the report is taken when the latch falls
+		pad.report = padReport();
+		pad.bit = 0;
+	} else if (rising) {
+		pad.bit++;
+	}
+	pad.latch = latch;
+	pad.clock = clock;
+	hostGpioSetInput(DATA_PIN, padData());
+}
+
+static void padLinesHook(uint32_t outputs, void *) {
+	bool latch = (outputs >> LATCH_PIN) & 1;
+	bool clock = (outputs >> CLOCK_PIN) & 1;
+	if (latch != pad.latch || clock != pad.clock)
+		padLines(latch, clock);
+}
+
+static void padRandomize() {
+	pad.held = rand() & 0x0fff;
+	pad.mouseLeft = rand() & 1;
+	pad.mouseRight = rand() & 1;
+	pad.dx = rand() % 255 - 127;
+	pad.dy = rand() % 255 - 127;
+}
+
+//--------------------------------------------------------------------+
+// snespad.pio, assembled from the source and interpreted
+//--------------------------------------------------------------------+
+
+enum PioOp { OP_JMP, OP_MOV, OP_PULL, OP_OUT, OP_SET, OP_IN, OP_PUSH, OP_NOP };
+
+struct PioInstruction {
+	PioOp op;
+	std::string dst;          // jmp: condition
+	std::string src;          // jmp: label
+	uint32_t value;
+	int side;
+	uint32_t delay;
+	uint32_t target;
+};
+
+class SnesPadProgram : public HostPIODevice {
+public:
+	std::vector<PioInstruction> program;
+	uint32_t wrapTarget = 0;
+	uint32_t wrap = 0;
+	uint32_t readCycles = 0;
+	std::deque<uint32_t> tx;
+	uint64_t packets = 0;
+	uint64_t lastPushNs = 0;
+	uint64_t periodMinNs = UINT64_MAX;
+	uint64_t periodMaxNs = 0;
+
+	bool assemble(const char * path) {
+		FILE * file = fopen(path, "r");
+		if (file == nullptr)
+			return false;
+		std::map<std::string, uint32_t> labels;
+		char line[256];
+		bool inProgram = false;
+		while (fgets(line, sizeof(line), file)) {
+			std::string code(line);
+			code = code.substr(0, code.find(';'));
+			if (code.find("% c-sdk") != std::string::npos)
+				break;
+			std::vector<std::string> words;
+			char * save = nullptr;
+			for (char * word = strtok_r(&code[0], " \t\r\n,", &save); word; word = strtok_r(nullptr, " \t\r\n,", &save))
+				words.push_back(word);
+			if (words.empty())
+				continue;
+			if (words[0] == ".program") {
+				inProgram = true;
+			} else if (!inProgram) {
+				continue;
+			} else if (words[0] == ".wrap_target") {
+				wrapTarget = program.size();
+			} else if (words[0] == ".wrap") {
+				wrap = program.size() - 1;
+			} else if (words[0] == ".define" && words.size() >= 4 && words[2] == "READ_CYCLES") {
+				readCycles = strtoul(words[3].c_str(), nullptr, 0);
+			} else if (words[0][0] == '.') {
+				continue;
+			} else if (words[0].back() == ':') {
+				labels[words[0].substr(0, words[0].size() - 1)] = program.size();
+			} else {
+				program.push_back(parse(words));
+			}
+		}
+		fclose(file);
+		for (PioInstruction & instruction : program) {
+			if (instruction.op == OP_JMP) {
+				if (labels.find(instruction.src) == labels.end())
+					return false;
+				instruction.target = labels[instruction.src];
+			}
+		}
+		return !program.empty();
+	}
+
+	void put(uint32_t data) {
+		if (tx.size() < 4)
+			tx.push_back(data);
+	}
+
+	void run(uint64_t nowNs) {
+		if (!started) {
+			started = true;
+			cycleNs = nowNs;
+		}
+		while (cycleNs + 1000 <= nowNs)
+			step();
+	}
+
+private:
+	bool started = false;
+	uint64_t cycleNs = 0;
+	uint32_t pc = 0;
+	uint32_t x = 0;
+	uint32_t y = 0;
+	uint32_t osr = 0;
+	uint32_t isr = 0;
+	bool latch = false;
+	bool clock = true;
+
+	static PioInstruction parse(const std::vector<std::string> & words) {
+		static const struct { const char * name; PioOp op; } ops[] = {
+			{ "jmp", OP_JMP }, { "mov", OP_MOV }, { "pull", OP_PULL }, { "out", OP_OUT },
+			{ "set", OP_SET }, { "in", OP_IN }, { "push", OP_PUSH }, { "nop", OP_NOP },
+		};
+		PioInstruction instruction = { OP_NOP, "", "", 0, -1, 0, 0 };
+		for (const auto & op : ops) {
+			if (words[0] == op.name)
+				instruction.op = op.op;
+		}
+		std::vector<std::string> args;
+		for (size_t i = 1; i < words.size(); i++) {
+			if (words[i] == "side")
+				instruction.side = atoi(words[++i].c_str());
+			else if (words[i][0] == '[')
+				instruction.delay = atoi(words[i].c_str() + 1);
+			else
+				args.push_back(words[i]);
+		}
+		if (instruction.op == OP_JMP) {
+			instruction.dst = args.size() > 1 ? args[0] : "";
+			instruction.src = args.back();
+		} else if (instruction.op == OP_MOV || instruction.op == OP_OUT || instruction.op == OP_SET || instruction.op == OP_IN) {
+			instruction.dst = args[0];
+			instruction.src = args.size() > 1 ? args[1] : "";
+			instruction.value = args.size() > 1 ? strtoul(args[1].c_str(), nullptr, 0) : 0;
+		}
+		return instruction;
+	}
+
+	void step() {
+		const PioInstruction & instruction = program[pc];
+		// inputs are sampled before this cycle's outputs change
+		uint32_t data = padData() ? 1 : 0;
+		uint32_t next = pc == wrap ? wrapTarget : pc + 1;
+		switch (instruction.op) {
+			case OP_JMP: {
+				bool taken = true;
+				if (instruction.dst == "y--")
+					taken = y-- != 0;
+				else if (instruction.dst == "!y")
+					taken = y == 0;
+				else if (instruction.dst == "pin")
+					taken = data;
+				if (taken)
+					next = instruction.target;
+				break;
+			}
+			case OP_MOV: {
+				uint32_t value = instruction.src == "x" ? x : instruction.src == "y" ? y : data;
+				if (instruction.dst == "x") x = value;
+				else if (instruction.dst == "y") y = value;
+				else osr = value;
+				break;
+			}
+			case OP_PULL:
+				// noblock with an empty FIFO copies X
+				if (tx.empty()) {
+					osr = x;
+				} else {
+					osr = tx.front();
+					tx.pop_front();
+				}
+				break;
+			case OP_OUT: {
+				uint32_t count = instruction.value;
+				uint32_t value = count == 32 ? osr : osr & ((1u << count) - 1);
+				osr = count == 32 ? 0 : osr >> count;
+				if (instruction.dst == "y") y = value;
+				else x = value;
+				break;
+			}
+			case OP_SET:
+				if (instruction.dst == "pins") latch = instruction.value & 1;
+				else if (instruction.dst == "y") y = instruction.value;
+				else x = instruction.value;
+				break;
+			case OP_IN: {
+				uint32_t count = instruction.value;
+				uint32_t value = instruction.dst == "pins" ? data : instruction.dst == "osr" ? osr : 0;
+				value &= count == 32 ? 0xffffffff : (1u << count) - 1;
+				isr = count == 32 ? value : (isr >> count) | (value << (32 - count));
+				break;
+			}
+			case OP_PUSH:
+				hostPIOPushRx(pio1, 0, isr);
+				isr = 0;
+				packets++;
+				if (lastPushNs) {
+					periodMinNs = std::min(periodMinNs, cycleNs - lastPushNs);
+					periodMaxNs = std::max(periodMaxNs, cycleNs - lastPushNs);
+				}
+				lastPushNs = cycleNs;
+				break;
+			case OP_NOP:
+				break;
+		}
+		if (instruction.side >= 0)
+			clock = instruction.side;
+		if (latch != pad.latch || clock != pad.clock)
+			padLines(latch, clock);
+		pc = next;
+		cycleNs += 1000 * (1 + instruction.delay);
+	}
+};
+
+//--------------------------------------------------------------------+
+// Runs
+//--------------------------------------------------------------------+
+
+struct Decoded {
+	int8_t type;
+	uint32_t buttons;         // SNES_ bits
+	uint16_t mouseX;
+	uint16_t mouseY;
+
+	bool operator==(const Decoded & other) const {
+		return type == other.type && buttons == other.buttons && mouseX == other.mouseX && mouseY == other.mouseY;
+	}
+};
+
+static Decoded decode(const SNESpad & snes) {
+	Decoded decoded = { snes.type, 0, snes.mouseX, snes.mouseY };
+	const struct { bool value; uint32_t mask; } fields[] = {
+		{ snes.buttonB, SNES_B }, { snes.buttonY, SNES_Y }, { snes.buttonSelect, SNES_SELECT }, { snes.buttonStart, SNES_START },
+		{ snes.directionUp, SNES_UP }, { snes.directionDown, SNES_DOWN }, { snes.directionLeft, SNES_LEFT },
+		{ snes.directionRight, SNES_RIGHT }, { snes.buttonA, SNES_A }, { snes.buttonX, SNES_X }, { snes.buttonL, SNES_L },
+		{ snes.buttonR, SNES_R },
+	};
+	for (const auto & field : fields) {
+		if (field.value)
+			decoded.buttons |= field.mask;
+	}
+	return decoded;
+}
+
+// What the pad holds, as SNESpad should decode it (mouse motion aside)
+static uint32_t expectedButtons() {
+	switch (pad.kind) {
+		case PAD_SNES:
+			return pad.held;
+		case PAD_NES: {
+			// NES A and B land on the SNES A and B fields
+			static const uint32_t nesMasks[8] = { SNES_A, SNES_B, SNES_SELECT, SNES_START, SNES_UP, SNES_DOWN, SNES_LEFT, SNES_RIGHT };
+			uint32_t buttons = 0;
+			for (int i = 0; i < 8; i++) {
+				if (pad.held & (1u << i))
+					buttons |= nesMasks[i];
+			}
+			return buttons;
+		}
+		case PAD_MOUSE:
+		case PAD_STUCK_MOUSE:
+			return (pad.mouseLeft ? SNES_A : 0) | (pad.mouseRight ? SNES_B : 0);
+		default:
+			return 0;
+	}
+}
+
+static const int8_t expectedTypes[] = { SNES_PAD_NONE, SNES_PAD_BASIC, SNES_PAD_NES, SNES_PAD_MOUSE, SNES_PAD_MOUSE };
+
+struct KindResult {
+	std::vector<Decoded> settled;     // decoded state at the end of every hold
+	uint64_t changes;
+	uint64_t wrong;                   // settled state not what the pad holds
+	uint64_t pollMaxNs;
+	uint64_t pollTotalNs;
+	uint64_t polls;
+	uint64_t latencyMaxUs;
+	uint32_t speedPulses;
+	uint8_t finalSpeed;
+};
+
+// Both paths see the same presses at the same times, whatever their loops take
+static KindResult runKind(SNESpad & snes, PadKind kind) {
+	KindResult result = {};
+	srand(12 + kind);
+
+	// unplug first, so the mouse speed state starts over
+	pad.kind = PAD_UNPLUGGED;
+	padLines(pad.latch, pad.clock);
+	for (uint64_t us = 0; us < UNPLUGGED_US; us += LOOP_US) {
+		snes.poll();
+		hostTimeAdvanceUs(LOOP_US);
+	}
+
+	pad.kind = kind;
+	pad.speed = SNES_MOUSE_MEDIUM;
+	pad.speedPulses = 0;
+	padRandomize();
+	padLines(pad.latch, pad.clock);
+	uint64_t startUs = hostTimeNs() / 1000;
+	uint64_t changeUs = startUs;
+	uint64_t nextChangeUs = startUs + 5000 + rand() % 25000;
+	// the plug-in read only identifies the device, its state comes with the next one
+	bool caughtUp = true;
+	Decoded decoded = {};
+	while (true) {
+		uint64_t us = hostTimeNs() / 1000;
+		if (us >= nextChangeUs) {
+			result.settled.push_back(decoded);
+			if (decoded.type != expectedTypes[kind] || decoded.buttons != expectedButtons())
+				result.wrong++;
+			if (nextChangeUs - startUs >= KIND_US)
+				break;
+			padRandomize();
+			changeUs = nextChangeUs;
+			nextChangeUs += 5000 + rand() % 25000;
+			caughtUp = false;
+			result.changes++;
+		}
+
+		uint64_t before = hostTimeNs();
+		snes.poll();
+		uint64_t pollNs = hostTimeNs() - before;
+		result.pollMaxNs = std::max(result.pollMaxNs, pollNs);
+		result.pollTotalNs += pollNs;
+		result.polls++;
+		decoded = decode(snes);
+		if (!caughtUp && decoded.type == expectedTypes[kind] && decoded.buttons == expectedButtons()) {
+			caughtUp = true;
+			result.latencyMaxUs = std::max(result.latencyMaxUs, hostTimeNs() / 1000 - changeUs);
+		}
+		hostTimeAdvanceUs(LOOP_US);
+	}
+	result.speedPulses = pad.speedPulses;
+	result.finalSpeed = pad.speed;
+	return result;
+}
+
+static void printKind(const char * path, PadKind kind, const KindResult & result) {
+	printf("  %-6s %-12s %8llu %8llu %10.1f %10.1f %12llu %7u\n", path, kindNames[kind],
+		(unsigned long long)result.changes, (unsigned long long)result.wrong,
+		result.polls ? (double)result.pollTotalNs / result.polls / 1000.0 : 0.0, (double)result.pollMaxNs / 1000.0,
+		(unsigned long long)result.latencyMaxUs, result.speedPulses);
+}
+
+int main() {
+	hostTimeSetManual(true);
+	hostGpioSetInputs(0xffffffff);
+	hostGpioSetOutputHook(padLinesHook, nullptr);
+	pad.clock = true;
+
+	SnesPadProgram program;
+	CHECK(program.assemble(SNESPAD_PIO_SOURCE));
+	hostPIOAttach(pio1, 0, &program);
+
+	const PadKind kinds[] = { PAD_SNES, PAD_NES, PAD_MOUSE, PAD_STUCK_MOUSE, PAD_UNPLUGGED };
+	std::vector<KindResult> bitBanged;
+	std::vector<KindResult> background;
+
+	printf("%dus poll interval, %dus loop\n", POLL_INTERVAL_US, LOOP_US);
+	printf("  %-6s %-12s %8s %8s %10s %10s %12s %7s\n", "path", "device", "changes", "wrong", "poll avg", "poll max",
+		"latency max", "pulses");
+
+	SNESpad gpioPad(CLOCK_PIN, LATCH_PIN, DATA_PIN);
+	gpioPad.begin();
+	gpioPad.start();
+	CHECK(!gpioPad.isBackground());
+	for (PadKind kind : kinds) {
+		bitBanged.push_back(runKind(gpioPad, kind));
+		printKind("gpio", kind, bitBanged.back());
+	}
+
+	SNESpad pioPad(CLOCK_PIN, LATCH_PIN, DATA_PIN);
+	pioPad.begin(POLL_INTERVAL_US);
+	pioPad.start();
+	CHECK(pioPad.isBackground());
+	for (PadKind kind : kinds) {
+		uint64_t packetsBefore = program.packets;
+		if (kind == PAD_SNES) {
+			program.periodMinNs = UINT64_MAX;
+			program.periodMaxNs = 0;
+		}
+		background.push_back(runKind(pioPad, kind));
+		printKind("pio", kind, background.back());
+		if (kind == PAD_SNES) {
+			// 16 bit reads only, so every packet is one poll interval apart
+			printf("         snes packet period %.0f-%.0fus, %llu packets\n", program.periodMinNs / 1000.0,
+				program.periodMaxNs / 1000.0, (unsigned long long)(program.packets - packetsBefore));
+			CHECK_EQ(program.periodMinNs, POLL_INTERVAL_US * 1000);
+			CHECK_EQ(program.periodMaxNs, POLL_INTERVAL_US * 1000);
+		}
+	}
+	printf("READ_CYCLES %u\n", program.readCycles);
+
+	for (size_t i = 0; i < sizeof(kinds) / sizeof(kinds[0]); i++) {
+		const KindResult & gpio = bitBanged[i];
+		const KindResult & pio = background[i];
+		// same presses, same settled decodes, mouse motion included
+		CHECK_EQ(gpio.settled.size(), pio.settled.size());
+		CHECK(gpio.settled == pio.settled);
+		CHECK_EQ(gpio.wrong, 0);
+		CHECK_EQ(pio.wrong, 0);
+		if (kinds[i] != PAD_UNPLUGGED) {
+			CHECK(pio.changes > 0);
+			// a read starts within an interval of the change and takes at most half of one more
+			CHECK(pio.latencyMaxUs <= 2 * POLL_INTERVAL_US + LOOP_US);
+		}
+		// the background reader never holds up the loop
+		CHECK(pio.pollMaxNs < 5000);
+		if (kinds[i] == PAD_MOUSE) {
+			// medium to fast is two steps, and no more once it is fast
+			CHECK_EQ(gpio.speedPulses, 2);
+			CHECK_EQ(pio.speedPulses, 2);
+			CHECK_EQ(gpio.finalSpeed, SNES_MOUSE_FAST);
+			CHECK_EQ(pio.finalSpeed, SNES_MOUSE_FAST);
+		}
+		if (kinds[i] == PAD_STUCK_MOUSE) {
+			// a mouse that never changes speed is given up on
+			CHECK(gpio.speedPulses > 0 && gpio.speedPulses <= SNES_MOUSE_THRESHOLD + 1);
+			CHECK(pio.speedPulses > 0 && pio.speedPulses <= SNES_MOUSE_THRESHOLD + 1);
+		}
+	}
+
+	return hostTestResult("test_snes_pad");
+}
@@ -0,0 +1,236 @@
+/*
+ * SPDX-License-Identifier: MIT
+ * SPDX-FileCopyrightText: Copyright (c) 2024 OpenStickCommunity (gp2040-ce.info)
+ */
+
+// TG16/PC Engine pad: a model of the pad follows OE and SELECT and drives the four data lines, which
+// read as noise for a while after every edge. Normal and 6-button pads are pressed at random while the
+// addon runs from its repeating timer; every read has to decode to buttons the pad really held, changes
+// have to show within a frame or two, and preprocess()/process() must never block the loop.
+
+#include <stdlib.h>
+#include <algorithm>
+
+#include "hosttest.h"
+#include "hostsim.h"
+
+#include "addons/tg16_input.h"
+#include "gamepad.h"
+#include "storagemanager.h"
+
+#define OE_PIN 10
+#define SELECT_PIN 11
+#define DATA_PIN0 12          // D0 to D3 on 12 to 15
+#define SETTLE_US 300         // data lines are undefined this long after an OE or SELECT edge
+#define LOOP_US 10
+#define RUN_US 3000000
+#define SIX_BUTTON_TIMEOUT_US 150000
+
+// Pad buttons, in data line order: D0-D3 with SELECT high, then with SELECT low
+enum {
+	PAD_UP, PAD_RIGHT, PAD_DOWN, PAD_LEFT,
+	PAD_I, PAD_II, PAD_SELECT, PAD_RUN,
+	PAD_III, PAD_IV, PAD_V, PAD_VI,
+	PAD_BUTTONS
+};
+
+static const struct {
+	uint8_t dpad;
+	uint32_t buttons;
+} padMasks[PAD_BUTTONS] = {
+	{ GAMEPAD_MASK_UP, 0 }, { GAMEPAD_MASK_RIGHT, 0 }, { GAMEPAD_MASK_DOWN, 0 }, { GAMEPAD_MASK_LEFT, 0 },
+	{ 0, GAMEPAD_MASK_B1 }, { 0, GAMEPAD_MASK_B2 }, { 0, GAMEPAD_MASK_S1 }, { 0, GAMEPAD_MASK_S2 },
+	{ 0, GAMEPAD_MASK_B3 }, { 0, GAMEPAD_MASK_B4 }, { 0, GAMEPAD_MASK_L1 }, { 0, GAMEPAD_MASK_R1 },
+};
+
+static struct {
+	bool sixButton;
+	uint32_t held;          // one bit per PAD_ button
+	bool oe;
+	bool select;
+	bool extraFrame;        // 6-button pads alternate frames on every OE cycle
+	uint64_t edgeUs;
+	uint64_t frames;
+} pad;
+
+static uint64_t nowUs() {
+	return hostTimeNs() / 1000;
+}
+
+// Active low nibble of held buttons, starting at first
+static uint32_t padNibble(int first) {
+	uint32_t nibble = 0x0f;
+	for (int i = 0; i < 4; i++) {
+		if (pad.held & (1u << (first + i)))
+			nibble &= ~(1u << i);
+	}
+	return nibble;
+}
+
+static void padDrive() {
+	uint32_t nibble;
+	if (nowUs() - pad.edgeUs < SETTLE_US)
+		nibble = rand() & 0x0f;
+	else if (pad.oe)
+		nibble = 0;
+	else if (pad.extraFrame)
+		nibble = pad.select ? 0 : padNibble(PAD_III);
+	else
+		nibble = pad.select ? padNibble(PAD_UP) : padNibble(PAD_I);
+	for (int i = 0; i < 4; i++)
+		hostGpioSetInput(DATA_PIN0 + i, (nibble >> i) & 1);
+}
+
+static void padLinesHook(uint32_t outputs, void *) {
+	bool oe = (outputs >> OE_PIN) & 1;
+	bool select = (outputs >> SELECT_PIN) & 1;
+	if (oe == pad.oe && select == pad.select)
+		return;
+	if (pad.oe && !oe) {
+		pad.frames++;
+		if (pad.sixButton)
+			pad.extraFrame = !pad.extraFrame;
+	}
+	pad.oe = oe;
+	pad.select = select;
+	pad.edgeUs = nowUs();
+	padDrive();
+}
+
+// A d-pad position (never two opposite directions) and any buttons the pad has
+static uint32_t randomHeld(bool sixButton) {
+	static const uint32_t positions[] = {
+		0, 1u << PAD_UP, 1u << PAD_RIGHT, 1u << PAD_DOWN, 1u << PAD_LEFT,
+		(1u << PAD_UP) | (1u << PAD_RIGHT), (1u << PAD_RIGHT) | (1u << PAD_DOWN),
+		(1u << PAD_DOWN) | (1u << PAD_LEFT), (1u << PAD_LEFT) | (1u << PAD_UP),
+	};
+	uint32_t held = positions[rand() % 9] | ((rand() & 0x0f) << PAD_I);
+	if (sixButton)
+		held |= (rand() & 0x0f) << PAD_III;
+	return held;
+}
+
+static uint32_t stateHeld(const GamepadState & state) {
+	uint32_t held = 0;
+	for (int i = 0; i < PAD_BUTTONS; i++) {
+		if ((state.dpad & padMasks[i].dpad) || (state.buttons & padMasks[i].buttons))
+			held |= 1u << i;
+	}
+	return held;
+}
+
+struct PadResult {
+	uint64_t changes;
+	uint64_t latencyMaxUs;
+	uint64_t latencyAvgUs;
+	uint64_t late;
+	uint64_t phantom;
+	uint64_t worstCallNs;
+	double framesPerSec;
+};
+
+// swapUs is how long buttons only the previous pad had may still show
+static PadResult runPad(TG16padInput * addon, bool sixButton, uint64_t boundUs, uint64_t swapUs) {
+	Gamepad * gamepad = Storage::getInstance().GetGamepad();
+	pad.sixButton = sixButton;
+	pad.extraFrame = false;
+	PadResult result = {};
+	uint64_t startUs = nowUs();
+	uint64_t framesBefore = pad.frames;
+	uint64_t changeUs = startUs;
+	uint64_t nextChangeUs = startUs + 20000;
+	uint32_t previous = pad.held;
+	uint32_t swapped = pad.held;
+	uint32_t shown = 0;
+	bool caughtUp = false;
+	uint64_t latencyTotalUs = 0;
+	while (nowUs() - startUs < RUN_US) {
+		if (nowUs() >= nextChangeUs) {
+			previous = pad.held;
+			pad.held = randomHeld(sixButton);
+			changeUs = nowUs();
+			nextChangeUs = changeUs + 20000 + rand() % 60000;
+			caughtUp = false;
+			result.changes++;
+		}
+		padDrive();
+
+		gamepad->state.dpad = 0;
+		gamepad->state.buttons = 0;
+		uint64_t before = hostTimeNs();
+		addon->preprocess();
+		addon->process();
+		result.worstCallNs = std::max(result.worstCallNs, hostTimeNs() - before);
+		shown = stateHeld(gamepad->state);
+
+		// a read spanning a change can mix old and new nibbles, but never anything neither held
+		uint32_t allowed = pad.held | previous | (nowUs() - startUs < swapUs ? swapped : 0);
+		if (shown & ~allowed)
+			result.phantom++;
+		if (!caughtUp && shown == pad.held) {
+			caughtUp = true;
+			uint64_t latencyUs = nowUs() - changeUs;
+			latencyTotalUs += latencyUs;
+			result.latencyMaxUs = std::max(result.latencyMaxUs, latencyUs);
+		}
+		if (!caughtUp && nowUs() - changeUs > boundUs && nowUs() - startUs > swapUs) {
+			result.late++;
+			caughtUp = true;
+		}
+		hostTimeAdvanceUs(LOOP_US);
+	}
+	result.latencyAvgUs = result.changes ? latencyTotalUs / result.changes : 0;
+	result.framesPerSec = (double)(pad.frames - framesBefore) * 1e6 / (nowUs() - startUs);
+	return result;
+}
+
+int main() {
+	srand(16);
+	hostTimeSetManual(true);
+	Storage::getInstance().init();
+	Storage::getInstance().SetGamepad(new Gamepad());
+
+	TG16Options & options = Storage::getInstance().getAddonOptions().tg16Options;
+	options.enabled = true;
+	options.oePin = OE_PIN;
+	options.selectPin = SELECT_PIN;
+	options.dataPin0 = DATA_PIN0;
+	options.dataPin1 = DATA_PIN0 + 1;
+	options.dataPin2 = DATA_PIN0 + 2;
+	options.dataPin3 = DATA_PIN0 + 3;
+	pad.oe = true;
+	hostGpioSetOutputHook(padLinesHook, nullptr);
+
+	TG16padInput * addon = new TG16padInput();
+	CHECK(addon->available());
+	addon->setup();
+
+	// A frame is four steps; a 6-button pad only sends each button set every other frame
+	const uint64_t frameUs = 4 * TG16_PAD_STEP_US;
+	printf("%dus per step, %dus of settle time after each edge, %dus loop\n", TG16_PAD_STEP_US, SETTLE_US, LOOP_US);
+	printf("  %-9s %8s %9s %12s %12s %6s %8s %14s\n", "pad", "changes", "frames/s", "latency avg", "latency max",
+		"late", "phantom", "worst call ns");
+	bool wasSixButton = false;
+	for (bool sixButton : { false, true, false }) {
+		uint64_t boundUs = (sixButton ? 2 : 1) * frameUs + TG16_PAD_STEP_US + 2 * LOOP_US;
+		// after a 6-button pad, its mode has to time out before the extra buttons are let go
+		uint64_t swapUs = wasSixButton ? SIX_BUTTON_TIMEOUT_US + 2 * frameUs + boundUs : 0;
+		PadResult result = runPad(addon, sixButton, boundUs, swapUs);
+		wasSixButton = sixButton;
+		printf("  %-9s %8llu %9.0f %10lluus %10lluus %6llu %8llu %14llu\n", sixButton ? "6-button" : "2-button",
+			(unsigned long long)result.changes, result.framesPerSec, (unsigned long long)result.latencyAvgUs,
+			(unsigned long long)result.latencyMaxUs, (unsigned long long)result.late,
+			(unsigned long long)result.phantom, (unsigned long long)result.worstCallNs);
+
+		CHECK(result.changes > 0);
+		CHECK_EQ(result.late, 0);
+		CHECK_EQ(result.phantom, 0);
+		CHECK(result.latencyMaxUs <= std::max(boundUs, swapUs));
+		// the old read slept for 3 to 4ms inside preprocess()
+		CHECK(result.worstCallNs < 20000);
+		CHECK(result.framesPerSec > 0.9e6 / frameUs);
+	}
+
+	delete addon;
+	return hostTestResult("test_tg16_pad");
+}
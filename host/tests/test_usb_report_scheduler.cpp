@@ -0,0 +1,174 @@
+/*
+ * SPDX-License-Identifier: MIT
+ * SPDX-FileCopyrightText: Copyright (c) 2024 OpenStickCommunity (gp2040-ce.info)
+ */
+
+// USB report scheduler against a simulated host: SOF every frame, and an IN token every bInterval frames at a
+// fixed phase after the SOF plus some jitter that changes from frame to frame. GP2040::runOnce runs with SOF
+// sync on and the input changes after every report, so each poll has a new report to pick up. For each
+// schedule the learned interval has to match bInterval and the learned phase the host's, every report has to
+// be built in the window just before the IN token it goes out on, and no loop may spin longer than the cap.
+// Schedules follow each other without a restart, so the model also has to follow a host that changes: the
+// guard widens on the polls it misses meanwhile, and creeps back once reports make it again.
+
+#include <stdlib.h>
+#include <algorithm>
+
+#include "hosttest.h"
+#include "hostsim.h"
+
+#include "gp2040.h"
+#include "drivermanager.h"
+#include "storagemanager.h"
+#include "usbreportscheduler.h"
+
+#define LOOP_US 20              // rest of the Core0 loop between runOnce calls
+#define SETTLE_POLLS 400
+#define MEASURE_POLLS 500
+#define PHASE_SLACK_US 10
+#define SPIN_SLACK_US 1         // time reads step the simulated clock on the way to the spin
+#define LATE_ONE_IN 100
+
+struct Schedule {
+	uint32_t interval;          // bInterval, frames
+	uint32_t phaseUs;
+	uint32_t jitterUs;
+};
+
+static const Schedule schedules[] = {
+	{ 1, 100, 0 },
+	{ 1, 500, 30 },
+	{ 1, 900, 60 },
+	{ 2, 300, 20 },
+	{ 4, 650, 0 },
+	{ 8, 200, 100 },
+	{ 1, 400, 250 },
+};
+
+static const uint32_t buttonPins[] = { 6, 7, 10, 11 };
+
+static GP2040 * gp2040;
+static uint32_t button = 0;
+static uint64_t reportsSeen = 0;
+static uint32_t widestGuard = 0;
+
+// One pass of the loop, the time runOnce took on the simulated clock
+static uint64_t loopOnce() {
+	uint64_t start = hostTimeNs();
+	gp2040->runOnce();
+	uint64_t spentNs = hostTimeNs() - start;
+	widestGuard = std::max(widestGuard, USBReportScheduler::getInstance().getGuard());
+
+	// A different button as soon as the host has the report, so the next window has something new to send
+	if (hostUSBReportCount() != reportsSeen) {
+		reportsSeen = hostUSBReportCount();
+		button = (button + 1) % (sizeof(buttonPins) / sizeof(buttonPins[0]));
+		hostGpioSetInputs(~(1u << buttonPins[button]));
+	}
+
+	hostTimeAdvanceUs(LOOP_US);
+	return spentNs;
+}
+
+static void runPolls(const Schedule & schedule, uint32_t polls, uint64_t & worstLoopNs) {
+	uint64_t endNs = hostTimeNs() + (uint64_t)polls * schedule.interval * USB_FRAME_US * 1000;
+	while (hostTimeNs() < endNs)
+		worstLoopNs = std::max(worstLoopNs, loopOnce());
+}
+
+int main() {
+	hostTimeSetManual(true);
+	hostGpioSetInputs(0xffffffff);
+
+	// Same bring-up as GP2040::run() with SOF sync on, which never returns
+	gp2040 = new GP2040();
+	gp2040->setup();
+	GamepadOptions & options = Storage::getInstance().getGamepadOptions();
+	options.debounceDelay = 0;
+	options.debounceReleaseDelay = 0;
+	DriverManager::getInstance().getDriver()->set_sof_callback(USBReportScheduler::sofCallback);
+	tud_init(TUD_OPT_RHPORT);
+
+	// Loop time with the scheduler still off, what is left over with it on is spinning for the window
+	uint64_t baselineNs = 0;
+	hostUSBSetPollSchedule(1, 500, 0);
+	runPolls(schedules[0], SETTLE_POLLS, baselineNs);
+
+	USBReportScheduler & scheduler = USBReportScheduler::getInstance();
+	scheduler.start(TUD_OPT_RHPORT, DriverManager::getInstance().getDriver()->get_descriptor_configuration_cb(0));
+	CHECK(scheduler.isEnabled());
+
+	printf("loop %.1fus without the scheduler, spin cap %dus\n", baselineNs / 1000.0, USB_SCHEDULER_MAX_SPIN_US);
+	printf("  %-8s %6s %7s %8s %8s %7s %7s %7s %7s %8s %8s %7s %7s %7s\n", "bInterval", "phase", "jitter", "learned",
+		"phase", "misses", "guard", "widest", "to", "reports", "lead us", "worst", "late", "spin");
+
+	bool first = true;
+	for (const Schedule & schedule : schedules) {
+		hostUSBSetPollSchedule(schedule.interval, schedule.phaseUs, schedule.jitterUs);
+		uint32_t guardBefore = scheduler.getGuard();
+		widestGuard = guardBefore;
+		uint32_t settleMisses = scheduler.getMisses();
+		uint64_t worstLoopNs = 0;
+		runPolls(schedule, SETTLE_POLLS, worstLoopNs);
+		settleMisses = scheduler.getMisses() - settleMisses;
+		uint32_t guardSettled = scheduler.getGuard();
+		uint32_t settleGuard = widestGuard;
+
+		hostUSBLog().clear();
+		hostUSBSetLogging(true);
+		uint32_t missesBefore = scheduler.getMisses();
+		uint32_t intervalWrong = 0;
+		widestGuard = scheduler.getGuard();
+		uint64_t endNs = hostTimeNs() + (uint64_t)MEASURE_POLLS * schedule.interval * USB_FRAME_US * 1000;
+		while (hostTimeNs() < endNs) {
+			worstLoopNs = std::max(worstLoopNs, loopOnce());
+			if (scheduler.getPollInterval() != schedule.interval)
+				intervalWrong++;
+		}
+		hostUSBSetLogging(false);
+		uint32_t misses = scheduler.getMisses() - missesBefore;
+
+		// Each report waits on the endpoint from when it was built until the IN token takes it: the guard, give or
+		// take where the token lands in its jitter
+		uint64_t windowNs = (widestGuard + schedule.jitterUs + PHASE_SLACK_US + LOOP_US) * 1000ull + baselineNs;
+		uint32_t reports = hostUSBLog().size();
+		uint32_t late = 0;
+		uint64_t leadNs = 0;
+		uint64_t worstLeadNs = 0;
+		for (const HostUSBReport & report : hostUSBLog()) {
+			uint64_t lead = report.timeNs - report.queuedNs;
+			leadNs += lead;
+			worstLeadNs = std::max(worstLeadNs, lead);
+			if (lead > windowNs)
+				late++;
+		}
+
+		uint32_t expectedPhase = schedule.phaseUs + schedule.jitterUs / 2;
+		uint32_t phaseError = abs((int)scheduler.getPollPhase() - (int)expectedPhase);
+		uint64_t spinNs = worstLoopNs > baselineNs ? worstLoopNs - baselineNs : 0;
+		printf("  %-8u %6u %7u %8u %8u %7u %7u %7u %7u %8u %8.1f %7.1f %7u %7.1f\n", schedule.interval,
+			schedule.phaseUs, schedule.jitterUs, scheduler.getPollInterval(), scheduler.getPollPhase(), settleMisses,
+			guardBefore, settleGuard, scheduler.getGuard(), reports, reports ? leadNs / 1000.0 / reports : 0.0, worstLeadNs / 1000.0, late,
+			spinNs / 1000.0);
+
+		CHECK_EQ(intervalWrong, 0);
+		CHECK(phaseError <= schedule.jitterUs / 2 + PHASE_SLACK_US);
+		// Every poll took a new report, built in the window just before its IN token
+		CHECK(reports >= MEASURE_POLLS - 2);
+		CHECK(late * LATE_ONE_IN <= reports);
+		CHECK(misses * LATE_ONE_IN <= reports);
+		CHECK(worstLoopNs <= baselineNs + (USB_SCHEDULER_MAX_SPIN_US + SPIN_SLACK_US) * 1000ull);
+
+		// Polls missed while the model catches up widen the guard, on time reports narrow it again
+		CHECK(scheduler.getGuard() >= USB_SCHEDULER_GUARD_MIN_US && scheduler.getGuard() <= USB_SCHEDULER_GUARD_MAX_US);
+		if (settleMisses > 0)
+			CHECK(settleGuard == USB_SCHEDULER_GUARD_MAX_US || settleGuard >= guardBefore + USB_SCHEDULER_GUARD_MISS_STEP_US);
+		if (misses == 0)
+			CHECK(scheduler.getGuard() < guardSettled || scheduler.getGuard() == USB_SCHEDULER_GUARD_MIN_US);
+		if (first)
+			CHECK(scheduler.getGuard() < USB_SCHEDULER_GUARD_START_US);
+		first = false;
+	}
+
+	return hostTestResult("test_usb_report_scheduler");
+}
@@ -0,0 +1,105 @@
+#!/usr/bin/env python3
+#
+# Host stand-in for pioasm. The simulated PIO never executes instructions, so this only
+# emits what C code uses from a generated header: the public defines, the program length
+# and wrap points, the default state machine config and the "% c-sdk" blocks.
+#
+# usage: pio_header.py <input.pio> <output.h>
+
+import os
+import re
+import sys
+
+
+def parse(path):
+    programs = []
+    program = None
+    in_block = False
+    with open(path) as f:
+        for raw in f:
+            line = raw.rstrip('\n')
+            if in_block:
+                if line.strip().startswith('%}'):
+                    in_block = False
+                else:
+                    program['blocks'].append(line)
+                continue
+            code = re.split(r';|//', line, 1)[0].strip()
+            if not code:
+                continue
+            if code.startswith('%'):
+                in_block = code.split()[1:2] == ['c-sdk']
+                if not in_block:
+                    # skip blocks for other languages
+                    for skipped in f:
+                        if skipped.strip().startswith('%}'):
+                            break
+                continue
+            words = code.split()
+            if words[0] == '.program':
+                program = {'name': words[1], 'length': 0, 'wrap_target': None, 'wrap': None,
+                           'sideset': None, 'defines': [], 'blocks': []}
+                programs.append(program)
+            elif words[0] == '.define':
+                public = words[1] == 'public'
+                if public:
+                    name, value = words[2], ' '.join(words[3:])
+                    if program is None:
+                        raise SystemExit('%s: public define outside a program' % path)
+                    program['defines'].append((name, value))
+            elif words[0] == '.side_set':
+                program['sideset'] = (int(words[1]), 'opt' in words[2:], 'pindirs' in words[2:])
+            elif words[0] == '.wrap_target':
+                program['wrap_target'] = program['length']
+            elif words[0] == '.wrap':
+                program['wrap'] = program['length'] - 1
+            elif words[0].startswith('.'):
+                continue
+            else:
+                # a label may share the line with an instruction
+                rest = code.split(':', 1)[1].strip() if re.match(r'^(public\s+)?\w+:', code) else code
+                if rest:
+                    program['length'] += 1
+    return programs
+
+
+def main():
+    source, output = sys.argv[1], sys.argv[2]
+    out = ['// Generated by host/tools/pio_header.py from %s, do not edit' % source.split('/')[-1],
+           '', '#pragma once', '', '#include "hardware/pio.h"', '']
+    for p in parse(source):
+        name = p['name']
+        wrap_target = p['wrap_target'] if p['wrap_target'] is not None else 0
+        wrap = p['wrap'] if p['wrap'] is not None else p['length'] - 1
+        out.append('#define %s_wrap_target %d' % (name, wrap_target))
+        out.append('#define %s_wrap %d' % (name, wrap))
+        for define, value in p['defines']:
+            out.append('#define %s_%s %s' % (name, define, value))
+        out.append('')
+        out.append('static const uint16_t %s_program_instructions[%d] = { 0 };' % (name, p['length']))
+        out.append('')
+        out.append('static const struct pio_program %s_program = {' % name)
+        out.append('    .instructions = %s_program_instructions,' % name)
+        out.append('    .length = %d,' % p['length'])
+        out.append('    .origin = -1,')
+        out.append('};')
+        out.append('')
+        out.append('static inline pio_sm_config %s_program_get_default_config(uint offset) {' % name)
+        out.append('    pio_sm_config c = pio_get_default_sm_config();')
+        out.append('    sm_config_set_wrap(&c, offset + %s_wrap_target, offset + %s_wrap);' % (name, name))
+        if p['sideset'] is not None:
+            bits, optional, pindirs = p['sideset']
+            out.append('    sm_config_set_sideset(&c, %d, %s, %s);' % (bits + (1 if optional else 0),
+                       'true' if optional else 'false', 'true' if pindirs else 'false'))
+        out.append('    return c;')
+        out.append('}')
+        out.append('')
+        out.extend(p['blocks'])
+        out.append('')
+    os.makedirs(os.path.dirname(os.path.abspath(output)), exist_ok=True)
+    with open(output, 'w') as f:
+        f.write('\n'.join(out) + '\n')
+
+
+if __name__ == '__main__':
+    main()
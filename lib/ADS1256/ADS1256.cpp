@@ -13,6 +13,7 @@ Special thanks to Abraão Queiroz for spending time on the code and suggesting c
 #include "ADS1256.h"
 #include <cstdio>
 #include <math.h>
+#include "hardware/irq.h"
 #include "hardware/sync.h"
 #include "pico.h"
 #include "pico/stdlib.h"
@@ -30,6 +31,8 @@ Special thanks to Abraão Queiroz for spending time on the code and suggesting c
 #define bitWrite(value, bit, bitvalue) (bitvalue ? bitSet(value, bit) : bitClear(value, bit))
 #endif
 
+ADS1256 *ADS1256::_acquisition = nullptr;
+
 // A function that waits for the DRDY status to change
 void ADS1256::waitForDRDY() {
     while (gpio_get(_DRDY_pin));
@@ -89,6 +92,10 @@ void ADS1256::init(uint8_t drate, uint8_t pga, bool useBuf) {
     _SPI->deselect();
     _SPI->endTransaction();
 
+    for (uint8_t channel = 0; channel < ADS1256_CHANNEL_COUNT; channel++) {
+        _channelRate[channel] = drate;
+    }
+
     _isAcquisitionRunning = false; // MCU will be waiting to start a continuous acquisition
 }
 
@@ -405,6 +412,15 @@ float ADS1256::convertToVoltage(int32_t rawData) {
     return (voltage);
 }
 
+// Converting a voltage back into a 24-bit reading
+int32_t ADS1256::convertToCode(float voltage) {
+    float code = voltage * (1 << _PGA) * 8388607 / (2 * _VREF);
+
+    if (code >= 8388607.0f) return 8388607;
+    if (code <= -8388608.0f) return -8388608;
+    return (int32_t)code;
+}
+
 void ADS1256::writeRegister(uint8_t registerAddress, uint8_t registerValueToWrite) {
     waitForDRDY();
 
@@ -730,3 +746,216 @@ uint32_t ADS1256::cycleDifferential() {
 
     return _outputValue;
 }
+
+void ADS1256::setChannelRate(uint8_t channel, uint8_t drate) {
+    if (channel < ADS1256_CHANNEL_COUNT) {
+        _channelRate[channel] = drate;
+    }
+}
+
+void ADS1256::startAcquisition(uint8_t channelCount) {
+    if (_acquisition != nullptr || channelCount == 0) {
+        return;
+    }
+    if (channelCount > ADS1256_CHANNEL_COUNT) {
+        channelCount = ADS1256_CHANNEL_COUNT;
+    }
+    _channelCount = channelCount;
+
+    // Pre-build the command selecting each channel, DRATE is only rewritten when
+    // it differs from the channel converted before it
+    for (uint8_t channel = 0; channel < _channelCount; channel++) {
+        uint8_t previous = (channel == 0 ? _channelCount : channel) - 1;
+        uint8_t *command = _command[channel];
+        uint8_t length = 0;
+
+        command[length++] = ADS1256_CMD_WREG | ADS1256_REG_MUX;
+        if (_channelRate[channel] != _channelRate[previous]) {
+            command[length++] = 2; // MUX, ADCON, DRATE
+            command[length++] = (channel << 4) | 0x0F; // Ax + AINCOM
+            command[length++] = _ADCON;
+            command[length++] = _channelRate[channel];
+        } else {
+            command[length++] = 0; // MUX only
+            command[length++] = (channel << 4) | 0x0F;
+        }
+        command[length++] = ADS1256_CMD_SYNC;
+        command[length++] = ADS1256_CMD_WAKEUP;
+        command[length++] = ADS1256_CMD_RDATA;
+        _commandLength[channel] = length;
+    }
+
+    _front = 0;
+    _sweeps = 0;
+    _phase = ADS1256_PHASE_IDLE;
+
+    _dmaTx = dma_claim_unused_channel(true);
+    _dmaRx = dma_claim_unused_channel(true);
+    irq_add_shared_handler(ADS1256_DMA_IRQ, dmaIRQ, PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY);
+    irq_set_enabled(ADS1256_DMA_IRQ, true);
+    if (ADS1256_DMA_IRQ == DMA_IRQ_0) {
+        dma_channel_set_irq0_enabled(_dmaRx, true);
+    } else {
+        dma_channel_set_irq1_enabled(_dmaRx, true);
+    }
+
+    // Select the first channel with its own rate and restart the conversion,
+    // CS then stays low for as long as the acquisition runs
+    waitForDRDY();
+    _SPI->beginTransaction(_SPISpeed, _SPIBitOrder, _SPIMode);
+    _SPI->select(_CS_pin);
+    _SPI->transfer(ADS1256_CMD_WREG | ADS1256_REG_MUX);
+    _SPI->transfer(2);
+    _SPI->transfer(ADS1256_SING_0);
+    _SPI->transfer(_ADCON);
+    _SPI->transfer(_channelRate[0]);
+    _SPI->transfer(ADS1256_CMD_SYNC);
+    _SPI->transfer(ADS1256_CMD_WAKEUP);
+    _readChannel = 0;
+    _nextChannel = 1 % _channelCount;
+    _isAcquisitionRunning = true;
+
+    _acquisition = this;
+    gpio_add_raw_irq_handler(_DRDY_pin, drdyIRQ);
+    gpio_acknowledge_irq(_DRDY_pin, GPIO_IRQ_EDGE_FALL);
+    gpio_set_irq_enabled(_DRDY_pin, GPIO_IRQ_EDGE_FALL, true);
+    irq_set_enabled(IO_IRQ_BANK0, true);
+}
+
+void ADS1256::stopAcquisition() {
+    if (_acquisition != this) {
+        return;
+    }
+
+    gpio_set_irq_enabled(_DRDY_pin, GPIO_IRQ_EDGE_FALL, false);
+    gpio_remove_raw_irq_handler(_DRDY_pin, drdyIRQ);
+
+    // Let a read in flight finish, but don't hang on a DMA or alarm that never completes
+    absolute_time_t timeout = make_timeout_time_us(ADS1256_STOP_TIMEOUT_US);
+    while (_phase != ADS1256_PHASE_IDLE && !time_reached(timeout)) {
+        tight_loop_contents();
+    }
+    if (_phase != ADS1256_PHASE_IDLE) {
+        if (_t6AlarmId > 0) {
+            cancel_alarm(_t6AlarmId);
+        }
+        dma_channel_abort(_dmaTx);
+        dma_channel_abort(_dmaRx);
+        _phase = ADS1256_PHASE_IDLE;
+    }
+
+    irq_remove_handler(ADS1256_DMA_IRQ, dmaIRQ);
+    dma_channel_set_irq0_enabled(_dmaRx, false);
+    dma_channel_set_irq1_enabled(_dmaRx, false);
+    dma_channel_unclaim(_dmaTx);
+    dma_channel_unclaim(_dmaRx);
+    _dmaTx = -1;
+    _dmaRx = -1;
+    _acquisition = nullptr;
+
+    _SPI->deselect();
+    _SPI->endTransaction();
+    _isAcquisitionRunning = false;
+}
+
+void ADS1256::getResults(uint32_t *results, uint8_t count) {
+    const volatile uint32_t *front = _results[_front];
+    if (count > ADS1256_CHANNEL_COUNT) {
+        count = ADS1256_CHANNEL_COUNT;
+    }
+    for (uint8_t i = 0; i < count; i++) {
+        results[i] = front[i];
+    }
+}
+
+// Clock count bytes through the SPI FIFOs with DMA, RX completion raises the DMA IRQ
+void ADS1256::startTransfer(const uint8_t *tx, bool txIncrement, uint8_t *rx, bool rxIncrement, uint8_t count) {
+    spi_inst_t *spi = _SPI->getController();
+
+    dma_channel_config rxConfig = dma_channel_get_default_config(_dmaRx);
+    channel_config_set_transfer_data_size(&rxConfig, DMA_SIZE_8);
+    channel_config_set_dreq(&rxConfig, spi_get_dreq(spi, false));
+    channel_config_set_read_increment(&rxConfig, false);
+    channel_config_set_write_increment(&rxConfig, rxIncrement);
+    dma_channel_configure(_dmaRx, &rxConfig, rx, &spi_get_hw(spi)->dr, count, true);
+
+    dma_channel_config txConfig = dma_channel_get_default_config(_dmaTx);
+    channel_config_set_transfer_data_size(&txConfig, DMA_SIZE_8);
+    channel_config_set_dreq(&txConfig, spi_get_dreq(spi, true));
+    channel_config_set_read_increment(&txConfig, txIncrement);
+    channel_config_set_write_increment(&txConfig, false);
+    dma_channel_configure(_dmaTx, &txConfig, &spi_get_hw(spi)->dr, tx, count, true);
+}
+
+// DRDY fell: switch the MUX to the next channel and request the finished conversion
+void ADS1256::sendCommand() {
+    _phase = ADS1256_PHASE_COMMAND;
+    startTransfer(_command[_nextChannel], true, &_dmaSink, false, _commandLength[_nextChannel]);
+}
+
+// The 24-bit result landed in the output buffer: store it and move to the next channel
+void ADS1256::finishRead() {
+    uint8_t back = _front ^ 1;
+    _results[back][_readChannel] = ((uint32_t)_outputBuffer[0] << 16) | ((uint32_t)_outputBuffer[1] << 8) | (_outputBuffer[2]);
+
+    if (_readChannel == _channelCount - 1) {
+        _front = back;
+        _sweeps++;
+    }
+
+    _readChannel = _nextChannel;
+    _nextChannel = (_nextChannel + 1) % _channelCount;
+    _phase = ADS1256_PHASE_IDLE;
+}
+
+void ADS1256::drdyIRQ() {
+    ADS1256 *ads = _acquisition;
+    if (ads == nullptr || !(gpio_get_irq_event_mask(ads->_DRDY_pin) & GPIO_IRQ_EDGE_FALL)) {
+        return;
+    }
+    gpio_acknowledge_irq(ads->_DRDY_pin, GPIO_IRQ_EDGE_FALL);
+
+    // Between DRDY and SYNC the converter keeps free-running on the channel being left, a
+    // fall during a transfer is one of those and the SYNC/WAKEUP already on the wire supersedes it.
+    // The next channel's conversion needs its full settling time, well past the end of the read.
+    if (ads->_phase == ADS1256_PHASE_IDLE) {
+        ads->sendCommand();
+    }
+}
+
+void ADS1256::dmaIRQ() {
+    ADS1256 *ads = _acquisition;
+    if (ads == nullptr) {
+        return;
+    }
+
+    if (ADS1256_DMA_IRQ == DMA_IRQ_0) {
+        if (!dma_channel_get_irq0_status(ads->_dmaRx)) return;
+        dma_channel_acknowledge_irq0(ads->_dmaRx);
+    } else {
+        if (!dma_channel_get_irq1_status(ads->_dmaRx)) return;
+        dma_channel_acknowledge_irq1(ads->_dmaRx);
+    }
+
+    if (ads->_phase == ADS1256_PHASE_COMMAND) {
+        ads->_phase = ADS1256_PHASE_T6;
+        ads->_t6AlarmId = add_alarm_in_us(ADS1256_T6_US, t6Alarm, ads, true);
+        if (ads->_t6AlarmId < 0) {
+            // No alarm slot free, wait out t6 here instead
+            busy_wait_us_32(ADS1256_T6_US);
+            t6Alarm(0, ads);
+        }
+    } else if (ads->_phase == ADS1256_PHASE_DATA) {
+        ads->finishRead();
+    }
+}
+
+int64_t ADS1256::t6Alarm(alarm_id_t id, void *user_data) {
+    static const uint8_t zero = 0;
+    ADS1256 *ads = (ADS1256 *)user_data;
+
+    ads->_t6AlarmId = 0;
+    ads->_phase = ADS1256_PHASE_DATA;
+    ads->startTransfer(&zero, false, ads->_outputBuffer, true, 3);
+    return 0;
+}
@@ -14,6 +14,7 @@
 #define _ADS1256_h
 
 #include "peripheral_spi.h"
+#include "pico/time.h"
 
 #define ADS1256_MAX_3V 3.3f
 #define ADS1256_MAX_5V 5.0f
@@ -38,6 +39,24 @@
 #define ADS1256_SPI_BIT_ORDER spi_order_t::SPI_MSB_FIRST
 #endif
 
+/**************************************
+ * Background acquisition
+ **************************************/
+
+#ifndef ADS1256_T6_US
+#define ADS1256_T6_US 7 // t6, DIN to DOUT delay after RDATA (~6.51 us)
+#endif
+
+#ifndef ADS1256_DMA_IRQ
+#define ADS1256_DMA_IRQ DMA_IRQ_1
+#endif
+
+#ifndef ADS1256_STOP_TIMEOUT_US
+#define ADS1256_STOP_TIMEOUT_US 1000 // longest stopAcquisition() waits for a read in flight
+#endif
+
+#define ADS1256_COMMAND_MAX 8 // WREG MUX/ADCON/DRATE + SYNC + WAKEUP + RDATA
+
 /**************************************
  * Differential inputs
  **************************************/
@@ -189,12 +208,39 @@ public:
     // Converts the reading into a voltage value
     float convertToVoltage(int32_t rawData);
 
+    // Converts a voltage into the matching 24-bit reading, saturated at positive full scale
+    int32_t convertToCode(float voltage);
+
     // Stop AD
     void stopConversion();
 
+    // Data rate used for a single-ended input by the background acquisition (defaults to the init() rate)
+    void setChannelRate(uint8_t channel, uint8_t drate);
+
+    // Cycle the first channelCount single-ended inputs in the background: DRDY interrupt,
+    // SPI DMA for the command and data phases, results double buffered per sweep
+    void startAcquisition(uint8_t channelCount);
+    void stopAcquisition();
+    bool isAcquisitionRunning() { return _acquisition == this; }
+
+    // Copy the raw 24-bit readings of the last complete sweep
+    void getResults(uint32_t *results, uint8_t count);
+
+    // Number of complete sweeps so far
+    uint32_t getSweepCount() { return _sweeps; }
+
 private:
     void waitForDRDY();
 
+    // Background acquisition steps, all run from interrupts
+    static ADS1256 *_acquisition;
+    static void drdyIRQ();
+    static void dmaIRQ();
+    static int64_t t6Alarm(alarm_id_t id, void *user_data);
+    void startTransfer(const uint8_t *tx, bool txIncrement, uint8_t *rx, bool rxIncrement, uint8_t count);
+    void sendCommand();
+    void finishRead();
+
     PeripheralSPI *_SPI;
 
     float _VREF; // Value of the reference voltage
@@ -228,6 +274,29 @@ private:
     // uint32_t _outputValue;      // Combined value of the _outputBuffer[3]
     bool _isAcquisitionRunning; // bool that keeps track of the acquisition (running or not)
     uint8_t _cycle;             // Tracks the cycles as the MUX is cycling through the input channels
+
+    // Background acquisition state
+    enum AcquisitionPhase : uint8_t {
+        ADS1256_PHASE_IDLE,     // waiting for DRDY
+        ADS1256_PHASE_COMMAND,  // MUX/DRATE write, SYNC, WAKEUP, RDATA on the wire
+        ADS1256_PHASE_T6,       // waiting out t6 before clocking the data
+        ADS1256_PHASE_DATA,     // 24-bit result on the wire
+    };
+
+    uint8_t _channelRate[ADS1256_CHANNEL_COUNT];
+    uint8_t _command[ADS1256_CHANNEL_COUNT][ADS1256_COMMAND_MAX]; // command selecting each channel
+    uint8_t _commandLength[ADS1256_CHANNEL_COUNT];
+    uint8_t _channelCount = 0;
+    uint8_t _readChannel = 0;   // channel converting when DRDY fires
+    uint8_t _nextChannel = 0;   // channel selected by the next command
+    int _dmaTx = -1;
+    int _dmaRx = -1;
+    uint8_t _dmaSink = 0;
+    volatile AcquisitionPhase _phase = ADS1256_PHASE_IDLE;
+    volatile alarm_id_t _t6AlarmId = 0;
+    volatile uint32_t _results[2][ADS1256_CHANNEL_COUNT] = {};
+    volatile uint8_t _front = 0;
+    volatile uint32_t _sweeps = 0;
 };
 
 #endif
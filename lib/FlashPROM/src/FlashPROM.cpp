@@ -4,50 +4,409 @@
  */
 
 #include "FlashPROM.h"
+#include "CRC32.h"
 
-uint8_t FlashPROM::writeCache[EEPROM_SIZE_BYTES];
-volatile static alarm_id_t flashWriteAlarm = 0;
+#include <stddef.h>
+
+#define RECORD_MAGIC 0x4c4f4750 // "PGOL"
+#define NO_RECORD    EEPROM_SIZE_BYTES
+
+uint8_t FlashPROM::writeCache[EEPROM_RECORD_MAX_BYTES];
+static uint8_t overlayCache[EEPROM_OVERLAY_MAX_BYTES];
 volatile static spin_lock_t *flashLock = nullptr;
 
-int64_t writeToFlash(alarm_id_t id, void *flashCache)
+// Newest record in flash, the log continues after it
+static uint32_t recordOffset = NO_RECORD;
+static uint32_t recordSequence = 0;
+static uint32_t recordSize = 0;
+
+// Current base record and the overlay on top of it, an overlay of size 0 is the same as none
+static uint32_t baseOffset = NO_RECORD;
+static uint32_t baseSize = 0;
+static uint32_t baseCrc = 0;
+static uint32_t overlayOffset = NO_RECORD;
+static uint32_t overlaySize = 0;
+static uint32_t overlayCrc = 0;
+
+// Write flash will do on the next flush
+enum QueuedWrite
 {
-	while (is_spin_locked(flashLock));
+	QUEUED_NONE,
+	QUEUED_BASE,
+	QUEUED_OVERLAY,
+	QUEUED_RESET,
+};
 
-	multicore_lockout_start_blocking();
-	uint32_t interrupts = spin_lock_blocking(flashLock);
+static QueuedWrite queuedWrite = QUEUED_NONE;
+static uint32_t queuedSize = 0;
+static uint32_t queuedCrc = 0;
 
-	flash_range_erase((intptr_t)EEPROM_ADDRESS_START - (intptr_t)XIP_BASE, EEPROM_SIZE_BYTES);
-	flash_range_program((intptr_t)EEPROM_ADDRESS_START - (intptr_t)XIP_BASE, reinterpret_cast<uint8_t *>(flashCache), EEPROM_SIZE_BYTES);
+static FlashCommitStats commitStats = {};
 
-	flashWriteAlarm = 0;
+static inline uint32_t millis()
+{
+	return time_us_64() / 1000;
+}
 
-	multicore_lockout_end_blocking();
-	spin_unlock(flashLock, interrupts);
+static inline uint32_t alignUp(uint32_t value, uint32_t alignment)
+{
+	return (value + alignment - 1) & ~(alignment - 1);
+}
+
+static inline uint32_t recordLength(uint32_t size)
+{
+	return alignUp(sizeof(FlashRecordHeader) + size, FLASH_PAGE_SIZE);
+}
+
+static inline const FlashRecordHeader* headerAt(uint32_t offset)
+{
+	return reinterpret_cast<const FlashRecordHeader*>(EEPROM_ADDRESS_START + offset);
+}
+
+static inline uint32_t headerCrc(const FlashRecordHeader& header)
+{
+	return CRC32::calculate(reinterpret_cast<const uint8_t*>(&header), offsetof(FlashRecordHeader, headerCrc));
+}
+
+static bool isHeader(uint32_t offset)
+{
+	const FlashRecordHeader& header = *headerAt(offset);
+	return header.magic == RECORD_MAGIC &&
+		header.size <= EEPROM_RECORD_MAX_BYTES &&
+		offset + recordLength(header.size) <= EEPROM_SIZE_BYTES &&
+		header.headerCrc == headerCrc(header);
+}
+
+static bool isBlank(uint32_t offset, uint32_t length)
+{
+	const uint32_t* words = reinterpret_cast<const uint32_t*>(EEPROM_ADDRESS_START + offset);
+	for (uint32_t i = 0; i < length / sizeof(uint32_t); i++)
+	{
+		if (words[i] != 0xFFFFFFFF)
+			return false;
+	}
+	return true;
+}
+
+static void eraseSector(uint32_t offset)
+{
+	if (!isBlank(offset, FLASH_SECTOR_SIZE))
+		flash_range_erase((intptr_t)EEPROM_ADDRESS_START - (intptr_t)XIP_BASE + offset, FLASH_SECTOR_SIZE);
+}
+
+static void programPages(uint32_t offset, const uint8_t* data, uint32_t length)
+{
+	flash_range_program((intptr_t)EEPROM_ADDRESS_START - (intptr_t)XIP_BASE + offset, data, length);
+}
+
+// Where the next record of the given length goes
+static uint32_t nextOffset(uint32_t length)
+{
+	uint32_t offset = (recordOffset == NO_RECORD) ? 0 : recordOffset + recordLength(recordSize);
+
+	// The rest of a partly used sector can only be appended to while it is still blank
+	if (offset % FLASH_SECTOR_SIZE != 0)
+	{
+		uint32_t sectorEnd = alignUp(offset, FLASH_SECTOR_SIZE);
+		if (offset + length > EEPROM_SIZE_BYTES || !isBlank(offset, sectorEnd - offset))
+			offset = sectorEnd;
+	}
+	if (offset + length > EEPROM_SIZE_BYTES)
+		offset = 0;
+
+	return offset;
+}
+
+// Whether a record at offset lands after the current base and its overlays, in the same half
+static bool fitsBehindBase(uint32_t offset, uint32_t length)
+{
+	const uint32_t halfEnd = (baseOffset < EEPROM_HALF_BYTES) ? EEPROM_HALF_BYTES : EEPROM_SIZE_BYTES;
+	return offset >= baseOffset && offset + length <= halfEnd;
+}
+
+// Where the next base record of the given length goes, without erasing the current base or its overlays
+static uint32_t nextBaseOffset(uint32_t length)
+{
+	uint32_t offset = nextOffset(length);
+
+	if (baseOffset == NO_RECORD)
+	{
+		if (offset < EEPROM_HALF_BYTES && offset + length > EEPROM_HALF_BYTES)
+			offset = EEPROM_HALF_BYTES;
+	}
+	else if (!fitsBehindBase(offset, length))
+	{
+		// Everything current sits in the base's half, the other one only holds stale records
+		offset = (baseOffset < EEPROM_HALF_BYTES) ? EEPROM_HALF_BYTES : 0;
+	}
+
+	return offset;
+}
+
+static void appendRecord(FlashRecordType type, uint8_t* data, uint32_t size, uint32_t crc)
+{
+	const uint32_t length = recordLength(size);
+	const uint32_t offset = (type == FLASH_RECORD_BASE) ? nextBaseOffset(length) : nextOffset(length);
+
+	// Erase the sectors the record runs into, none of them hold the current base or its overlays
+	for (uint32_t sector = alignUp(offset, FLASH_SECTOR_SIZE); sector < offset + length; sector += FLASH_SECTOR_SIZE)
+		eraseSector(sector);
+
+	FlashRecordHeader header;
+	header.magic = RECORD_MAGIC;
+	header.sequence = recordSequence + 1;
+	header.type = type;
+	header.size = size;
+	header.dataCrc = crc;
+	header.headerCrc = headerCrc(header);
+
+	// The header page shares its space with the start of the data
+	static uint8_t headerPage[FLASH_PAGE_SIZE];
+	const uint32_t headerData = FLASH_PAGE_SIZE - sizeof(FlashRecordHeader);
+	memset(data + size, 0xFF, length - sizeof(FlashRecordHeader) - size);
+	memcpy(headerPage, &header, sizeof(FlashRecordHeader));
+	memcpy(headerPage + sizeof(FlashRecordHeader), data, headerData);
+
+	// Program the data first and the header last, a record only becomes valid once it is complete
+	if (length > FLASH_PAGE_SIZE)
+		programPages(offset + FLASH_PAGE_SIZE, data + headerData, length - FLASH_PAGE_SIZE);
+	programPages(offset, headerPage, FLASH_PAGE_SIZE);
+
+	recordOffset = offset;
+	recordSequence = header.sequence;
+	recordSize = size;
+}
 
-	return 0;
+static void clearOverlay()
+{
+	overlayOffset = NO_RECORD;
+	overlaySize = 0;
+	overlayCrc = CRC32::calculate(overlayCache, 0);
 }
 
+static void writeQueued()
+{
+	switch (queuedWrite)
+	{
+		case QUEUED_RESET:
+			for (uint32_t sector = 0; sector < EEPROM_SIZE_BYTES; sector += FLASH_SECTOR_SIZE)
+				eraseSector(sector);
+			recordOffset = NO_RECORD;
+			recordSize = 0;
+			baseOffset = NO_RECORD;
+			baseSize = 0;
+			baseCrc = 0;
+			clearOverlay();
+			break;
+		case QUEUED_BASE:
+			appendRecord(FLASH_RECORD_BASE, FlashPROM::writeCache, queuedSize, queuedCrc);
+			baseOffset = recordOffset;
+			baseSize = queuedSize;
+			baseCrc = queuedCrc;
+			clearOverlay();
+			break;
+		case QUEUED_OVERLAY:
+			appendRecord(FLASH_RECORD_OVERLAY, overlayCache, queuedSize, queuedCrc);
+			overlayOffset = recordOffset;
+			overlaySize = queuedSize;
+			overlayCrc = queuedCrc;
+			break;
+		default:
+			break;
+	}
+	queuedWrite = QUEUED_NONE;
+}
+
+// Queue a write, replacing whatever was queued before
+static void queueWrite(QueuedWrite write, uint32_t size, uint32_t crc)
+{
+	const uint32_t now = millis();
+	if (queuedWrite == QUEUED_NONE)
+		commitStats.pendingSince = now;
+	commitStats.lastRequest = now;
+
+	queuedWrite = write;
+	queuedSize = size;
+	queuedCrc = crc;
+}
+
+/* Index the record headers. A record that fails its CRC (e.g. power was lost while it was written) is skipped in
+	favour of the next newest one. */
 void FlashPROM::start()
 {
 	if (flashLock == nullptr)
 		flashLock = spin_lock_instance(spin_lock_claim_unused(true));
 
-	memcpy(writeCache, reinterpret_cast<uint8_t *>(EEPROM_ADDRESS_START), EEPROM_SIZE_BYTES);
+	uint8_t indexPages[EEPROM_PAGE_COUNT];
+	uint32_t indexCount = 0;
+	uint32_t highestSequence = 0;
+
+	// Every page is checked, the length in a header whose record was cut short could skip over newer records
+	for (uint32_t offset = 0; offset < EEPROM_SIZE_BYTES; offset += FLASH_PAGE_SIZE)
+	{
+		if (isHeader(offset))
+		{
+			const FlashRecordHeader& header = *headerAt(offset);
+			indexPages[indexCount++] = offset / FLASH_PAGE_SIZE;
+			if (header.sequence > highestSequence)
+				highestSequence = header.sequence;
+		}
+	}
+
+	recordOffset = NO_RECORD;
+	recordSequence = highestSequence;
+	recordSize = 0;
+	baseOffset = NO_RECORD;
+	baseSize = 0;
+	baseCrc = 0;
+	clearOverlay();
+
+	// Walk back from the newest record to the current base, keeping the newest overlay found on the way
+	while (indexCount > 0)
+	{
+		uint32_t newest = 0;
+		for (uint32_t i = 1; i < indexCount; i++)
+		{
+			if (headerAt(indexPages[i] * FLASH_PAGE_SIZE)->sequence > headerAt(indexPages[newest] * FLASH_PAGE_SIZE)->sequence)
+				newest = i;
+		}
+
+		const uint32_t offset = indexPages[newest] * FLASH_PAGE_SIZE;
+		const FlashRecordHeader& header = *headerAt(offset);
+		if (CRC32::calculate(reinterpret_cast<const uint8_t*>(&header + 1), header.size) == header.dataCrc)
+		{
+			if (recordOffset == NO_RECORD)
+			{
+				recordOffset = offset;
+				recordSize = header.size;
+			}
+
+			if (header.type == FLASH_RECORD_BASE)
+			{
+				baseOffset = offset;
+				baseSize = header.size;
+				baseCrc = header.dataCrc;
+				break;
+			}
+
+			if (header.type == FLASH_RECORD_OVERLAY && overlayOffset == NO_RECORD && header.size <= EEPROM_OVERLAY_MAX_BYTES)
+			{
+				overlayOffset = offset;
+				overlaySize = header.size;
+				overlayCrc = header.dataCrc;
+			}
+		}
+
+		indexPages[newest] = indexPages[--indexCount];
+	}
+
+	// An overlay means nothing without its base
+	if (baseOffset == NO_RECORD)
+		clearOverlay();
+
+	queuedWrite = QUEUED_NONE;
+}
+
+const uint8_t * FlashPROM::read(uint32_t & size) const
+{
+	if (baseOffset == NO_RECORD)
+		return nullptr;
+
+	size = baseSize;
+	return reinterpret_cast<const uint8_t*>(headerAt(baseOffset) + 1);
+}
+
+const uint8_t * FlashPROM::readOverlay(uint32_t & size) const
+{
+	if (overlayOffset == NO_RECORD)
+		return nullptr;
+
+	size = overlaySize;
+	return reinterpret_cast<const uint8_t*>(headerAt(overlayOffset) + 1);
 }
 
 /* We don't have an actual EEPROM, so we need to be extra careful about minimizing writes. Instead
-	of writing when a commit is requested, we update a time to actually commit. That way, if we receive multiple requests
-	to commit in that timeframe, we'll hold off until the user is done sending changes. */
-void FlashPROM::commit()
+	of writing when a commit is requested, we only queue it and leave the write to flush(). That way, if we receive
+	multiple requests before then, only the last one is written. */
+bool FlashPROM::commit(uint32_t size)
 {
-	while (is_spin_locked(flashLock));
-	if (flashWriteAlarm != 0)
-		cancel_alarm(flashWriteAlarm);
-	flashWriteAlarm = add_alarm_in_ms(EEPROM_WRITE_WAIT, writeToFlash, writeCache, true);
+	if (size > EEPROM_RECORD_MAX_BYTES)
+		return false;
+
+	// Nothing to write when flash already holds (or is about to hold) the same data. A pending or written overlay
+	// is folded into the new base instead.
+	uint32_t crc = CRC32::calculate(writeCache, size);
+	if (queuedWrite == QUEUED_BASE && size == queuedSize && crc == queuedCrc)
+		return true;
+	if (queuedWrite == QUEUED_NONE && baseOffset != NO_RECORD && overlaySize == 0 && size == baseSize && crc == baseCrc)
+		return true;
+
+	queueWrite(QUEUED_BASE, size, crc);
+	return true;
+}
+
+bool FlashPROM::commitOverlay(const uint8_t * data, uint32_t size)
+{
+	if (size > EEPROM_OVERLAY_MAX_BYTES)
+		return false;
+
+	if (baseOffset == NO_RECORD || queuedWrite == QUEUED_BASE || queuedWrite == QUEUED_RESET)
+		return false;
+
+	uint32_t crc = CRC32::calculate(data, size);
+	if (queuedWrite == QUEUED_OVERLAY ? (size == queuedSize && crc == queuedCrc) : (size == overlaySize && crc == overlayCrc))
+		return true;
+
+	// A queued overlay is replaced, so the new one lands where the log currently ends. It has to stay in the
+	// base's half, where the next base write won't erase it before that base is complete.
+	const uint32_t length = recordLength(size);
+	if (!fitsBehindBase(nextOffset(length), length))
+		return false;
+
+	memcpy(overlayCache, data, size);
+	queueWrite(QUEUED_OVERLAY, size, crc);
+	return true;
 }
 
 void FlashPROM::reset()
 {
-	memset(writeCache, 0, EEPROM_SIZE_BYTES);
-	commit();
+	queueWrite(QUEUED_RESET, 0, 0);
+}
+
+void FlashPROM::flush()
+{
+	if (queuedWrite == QUEUED_NONE)
+		return;
+
+	const uint64_t start = time_us_64();
+
+	// Core1 has to stay off flash while it is written, before it is running there is nothing to lock out
+	const bool lockout = multicore_lockout_victim_is_initialized(1);
+	if (lockout)
+		multicore_lockout_start_blocking();
+	uint32_t interrupts = spin_lock_blocking(flashLock);
+
+	writeQueued();
+
+	if (lockout)
+		multicore_lockout_end_blocking();
+	spin_unlock(flashLock, interrupts);
+
+	const uint64_t end = time_us_64();
+	commitStats.lastCommit = end / 1000;
+	commitStats.lastDuration = end - start;
+	commitStats.lastDeferral = commitStats.lastCommit - commitStats.pendingSince;
+	commitStats.commitCount++;
+}
+
+bool FlashPROM::isPending() const
+{
+	return queuedWrite != QUEUED_NONE;
+}
+
+FlashCommitStats FlashPROM::getStats() const
+{
+	FlashCommitStats stats = commitStats;
+	stats.pending = isPending();
+	return stats;
 }
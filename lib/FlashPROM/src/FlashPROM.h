@@ -13,20 +13,91 @@
 #include <hardware/flash.h>
 #include <hardware/timer.h>
 
-#define EEPROM_SIZE_BYTES    0x8000           // Reserve 32k of flash memory (ensure this value is divisible by 256)
-#define EEPROM_ADDRESS_START _u(0x101F8000) // The arduino-pico EEPROM lib starts here, so we'll do the same
+#define EEPROM_SIZE_BYTES    0x10000          // Reserve 64k of flash memory (ensure this value is divisible by 8192)
+#define EEPROM_ADDRESS_START (XIP_BASE + 0x1F0000) // Ends where the 32k area from the arduino-pico EEPROM lib (0x101F8000) ended, so configs saved with a footer there are still found
+#define EEPROM_LEGACY_ADDRESS_START (XIP_BASE + 0x1F8000) // Start of that 32k area, where the legacy config structs were stored
 
-// Warning: If the write wait is too long it can stall other processes
-#define EEPROM_WRITE_WAIT    50             // Amount of time in ms to wait before blocking core1 and committing to flash
+// Commits are only queued in RAM. Core0 calls flush() to write them, which blocks core1 and stalls core0 for the
+// duration of the erase/program, so it waits for a quiet moment (see GP2040::checkFlashCommit) and flushes before a reboot.
+#define EEPROM_WRITE_WAIT    50             // Amount of time in ms since the last commit before the write may happen
+
+#ifndef EEPROM_IDLE_WAIT
+#define EEPROM_IDLE_WAIT     1000           // Amount of time in ms the inputs have to be unchanged before the write may happen
+#endif
+
+/*
+	Commits are appended to the reserved area as a log of page aligned records. A sector is only erased when the
+	log runs into it again, and the header page of a record is programmed last, so the previous record stays
+	readable until the new one is complete.
+
+	A base record holds the complete data. An overlay record is a single page of small changes on top of the base
+	before it; only the newest overlay that follows the current base is kept.
+
+	The current base and its overlays always share one half of the area, so a base record is at most half of it;
+	the area is sized so that a half holds the largest config.
+	A base that doesn't fit behind them goes to the start of the other half, and an overlay that doesn't fit
+	needs a full commit instead. Nothing current is erased before the record replacing it is complete.
+
+	┌────────┬──────────────┬────────┬───────────────────┬─────────────────┐
+	│Header 1│Data 1        │Header 2│Data 2             │Erased           │
+	└────────┴──────────────┴────────┴───────────────────┴─────────────────┘
+*/
+enum FlashRecordType : uint32_t
+{
+	FLASH_RECORD_BASE    = 0,
+	FLASH_RECORD_OVERLAY = 1,
+};
+
+struct FlashRecordHeader
+{
+	uint32_t magic;
+	uint32_t sequence;  // increases with every record, the highest valid one is current
+	uint32_t type;      // FlashRecordType
+	uint32_t size;      // bytes of data following the header
+	uint32_t dataCrc;
+	uint32_t headerCrc; // covers the fields above
+};
+
+#define EEPROM_SECTOR_COUNT     (EEPROM_SIZE_BYTES / FLASH_SECTOR_SIZE)
+#define EEPROM_PAGE_COUNT       (EEPROM_SIZE_BYTES / FLASH_PAGE_SIZE)
+#define EEPROM_HALF_BYTES       (EEPROM_SIZE_BYTES / 2)
+#define EEPROM_RECORD_MAX_BYTES (EEPROM_HALF_BYTES - sizeof(FlashRecordHeader))
+#define EEPROM_OVERLAY_MAX_BYTES (FLASH_PAGE_SIZE - sizeof(FlashRecordHeader))
+
+struct FlashCommitStats
+{
+	bool pending;
+	uint32_t pendingSince;  // ms since boot the queued write was first requested
+	uint32_t lastRequest;   // ms since boot of the latest commit request
+	uint32_t lastCommit;    // ms since boot the last write finished, 0 when nothing has been written since boot
+	uint32_t lastDuration;  // us the last write blocked the system
+	uint32_t lastDeferral;  // ms the last write waited in the queue
+	uint32_t commitCount;   // writes since boot
+};
 
 class FlashPROM
 {
 	public:
 		void start();
-		void commit();
+		bool commit(uint32_t size); // Queue the first size bytes of writeCache as the new base record, fails above EEPROM_RECORD_MAX_BYTES
 		void reset();
 
-		static uint8_t writeCache[EEPROM_SIZE_BYTES];
+		// Write the queued commit to flash now. Core0 only.
+		void flush();
+		bool isPending() const;
+		FlashCommitStats getStats() const;
+
+		// Queue an overlay for the current base. Fails when the base itself still has to be written, or when the
+		// overlay doesn't fit behind the base in its half; a full commit is needed instead.
+		bool commitOverlay(const uint8_t * data, uint32_t size);
+
+		// Data of the current base record, nullptr when nothing has been committed yet
+		const uint8_t * read(uint32_t & size) const;
+
+		// Data of the overlay on top of the current base, nullptr when there is none
+		const uint8_t * readOverlay(uint32_t & size) const;
+
+		static uint8_t writeCache[EEPROM_RECORD_MAX_BYTES];
 };
 
 inline FlashPROM EEPROM;
@@ -12,8 +12,12 @@
 #include "pico/stdlib.h"
 #include "hardware/pio.h"
 #include "hardware/clocks.h"
+#include "hardware/dma.h"
+#include "hardware/irq.h"
 #include "NeoPico.h"
 
+NeoPico * NeoPico::active = nullptr;
+
 NeoPico::NeoPico(){
 }
 
@@ -21,27 +25,50 @@ LEDFormat NeoPico::GetFormat() {
   return format;
 }
 
-void NeoPico::PutPixel(uint32_t pixelData) {
+uint32_t NeoPico::PixelWord(uint32_t pixelData) {
   switch (format) {
     case LED_FORMAT_GRB:
     case LED_FORMAT_RGB:
-      pio_sm_put_blocking(pio, stateMachine, pixelData << 8u);
-      break;
+      return pixelData << 8u;
     case LED_FORMAT_GRBW:
     case LED_FORMAT_RGBW:
-      pio_sm_put_blocking(pio, stateMachine, pixelData);
-      break;
+    default:
+      return pixelData;
   }
 }
 
 void NeoPico::Setup(int ledPin, int inNumPixels, LEDFormat inFormat, PIO inPio, int inState){
   format = inFormat;
   pio = inPio;
-  numPixels = inNumPixels;
+  numPixels = MIN(inNumPixels, NEO_PICO_MAX_PIXELS);
   stateMachine = inState;
   uint offset = pio_add_program(pio, &ws2812_program);
   bool rgbw = (format == LED_FORMAT_GRBW) || (format == LED_FORMAT_RGBW);
   ws2812_program_init(pio, stateMachine, offset, ledPin, 800000, rgbw);
+
+  // After the last word leaves DMA the joined FIFO (8 words) and the shift register still
+  // have to clock out at 1.25us per bit before the line can be held low for the reset. The
+  // alarm counts from the current microsecond, so it may fire up to 1us early.
+  latchUs = (9 * (rgbw ? 32 : 24) * 5) / 4 + NEO_PICO_RESET_US + 1;
+
+  lock = spin_lock_instance(spin_lock_claim_unused(true));
+  dmaChannel = dma_claim_unused_channel(true);
+  dma_channel_config c = dma_channel_get_default_config(dmaChannel);
+  channel_config_set_transfer_data_size(&c, DMA_SIZE_32);
+  channel_config_set_read_increment(&c, true);
+  channel_config_set_write_increment(&c, false);
+  channel_config_set_dreq(&c, pio_get_dreq(pio, stateMachine, true));
+  dma_channel_configure(dmaChannel, &c, &pio->txf[stateMachine], NULL, 0, false);
+
+  active = this;
+  irq_add_shared_handler(NEO_PICO_DMA_IRQ, DmaIRQ, PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY);
+  irq_set_enabled(NEO_PICO_DMA_IRQ, true);
+  if (NEO_PICO_DMA_IRQ == DMA_IRQ_0) {
+    dma_channel_set_irq0_enabled(dmaChannel, true);
+  } else {
+    dma_channel_set_irq1_enabled(dmaChannel, true);
+  }
+
   this->Clear();
 }
 
@@ -54,14 +81,79 @@ void NeoPico::SetFrame(uint32_t * newFrame) {
 }
 
 void NeoPico::Show() {
+  if (this->numPixels == 0) {
+    return;
+  }
+
+  // Take the back buffer away from the latch alarm while it is rewritten
+  uint32_t save = spin_lock_blocking(lock);
+  pending = false;
+  spin_unlock(lock, save);
+
+  uint32_t * buffer = buffers[backBuffer];
   for (int i = 0; i < this->numPixels; ++i) {
-     this->PutPixel(this->frame[i]);
+    buffer[i] = PixelWord(this->frame[i]);
+  }
+
+  save = spin_lock_blocking(lock);
+  if (busy) {
+    pending = true;
+  } else {
+    StartTransfer();
   }
+  spin_unlock(lock, save);
 }
 
 void NeoPico::Off() {
   Clear();
-  for (int i = 0; i < this->numPixels; ++i) {
-     this->PutPixel(this->frame[i]);
+  Show();
+}
+
+bool NeoPico::IsBusy() {
+  return busy || pending;
+}
+
+void NeoPico::Wait() {
+  while (IsBusy()) {
+    tight_loop_contents();
+  }
+}
+
+// Called with the lock held
+void NeoPico::StartTransfer() {
+  busy = true;
+  pending = false;
+  dma_channel_transfer_from_buffer_now(dmaChannel, buffers[backBuffer], numPixels);
+  backBuffer ^= 1;
+}
+
+void NeoPico::DmaIRQ() {
+  NeoPico * neo = active;
+  if (neo == nullptr) {
+    return;
+  }
+
+  if (NEO_PICO_DMA_IRQ == DMA_IRQ_0) {
+    if (!dma_channel_get_irq0_status(neo->dmaChannel)) return;
+    dma_channel_acknowledge_irq0(neo->dmaChannel);
+  } else {
+    if (!dma_channel_get_irq1_status(neo->dmaChannel)) return;
+    dma_channel_acknowledge_irq1(neo->dmaChannel);
+  }
+
+  if (add_alarm_in_us(neo->latchUs, LatchAlarm, neo, true) < 0) {
+    LatchAlarm(0, neo);
+  }
+}
+
+int64_t NeoPico::LatchAlarm(alarm_id_t id, void *user_data) {
+  NeoPico * neo = (NeoPico *)user_data;
+  uint32_t save = spin_lock_blocking(neo->lock);
+  if (neo->pending) {
+    neo->StartTransfer();
+  } else {
+    neo->busy = false;
   }
+  spin_unlock(neo->lock, save);
+  return 0;
 }
@@ -2,8 +2,22 @@
 #define _NEO_PICO_H_
 
 #include "ws2812.pio.h"
+#include "hardware/sync.h"
+#include "pico/time.h"
 #include <vector>
 
+#define NEO_PICO_MAX_PIXELS 100
+
+// Frames are streamed to the PIO by DMA, completion is signalled on this (shared) IRQ
+#ifndef NEO_PICO_DMA_IRQ
+#define NEO_PICO_DMA_IRQ DMA_IRQ_0
+#endif
+
+// Low time the strip needs to latch a frame (WS2812B-V5/SK6812 need 280us)
+#ifndef NEO_PICO_RESET_US
+#define NEO_PICO_RESET_US 280
+#endif
+
 typedef enum
 {
   LED_FORMAT_GRB = 0,
@@ -17,18 +31,36 @@ class NeoPico
 public:
   NeoPico();
   void Setup(int ledPin, int inNumPixels, LEDFormat inFormat, PIO inPio, int inState);
+  // Queue the current frame and return, the latest queued frame goes out once the previous one has latched
   void Show();
   void Clear();
   void Off();
+  // A frame is still being sent or latched
+  bool IsBusy();
+  void Wait();
   LEDFormat GetFormat();
   void SetFrame(uint32_t * newFrame);
 private:
-  void PutPixel(uint32_t pixel_grb);
+  uint32_t PixelWord(uint32_t pixel);
+  void StartTransfer();
+  static void DmaIRQ();
+  static int64_t LatchAlarm(alarm_id_t id, void *user_data);
+  static NeoPico * active;
+
   LEDFormat format;
   PIO pio = pio1;
   int stateMachine = 0;
   int numPixels = 0;
-  uint32_t frame[100];
+  uint32_t frame[NEO_PICO_MAX_PIXELS];
+
+  // Frames ready for the PIO, one being sent while the other is filled
+  uint32_t buffers[2][NEO_PICO_MAX_PIXELS];
+  uint8_t backBuffer = 0;
+  int dmaChannel = -1;
+  spin_lock_t * lock = nullptr;
+  uint32_t latchUs = 0;
+  volatile bool busy = false;
+  volatile bool pending = false;
 };
 
 #endif
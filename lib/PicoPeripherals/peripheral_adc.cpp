@@ -0,0 +1,172 @@
+#include "peripheral_adc.h"
+
+#include <hardware/timer.h>
+
+// Upper bound for waitForSweep() in case conversions have stalled
+#define ADC_SWEEP_TIMEOUT_US 500
+
+int8_t PeripheralADC::addPin(int32_t pin) {
+    if (pin < ADC_PIN_BASE || pin >= ADC_PIN_BASE + ADC_PIN_COUNT)
+        return -1;
+
+    uint8_t input = pin - ADC_PIN_BASE;
+    adc_gpio_init(pin);
+    if ((_inputMask & (1 << input)) == 0) {
+        _inputMask |= (1 << input);
+        if (_running) {
+            stop();
+            start();
+        }
+    }
+    return input;
+}
+
+void PeripheralADC::start() {
+    if (_running || _inputMask == 0)
+        return;
+
+    // Round robin converts the enabled inputs in ascending order, so each input
+    // owns every _inputCount-th slot of the ring
+    uint8_t first = ADC_PIN_COUNT;
+    _inputCount = 0;
+    for (uint8_t input = 0; input < ADC_PIN_COUNT; input++) {
+        if (_inputMask & (1 << input)) {
+            if (first == ADC_PIN_COUNT)
+                first = input;
+            _inputSlot[input] = _inputCount++;
+        }
+    }
+    _ringSize = _inputCount * ADC_OVERSAMPLE;
+
+    adc_run(false);
+    adc_fifo_drain();
+    hw_set_bits(&adc_hw->fcs, ADC_FCS_OVER_BITS | ADC_FCS_UNDER_BITS);
+    adc_select_input(first);
+    adc_set_round_robin(_inputMask);
+    adc_fifo_setup(true, true, 1, false, false);
+    adc_set_clkdiv(ADC_SAMPLE_CLKDIV);
+
+    // Data channel drains the FIFO into the ring, then chains to the control
+    // channel which rewinds its write address and retriggers it
+    _dmaData = dma_claim_unused_channel(true);
+    _dmaControl = dma_claim_unused_channel(true);
+
+    dma_channel_config controlConfig = dma_channel_get_default_config(_dmaControl);
+    channel_config_set_transfer_data_size(&controlConfig, DMA_SIZE_32);
+    channel_config_set_read_increment(&controlConfig, false);
+    channel_config_set_write_increment(&controlConfig, false);
+    dma_channel_configure(
+        _dmaControl,
+        &controlConfig,
+        &dma_hw->ch[_dmaData].al2_write_addr_trig,
+        &_ringStart,
+        1,
+        false
+    );
+
+    dma_channel_config dataConfig = dma_channel_get_default_config(_dmaData);
+    channel_config_set_transfer_data_size(&dataConfig, DMA_SIZE_16);
+    channel_config_set_read_increment(&dataConfig, false);
+    channel_config_set_write_increment(&dataConfig, true);
+    channel_config_set_dreq(&dataConfig, DREQ_ADC);
+    channel_config_set_chain_to(&dataConfig, _dmaControl);
+    dma_channel_configure(
+        _dmaData,
+        &dataConfig,
+        _ring,
+        &adc_hw->fifo,
+        _ringSize,
+        true
+    );
+
+    adc_run(true);
+    _running = true;
+
+    // Let the ring fill once so reads and averages are valid straight away
+    uint32_t begin = time_us_32();
+    uint32_t last = 0;
+    uint32_t current;
+    while ((current = position()) >= last && (time_us_32() - begin) < ADC_SWEEP_TIMEOUT_US)
+        last = current;
+}
+
+void PeripheralADC::stop() {
+    if (!_running)
+        return;
+
+    adc_run(false);
+    dma_channel_abort(_dmaControl);
+    dma_channel_abort(_dmaData);
+    dma_channel_unclaim(_dmaControl);
+    dma_channel_unclaim(_dmaData);
+    _dmaControl = -1;
+    _dmaData = -1;
+
+    adc_fifo_setup(false, false, 0, false, false);
+    adc_fifo_drain();
+    adc_set_round_robin(0);
+    _running = false;
+}
+
+uint32_t PeripheralADC::position() const {
+    uint32_t remaining = dma_channel_hw_addr(_dmaData)->transfer_count;
+    return (remaining == 0 || remaining > _ringSize) ? 0 : _ringSize - remaining;
+}
+
+// A FIFO overflow drops conversions and every later one lands in another input's
+// slot, so restart the ring to line the slots up again
+void PeripheralADC::checkOverrun() {
+    if (adc_hw->fcs & ADC_FCS_OVER_BITS) {
+        stop();
+        start();
+    }
+}
+
+uint16_t PeripheralADC::read(uint8_t input) {
+    if (!_running) {
+        adc_select_input(input);
+        return adc_read();
+    }
+    if ((_inputMask & (1 << input)) == 0)
+        return 0;
+    checkOverrun();
+
+    // Newest completed slot belonging to this input
+    int32_t last = (int32_t)((position() + _ringSize - 1) % _ringSize);
+    int32_t slot = last - (int32_t)((last + _inputCount - _inputSlot[input]) % _inputCount);
+    if (slot < 0)
+        slot += _ringSize;
+    return _ring[slot];
+}
+
+uint16_t PeripheralADC::readAverage(uint8_t input) {
+    if (!_running) {
+        adc_select_input(input);
+        return adc_read();
+    }
+    if ((_inputMask & (1 << input)) == 0)
+        return 0;
+    checkOverrun();
+
+    uint32_t sum = 0;
+    for (uint32_t slot = _inputSlot[input]; slot < _ringSize; slot += _inputCount)
+        sum += _ring[slot];
+    return (sum + (ADC_OVERSAMPLE / 2)) / ADC_OVERSAMPLE;
+}
+
+uint32_t PeripheralADC::mark() const {
+    return _running ? position() : 0;
+}
+
+void PeripheralADC::waitForSweep(uint32_t marker) const {
+    if (!_running)
+        return;
+
+    // The conversion in flight at the mark may have sampled before it, so wait for
+    // one more. A wait longer than a full ring only costs extra time, never a stale read.
+    uint32_t begin = time_us_32();
+    while (((position() + _ringSize - marker) % _ringSize) < (uint32_t)_inputCount + 1) {
+        if ((time_us_32() - begin) > ADC_SWEEP_TIMEOUT_US)
+            break;
+    }
+}
@@ -0,0 +1,67 @@
+#ifndef _PERIPHERAL_ADC_H_
+#define _PERIPHERAL_ADC_H_
+
+#include <hardware/adc.h>
+#include <hardware/dma.h>
+#include <hardware/gpio.h>
+#include <hardware/platform_defs.h>
+
+#define ADC_PIN_BASE 26
+#define ADC_PIN_COUNT 4
+
+// Samples kept per input in the DMA ring, averaged by readAverage()
+#ifndef ADC_OVERSAMPLE
+#define ADC_OVERSAMPLE 4
+#endif
+
+#if ADC_OVERSAMPLE < 3
+#error "ADC_OVERSAMPLE must be at least 3 so a full sweep fits in the ring"
+#endif
+
+// ADC clock divider while free running, 0 = back to back conversions (2us each)
+#ifndef ADC_SAMPLE_CLKDIV
+#define ADC_SAMPLE_CLKDIV 0
+#endif
+
+class PeripheralADC {
+public:
+    PeripheralADC() {}
+    ~PeripheralADC() { stop(); }
+
+    // Claim an ADC GPIO (26-29) for sampling, returns the ADC input or -1 if the pin has no ADC
+    int8_t addPin(int32_t pin);
+
+    // Start free running round robin conversions of all claimed inputs into the DMA ring
+    void start();
+    void stop();
+    bool isRunning() const { return _running; }
+
+    // Latest conversion of an input; a blocking conversion when the sampler isn't running
+    uint16_t read(uint8_t input);
+
+    // Mean of the last ADC_OVERSAMPLE conversions of an input
+    uint16_t readAverage(uint8_t input);
+
+    // Mark the current ring position, e.g. right after switching an external mux
+    uint32_t mark() const;
+
+    // Wait until every input has been converted after the given mark
+    void waitForSweep(uint32_t marker) const;
+private:
+    uint8_t _inputMask = 0;
+    uint8_t _inputCount = 0;
+    uint8_t _inputSlot[ADC_PIN_COUNT] = {};
+    uint32_t _ringSize = 0;
+
+    bool _running = false;
+    int _dmaData = -1;
+    int _dmaControl = -1;
+
+    volatile uint16_t _ring[ADC_PIN_COUNT * ADC_OVERSAMPLE] = {};
+    volatile uint16_t * _ringStart = _ring;
+
+    uint32_t position() const;
+    void checkOverrun();
+};
+
+#endif
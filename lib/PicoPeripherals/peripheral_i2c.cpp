@@ -1,5 +1,8 @@
 #include <cstdio>
 #include "peripheral_i2c.h"
+#include <hardware/irq.h>
+
+PeripheralI2C *PeripheralI2C::_instances[NUM_I2CS] = {};
 
 PeripheralI2C::PeripheralI2C() {
 #ifdef PICO_DEFAULT_I2C_INSTANCE
@@ -40,6 +43,17 @@ void PeripheralI2C::setup() {
     gpio_pull_up(_SDA);
     gpio_pull_up(_SCL);
 
+    // transaction queue, serviced from this block's interrupt on the configuring core
+    if (_lock == nullptr) {
+        uint8_t index = i2c_hw_index(_I2C);
+        _lock = spin_lock_instance(spin_lock_claim_unused(true));
+        _dmaTx = dma_claim_unused_channel(true);
+        _dmaRx = dma_claim_unused_channel(true);
+        _instances[index] = this;
+        irq_set_exclusive_handler(index == 0 ? I2C0_IRQ : I2C1_IRQ, index == 0 ? irq0Handler : irq1Handler);
+        irq_set_enabled(index == 0 ? I2C0_IRQ : I2C1_IRQ, true);
+    }
+
     // reset the bus before using it
     clear();
 }
@@ -47,7 +61,7 @@ void PeripheralI2C::setup() {
 int16_t PeripheralI2C::read(uint8_t address, uint8_t *data, uint16_t len, bool isBlock) {
     if ((_exclusiveAddress > -1) && (_exclusiveAddress != address)) return -1;
 
-    int16_t result = i2c_read_blocking(_I2C, address, data, len, isBlock);
+    int16_t result = transfer(address, nullptr, 0, data, len);
 #ifdef DEBUG_PERIPHERALI2C
     printf("PeripheralI2C::write %d:%d (blocking? %d)\n", address, len, isBlock);
     for (int i = 0; i < len; i++) {
@@ -62,11 +76,8 @@ int16_t PeripheralI2C::read(uint8_t address, uint8_t *data, uint16_t len, bool i
 int16_t PeripheralI2C::readRegister(uint8_t address, uint8_t reg, uint8_t *data, uint16_t len) {
     if ((_exclusiveAddress > -1) && (_exclusiveAddress != address)) return -1;
 
-    int16_t registerCheck;
-    registerCheck = i2c_write_blocking(_I2C, address, &reg, 1, true);
-    if (registerCheck >= 0) {
-        registerCheck = i2c_read_blocking(_I2C, address, data, len, false);
-    }
+    // register write and read share one transaction with a repeated start
+    int16_t registerCheck = transfer(address, &reg, 1, data, len);
     return (registerCheck >= 0);
 }
 
@@ -79,7 +90,7 @@ int16_t PeripheralI2C::write(uint8_t address, uint8_t *data, uint16_t len, bool
         printf("%02x ", data[i]);
     }
 #endif
-    int16_t result = i2c_write_blocking(_I2C, address, data, len, isBlock);
+    int16_t result = transfer(address, data, len, nullptr, 0);
 #ifdef DEBUG_PERIPHERALI2C
     printf("\nResult: %d\n", result);
     printf("-----\n");
@@ -93,7 +104,9 @@ uint8_t PeripheralI2C::test(uint8_t address) {
     // TODO: Revert to i2c_read_blocking when we have I2C resolved
     // int16_t ret = i2c_read_blocking(_I2C, address, &data, 1, false);
     absolute_time_t test_timeout = make_timeout_time_ms(100);
+    acquireBus();
     int16_t ret = i2c_read_blocking_until(_I2C, address, &data, 1, false, test_timeout);
+    releaseBus();
     return (ret >= 0);
 }
 
@@ -108,7 +121,9 @@ std::map<uint8_t,bool> PeripheralI2C::scan() {
     for (uint8_t addr = 0; addr < (1 << 7); ++addr) {
         int8_t ret;
         uint8_t rxdata;
+        acquireBus();
         ret = i2c_read_blocking(_I2C, addr, &rxdata, 1, false);
+        releaseBus();
 
         if (ret >= 0) {
             result.insert({addr,(ret >= 0)});
@@ -120,4 +135,218 @@ std::map<uint8_t,bool> PeripheralI2C::scan() {
 #endif
 
     return result;
-}
\ No newline at end of file
+}
+
+void PeripheralI2C::setPriority(uint8_t address, PeripheralI2CPriority priority) {
+    address &= 0x7F;
+    if (priority == I2C_PRIORITY_LOW) {
+        _lowPriority[address >> 5] |= (1u << (address & 31));
+    } else {
+        _lowPriority[address >> 5] &= ~(1u << (address & 31));
+    }
+}
+
+PeripheralI2CPriority PeripheralI2C::getPriority(uint8_t address) {
+    address &= 0x7F;
+    return (_lowPriority[address >> 5] & (1u << (address & 31))) ? I2C_PRIORITY_LOW : I2C_PRIORITY_HIGH;
+}
+
+bool PeripheralI2C::submit(PeripheralI2CTransaction *transaction) {
+    uint32_t length = transaction->txLen + transaction->rxLen;
+    if ((_lock == nullptr) || (length == 0) || (length > I2C_MAX_TRANSFER) || (transaction->priority >= I2C_PRIORITY_COUNT)) {
+        return false;
+    }
+
+    transaction->status = I2C_TRANSACTION_QUEUED;
+    transaction->next = nullptr;
+
+    uint32_t irq = spin_lock_blocking(_lock);
+    PeripheralI2CPriority priority = transaction->priority;
+    if (_tail[priority] != nullptr) {
+        _tail[priority]->next = transaction;
+    } else {
+        _head[priority] = transaction;
+    }
+    _tail[priority] = transaction;
+    startNext();
+    spin_unlock(_lock, irq);
+
+    return true;
+}
+
+int16_t PeripheralI2C::wait(PeripheralI2CTransaction *transaction) {
+    while (!transaction->isDone()) {
+        tight_loop_contents();
+    }
+    return transaction->result;
+}
+
+// Queue a write/read pair and wait for it, or run it blocking if it can't go through DMA
+int16_t PeripheralI2C::transfer(uint8_t address, const uint8_t *tx, uint16_t txLen, uint8_t *rx, uint16_t rxLen) {
+    PeripheralI2CTransaction transaction;
+    transaction.address = address;
+    transaction.tx = tx;
+    transaction.txLen = txLen;
+    transaction.rx = rx;
+    transaction.rxLen = rxLen;
+    transaction.priority = getPriority(address);
+    if (submit(&transaction)) {
+        return wait(&transaction);
+    }
+
+    acquireBus();
+    int16_t result = 0;
+    if (txLen > 0) {
+        result = i2c_write_blocking(_I2C, address, tx, txLen, rxLen > 0);
+    }
+    if ((result >= 0) && (rxLen > 0)) {
+        result = i2c_read_blocking(_I2C, address, rx, rxLen, false);
+    }
+    releaseBus();
+    return result;
+}
+
+// Take the bus for blocking SDK transfers once the active transaction is done
+void PeripheralI2C::acquireBus() {
+    if (_lock == nullptr) return;
+
+    while (true) {
+        uint32_t irq = spin_lock_blocking(_lock);
+        if ((_active == nullptr) && !_manual) {
+            _manual = true;
+            spin_unlock(_lock, irq);
+            return;
+        }
+        spin_unlock(_lock, irq);
+        tight_loop_contents();
+    }
+}
+
+void PeripheralI2C::releaseBus() {
+    if (_lock == nullptr) return;
+
+    uint32_t irq = spin_lock_blocking(_lock);
+    _manual = false;
+    startNext();
+    spin_unlock(_lock, irq);
+}
+
+// Start the next queued transaction if the bus is free, called with _lock held
+void PeripheralI2C::startNext() {
+    if ((_active != nullptr) || _manual) return;
+
+    // high priority first, but low priority gets a turn after a burst so it can't starve
+    PeripheralI2CPriority priority = I2C_PRIORITY_HIGH;
+    if ((_head[I2C_PRIORITY_HIGH] == nullptr) || ((_head[I2C_PRIORITY_LOW] != nullptr) && (_highBurst >= I2C_HIGH_PRIORITY_BURST))) {
+        priority = I2C_PRIORITY_LOW;
+    }
+
+    PeripheralI2CTransaction *transaction = _head[priority];
+    if (transaction == nullptr) return;
+
+    _head[priority] = transaction->next;
+    if (_head[priority] == nullptr) {
+        _tail[priority] = nullptr;
+    }
+    if (priority == I2C_PRIORITY_HIGH) {
+        if (_highBurst < I2C_HIGH_PRIORITY_BURST) _highBurst++;
+    } else {
+        _highBurst = 0;
+    }
+
+    _active = transaction;
+    _aborted = false;
+    transaction->status = I2C_TRANSACTION_ACTIVE;
+
+    // writes, then reads behind a repeated start, stop on the last byte
+    uint16_t count = 0;
+    for (uint16_t i = 0; i < transaction->txLen; i++) {
+        _commands[count++] = transaction->tx[i];
+    }
+    for (uint16_t i = 0; i < transaction->rxLen; i++) {
+        _commands[count++] = I2C_IC_DATA_CMD_CMD_BITS | (((i == 0) && (transaction->txLen > 0)) ? I2C_IC_DATA_CMD_RESTART_BITS : 0);
+    }
+    _commands[count - 1] |= I2C_IC_DATA_CMD_STOP_BITS;
+
+    i2c_hw_t *hw = i2c_get_hw(_I2C);
+    hw->enable = 0;
+    hw->tar = transaction->address;
+    hw->enable = 1;
+    (void)hw->clr_intr; // drop stop/abort flags left by blocking transfers
+    hw->intr_mask = I2C_IC_INTR_MASK_M_STOP_DET_BITS | I2C_IC_INTR_MASK_M_TX_ABRT_BITS;
+
+    if (transaction->rxLen > 0) {
+        dma_channel_config rxConfig = dma_channel_get_default_config(_dmaRx);
+        channel_config_set_transfer_data_size(&rxConfig, DMA_SIZE_8);
+        channel_config_set_dreq(&rxConfig, i2c_get_dreq(_I2C, false));
+        channel_config_set_read_increment(&rxConfig, false);
+        channel_config_set_write_increment(&rxConfig, true);
+        dma_channel_configure(_dmaRx, &rxConfig, transaction->rx, &hw->data_cmd, transaction->rxLen, true);
+    }
+
+    dma_channel_config txConfig = dma_channel_get_default_config(_dmaTx);
+    channel_config_set_transfer_data_size(&txConfig, DMA_SIZE_16);
+    channel_config_set_dreq(&txConfig, i2c_get_dreq(_I2C, true));
+    channel_config_set_read_increment(&txConfig, true);
+    channel_config_set_write_increment(&txConfig, false);
+    dma_channel_configure(_dmaTx, &txConfig, &hw->data_cmd, _commands, count, true);
+}
+
+// Complete the active transaction and move on to the next one, called from the interrupt
+void PeripheralI2C::finish(int16_t result) {
+    i2c_get_hw(_I2C)->intr_mask = 0;
+
+    uint32_t irq = spin_lock_blocking(_lock);
+    PeripheralI2CTransaction *transaction = _active;
+    _active = nullptr;
+    startNext();
+    spin_unlock(_lock, irq);
+
+    if (transaction == nullptr) return;
+
+    // the owner may reuse the transaction as soon as the status changes
+    PeripheralI2CCallback callback = transaction->callback;
+    transaction->result = result;
+    __dmb();
+    transaction->status = (result < 0) ? I2C_TRANSACTION_ERROR : I2C_TRANSACTION_DONE;
+    if (callback != nullptr) {
+        callback(transaction);
+    }
+}
+
+void PeripheralI2C::service() {
+    i2c_hw_t *hw = i2c_get_hw(_I2C);
+    uint32_t status = hw->intr_stat;
+
+    if (status & I2C_IC_INTR_STAT_R_TX_ABRT_BITS) {
+        // NACK or lost arbitration: stop feeding the FIFO, the controller still sends a stop
+        dma_channel_abort(_dmaTx);
+        dma_channel_abort(_dmaRx);
+        (void)hw->clr_tx_abrt;
+        while (hw->rxflr) {
+            (void)hw->data_cmd;
+        }
+        _aborted = true;
+    }
+
+    if (status & I2C_IC_INTR_STAT_R_STOP_DET_BITS) {
+        (void)hw->clr_stop_det;
+        if (_aborted) {
+            finish(PICO_ERROR_GENERIC);
+        } else {
+            // the last read byte may still be on its way out of the FIFO
+            while (dma_channel_is_busy(_dmaRx)) {
+                tight_loop_contents();
+            }
+            finish((_active != nullptr && _active->rxLen > 0) ? _active->rxLen : (_active != nullptr ? _active->txLen : 0));
+        }
+    }
+}
+
+void PeripheralI2C::irq0Handler() {
+    if (_instances[0] != nullptr) _instances[0]->service();
+}
+
+void PeripheralI2C::irq1Handler() {
+    if (_instances[1] != nullptr) _instances[1]->service();
+}
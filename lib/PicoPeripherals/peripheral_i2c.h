@@ -2,8 +2,10 @@
 #define _PERIPHERAL_I2C_H_
 
 #include <map>
+#include <hardware/dma.h>
 #include <hardware/gpio.h>
 #include <hardware/i2c.h>
+#include <hardware/sync.h>
 #include <hardware/platform_defs.h>
 
 //#define DEBUG_PERIPHERALI2C
@@ -40,6 +42,52 @@
 #define I2C1_SPEED 400000
 #endif
 
+// Largest transaction (write + read bytes) sent through DMA, longer ones fall back to blocking transfers
+#ifndef I2C_MAX_TRANSFER
+#define I2C_MAX_TRANSFER 160
+#endif
+
+// Low priority transactions get a turn after this many high priority ones in a row
+#ifndef I2C_HIGH_PRIORITY_BURST
+#define I2C_HIGH_PRIORITY_BURST 4
+#endif
+
+typedef enum {
+    I2C_PRIORITY_HIGH, // input devices
+    I2C_PRIORITY_LOW,  // bulk writes such as display pages
+    I2C_PRIORITY_COUNT
+} PeripheralI2CPriority;
+
+typedef enum {
+    I2C_TRANSACTION_QUEUED,
+    I2C_TRANSACTION_ACTIVE,
+    I2C_TRANSACTION_DONE,
+    I2C_TRANSACTION_ERROR,
+} PeripheralI2CStatus;
+
+struct PeripheralI2CTransaction;
+typedef void (*PeripheralI2CCallback)(PeripheralI2CTransaction *transaction);
+
+// A write followed by a read (either may be empty) to one address, ended with a stop.
+// The transaction and its buffers must stay valid until isDone().
+struct PeripheralI2CTransaction {
+    uint8_t address = 0;
+    const uint8_t *tx = nullptr;
+    uint16_t txLen = 0;
+    uint8_t *rx = nullptr;
+    uint16_t rxLen = 0;
+    PeripheralI2CPriority priority = I2C_PRIORITY_HIGH;
+    PeripheralI2CCallback callback = nullptr; // called from the I2C interrupt on completion
+    void *userData = nullptr;
+
+    volatile PeripheralI2CStatus status = I2C_TRANSACTION_DONE;
+    int16_t result = 0; // bytes transferred, or a PICO_ERROR_* code
+
+    bool isDone() const { return status >= I2C_TRANSACTION_DONE; }
+
+    PeripheralI2CTransaction *next = nullptr;
+};
+
 class PeripheralI2C {
 public:
     PeripheralI2C();
@@ -56,6 +104,16 @@ public:
 
     int16_t write(uint8_t address, uint8_t *data, uint16_t len, bool isBlock=true);
 
+    // Queue a transaction, safe from either core; returns false if it can't be queued
+    bool submit(PeripheralI2CTransaction *transaction);
+
+    // Wait for a submitted transaction and return its result
+    int16_t wait(PeripheralI2CTransaction *transaction);
+
+    // Priority used by read/write/readRegister for an address (high by default)
+    void setPriority(uint8_t address, PeripheralI2CPriority priority);
+    PeripheralI2CPriority getPriority(uint8_t address);
+
     uint8_t test(uint8_t address);
     void clear();
 
@@ -75,7 +133,31 @@ private:
 
     int8_t _exclusiveAddress = -1;
 
+    // Transaction queue, guarded by _lock across cores and the I2C interrupt
+    spin_lock_t *_lock = nullptr;
+    PeripheralI2CTransaction *_head[I2C_PRIORITY_COUNT] = {};
+    PeripheralI2CTransaction *_tail[I2C_PRIORITY_COUNT] = {};
+    PeripheralI2CTransaction *_active = nullptr;
+    bool _manual = false;   // a blocking SDK transfer owns the bus
+    bool _aborted = false;  // the active transaction hit TX_ABRT, waiting for its stop
+    uint8_t _highBurst = 0;
+    uint32_t _lowPriority[4] = {}; // one bit per 7-bit address
+
+    int _dmaTx = -1;
+    int _dmaRx = -1;
+    uint16_t _commands[I2C_MAX_TRANSFER]; // DATA_CMD words of the active transaction
+
+    static PeripheralI2C *_instances[NUM_I2CS];
+    static void irq0Handler();
+    static void irq1Handler();
+
     void setup();
+    int16_t transfer(uint8_t address, const uint8_t *tx, uint16_t txLen, uint8_t *rx, uint16_t rxLen);
+    void acquireBus();
+    void releaseBus();
+    void startNext();
+    void finish(int16_t result);
+    void service();
 };
 
 #endif
@@ -31,6 +31,7 @@
 #else
     #include <cstring>
     #include <cstdio>
+    #include "snespad.pio.h"
 #endif
 
 SNESpad::SNESpad(int clock, int latch, int data) {
@@ -46,6 +47,30 @@ void SNESpad::begin() {
 #endif
 }
 
+void SNESpad::begin(uint32_t pollIntervalUS) {
+    init();
+#ifndef ARDUINO
+    // pio0 is taken by the LED strip, so only try the second block
+    PIO pio = pio1;
+    if (pio_can_add_program(pio, &snespad_program)) {
+        int sm = pio_claim_unused_sm(pio, false);
+        if (sm >= 0) {
+            uint offset = pio_add_program(pio, &snespad_program);
+            snespad_program_init(pio, sm, offset, clockPin, latchPin, dataPin);
+
+            _pio = pio;
+            _sm = sm;
+            _pollCycles = (pollIntervalUS > snespad_READ_CYCLES ? pollIntervalUS - snespad_READ_CYCLES : 0) & ~SNES_PAD_PIO_SPEED;
+            pio_sm_put(_pio, _sm, _pollCycles);
+            pio_sm_set_enabled(_pio, _sm, true);
+        }
+    }
+#endif
+#if SNES_PAD_DEBUG==true
+    printf("SNESpad::begin %s\n", isBackground() ? "pio" : "gpio");
+#endif
+}
+
 void SNESpad::start() {
 #if SNES_PAD_DEBUG==true
     printf("SNESpad::start\n");
@@ -64,23 +89,7 @@ void SNESpad::start() {
 #if SNES_PAD_DEBUG==true
         printf("Device Type: %d\n", type);
 #endif
-        mouseX          = 0;
-        mouseY          = 0;
-
-        buttonA         = 0;
-        buttonB         = 0;
-        buttonX         = 0;
-        buttonY         = 0;
-        buttonStart     = 0;
-        buttonSelect    = 0;
-        buttonL         = 0;
-        buttonR         = 0;
-
-        directionUp     = 0;
-        directionDown   = 0;
-        directionLeft   = 0;
-        directionRight  = 0;
-
+        reset();
     } else {
 #if SNES_PAD_DEBUG==true
         printf("Unknown Device: %02x\n", packet);
@@ -88,79 +97,36 @@ void SNESpad::start() {
     }
 }
 
-void SNESpad::poll() {
+void SNESpad::poll(bool wait) {
     int32_t state = 0;
 
 #if SNES_PAD_DEBUG==true
     //printf("SNESpad::poll\n");
 #endif
 
+#ifndef ARDUINO
+    if (_sm >= 0) {
+        uint32_t packet;
+        if (!fetch(packet, wait)) return; // nothing new since the last poll
+
+        if (type != SNES_PAD_NONE) {
+            state = unpack(packet);
+            if (state) update(state);
+        } else {
+            unpack(packet);
+            if (type != SNES_PAD_NONE) reset();
+        }
+
+        control();
+        return;
+    }
+#endif
+
     if (type != SNES_PAD_NONE) {
         state = read(); // polls current controller state
 
         if (state) {
-            switch (type) {
-                case SNES_PAD_BASIC:
-                    directionLeft =  (state & SNES_LEFT);
-                    directionUp =    (state & SNES_UP);
-                    directionRight = (state & SNES_RIGHT);
-                    directionDown =  (state & SNES_DOWN);
-
-                    buttonSelect =   (state & SNES_SELECT);
-                    buttonStart =    (state & SNES_START);
-                    buttonB =        (state & SNES_B);
-                    buttonY =        (state & SNES_Y);
-                    buttonA =        (state & SNES_A);
-                    buttonX =        (state & SNES_X);
-                    buttonL =        (state & SNES_L);
-                    buttonR =        (state & SNES_R);
-
-                    break;
-                case SNES_PAD_NES:
-                    directionLeft =  (state & SNES_LEFT);
-                    directionUp =    (state & SNES_UP);
-                    directionRight = (state & SNES_RIGHT);
-                    directionDown =  (state & SNES_DOWN);
-
-                    buttonSelect =   (state & SNES_SELECT);
-                    buttonStart =    (state & SNES_START);
-                    buttonB =        (state & SNES_Y);
-                    buttonA =        (state & SNES_B);
-
-                    break;
-                case SNES_PAD_MOUSE:
-                    int x = 127;  //set center position [0-255]
-                    int y = 127;
-
-                    // Mouse X axis
-                    x = (state & SNES_MOUSE_X) >> 25;
-                    x = reverse(x) * SNES_MOUSE_PRECISION;
-                    if (state & SNES_MOUSE_X_SIGN) x = 127 - x;
-                    else x = 127 + x;
-
-                    // Mouse Y axis
-                    y = (state & SNES_MOUSE_Y) >> 17;
-                    y = reverse(y) * SNES_MOUSE_PRECISION;
-                    if (state & SNES_MOUSE_Y_SIGN) y = 127 - y;
-                    else y = 127 + y;
-
-                    mouseX  = x;
-                    mouseY  = y;
-                    buttonB = (state & SNES_X);
-                    buttonA = (state & SNES_A);
-
-                    break;
-            }
-
-#if SNES_PAD_DEBUG==true
-            if (_lastRead != state) {
-                printf(
-                    "A=%1d B=%1d X=%1d Y=%1d L=%1d R=%1d Select=%1d Start=%1d Mouse X=%4d Y=%4d\n",
-                    buttonA, buttonB, buttonX, buttonY, buttonL, buttonR, buttonSelect, buttonStart, mouseX, mouseY
-                );
-            }
-            _lastRead = state;
-#endif
+            update(state);
         } else {
             // device disconnected or invalid read
             type = SNES_PAD_NONE;
@@ -171,6 +137,91 @@ void SNESpad::poll() {
     }
 }
 
+void SNESpad::reset() {
+    mouseX          = 0;
+    mouseY          = 0;
+
+    buttonA         = 0;
+    buttonB         = 0;
+    buttonX         = 0;
+    buttonY         = 0;
+    buttonStart     = 0;
+    buttonSelect    = 0;
+    buttonL         = 0;
+    buttonR         = 0;
+
+    directionUp     = 0;
+    directionDown   = 0;
+    directionLeft   = 0;
+    directionRight  = 0;
+}
+
+// decode a non-zero read into the button/mouse fields of the current type
+void SNESpad::update(uint32_t state) {
+    switch (type) {
+        case SNES_PAD_BASIC:
+            directionLeft =  (state & SNES_LEFT);
+            directionUp =    (state & SNES_UP);
+            directionRight = (state & SNES_RIGHT);
+            directionDown =  (state & SNES_DOWN);
+
+            buttonSelect =   (state & SNES_SELECT);
+            buttonStart =    (state & SNES_START);
+            buttonB =        (state & SNES_B);
+            buttonY =        (state & SNES_Y);
+            buttonA =        (state & SNES_A);
+            buttonX =        (state & SNES_X);
+            buttonL =        (state & SNES_L);
+            buttonR =        (state & SNES_R);
+
+            break;
+        case SNES_PAD_NES:
+            directionLeft =  (state & SNES_LEFT);
+            directionUp =    (state & SNES_UP);
+            directionRight = (state & SNES_RIGHT);
+            directionDown =  (state & SNES_DOWN);
+
+            buttonSelect =   (state & SNES_SELECT);
+            buttonStart =    (state & SNES_START);
+            buttonB =        (state & SNES_Y);
+            buttonA =        (state & SNES_B);
+
+            break;
+        case SNES_PAD_MOUSE:
+            int x = 127;  //set center position [0-255]
+            int y = 127;
+
+            // Mouse X axis
+            x = (state & SNES_MOUSE_X) >> 25;
+            x = reverse(x) * SNES_MOUSE_PRECISION;
+            if (state & SNES_MOUSE_X_SIGN) x = 127 - x;
+            else x = 127 + x;
+
+            // Mouse Y axis
+            y = (state & SNES_MOUSE_Y) >> 17;
+            y = reverse(y) * SNES_MOUSE_PRECISION;
+            if (state & SNES_MOUSE_Y_SIGN) y = 127 - y;
+            else y = 127 + y;
+
+            mouseX  = x;
+            mouseY  = y;
+            buttonB = (state & SNES_X);
+            buttonA = (state & SNES_A);
+
+            break;
+    }
+
+#if SNES_PAD_DEBUG==true
+    if (_lastRead != state) {
+        printf(
+            "A=%1d B=%1d X=%1d Y=%1d L=%1d R=%1d Select=%1d Start=%1d Mouse X=%4d Y=%4d\n",
+            buttonA, buttonB, buttonX, buttonY, buttonL, buttonR, buttonSelect, buttonStart, mouseX, mouseY
+        );
+    }
+    _lastRead = state;
+#endif
+}
+
 // init gpio pins
 void SNESpad::init() {
 #ifdef ARDUINO
@@ -271,6 +322,14 @@ uint32_t SNESpad::read()
     uint32_t ret = 0;
     uint8_t i;
 
+#ifndef ARDUINO
+    if (_sm >= 0) {
+        uint32_t packet;
+        if (!fetch(packet, true)) return identify(0, true); // reader stalled, treat as unplugged
+        return unpack(packet);
+    }
+#endif
+
     /* A connected device will pull the data line low prior to latch.
        A disconnected pin is kept high by internal pull_up.*/
     uint32_t disconnected = false;
@@ -297,11 +356,18 @@ uint32_t SNESpad::read()
     }
     ret = ~ret; // buttons are active low, so invert bits
 
+    return identify(ret, disconnected);
+}
+
+// set the device type from an inverted read, returns 0 when nothing is connected
+uint32_t SNESpad::identify(uint32_t ret, bool disconnected)
+{
     // verify controller or mouse is connected
     if (disconnected && !(ret & 0xFFFF)) {
         type = SNES_PAD_NONE;
         mouseSpeedFails = 0;
         mouseSpeed = 0;
+        reset(); // release everything that was held when it was unplugged
         return 0;
     }
 
@@ -339,6 +405,55 @@ uint32_t SNESpad::read()
     return ret;
 }
 
+#ifndef ARDUINO
+// take the newest packet from the background reader, optionally waiting for one
+bool SNESpad::fetch(uint32_t & packet, bool wait)
+{
+    if (wait) {
+        while (!pio_sm_is_rx_fifo_empty(_pio, _sm)) pio_sm_get(_pio, _sm);
+        uint32_t start = time_us_32();
+        while (pio_sm_is_rx_fifo_empty(_pio, _sm)) {
+            if (time_us_32() - start > (_pollCycles + SNES_PAD_PACKET_TIMEOUT_US)) return false;
+        }
+    } else if (pio_sm_is_rx_fifo_empty(_pio, _sm)) {
+        return false;
+    }
+
+    // older packets are stale, only the last one matters
+    do {
+        packet = pio_sm_get(_pio, _sm);
+    } while (!pio_sm_is_rx_fifo_empty(_pio, _sm));
+
+    return true;
+}
+
+// split a background packet back into the bit-banged read and identify it
+uint32_t SNESpad::unpack(uint32_t packet)
+{
+    bool disconnected = false;
+
+    if (packet & 0x8000) {
+        // 16 bit read, bit 16 holds the data line level seen before latching
+        disconnected = (packet & 0x10000);
+        packet &= 0xFFFF;
+    }
+
+    return identify(~packet, disconnected);
+}
+
+// queue a single mouse speed step for the next read when one is needed
+void SNESpad::control()
+{
+    if (type == SNES_PAD_MOUSE
+        && mouseSpeed != SNES_MOUSE_FAST
+        && mouseSpeedFails < SNES_MOUSE_THRESHOLD
+        && pio_sm_is_tx_fifo_empty(_pio, _sm)
+    ) {
+        pio_sm_put(_pio, _sm, _pollCycles | SNES_PAD_PIO_SPEED);
+    }
+}
+#endif
+
 // reverse bits within a byte (ex: 0b1000 -> 0b0001)
 uint8_t SNESpad::reverse(uint8_t c) {
     char r = 0;
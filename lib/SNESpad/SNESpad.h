@@ -34,6 +34,7 @@
 #else
     // If we aren't compiling on Arduino, include the Pico SDK standard library
     #include "pico/stdlib.h"
+    #include "hardware/pio.h"
 #endif
 
 #define SNES_PAD_NONE   -1
@@ -70,6 +71,12 @@
 #define SNES_MOUSE_THRESHOLD 10  // max speed fails (Hyperkin compatiblity)
 #define SNES_MOUSE_PRECISION 1   // mouse movement velocity multiplier
 
+// Control word bit asking the background reader for one mouse speed step
+#define SNES_PAD_PIO_SPEED  0x80000000
+
+// Give up waiting for a background packet after this long
+#define SNES_PAD_PACKET_TIMEOUT_US 5000
+
 #ifndef SNES_PAD_DEBUG
 #define SNES_PAD_DEBUG false
 #endif
@@ -102,8 +109,14 @@ class SNESpad {
 
     // Methods
     void begin();
+    // Hand latch/clock to a PIO state machine reading every pollIntervalUS,
+    // falls back to bit-banging when no PIO is free
+    void begin(uint32_t pollIntervalUS);
     void start();
-    void poll();
+    // Decode the latest packet; with a background reader this never blocks
+    // unless wait is set, in which case it waits for a fresh packet
+    void poll(bool wait = false);
+    bool isBackground() { return _sm >= 0; }
   private:
   
     uint8_t latchPin; // output: latch
@@ -113,11 +126,27 @@ class SNESpad {
     uint8_t mouseSpeedFails = 0;
     uint32_t _lastRead;
 
+#ifndef ARDUINO
+    PIO _pio = nullptr;
+    int _sm = -1;
+    uint32_t _pollCycles = 0;
+#else
+    int _sm = -1;
+#endif
+
     void init();
     void speed();
     void latch();
     uint32_t read();
     uint32_t clock();
+    uint32_t identify(uint32_t ret, bool disconnected);
+    void update(uint32_t state);
+    void reset();
+#ifndef ARDUINO
+    bool fetch(uint32_t & packet, bool wait);
+    uint32_t unpack(uint32_t packet);
+    void control();
+#endif
     uint8_t reverse(uint8_t c);
 };
 
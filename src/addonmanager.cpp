@@ -1,4 +1,5 @@
 #include "addonmanager.h"
+#include "hotpath.h"
 #include "usbhostmanager.h"
 
 bool AddonManager::LoadAddon(GPAddon* addon) {
@@ -6,6 +7,7 @@ bool AddonManager::LoadAddon(GPAddon* addon) {
         AddonBlock * block = new AddonBlock;
         addon->setup();
         block->ptr = addon;
+        block->stats = LoopStats::getInstance().registerAddon(addon->name());
         addons.push_back(block);
         return true;
     } else {
@@ -29,24 +31,30 @@ void AddonManager::ReinitializeAddons() {
     }
 }
 
-void AddonManager::PreprocessAddons() {
+void HOT_PATH_FUNC(AddonManager::PreprocessAddons)() {
     // Loop through all addons and process any that match our type
     for (std::vector<AddonBlock*>::iterator it = addons.begin(); it != addons.end(); it++) {
+        uint32_t start = LoopStats::now();
         (*it)->ptr->preprocess();
+        LoopStats::mark((*it)->stats, LOOP_ADDON_PREPROCESS, start);
     }
 }
 
-void AddonManager::ProcessAddons() {
+void HOT_PATH_FUNC(AddonManager::ProcessAddons)() {
     // Loop through all addons and process any that match our type
     for (std::vector<AddonBlock*>::iterator it = addons.begin(); it != addons.end(); it++) {
+        uint32_t start = LoopStats::now();
         (*it)->ptr->process();
+        LoopStats::mark((*it)->stats, LOOP_ADDON_PROCESS, start);
     }
 }
 
-void AddonManager::PostprocessAddons(bool reportSent) {
+void HOT_PATH_FUNC(AddonManager::PostprocessAddons)(bool reportSent) {
     // Loop through all addons and process any that match our type
     for (std::vector<AddonBlock*>::iterator it = addons.begin(); it != addons.end(); it++) {
+        uint32_t start = LoopStats::now();
         (*it)->ptr->postprocess(reportSent);
+        LoopStats::mark((*it)->stats, LOOP_ADDON_POSTPROCESS, start);
     }
 }
 
@@ -1,8 +1,9 @@
 #include "addons/analog.h"
+#include "hotpath.h"
 #include "config.pb.h"
 #include "enums.pb.h"
-#include "hardware/adc.h"
 #include "helper.h"
+#include "peripheralmanager.h"
 #include "storagemanager.h"
 #include "drivermanager.h"
 
@@ -10,9 +11,49 @@
 
 #define ADC_MAX ((1 << 12) - 1) // 4095
 #define ADC_PIN_OFFSET 26
+
+#if ANALOG_FIXED_POINT
+// Stick values are ADC codes x4096 (0xFFF000 full scale), so every ADC code maps exactly and a
+// smoothed value keeps 12 bits below the code all the way to the output
+#define ANALOG_VALUE_SHIFT 12
+#define ANALOG_MAX (ADC_MAX << ANALOG_VALUE_SHIFT)
+#define ANALOG_CENTER (ANALOG_MAX / 2)
+#define ANALOG_MINIMUM 0
+#define ANALOG_SHIFT 16
+#define ANALOG_SCALE_SHIFT 24
+// Extra fractional bits in the EMA state, so small smoothing factors still converge
+#define ANALOG_EMA_SHIFT 6
+// Convert an option expressed in 1/div units to a Q16 or Q24 coefficient, or a stick value.
+// Only used in setup(); the smoothing factor option is a float.
+#define ANALOG_COEFFICIENT(value, div) ((analog_value_t)((((uint32_t)(value) << ANALOG_SHIFT) + ((div) / 2)) / (div)))
+#define ANALOG_FINE_COEFFICIENT(value, div) ((analog_value_t)((value) * (double)(1 << ANALOG_SCALE_SHIFT) / (div) + 0.5))
+#define ANALOG_FINE_RATIO(value, div) ((analog_value_t)(((uint32_t)(value) * ANALOG_MAX + ((div) / 2)) / (div)))
+
+// Bitwise integer square root, floor(sqrt(value)) for values below 2^48
+static inline uint32_t isqrt48(uint64_t value) {
+    uint64_t result = 0;
+    uint64_t bit = 1ULL << 46;
+    while (bit > value)
+        bit >>= 2;
+    while (bit != 0) {
+        if (value >= result + bit) {
+            value -= result + bit;
+            result = (result >> 1) + bit;
+        } else {
+            result >>= 1;
+        }
+        bit >>= 2;
+    }
+    return (uint32_t)result;
+}
+#else
 #define ANALOG_MAX 1.0f
 #define ANALOG_CENTER 0.5f
 #define ANALOG_MINIMUM 0.0f
+#define ANALOG_COEFFICIENT(value, div) ((value) / (float)(div))
+#define ANALOG_FINE_COEFFICIENT(value, div) ((value) / (float)(div))
+#define ANALOG_FINE_RATIO(value, div) ((value) / (float)(div))
+#endif
 
 bool AnalogInput::available() {
     return Storage::getInstance().getAddonOptions().analogOptions.enabled;
@@ -27,10 +68,10 @@ void AnalogInput::setup() {
     adc_pairs[0].analog_invert = analogOptions.analogAdc1Invert;
     adc_pairs[0].analog_dpad = analogOptions.analogAdc1Mode;
     adc_pairs[0].ema_option = analogOptions.analog_smoothing;
-    adc_pairs[0].ema_smoothing = analogOptions.smoothing_factor / 1000.0f;
-    adc_pairs[0].error_rate = analogOptions.analog_error / 1000.0f;
-    adc_pairs[0].in_deadzone = analogOptions.inner_deadzone / 100.0f;
-    adc_pairs[0].out_deadzone = analogOptions.outer_deadzone / 100.0f;
+    adc_pairs[0].ema_smoothing = ANALOG_FINE_COEFFICIENT(analogOptions.smoothing_factor, 1000);
+    adc_pairs[0].error_rate = ANALOG_COEFFICIENT(analogOptions.analog_error, 1000);
+    adc_pairs[0].in_deadzone = ANALOG_FINE_RATIO(analogOptions.inner_deadzone, 100);
+    adc_pairs[0].out_deadzone = ANALOG_FINE_RATIO(analogOptions.outer_deadzone, 100);
     adc_pairs[0].auto_calibration = analogOptions.auto_calibrate;
     adc_pairs[0].forced_circularity = analogOptions.forced_circularity;
     adc_pairs[1].x_pin = analogOptions.analogAdc2PinX;
@@ -38,47 +79,54 @@ void AnalogInput::setup() {
     adc_pairs[1].analog_invert = analogOptions.analogAdc2Invert;
     adc_pairs[1].analog_dpad = analogOptions.analogAdc2Mode;
     adc_pairs[1].ema_option = analogOptions.analog_smoothing2;
-    adc_pairs[1].ema_smoothing = analogOptions.smoothing_factor2 / 1000.0f;
-    adc_pairs[1].error_rate = analogOptions.analog_error2 / 1000.0f;
-    adc_pairs[1].in_deadzone = analogOptions.inner_deadzone2 / 100.0f;
-    adc_pairs[1].out_deadzone = analogOptions.outer_deadzone2 / 100.0f;
+    adc_pairs[1].ema_smoothing = ANALOG_FINE_COEFFICIENT(analogOptions.smoothing_factor2, 1000);
+    adc_pairs[1].error_rate = ANALOG_COEFFICIENT(analogOptions.analog_error2, 1000);
+    adc_pairs[1].in_deadzone = ANALOG_FINE_RATIO(analogOptions.inner_deadzone2, 100);
+    adc_pairs[1].out_deadzone = ANALOG_FINE_RATIO(analogOptions.outer_deadzone2, 100);
     adc_pairs[1].auto_calibration = analogOptions.auto_calibrate2;
     adc_pairs[1].forced_circularity = analogOptions.forced_circularity2;
     
 
+    adc = PeripheralManager::getInstance().getADC();
+
     // Setup defaults and helpers
     for (int i = 0; i < ADC_COUNT; i++) {
         adc_pairs[i].x_pin_adc = adc_pairs[i].x_pin - ADC_PIN_OFFSET;
         adc_pairs[i].y_pin_adc = adc_pairs[i].y_pin - ADC_PIN_OFFSET;
         adc_pairs[i].x_value = ANALOG_CENTER;
         adc_pairs[i].y_value = ANALOG_CENTER;
-        adc_pairs[i].xy_magnitude = 0.0f;
-        adc_pairs[i].x_magnitude = 0.0f;
-        adc_pairs[i].y_magnitude = 0.0f;
-        adc_pairs[i].x_ema = 0.0f;
-        adc_pairs[i].y_ema = 0.0f;
+        adc_pairs[i].xy_magnitude = 0;
+        adc_pairs[i].x_magnitude = 0;
+        adc_pairs[i].y_magnitude = 0;
+        adc_pairs[i].x_ema = 0;
+        adc_pairs[i].y_ema = 0;
+#if ANALOG_FIXED_POINT
+        // Reciprocal of the deadzone span (x2^24) so the per-sample rescale is a multiply
+        int32_t span = std::max(adc_pairs[i].out_deadzone - adc_pairs[i].in_deadzone, (int32_t)1 << ANALOG_VALUE_SHIFT);
+        adc_pairs[i].deadzone_scale = (uint32_t)std::min(((uint64_t)ANALOG_MAX << ANALOG_SCALE_SHIFT) / span, (uint64_t)UINT32_MAX);
+#else
+        adc_pairs[i].deadzone_scale = 0;
+#endif
     }
 
     // Intialize and auto center X/Y for each pair
     for (int i = 0; i < ADC_COUNT; i++) {
         if(isValidPin(adc_pairs[i].x_pin)) {
-            adc_gpio_init(adc_pairs[i].x_pin);
+            adc->addPin(adc_pairs[i].x_pin);
             if (adc_pairs[i].auto_calibration) {
-                adc_select_input(adc_pairs[i].x_pin - ADC_PIN_OFFSET);
-                adc_pairs[i].x_center = adc_read();
+                adc_pairs[i].x_center = adc->read(adc_pairs[i].x_pin_adc);
             }
         }
         if(isValidPin(adc_pairs[i].y_pin)) {
-            adc_gpio_init(adc_pairs[i].y_pin);
+            adc->addPin(adc_pairs[i].y_pin);
             if (adc_pairs[i].auto_calibration) {
-                adc_select_input(adc_pairs[i].y_pin - ADC_PIN_OFFSET);
-                adc_pairs[i].y_center = adc_read();
+                adc_pairs[i].y_center = adc->read(adc_pairs[i].y_pin_adc);
             }
         }
     }
 }
 
-void AnalogInput::process() {
+void HOT_PATH_FUNC(AnalogInput::process)() {
     Gamepad * gamepad = Storage::getInstance().GetGamepad();
     
     uint32_t joystickMid = GAMEPAD_JOYSTICK_MID;
@@ -98,7 +146,6 @@ void AnalogInput::process() {
             }
             if (adc_pairs[i].ema_option) {
                 adc_pairs[i].x_value = emaCalculation(i, adc_pairs[i].x_value, adc_pairs[i].x_ema);
-                adc_pairs[i].x_ema = adc_pairs[i].x_value;
             }
         }
         // Read Y-Axis
@@ -110,7 +157,6 @@ void AnalogInput::process() {
             }
             if (adc_pairs[i].ema_option) {
                 adc_pairs[i].y_value = emaCalculation(i, adc_pairs[i].y_value, adc_pairs[i].y_ema);
-                adc_pairs[i].y_ema = adc_pairs[i].y_value;
             }
         }
         // Look for dead-zones and circularity
@@ -123,8 +169,15 @@ void AnalogInput::process() {
         }
 
         // If MID is 0x8000, clamp our max to 0xFFFF incase we are at 0x10000. 0x7FFF will max at 0xFFFE
+#if ANALOG_FIXED_POINT
+        uint32_t scaledX = (uint32_t)(((uint64_t)joystickMax * (uint32_t)adc_pairs[i].x_value) / ANALOG_MAX);
+        uint32_t scaledY = (uint32_t)(((uint64_t)joystickMax * (uint32_t)adc_pairs[i].y_value) / ANALOG_MAX);
+        uint16_t clampedX = (uint16_t)std::min(scaledX, (uint32_t)0xFFFF);
+        uint16_t clampedY = (uint16_t)std::min(scaledY, (uint32_t)0xFFFF);
+#else
         uint16_t clampedX = (uint16_t)std::min((uint32_t)(joystickMax * std::min(adc_pairs[i].x_value, 1.0f)), (uint32_t)0xFFFF);
         uint16_t clampedY = (uint16_t)std::min((uint32_t)(joystickMax * std::min(adc_pairs[i].y_value, 1.0f)), (uint32_t)0xFFFF);
+#endif
 
         if (adc_pairs[i].analog_dpad == DpadMode::DPAD_MODE_LEFT_ANALOG) {
             gamepad->state.lx = clampedX;
@@ -136,9 +189,8 @@ void AnalogInput::process() {
     }
 }
 
-float AnalogInput::readPin(int stick_num, Pin_t pin_adc, uint16_t center) {
-    adc_select_input(pin_adc);
-    uint16_t adc_value = adc_read();
+analog_value_t AnalogInput::readPin(int stick_num, Pin_t pin_adc, uint16_t center) {
+    uint16_t adc_value = adc->read(pin_adc);
     if (adc_pairs[stick_num].auto_calibration) {
         if (adc_value > center) {
             adc_value = map(adc_value, center, ADC_MAX, ADC_MAX / 2, ADC_MAX);
@@ -148,24 +200,58 @@ float AnalogInput::readPin(int stick_num, Pin_t pin_adc, uint16_t center) {
             adc_value = map(adc_value, 0, center, 0, ADC_MAX / 2);
         }
     }
+#if ANALOG_FIXED_POINT
+    return adc_value * (ANALOG_MAX / ADC_MAX);
+#else
     return ((float)adc_value) / ADC_MAX;
+#endif
 }
 
-float AnalogInput::emaCalculation(int stick_num, float ema_value, float ema_previous) {
-    return (adc_pairs[stick_num].ema_smoothing * ema_value) + ((1.0f - adc_pairs[stick_num].ema_smoothing) * ema_previous);
+analog_value_t AnalogInput::emaCalculation(int stick_num, analog_value_t ema_value, analog_value_t & ema_previous) {
+#if ANALOG_FIXED_POINT
+    // Rounded rather than floored, so the state settles on the input from either side
+    int32_t delta = (ema_value << ANALOG_EMA_SHIFT) - ema_previous;
+    ema_previous += (int32_t)(((int64_t)delta * adc_pairs[stick_num].ema_smoothing + (1 << (ANALOG_SCALE_SHIFT - 1))) >> ANALOG_SCALE_SHIFT);
+    return (ema_previous + (1 << (ANALOG_EMA_SHIFT - 1))) >> ANALOG_EMA_SHIFT;
+#else
+    // Same EMA written as a step towards the input; a*v + (1-a)*e rounds (1-a) and settles off the input for small a
+    ema_previous += adc_pairs[stick_num].ema_smoothing * (ema_value - ema_previous);
+    return ema_previous;
+#endif
 }
 
 uint16_t AnalogInput::map(uint16_t x, uint16_t in_min, uint16_t in_max, uint16_t out_min, uint16_t out_max) {
     return (x - in_min) * (out_max - out_min) / (in_max - in_min) + out_min;
 }
 
-float AnalogInput::magnitudeCalculation(int stick_num, adc_instance & adc_inst) {
+analog_value_t AnalogInput::magnitudeCalculation(int stick_num, adc_instance & adc_inst) {
     adc_inst.x_magnitude = adc_inst.x_value - ANALOG_CENTER;
     adc_inst.y_magnitude = adc_inst.y_value - ANALOG_CENTER;
+#if ANALOG_FIXED_POINT
+    // Squared offsets sum to under 2^47, the root is already in stick value units
+    uint64_t sum = (uint64_t)((int64_t)adc_inst.x_magnitude * adc_inst.x_magnitude) + (uint64_t)((int64_t)adc_inst.y_magnitude * adc_inst.y_magnitude);
+    uint32_t magnitude = isqrt48(sum);
+    return (analog_value_t)(((uint64_t)magnitude * (uint32_t)adc_pairs[stick_num].error_rate + (1 << (ANALOG_SHIFT - 1))) >> ANALOG_SHIFT);
+#else
     return adc_pairs[stick_num].error_rate * std::sqrt((adc_inst.x_magnitude * adc_inst.x_magnitude) + (adc_inst.y_magnitude * adc_inst.y_magnitude));
+#endif
 }
 
 void AnalogInput::radialDeadzone(int stick_num, adc_instance & adc_inst) {
+#if ANALOG_FIXED_POINT
+    // Magnitude, deadzones and scaling factor are stick values; the per-axis gain is Q24
+    uint64_t scaling_factor = ((uint64_t)(adc_inst.xy_magnitude - adc_pairs[stick_num].in_deadzone) * adc_pairs[stick_num].deadzone_scale) >> ANALOG_SCALE_SHIFT;
+    if (adc_pairs[stick_num].forced_circularity == true) {
+        scaling_factor = std::min(scaling_factor, (uint64_t)ANALOG_CENTER);
+    }
+    uint32_t magnitude = std::max(adc_inst.xy_magnitude, (int32_t)1);
+    int64_t gain = (int64_t)(((scaling_factor << ANALOG_SCALE_SHIFT) + (magnitude / 2)) / magnitude);
+    const int64_t half = 1 << (ANALOG_SCALE_SHIFT - 1);
+    int64_t x_value = (((int64_t)adc_inst.x_magnitude * gain + half) >> ANALOG_SCALE_SHIFT) + ANALOG_CENTER;
+    int64_t y_value = (((int64_t)adc_inst.y_magnitude * gain + half) >> ANALOG_SCALE_SHIFT) + ANALOG_CENTER;
+    adc_inst.x_value = (analog_value_t)std::clamp(x_value, (int64_t)ANALOG_MINIMUM, (int64_t)ANALOG_MAX);
+    adc_inst.y_value = (analog_value_t)std::clamp(y_value, (int64_t)ANALOG_MINIMUM, (int64_t)ANALOG_MAX);
+#else
     float scaling_factor = (adc_inst.xy_magnitude - adc_pairs[stick_num].in_deadzone) / (adc_pairs[stick_num].out_deadzone - adc_pairs[stick_num].in_deadzone);
     if (adc_pairs[stick_num].forced_circularity == true) {
         scaling_factor = std::fmin(scaling_factor, ANALOG_CENTER);
@@ -174,4 +260,5 @@ void AnalogInput::radialDeadzone(int stick_num, adc_instance & adc_inst) {
     adc_inst.y_value = ((adc_inst.y_magnitude / adc_inst.xy_magnitude) * scaling_factor) + ANALOG_CENTER;
     adc_inst.x_value = std::clamp(adc_inst.x_value, ANALOG_MINIMUM, ANALOG_MAX);
     adc_inst.y_value = std::clamp(adc_inst.y_value, ANALOG_MINIMUM, ANALOG_MAX);
-}
\ No newline at end of file
+#endif
+}
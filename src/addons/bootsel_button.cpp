@@ -1,4 +1,5 @@
 #include "addons/bootsel_button.h"
+#include "hotpath.h"
 #include "storagemanager.h"
 #include "hardware/gpio.h"
 #include "hardware/sync.h"
@@ -47,7 +48,7 @@ void BootselButtonAddon::setup() {
 	bootselButtonMap = options.buttonMap;
 }
 
-void BootselButtonAddon::preprocess() {
+void HOT_PATH_FUNC(BootselButtonAddon::preprocess)() {
 	Gamepad * gamepad = Storage::getInstance().GetGamepad();
 	if (isBootselPressed()) {
 		switch (bootselButtonMap) {
@@ -60,22 +60,22 @@ void DRV8833RumbleAddon::setup() {
 	}
 }
 
-bool DRV8833RumbleAddon::compareRumbleState(Gamepad * gamepad) {
-	if (currentRumbleState.leftActuator.active == gamepad->auxState.haptics.leftActuator.active && 
-		currentRumbleState.leftActuator.intensity == gamepad->auxState.haptics.leftActuator.intensity && 
-		currentRumbleState.rightActuator.active == gamepad->auxState.haptics.rightActuator.active && 
-		currentRumbleState.rightActuator.intensity == gamepad->auxState.haptics.rightActuator.intensity)
+bool DRV8833RumbleAddon::compareRumbleState(const GamepadAuxHaptics & haptics) {
+	if (currentRumbleState.leftActuator.active == haptics.leftActuator.active && 
+		currentRumbleState.leftActuator.intensity == haptics.leftActuator.intensity && 
+		currentRumbleState.rightActuator.active == haptics.rightActuator.active && 
+		currentRumbleState.rightActuator.intensity == haptics.rightActuator.intensity)
 		return true;
 
 	return false;
 
 }
 
-void DRV8833RumbleAddon::setRumbleState(Gamepad * gamepad) {
-	currentRumbleState.leftActuator.active = gamepad->auxState.haptics.leftActuator.active;
-	currentRumbleState.leftActuator.intensity = gamepad->auxState.haptics.leftActuator.intensity;
-	currentRumbleState.rightActuator.active = gamepad->auxState.haptics.rightActuator.active;
-	currentRumbleState.rightActuator.intensity = gamepad->auxState.haptics.rightActuator.intensity;
+void DRV8833RumbleAddon::setRumbleState(const GamepadAuxHaptics & haptics) {
+	currentRumbleState.leftActuator.active = haptics.leftActuator.active;
+	currentRumbleState.leftActuator.intensity = haptics.leftActuator.intensity;
+	currentRumbleState.rightActuator.active = haptics.rightActuator.active;
+	currentRumbleState.rightActuator.intensity = haptics.rightActuator.intensity;
 }
 
 void DRV8833RumbleAddon::disableMotors() {
@@ -87,9 +87,9 @@ void DRV8833RumbleAddon::disableMotors() {
 	pwmSetFreqDuty(rightMotorPinSlice, rightMotorPinChannel, pwmFrequency, 0);
 }
 
-void DRV8833RumbleAddon::enableMotors(Gamepad * gamepad) {
-	pwmSetFreqDuty(leftMotorPinSlice, leftMotorPinChannel, pwmFrequency, (gamepad->auxState.haptics.leftActuator.intensity == 0) ? 0 : scaleDuty(motorToDuty(gamepad->auxState.haptics.leftActuator.intensity), dutyMin, dutyMax));
-	pwmSetFreqDuty(rightMotorPinSlice, rightMotorPinChannel, pwmFrequency, (gamepad->auxState.haptics.rightActuator.intensity == 0) ? 0 : scaleDuty(motorToDuty(gamepad->auxState.haptics.rightActuator.intensity), dutyMin, dutyMax));
+void DRV8833RumbleAddon::enableMotors(const GamepadAuxHaptics & haptics) {
+	pwmSetFreqDuty(leftMotorPinSlice, leftMotorPinChannel, pwmFrequency, (haptics.leftActuator.intensity == 0) ? 0 : scaleDuty(motorToDuty(haptics.leftActuator.intensity), dutyMin, dutyMax));
+	pwmSetFreqDuty(rightMotorPinSlice, rightMotorPinChannel, pwmFrequency, (haptics.rightActuator.intensity == 0) ? 0 : scaleDuty(motorToDuty(haptics.rightActuator.intensity), dutyMin, dutyMax));
 
 	// if motorSleepPin set and any motors are on, disable motor driver sleep mode
 	if (isValidPin(motorSleepPin))
@@ -97,15 +97,15 @@ void DRV8833RumbleAddon::enableMotors(Gamepad * gamepad) {
 }
 
 void DRV8833RumbleAddon::process() {
-	Gamepad * gamepad = Storage::getInstance().GetProcessedGamepad();
+	const GamepadAuxHaptics & haptics = Storage::getInstance().GetProcessedAuxState().haptics;
 
-	if (!compareRumbleState(gamepad)) {
-		setRumbleState(gamepad);
-		if (!(gamepad->auxState.haptics.leftActuator.active || gamepad->auxState.haptics.rightActuator.active)) {
+	if (!compareRumbleState(haptics)) {
+		setRumbleState(haptics);
+		if (!(haptics.leftActuator.active || haptics.rightActuator.active)) {
 			disableMotors();
 			return;
 		}
-		enableMotors(gamepad);
+		enableMotors(haptics);
 	}
 }
 
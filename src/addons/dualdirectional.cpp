@@ -1,4 +1,5 @@
 #include "addons/dualdirectional.h"
+#include "hotpath.h"
 #include "storagemanager.h"
 #include "helper.h"
 #include "config.pb.h"
@@ -97,7 +98,7 @@ uint8_t DualDirectionalInput::filterToFourWayModeDDI(uint8_t dpad)
 }
 
 
-void DualDirectionalInput::preprocess()
+void HOT_PATH_FUNC(DualDirectionalInput::preprocess)()
 {
     const DualDirectionalOptions& options = Storage::getInstance().getAddonOptions().dualDirectionalOptions;
     Gamepad * gamepad = Storage::getInstance().GetGamepad();
@@ -120,7 +121,7 @@ void DualDirectionalInput::preprocess()
     SOCDDualClean(socdMode);
 }
 
-void DualDirectionalInput::process()
+void HOT_PATH_FUNC(DualDirectionalInput::process)()
 {
     const DualDirectionalOptions& options = Storage::getInstance().getAddonOptions().dualDirectionalOptions;
     Gamepad * gamepad = Storage::getInstance().GetGamepad();
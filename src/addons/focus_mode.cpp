@@ -1,4 +1,5 @@
 #include "addons/focus_mode.h"
+#include "hotpath.h"
 #include "storagemanager.h"
 #include "hardware/gpio.h"
 
@@ -12,7 +13,7 @@ void FocusModeAddon::setup() {
 	buttonLockMask = options.buttonLockMask;
 }
 
-void FocusModeAddon::process() {
+void HOT_PATH_FUNC(FocusModeAddon::process)() {
 	Gamepad * gamepad = Storage::getInstance().GetGamepad();
 	const FocusModeOptions& options = Storage::getInstance().getAddonOptions().focusModeOptions;
 	// Override Enabled Focus-Mode Toggle OR the pin has been pressed
@@ -1,7 +1,7 @@
 #include "addons/he_trigger.h"
+#include "hotpath.h"
 #include "storagemanager.h"
-
-#include "hardware/adc.h"
+#include "peripheralmanager.h"
 
 #define ADC_MAX ((1 << 12) - 1) // 4095
 
@@ -11,7 +11,8 @@ bool HETriggerAddon::available() {
 
 void HETriggerAddon::setup() {
     HETriggerOptions & options = Storage::getInstance().getAddonOptions().heTriggerOptions;
-    this->muxTotal = 32 / options.muxChannels;
+    this->muxChannels = std::max(options.muxChannels, (int32_t)1);
+    this->muxTotal = HETRIGGER_COUNT / muxChannels;
     if ( this->muxTotal > 4 )
         this->muxTotal = 4; // Direct = 4, 4-Channel = 4, 8-Channel = 3, 16-Channel = 2
 
@@ -20,10 +21,9 @@ void HETriggerAddon::setup() {
     muxPinArray[1] = options.muxADCPin1;
     muxPinArray[2] = options.muxADCPin2;
     muxPinArray[3] = options.muxADCPin3;
-    for(int i = 0; i < muxTotal; i++) {
-        if ( muxPinArray[i] >= 26 && muxPinArray[i] <= 29 ) {
-            adc_gpio_init(muxPinArray[i]);
-        }
+    adc = PeripheralManager::getInstance().getADC();
+    for(int i = 0; i < 4; i++) {
+        muxInputArray[i] = (i < muxTotal) ? adc->addPin(muxPinArray[i]) : -1;
     }
 
     // Init our select pins
@@ -55,33 +55,116 @@ void HETriggerAddon::setup() {
         }
     }
 
-    lastADCSelected = -1;
+    // Output words for every channel so a mux switch is a single masked write
+    selectPinMask = 0;
+    for(int i = 0; i < selectPins; i++) {
+        if ( selectPinArray[i] != -1 )
+            selectPinMask |= (1 << selectPinArray[i]);
+    }
+    for(uint32_t c = 0; c < 16; c++) {
+        selectPinValues[c] = 0;
+        for(int i = 0; i < selectPins; i++) {
+            if ( selectPinArray[i] != -1 && ((c >> i) & 0x01) )
+                selectPinValues[c] |= (1 << selectPinArray[i]);
+        }
+    }
+
+    buildActionTable(options);
 
     if ( options.emaSmoothing == 1 ) {
         // Read all ADC values once
-        for(int i = 0; i < 32; i++) {
+        for(int i = 0; i < HETRIGGER_COUNT; i++) {
             // Ignore triggers with no actions
             if (options.triggers[i].action == -10 )
                 continue;
-            mux = (i / options.muxChannels);
-            channel = (i % options.muxChannels);
+            mux = (i / muxChannels);
+            channel = (i % muxChannels);
+            if ( mux >= 4 || muxInputArray[mux] == -1 )
+                continue;
             selectChannel(channel);
-            // Only Switch ADC if we are not currently on the mux ADC
-            if ( lastADCSelected != muxPinArray[mux]) {
-                adc_select_input(muxPinArray[mux]-26);
-                lastADCSelected = muxPinArray[mux];
-            }
-            emaSmoothingReads[i] = adc_read();
+            emaSmoothingReads[i] = adc->read(muxInputArray[mux]);
         }
         emaSmoothingFactor = (float)options.smoothingFactor / 100.f; // 99 = max smoothing factor
     }
+
+    // Channels sampled per loop, 0 scans every channel each loop
+    scanChannelsPerLoop = options.muxChannelsPerLoop;
+    if ( scanChannelsPerLoop <= 0 || scanChannelsPerLoop > muxChannels )
+        scanChannelsPerLoop = muxChannels;
+    activeTriggers = 0;
+    scanChannel = 0;
+    selectChannel(scanChannel);
+    scanMarker = adc->mark();
+}
+
+void HETriggerAddon::buildActionTable(const HETriggerOptions & options) {
+    for (uint8_t he = 0; he < HETRIGGER_COUNT; he++) {
+        HETriggerAction & entry = actionTable[he];
+        entry.buttons = 0;
+        entry.dpad = 0;
+        entry.aux = 0;
+        entry.axis = nullptr;
+        entry.axisValue = 0;
+        entry.menuAction = GpioAction::NONE;
+        switch (options.triggers[he].action) {
+            case GpioAction::BUTTON_PRESS_UP: entry.dpad = GAMEPAD_MASK_UP; break;
+            case GpioAction::BUTTON_PRESS_DOWN: entry.dpad = GAMEPAD_MASK_DOWN; break;
+            case GpioAction::BUTTON_PRESS_LEFT: entry.dpad = GAMEPAD_MASK_LEFT; break;
+            case GpioAction::BUTTON_PRESS_RIGHT: entry.dpad = GAMEPAD_MASK_RIGHT; break;
+            case GpioAction::BUTTON_PRESS_B1: entry.buttons = GAMEPAD_MASK_B1; break;
+            case GpioAction::BUTTON_PRESS_B2: entry.buttons = GAMEPAD_MASK_B2; break;
+            case GpioAction::BUTTON_PRESS_B3: entry.buttons = GAMEPAD_MASK_B3; break;
+            case GpioAction::BUTTON_PRESS_B4: entry.buttons = GAMEPAD_MASK_B4; break;
+            case GpioAction::BUTTON_PRESS_L1: entry.buttons = GAMEPAD_MASK_L1; break;
+            case GpioAction::BUTTON_PRESS_R1: entry.buttons = GAMEPAD_MASK_R1; break;
+            case GpioAction::BUTTON_PRESS_L2: entry.buttons = GAMEPAD_MASK_L2; break;
+            case GpioAction::BUTTON_PRESS_R2: entry.buttons = GAMEPAD_MASK_R2; break;
+            case GpioAction::BUTTON_PRESS_S1: entry.buttons = GAMEPAD_MASK_S1; break;
+            case GpioAction::BUTTON_PRESS_S2: entry.buttons = GAMEPAD_MASK_S2; break;
+            case GpioAction::BUTTON_PRESS_L3: entry.buttons = GAMEPAD_MASK_L3; break;
+            case GpioAction::BUTTON_PRESS_R3: entry.buttons = GAMEPAD_MASK_R3; break;
+            case GpioAction::BUTTON_PRESS_A1: entry.buttons = GAMEPAD_MASK_A1; break;
+            case GpioAction::BUTTON_PRESS_A2: entry.buttons = GAMEPAD_MASK_A2; break;
+            case GpioAction::BUTTON_PRESS_A3: entry.buttons = GAMEPAD_MASK_A3; break;
+            case GpioAction::BUTTON_PRESS_A4: entry.buttons = GAMEPAD_MASK_A4; break;
+            case GpioAction::BUTTON_PRESS_E1: entry.buttons = GAMEPAD_MASK_E1; break;
+            case GpioAction::BUTTON_PRESS_E2: entry.buttons = GAMEPAD_MASK_E2; break;
+            case GpioAction::BUTTON_PRESS_E3: entry.buttons = GAMEPAD_MASK_E3; break;
+            case GpioAction::BUTTON_PRESS_E4: entry.buttons = GAMEPAD_MASK_E4; break;
+            case GpioAction::BUTTON_PRESS_E5: entry.buttons = GAMEPAD_MASK_E5; break;
+            case GpioAction::BUTTON_PRESS_E6: entry.buttons = GAMEPAD_MASK_E6; break;
+            case GpioAction::BUTTON_PRESS_E7: entry.buttons = GAMEPAD_MASK_E7; break;
+            case GpioAction::BUTTON_PRESS_E8: entry.buttons = GAMEPAD_MASK_E8; break;
+            case GpioAction::BUTTON_PRESS_E9: entry.buttons = GAMEPAD_MASK_E9; break;
+            case GpioAction::BUTTON_PRESS_E10: entry.buttons = GAMEPAD_MASK_E10; break;
+            case GpioAction::BUTTON_PRESS_E11: entry.buttons = GAMEPAD_MASK_E11; break;
+            case GpioAction::BUTTON_PRESS_E12: entry.buttons = GAMEPAD_MASK_E12; break;
+            case GpioAction::ANALOG_DIRECTION_LS_X_NEG: entry.axis = &GamepadState::lx; entry.axisValue = GAMEPAD_JOYSTICK_MIN; break;
+            case GpioAction::ANALOG_DIRECTION_LS_X_POS: entry.axis = &GamepadState::lx; entry.axisValue = GAMEPAD_JOYSTICK_MAX; break;
+            case GpioAction::ANALOG_DIRECTION_LS_Y_NEG: entry.axis = &GamepadState::ly; entry.axisValue = GAMEPAD_JOYSTICK_MIN; break;
+            case GpioAction::ANALOG_DIRECTION_LS_Y_POS: entry.axis = &GamepadState::ly; entry.axisValue = GAMEPAD_JOYSTICK_MAX; break;
+            case GpioAction::ANALOG_DIRECTION_RS_X_NEG: entry.axis = &GamepadState::rx; entry.axisValue = GAMEPAD_JOYSTICK_MIN; break;
+            case GpioAction::ANALOG_DIRECTION_RS_X_POS: entry.axis = &GamepadState::rx; entry.axisValue = GAMEPAD_JOYSTICK_MAX; break;
+            case GpioAction::ANALOG_DIRECTION_RS_Y_NEG: entry.axis = &GamepadState::ry; entry.axisValue = GAMEPAD_JOYSTICK_MIN; break;
+            case GpioAction::ANALOG_DIRECTION_RS_Y_POS: entry.axis = &GamepadState::ry; entry.axisValue = GAMEPAD_JOYSTICK_MAX; break;
+            case GpioAction::BUTTON_PRESS_FN: entry.aux = AUX_MASK_FUNCTION; break;
+            case GpioAction::MENU_NAVIGATION_UP:
+            case GpioAction::MENU_NAVIGATION_DOWN:
+            case GpioAction::MENU_NAVIGATION_LEFT:
+            case GpioAction::MENU_NAVIGATION_RIGHT:
+            case GpioAction::MENU_NAVIGATION_SELECT:
+            case GpioAction::MENU_NAVIGATION_BACK:
+            case GpioAction::MENU_NAVIGATION_TOGGLE:
+                entry.menuAction = options.triggers[he].action;
+                break;
+            default: break;
+        }
+    }
 }
 
 void HETriggerAddon::selectChannel(uint8_t channel) {
-    for(int i = 0; i < selectPins; i++) {
-        if ( selectPinArray[i] != -1 ) {
-            gpio_put(selectPinArray[i], (channel >> i) & 0x01);
-        }   
+    if ( selectPinMask != 0 ) {
+        gpio_put_masked(selectPinMask, selectPinValues[channel]);
     }
 }
 
@@ -91,22 +174,13 @@ uint16_t HETriggerAddon::emaSmoothing(uint16_t value, uint16_t previous) {
     return ((emaSmoothingFactor*ema_value) + ((1.0f-emaSmoothingFactor) * ema_previous)) * ADC_MAX;
 }
 
-void HETriggerAddon::preprocess() {
-    Gamepad * gamepad = Storage::getInstance().GetGamepad();
-    HETriggerOptions & options = Storage::getInstance().getAddonOptions().heTriggerOptions;
-    for (uint8_t he = 0; he < 32; he++) {
+void HETriggerAddon::sampleChannel(const HETriggerOptions & options) {
+    for (mux = 0; mux < (uint32_t)muxTotal; mux++) {
+        uint8_t he = (mux * muxChannels) + channel;
         // Ignore triggers with no actions
-        if (options.triggers[he].action == -10 )
+        if (he >= HETRIGGER_COUNT || options.triggers[he].action == -10 || muxInputArray[mux] == -1)
             continue;
-        mux = (he / options.muxChannels);
-        channel = (he % options.muxChannels);
-        selectChannel(channel);
-        // Only Switch ADC if we are not currently on the mux ADC
-        if ( lastADCSelected != muxPinArray[mux]) {
-            adc_select_input(muxPinArray[mux]-26);
-            lastADCSelected = muxPinArray[mux];
-        }
-        value = adc_read();
+        value = adc->read(muxInputArray[mux]);
 
         // EMA Smoothing
         if ( options.emaSmoothing == 1 ) {
@@ -115,57 +189,48 @@ void HETriggerAddon::preprocess() {
         }
 
         if (value >= options.triggers[he].active) {
-            switch (options.triggers[he].action) {
-                case GpioAction::BUTTON_PRESS_UP: gamepad->state.dpad |= GAMEPAD_MASK_UP; break;
-                case GpioAction::BUTTON_PRESS_DOWN: gamepad->state.dpad |= GAMEPAD_MASK_DOWN; break;
-                case GpioAction::BUTTON_PRESS_LEFT: gamepad->state.dpad |= GAMEPAD_MASK_LEFT; break;
-                case GpioAction::BUTTON_PRESS_RIGHT: gamepad->state.dpad |= GAMEPAD_MASK_RIGHT; break;
-                case GpioAction::BUTTON_PRESS_B1: gamepad->state.buttons |= GAMEPAD_MASK_B1; break;
-                case GpioAction::BUTTON_PRESS_B2: gamepad->state.buttons |= GAMEPAD_MASK_B2; break;
-                case GpioAction::BUTTON_PRESS_B3: gamepad->state.buttons |= GAMEPAD_MASK_B3; break;
-                case GpioAction::BUTTON_PRESS_B4: gamepad->state.buttons |= GAMEPAD_MASK_B4; break;
-                case GpioAction::BUTTON_PRESS_L1: gamepad->state.buttons |= GAMEPAD_MASK_L1; break;
-                case GpioAction::BUTTON_PRESS_R1: gamepad->state.buttons |= GAMEPAD_MASK_R1; break;
-                case GpioAction::BUTTON_PRESS_L2: gamepad->state.buttons |= GAMEPAD_MASK_L2; break;
-                case GpioAction::BUTTON_PRESS_R2: gamepad->state.buttons |= GAMEPAD_MASK_R2; break;
-                case GpioAction::BUTTON_PRESS_S1: gamepad->state.buttons |= GAMEPAD_MASK_S1; break;
-                case GpioAction::BUTTON_PRESS_S2: gamepad->state.buttons |= GAMEPAD_MASK_S2; break;
-                case GpioAction::BUTTON_PRESS_L3: gamepad->state.buttons |= GAMEPAD_MASK_L3; break;
-                case GpioAction::BUTTON_PRESS_R3: gamepad->state.buttons |= GAMEPAD_MASK_R3; break;
-                case GpioAction::BUTTON_PRESS_A1: gamepad->state.buttons |= GAMEPAD_MASK_A1; break;
-                case GpioAction::BUTTON_PRESS_A2: gamepad->state.buttons |= GAMEPAD_MASK_A2; break;
-                case GpioAction::BUTTON_PRESS_A3: gamepad->state.buttons |= GAMEPAD_MASK_A3; break;
-                case GpioAction::BUTTON_PRESS_A4: gamepad->state.buttons |= GAMEPAD_MASK_A4; break;
-                case GpioAction::BUTTON_PRESS_E1: gamepad->state.buttons |= GAMEPAD_MASK_E1; break;
-                case GpioAction::BUTTON_PRESS_E2: gamepad->state.buttons |= GAMEPAD_MASK_E2; break;
-                case GpioAction::BUTTON_PRESS_E3: gamepad->state.buttons |= GAMEPAD_MASK_E3; break;
-                case GpioAction::BUTTON_PRESS_E4: gamepad->state.buttons |= GAMEPAD_MASK_E4; break;
-                case GpioAction::BUTTON_PRESS_E5: gamepad->state.buttons |= GAMEPAD_MASK_E5; break;
-                case GpioAction::BUTTON_PRESS_E6: gamepad->state.buttons |= GAMEPAD_MASK_E6; break;
-                case GpioAction::BUTTON_PRESS_E7: gamepad->state.buttons |= GAMEPAD_MASK_E7; break;
-                case GpioAction::BUTTON_PRESS_E8: gamepad->state.buttons |= GAMEPAD_MASK_E8; break;
-                case GpioAction::BUTTON_PRESS_E9: gamepad->state.buttons |= GAMEPAD_MASK_E9; break;
-                case GpioAction::BUTTON_PRESS_E10: gamepad->state.buttons |= GAMEPAD_MASK_E10; break;
-                case GpioAction::BUTTON_PRESS_E11: gamepad->state.buttons |= GAMEPAD_MASK_E11; break;
-                case GpioAction::BUTTON_PRESS_E12: gamepad->state.buttons |= GAMEPAD_MASK_E12; break;                
-                case GpioAction::ANALOG_DIRECTION_LS_X_NEG:	gamepad->state.lx = GAMEPAD_JOYSTICK_MIN; break;
-			    case GpioAction::ANALOG_DIRECTION_LS_X_POS:	gamepad->state.lx = GAMEPAD_JOYSTICK_MAX; break;
-			    case GpioAction::ANALOG_DIRECTION_LS_Y_NEG:	gamepad->state.ly = GAMEPAD_JOYSTICK_MIN; break;
-			    case GpioAction::ANALOG_DIRECTION_LS_Y_POS:	gamepad->state.ly = GAMEPAD_JOYSTICK_MAX; break;
-			    case GpioAction::ANALOG_DIRECTION_RS_X_NEG:	gamepad->state.rx = GAMEPAD_JOYSTICK_MIN; break;
-			    case GpioAction::ANALOG_DIRECTION_RS_X_POS:	gamepad->state.rx = GAMEPAD_JOYSTICK_MAX; break;
-                case GpioAction::ANALOG_DIRECTION_RS_Y_NEG:	gamepad->state.ry = GAMEPAD_JOYSTICK_MIN; break;
-                case GpioAction::ANALOG_DIRECTION_RS_Y_POS:	gamepad->state.ry = GAMEPAD_JOYSTICK_MAX; break;
-                case GpioAction::BUTTON_PRESS_FN:	gamepad->state.aux |= AUX_MASK_FUNCTION; break;
-                case GpioAction::MENU_NAVIGATION_UP: EventManager::getInstance().triggerEvent(new GPMenuNavigateEvent(GpioAction::MENU_NAVIGATION_UP)); break;
-                case GpioAction::MENU_NAVIGATION_DOWN: EventManager::getInstance().triggerEvent(new GPMenuNavigateEvent(GpioAction::MENU_NAVIGATION_DOWN)); break;
-                case GpioAction::MENU_NAVIGATION_LEFT: EventManager::getInstance().triggerEvent(new GPMenuNavigateEvent(GpioAction::MENU_NAVIGATION_LEFT)); break;
-                case GpioAction::MENU_NAVIGATION_RIGHT: EventManager::getInstance().triggerEvent(new GPMenuNavigateEvent(GpioAction::MENU_NAVIGATION_RIGHT)); break;
-                case GpioAction::MENU_NAVIGATION_SELECT: EventManager::getInstance().triggerEvent(new GPMenuNavigateEvent(GpioAction::MENU_NAVIGATION_SELECT)); break;
-                case GpioAction::MENU_NAVIGATION_BACK: EventManager::getInstance().triggerEvent(new GPMenuNavigateEvent(GpioAction::MENU_NAVIGATION_BACK)); break;
-                case GpioAction::MENU_NAVIGATION_TOGGLE: EventManager::getInstance().triggerEvent(new GPMenuNavigateEvent(GpioAction::MENU_NAVIGATION_TOGGLE)); break;
-                default: break;
-            }
+            activeTriggers |= (1UL << he);
+        } else {
+            activeTriggers &= ~(1UL << he);
+        }
+    }
+}
+
+void HOT_PATH_FUNC(HETriggerAddon::preprocess)() {
+    Gamepad * gamepad = Storage::getInstance().GetGamepad();
+    HETriggerOptions & options = Storage::getInstance().getAddonOptions().heTriggerOptions;
+
+    // The next channel was selected at the end of the previous pass, so the mux has
+    // settled and been converted while the rest of the loop ran. Select pins are shared
+    // by every mux, so each pass samples one channel across all muxes.
+    for (int32_t pass = 0; pass < scanChannelsPerLoop; pass++) {
+        if ( selectPins > 0 )
+            adc->waitForSweep(scanMarker);
+        channel = scanChannel;
+        sampleChannel(options);
+
+        scanChannel = (scanChannel + 1) % muxChannels;
+        if ( selectPins > 0 ) {
+            selectChannel(scanChannel);
+            scanMarker = adc->mark();
+        }
+    }
+
+    // Apply the held state of every active trigger from the precomputed action table
+    uint32_t active = activeTriggers;
+    while (active) {
+        uint8_t he = __builtin_ctz(active);
+        active &= active - 1;
+        const HETriggerAction & entry = actionTable[he];
+        gamepad->state.dpad |= entry.dpad;
+        gamepad->state.buttons |= entry.buttons;
+        gamepad->state.aux |= entry.aux;
+        if (entry.axis != nullptr) {
+            gamepad->state.*entry.axis = entry.axisValue;
+        }
+        if (entry.menuAction != GpioAction::NONE) {
+            GPMenuNavigateEvent event(entry.menuAction);
+            EventManager::getInstance().triggerEvent(event);
         }
     }
 }
@@ -1,4 +1,5 @@
 #include "addons/input_macro.h"
+#include "hotpath.h"
 #include "storagemanager.h"
 #include "GamepadState.h"
 
@@ -241,7 +242,7 @@ void InputMacro::runCurrentMacro() {
     }
 }
 
-void InputMacro::preprocess()
+void HOT_PATH_FUNC(InputMacro::preprocess)()
 {
     FocusModeOptions * focusModeOptions = &Storage::getInstance().getAddonOptions().focusModeOptions;
     if (focusModeOptions->enabled && focusModeOptions->macroLockEnabled) {
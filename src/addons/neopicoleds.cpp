@@ -135,7 +135,7 @@ PLEDAnimationState getXInputAnimationNEOPICO(uint16_t ledState)
     return animationState;
 }
 
-PLEDAnimationState getXBoneAnimationNEOPICO(Gamepad * gamepad)
+PLEDAnimationState getXBoneAnimationNEOPICO(const GamepadAuxPlayerID & playerID)
 {
     PLEDAnimationState animationState =
     {
@@ -143,7 +143,7 @@ PLEDAnimationState getXBoneAnimationNEOPICO(Gamepad * gamepad)
         .animation = PLED_ANIM_OFF
     };
 
-    if ( gamepad->auxState.playerID.ledValue == 1 ) { 
+    if ( playerID.ledValue == 1 ) { 
         animationState.animation = PLED_ANIM_SOLID;
     }
 
@@ -327,6 +327,8 @@ void NeoPicoLEDAddon::ambientLightCustom() {
 	uint8_t alStartIndex = ledOptions.caseRGBIndex;
 	uint8_t multipleOfCustomStaticThemeCount;
 	uint8_t remainderOfCustomStaticThemeCount;
+	uint32_t alValue;
+	uint16_t alScale;
 	int maxFrame = (int)ledOptions.caseRGBCount;
 	if ( maxFrame > FRAME_MAX - alStartIndex )
 		maxFrame = FRAME_MAX - alStartIndex; // make sure we don't go over 100 and overflow frame[]
@@ -334,8 +336,9 @@ void NeoPicoLEDAddon::ambientLightCustom() {
 	// Start-up Animations in Haute were here
 	switch(options.ambientLightEffectsCountIndex) {
 		case AL_CUSTOM_EFFECT_STATIC_COLOR: 
+			alValue = alCustomStaticColors[options.alCustomStaticColorIndex].value(Animation::format, options.alStaticColorBrightnessCustomX);
 			for(int i = 0; i < maxFrame; i++) {
-				frame[alStartIndex + i] = alCustomStaticColors[options.alCustomStaticColorIndex].value(Animation::format, options.alStaticColorBrightnessCustomX);
+				frame[alStartIndex + i] = alValue;
 			}
 			break;
 
@@ -371,8 +374,9 @@ void NeoPicoLEDAddon::ambientLightCustom() {
 				}
 			}
 			// Fill Frame
+			alValue = ambientLight.value(Animation::format, options.alGradientBrightnessCustomX);
 			for(int i = 0; i < maxFrame; i++){
-				frame[alStartIndex + i] = ambientLight.value(Animation::format, options.alGradientBrightnessCustomX);
+				frame[alStartIndex + i] = alValue;
 			}
 			break;
 		case AL_CUSTOM_EFFECT_CHASE: 
@@ -417,13 +421,14 @@ void NeoPicoLEDAddon::ambientLightCustom() {
 				frame[alStartIndex + j] = 0x0;
 			}
 			// Fill up to four pixels forward
+			alValue = ambientLight.value(Animation::format, options.alChaseBrightnessCustomX);
 			for(int i = 0; i < CHASE_LIGHTS_TURN_ON && chaseLightIndex + i < chaseLightMaxIndexPos; i++) {
-				frame[chaseLightIndex + i] = ambientLight.value(Animation::format, options.alChaseBrightnessCustomX);
+				frame[chaseLightIndex + i] = alValue;
 			}
 			// Fill up to 3 pixels in the beginning of our casergb (wrap-around)
 			if ( chaseLightIndex + CHASE_LIGHTS_TURN_ON > chaseLightMaxIndexPos ) {
 				for(int i = 0; i < (chaseLightIndex + CHASE_LIGHTS_TURN_ON) - chaseLightMaxIndexPos; i++) {
-					frame[alStartIndex + i] = ambientLight.value(Animation::format, options.alChaseBrightnessCustomX);
+					frame[alStartIndex + i] = alValue;
 				}
 			}
 			break;
@@ -464,22 +469,24 @@ void NeoPicoLEDAddon::ambientLightCustom() {
 				breathLedEffectCycle = 0;	
 			}
 			// Fill Frame
+			alValue = ambientLight.value(Animation::format, alBrightnessBreathX);
 			for(int i = 0; i < maxFrame; i++) {
-				frame[alStartIndex + i] = ambientLight.value(Animation::format, alBrightnessBreathX);
+				frame[alStartIndex + i] = alValue;
 			}
 			break;
 		case AL_CUSTOM_EFFECT_STATIC_THEME:
+			alScale = brightnessScale(options.alStaticBrightnessCustomThemeX);
 			multipleOfCustomStaticThemeCount = maxFrame / AL_COL;
 			remainderOfCustomStaticThemeCount = maxFrame % AL_COL;
 			// Fill frame with extras on remainder
 			for(int i = 0; i < multipleOfCustomStaticThemeCount; i++){
 				for(int j = 0; j < AL_COL; j++){
-					frame[alStartIndex + i*AL_COL + j] = alCustomStaticTheme[options.alCustomStaticThemeIndex][j].value(Animation::format, options.alStaticBrightnessCustomThemeX);
+					frame[alStartIndex + i*AL_COL + j] = alCustomStaticTheme[options.alCustomStaticThemeIndex][j].scaledValue(Animation::format, alScale);
 				}
 			}
 			if(remainderOfCustomStaticThemeCount != 0){
 				for(int k = 0; k < remainderOfCustomStaticThemeCount; k++){
-					frame[alStartIndex + multipleOfCustomStaticThemeCount * AL_COL + k] = alCustomStaticTheme[options.alCustomStaticThemeIndex][k].value(Animation::format, options.alStaticBrightnessCustomThemeX);
+					frame[alStartIndex + multipleOfCustomStaticThemeCount * AL_COL + k] = alCustomStaticTheme[options.alCustomStaticThemeIndex][k].scaledValue(Animation::format, alScale);
 				}
 			}
 			break;
@@ -489,16 +496,16 @@ void NeoPicoLEDAddon::ambientLightCustom() {
 }
 
 void NeoPicoLEDAddon::ambientLightLinkage() {
-	float preLinkageBrightnessX = as.GetLinkageModeOfBrightnessX();
+	const BrightnessTable & linkageBrightness = as.GetLinkageBrightnessTable();
 	for(int i = 0; i < multipleOfButtonLedsCount; i++){ // Repeat buttons
 		for(int j = 0; j < buttonLedCount; j++){
-			frame[alLinkageStartIndex + i*buttonLedCount + j] = as.linkageFrame[j].value(Animation::format, preLinkageBrightnessX);
+			frame[alLinkageStartIndex + i*buttonLedCount + j] = as.linkageFrame[j].value(Animation::format, linkageBrightness);
 		}
 	}
 	
 	if(remainderOfButtonLedsCount != 0){ // Remainder
 		for(int k = 0; k < remainderOfButtonLedsCount; k++){
-			frame[alLinkageStartIndex + multipleOfButtonLedsCount * buttonLedCount + k] = as.linkageFrame[k].value(Animation::format, preLinkageBrightnessX);
+			frame[alLinkageStartIndex + multipleOfButtonLedsCount * buttonLedCount + k] = as.linkageFrame[k].value(Animation::format, linkageBrightness);
 		}
 	}
 }
@@ -513,26 +520,27 @@ void NeoPicoLEDAddon::process() {
     // Get turbo options (turbo RGB led)
     const TurboOptions& turboOptions = Storage::getInstance().getAddonOptions().turboOptions;
     Gamepad * gamepad = Storage::getInstance().GetProcessedGamepad();
+    const GamepadAuxState & auxState = Storage::getInstance().GetProcessedAuxState();
     GamepadHotkey action = animationHotkeys(gamepad);
     if (ledOptions.pledType == PLED_TYPE_RGB) {
-        if (gamepad->auxState.playerID.enabled && gamepad->auxState.playerID.active) {
+        if (auxState.playerID.enabled && auxState.playerID.active) {
             switch (gamepad->getOptions().inputMode) {
                 case INPUT_MODE_XINPUT:
-                    animationState = getXInputAnimationNEOPICO(gamepad->auxState.playerID.ledValue);
+                    animationState = getXInputAnimationNEOPICO(auxState.playerID.ledValue);
                     break;
                 case INPUT_MODE_PS3:
-                    animationState = getPS3AnimationNEOPICO(gamepad->auxState.playerID.ledValue);
+                    animationState = getPS3AnimationNEOPICO(auxState.playerID.ledValue);
                     break;
                 case INPUT_MODE_PS4:
                 case INPUT_MODE_PS5:
                 case INPUT_MODE_P5GENERAL:
-                    animationState = getPS4AnimationNEOPICO(gamepad->auxState.playerID.ledBlinkOn, gamepad->auxState.playerID.ledBlinkOff);
+                    animationState = getPS4AnimationNEOPICO(auxState.playerID.ledBlinkOn, auxState.playerID.ledBlinkOff);
                     break;
                 case INPUT_MODE_XBONE:
-                    animationState = getXBoneAnimationNEOPICO(gamepad);
+                    animationState = getXBoneAnimationNEOPICO(auxState.playerID);
                     break;
                 case INPUT_MODE_SWITCH_PRO:
-                    animationState = getSwitchProAnimationNEOPICO(gamepad->auxState.playerID.ledValue);
+                    animationState = getSwitchProAnimationNEOPICO(auxState.playerID.ledValue);
                     break;
                 default:
                     break;
@@ -549,17 +557,9 @@ void NeoPicoLEDAddon::process() {
     }
 
     uint32_t buttonState = gamepad->state.dpad << 16 | gamepad->state.buttons;
-    vector<Pixel> pressed;
-    for (auto row : matrix.pixels)
-    {
-        for (auto pixel : row)
-        {
-            if (buttonState & pixel.mask)
-                pressed.push_back(pixel);
-        }
-    }
-    if (pressed.size() > 0)
-        as.HandlePressed(pressed);
+    uint32_t pressedMask = matrix.getPressedMask(buttonState);
+    if (pressedMask != 0)
+        as.HandlePressed(pressedMask);
     else
         as.ClearPressed();
 
@@ -582,12 +582,13 @@ void NeoPicoLEDAddon::process() {
             if (pledIndexes[i] < 0 || pledIndexes[i] > 99)
                 continue;
 
-            float level = (static_cast<float>(PLED_MAX_LEVEL - neoPLEDs->getLedLevels()[i]) / static_cast<float>(PLED_MAX_LEVEL));
-            float brightness = as.GetBrightnessX() * level;
-            if (gamepad->auxState.sensors.statusLight.enabled && gamepad->auxState.sensors.statusLight.active) {
-                rgbPLEDValues[i] = (RGB(gamepad->auxState.sensors.statusLight.color.red, gamepad->auxState.sensors.statusLight.color.green, gamepad->auxState.sensors.statusLight.color.blue)).value(neopico.GetFormat(), brightness);
+            uint32_t level = PLED_MAX_LEVEL - neoPLEDs->getLedLevels()[i];
+            // Rounded, the scale is already rounded once and truncating again can be off by 2 per channel
+            uint16_t brightness = (as.GetBrightnessScale() * level + PLED_MAX_LEVEL / 2) / PLED_MAX_LEVEL;
+            if (auxState.sensors.statusLight.enabled && auxState.sensors.statusLight.active) {
+                rgbPLEDValues[i] = (RGB(auxState.sensors.statusLight.color.red, auxState.sensors.statusLight.color.green, auxState.sensors.statusLight.color.blue)).scaledValue(neopico.GetFormat(), brightness);
             } else {
-                rgbPLEDValues[i] = ((RGB)ledOptions.pledColor).value(neopico.GetFormat(), brightness);
+                rgbPLEDValues[i] = ((RGB)ledOptions.pledColor).scaledValue(neopico.GetFormat(), brightness);
             }
             frame[pledIndexes[i]] = rgbPLEDValues[i];
         }
@@ -595,10 +596,10 @@ void NeoPicoLEDAddon::process() {
 
     // Turbo LED is a separate RGB that is on if turbo is on, and off if its off
     if ( turboOptions.turboLedType == PLED_TYPE_RGB ) { // RGB or PWM?
-        if ( gamepad->auxState.turbo.activity == 1) { // Turbo is on (active sensor)
+        if ( auxState.turbo.activity == 1) { // Turbo is on (active sensor)
             if (turboOptions.turboLedIndex >= 0 && turboOptions.turboLedIndex < 100) { // Double check index value
-                float brightness = as.GetBrightnessX();
-                frame[turboOptions.turboLedIndex] = ((RGB)turboOptions.turboLedColor).value(neopico.GetFormat(), brightness);
+                uint16_t brightness = as.GetBrightnessScale();
+                frame[turboOptions.turboLedIndex] = ((RGB)turboOptions.turboLedColor).scaledValue(neopico.GetFormat(), brightness);
             }
         }
     }
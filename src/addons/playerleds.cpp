@@ -132,9 +132,10 @@ void PlayerLEDAddon::process()
 		if (pwmLEDs != nullptr)
 			pwmLEDs->display();
 
-		if (gamepad->auxState.playerID.enabled && gamepad->auxState.playerID.active) {
+		const GamepadAuxPlayerID & playerID = Storage::getInstance().GetProcessedAuxState().playerID;
+		if (playerID.enabled && playerID.active) {
 			if (gamepad->getOptions().inputMode == INPUT_MODE_XINPUT) {
-				animationState = getXInputAnimationPWM(gamepad->auxState.playerID.ledValue);
+				animationState = getXInputAnimationPWM(playerID.ledValue);
 			}
 		}
 
@@ -1,4 +1,5 @@
 #include "addons/reverse.h"
+#include "hotpath.h"
 #include "storagemanager.h"
 #include "GamepadEnums.h"
 #include "helper.h"
@@ -68,7 +69,7 @@ uint8_t ReverseInput::input(uint32_t valueMask, uint16_t buttonMask, uint16_t bu
     return (valueMask ? (invert ? buttonMaskReverse : buttonMask) : 0);
 }
 
-void ReverseInput::process()
+void HOT_PATH_FUNC(ReverseInput::process)()
 {
     // Update Reverse State
     update();
@@ -1,4 +1,5 @@
 #include "addons/rotaryencoder.h"
+#include "hotpath.h"
 
 #include "eventmanager.h"
 #include "storagemanager.h"
@@ -9,6 +10,22 @@
 #include "helper.h"
 #include "config.pb.h"
 
+#include "hardware/gpio.h"
+#include "hardware/irq.h"
+
+#define ENCODER_EDGES (GPIO_IRQ_EDGE_RISE | GPIO_IRQ_EDGE_FALL)
+
+// Step for each previous (bits 3:2) and current (bits 1:0) A:B level pair,
+// transitions that skip a state can't be resolved and are ignored
+static const int8_t QUADRATURE_STEPS[16] = {
+     0, -1,  1,  0,
+     1,  0,  0, -1,
+    -1,  0,  0,  1,
+     0,  1, -1,  0,
+};
+
+RotaryEncoderInput * RotaryEncoderInput::instance = nullptr;
+
 bool RotaryEncoderInput::available() {
     const RotaryOptions& options = Storage::getInstance().getAddonOptions().rotaryOptions;
     return options.enabled;
@@ -52,6 +69,9 @@ void RotaryEncoderInput::setup()
             gpio_init(encoderMap[i].pinB);             // Initialize pin
             gpio_set_dir(encoderMap[i].pinB, GPIO_IN); // Set as INPUT
             gpio_pull_up(encoderMap[i].pinB);          // Set as PULLUP
+
+            encoderState[i] = EncoderPinState();
+            encoderState[i].levels = readLevels(i, gpio_get_all());
         }
     
         if ((encoderMap[i].mode == ENCODER_MODE_LEFT_TRIGGER) || (encoderMap[i].mode == ENCODER_MODE_RIGHT_TRIGGER)) {
@@ -63,9 +83,59 @@ void RotaryEncoderInput::setup()
             encoderMap[i].maxRange = GAMEPAD_JOYSTICK_MAX;
         }
     }
+
+    // Count every edge from the pin IRQ so loop stalls can't drop quadrature transitions
+    uint32_t encoderPinMask = 0;
+    for (uint8_t i = 0; i < MAX_ENCODERS; i++) {
+        if (encoderMap[i].enabled)
+            encoderPinMask |= (1u << encoderMap[i].pinA) | (1u << encoderMap[i].pinB);
+    }
+
+    if (encoderPinMask != 0) {
+        instance = this;
+        gpio_add_raw_irq_handler_masked(encoderPinMask, encoderIRQ);
+        for (uint8_t i = 0; i < MAX_ENCODERS; i++) {
+            if (encoderMap[i].enabled) {
+                gpio_acknowledge_irq(encoderMap[i].pinA, ENCODER_EDGES);
+                gpio_acknowledge_irq(encoderMap[i].pinB, ENCODER_EDGES);
+                gpio_set_irq_enabled(encoderMap[i].pinA, ENCODER_EDGES, true);
+                gpio_set_irq_enabled(encoderMap[i].pinB, ENCODER_EDGES, true);
+            }
+        }
+        irq_set_enabled(IO_IRQ_BANK0, true);
+    }
+}
+
+uint8_t RotaryEncoderInput::readLevels(uint8_t index, uint32_t pins) {
+    return (((pins >> encoderMap[index].pinA) & 1) << 1) | ((pins >> encoderMap[index].pinB) & 1);
+}
+
+void __not_in_flash_func(RotaryEncoderInput::encoderIRQ)() {
+    RotaryEncoderInput * encoder = instance;
+    if (encoder == nullptr)
+        return;
+
+    for (uint8_t i = 0; i < MAX_ENCODERS; i++) {
+        if (!encoder->encoderMap[i].enabled)
+            continue;
+
+        uint8_t pinA = encoder->encoderMap[i].pinA;
+        uint8_t pinB = encoder->encoderMap[i].pinB;
+        if (!((gpio_get_irq_event_mask(pinA) | gpio_get_irq_event_mask(pinB)) & ENCODER_EDGES))
+            continue;
+
+        // Acknowledge before sampling so an edge landing after the read raises the IRQ again
+        gpio_acknowledge_irq(pinA, ENCODER_EDGES);
+        gpio_acknowledge_irq(pinB, ENCODER_EDGES);
+
+        EncoderPinState & state = encoder->encoderState[i];
+        uint8_t levels = encoder->readLevels(i, gpio_get_all());
+        state.count = state.count + QUADRATURE_STEPS[(state.levels << 2) | levels];
+        state.levels = levels;
+    }
 }
 
-void RotaryEncoderInput::process()
+void HOT_PATH_FUNC(RotaryEncoderInput::process)()
 {
     Gamepad * gamepad = Storage::getInstance().GetGamepad();
 
@@ -73,29 +143,14 @@ void RotaryEncoderInput::process()
 
     for (uint8_t i = 0; i < MAX_ENCODERS; i++) {
         if (encoderMap[i].enabled) {
-            uint32_t lastUpdate = now - encoderState[i].updateTime;
-
-            if (lastUpdate >= encoderState[i].delay) {
-                bool pinAValue = gpio_get(encoderMap[i].pinA);
-                bool pinBValue = gpio_get(encoderMap[i].pinB);
-
-                uint32_t encoderIncrement = (ENCODER_RADIUS / (encoderMap[i].pulsesPerRevolution / (ENCODER_PRECISION * encoderMap[i].multiplier)));
-
-                if (encoderState[i].pinA != pinAValue || encoderState[i].pinB != pinBValue) {
-                    if ((encoderState[i].pinA == encoderState[i].prevA) && (encoderState[i].pinB == encoderState[i].prevB)) {
-                        if ((encoderState[i].pinA && !encoderState[i].pinB && pinBValue) || (!encoderState[i].pinA && encoderState[i].pinB && !pinBValue)) {
-                            encoderValues[i]+=encoderIncrement;
-                        } else if ((!encoderState[i].pinA && encoderState[i].pinB && pinBValue) || (encoderState[i].pinA && !encoderState[i].pinB && !pinBValue)) {
-                            encoderValues[i]-=encoderIncrement;
-                        }
-                    }
-                }
-
-                encoderState[i].pinA = pinAValue;
-                encoderState[i].pinB = pinBValue;
-                encoderState[i].prevA = pinAValue;
-                encoderState[i].prevB = pinBValue;
-                encoderState[i].updateTime = now;
+            uint32_t encoderIncrement = (ENCODER_RADIUS / (encoderMap[i].pulsesPerRevolution / (ENCODER_PRECISION * encoderMap[i].multiplier)));
+
+            // The value moves once per half quadrature cycle, the IRQ counts every edge
+            int32_t count = encoderState[i].count;
+            int32_t steps = (count - encoderState[i].appliedCount) / 2;
+            if (steps != 0) {
+                encoderValues[i] += steps * (int32_t)encoderIncrement;
+                encoderState[i].appliedCount += steps * 2;
             }
         }
     }
@@ -131,11 +186,8 @@ void RotaryEncoderInput::process()
             if ((encoderValues[i] - prevValues[i]) != 0) {
                 encoderState[i].changeTime = now;
 
-                if ((encoderValues[i] - prevValues[i]) > 0) {
-                    EventManager::getInstance().triggerEvent(new GPEncoderChangeEvent(i, 1));
-                } else if ((encoderValues[i] - prevValues[i]) < 0) {
-                    EventManager::getInstance().triggerEvent(new GPEncoderChangeEvent(i, -1));
-                }
+                GPEncoderChangeEvent event(i, ((encoderValues[i] - prevValues[i]) > 0) ? 1 : -1);
+                EventManager::getInstance().triggerEvent(event);
             }
 
             if ((encoderMap[i].resetAfter > 0) && (lastChange >= encoderMap[i].resetAfter)) {
@@ -1,4 +1,5 @@
 #include "addons/slider_socd.h"
+#include "hotpath.h"
 
 #include "enums.pb.h"
 #include "storagemanager.h"
@@ -53,7 +54,7 @@ void SliderSOCDInput::reinit()
     this->setup();
 }
 
-void SliderSOCDInput::process()
+void HOT_PATH_FUNC(SliderSOCDInput::process)()
 {
     // Get Slider State
     SOCDMode socdState = read();
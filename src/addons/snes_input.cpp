@@ -1,6 +1,8 @@
 #include "addons/snes_input.h"
+#include "hotpath.h"
 #include "drivermanager.h"
 #include "storagemanager.h"
+#include "peripheralmanager.h"
 #include "hardware/gpio.h"
 #include "helper.h"
 
@@ -15,23 +17,26 @@ bool SNESpadInput::available() {
 
 void SNESpadInput::setup() {
     const SNESOptions& snesOptions = Storage::getInstance().getAddonOptions().snesOptions;
-    nextTimer = getMillis();
 
 #if SNES_PAD_DEBUG==true
     stdio_init_all();
 #endif
 
-    uIntervalMS = 0;
-
     snes = new SNESpad(
         snesOptions.clockPin,
         snesOptions.latchPin,
         snesOptions.dataPin);
-    snes->begin();
+
+    // PIO USB host needs both PIO blocks, keep bit-banging alongside it
+    if (SNES_PAD_POLL_INTERVAL_US > 0 && !PeripheralManager::getInstance().isUSBEnabled(0)) {
+        snes->begin(SNES_PAD_POLL_INTERVAL_US);
+    } else {
+        snes->begin();
+    }
     snes->start();
 
     // Run during setup to catch boot selection mode
-    snes->poll();
+    snes->poll(true);
 
     if (snes->type == SNES_PAD_BASIC) {
         buttonA = snes->buttonA;
@@ -80,68 +85,78 @@ void SNESpadInput::setup() {
     }
 }
 
-void SNESpadInput::process() {
-    if (nextTimer < getMillis()) {
-        snes->poll();
-
-        uint16_t joystickMid = GAMEPAD_JOYSTICK_MID;
-        if ( DriverManager::getInstance().getDriver() != nullptr ) {
-            joystickMid = DriverManager::getInstance().getDriver()->GetJoystickMidValue();
-        }
-
-        leftX = joystickMid;
-        leftY = joystickMid;
-        rightX = joystickMid;
-        rightY = joystickMid;
-
-        if (snes->type == SNES_PAD_BASIC) {
-            buttonA = snes->buttonA;
-            buttonB = snes->buttonB;
-            buttonX = snes->buttonX;
-            buttonY = snes->buttonY;
-            buttonL = snes->buttonL;
-            buttonR = snes->buttonR;
-            dpadUp = snes->directionUp;
-            dpadDown = snes->directionDown;
-            dpadLeft = snes->directionLeft;
-            dpadRight = snes->directionRight;
-            buttonSelect = snes->buttonSelect;
-            buttonStart = snes->buttonStart;
-
-        } else if (snes->type == SNES_PAD_NES) {
-            buttonA = snes->buttonA;
-            buttonB = snes->buttonB;
-            buttonX = false;
-            buttonY = false;
-            buttonL = false;
-            buttonR = false;
-            dpadUp = snes->directionUp;
-            dpadDown = snes->directionDown;
-            dpadLeft = snes->directionLeft;
-            dpadRight = snes->directionRight;
-            buttonSelect = snes->buttonSelect;
-            buttonStart = snes->buttonStart;
-
-        } else if (snes->type == SNES_PAD_MOUSE){
-            buttonA = snes->buttonA;
-            buttonB = snes->buttonB;
-            buttonX = false;
-            buttonY = false;
-            buttonL = false;
-            buttonR = false;
-            dpadUp = false;
-            dpadDown = false;
-            dpadLeft = false;
-            dpadRight = false;
-            buttonSelect = false;
-            buttonStart = false;
-
-            leftX = map(snes->mouseX,0,255,GAMEPAD_JOYSTICK_MIN,GAMEPAD_JOYSTICK_MAX);
-            leftY = map(snes->mouseY,0,255,GAMEPAD_JOYSTICK_MIN,GAMEPAD_JOYSTICK_MAX);
-
-        }
-
-        nextTimer = getMillis() + uIntervalMS;
+void HOT_PATH_FUNC(SNESpadInput::process)() {
+    snes->poll();
+
+    uint16_t joystickMid = GAMEPAD_JOYSTICK_MID;
+    if ( DriverManager::getInstance().getDriver() != nullptr ) {
+        joystickMid = DriverManager::getInstance().getDriver()->GetJoystickMidValue();
+    }
+
+    leftX = joystickMid;
+    leftY = joystickMid;
+    rightX = joystickMid;
+    rightY = joystickMid;
+
+    if (snes->type == SNES_PAD_BASIC) {
+        buttonA = snes->buttonA;
+        buttonB = snes->buttonB;
+        buttonX = snes->buttonX;
+        buttonY = snes->buttonY;
+        buttonL = snes->buttonL;
+        buttonR = snes->buttonR;
+        dpadUp = snes->directionUp;
+        dpadDown = snes->directionDown;
+        dpadLeft = snes->directionLeft;
+        dpadRight = snes->directionRight;
+        buttonSelect = snes->buttonSelect;
+        buttonStart = snes->buttonStart;
+
+    } else if (snes->type == SNES_PAD_NES) {
+        buttonA = snes->buttonA;
+        buttonB = snes->buttonB;
+        buttonX = false;
+        buttonY = false;
+        buttonL = false;
+        buttonR = false;
+        dpadUp = snes->directionUp;
+        dpadDown = snes->directionDown;
+        dpadLeft = snes->directionLeft;
+        dpadRight = snes->directionRight;
+        buttonSelect = snes->buttonSelect;
+        buttonStart = snes->buttonStart;
+
+    } else if (snes->type == SNES_PAD_MOUSE){
+        buttonA = snes->buttonA;
+        buttonB = snes->buttonB;
+        buttonX = false;
+        buttonY = false;
+        buttonL = false;
+        buttonR = false;
+        dpadUp = false;
+        dpadDown = false;
+        dpadLeft = false;
+        dpadRight = false;
+        buttonSelect = false;
+        buttonStart = false;
+
+        leftX = map(snes->mouseX,0,255,GAMEPAD_JOYSTICK_MIN,GAMEPAD_JOYSTICK_MAX);
+        leftY = map(snes->mouseY,0,255,GAMEPAD_JOYSTICK_MIN,GAMEPAD_JOYSTICK_MAX);
+
+    } else {
+        // unplugged, nothing stays held
+        buttonA = false;
+        buttonB = false;
+        buttonX = false;
+        buttonY = false;
+        buttonL = false;
+        buttonR = false;
+        dpadUp = false;
+        dpadDown = false;
+        dpadLeft = false;
+        dpadRight = false;
+        buttonSelect = false;
+        buttonStart = false;
     }
 
     Gamepad * gamepad = Storage::getInstance().GetGamepad();
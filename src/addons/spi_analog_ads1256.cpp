@@ -11,25 +11,30 @@ void SPIAnalog1256Input::setup() {
     PeripheralSPI* spi = PeripheralManager::getInstance().getSPI(options.spiBlock);
     enableTriggers = options.enableTriggers;
     readChannelCount = 4 + (enableTriggers ? 2 : 0);
-    analogMax = options.avdd;
 
     Gamepad * gamepad = Storage::getInstance().GetGamepad();
     gamepad->hasAnalogTriggers = enableTriggers;
 
     // Init our ADS1256 library
     ads = new ADS1256(spi, options.drdyPin, -1, -1, options.csPin, (float)ADS1256_VREF_VOLTAGE);
-    ads->init(ADS1256_DRATE_30000SPS, ADS1256_PGA_1, true);
-}
+    ads->init(SPI_ANALOG1256_STICK_DRATE, ADS1256_PGA_1, true);
 
-void SPIAnalog1256Input::process() {
-    // Read the first X channels
-    for (uint8_t i = 0; i < readChannelCount; i++) {
-        values[i] = ads->convertToVoltage(ads->cycleSingle());
+    for (uint8_t i = 4; i < readChannelCount; i++) {
+        ads->setChannelRate(i, SPI_ANALOG1256_TRIGGER_DRATE);
     }
 
-    // Tells the ADC we're done sampling and flags to reset
-    // the read cycle next time an ADC read is performed
-    ads->stopConversion();
+    int32_t maxCode = ads->convertToCode(options.avdd);
+    analogMaxCode = std::max(maxCode, (int32_t)1);
+    scale16 = ((uint64_t)0xFFFF << SPI_ANALOG1256_SCALE_SHIFT) / analogMaxCode;
+    scale8 = ((uint64_t)0xFF << SPI_ANALOG1256_SCALE_SHIFT) / analogMaxCode;
+
+    // Channels are cycled from the DRDY interrupt from here on
+    ads->startAcquisition(readChannelCount);
+}
+
+void SPIAnalog1256Input::process() {
+    uint32_t values[ADS1256_CHANNEL_COUNT];
+    ads->getResults(values, readChannelCount);
 
     Gamepad * gamepad = Storage::getInstance().GetGamepad();
 
@@ -45,12 +50,16 @@ void SPIAnalog1256Input::process() {
     }
 }
 
-uint8_t SPIAnalog1256Input::convert24to8bit(float voltage) {
-    float ratio = std::clamp(voltage, 0.0f, analogMax) / analogMax;
-    return (uint8_t)(255.f * ratio);
+uint8_t SPIAnalog1256Input::convert24to8bit(uint32_t code) {
+    int32_t value = (int32_t)(code << 8) >> 8; // sign extend the 24-bit reading
+    if (value <= 0) return 0;
+    if ((uint32_t)value >= analogMaxCode) return 0xFF;
+    return ((uint64_t)value * scale8) >> SPI_ANALOG1256_SCALE_SHIFT;
 }
 
-uint16_t SPIAnalog1256Input::convert24to16bit(float voltage) {
-    float ratio = std::clamp(voltage, 0.0f, analogMax) / analogMax;
-    return (uint16_t)(65535.f * ratio);
+uint16_t SPIAnalog1256Input::convert24to16bit(uint32_t code) {
+    int32_t value = (int32_t)(code << 8) >> 8; // sign extend the 24-bit reading
+    if (value <= 0) return 0;
+    if ((uint32_t)value >= analogMaxCode) return 0xFFFF;
+    return ((uint64_t)value * scale16) >> SPI_ANALOG1256_SCALE_SHIFT;
 }
@@ -1,7 +1,9 @@
 #include "addons/tg16_input.h"
+#include "hotpath.h"
 #include "drivermanager.h"
 #include "storagemanager.h"
 #include "hardware/gpio.h"
+#include "pico/time.h"
 #include "helper.h"
 
 #if TG16_PAD_DEBUG==true
@@ -13,11 +15,10 @@
 #define CLR_PIN(pin) gpio_put(pin, 0)
 #define READ_PIN(pin) gpio_get(pin)
 
-// 6-button support state
+// 6-button support state, only touched from the read steps
 static bool sixButtonMode = false;
 static uint32_t sixButtonTimeout = 0;
 #define SIX_BUTTON_TIMEOUT_MS 150
-static int sixButtonSequenceStep = 0;
 
 // Extra buttons for 6-button mode
 static bool buttonIII = false;
@@ -25,20 +26,15 @@ static bool buttonIV = false;
 static bool buttonV = false;
 static bool buttonVI = false;
 
-// Helper to detect 6-button sequence (3 rapid reads with SELECT high/low)
-static void detectSixButtonSequence(bool selectState) {
-    // Sequence: High, Low, High (SEL)
-    static int lastSelect = -1;
-    if (lastSelect == -1) lastSelect = selectState;
-    if (selectState != lastSelect) {
-        sixButtonSequenceStep++;
-        lastSelect = selectState;
-        if (sixButtonSequenceStep >= 3) {
-            sixButtonMode = true;
-            sixButtonTimeout = getMillis() + SIX_BUTTON_TIMEOUT_MS;
-            sixButtonSequenceStep = 0;
-        }
-    }
+// Helper to detect the 6-button extra frame. A 6-button pad alternates frames on every OE cycle, and
+// on the extra one it reports all four directions held (which a d-pad can't do) with SELECT high,
+// then III, IV, V, VI with SELECT low
+static bool detectSixButtonSequence(uint8_t directions) {
+    if (directions != 0x0F)
+        return false;
+    sixButtonMode = true;
+    sixButtonTimeout = getMillis() + SIX_BUTTON_TIMEOUT_MS;
+    return true;
 }
 
 bool TG16padInput::available()
@@ -54,79 +50,112 @@ bool TG16padInput::available()
 void TG16padInput::setup()
 {
 	const TG16Options &tg16Options = Storage::getInstance().getAddonOptions().tg16Options;
-	nextTimer = getMillis();
-	uIntervalMS = 0;
+	oePin = tg16Options.oePin;
+	selectPin = tg16Options.selectPin;
+	// First data pin is the lowest bit of each nibble
+	dataPins[0] = tg16Options.dataPin3;
+	dataPins[1] = tg16Options.dataPin2;
+	dataPins[2] = tg16Options.dataPin1;
+	dataPins[3] = tg16Options.dataPin0;
 
 	// Set up OE and SELECT as outputs
-	gpio_init(tg16Options.oePin);
-	gpio_set_dir(tg16Options.oePin, GPIO_OUT);
-	gpio_init(tg16Options.selectPin);
-	gpio_set_dir(tg16Options.selectPin, GPIO_OUT);
+	gpio_init(oePin);
+	gpio_set_dir(oePin, GPIO_OUT);
+	gpio_init(selectPin);
+	gpio_set_dir(selectPin, GPIO_OUT);
 
 	// Set up data pins as inputs with pull-ups
-	int dataPins[4] = {tg16Options.dataPin0, tg16Options.dataPin1, tg16Options.dataPin2, tg16Options.dataPin3};
 	for (int i = 0; i < 4; ++i)
 	{
 		gpio_init(dataPins[i]);
 		gpio_set_dir(dataPins[i], GPIO_IN);
 		gpio_pull_up(dataPins[i]);
 	}
+
+	// Clock the pad from a timer so the settle time between steps never blocks the loop
+	readStep = TG16_READ_OE;
+	readNibbles[0] = readNibbles[1] = readNibbles[2] = 0;
+	extraFrame = false;
+	latestData = 0;
+	nextReadStep = make_timeout_time_us(TG16_PAD_STEP_US);
+	readTimerRunning = add_repeating_timer_us(-TG16_PAD_STEP_US, readTimerCallback, this, &readTimer);
 }
 
-uint8_t TG16padInput::readController()
+void HOT_PATH_FUNC(TG16padInput::preprocess)()
 {
-    const TG16Options &tg16Options = Storage::getInstance().getAddonOptions().tg16Options;
-    int dataPins[4] = {tg16Options.dataPin3, tg16Options.dataPin2, tg16Options.dataPin1, tg16Options.dataPin0};
-    uint8_t a = 0, b = 0, c = 0;
-    // Set OE active (active low)
-    CLR_PIN(tg16Options.oePin);
-    sleep_ms(1);
-
-    // SELECT high, read first nibble
-    SET_PIN(tg16Options.selectPin);
-    sleep_ms(1);
-    for (int i = 0; i < 4; ++i)
-    {
-        if (!READ_PIN(dataPins[i])) // active low
-            a |= (1 << i);
+    // Without a free alarm slot the steps are polled from the loop instead, still without sleeping
+    if (!readTimerRunning && time_reached(nextReadStep)) {
+        readStepController();
+        nextReadStep = make_timeout_time_us(TG16_PAD_STEP_US);
     }
-    // Detect 6-button sequence (SEL high)
-    detectSixButtonSequence(1);
+}
 
-    // SELECT low, read second nibble
-    CLR_PIN(tg16Options.selectPin);
-    sleep_ms(1);
+bool TG16padInput::readTimerCallback(repeating_timer_t * rt)
+{
+    static_cast<TG16padInput*>(rt->user_data)->readStepController();
+    return true;
+}
+
+uint8_t TG16padInput::readNibble()
+{
+    uint32_t gpio = ~gpio_get_all(); // active low
+    uint8_t nibble = 0;
     for (int i = 0; i < 4; ++i)
     {
-        if (!READ_PIN(dataPins[i])) // active low
-            b |= (1 << i);
+        if (gpio & (1UL << dataPins[i]))
+            nibble |= (1 << i);
     }
-    // Detect 6-button sequence (SEL low)
-    detectSixButtonSequence(0);
-
-    // If in 6-button mode, read third nibble (extra buttons)
-    if (sixButtonMode) {
-        // SELECT high again
-        SET_PIN(tg16Options.selectPin);
-        sleep_ms(1);
-        for (int i = 0; i < 4; ++i)
-        {
-            if (!READ_PIN(dataPins[i])) // active low
-                c |= (1 << i);
+    return nibble;
+}
+
+// Advance the pad read by one step; each step runs TG16_PAD_STEP_US after the last so
+// the lines have settled, replacing the sleep_ms(1) calls between them
+void TG16padInput::readStepController()
+{
+    switch (readStep) {
+        case TG16_READ_OE:
+            // Set OE active (active low)
+            CLR_PIN(oePin);
+            readStep = TG16_READ_SELECT_HIGH;
+            break;
+        case TG16_READ_SELECT_HIGH:
+            // SELECT high, first nibble is read on the next step
+            SET_PIN(selectPin);
+            readStep = TG16_READ_FIRST;
+            break;
+        case TG16_READ_FIRST: {
+            uint8_t directions = readNibble();
+            // Detect 6-button extra frame (SEL high), the directions from the last normal frame stand
+            extraFrame = detectSixButtonSequence(directions);
+            if (!extraFrame)
+                readNibbles[0] = directions;
+            // SELECT low, read second nibble
+            CLR_PIN(selectPin);
+            readStep = TG16_READ_SECOND;
+            break;
         }
-        // After reading, revert SELECT to low
-        CLR_PIN(tg16Options.selectPin);
+        case TG16_READ_SECOND:
+            // I, II, Select, Run, or III, IV, V, VI on the extra frame
+            readNibbles[extraFrame ? 2 : 1] = readNibble();
+            finishRead();
+            break;
     }
+}
 
+void TG16padInput::finishRead()
+{
     // Set OE inactive
-    SET_PIN(tg16Options.oePin);
+    SET_PIN(oePin);
 
-    // Pack nibbles: a = 1st (I,II,Select,Run), b = 2nd (Up,Right,Down,Left), c = 3rd (III,IV,V,VI)
-    if (sixButtonMode) {
-        return (a & 0x0F) | ((b & 0x0F) << 4) | ((c & 0x0F) << 8); // 12 bits
-    } else {
-        return (a & 0x0F) | ((b & 0x0F) << 4); // 8 bits
+    // Timeout for 6-button mode, the extra buttons go with it
+    if (sixButtonMode && getMillis() > sixButtonTimeout) {
+        sixButtonMode = false;
+        readNibbles[2] = 0;
     }
+
+    // Pack nibbles: a = 1st (Up,Right,Down,Left), b = 2nd (I,II,Select,Run), c = extra frame (III,IV,V,VI)
+    latestData = (readNibbles[0] & 0x0F) | ((readNibbles[1] & 0x0F) << 4) | ((readNibbles[2] & 0x0F) << 8);
+    readStep = TG16_READ_OE;
 }
 
 void TG16padInput::updateButtons(uint16_t data)
@@ -140,11 +169,11 @@ void TG16padInput::updateButtons(uint16_t data)
     dpadRight = data & 0x04;
     dpadDown = data & 0x02;
     dpadLeft = data & 0x01;
-    // 6-button extra: bits 8-11 (III, IV, V, VI)
-    buttonIII = data & 0x100;
-    buttonIV  = data & 0x200;
-    buttonV   = data & 0x400;
-    buttonVI  = data & 0x800;
+    // 6-button extra: bits 11-8 (III, IV, V, VI), in the same data pin order as I, II, Select, Run
+    buttonIII = data & 0x800;
+    buttonIV  = data & 0x400;
+    buttonV   = data & 0x200;
+    buttonVI  = data & 0x100;
     // Map dpad to analog stick
     leftX = dpadLeft ? GAMEPAD_JOYSTICK_MIN : (dpadRight ? GAMEPAD_JOYSTICK_MAX : GAMEPAD_JOYSTICK_MID);
     leftY = dpadUp ? GAMEPAD_JOYSTICK_MIN : (dpadDown ? GAMEPAD_JOYSTICK_MAX : GAMEPAD_JOYSTICK_MID);
@@ -152,23 +181,13 @@ void TG16padInput::updateButtons(uint16_t data)
     rightY = GAMEPAD_JOYSTICK_MID;
 }
 
-void TG16padInput::process()
+void HOT_PATH_FUNC(TG16padInput::process)()
 {
-    if (nextTimer < getMillis())
-    {
-        uint16_t data = readController();
-        updateButtons(data);
-        nextTimer = getMillis() + uIntervalMS;
-    }
-    // Timeout for 6-button mode
-    if (sixButtonMode && getMillis() > sixButtonTimeout) {
-        sixButtonMode = false;
-    }
+    updateButtons(latestData);
 #if TG16_PAD_DEBUG==true
     stdio_init_all();
-    const TG16Options &tg16Options = Storage::getInstance().getAddonOptions().tg16Options;
-    int oeState = gpio_get(tg16Options.oePin);
-    int selectState = gpio_get(tg16Options.selectPin);
+    int oeState = gpio_get(oePin);
+    int selectState = gpio_get(selectPin);
     printf(
         "OE: %d SELECT: %d | I=%1d II=%1d III=%1d IV=%1d V=%1d VI=%1d Select=%1d Run=%1d Up=%1d Down=%1d Left=%1d Right=%1d | 6btn: %d\n",
         oeState, selectState,
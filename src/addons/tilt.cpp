@@ -1,4 +1,5 @@
 #include "addons/tilt.h"
+#include "hotpath.h"
 #include "drivermanager.h"
 #include "storagemanager.h"
 #include "helper.h"
@@ -34,7 +35,7 @@ void TiltInput::setup() {
 	}
 }
 
-void TiltInput::preprocess()
+void HOT_PATH_FUNC(TiltInput::preprocess)()
 {
 	Gamepad* gamepad = Storage::getInstance().GetGamepad();
 	Mask_t values = Storage::getInstance().GetGamepad()->debouncedGpio;
@@ -58,7 +59,7 @@ void TiltInput::preprocess()
 	gamepad->state.dpad = gamepadState;
 }
 
-void TiltInput::process()
+void HOT_PATH_FUNC(TiltInput::process)()
 {
 	const TiltOptions& options = Storage::getInstance().getAddonOptions().tiltOptions;
 	
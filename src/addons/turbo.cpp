@@ -1,8 +1,8 @@
 #include "addons/turbo.h"
-
-#include "hardware/adc.h"
+#include "hotpath.h"
 
 #include "storagemanager.h"
+#include "peripheralmanager.h"
 #include "helper.h"
 #include "config.pb.h"
 
@@ -42,12 +42,11 @@ void TurboInput::setup(){
 
     // Turbo Dial
     uint8_t shotCount = std::clamp<uint8_t>(options.shotCount, TURBO_SHOT_MIN, TURBO_SHOT_MAX);
-    if (isValidPin(options.shmupDialPin)) {
+    int8_t dialInput = isValidPin(options.shmupDialPin) ? PeripheralManager::getInstance().getADC()->addPin(options.shmupDialPin) : -1;
+    if (dialInput != -1) {
         hasShmupDial = true;
-        adc_gpio_init(options.shmupDialPin);
-        adcShmupDial = 26 - options.shmupDialPin;
-        adc_select_input(adcShmupDial);
-        dialValue = adc_read(); // setup initial Dial + Turbo Speed
+        adcShmupDial = dialInput;
+        dialValue = PeripheralManager::getInstance().getADC()->read(adcShmupDial); // setup initial Dial + Turbo Speed
         shotCount = (dialValue / TURBO_DIAL_INCREMENTS) + TURBO_SHOT_MIN;
     } else {
         dialValue = 0;
@@ -123,7 +122,7 @@ void TurboInput::reinit()
     }
 }
 
-void TurboInput::process()
+void HOT_PATH_FUNC(TurboInput::process)()
 {
     Gamepad * gamepad = Storage::getInstance().GetGamepad();
     const TurboOptions& options = Storage::getInstance().getAddonOptions().turboOptions;
@@ -182,8 +181,7 @@ void TurboInput::process()
 
     // Use the dial to modify our turbo shot speed (don't save on dial modify)
     if (hasShmupDial && nextAdcRead < now) {
-        adc_select_input(adcShmupDial);
-        dialValue = adc_read();
+        dialValue = PeripheralManager::getInstance().getADC()->readAverage(adcShmupDial);
         uint8_t shotCount = (dialValue / TURBO_DIAL_INCREMENTS) + TURBO_SHOT_MIN;
         if (shotCount != options.shotCount) {
             updateTurboShotCount(shotCount, false);
@@ -21,8 +21,8 @@ Animation::Animation(PixelMatrix &matrix) : matrix(&matrix) {
   }
 }
 
-void Animation::UpdatePixels(std::vector<Pixel> inpixels) {
-  this->pixels = inpixels;
+void Animation::UpdatePixels(uint32_t pressedMask) {
+  this->pressedMask = pressedMask;
 }
 
 void Animation::UpdateTime() {
@@ -35,11 +35,14 @@ void Animation::UpdateTime() {
 }
 
 void Animation::UpdatePresses(RGB (&frame)[100]) {
+  if (this->pressedMask == 0)
+    return;
+
   // Queue up blend on hit
-  for (size_t p = 0; p < pixels.size(); p++) {
-    if (pixels[p].index != NO_PIXEL.index) {
-      times[pixels[p].index] = coolDownTimeInMs;
-      hitColor[pixels[p].index] = frame[pixels[p].positions[0]];
+  for (auto &pixel : matrix->buttonPixels) {
+    if (pixel.mask & this->pressedMask) {
+      times[pixel.index] = coolDownTimeInMs;
+      hitColor[pixel.index] = frame[pixel.positions[0]];
     }
   }
 }
@@ -52,23 +55,17 @@ void Animation::DecrementFadeCounter(int32_t index) {
 }
 
 void Animation::ClearPixels() {
-  this->pixels.clear();
+  this->pressedMask = 0;
 }
 
 /* Some of these animations are filtered to specific pixels, such as button press animations.
 This somewhat backwards named method determines if a specific pixel is _not_ included in the filter */
-bool Animation::notInFilter(Pixel pixel) {
+bool Animation::notInFilter(const Pixel &pixel) const {
   if (!this->filtered) {
     return false;
   }
 
-  for (size_t i = 0; i < this->pixels.size(); i++) {
-    if (pixel == this->pixels.at(i)) {
-      return false;
-    }
-  }
-
-  return true;
+  return (pixel.mask & this->pressedMask) == 0;
 }
 
 RGB Animation::BlendColor(RGB start, RGB end, uint32_t timeRemainingInMs) {
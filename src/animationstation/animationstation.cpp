@@ -13,8 +13,10 @@
 AnimationStation::AnimationStation() {
     brightnessMax = 100;
     brightnessSteps = 5;
-    brightnessX = 0;
-    linkageModeOfBrightnessX = 0;
+    brightnessLevel = 0;
+    linkageBrightnessLevel = 0;
+    brightnessTable.setup(0);
+    linkageBrightnessTable.setup(0);
     nextChange = nil_time;
     effectCount = TOTAL_EFFECTS;
 }
@@ -112,10 +114,10 @@ uint16_t AnimationStation::AdjustIndex(int changeSize) {
   return static_cast<uint16_t>(newIndex);
 }
 
-void AnimationStation::HandlePressed(std::vector<Pixel> pressed) {
-  this->lastPressed = pressed;
-  this->baseAnimation->UpdatePixels(pressed);  
-  this->buttonAnimation->UpdatePixels(pressed);
+void AnimationStation::HandlePressed(uint32_t pressedMask) {
+  this->lastPressed = pressedMask;
+  this->baseAnimation->UpdatePixels(pressedMask);
+  this->buttonAnimation->UpdatePixels(pressedMask);
 }
 
 void AnimationStation::ClearPressed() {
@@ -126,7 +128,7 @@ void AnimationStation::ClearPressed() {
     this->baseAnimation->ClearPixels();
   }
 
-  this->lastPressed.clear();
+  this->lastPressed = 0;
 }
 
 void AnimationStation::Animate() {
@@ -150,12 +152,8 @@ void AnimationStation::Clear() {
   memset(frame, 0, sizeof(frame));
 }
 
-float AnimationStation::GetBrightnessX() {
-  return brightnessX;
-}
-
-float AnimationStation::GetLinkageModeOfBrightnessX() {
-  return linkageModeOfBrightnessX;
+uint16_t AnimationStation::GetBrightnessScale() {
+  return ((uint16_t)brightnessLevel * BRIGHTNESS_SCALE_ONE + 127) / 255;
 }
 
 uint8_t AnimationStation::GetBrightness() {
@@ -217,25 +215,31 @@ void AnimationStation::SetMatrix(PixelMatrix matrix) {
 
 void AnimationStation::ApplyBrightness(uint32_t *frameValue) {
   for (int i = 0; i < 100; i++)
-    frameValue[i] = this->frame[i].value(Animation::format, brightnessX);
+    frameValue[i] = this->frame[i].value(Animation::format, brightnessTable);
 }
 
 void AnimationStation::SetBrightness(uint8_t brightness) {
   AnimationOptions & animationOptions = Storage::getInstance().getAnimationOptions();
   animationOptions.brightness =
       (brightness > brightnessSteps) ? brightnessSteps : brightness;
-  brightnessX =
-      (animationOptions.brightness * getBrightnessStepSize()) / 255.0F;
-  linkageModeOfBrightnessX =
-      (animationOptions.brightness * getLinkageModeOfBrightnessStepSize()) / 255.0F;
-  if (linkageModeOfBrightnessX > 1)
-      linkageModeOfBrightnessX = 1;
-  else if (linkageModeOfBrightnessX < 0)
-      linkageModeOfBrightnessX = 0;
-  if (brightnessX > 1.0f)
-    brightnessX = 1.0f;
-  else if (brightnessX < 0.0f)
-    brightnessX = 0.0f;
+  SetBrightnessLevel(animationOptions.brightness * getBrightnessStepSize());
+
+  uint32_t linkageLevel = animationOptions.brightness * getLinkageModeOfBrightnessStepSize();
+  if (linkageLevel > 255)
+    linkageLevel = 255;
+  if (linkageLevel != linkageBrightnessLevel) {
+    linkageBrightnessLevel = linkageLevel;
+    linkageBrightnessTable.setup(linkageBrightnessLevel);
+  }
+}
+
+void AnimationStation::SetBrightnessLevel(uint32_t level) {
+  if (level > 255)
+    level = 255;
+  if (level != brightnessLevel) {
+    brightnessLevel = level;
+    brightnessTable.setup(brightnessLevel);
+  }
 }
 
 void AnimationStation::DecreaseBrightness() {
@@ -253,7 +257,7 @@ void AnimationStation::IncreaseBrightness() {
 }
 
 void AnimationStation::DimBrightnessTo0() {
-  brightnessX = 0;
+  SetBrightnessLevel(0);
 }
 
 bool AnimationStation::isEffectAvailable(AnimationEffects effect) {
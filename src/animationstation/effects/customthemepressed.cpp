@@ -29,8 +29,9 @@ CustomThemePressed::CustomThemePressed(PixelMatrix &matrix) : Animation(matrix)
 	}
 }
 
-CustomThemePressed::CustomThemePressed(PixelMatrix &matrix, std::vector<Pixel> &pixels) : Animation(matrix), pixels(&pixels) {
+CustomThemePressed::CustomThemePressed(PixelMatrix &matrix, uint32_t pressedMask) : Animation(matrix) {
   this->filtered = true;
+  this->pressedMask = pressedMask;
 
   AnimationOptions & animationOptions = Storage::getInstance().getAnimationOptions();
   if (animationOptions.hasCustomTheme)
@@ -50,6 +50,10 @@ constexpr uint32_t GRID_GRADIENT_COLUMN_DURATION_MS[] = { 1400, 1000, 750, 1800,
 } // namespace
 
 GridGradient::GridGradient(PixelMatrix &matrix) : Animation(matrix) {
+    for (auto &pixel : matrix.buttonPixels) {
+        pixelMasks.insert(pixel.mask);
+    }
+
     setupButtons();
     setupLeverPositions();
     setupPresetBCells();
@@ -166,8 +170,10 @@ uint32_t GridGradient::getColumnDurationMs(GridGradientSpeed speed) const {
     return GRID_GRADIENT_COLUMN_DURATION_MS[clamped];
 }
 
-bool GridGradient::isMaskPressed(uint32_t mask, const std::set<uint32_t> &pressedMasks) const {
-    return pressedMasks.find(mask) != pressedMasks.end();
+// A mask counts as pressed when a pixel is bound to exactly that mask and one of its buttons is held,
+// so a case LED mask that only overlaps pixel masks stays unlit
+bool GridGradient::isMaskPressed(uint32_t mask, uint32_t pressedMask) const {
+    return (mask & pressedMask) != 0 && pixelMasks.find(mask) != pixelMasks.end();
 }
 
 RGB GridGradient::interpolate(const RGB &from, const RGB &to, float t) const {
@@ -195,7 +201,7 @@ RGB GridGradient::columnColor(float t, const RGB &colorA, const RGB &colorB, con
     return interpolate(colorD, colorA, (t - 0.75f) / 0.25f);
 }
 
-void GridGradient::renderCaseLeds(RGB (&frame)[100], const std::set<uint32_t> &pressedMasks, const RGB &caseNormal, const RGB &casePress) {
+void GridGradient::renderCaseLeds(RGB (&frame)[100], uint32_t pressedMask, const RGB &caseNormal, const RGB &casePress) {
     const LEDOptions &ledOptions = Storage::getInstance().getLedOptions();
     int32_t start = ledOptions.caseRGBIndex;
     uint32_t count = ledOptions.caseRGBCount;
@@ -222,7 +228,7 @@ void GridGradient::renderCaseLeds(RGB (&frame)[100], const std::set<uint32_t> &p
 
     std::set<uint32_t> activeTargets;
     for (auto &config : configs) {
-        if (!isMaskPressed(config.mask, pressedMasks))
+        if (!isMaskPressed(config.mask, pressedMask))
             continue;
 
         for (pb_size_t i = 0; i < config.count; i++) {
@@ -263,11 +269,6 @@ bool GridGradient::Animate(RGB (&frame)[100]) {
 
     UpdateTime();
 
-    std::set<uint32_t> pressedMasks;
-    for (auto &p : pixels) {
-        pressedMasks.insert(p.mask);
-    }
-
     std::fill_n(frame, 100, ColorBlack);
 
     RGB colorA(animationOptions.gridGradientColorA);
@@ -311,7 +312,7 @@ bool GridGradient::Animate(RGB (&frame)[100]) {
             if (button.pixel.index == NO_PIXEL.index || button.pixel.positions.empty())
                 continue;
 
-            bool pressed = isMaskPressed(button.pixel.mask, pressedMasks);
+            bool pressed = isMaskPressed(button.pixel.mask, pressedMask);
             RGB baseColor = columnColors[button.column];
             RGB resolved = baseColor;
 
@@ -335,7 +336,7 @@ bool GridGradient::Animate(RGB (&frame)[100]) {
         RGB leverPress(animationOptions.gridLeverPressColor);
 
         for (auto &entry : leverPositions) {
-            bool pressed = isMaskPressed(entry.first, pressedMasks);
+            bool pressed = isMaskPressed(entry.first, pressedMask);
             for (auto pos : entry.second) {
                 if (pos >= 100)
                     continue;
@@ -361,7 +362,7 @@ bool GridGradient::Animate(RGB (&frame)[100]) {
             float cellPhase = std::fmod(globalPhase + normalizedX, 1.0f);
             RGB baseColor = columnColor(cellPhase, colorA, colorB, colorC, colorD);
 
-            bool pressed = isMaskPressed(cell.mask, pressedMasks);
+            bool pressed = isMaskPressed(cell.mask, pressedMask);
 
             for (auto pos : cell.indices) {
                 if (pos >= 100)
@@ -381,7 +382,7 @@ bool GridGradient::Animate(RGB (&frame)[100]) {
 
     RGB caseNormal(animationOptions.gridCaseNormalColor);
     RGB casePress(animationOptions.gridCaseLeverPressColor);
-    renderCaseLeds(frame, pressedMasks, caseNormal, casePress);
+    renderCaseLeds(frame, pressedMask, caseNormal, casePress);
 
     return true;
 }
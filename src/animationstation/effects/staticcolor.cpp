@@ -4,9 +4,9 @@
 StaticColor::StaticColor(PixelMatrix &matrix) : Animation(matrix) {
 }
 
-StaticColor::StaticColor(PixelMatrix &matrix, std::vector<Pixel> &inpixels) : Animation(matrix) {
+StaticColor::StaticColor(PixelMatrix &matrix, uint32_t pressedMask) : Animation(matrix) {
   this->filtered = true;
-  pixels = inpixels;
+  this->pressedMask = pressedMask;
 }
 
 bool StaticColor::Animate(RGB (&frame)[100]) {
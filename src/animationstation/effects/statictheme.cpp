@@ -310,6 +310,7 @@ bool StaticTheme::Animate(RGB (&frame)[100]) {
     UpdateTime();
     UpdatePresses(frame);
 
+    const std::map<uint32_t, RGB> &theme = themes.at(animationOptions.themeIndex);
     for (size_t r = 0; r != matrix->pixels.size(); r++) {
       for (size_t c = 0; c != matrix->pixels[r].size(); c++) {
         if (matrix->pixels[r][c].index == NO_PIXEL.index)
@@ -318,8 +319,6 @@ bool StaticTheme::Animate(RGB (&frame)[100]) {
         // Count down the timer
         DecrementFadeCounter(matrix->pixels[r][c].index);
 
-        std::map<uint32_t, RGB> theme = themes.at(animationOptions.themeIndex);
-
         auto itr = theme.find(matrix->pixels[r][c].mask);
         if (itr != theme.end()) {
           for (size_t p = 0; p != matrix->pixels[r][c].positions.size(); p++) {
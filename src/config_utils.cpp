@@ -126,6 +126,14 @@
     #define DEFAULT_DEBOUNCE_DELAY 5
 #endif
 
+#ifndef DEFAULT_DEBOUNCE_MODE
+    #define DEFAULT_DEBOUNCE_MODE DEBOUNCE_MODE_EAGER
+#endif
+
+#ifndef DEFAULT_USB_SOF_SYNC
+    #define DEFAULT_USB_SOF_SYNC false
+#endif
+
 #ifndef DEFAULT_PS4_REPORTHACK
     #define DEFAULT_PS4_REPORTHACK false
 #endif
@@ -300,6 +308,9 @@ void ConfigUtils::initUnsetPropertiesWithDefaults(Config& config)
     INIT_UNSET_PROPERTY(config.gamepadOptions, profileNumber, 1);
     INIT_UNSET_PROPERTY(config.gamepadOptions, ps4ControllerType, DEFAULT_PS4CONTROLLER_TYPE);
     INIT_UNSET_PROPERTY(config.gamepadOptions, debounceDelay, DEFAULT_DEBOUNCE_DELAY);
+    INIT_UNSET_PROPERTY(config.gamepadOptions, debounceMode, DEFAULT_DEBOUNCE_MODE);
+    // releases debounce like presses unless configured otherwise
+    INIT_UNSET_PROPERTY(config.gamepadOptions, debounceReleaseDelay, config.gamepadOptions.debounceDelay);
     INIT_UNSET_PROPERTY(config.gamepadOptions, inputModeB1, DEFAULT_INPUT_MODE_B1);
     INIT_UNSET_PROPERTY(config.gamepadOptions, inputModeB2, DEFAULT_INPUT_MODE_B2);
     INIT_UNSET_PROPERTY(config.gamepadOptions, inputModeB3, DEFAULT_INPUT_MODE_B3);
@@ -320,6 +331,7 @@ void ConfigUtils::initUnsetPropertiesWithDefaults(Config& config)
     INIT_UNSET_PROPERTY(config.gamepadOptions, usbVendorID, DEFAULT_USB_VENDOR_ID);
     INIT_UNSET_PROPERTY(config.gamepadOptions, usbProductID, DEFAULT_USB_PRODUCT_ID);
     INIT_UNSET_PROPERTY(config.gamepadOptions, miniMenuGamepadInput, MINI_MENU_GAMEPAD_INPUT);
+    INIT_UNSET_PROPERTY(config.gamepadOptions, usbSofSync, DEFAULT_USB_SOF_SYNC);
 
     // hotkeyOptions
     HotkeyOptions& hotkeyOptions = config.hotkeyOptions;
@@ -842,6 +854,7 @@ void ConfigUtils::initUnsetPropertiesWithDefaults(Config& config)
     INIT_UNSET_PROPERTY(config.addonOptions.heTriggerOptions, muxChannels, HETRIGGER_MUX_CHANNELS);
     INIT_UNSET_PROPERTY(config.addonOptions.heTriggerOptions, emaSmoothing, HETRIGGER_SMOOTHING_ENABLED);
     INIT_UNSET_PROPERTY(config.addonOptions.heTriggerOptions, smoothingFactor, HETRIGGER_SMOOTHING_FACTOR);
+    INIT_UNSET_PROPERTY(config.addonOptions.heTriggerOptions, muxChannelsPerLoop, HETRIGGER_MUX_CHANNELS_PER_LOOP);
     INIT_UNSET_PROPERTY(config.addonOptions.heTriggerOptions.triggers[0], action, HETRIGGER_HE0_ACTION);
     INIT_UNSET_PROPERTY(config.addonOptions.heTriggerOptions.triggers[0], active, HETRIGGER_HE0_ACTIVE);
     INIT_UNSET_PROPERTY(config.addonOptions.heTriggerOptions.triggers[0], idle, HETRIGGER_HE0_IDLE);
@@ -1780,9 +1793,11 @@ void hotkeysMigration(Config& config)
 // Loading / Saving
 // -----------------------------------------------------
 
-// We put a ConfigFooter struct at the end of the flash area reserved for FlashPROM. It contains a magicvalue, the size
-// of the serialized config data and a CRC of that data. This information allows us to both locate and verify the stored
-// data. The serialized data is located directly before the footer:
+// The config is stored as the current FlashPROM record, see FlashPROM.h for the layout.
+//
+// Firmware before the record log put a ConfigFooter struct at the end of the flash area reserved for FlashPROM. It
+// contains a magicvalue, the size of the serialized config data and a CRC of that data. That layout is still read
+// when no record has been written yet:
 //
 //                       FlashPROM block
 // ┌────────────────────────────┴─────────────────────────────┐
@@ -1795,29 +1810,19 @@ struct ConfigFooter
     uint32_t dataSize;
     uint32_t dataCrc;
     uint32_t magic;
-
-    bool operator==(const ConfigFooter& other) const
-    {
-        return
-            dataSize == other.dataSize &&
-            dataCrc == other.dataCrc &&
-            magic == other.magic;
-    }
 };
 
 static const uint32_t FOOTER_MAGIC = 0xd2f1e365;
 
-// Verify that the maximum size of the serialized Config object fits into the allocated flash block
+// Verify that the maximum size of the serialized Config object fits into a FlashPROM record
 #if defined(Config_size)
-    static_assert(Config_size + sizeof(ConfigFooter) <= EEPROM_SIZE_BYTES, "Maximum size of Config exceeds the maximum size allocated for FlashPROM");
+    static_assert(Config_size <= EEPROM_RECORD_MAX_BYTES, "Maximum size of Config exceeds the maximum size allocated for FlashPROM");
 #else
     #error "Maximum size of Config cannot be determined statically, make sure that you do not use any dynamically sized arrays or strings"
 #endif
 
-static bool loadConfigInner(Config& config)
+static bool loadFooterConfig(Config& config)
 {
-    config = Config Config_init_zero;
-
     const uint8_t* flashEnd = reinterpret_cast<const uint8_t*>(EEPROM_ADDRESS_START) + EEPROM_SIZE_BYTES;
     const ConfigFooter& footer = *reinterpret_cast<const ConfigFooter*>(flashEnd - sizeof(ConfigFooter));
 
@@ -1846,6 +1851,129 @@ static bool loadConfigInner(Config& config)
     return pb_decode(&inputStream, Config_fields, &config);
 }
 
+// Options that hotkeys change are saved as an overlay record of tag/value pairs, holding only the ones that differ
+// from the last full save. Tags are stored in flash, so existing values must not change.
+enum HotOptionTag : uint32_t
+{
+    HOT_OPTION_DPAD_MODE = 0,
+    HOT_OPTION_SOCD_MODE = 1,
+    HOT_OPTION_INVERT_X_AXIS = 2,
+    HOT_OPTION_INVERT_Y_AXIS = 3,
+    HOT_OPTION_FOUR_WAY_MODE = 4,
+    HOT_OPTION_PROFILE_NUMBER = 5,
+    HOT_OPTION_DDI_FOUR_WAY_MODE = 6,
+    HOT_OPTION_FOCUS_MODE_OVERRIDE = 7,
+    HOT_OPTION_COUNT
+};
+
+struct HotOptionEntry
+{
+    uint32_t tag;
+    uint32_t value;
+};
+
+static_assert(sizeof(HotOptionEntry) * HOT_OPTION_COUNT <= EEPROM_OVERLAY_MAX_BYTES, "Hot options do not fit into a FlashPROM overlay");
+
+// Hot option values as of the last full save
+static uint32_t hotOptionBaseline[HOT_OPTION_COUNT];
+
+static uint32_t getHotOption(const Config& config, uint32_t tag)
+{
+    switch (tag)
+    {
+        case HOT_OPTION_DPAD_MODE:           return config.gamepadOptions.dpadMode;
+        case HOT_OPTION_SOCD_MODE:           return config.gamepadOptions.socdMode;
+        case HOT_OPTION_INVERT_X_AXIS:       return config.gamepadOptions.invertXAxis;
+        case HOT_OPTION_INVERT_Y_AXIS:       return config.gamepadOptions.invertYAxis;
+        case HOT_OPTION_FOUR_WAY_MODE:       return config.gamepadOptions.fourWayMode;
+        case HOT_OPTION_PROFILE_NUMBER:      return config.gamepadOptions.profileNumber;
+        case HOT_OPTION_DDI_FOUR_WAY_MODE:   return config.addonOptions.dualDirectionalOptions.fourWayMode;
+        case HOT_OPTION_FOCUS_MODE_OVERRIDE: return config.addonOptions.focusModeOptions.overrideEnabled;
+        default:                             return 0;
+    }
+}
+
+static void setHotOption(Config& config, uint32_t tag, uint32_t value)
+{
+    switch (tag)
+    {
+        case HOT_OPTION_DPAD_MODE:
+            config.gamepadOptions.dpadMode = static_cast<DpadMode>(value);
+            config.gamepadOptions.has_dpadMode = true;
+            break;
+        case HOT_OPTION_SOCD_MODE:
+            config.gamepadOptions.socdMode = static_cast<SOCDMode>(value);
+            config.gamepadOptions.has_socdMode = true;
+            break;
+        case HOT_OPTION_INVERT_X_AXIS:
+            config.gamepadOptions.invertXAxis = value != 0;
+            config.gamepadOptions.has_invertXAxis = true;
+            break;
+        case HOT_OPTION_INVERT_Y_AXIS:
+            config.gamepadOptions.invertYAxis = value != 0;
+            config.gamepadOptions.has_invertYAxis = true;
+            break;
+        case HOT_OPTION_FOUR_WAY_MODE:
+            config.gamepadOptions.fourWayMode = value != 0;
+            config.gamepadOptions.has_fourWayMode = true;
+            break;
+        case HOT_OPTION_PROFILE_NUMBER:
+            config.gamepadOptions.profileNumber = value;
+            config.gamepadOptions.has_profileNumber = true;
+            break;
+        case HOT_OPTION_DDI_FOUR_WAY_MODE:
+            config.addonOptions.dualDirectionalOptions.fourWayMode = value != 0;
+            config.addonOptions.dualDirectionalOptions.has_fourWayMode = true;
+            break;
+        case HOT_OPTION_FOCUS_MODE_OVERRIDE:
+            config.addonOptions.focusModeOptions.overrideEnabled = value != 0;
+            config.addonOptions.focusModeOptions.has_overrideEnabled = true;
+            break;
+        default:
+            // Written by another firmware version, skip it
+            break;
+    }
+}
+
+static void applyHotOptions(Config& config)
+{
+    uint32_t dataSize = 0;
+    const uint8_t* dataPtr = EEPROM.readOverlay(dataSize);
+    if (dataPtr == nullptr)
+    {
+        return;
+    }
+
+    HotOptionEntry entry;
+    for (uint32_t offset = 0; offset + sizeof(HotOptionEntry) <= dataSize; offset += sizeof(HotOptionEntry))
+    {
+        memcpy(&entry, dataPtr + offset, sizeof(HotOptionEntry));
+        setHotOption(config, entry.tag, entry.value);
+    }
+}
+
+static bool loadConfigInner(Config& config)
+{
+    config = Config Config_init_zero;
+
+    // FlashPROM has already located the current record and verified its CRC
+    uint32_t dataSize = 0;
+    const uint8_t* dataPtr = EEPROM.read(dataSize);
+    if (dataPtr == nullptr)
+    {
+        return loadFooterConfig(config);
+    }
+
+    pb_istream_t inputStream = pb_istream_from_buffer(dataPtr, dataSize);
+    if (!pb_decode(&inputStream, Config_fields, &config))
+    {
+        return false;
+    }
+
+    applyHotOptions(config);
+    return true;
+}
+
 void ConfigUtils::load(Config& config)
 {
     // First try to load from Protobuf storage, if that fails fall back to legacy storage.
@@ -1966,36 +2094,61 @@ bool ConfigUtils::save(Config& config)
     // its default value.
     setHasFlags(Config_fields, &config);
 
+    // The cache holds the data of a commit that is still queued, so make sure the encode succeeds before it
+    // overwrites that
+    size_t encodedSize = 0;
+    if (EEPROM.isPending() && !pb_get_encoded_size(&encodedSize, Config_fields, &config))
+    {
+        return false;
+    }
+
     // Encode the data directly into the cache of FlashPROM
-    pb_ostream_t outputStream = pb_ostream_from_buffer(EEPROM.writeCache, EEPROM_SIZE_BYTES - sizeof(ConfigFooter));
+    pb_ostream_t outputStream = pb_ostream_from_buffer(EEPROM.writeCache, EEPROM_RECORD_MAX_BYTES);
     if (!pb_encode(&outputStream, Config_fields, &config))
     {
         return false;
     }
 
-    // Create the new footer
-    ConfigFooter newFooter;
-    newFooter.dataSize = outputStream.bytes_written;
-    newFooter.dataCrc = CRC32::calculate(EEPROM.writeCache, newFooter.dataSize);
-    newFooter.magic = FOOTER_MAGIC;
+    // FlashPROM skips the write when the data hasn't changed
+    if (!EEPROM.commit(outputStream.bytes_written))
+    {
+        return false;
+    }
 
-    // The data has changed when the footer content has changed. Only then do we acutally need to save.
-    const ConfigFooter& oldFooter = *reinterpret_cast<ConfigFooter*>(EEPROM.writeCache + EEPROM_SIZE_BYTES - sizeof(ConfigFooter));
-    if (newFooter == oldFooter)
+    for (uint32_t tag = 0; tag < HOT_OPTION_COUNT; ++tag)
     {
-        // The data has not changed, no saving neccessary.
-        return true;
+        hotOptionBaseline[tag] = getHotOption(config, tag);
     }
 
-    // Write the footer
-    ConfigFooter* cacheFooter = reinterpret_cast<ConfigFooter*>(EEPROM.writeCache + EEPROM_SIZE_BYTES - sizeof(ConfigFooter));
-    memcpy(cacheFooter, &newFooter, sizeof(ConfigFooter));
+    return true;
+}
+
+bool ConfigUtils::saveHotOptions(Config& config)
+{
+    // We only allow saves from core0. Saves from core1 have to be marshalled to core0.
+    assert(get_core_num() == 0);
+    if (get_core_num() != 0)
+    {
+        return false;
+    }
 
-    // Move the encoded data in memory down to the footer
-    memmove(EEPROM.writeCache + EEPROM_SIZE_BYTES - sizeof(ConfigFooter) - newFooter.dataSize, EEPROM.writeCache, newFooter.dataSize);
-    memset(EEPROM.writeCache, 0, EEPROM_SIZE_BYTES - sizeof(ConfigFooter) - newFooter.dataSize);
+    HotOptionEntry entries[HOT_OPTION_COUNT];
+    uint32_t entryCount = 0;
+    for (uint32_t tag = 0; tag < HOT_OPTION_COUNT; ++tag)
+    {
+        const uint32_t value = getHotOption(config, tag);
+        if (value != hotOptionBaseline[tag])
+        {
+            entries[entryCount++] = { tag, value };
+        }
+    }
 
-    EEPROM.commit();
+    // When the overlay can't be written (no base yet, a full save is pending or the log would run into the base),
+    // compact everything into a new full save instead
+    if (!EEPROM.commitOverlay(reinterpret_cast<const uint8_t*>(entries), entryCount * sizeof(HotOptionEntry)))
+    {
+        return save(config);
+    }
 
     return true;
 }
@@ -24,16 +24,17 @@ GPGFX::GPGFX() {
 void GPGFX::init(GPGFX_DisplayTypeOptions options) {
     switch (options.displayType) {
         case GPGFX_DisplayType::DISPLAY_TYPE_SSD1306:
-            this->displayDriver = new GPGFX_TinySSD1306();
+            init(options, new GPGFX_TinySSD1306());
             break;
         default:
-            options.displayType = GPGFX_DisplayType::DISPLAY_TYPE_NONE;
+            break;
     }
+}
 
-    if (options.displayType != GPGFX_DisplayType::DISPLAY_TYPE_NONE) {
-        this->displayDriver->setMetrics(&GPGFX_DisplayModes[options.displayType][(GPGFX_DisplaySize)options.size]);
-        this->displayDriver->init(options);
-    }
+void GPGFX::init(GPGFX_DisplayTypeOptions options, GPGFX_DisplayBase* driver) {
+    this->displayDriver = driver;
+    this->displayDriver->setMetrics(&GPGFX_DisplayModes[options.displayType][(GPGFX_DisplaySize)options.size]);
+    this->displayDriver->init(options);
 }
 
 GPGFX_DisplayTypeOptions GPGFX::getAvailableDisplay(GPGFX_DisplayType displayType) {
@@ -70,7 +71,8 @@ bool GPGFX::detectDisplay(GPGFX_DisplayTypeOptions* display, GPGFX_DisplayType d
                 display->displayType = displayType;
                 display->address = result.address;
                 display->i2c = PeripheralManager::getInstance().getI2C(result.block);
-                display->i2c->setExclusiveUse(result.address);
+                // page writes queue behind input devices sharing the bus
+                display->i2c->setPriority(result.address, I2C_PRIORITY_LOW);
                 return true;
             }
         }
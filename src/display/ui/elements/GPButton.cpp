@@ -1,34 +1,9 @@
 #include "GPButton.h"
 #include "GPGFX_UI_layouts.h"
 
-void GPButton::draw() {
-    // new style button:
-    uint16_t baseX = this->x;
-    uint16_t baseY = this->y;
+void GPButton::refresh() {
     Mask_t pinValues = ~gpio_get_all();
 
-    // scale to viewport
-    double scaleX = this->getScaleX();
-    double scaleY = this->getScaleY();
-
-    // set scale on X & Y to be proportionate if either is 0
-    if ((scaleX > 0.0f) & ((scaleY == 0.0f) || (scaleY == 1.0f))) {
-        scaleY = scaleX;
-    } else if (((scaleX == 0.0f) || (scaleX == 1.0f)) & (scaleY > 0.0f)) {
-        scaleX = scaleY;
-    }
-
-    uint16_t offsetX = ((getRenderer()->getDriver()->getMetrics()->width - (uint16_t)((double)(this->getViewport().right - this->getViewport().left) * scaleX)) / 2);
-    uint16_t offsetY = ((getRenderer()->getDriver()->getMetrics()->height - (uint16_t)((double)(this->getViewport().bottom - this->getViewport().top) * scaleY)) / 2);
-
-    if (scaleX > 0.0f) {
-        baseX = ((this->x) * scaleX + this->getViewport().left) + offsetX;
-    }
-
-    if (scaleY > 0.0f) {
-        baseY = ((this->y) * scaleY + this->getViewport().top);
-    }
-
     bool pinState = false;
     bool buttonState = false;
     bool turboState = false;
@@ -128,6 +103,42 @@ void GPButton::draw() {
 
     state = (buttonState ? pinState : 0);
 
+    if ((state != this->_state) || (turboState != this->_turboState)) {
+        this->_state = state;
+        this->_turboState = turboState;
+        invalidate();
+    }
+}
+
+void GPButton::draw() {
+    // new style button:
+    uint16_t baseX = this->x;
+    uint16_t baseY = this->y;
+    uint16_t state = this->_state;
+    bool turboState = this->_turboState;
+
+    // scale to viewport
+    double scaleX = this->getScaleX();
+    double scaleY = this->getScaleY();
+
+    // set scale on X & Y to be proportionate if either is 0
+    if ((scaleX > 0.0f) & ((scaleY == 0.0f) || (scaleY == 1.0f))) {
+        scaleY = scaleX;
+    } else if (((scaleX == 0.0f) || (scaleX == 1.0f)) & (scaleY > 0.0f)) {
+        scaleX = scaleY;
+    }
+
+    uint16_t offsetX = ((getRenderer()->getDriver()->getMetrics()->width - (uint16_t)((double)(this->getViewport().right - this->getViewport().left) * scaleX)) / 2);
+    uint16_t offsetY = ((getRenderer()->getDriver()->getMetrics()->height - (uint16_t)((double)(this->getViewport().bottom - this->getViewport().top) * scaleY)) / 2);
+
+    if (scaleX > 0.0f) {
+        baseX = ((this->x) * scaleX + this->getViewport().left) + offsetX;
+    }
+
+    if (scaleY > 0.0f) {
+        baseY = ((this->y) * scaleY + this->getViewport().top);
+    }
+
     // base
     if (this->_shape == GP_SHAPE_ELLIPSE) {
         uint16_t scaledSize = (uint16_t)((double)this->_sizeX * scaleX);
@@ -1,12 +1,13 @@
 #include "GPLabel.h"
 
-void GPLabel::draw() {
+void GPLabel::refresh() {
     std::string label = this->getText();
+    std::string display;
 
     this->_delimiter = ": ";
 
     if (!this->_scrolling) {
-        getRenderer()->drawText(x, y, label.c_str());
+        display = label;
     } else {
         std::string prefix, scrollText;
         size_t delimiterPos = label.find(this->_delimiter);
@@ -29,8 +30,7 @@ void GPLabel::draw() {
                 std::string doubled = scrollText + scrollText;
                 std::string window = doubled.substr(this->_scrollPosition, scrollWidth);
 
-                std::string display = prefix + window;
-                getRenderer()->drawText(x, y, display.c_str());
+                display = prefix + window;
 
                 uint32_t now = getMillis();
                 uint32_t delay = (_scrollPosition == 0) ? _scrollDelayStart : _scrollDelay;
@@ -44,10 +44,19 @@ void GPLabel::draw() {
                     this->_lastScrollTime = now;
                 }
             } else {
-                getRenderer()->drawText(x, y, label.c_str());
+                display = label;
             }
         } else {
-            getRenderer()->drawText(x, y, label.c_str());
+            display = label;
         }
     }
+
+    if (display != this->_displayText) {
+        this->_displayText = display;
+        invalidate();
+    }
+}
+
+void GPLabel::draw() {
+    getRenderer()->drawText(x, y, this->_displayText.c_str());
 }
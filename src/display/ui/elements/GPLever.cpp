@@ -2,7 +2,7 @@
 
 #include "drivermanager.h"
 
-void GPLever::draw() {
+void GPLever::refresh() {
     // new style lever:
     // radius defines the base of the lever
     // the lever indicator itself will be sized slightly smaller than the base
@@ -98,6 +98,26 @@ void GPLever::draw() {
         leverY = (baseY-baseRadius) + baseRadius * (analogY / (float)joystickMid);
     }
 
+    if ((baseX != this->_baseX) || (baseY != this->_baseY) || (leverX != this->_leverX) || (leverY != this->_leverY) ||
+        (baseRadius != this->_baseRadius) || (leverRadius != this->_leverRadius)) {
+        this->_baseX = baseX;
+        this->_baseY = baseY;
+        this->_leverX = leverX;
+        this->_leverY = leverY;
+        this->_baseRadius = baseRadius;
+        this->_leverRadius = leverRadius;
+        invalidate();
+    }
+}
+
+void GPLever::draw() {
+    int baseX = this->_baseX;
+    int baseY = this->_baseY;
+    int leverX = this->_leverX;
+    int leverY = this->_leverY;
+    int baseRadius = this->_baseRadius;
+    int leverRadius = this->_leverRadius;
+
     // base
     getRenderer()->drawEllipse(baseX, baseY, baseRadius, baseRadius, this->strokeColor, 0);
 
@@ -5,19 +5,91 @@ const bool prioritySort(GPWidget * a, GPWidget * b) {
 }
 
 void GPScreen::draw(uint8_t pageLimit) {
-    getRenderer()->clearScreen();
-
-    // draw the display list
     if ( displayList.size() > 0 ) {
         std::sort(displayList.begin(), displayList.end(), prioritySort);
         for(std::vector<GPWidget*>::iterator it = displayList.begin(); it != displayList.end(); ++it) {
-            (*it)->draw();
+            (*it)->refresh();
         }
     }
-    drawScreen();
+    bool screenChanged = refreshScreen();
+
+    if (!retained || fullRedraw || !getRenderer()->supportsRegions()) {
+        drawAll();
+    } else {
+        // everything an invalidated widget has ever covered needs repainting
+        GPGFX_Rect region = gpgfxEmptyRect();
+        for(std::vector<GPWidget*>::iterator it = displayList.begin(); it != displayList.end(); ++it) {
+            if ((*it)->isInvalid()) {
+                gpgfxRectUnion(region, (*it)->getBounds());
+            }
+        }
+        if (screenChanged) {
+            gpgfxRectUnion(region, screenBounds);
+        }
+
+        // fall back to a full redraw when something grew past the area that was cleared
+        if (!gpgfxRectIsEmpty(region) && !drawRegion(region, screenChanged)) {
+            drawAll();
+        }
+    }
+
     getRenderer()->render(pageLimit);
 }
 
+void GPScreen::drawAll() {
+    getRenderer()->clearScreen();
+    getRenderer()->resetClip();
+
+    // draw the display list
+    for(std::vector<GPWidget*>::iterator it = displayList.begin(); it != displayList.end(); ++it) {
+        getRenderer()->resetBounds();
+        (*it)->draw();
+        (*it)->addBounds(getRenderer()->getBounds());
+        (*it)->validate();
+    }
+
+    getRenderer()->resetBounds();
+    drawScreen();
+    gpgfxRectUnion(screenBounds, getRenderer()->getBounds());
+
+    fullRedraw = false;
+}
+
+bool GPScreen::drawRegion(GPGFX_Rect region, bool screenChanged) {
+    bool contained = true;
+
+    getRenderer()->clearRegion(region);
+    getRenderer()->setClip(region);
+
+    // redraw in the usual order, clipped, so overlapping widgets keep their stacking
+    for(std::vector<GPWidget*>::iterator it = displayList.begin(); it != displayList.end(); ++it) {
+        bool invalid = (*it)->isInvalid();
+        if (invalid || gpgfxRectIntersects((*it)->getBounds(), region)) {
+            getRenderer()->resetBounds();
+            (*it)->draw();
+            GPGFX_Rect bounds = getRenderer()->getBounds();
+            if (invalid && !gpgfxRectContains(region, bounds)) {
+                contained = false;
+            }
+            (*it)->addBounds(bounds);
+            (*it)->validate();
+        }
+    }
+
+    if (screenChanged || gpgfxRectIntersects(screenBounds, region)) {
+        getRenderer()->resetBounds();
+        drawScreen();
+        GPGFX_Rect bounds = getRenderer()->getBounds();
+        if (screenChanged && !gpgfxRectContains(region, bounds)) {
+            contained = false;
+        }
+        gpgfxRectUnion(screenBounds, bounds);
+    }
+
+    getRenderer()->resetClip();
+    return contained;
+}
+
 void GPScreen::clear() {
     if (displayList.size() > 0) {
         displayList.clear();
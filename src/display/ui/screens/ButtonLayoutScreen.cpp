@@ -81,6 +81,7 @@ void ButtonLayoutScreen::init() {
     showMacroMode = Storage::getInstance().getDisplayOptions().macroMode;
     showProfileMode = Storage::getInstance().getDisplayOptions().profileMode;
 
+    setRetained(true);
     getRenderer()->clearScreen();
 }
 
@@ -277,6 +278,17 @@ void ButtonLayoutScreen::drawScreen() {
     getRenderer()->drawText(0, 7, footer);
 }
 
+bool ButtonLayoutScreen::refreshScreen() {
+    if ((statusBar == drawnStatusBar) && (footer == drawnFooter) && (bannerDisplay == drawnBannerDisplay)) {
+        return false;
+    }
+
+    drawnStatusBar = statusBar;
+    drawnFooter = footer;
+    drawnBannerDisplay = bannerDisplay;
+    return true;
+}
+
 GPLever* ButtonLayoutScreen::addLever(uint16_t startX, uint16_t startY, uint16_t sizeX, uint16_t sizeY, uint16_t strokeColor, uint16_t fillColor, uint16_t inputType) {
     GPLever* lever = new GPLever();
     lever->setRenderer(getRenderer());
@@ -308,6 +308,10 @@ void MainMenuScreen::exitOnly() {
     exitToScreen = DisplayMode::BUTTONS;
 }
 
+void MainMenuScreen::showLoopStats() {
+    exitToScreen = DisplayMode::STATS;
+}
+
 int32_t MainMenuScreen::modeValue() {
     return -1;
 }
@@ -4,8 +4,23 @@
 #include "version.h"
 #include "drivermanager.h"
 
+#include <algorithm>
+
+#define LOOP_PAGE_REFRESH_MS 250
+
 void StatsScreen::init() {
+    // the loop page is the only one worth showing outside of web config
+    if (LoopStats::enabled() && !DriverManager::getInstance().isConfigMode()) {
+        showLoopPage();
+    } else {
+        showInfoPage();
+    }
+}
+
+void StatsScreen::showInfoPage() {
+    clearElements();
     getRenderer()->clearScreen();
+    loopPage = false;
 
     header = new GPLabel();
     header->setRenderer(getRenderer());
@@ -45,11 +60,50 @@ void StatsScreen::init() {
 
     exit = new GPLabel();
     exit->setRenderer(getRenderer());
-    exit->setText("B2 to Return");
-    exit->setPosition(5, 7); 
+    exit->setText(LoopStats::enabled() ? "B1 Loop  B2 Return" : "B2 to Return");
+    exit->setPosition(LoopStats::enabled() ? 1 : 5, 7);
     addElement(exit);
 }
 
+void StatsScreen::showLoopPage() {
+    clearElements();
+    getRenderer()->clearScreen();
+    loopPage = true;
+
+    header = new GPLabel();
+    header->setRenderer(getRenderer());
+    header->setScrolling(false);
+    header->setText("[us]    avg  p99  max");
+    header->setPosition(0, 0);
+    addElement(header);
+
+    for (uint8_t i = 0; i <= LOOP_STAGE_POSTPROCESS; i++) {
+        loopLines[i] = new GPLabel();
+        loopLines[i]->setRenderer(getRenderer());
+        loopLines[i]->setScrolling(false);
+        loopLines[i]->setPosition(0, i + 1);
+        addElement(loopLines[i]);
+    }
+
+    nextLoopRefresh = nil_time;
+    updateLoopPage();
+}
+
+void StatsScreen::updateLoopPage() {
+    static const char * const stageLabels[] = { "Loop", "Input", "Pre", "Proc", "Drv", "USB", "Post" };
+    const LoopStats & loopStats = LoopStats::getInstance();
+    char line[24];
+
+    for (uint8_t i = 0; i <= LOOP_STAGE_POSTPROCESS; i++) {
+        const LoopStageStats & stats = loopStats.getStage((LoopStage)i);
+        snprintf(line, sizeof(line), "%-6s%5lu%5lu%5lu", stageLabels[i],
+            (unsigned long)std::min<uint32_t>(stats.getAverage(), 99999),
+            (unsigned long)std::min<uint32_t>(stats.percentile(99), 99999),
+            (unsigned long)std::min<uint32_t>(stats.getMax(), 99999));
+        loopLines[i]->setText(line);
+    }
+}
+
 void StatsScreen::shutdown() {
     clearElements();
 }
@@ -58,16 +112,30 @@ void StatsScreen::drawScreen() {
 }
 
 int8_t StatsScreen::update() {
-    if (DriverManager::getInstance().isConfigMode()) {
-        uint16_t buttonState = getGamepad()->state.buttons;
-        if (prevButtonState && !buttonState) {
-            if (prevButtonState == GAMEPAD_MASK_B2) {
-                prevButtonState = 0;
+    if (loopPage && time_reached(nextLoopRefresh)) {
+        updateLoopPage();
+        nextLoopRefresh = make_timeout_time_ms(LOOP_PAGE_REFRESH_MS);
+    }
+
+    // the loop page is also opened from the main menu while playing, so B1/B2 work in both modes
+    uint16_t buttonState = getGamepad()->state.buttons;
+    if (prevButtonState && !buttonState) {
+        if (prevButtonState == GAMEPAD_MASK_B2) {
+            prevButtonState = 0;
+            if (DriverManager::getInstance().isConfigMode()) {
                 return DisplayMode::CONFIG_INSTRUCTION;
+            } else {
+                return DisplayMode::BUTTONS;
+            }
+        } else if (prevButtonState == GAMEPAD_MASK_B1 && LoopStats::enabled()) {
+            if (loopPage) {
+                showInfoPage();
+            } else {
+                showLoopPage();
             }
         }
-        prevButtonState = buttonState;
     }
+    prevButtonState = buttonState;
 
     return -1; // -1 means no change in screen state
 }
@@ -1,4 +1,5 @@
 #include "drivers/astro/AstroDriver.h"
+#include "hotpath.h"
 #include "drivers/shared/driverhelper.h"
 
 void AstroDriver::initialize() {
@@ -25,7 +26,7 @@ void AstroDriver::initialize() {
 	};
 }
 
-bool AstroDriver::process(Gamepad * gamepad) {
+bool HOT_PATH_FUNC(AstroDriver::process)(Gamepad * gamepad) {
 	astroReport.lx = 0x7f;
 	astroReport.ly = 0x7f;
 
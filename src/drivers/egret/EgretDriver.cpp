@@ -1,4 +1,5 @@
 #include "drivers/egret/EgretDriver.h"
+#include "hotpath.h"
 #include "drivers/shared/driverhelper.h"
 
 void EgretDriver::initialize() {
@@ -21,7 +22,7 @@ void EgretDriver::initialize() {
 	};
 }
 
-bool EgretDriver::process(Gamepad * gamepad) {
+bool HOT_PATH_FUNC(EgretDriver::process)(Gamepad * gamepad) {
 	switch (gamepad->state.dpad & GAMEPAD_MASK_DPAD)
 	{
 		case GAMEPAD_MASK_UP:                        egretReport.lx = EGRET_JOYSTICK_MID; egretReport.ly = EGRET_JOYSTICK_MIN; break;
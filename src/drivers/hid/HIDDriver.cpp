@@ -4,6 +4,7 @@
  */
 
 #include "drivers/hid/HIDDriver.h"
+#include "hotpath.h"
 #include "drivers/hid/HIDDescriptors.h"
 #include "drivers/shared/driverhelper.h"
 #include "storagemanager.h"
@@ -35,7 +36,7 @@ void HIDDriver::initialize() {
 }
 
 // Generate HID report from gamepad and send to TUSB Device
-bool HIDDriver::process(Gamepad * gamepad) {
+bool HOT_PATH_FUNC(HIDDriver::process)(Gamepad * gamepad) {
 	switch (gamepad->state.dpad & GAMEPAD_MASK_DPAD)
 	{
 		case GAMEPAD_MASK_UP:                        hidReport.direction = HID_HAT_UP;        break;
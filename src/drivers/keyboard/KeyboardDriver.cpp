@@ -1,4 +1,5 @@
 #include "drivers/keyboard/KeyboardDriver.h"
+#include "hotpath.h"
 #include "storagemanager.h"
 #include "drivers/shared/driverhelper.h"
 #include "drivers/hid/HIDDescriptors.h"
@@ -57,7 +58,7 @@ uint8_t KeyboardDriver::getMultimedia(uint8_t code) {
 }
 
 
-bool KeyboardDriver::process(Gamepad * gamepad) {
+bool HOT_PATH_FUNC(KeyboardDriver::process)(Gamepad * gamepad) {
 	const KeyboardMapping& keyboardMapping = Storage::getInstance().getKeyboardMapping();
 	releaseAllKeys();
 	if(gamepad->pressedUp())     { pressKey(keyboardMapping.keyDpadUp); }
@@ -1,4 +1,5 @@
 #include "drivers/mdmini/MDMiniDriver.h"
+#include "hotpath.h"
 #include "drivers/shared/driverhelper.h"
 
 void MDMiniDriver::initialize() {
@@ -25,7 +26,7 @@ void MDMiniDriver::initialize() {
 	};
 }
 
-bool MDMiniDriver::process(Gamepad * gamepad) {
+bool HOT_PATH_FUNC(MDMiniDriver::process)(Gamepad * gamepad) {
 	mdminiReport.lx = 0x7f;
 	mdminiReport.ly = 0x7f;
 
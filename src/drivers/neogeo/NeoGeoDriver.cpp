@@ -1,4 +1,5 @@
 #include "drivers/neogeo/NeoGeoDriver.h"
+#include "hotpath.h"
 #include "drivers/shared/driverhelper.h"
 
 void NeoGeoDriver::initialize() {
@@ -38,7 +39,7 @@ void NeoGeoDriver::initialize() {
 	};
 }
 
-bool NeoGeoDriver::process(Gamepad * gamepad) {
+bool HOT_PATH_FUNC(NeoGeoDriver::process)(Gamepad * gamepad) {
 	switch (gamepad->state.dpad & GAMEPAD_MASK_DPAD)
 	{
 		case GAMEPAD_MASK_UP:                        neogeoReport.hat = NEOGEO_HAT_UP;        break;
@@ -1,4 +1,5 @@
 #include "drivers/p5general/P5GeneralDriver.h"
+#include "hotpath.h"
 #include "drivers/shared/driverhelper.h"
 #include "storagemanager.h"
 
@@ -122,7 +123,7 @@ bool P5GeneralDriver::shouldDeferIO() {
            p5GeneralAuthData->passthrough_state == P5GeneralGPAuthState::p5g_auth_recv_f2_wait;
 }
 
-bool P5GeneralDriver::process(Gamepad * gamepad) {
+bool HOT_PATH_FUNC(P5GeneralDriver::process)(Gamepad * gamepad) {
     if (!p5GeneralAuthData || !p5GeneralAuthData->dongle_ready) {
         return false;
     }
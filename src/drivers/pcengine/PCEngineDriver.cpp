@@ -1,4 +1,5 @@
 #include "drivers/pcengine/PCEngineDriver.h"
+#include "hotpath.h"
 #include "drivers/shared/driverhelper.h"
 
 void PCEngineDriver::initialize() {
@@ -25,7 +26,7 @@ void PCEngineDriver::initialize() {
 	};
 }
 
-bool PCEngineDriver::process(Gamepad * gamepad) {
+bool HOT_PATH_FUNC(PCEngineDriver::process)(Gamepad * gamepad) {
 	switch (gamepad->state.dpad & GAMEPAD_MASK_DPAD)
 	{
 		case GAMEPAD_MASK_UP:                        pcengineReport.hat = PCENGINE_HAT_UP;        break;
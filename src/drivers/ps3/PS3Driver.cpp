@@ -4,6 +4,7 @@
  */
 
 #include "drivers/ps3/PS3Driver.h"
+#include "hotpath.h"
 #include "drivers/ps3/PS3Descriptors.h"
 #include "drivers/shared/driverhelper.h"
 #include "storagemanager.h"
@@ -170,7 +171,7 @@ void PS3Driver::initialize() {
 }
 
 // Generate PS3 report from gamepad and send to TUSB Device
-bool PS3Driver::process(Gamepad * gamepad) {
+bool HOT_PATH_FUNC(PS3Driver::process)(Gamepad * gamepad) {
     const GamepadOptions & options = gamepad->getOptions();
     Mask_t values = Storage::getInstance().GetGamepad()->debouncedGpio;
 
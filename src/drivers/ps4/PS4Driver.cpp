@@ -1,4 +1,5 @@
 #include "drivers/ps4/PS4Driver.h"
+#include "hotpath.h"
 #include "drivers/shared/driverhelper.h"
 #include "storagemanager.h"
 #include "CRC32.h"
@@ -420,7 +421,7 @@ bool PS4Driver::getDongleAuthRequired() {
     return false;
 }
 
-bool PS4Driver::process(Gamepad * gamepad) {
+bool HOT_PATH_FUNC(PS4Driver::process)(Gamepad * gamepad) {
     const GamepadOptions & options = gamepad->getOptions();
     Mask_t values = Storage::getInstance().GetGamepad()->debouncedGpio;
     switch (gamepad->state.dpad & GAMEPAD_MASK_DPAD)
@@ -1,4 +1,5 @@
 #include "drivers/psclassic/PSClassicDriver.h"
+#include "hotpath.h"
 #include "drivers/shared/driverhelper.h"
 
 void PSClassicDriver::initialize() {
@@ -19,7 +20,7 @@ void PSClassicDriver::initialize() {
 	};
 }
 
-bool PSClassicDriver::process(Gamepad * gamepad) {
+bool HOT_PATH_FUNC(PSClassicDriver::process)(Gamepad * gamepad) {
 	psClassicReport.buttons = PSCLASSIC_MASK_CENTER;
 
 	switch (gamepad->state.dpad & GAMEPAD_MASK_DPAD)
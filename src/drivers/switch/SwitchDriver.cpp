@@ -1,4 +1,5 @@
 #include "drivers/switch/SwitchDriver.h"
+#include "hotpath.h"
 #include "drivers/shared/driverhelper.h"
 
 void SwitchDriver::initialize() {
@@ -25,7 +26,7 @@ void SwitchDriver::initialize() {
 	};
 }
 
-bool SwitchDriver::process(Gamepad * gamepad) {
+bool HOT_PATH_FUNC(SwitchDriver::process)(Gamepad * gamepad) {
 	switch (gamepad->state.dpad & GAMEPAD_MASK_DPAD)
 	{
 		case GAMEPAD_MASK_UP:                        switchReport.hat = SWITCH_HAT_UP;        break;
@@ -1,4 +1,5 @@
 #include "drivers/switchpro/SwitchProDriver.h"
+#include "hotpath.h"
 #include "drivers/shared/driverhelper.h"
 #include "storagemanager.h"
 #include "pico/rand.h"
@@ -92,7 +93,7 @@ void SwitchProDriver::initialize() {
 	};
 }
 
-bool SwitchProDriver::process(Gamepad * gamepad) {
+bool HOT_PATH_FUNC(SwitchProDriver::process)(Gamepad * gamepad) {
     uint32_t now = to_ms_since_boot(get_absolute_time());
     reportSent = false;
 
@@ -1,4 +1,5 @@
 #include "drivers/xbone/XBOneDriver.h"
+#include "hotpath.h"
 #include "drivers/shared/driverhelper.h"
 
 #include "drivers/xbone/XBOneAuth.h"
@@ -385,7 +386,7 @@ USBListener * XBOneDriver::get_usb_auth_listener() {
     return nullptr;
 }
 
-bool XBOneDriver::process(Gamepad * gamepad) {
+bool HOT_PATH_FUNC(XBOneDriver::process)(Gamepad * gamepad) {
     // Do nothing if we couldn't setup our auth listener
     if ( xboxOneAuthData == nullptr) {
         return false;
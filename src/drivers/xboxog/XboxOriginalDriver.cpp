@@ -1,4 +1,5 @@
 #include "drivers/xboxog/XboxOriginalDriver.h"
+#include "hotpath.h"
 #include "drivers/xboxog/xid/xid.h"
 #include "drivers/shared/driverhelper.h"
 
@@ -23,7 +24,7 @@ void XboxOriginalDriver::initialize() {
     memcpy(&class_driver, xid_get_driver(), sizeof(usbd_class_driver_t));
 }
 
-bool XboxOriginalDriver::process(Gamepad * gamepad) {
+bool HOT_PATH_FUNC(XboxOriginalDriver::process)(Gamepad * gamepad) {
 	// digital buttons
 	xboxOriginalReport.dButtons = 0
 		| (gamepad->pressedUp()    ? XID_DUP    : 0)
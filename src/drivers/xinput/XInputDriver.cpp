@@ -4,6 +4,7 @@
  */
 
 #include "drivers/xinput/XInputDriver.h"
+#include "hotpath.h"
 #include "drivers/shared/driverhelper.h"
 #include "storagemanager.h"
 
@@ -250,7 +251,7 @@ bool XInputDriver::getAuthSent() {
     return xAuthSent;
 }
 
-bool XInputDriver::process(Gamepad * gamepad) {
+bool HOT_PATH_FUNC(XInputDriver::process)(Gamepad * gamepad) {
     Gamepad * processedGamepad = Storage::getInstance().GetProcessedGamepad();
     Mask_t values = Storage::getInstance().GetGamepad()->debouncedGpio;
 
@@ -5,6 +5,7 @@
 
 // GP2040 Libraries
 #include "gamepad.h"
+#include "hotpath.h"
 #include "enums.pb.h"
 #include "storagemanager.h"
 #include "types.h"
@@ -28,6 +29,7 @@ uint64_t getMicro() {
 Gamepad::Gamepad() :
 	options(Storage::getInstance().getGamepadOptions())
 	, hotkeyOptions(Storage::getInstance().getHotkeyOptions())
+	, pinLookup()
 {
 }
 
@@ -36,56 +38,59 @@ void Gamepad::setup()
 	// Configure pin mapping
 	GpioMappingInfo* pinMappings = Storage::getInstance().getProfilePinMappings();
 
-	mapDpadUp       = new GamepadButtonMapping(GAMEPAD_MASK_UP);
-	mapDpadDown     = new GamepadButtonMapping(GAMEPAD_MASK_DOWN);
-	mapDpadLeft     = new GamepadButtonMapping(GAMEPAD_MASK_LEFT);
-	mapDpadRight    = new GamepadButtonMapping(GAMEPAD_MASK_RIGHT);
-	mapButtonB1     = new GamepadButtonMapping(GAMEPAD_MASK_B1);
-	mapButtonB2     = new GamepadButtonMapping(GAMEPAD_MASK_B2);
-	mapButtonB3     = new GamepadButtonMapping(GAMEPAD_MASK_B3);
-	mapButtonB4     = new GamepadButtonMapping(GAMEPAD_MASK_B4);
-	mapButtonL1     = new GamepadButtonMapping(GAMEPAD_MASK_L1);
-	mapButtonR1     = new GamepadButtonMapping(GAMEPAD_MASK_R1);
-	mapButtonL2     = new GamepadButtonMapping(GAMEPAD_MASK_L2);
-	mapButtonR2     = new GamepadButtonMapping(GAMEPAD_MASK_R2);
-	mapButtonS1     = new GamepadButtonMapping(GAMEPAD_MASK_S1);
-	mapButtonS2     = new GamepadButtonMapping(GAMEPAD_MASK_S2);
-	mapButtonL3     = new GamepadButtonMapping(GAMEPAD_MASK_L3);
-	mapButtonR3     = new GamepadButtonMapping(GAMEPAD_MASK_R3);
-	mapButtonA1     = new GamepadButtonMapping(GAMEPAD_MASK_A1);
-	mapButtonA2     = new GamepadButtonMapping(GAMEPAD_MASK_A2);
-	mapButtonA3     = new GamepadButtonMapping(GAMEPAD_MASK_A3);
-	mapButtonA4     = new GamepadButtonMapping(GAMEPAD_MASK_A4);
-	mapButtonE1     = new GamepadButtonMapping(GAMEPAD_MASK_E1);
-	mapButtonE2     = new GamepadButtonMapping(GAMEPAD_MASK_E2);
-	mapButtonE3     = new GamepadButtonMapping(GAMEPAD_MASK_E3);
-	mapButtonE4     = new GamepadButtonMapping(GAMEPAD_MASK_E4);
-	mapButtonE5     = new GamepadButtonMapping(GAMEPAD_MASK_E5);
-	mapButtonE6     = new GamepadButtonMapping(GAMEPAD_MASK_E6);
-	mapButtonE7     = new GamepadButtonMapping(GAMEPAD_MASK_E7);
-	mapButtonE8     = new GamepadButtonMapping(GAMEPAD_MASK_E8);
-	mapButtonE9     = new GamepadButtonMapping(GAMEPAD_MASK_E9);
-	mapButtonE10    = new GamepadButtonMapping(GAMEPAD_MASK_E10);
-	mapButtonE11    = new GamepadButtonMapping(GAMEPAD_MASK_E11);
-	mapButtonE12    = new GamepadButtonMapping(GAMEPAD_MASK_E12);
-	mapButtonFn     = new GamepadButtonMapping(AUX_MASK_FUNCTION);
-	mapButtonDP     = new GamepadButtonMapping(SUSTAIN_DP_MODE_DP);
-	mapButtonLS     = new GamepadButtonMapping(SUSTAIN_DP_MODE_LS);
-	mapButtonRS     = new GamepadButtonMapping(SUSTAIN_DP_MODE_RS);
-	mapDigitalUp    = new GamepadButtonMapping(GAMEPAD_MASK_UP);
-	mapDigitalDown  = new GamepadButtonMapping(GAMEPAD_MASK_DOWN);
-	mapDigitalLeft  = new GamepadButtonMapping(GAMEPAD_MASK_LEFT);
-	mapDigitalRight = new GamepadButtonMapping(GAMEPAD_MASK_RIGHT);
-	mapAnalogLSXNeg = new GamepadButtonMapping(ANALOG_DIRECTION_LS_X_NEG);
-	mapAnalogLSXPos = new GamepadButtonMapping(ANALOG_DIRECTION_LS_X_POS);
-	mapAnalogLSYNeg = new GamepadButtonMapping(ANALOG_DIRECTION_LS_Y_NEG);
-	mapAnalogLSYPos = new GamepadButtonMapping(ANALOG_DIRECTION_LS_Y_POS);
-	mapAnalogRSXNeg = new GamepadButtonMapping(ANALOG_DIRECTION_RS_X_NEG);
-	mapAnalogRSXPos = new GamepadButtonMapping(ANALOG_DIRECTION_RS_X_POS);
-	mapAnalogRSYNeg = new GamepadButtonMapping(ANALOG_DIRECTION_RS_Y_NEG);
-	mapAnalogRSYPos = new GamepadButtonMapping(ANALOG_DIRECTION_RS_Y_POS);
-	map48WayMode    = new GamepadButtonMapping(SUSTAIN_4_8_WAY_MODE);
-	mapFocusMode    = new GamepadButtonMapping(SUSTAIN_FOCUS_MODE);
+	// mapping objects are created once and reused by reinit()
+	if (mapDpadUp == nullptr) {
+		mapDpadUp       = new GamepadButtonMapping(GAMEPAD_MASK_UP);
+		mapDpadDown     = new GamepadButtonMapping(GAMEPAD_MASK_DOWN);
+		mapDpadLeft     = new GamepadButtonMapping(GAMEPAD_MASK_LEFT);
+		mapDpadRight    = new GamepadButtonMapping(GAMEPAD_MASK_RIGHT);
+		mapButtonB1     = new GamepadButtonMapping(GAMEPAD_MASK_B1);
+		mapButtonB2     = new GamepadButtonMapping(GAMEPAD_MASK_B2);
+		mapButtonB3     = new GamepadButtonMapping(GAMEPAD_MASK_B3);
+		mapButtonB4     = new GamepadButtonMapping(GAMEPAD_MASK_B4);
+		mapButtonL1     = new GamepadButtonMapping(GAMEPAD_MASK_L1);
+		mapButtonR1     = new GamepadButtonMapping(GAMEPAD_MASK_R1);
+		mapButtonL2     = new GamepadButtonMapping(GAMEPAD_MASK_L2);
+		mapButtonR2     = new GamepadButtonMapping(GAMEPAD_MASK_R2);
+		mapButtonS1     = new GamepadButtonMapping(GAMEPAD_MASK_S1);
+		mapButtonS2     = new GamepadButtonMapping(GAMEPAD_MASK_S2);
+		mapButtonL3     = new GamepadButtonMapping(GAMEPAD_MASK_L3);
+		mapButtonR3     = new GamepadButtonMapping(GAMEPAD_MASK_R3);
+		mapButtonA1     = new GamepadButtonMapping(GAMEPAD_MASK_A1);
+		mapButtonA2     = new GamepadButtonMapping(GAMEPAD_MASK_A2);
+		mapButtonA3     = new GamepadButtonMapping(GAMEPAD_MASK_A3);
+		mapButtonA4     = new GamepadButtonMapping(GAMEPAD_MASK_A4);
+		mapButtonE1     = new GamepadButtonMapping(GAMEPAD_MASK_E1);
+		mapButtonE2     = new GamepadButtonMapping(GAMEPAD_MASK_E2);
+		mapButtonE3     = new GamepadButtonMapping(GAMEPAD_MASK_E3);
+		mapButtonE4     = new GamepadButtonMapping(GAMEPAD_MASK_E4);
+		mapButtonE5     = new GamepadButtonMapping(GAMEPAD_MASK_E5);
+		mapButtonE6     = new GamepadButtonMapping(GAMEPAD_MASK_E6);
+		mapButtonE7     = new GamepadButtonMapping(GAMEPAD_MASK_E7);
+		mapButtonE8     = new GamepadButtonMapping(GAMEPAD_MASK_E8);
+		mapButtonE9     = new GamepadButtonMapping(GAMEPAD_MASK_E9);
+		mapButtonE10    = new GamepadButtonMapping(GAMEPAD_MASK_E10);
+		mapButtonE11    = new GamepadButtonMapping(GAMEPAD_MASK_E11);
+		mapButtonE12    = new GamepadButtonMapping(GAMEPAD_MASK_E12);
+		mapButtonFn     = new GamepadButtonMapping(AUX_MASK_FUNCTION);
+		mapButtonDP     = new GamepadButtonMapping(SUSTAIN_DP_MODE_DP);
+		mapButtonLS     = new GamepadButtonMapping(SUSTAIN_DP_MODE_LS);
+		mapButtonRS     = new GamepadButtonMapping(SUSTAIN_DP_MODE_RS);
+		mapDigitalUp    = new GamepadButtonMapping(GAMEPAD_MASK_UP);
+		mapDigitalDown  = new GamepadButtonMapping(GAMEPAD_MASK_DOWN);
+		mapDigitalLeft  = new GamepadButtonMapping(GAMEPAD_MASK_LEFT);
+		mapDigitalRight = new GamepadButtonMapping(GAMEPAD_MASK_RIGHT);
+		mapAnalogLSXNeg = new GamepadButtonMapping(ANALOG_DIRECTION_LS_X_NEG);
+		mapAnalogLSXPos = new GamepadButtonMapping(ANALOG_DIRECTION_LS_X_POS);
+		mapAnalogLSYNeg = new GamepadButtonMapping(ANALOG_DIRECTION_LS_Y_NEG);
+		mapAnalogLSYPos = new GamepadButtonMapping(ANALOG_DIRECTION_LS_Y_POS);
+		mapAnalogRSXNeg = new GamepadButtonMapping(ANALOG_DIRECTION_RS_X_NEG);
+		mapAnalogRSXPos = new GamepadButtonMapping(ANALOG_DIRECTION_RS_X_POS);
+		mapAnalogRSYNeg = new GamepadButtonMapping(ANALOG_DIRECTION_RS_Y_NEG);
+		mapAnalogRSYPos = new GamepadButtonMapping(ANALOG_DIRECTION_RS_Y_POS);
+		map48WayMode    = new GamepadButtonMapping(SUSTAIN_4_8_WAY_MODE);
+		mapFocusMode    = new GamepadButtonMapping(SUSTAIN_FOCUS_MODE);
+	}
 
 	const auto assignCustomMappingToMaps = [&](GpioMappingInfo mapInfo, Pin_t pin) -> void {
 		if (mapDpadUp->buttonMask & mapInfo.customDpadMask)	mapDpadUp->pinMask |= 1 << pin;
@@ -170,6 +175,8 @@ void Gamepad::setup()
 		}
 	}
 
+	compilePinLookup();
+
 	// Define our hotkey array
 	hotkeys[0] = hotkeyOptions.hotkey01;
 	hotkeys[1] = hotkeyOptions.hotkey02;
@@ -190,66 +197,146 @@ void Gamepad::setup()
 }
 
 /**
- * @brief Undo setup().
+ * @brief Undo setup(). The mapping objects are kept, only their pins are cleared.
  */
 void Gamepad::reinit()
 {
-	delete mapDpadUp;
-	delete mapDpadDown;
-	delete mapDpadLeft;
-	delete mapDpadRight;
-	delete mapButtonB1;
-	delete mapButtonB2;
-	delete mapButtonB3;
-	delete mapButtonB4;
-	delete mapButtonL1;
-	delete mapButtonR1;
-	delete mapButtonL2;
-	delete mapButtonR2;
-	delete mapButtonS1;
-	delete mapButtonS2;
-	delete mapButtonL3;
-	delete mapButtonR3;
-	delete mapButtonA1;
-	delete mapButtonA2;
-	delete mapButtonA3;
-	delete mapButtonA4;
-	delete mapButtonE1;
-	delete mapButtonE2;
-	delete mapButtonE3;
-	delete mapButtonE4;
-	delete mapButtonE5;
-	delete mapButtonE6;
-	delete mapButtonE7;
-	delete mapButtonE8;
-	delete mapButtonE9;
-	delete mapButtonE10;
-	delete mapButtonE11;
-	delete mapButtonE12;
-	delete mapButtonFn;
-	delete mapButtonDP;
-	delete mapButtonLS;
-	delete mapButtonRS;
-	delete mapDigitalUp;
-	delete mapDigitalDown;
-	delete mapDigitalLeft;
-	delete mapDigitalRight;
-	delete mapAnalogLSXNeg;
-	delete mapAnalogLSXPos;
-	delete mapAnalogLSYNeg;
-	delete mapAnalogLSYPos;
-	delete mapAnalogRSXNeg;
-	delete mapAnalogRSXPos;
-	delete mapAnalogRSYNeg;
-	delete mapAnalogRSYPos;
-	delete map48WayMode;
-	delete mapFocusMode;
+	mapDpadUp->pinMask = 0;
+	mapDpadDown->pinMask = 0;
+	mapDpadLeft->pinMask = 0;
+	mapDpadRight->pinMask = 0;
+	mapButtonB1->pinMask = 0;
+	mapButtonB2->pinMask = 0;
+	mapButtonB3->pinMask = 0;
+	mapButtonB4->pinMask = 0;
+	mapButtonL1->pinMask = 0;
+	mapButtonR1->pinMask = 0;
+	mapButtonL2->pinMask = 0;
+	mapButtonR2->pinMask = 0;
+	mapButtonS1->pinMask = 0;
+	mapButtonS2->pinMask = 0;
+	mapButtonL3->pinMask = 0;
+	mapButtonR3->pinMask = 0;
+	mapButtonA1->pinMask = 0;
+	mapButtonA2->pinMask = 0;
+	mapButtonA3->pinMask = 0;
+	mapButtonA4->pinMask = 0;
+	mapButtonE1->pinMask = 0;
+	mapButtonE2->pinMask = 0;
+	mapButtonE3->pinMask = 0;
+	mapButtonE4->pinMask = 0;
+	mapButtonE5->pinMask = 0;
+	mapButtonE6->pinMask = 0;
+	mapButtonE7->pinMask = 0;
+	mapButtonE8->pinMask = 0;
+	mapButtonE9->pinMask = 0;
+	mapButtonE10->pinMask = 0;
+	mapButtonE11->pinMask = 0;
+	mapButtonE12->pinMask = 0;
+	mapButtonFn->pinMask = 0;
+	mapButtonDP->pinMask = 0;
+	mapButtonLS->pinMask = 0;
+	mapButtonRS->pinMask = 0;
+	mapDigitalUp->pinMask = 0;
+	mapDigitalDown->pinMask = 0;
+	mapDigitalLeft->pinMask = 0;
+	mapDigitalRight->pinMask = 0;
+	mapAnalogLSXNeg->pinMask = 0;
+	mapAnalogLSXPos->pinMask = 0;
+	mapAnalogLSYNeg->pinMask = 0;
+	mapAnalogLSYPos->pinMask = 0;
+	mapAnalogRSXNeg->pinMask = 0;
+	mapAnalogRSXPos->pinMask = 0;
+	mapAnalogRSYNeg->pinMask = 0;
+	mapAnalogRSYPos->pinMask = 0;
+	map48WayMode->pinMask = 0;
+	mapFocusMode->pinMask = 0;
 
 	// reinitialize pin mappings
 	this->setup();
 }
 
-void Gamepad::process()
+/**
+ * @brief Precompute what every nibble of GPIO state maps to, so read() never has to walk the mappings.
+ */
+void Gamepad::compilePinLookup()
+{
+	const struct {
+		const GamepadButtonMapping * map;
+		uint32_t buttons;
+		uint16_t modifiers;
+		uint8_t dpad;
+	} sources[] = {
+		{ mapDpadUp,       0, 0, (uint8_t)mapDpadUp->buttonMask },
+		{ mapDpadDown,     0, 0, (uint8_t)mapDpadDown->buttonMask },
+		{ mapDpadLeft,     0, 0, (uint8_t)mapDpadLeft->buttonMask },
+		{ mapDpadRight,    0, 0, (uint8_t)mapDpadRight->buttonMask },
+		{ mapDigitalUp,    0, 0, (uint8_t)(mapDigitalUp->buttonMask << 4) },
+		{ mapDigitalDown,  0, 0, (uint8_t)(mapDigitalDown->buttonMask << 4) },
+		{ mapDigitalLeft,  0, 0, (uint8_t)(mapDigitalLeft->buttonMask << 4) },
+		{ mapDigitalRight, 0, 0, (uint8_t)(mapDigitalRight->buttonMask << 4) },
+		{ mapButtonB1,     mapButtonB1->buttonMask,  0, 0 },
+		{ mapButtonB2,     mapButtonB2->buttonMask,  0, 0 },
+		{ mapButtonB3,     mapButtonB3->buttonMask,  0, 0 },
+		{ mapButtonB4,     mapButtonB4->buttonMask,  0, 0 },
+		{ mapButtonL1,     mapButtonL1->buttonMask,  0, 0 },
+		{ mapButtonR1,     mapButtonR1->buttonMask,  0, 0 },
+		{ mapButtonL2,     mapButtonL2->buttonMask,  0, 0 },
+		{ mapButtonR2,     mapButtonR2->buttonMask,  0, 0 },
+		{ mapButtonS1,     mapButtonS1->buttonMask,  0, 0 },
+		{ mapButtonS2,     mapButtonS2->buttonMask,  0, 0 },
+		{ mapButtonL3,     mapButtonL3->buttonMask,  0, 0 },
+		{ mapButtonR3,     mapButtonR3->buttonMask,  0, 0 },
+		{ mapButtonA1,     mapButtonA1->buttonMask,  0, 0 },
+		{ mapButtonA2,     mapButtonA2->buttonMask,  0, 0 },
+		{ mapButtonA3,     mapButtonA3->buttonMask,  0, 0 },
+		{ mapButtonA4,     mapButtonA4->buttonMask,  0, 0 },
+		{ mapButtonE1,     mapButtonE1->buttonMask,  0, 0 },
+		{ mapButtonE2,     mapButtonE2->buttonMask,  0, 0 },
+		{ mapButtonE3,     mapButtonE3->buttonMask,  0, 0 },
+		{ mapButtonE4,     mapButtonE4->buttonMask,  0, 0 },
+		{ mapButtonE5,     mapButtonE5->buttonMask,  0, 0 },
+		{ mapButtonE6,     mapButtonE6->buttonMask,  0, 0 },
+		{ mapButtonE7,     mapButtonE7->buttonMask,  0, 0 },
+		{ mapButtonE8,     mapButtonE8->buttonMask,  0, 0 },
+		{ mapButtonE9,     mapButtonE9->buttonMask,  0, 0 },
+		{ mapButtonE10,    mapButtonE10->buttonMask, 0, 0 },
+		{ mapButtonE11,    mapButtonE11->buttonMask, 0, 0 },
+		{ mapButtonE12,    mapButtonE12->buttonMask, 0, 0 },
+		{ mapButtonFn,     0, PIN_LOOKUP_FUNCTION,     0 },
+		{ mapButtonDP,     0, PIN_LOOKUP_DPAD_MODE_DP, 0 },
+		{ mapButtonLS,     0, PIN_LOOKUP_DPAD_MODE_LS, 0 },
+		{ mapButtonRS,     0, PIN_LOOKUP_DPAD_MODE_RS, 0 },
+		{ map48WayMode,    0, PIN_LOOKUP_4_8_WAY_MODE, 0 },
+		{ mapAnalogLSXNeg, 0, PIN_LOOKUP_LS_X_NEG,     0 },
+		{ mapAnalogLSXPos, 0, PIN_LOOKUP_LS_X_POS,     0 },
+		{ mapAnalogLSYNeg, 0, PIN_LOOKUP_LS_Y_NEG,     0 },
+		{ mapAnalogLSYPos, 0, PIN_LOOKUP_LS_Y_POS,     0 },
+		{ mapAnalogRSXNeg, 0, PIN_LOOKUP_RS_X_NEG,     0 },
+		{ mapAnalogRSXPos, 0, PIN_LOOKUP_RS_X_POS,     0 },
+		{ mapAnalogRSYNeg, 0, PIN_LOOKUP_RS_Y_NEG,     0 },
+		{ mapAnalogRSYPos, 0, PIN_LOOKUP_RS_Y_POS,     0 },
+	};
+
+	for (uint32_t i = 0; i < PIN_LOOKUP_TABLES; i++) {
+		for (uint32_t value = 0; value < PIN_LOOKUP_ENTRIES; value++) {
+			Mask_t pins = value << (i * PIN_LOOKUP_BITS);
+			GamepadPinLookup & entry = pinLookup[i][value];
+			entry.buttons = 0;
+			entry.modifiers = 0;
+			entry.dpad = 0;
+			for (const auto & source : sources) {
+				if (pins & source.map->pinMask) {
+					entry.buttons |= source.buttons;
+					entry.modifiers |= source.modifiers;
+					entry.dpad |= source.dpad;
+				}
+			}
+		}
+	}
+}
+
+void HOT_PATH_FUNC(Gamepad::process)()
 {
 	// NOTE: Inverted X/Y-axis must run before SOCD and Dpad processing
 	if (options.invertXAxis) {
@@ -318,7 +405,7 @@ void Gamepad::process()
 	}
 }
 
-void Gamepad::read()
+void HOT_PATH_FUNC(Gamepad::read)()
 {
 	Mask_t values = Storage::getInstance().GetGamepad()->debouncedGpio;
 
@@ -328,84 +415,54 @@ void Gamepad::read()
 		joystickMid = DriverManager::getInstance().getDriver()->GetJoystickMidValue();
 	}
 
-	state.aux = 0
-		| (values & mapButtonFn->pinMask)   ? mapButtonFn->buttonMask : 0;
-
-	state.dpad = 0
-		| ((values & mapDpadUp->pinMask)       ? mapDpadUp->buttonMask              : 0)
-		| ((values & mapDpadDown->pinMask)     ? mapDpadDown->buttonMask            : 0)
-		| ((values & mapDpadLeft->pinMask)     ? mapDpadLeft->buttonMask            : 0)
-		| ((values & mapDpadRight->pinMask)    ? mapDpadRight->buttonMask           : 0)
-		| ((values & mapDigitalUp->pinMask)    ? (mapDigitalUp->buttonMask << 4)    : 0)
-		| ((values & mapDigitalDown->pinMask)  ? (mapDigitalDown->buttonMask << 4)  : 0)
-		| ((values & mapDigitalLeft->pinMask)  ? (mapDigitalLeft->buttonMask << 4)  : 0)
-		| ((values & mapDigitalRight->pinMask) ? (mapDigitalRight->buttonMask << 4) : 0)
-	;
-
-	state.buttons = 0
-		| ((values & mapButtonB1->pinMask)  ? mapButtonB1->buttonMask  : 0)
-		| ((values & mapButtonB2->pinMask)  ? mapButtonB2->buttonMask  : 0)
-		| ((values & mapButtonB3->pinMask)  ? mapButtonB3->buttonMask  : 0)
-		| ((values & mapButtonB4->pinMask)  ? mapButtonB4->buttonMask  : 0)
-		| ((values & mapButtonL1->pinMask)  ? mapButtonL1->buttonMask  : 0)
-		| ((values & mapButtonR1->pinMask)  ? mapButtonR1->buttonMask  : 0)
-		| ((values & mapButtonL2->pinMask)  ? mapButtonL2->buttonMask  : 0)
-		| ((values & mapButtonR2->pinMask)  ? mapButtonR2->buttonMask  : 0)
-		| ((values & mapButtonS1->pinMask)  ? mapButtonS1->buttonMask  : 0)
-		| ((values & mapButtonS2->pinMask)  ? mapButtonS2->buttonMask  : 0)
-		| ((values & mapButtonL3->pinMask)  ? mapButtonL3->buttonMask  : 0)
-		| ((values & mapButtonR3->pinMask)  ? mapButtonR3->buttonMask  : 0)
-		| ((values & mapButtonA1->pinMask)  ? mapButtonA1->buttonMask  : 0)
-		| ((values & mapButtonA2->pinMask)  ? mapButtonA2->buttonMask  : 0)
-		| ((values & mapButtonA3->pinMask)  ? mapButtonA3->buttonMask  : 0)
-		| ((values & mapButtonA4->pinMask)  ? mapButtonA4->buttonMask  : 0)
-		| ((values & mapButtonE1->pinMask)  ? mapButtonE1->buttonMask  : 0)
-		| ((values & mapButtonE2->pinMask)  ? mapButtonE2->buttonMask  : 0)
-		| ((values & mapButtonE3->pinMask)  ? mapButtonE3->buttonMask  : 0)
-		| ((values & mapButtonE4->pinMask)  ? mapButtonE4->buttonMask  : 0)
-		| ((values & mapButtonE5->pinMask)  ? mapButtonE5->buttonMask  : 0)
-		| ((values & mapButtonE6->pinMask)  ? mapButtonE6->buttonMask  : 0)
-		| ((values & mapButtonE7->pinMask)  ? mapButtonE7->buttonMask  : 0)
-		| ((values & mapButtonE8->pinMask)  ? mapButtonE8->buttonMask  : 0)
-		| ((values & mapButtonE9->pinMask)  ? mapButtonE9->buttonMask  : 0)
-		| ((values & mapButtonE10->pinMask) ? mapButtonE10->buttonMask : 0)
-		| ((values & mapButtonE11->pinMask) ? mapButtonE11->buttonMask : 0)
-		| ((values & mapButtonE12->pinMask) ? mapButtonE12->buttonMask : 0)
-	;
+	// OR together what each nibble of GPIO state maps to
+	uint32_t buttons = 0;
+	uint16_t modifiers = 0;
+	uint8_t dpad = 0;
+	for (uint32_t i = 0; i < PIN_LOOKUP_TABLES; i++) {
+		const GamepadPinLookup & entry = pinLookup[i][(values >> (i * PIN_LOOKUP_BITS)) & (PIN_LOOKUP_ENTRIES - 1)];
+		buttons |= entry.buttons;
+		modifiers |= entry.modifiers;
+		dpad |= entry.dpad;
+	}
+
+	state.aux = (modifiers & PIN_LOOKUP_FUNCTION) ? AUX_MASK_FUNCTION : 0;
+	state.dpad = dpad;
+	state.buttons = buttons;
 
 	// set the effective dpad mode based on settings + overrides
-	if (values & mapButtonDP->pinMask)	activeDpadMode = DpadMode::DPAD_MODE_DIGITAL;
-	else if (values & mapButtonLS->pinMask)	activeDpadMode = DpadMode::DPAD_MODE_LEFT_ANALOG;
-	else if (values & mapButtonRS->pinMask)	activeDpadMode = DpadMode::DPAD_MODE_RIGHT_ANALOG;
+	if (modifiers & PIN_LOOKUP_DPAD_MODE_DP)	activeDpadMode = DpadMode::DPAD_MODE_DIGITAL;
+	else if (modifiers & PIN_LOOKUP_DPAD_MODE_LS)	activeDpadMode = DpadMode::DPAD_MODE_LEFT_ANALOG;
+	else if (modifiers & PIN_LOOKUP_DPAD_MODE_RS)	activeDpadMode = DpadMode::DPAD_MODE_RIGHT_ANALOG;
 	else					activeDpadMode = options.dpadMode;
 
-	map48WayModeToggle = (values & map48WayMode->pinMask);
+	map48WayModeToggle = (modifiers & PIN_LOOKUP_4_8_WAY_MODE) != 0;
 
-	if (values & mapAnalogLSXNeg->pinMask) {
+	if (modifiers & PIN_LOOKUP_LS_X_NEG) {
 		state.lx = GAMEPAD_JOYSTICK_MIN;
-	} else if (values & mapAnalogLSXPos->pinMask) {
+	} else if (modifiers & PIN_LOOKUP_LS_X_POS) {
 		state.lx = GAMEPAD_JOYSTICK_MAX;
 	} else {
 		state.lx = joystickMid;
 	}
-	if (values & mapAnalogLSYNeg->pinMask) {
+	if (modifiers & PIN_LOOKUP_LS_Y_NEG) {
 		state.ly = GAMEPAD_JOYSTICK_MIN;
-	} else if (values & mapAnalogLSYPos->pinMask) {
+	} else if (modifiers & PIN_LOOKUP_LS_Y_POS) {
 		state.ly = GAMEPAD_JOYSTICK_MAX;
 	} else {
 		state.ly = joystickMid;
 	}
 
-	if (values & mapAnalogRSXNeg->pinMask) {
+	if (modifiers & PIN_LOOKUP_RS_X_NEG) {
 		state.rx = GAMEPAD_JOYSTICK_MIN;
-	} else if (values & mapAnalogRSXPos->pinMask) {
+	} else if (modifiers & PIN_LOOKUP_RS_X_POS) {
 		state.rx = GAMEPAD_JOYSTICK_MAX;
 	} else {
 		state.rx = joystickMid;
 	}
-	if (values & mapAnalogRSYNeg->pinMask) {
+	if (modifiers & PIN_LOOKUP_RS_Y_NEG) {
 		state.ry = GAMEPAD_JOYSTICK_MIN;
-	} else if (values & mapAnalogRSYPos->pinMask) {
+	} else if (modifiers & PIN_LOOKUP_RS_Y_POS) {
 		state.ry = GAMEPAD_JOYSTICK_MAX;
 	} else {
 		state.ry = joystickMid;
@@ -415,7 +472,7 @@ void Gamepad::read()
 	state.rt = 0;
 }
 
-void Gamepad::hotkey() {
+void HOT_PATH_FUNC(Gamepad::hotkey)() {
 	if (options.lockHotkeys)
 		return;
 
@@ -693,37 +750,44 @@ void Gamepad::processHotkeyAction(GamepadHotkey action) {
 			break;
 		case HOTKEY_MENU_NAV_UP:
 			if (action != lastAction) {
-                EventManager::getInstance().triggerEvent(new GPMenuNavigateEvent(GpioAction::MENU_NAVIGATION_UP));
+                GPMenuNavigateEvent event(GpioAction::MENU_NAVIGATION_UP);
+                EventManager::getInstance().triggerEvent(event);
             }
 			break;
 		case HOTKEY_MENU_NAV_DOWN:
 			if (action != lastAction) {
-                EventManager::getInstance().triggerEvent(new GPMenuNavigateEvent(GpioAction::MENU_NAVIGATION_DOWN));
+                GPMenuNavigateEvent event(GpioAction::MENU_NAVIGATION_DOWN);
+                EventManager::getInstance().triggerEvent(event);
             }
 			break;
 		case HOTKEY_MENU_NAV_LEFT:
 			if (action != lastAction) {
-                EventManager::getInstance().triggerEvent(new GPMenuNavigateEvent(GpioAction::MENU_NAVIGATION_LEFT));
+                GPMenuNavigateEvent event(GpioAction::MENU_NAVIGATION_LEFT);
+                EventManager::getInstance().triggerEvent(event);
             }
 			break;
 		case HOTKEY_MENU_NAV_RIGHT:
 			if (action != lastAction) {
-                EventManager::getInstance().triggerEvent(new GPMenuNavigateEvent(GpioAction::MENU_NAVIGATION_RIGHT));
+                GPMenuNavigateEvent event(GpioAction::MENU_NAVIGATION_RIGHT);
+                EventManager::getInstance().triggerEvent(event);
             }
 			break;
 		case HOTKEY_MENU_NAV_SELECT:
 			if (action != lastAction) {
-                EventManager::getInstance().triggerEvent(new GPMenuNavigateEvent(GpioAction::MENU_NAVIGATION_SELECT));
+                GPMenuNavigateEvent event(GpioAction::MENU_NAVIGATION_SELECT);
+                EventManager::getInstance().triggerEvent(event);
             }
 			break;
 		case HOTKEY_MENU_NAV_BACK:
 			if (action != lastAction) {
-                EventManager::getInstance().triggerEvent(new GPMenuNavigateEvent(GpioAction::MENU_NAVIGATION_BACK));
+                GPMenuNavigateEvent event(GpioAction::MENU_NAVIGATION_BACK);
+                EventManager::getInstance().triggerEvent(event);
             }
 			break;
 		case HOTKEY_MENU_NAV_TOGGLE:
 			if (action != lastAction) {
-				EventManager::getInstance().triggerEvent(new GPMenuNavigateEvent(GpioAction::MENU_NAVIGATION_TOGGLE));
+				GPMenuNavigateEvent event(GpioAction::MENU_NAVIGATION_TOGGLE);
+				EventManager::getInstance().triggerEvent(event);
 			}
 			break;
 		case HOTKEY_FOCUS_MODE_TOGGLE:
@@ -763,7 +827,8 @@ void Gamepad::processHotkeyAction(GamepadHotkey action) {
 
 	// only save if requested
 	if (reqSave) {
-		EventManager::getInstance().triggerEvent(new GPStorageSaveEvent(true));
+		GPStorageSaveEvent event(true, false, true);
+		EventManager::getInstance().triggerEvent(event);
 	}
 
 	lastAction = action;
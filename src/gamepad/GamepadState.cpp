@@ -1,4 +1,5 @@
 #include "GamepadState.h"
+#include "hotpath.h"
 #include "drivermanager.h"
 
 // Convert the horizontal GamepadState dpad axis value into an analog value
@@ -97,7 +98,7 @@ uint8_t filterToFourWayMode(uint8_t dpad)
  * @param dpad The GamepadState.dpad value.
  * @return uint8_t The clean D-pad value.
  */
-uint8_t runSOCDCleaner(SOCDMode mode, uint8_t dpad)
+uint8_t HOT_PATH_FUNC(runSOCDCleaner)(SOCDMode mode, uint8_t dpad)
 {
 	if (mode == SOCD_MODE_BYPASS) {
 		return dpad;
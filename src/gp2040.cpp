@@ -1,5 +1,6 @@
 // GP2040 includes
 #include "gp2040.h"
+#include "hotpath.h"
 #include "helper.h"
 #include "system.h"
 #include "enums.pb.h"
@@ -8,8 +9,10 @@
 #include "peripheralmanager.h"
 #include "storagemanager.h"
 #include "addonmanager.h"
+#include "loopstats.h"
 #include "types.h"
 #include "usbhostmanager.h"
+#include "usbreportscheduler.h"
 
 // Inputs for Core0
 #include "addons/analog.h"
@@ -133,6 +136,7 @@ void GP2040::setup() {
 			inputMode = INPUT_MODE_CONFIG;
 			break;
 		case BootAction::ENTER_USB_MODE:
+			EEPROM.flush();
 			reset_usb_boot(0, 0);
 			return;
 		case BootAction::SET_INPUT_MODE_SWITCH:
@@ -201,6 +205,12 @@ void GP2040::setup() {
 		Storage::getInstance().save(true);
 	}
 
+	// Add-ons have claimed their ADC inputs, so switch the ADC to free running DMA sampling.
+	// Web-config keeps blocking reads for its own calibration endpoints.
+	if (inputMode != INPUT_MODE_CONFIG) {
+		PeripheralManager::getInstance().getADC()->start();
+	}
+
 	// register system event handlers
 	EventManager::getInstance().registerEventHandler(GP_EVENT_STORAGE_SAVE, GPEVENT_CALLBACK(this->handleStorageSave(event)));
 	EventManager::getInstance().registerEventHandler(GP_EVENT_RESTART, GPEVENT_CALLBACK(this->handleSystemReboot(event)));
@@ -212,6 +222,7 @@ void GP2040::setup() {
 void GP2040::initializeStandardGpio() {
 	GpioMappingInfo* pinMappings = Storage::getInstance().getProfilePinMappings();
 	buttonGpios = 0;
+	gpioDebounceActive = 0;
 	for (Pin_t pin = 0; pin < (Pin_t)NUM_BANK0_GPIOS; pin++)
 	{
 		// (NONE=-10, RESERVED=-5, ASSIGNED_TO_ADDON=0, everything else is ours)
@@ -249,45 +260,114 @@ void GP2040::deinitializeStandardGpio() {
  * For ease of use this provides the mask bitwise NOTed so that callers don't have to. To avoid misuse
  * and to simplify this method, non-button GPIO IS NOT PRESENT in this result. Use gpio_get_all directly
  * instead, if you don't want debounced data.
+ *
+ * Only pins whose raw state differs from the debounced state, or that are still mid-debounce, are
+ * visited, so an idle controller costs a couple of mask operations per call. Timing is kept in
+ * microseconds; a pin is only compared against its own timestamp while it is marked active, which
+ * keeps the 32-bit timer wrap harmless. Presses and releases have separate delays.
  */
-void GP2040::debounceGpioGetAll() {
-	Mask_t raw_gpio = ~gpio_get_all();
+void HOT_PATH_FUNC(GP2040::debounceGpioGetAll)() {
+	Mask_t raw_gpio = ~gpio_get_all() & buttonGpios;
 	Gamepad* gamepad = Storage::getInstance().GetGamepad();
-	// return if state isn't different than the actual
-	if (gamepad->debouncedGpio == (raw_gpio & buttonGpios)) return;
+	Mask_t pending = (gamepad->debouncedGpio ^ raw_gpio) | gpioDebounceActive;
+	// return if state isn't different than the actual and nothing is mid-debounce
+	if (pending == 0) return;
 
-	uint32_t debounceDelay = Storage::getInstance().getGamepadOptions().debounceDelay;
+	const GamepadOptions & options = Storage::getInstance().getGamepadOptions();
+	uint32_t pressDelay = options.debounceDelay * 1000;
+	uint32_t releaseDelay = options.debounceReleaseDelay * 1000;
 	// abort if no delay is configured
-	if (debounceDelay == 0) {
+	if (pressDelay == 0 && releaseDelay == 0) {
 		gamepad->debouncedGpio = raw_gpio;
+		gpioDebounceActive = 0;
 		return;
 	}
 
-	uint32_t now = getMillis();
-	// check each button use case GPIO for state
-	for (Pin_t pin = 0; pin < (Pin_t)NUM_BANK0_GPIOS; pin++) {
-		Mask_t pin_mask = 1 << pin;
-		if (buttonGpios & pin_mask) {
-			// Allow debouncer to change state if button state changed and debounce delay threshold met
-			if ((gamepad->debouncedGpio & pin_mask) != \
-					(raw_gpio & pin_mask) && ((now - gpioDebounceTime[pin]) > debounceDelay)) {
-				gamepad->debouncedGpio ^= pin_mask;
-				gpioDebounceTime[pin] = now;
-			}
+	uint32_t now = time_us_32();
+	Mask_t debounced = gamepad->debouncedGpio;
+	while (pending) {
+		Pin_t pin = __builtin_ctz(pending);
+		Mask_t pin_mask = 1U << pin;
+		pending &= pending - 1;
+
+		bool differs = (debounced ^ raw_gpio) & pin_mask;
+		bool active = gpioDebounceActive & pin_mask;
+		gpioDebounceActive &= ~pin_mask;
+
+		switch (options.debounceMode) {
+			case DEBOUNCE_MODE_DEFER:
+				{
+					// the new state has to hold for the whole delay, any glitch restarts the wait
+					if (!differs)
+						break;
+					if (!active)
+						gpioDebounceTime[pin] = now;
+					uint32_t delay = (raw_gpio & pin_mask) ? pressDelay : releaseDelay;
+					if ((now - gpioDebounceTime[pin]) >= delay) {
+						debounced ^= pin_mask;
+					} else {
+						gpioDebounceActive |= pin_mask;
+					}
+				}
+				break;
+			case DEBOUNCE_MODE_INTEGRATOR:
+				{
+					// time spent in the new state counts up, time spent back in the old state counts down
+					uint32_t elapsed = active ? (now - gpioDebounceTime[pin]) : 0;
+					if (!active)
+						gpioDebounceLevel[pin] = 0;
+					gpioDebounceTime[pin] = now;
+					if (differs) {
+						gpioDebounceLevel[pin] += elapsed;
+						uint32_t delay = (raw_gpio & pin_mask) ? pressDelay : releaseDelay;
+						if (gpioDebounceLevel[pin] >= delay) {
+							debounced ^= pin_mask;
+							gpioDebounceLevel[pin] = 0;
+						} else {
+							gpioDebounceActive |= pin_mask;
+						}
+					} else if (gpioDebounceLevel[pin] > elapsed) {
+						gpioDebounceLevel[pin] -= elapsed;
+						gpioDebounceActive |= pin_mask;
+					}
+				}
+				break;
+			case DEBOUNCE_MODE_EAGER:
+			default:
+				{
+					// accept the edge right away, then ignore the pin until the contacts have settled
+					uint32_t lockout = (debounced & pin_mask) ? pressDelay : releaseDelay;
+					if (active && (now - gpioDebounceTime[pin]) < lockout) {
+						gpioDebounceActive |= pin_mask;
+					} else if (differs) {
+						debounced ^= pin_mask;
+						gpioDebounceTime[pin] = now;
+						gpioDebounceActive |= pin_mask;
+					}
+				}
+				break;
 		}
 	}
+	gamepad->debouncedGpio = debounced;
 }
 
 void GP2040::run() {
 	bool configMode = DriverManager::getInstance().isConfigMode();
-	GPDriver * inputDriver = DriverManager::getInstance().getDriver();
-	Gamepad * gamepad = Storage::getInstance().GetGamepad();
-	Gamepad * processedGamepad = Storage::getInstance().GetProcessedGamepad();
-	GamepadState prevState;
+	bool sofSync = !configMode && Storage::getInstance().getGamepadOptions().usbSofSync;
+
+	// SOF has to reach the report scheduler through the class driver
+	if (sofSync) {
+		DriverManager::getInstance().getDriver()->set_sof_callback(USBReportScheduler::sofCallback);
+	}
 
 	// Start the TinyUSB Device functionality
 	tud_init(TUD_OPT_RHPORT);
 
+	// Align report generation to host polling
+	if (sofSync) {
+		USBReportScheduler::getInstance().start(TUD_OPT_RHPORT, DriverManager::getInstance().getDriver()->get_descriptor_configuration_cb(0));
+	}
+
 	// Initialize our USB manager
 	USBHostManager::getInstance().start();
 
@@ -296,59 +376,97 @@ void GP2040::run() {
 	}
 
 	while (1) { // LOOP
-		this->getReinitGamepad(gamepad);
+		this->runOnce();
+	}
+}
 
-		memcpy(&prevState, &gamepad->state, sizeof(GamepadState));
+/**
+ * @brief Perform a single iteration of the Core0 input loop.
+ *
+ * Everything that happens between sampling the GPIO and handing the report to the USB
+ * driver lives here so the per-iteration work can be driven and measured on its own,
+ * independent of the USB/RNDIS bring-up done by GP2040::run.
+ */
+void HOT_PATH_FUNC(GP2040::runOnce)() {
+	bool configMode = DriverManager::getInstance().isConfigMode();
+	GPDriver * inputDriver = DriverManager::getInstance().getDriver();
+	Gamepad * gamepad = Storage::getInstance().GetGamepad();
+	GamepadState prevState;
+	LoopStats & loopStats = LoopStats::getInstance();
+	USBReportScheduler & reportScheduler = USBReportScheduler::getInstance();
 
-		// Debounce
-		debounceGpioGetAll();
-		// Read Gamepad
-		gamepad->read();
+	// Hold off building the report until just before the host's next poll (always open unless SOF sync is enabled)
+	bool sendWindow = reportScheduler.waitForSendWindow();
 
-		checkRawState(prevState, gamepad->state);
+	uint32_t loopStart = LoopStats::now();
 
-		// Process USB Host on Core0
-		USBHostManager::getInstance().process();
+	this->getReinitGamepad(gamepad);
 
-		// Config Loop (Web-Config skips Core0 add-ons)
-		if (configMode == true) {
-			inputDriver->process(gamepad);
-			rebootHotkeys.process(gamepad, configMode);
-			checkSaveRebootState();
-			continue;
-		}
+	memcpy(&prevState, &gamepad->state, sizeof(GamepadState));
 
-		// Pre-Process add-ons for MPGS
-		addons.PreprocessAddons();
+	// Debounce
+	debounceGpioGetAll();
+	// Read Gamepad
+	gamepad->read();
+	uint32_t stageStart = loopStats.mark(LOOP_STAGE_INPUT, loopStart);
 
-		gamepad->hotkey(); 	// check for MPGS hotkeys
-		rebootHotkeys.process(gamepad, configMode);
+	checkRawState(prevState, gamepad->state);
 
-		gamepad->process(); // process through MPGS
+	// Process USB Host on Core0
+	USBHostManager::getInstance().process();
 
-		// (Post) Process for add-ons
-		addons.ProcessAddons();
+	// Config Loop (Web-Config skips Core0 add-ons)
+	if (configMode == true) {
+		inputDriver->process(gamepad);
+		rebootHotkeys.process(gamepad, configMode);
+		checkSaveRebootState();
+		checkFlashCommit(gamepad->state.buttons != prevState.buttons || gamepad->state.dpad != prevState.dpad);
+		loopStats.mark(LOOP_STAGE_TOTAL, loopStart);
+		return;
+	}
 
-		checkProcessedState(processedGamepad->state, gamepad->state);
+	// Pre-Process add-ons for MPGS
+	addons.PreprocessAddons();
+	stageStart = loopStats.mark(LOOP_STAGE_PREPROCESS, stageStart);
 
-		// Copy Processed Gamepad for Core1 (race condition otherwise)
-		memcpy(&processedGamepad->state, &gamepad->state, sizeof(GamepadState));
+	gamepad->hotkey(); 	// check for MPGS hotkeys
+	rebootHotkeys.process(gamepad, configMode);
 
-		// Process Input Driver
-		bool processed = inputDriver->process(gamepad);
+	gamepad->process(); // process through MPGS
 
-		// TinyUSB Task update
-		tud_task();
+	// (Post) Process for add-ons
+	addons.ProcessAddons();
+	stageStart = loopStats.mark(LOOP_STAGE_PROCESS, stageStart);
 
-		// Post-Process Add-ons with USB Report Processed Sent
-		addons.PostprocessAddons(processed);
+	checkProcessedState(processedState, gamepad->state);
+	bool inputChanged = gamepad->state.buttons != processedState.buttons || gamepad->state.dpad != processedState.dpad;
+	processedState = gamepad->state;
 
-		// Check if we have a pending save
-		checkSaveRebootState();
+	// Process Input Driver
+	bool processed = sendWindow && inputDriver->process(gamepad);
+	if (processed) {
+		reportScheduler.reportQueued();
 	}
+	stageStart = loopStats.mark(LOOP_STAGE_DRIVER, stageStart);
+
+	// TinyUSB Task update
+	tud_task();
+	stageStart = loopStats.mark(LOOP_STAGE_USB, stageStart);
+
+	// Hand the processed state (and any rumble/LED data from the driver) to Core1
+	Storage::getInstance().PublishProcessedGamepad(processedState);
+
+	// Post-Process Add-ons with USB Report Processed Sent
+	addons.PostprocessAddons(processed);
+	loopStats.mark(LOOP_STAGE_POSTPROCESS, stageStart);
+
+	// Check if we have a pending save
+	checkSaveRebootState();
+	checkFlashCommit(inputChanged);
+	loopStats.mark(LOOP_STAGE_TOTAL, loopStart);
 }
 
-void GP2040::getReinitGamepad(Gamepad * gamepad) {
+void HOT_PATH_FUNC(GP2040::getReinitGamepad)(Gamepad * gamepad) {
 	GamepadOptions& gamepadOptions = Storage::getInstance().getGamepadOptions();
 
 	// Check if profile has changed since last reinit
@@ -407,8 +525,10 @@ GP2040::BootAction GP2040::getBootAction() {
 				// Process for add-ons
 				addons.ProcessAddons();
 
-				// Copy Processed Gamepad for Core1 (race condition otherwise)
+				// Core1 isn't running yet, so the processed gamepad can be written directly
 				memcpy(&processedGamepad->state, &gamepad->state, sizeof(GamepadState));
+				processedState = gamepad->state;
+				Storage::getInstance().PublishProcessedGamepad(processedState);
 
                 const ForcedSetupOptions& forcedSetupOptions = Storage::getInstance().getForcedSetupOptions();
                 bool modeSwitchLocked = forcedSetupOptions.mode == FORCED_SETUP_MODE_LOCK_MODE_SWITCH ||
@@ -517,14 +637,15 @@ void GP2040::RebootHotkeys::process(Gamepad* gamepad, bool configMode) {
 	}
 }
 
-void GP2040::checkRawState(GamepadState prevState, GamepadState currState) {
+void HOT_PATH_FUNC(GP2040::checkRawState)(const GamepadState& prevState, const GamepadState& currState) {
     // buttons pressed
     if (
         ((currState.aux & ~prevState.aux) != 0) ||
         ((currState.dpad & ~prevState.dpad) != 0) ||
         ((currState.buttons & ~prevState.buttons) != 0)
     ) {
-        EventManager::getInstance().triggerEvent(new GPButtonDownEvent((currState.dpad & ~prevState.dpad), (currState.buttons & ~prevState.buttons), (currState.aux & ~prevState.aux)));
+        GPButtonDownEvent event((currState.dpad & ~prevState.dpad), (currState.buttons & ~prevState.buttons), (currState.aux & ~prevState.aux));
+        EventManager::getInstance().triggerEvent(event);
     }
 
     // buttons released
@@ -533,18 +654,20 @@ void GP2040::checkRawState(GamepadState prevState, GamepadState currState) {
         ((prevState.dpad & ~currState.dpad) != 0) ||
         ((prevState.buttons & ~currState.buttons) != 0)
     ) {
-        EventManager::getInstance().triggerEvent(new GPButtonUpEvent((prevState.dpad & ~currState.dpad), (prevState.buttons & ~currState.buttons), (prevState.aux & ~currState.aux)));
+        GPButtonUpEvent event((prevState.dpad & ~currState.dpad), (prevState.buttons & ~currState.buttons), (prevState.aux & ~currState.aux));
+        EventManager::getInstance().triggerEvent(event);
     }
 }
 
-void GP2040::checkProcessedState(GamepadState prevState, GamepadState currState) {
+void HOT_PATH_FUNC(GP2040::checkProcessedState)(const GamepadState& prevState, const GamepadState& currState) {
     // buttons pressed
     if (
         ((currState.aux & ~prevState.aux) != 0) ||
         ((currState.dpad & ~prevState.dpad) != 0) ||
         ((currState.buttons & ~prevState.buttons) != 0)
     ) {
-        EventManager::getInstance().triggerEvent(new GPButtonProcessedDownEvent((currState.dpad & ~prevState.dpad), (currState.buttons & ~prevState.buttons), (currState.aux & ~prevState.aux)));
+        GPButtonProcessedDownEvent event((currState.dpad & ~prevState.dpad), (currState.buttons & ~prevState.buttons), (currState.aux & ~prevState.aux));
+        EventManager::getInstance().triggerEvent(event);
     }
 
     // buttons released
@@ -553,7 +676,8 @@ void GP2040::checkProcessedState(GamepadState prevState, GamepadState currState)
         ((prevState.dpad & ~currState.dpad) != 0) ||
         ((prevState.buttons & ~currState.buttons) != 0)
     ) {
-        EventManager::getInstance().triggerEvent(new GPButtonProcessedUpEvent((prevState.dpad & ~currState.dpad), (prevState.buttons & ~currState.buttons), (prevState.aux & ~currState.aux)));
+        GPButtonProcessedUpEvent event((prevState.dpad & ~currState.dpad), (prevState.buttons & ~currState.buttons), (prevState.aux & ~currState.aux));
+        EventManager::getInstance().triggerEvent(event);
     }
 
     if (
@@ -564,14 +688,18 @@ void GP2040::checkProcessedState(GamepadState prevState, GamepadState currState)
         (currState.lt != prevState.lt) ||
         (currState.rt != prevState.rt)
     ) {
-        EventManager::getInstance().triggerEvent(new GPAnalogProcessedMoveEvent(currState.lx, currState.ly, currState.rx, currState.ry, currState.lt, currState.rt));
+        GPAnalogProcessedMoveEvent event(currState.lx, currState.ly, currState.rx, currState.ry, currState.lt, currState.rt);
+        EventManager::getInstance().triggerEvent(event);
     }
 }
 
 void GP2040::checkSaveRebootState() {
 	if (saveRequested) {
 		saveRequested = false;
-		Storage::getInstance().save(forceSave);
+		if (saveHotOptionsOnly)
+			Storage::getInstance().saveHotOptions(forceSave);
+		else
+			Storage::getInstance().save(forceSave);
 	}
 
 	if (rebootRequested) {
@@ -584,7 +712,34 @@ void GP2040::checkSaveRebootState() {
 	}
 }
 
+/**
+ * @brief Write a queued config commit once nobody is playing.
+ *
+ * The write locks out Core1 and stalls this loop for the erase/program, so it waits until the
+ * buttons have been left alone for EEPROM_IDLE_WAIT and the host has picked up the last report.
+ * Analog inputs are ignored, they rarely sit perfectly still. Reboots flush regardless.
+ */
+void GP2040::checkFlashCommit(bool inputChanged) {
+	uint32_t now = to_ms_since_boot(get_absolute_time());
+	if (inputChanged)
+		lastInputChange = now;
+
+	if (!EEPROM.isPending())
+		return;
+
+	FlashCommitStats stats = EEPROM.getStats();
+	if ((now - stats.lastRequest) < EEPROM_WRITE_WAIT || (now - lastInputChange) < EEPROM_IDLE_WAIT)
+		return;
+
+	if (USBReportScheduler::getInstance().isReportPending())
+		return;
+
+	EEPROM.flush();
+}
+
 void GP2040::handleStorageSave(GPEvent* e) {
+	// Any other save still pending needs the full config written
+	saveHotOptionsOnly = ((GPStorageSaveEvent*)e)->hotOptionsOnly && (!saveRequested || saveHotOptionsOnly);
 	saveRequested = true;
 	forceSave = ((GPStorageSaveEvent*)e)->forceSave;
 	rebootRequested = ((GPStorageSaveEvent*)e)->restartAfterSave;
@@ -5,6 +5,7 @@
 #include "drivermanager.h"
 #include "storagemanager.h"
 #include "usbhostmanager.h"
+#include "loopstats.h"
 
 #include "addons/board_led.h"  // Add-Ons
 #include "addons/buzzerspeaker.h"
@@ -51,7 +52,13 @@ void GP2040Aux::setup() {
 }
 
 void GP2040Aux::run() {
+        LoopStats & loopStats = LoopStats::getInstance();
         while (1) {
+                uint32_t loopStart = LoopStats::now();
+
+                // Take a consistent copy of the processed gamepad published by Core0
+                Storage::getInstance().SyncProcessedGamepad();
+
                 // Pre, Process, and Post
                 addons.PreprocessAddons();
 
@@ -61,5 +68,7 @@ void GP2040Aux::run() {
                 }
 
                 addons.ProcessAddons();
+
+                loopStats.mark(LOOP_STAGE_CORE1, loopStart);
         }
 }
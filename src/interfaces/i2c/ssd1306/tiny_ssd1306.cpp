@@ -1,5 +1,68 @@
 #include "tiny_ssd1306.h"
 
+// Shapes are rasterized with integer math only: angles are binary (ANGLE_STEPS per turn)
+// and sin/cos come from a quarter wave table in Q14 fixed point
+#define ANGLE_STEPS 1024
+#define TRIG_SHIFT 14
+
+// Line segments used to approximate each round end of a pill
+#define PILL_CAP_SEGMENTS 16
+
+static const int16_t QUARTER_SINE[ANGLE_STEPS / 4 + 1] = {
+    0, 101, 201, 302, 402, 503, 603, 704, 804, 904, 1005, 1105, 1205, 1306, 1406, 1506,
+    1606, 1706, 1806, 1906, 2006, 2105, 2205, 2305, 2404, 2503, 2603, 2702, 2801, 2900, 2999, 3098,
+    3196, 3295, 3393, 3492, 3590, 3688, 3786, 3883, 3981, 4078, 4176, 4273, 4370, 4467, 4563, 4660,
+    4756, 4852, 4948, 5044, 5139, 5235, 5330, 5425, 5520, 5614, 5708, 5803, 5897, 5990, 6084, 6177,
+    6270, 6363, 6455, 6547, 6639, 6731, 6823, 6914, 7005, 7096, 7186, 7276, 7366, 7456, 7545, 7635,
+    7723, 7812, 7900, 7988, 8076, 8163, 8250, 8337, 8423, 8509, 8595, 8680, 8765, 8850, 8935, 9019,
+    9102, 9186, 9269, 9352, 9434, 9516, 9598, 9679, 9760, 9841, 9921, 10001, 10080, 10159, 10238, 10316,
+    10394, 10471, 10549, 10625, 10702, 10778, 10853, 10928, 11003, 11077, 11151, 11224, 11297, 11370, 11442, 11514,
+    11585, 11656, 11727, 11797, 11866, 11935, 12004, 12072, 12140, 12207, 12274, 12340, 12406, 12472, 12537, 12601,
+    12665, 12729, 12792, 12854, 12916, 12978, 13039, 13100, 13160, 13219, 13279, 13337, 13395, 13453, 13510, 13567,
+    13623, 13678, 13733, 13788, 13842, 13896, 13949, 14001, 14053, 14104, 14155, 14206, 14256, 14305, 14354, 14402,
+    14449, 14497, 14543, 14589, 14635, 14680, 14724, 14768, 14811, 14854, 14896, 14937, 14978, 15019, 15059, 15098,
+    15137, 15175, 15213, 15250, 15286, 15322, 15357, 15392, 15426, 15460, 15493, 15525, 15557, 15588, 15619, 15649,
+    15679, 15707, 15736, 15763, 15791, 15817, 15843, 15868, 15893, 15917, 15941, 15964, 15986, 16008, 16029, 16049,
+    16069, 16088, 16107, 16125, 16143, 16160, 16176, 16192, 16207, 16221, 16235, 16248, 16261, 16273, 16284, 16295,
+    16305, 16315, 16324, 16332, 16340, 16347, 16353, 16359, 16364, 16369, 16373, 16376, 16379, 16381, 16383, 16384,
+    16384
+};
+
+static int32_t fixedSin(int32_t angle) {
+    angle &= (ANGLE_STEPS - 1);
+    if (angle <= ANGLE_STEPS / 4) return QUARTER_SINE[angle];
+    if (angle <= ANGLE_STEPS / 2) return QUARTER_SINE[ANGLE_STEPS / 2 - angle];
+    if (angle <= ANGLE_STEPS * 3 / 4) return -QUARTER_SINE[angle - ANGLE_STEPS / 2];
+    return -QUARTER_SINE[ANGLE_STEPS - angle];
+}
+
+static int32_t fixedCos(int32_t angle) {
+    return fixedSin(angle + ANGLE_STEPS / 4);
+}
+
+// Round a fixed point value with `shift` fractional bits to the nearest integer
+static int32_t fixedRound(int32_t value, uint8_t shift) {
+    return (value + (1 << (shift - 1))) >> shift;
+}
+
+// The drawing API takes angles as doubles, convert them once per shape
+static int32_t degreesToAngle(double degrees) {
+    return (int32_t)(degrees * (ANGLE_STEPS / 360.0) + (degrees < 0 ? -0.5 : 0.5));
+}
+
+static int32_t radiansToAngle(double radians) {
+    return (int32_t)(radians * (ANGLE_STEPS / (2 * M_PI)) + (radians < 0 ? -0.5 : 0.5));
+}
+
+// Whether the offset (px, py) lies within `sweep` of the start direction, going towards the end direction
+static bool inSector(int32_t px, int32_t py, int32_t startX, int32_t startY, int32_t endX, int32_t endY, int32_t sweep) {
+    if (sweep >= ANGLE_STEPS) return true;
+
+    bool afterStart = (startX * py - startY * px) >= 0;
+    bool beforeEnd = (px * endY - py * endX) >= 0;
+    return (sweep <= ANGLE_STEPS / 2) ? (afterStart && beforeEnd) : (afterStart || beforeEnd);
+}
+
 void GPGFX_TinySSD1306::init(GPGFX_DisplayTypeOptions options) {
     _options.displayType = options.displayType;
     _options.i2c = options.i2c;
@@ -63,6 +126,7 @@ void GPGFX_TinySSD1306::init(GPGFX_DisplayTypeOptions options) {
     sendCommands(commands, sizeof(commands));
 
     clear();
+    invalidate();
     drawBuffer(NULL);
 }
 
@@ -114,6 +178,35 @@ void GPGFX_TinySSD1306::clear() {
 	memset(frameBuffer, 0, MAX_SCREEN_SIZE);
 }
 
+void GPGFX_TinySSD1306::clearRegion(GPGFX_Rect region) {
+    int16_t left = MAX(region.left, 0);
+    int16_t right = MIN(region.right, MAX_SCREEN_WIDTH - 1);
+    int16_t top = MAX(region.top, 0);
+    int16_t bottom = MIN(region.bottom, MAX_SCREEN_HEIGHT - 1);
+    if ((left > right) || (top > bottom)) return;
+
+    if (this->screenType == ScreenAlternatives::SCREEN_132x64) {
+        left += 2;
+        right = MIN(right + 2, MAX_SCREEN_WIDTH - 1);
+    }
+
+    for (int16_t page = top / 8; page <= bottom / 8; page++) {
+        uint8_t mask = 0xFF;
+        if (page == top / 8) mask &= (0xFF << (top % 8));
+        if (page == bottom / 8) mask &= (0xFF >> (7 - (bottom % 8)));
+
+        uint8_t* column = &frameBuffer[page * MAX_SCREEN_WIDTH];
+        for (int16_t x = left; x <= right; x++) {
+            column[x] &= ~mask;
+        }
+    }
+}
+
+void GPGFX_TinySSD1306::invalidate() {
+	panelPages = 0;
+	framePage = 0;
+}
+
 uint32_t GPGFX_TinySSD1306::getPixel(uint8_t x, uint8_t y) {
 	uint16_t row, bitIndex;
     uint32_t result = 0;
@@ -127,7 +220,7 @@ uint32_t GPGFX_TinySSD1306::getPixel(uint8_t x, uint8_t y) {
 		row=((y/8)*MAX_SCREEN_WIDTH)+x;
 		bitIndex=y % 8;
 
-        result = (frameBuffer[row] >> bitIndex) && 0x01;
+        result = (frameBuffer[row] >> bitIndex) & 0x01;
 	}
 
     return result;
@@ -138,6 +231,13 @@ void GPGFX_TinySSD1306::drawPixel(uint8_t x, uint8_t y, uint32_t color) {
 
 	if ((x<MAX_SCREEN_WIDTH) and (y<MAX_SCREEN_HEIGHT))
 	{
+        if (x < bounds.left) bounds.left = x;
+        if (x > bounds.right) bounds.right = x;
+        if (y < bounds.top) bounds.top = y;
+        if (y > bounds.bottom) bounds.bottom = y;
+
+        if (clipEnabled && ((x < clip.left) || (x > clip.right) || (y < clip.top) || (y > clip.bottom))) return;
+
         if (this->screenType == ScreenAlternatives::SCREEN_132x64) {
             x+=2;
         }
@@ -213,49 +313,83 @@ void GPGFX_TinySSD1306::drawLine(uint16_t x1, uint16_t y1, uint16_t x2, uint16_t
 }
 
 void GPGFX_TinySSD1306::drawArc(uint16_t x, uint16_t y, uint32_t radiusX, uint32_t radiusY, uint32_t color, uint8_t filled, double startAngle, double endAngle, uint8_t closed) {
-    // Convert degrees to radians
-    startAngle = startAngle * M_PI / 180.0;
-    endAngle = endAngle * M_PI / 180.0;
+    int32_t rx = MIN(radiusX, MAX_SCREEN_WIDTH);
+    int32_t ry = MIN(radiusY, MAX_SCREEN_WIDTH);
+
+    int32_t start = degreesToAngle(startAngle);
+    int32_t sweep = degreesToAngle(endAngle) - start;
+
+    int32_t startX = fixedCos(start);
+    int32_t startY = fixedSin(start);
+    int32_t endX = fixedCos(start + sweep);
+    int32_t endY = fixedSin(start + sweep);
+
+    int32_t startPosX = x + fixedRound(rx * startX, TRIG_SHIFT);
+    int32_t startPosY = y + fixedRound(ry * startY, TRIG_SHIFT);
+    int32_t endPosX = x + fixedRound(rx * endX, TRIG_SHIFT);
+    int32_t endPosY = y + fixedRound(ry * endY, TRIG_SHIFT);
+
+    if (sweep > 0) {
+        // Offsets are scaled by the other radius so the sector test works on the circle the ellipse was stretched from
+        const auto plotArcPixel = [&](int32_t dx, int32_t dy) -> void {
+            if (inSector(dx * ry, dy * rx, startX, startY, endX, endY, sweep)) {
+                drawPixel(x + dx, y + dy, color);
+            }
+        };
+
+        // Midpoint ellipse, same stepping as drawEllipse
+        int32_t x1 = -rx, y1 = 0;
+        int32_t e2 = ry, dx = (1 + 2 * x1) * e2 * e2;
+        int32_t dy = x1 * x1, err = dx + dy;
+
+        while (x1 <= 0) {
+            plotArcPixel(-x1, y1);
+            plotArcPixel(x1, y1);
+            plotArcPixel(x1, -y1);
+            plotArcPixel(-x1, -y1);
+
+            e2 = 2 * err;
+            if (e2 >= dx) {
+                x1++;
+                err += dx += 2 * ry * ry;
+            }
+            if (e2 <= dy) {
+                y1++;
+                err += dy += 2 * rx * rx;
+            }
+        }
 
-    // Angle step based on the resolution you want
-    double angleStep = 0.01; // Adjust as needed for smoother arcs
+        while (y1++ < ry) {
+            plotArcPixel(0, y1);
+            plotArcPixel(0, -y1);
+        }
 
-    for (double angle = startAngle; angle < endAngle; angle += angleStep) {
-        int xPos = x + static_cast<int>(radiusX * cos(angle));
-        int yPos = y + static_cast<int>(radiusY * sin(angle));
-        drawPixel(xPos, yPos, color);
+        if (filled) {
+            int32_t limit = rx * rx * ry * ry;
+            for (int32_t row = -ry; row <= ry; row++) {
+                int32_t rowWeight = row * row * rx * rx;
+                for (int32_t col = -rx; col <= rx; col++) {
+                    if (col * col * ry * ry + rowWeight <= limit) {
+                        plotArcPixel(col, row);
+                    }
+                }
+            }
+        }
     }
 
-    // Draw the last point
-    int xPos = x + static_cast<int>(radiusX * cos(endAngle));
-    int yPos = y + static_cast<int>(radiusY * sin(endAngle));
-    drawPixel(xPos, yPos, color);
+    // Draw the first and last points, the outline pixel nearest either one may fall just outside the sector
+    drawPixel(startPosX, startPosY, color);
+    drawPixel(endPosX, endPosY, color);
 
     if (closed) {
-        drawLine(x, y, (x + static_cast<int>(radiusX * cos(startAngle))), (y + static_cast<int>(radiusY * sin(startAngle))), color, filled);
-        drawLine(x, y, (x + static_cast<int>(radiusX * cos(endAngle))), (y + static_cast<int>(radiusY * sin(endAngle))), color, filled);
-    }
-
-    // If filled is true, fill the arc
-    if (filled) {
-        // Draw lines to fill the arc
-        for (double angle = startAngle; angle <= endAngle; angle += angleStep) {
-            int xPosStart = x;
-            int yPosStart = y;
-            int xPosEnd = x + static_cast<int>(radiusX * cos(angle));
-            int yPosEnd = y + static_cast<int>(radiusY * sin(angle));
-            // Draw line from center to arc point
-            // You may replace this with your actual line drawing function
-            //drawPixel(xPosStart, yPosStart, color);
-            //drawPixel(xPosEnd, yPosEnd, color);
-            drawLine(xPosStart, yPosStart, xPosEnd, yPosEnd, color, filled);
-        }
+        drawLine(x, y, startPosX, startPosY, color, filled);
+        drawLine(x, y, endPosX, endPosY, color, filled);
     }
 }
 
 void GPGFX_TinySSD1306::drawEllipse(uint16_t x, uint16_t y, uint32_t radiusX, uint32_t radiusY, uint32_t color, uint8_t filled) {
     //printf("Ellipse %d, %d, %d, %d, %d, %d\n", x, y, radiusX, radiusY, color, filled);
-	long x1 = -radiusX, y1 = 0;
+	long x1 = -(long)radiusX, y1 = 0;
 	long e2 = radiusY, dx = (1 + 2 * x1) * e2 * e2;
 	long dy = x1 * x1, err = dx + dy;
 	long diff = 0;
@@ -296,226 +430,160 @@ void GPGFX_TinySSD1306::drawEllipse(uint16_t x, uint16_t y, uint32_t radiusX, ui
 }
 
 void GPGFX_TinySSD1306::drawRectangle(uint16_t x, uint16_t y, uint16_t width, uint16_t height, uint32_t color, uint8_t filled, double rotationAngle) {
-    // Calculate center point of the rectangle
-    double centerX = (x + width) / 2.0;
-    double centerY = (y + height) / 2.0;
-
-    // Calculate half width and half height for easier calculations
-    double halfWidth = (width - x) / 2.0;
-    double halfHeight = (height - y) / 2.0;
-
-    // Convert rotation angle to radians
-    double angleRad = rotationAngle * M_PI / 180.0;
-
-    // Pre-calculate sine and cosine of the rotation angle
-    double cosA = cos(angleRad);
-    double sinA = sin(angleRad);
-
-    // Calculate rotated coordinates for each corner of the rectangle
-    double x0 = centerX + cosA * (-halfWidth) - sinA * (-halfHeight);
-    double y0 = centerY + sinA * (-halfWidth) + cosA * (-halfHeight);
-
-    double x1 = centerX + cosA * (halfWidth) - sinA * (-halfHeight);
-    double y1 = centerY + sinA * (halfWidth) + cosA * (-halfHeight);
-
-    double x2 = centerX + cosA * (halfWidth) - sinA * (halfHeight);
-    double y2 = centerY + sinA * (halfWidth) + cosA * (halfHeight);
-
-    double x3 = centerX + cosA * (-halfWidth) - sinA * (halfHeight);
-    double y3 = centerY + sinA * (-halfWidth) + cosA * (halfHeight);
-
-    // Round coordinates to nearest integer
-    uint16_t x0_rounded = (uint16_t)round(x0);
-    uint16_t y0_rounded = (uint16_t)round(y0);
-    uint16_t x1_rounded = (uint16_t)round(x1);
-    uint16_t y1_rounded = (uint16_t)round(y1);
-    uint16_t x2_rounded = (uint16_t)round(x2);
-    uint16_t y2_rounded = (uint16_t)round(y2);
-    uint16_t x3_rounded = (uint16_t)round(x3);
-    uint16_t y3_rounded = (uint16_t)round(y3);
-
-    // Draw lines between rotated coordinates
-    drawLine(x0_rounded, y0_rounded, x1_rounded, y1_rounded, color, filled);
-    drawLine(x1_rounded, y1_rounded, x2_rounded, y2_rounded, color, filled);
-    drawLine(x2_rounded, y2_rounded, x3_rounded, y3_rounded, color, filled);
-    drawLine(x3_rounded, y3_rounded, x0_rounded, y0_rounded, color, filled);
-
-	if (filled) {
-        // Calculate the number of lines needed for the filling
-        uint16_t numLines = (uint16_t)round(sqrt(halfWidth * halfWidth + halfHeight * halfHeight) * 2);
-
-        for (uint16_t i = 0; i <= numLines; i++) {
-            double t = (double)i / numLines;
-            double xStart = (1 - t) * x0 + t * x3;
-            double yStart = (1 - t) * y0 + t * y3;
-            double xEnd = (1 - t) * x1 + t * x2;
-            double yEnd = (1 - t) * y1 + t * y2;
-
-            drawLine((uint16_t)round(xStart), (uint16_t)round(yStart), (uint16_t)round(xEnd), (uint16_t)round(yEnd), color, filled);
+    int32_t angle = degreesToAngle(rotationAngle);
+
+    // Unrotated rectangles (nearly all of them) have their corners exactly at (x, y) and (width, height)
+    if ((angle & (ANGLE_STEPS - 1)) == 0) {
+        drawLine(x, y, width, y, color, filled);
+        drawLine(width, y, width, height, color, filled);
+        drawLine(width, height, x, height, color, filled);
+        drawLine(x, height, x, y, color, filled);
+
+        if (filled) {
+            for (int16_t row = MIN(y, height); row <= MAX(y, height); row++) {
+                drawHorizontalLine(x, width, row, color);
+            }
         }
-	}
+        return;
+    }
+
+    int32_t cosA = fixedCos(angle);
+    int32_t sinA = fixedSin(angle);
+
+    // Work in half pixels so the center of an even sized rectangle stays exact
+    int32_t centerX = x + width;
+    int32_t centerY = y + height;
+    int32_t halfWidth = width - x;
+    int32_t halfHeight = height - y;
+
+    static const int8_t cornerSigns[4][2] = {{-1, -1}, {1, -1}, {1, 1}, {-1, 1}};
+    int16_t xCorners[4];
+    int16_t yCorners[4];
+    for (uint8_t i = 0; i < 4; i++) {
+        int32_t offsetX = cornerSigns[i][0] * halfWidth;
+        int32_t offsetY = cornerSigns[i][1] * halfHeight;
+        xCorners[i] = fixedRound((centerX << TRIG_SHIFT) + cosA * offsetX - sinA * offsetY, TRIG_SHIFT + 1);
+        yCorners[i] = fixedRound((centerY << TRIG_SHIFT) + sinA * offsetX + cosA * offsetY, TRIG_SHIFT + 1);
+    }
+
+    for (uint8_t i = 0; i < 4; i++) {
+        uint8_t next = (i + 1) % 4;
+        drawLine(xCorners[i], yCorners[i], xCorners[next], yCorners[next], color, filled);
+    }
+
+    if (filled) {
+        fillPolygon(xCorners, yCorners, 4, color);
+    }
 }
 
 void GPGFX_TinySSD1306::drawPolygon(uint16_t x, uint16_t y, uint16_t radius, uint16_t sides, uint32_t color, uint8_t filled, double rotation) {
-    // Calculate the angle increment between each vertex
-    double angleIncrement = 2 * M_PI / sides;
+    if (sides == 0) return;
+
+    int32_t rotationAngle = radiansToAngle(rotation);
 
     // Calculate vertices
-    uint16_t xVertices[sides];
-    uint16_t yVertices[sides];
-    for (int i = 0; i < sides; i++) {
-        double angle = i * angleIncrement + rotation;
-        xVertices[i] = x + round(radius * cos(angle));
-        yVertices[i] = y + round(radius * sin(angle));
+    int16_t xVertices[sides];
+    int16_t yVertices[sides];
+    for (uint16_t i = 0; i < sides; i++) {
+        int32_t angle = rotationAngle + ((int32_t)i * ANGLE_STEPS + sides / 2) / sides;
+        xVertices[i] = x + fixedRound(radius * fixedCos(angle), TRIG_SHIFT);
+        yVertices[i] = y + fixedRound(radius * fixedSin(angle), TRIG_SHIFT);
     }
 
     // Draw lines between vertices
-    for (int i = 0; i < sides - 1; i++) {
-        drawLine(xVertices[i], yVertices[i], xVertices[i + 1], yVertices[i + 1], color, false);
+    for (uint16_t i = 0; i < sides; i++) {
+        uint16_t next = (i + 1) % sides;
+        drawLine(xVertices[i], yVertices[i], xVertices[next], yVertices[next], color, false);
     }
-    drawLine(xVertices[sides - 1], yVertices[sides - 1], xVertices[0], yVertices[0], color, false);
 
     if (filled) {
-        // Find the minimum and maximum y coordinates to scan
-        uint16_t minY = yVertices[0], maxY = yVertices[0];
-        for (int i = 1; i < sides; i++) {
-            if (yVertices[i] < minY) minY = yVertices[i];
-            if (yVertices[i] > maxY) maxY = yVertices[i];
-        }
-
-        // Scan horizontally and draw lines between intersections
-        for (int scanY = minY + 1; scanY < maxY; scanY++) {
-            int intersections = 0;
-            double intersectPoints[sides];
-
-            for (int i = 0; i < sides; i++) {
-                int next = (i + 1) % sides;
-                if ((yVertices[i] < scanY && yVertices[next] >= scanY) || (yVertices[next] < scanY && yVertices[i] >= scanY)) {
-                    intersectPoints[intersections++] = xVertices[i] + (scanY - yVertices[i]) * (xVertices[next] - xVertices[i]) / (yVertices[next] - yVertices[i]);
-                }
-            }
-
-            // Sort the intersection points by x coordinate
-            for (int i = 0; i < intersections - 1; i++) {
-                for (int j = 0; j < intersections - i - 1; j++) {
-                    if (intersectPoints[j] > intersectPoints[j + 1]) {
-                        double temp = intersectPoints[j];
-                        intersectPoints[j] = intersectPoints[j + 1];
-                        intersectPoints[j + 1] = temp;
-                    }
-                }
-            }
-
-            // Draw lines between pairs of intersection points
-            for (int i = 0; i < intersections; i += 2) {
-                drawLine(intersectPoints[i], scanY, intersectPoints[i + 1], scanY, color, false);
-            }
-        }
+        fillPolygon(xVertices, yVertices, sides, color);
     }
 }
 
 void GPGFX_TinySSD1306::drawPill(uint16_t x, uint16_t y, uint16_t width, uint16_t height, uint32_t color, uint8_t filled, double rotationAngle) {
     bool horizontal = (width - x) >= (height - y);
 
-    // Center of the rectangle
-    double centerX = (x + width) / 2.0;
-    double centerY = (y + height) / 2.0;
-
-    // Half dimensions
-    double halfWidth  = (width - x) / 2.0;
-    double halfHeight = (height - y) / 2.0;
-
-    // Pill radius = half of the short axis
-    double radius = horizontal ? halfHeight : halfWidth;
-
-    // Rectangle half-lengths along long and short axes
-    double rectHalfLong  = (horizontal ? halfWidth : halfHeight) - radius;
-    double rectHalfShort = horizontal ? halfHeight : halfWidth;
-
-    // Rotation
-    double angleRad = rotationAngle * M_PI / 180.0;
-    double cosA = cos(angleRad);
-    double sinA = sin(angleRad);
-
-    // Long and short axis vectors
-    double longX = horizontal ? 1.0 : 0.0;
-    double longY = horizontal ? 0.0 : 1.0;
-    double shortX = -longY; // perpendicular to long axis
-    double shortY = longX;
-
-    // Rectangle corners
-    double corners[4][2] = {
-        {-rectHalfLong * longX - rectHalfShort * shortX, -rectHalfLong * longY - rectHalfShort * shortY},
-        { rectHalfLong * longX - rectHalfShort * shortX,  rectHalfLong * longY - rectHalfShort * shortY},
-        { rectHalfLong * longX + rectHalfShort * shortX,  rectHalfLong * longY + rectHalfShort * shortY},
-        {-rectHalfLong * longX + rectHalfShort * shortX, -rectHalfLong * longY + rectHalfShort * shortY}
-    };
-
-    // Rotate rectangle corners
-    uint16_t rx[4], ry[4];
-    for(int i=0; i<4; i++){
-        double xr = centerX + cosA * corners[i][0] - sinA * corners[i][1];
-        double yr = centerY + sinA * corners[i][0] + cosA * corners[i][1];
-        rx[i] = (uint16_t)round(xr);
-        ry[i] = (uint16_t)round(yr);
+    // Half pixel units, as in drawRectangle
+    int32_t centerX = x + width;
+    int32_t centerY = y + height;
+    int32_t radius = horizontal ? (height - y) : (width - x);
+    int32_t rectHalfLong = (horizontal ? (width - x) : (height - y)) - radius;
+
+    // Direction of the long axis, each round end is a half turn centered on it
+    int32_t direction = degreesToAngle(rotationAngle) + (horizontal ? 0 : ANGLE_STEPS / 4);
+    int32_t longX = fixedCos(direction);
+    int32_t longY = fixedSin(direction);
+
+    int16_t xVertices[2 * (PILL_CAP_SEGMENTS + 1)];
+    int16_t yVertices[2 * (PILL_CAP_SEGMENTS + 1)];
+    uint8_t count = 0;
+    for (int8_t side = 1; side >= -1; side -= 2) {
+        int32_t capX = (centerX << TRIG_SHIFT) + side * rectHalfLong * longX;
+        int32_t capY = (centerY << TRIG_SHIFT) + side * rectHalfLong * longY;
+        int32_t capStart = direction - ANGLE_STEPS / 4 + (side < 0 ? ANGLE_STEPS / 2 : 0);
+
+        for (uint8_t i = 0; i <= PILL_CAP_SEGMENTS; i++) {
+            int32_t angle = capStart + (i * ANGLE_STEPS / 2) / PILL_CAP_SEGMENTS;
+            xVertices[count] = fixedRound(capX + radius * fixedCos(angle), TRIG_SHIFT + 1);
+            yVertices[count] = fixedRound(capY + radius * fixedSin(angle), TRIG_SHIFT + 1);
+            count++;
+        }
     }
 
-    drawLine(rx[0], ry[0], rx[1], ry[1], color, filled); // top
-    drawLine(rx[2], ry[2], rx[3], ry[3], color, filled); // bottom
+    for (uint8_t i = 0; i < count; i++) {
+        uint8_t next = (i + 1) % count;
+        drawLine(xVertices[i], yVertices[i], xVertices[next], yVertices[next], color, filled);
+    }
 
     if (filled) {
-        double longVecX = cosA * longX - sinA * longY;
-        double longVecY = sinA * longX + cosA * longY;
-        double shortVecX = cosA * shortX - sinA * shortY;
-        double shortVecY = sinA * shortX + cosA * shortY;
-
-        int steps = (int)ceil(2.0 * rectHalfLong * 8.0);
-        if (steps < 1) steps = 1;
-
-        double shortExtra = 0.5;
-
-        for (int k = -steps; k <= steps; k++) {
-            double t = (double)k / steps;
-
-            double baseX = centerX + t * rectHalfLong * longVecX;
-            double baseY = centerY + t * rectHalfLong * longVecY;
-
-            double sx = rectHalfShort * shortVecX + shortExtra * (shortVecX >= 0 ? 1 : -1);
-            double sy = rectHalfShort * shortVecY + shortExtra * (shortVecY >= 0 ? 1 : -1);
-
-            drawLine((uint16_t)round(baseX - sx), (uint16_t)round(baseY - sy), (uint16_t)round(baseX + sx), (uint16_t)round(baseY + sy), color, 1);
-        }
+        fillPolygon(xVertices, yVertices, count, color);
     }
+}
 
-    int steps = 32;
-    for(int side=-1; side<=1; side+=2){
-        double cx = side * rectHalfLong * longX;
-        double cy = side * rectHalfLong * longY;
+void GPGFX_TinySSD1306::drawHorizontalLine(int16_t x1, int16_t x2, int16_t y, uint32_t color) {
+    if ((y < 0) || (y >= MAX_SCREEN_HEIGHT)) return;
 
-        double prevX = 0, prevY = 0;
-        for(int i=0; i<=steps; i++){
-            double t = (double)i / steps;
-            double theta = -M_PI/2 + t * M_PI;
-            if(side == -1) theta = M_PI/2 + t * M_PI;
+    int16_t left = MAX(MIN(x1, x2), 0);
+    int16_t right = MIN(MAX(x1, x2), MAX_SCREEN_WIDTH - 1);
+    for (int16_t col = left; col <= right; col++) {
+        drawPixel(col, y, color);
+    }
+}
 
-            double thetaOffset = horizontal ? -M_PI/2 : M_PI/2;
-            double arcLocalX = cx + radius * cos(theta + thetaOffset) * shortX + radius * sin(theta + thetaOffset) * longX;
-            double arcLocalY = cy + radius * cos(theta + thetaOffset) * shortY + radius * sin(theta + thetaOffset) * longY;
+void GPGFX_TinySSD1306::fillPolygon(const int16_t* xVertices, const int16_t* yVertices, uint16_t count, uint32_t color) {
+    // Find the minimum and maximum y coordinates to scan
+    int16_t minY = yVertices[0], maxY = yVertices[0];
+    for (uint16_t i = 1; i < count; i++) {
+        if (yVertices[i] < minY) minY = yVertices[i];
+        if (yVertices[i] > maxY) maxY = yVertices[i];
+    }
 
-            double rotatedX = centerX + cosA * arcLocalX - sinA * arcLocalY;
-            double rotatedY = centerY + sinA * arcLocalX + cosA * arcLocalY;
+    // The outline covers the first and last rows, scan horizontally in between and fill between intersections
+    int16_t intersectPoints[count];
+    for (int16_t scanY = MAX(minY + 1, 0); scanY < MIN(maxY, MAX_SCREEN_HEIGHT); scanY++) {
+        uint16_t intersections = 0;
 
-            if(i>0){
-                drawLine((uint16_t)round(rotatedX), (uint16_t)round(rotatedY), (uint16_t)round(prevX), (uint16_t)round(prevY), color, filled);
+        for (uint16_t i = 0; i < count; i++) {
+            uint16_t next = (i + 1) % count;
+            if ((yVertices[i] < scanY && yVertices[next] >= scanY) || (yVertices[next] < scanY && yVertices[i] >= scanY)) {
+                intersectPoints[intersections++] = xVertices[i] + (scanY - yVertices[i]) * (xVertices[next] - xVertices[i]) / (yVertices[next] - yVertices[i]);
+            }
+        }
 
-                if (filled) {
-                    double capCenterX = centerX + cosA * cx - sinA * cy;
-                    double capCenterY = centerY + sinA * cx + cosA * cy;
-                    drawLine((uint16_t)round(rotatedX), (uint16_t)round(rotatedY), (uint16_t)round(capCenterX), (uint16_t)round(capCenterY), color, 1);
-                }
+        // Sort the intersection points by x coordinate
+        for (uint16_t i = 1; i < intersections; i++) {
+            int16_t point = intersectPoints[i];
+            uint16_t j = i;
+            for (; j > 0 && intersectPoints[j - 1] > point; j--) {
+                intersectPoints[j] = intersectPoints[j - 1];
             }
-            prevX = rotatedX;
-            prevY = rotatedY;
+            intersectPoints[j] = point;
+        }
+
+        // Draw lines between pairs of intersection points
+        for (uint16_t i = 0; i + 1 < intersections; i += 2) {
+            drawHorizontalLine(intersectPoints[i], intersectPoints[i + 1], scanY, color);
         }
     }
 }
@@ -545,51 +613,79 @@ void GPGFX_TinySSD1306::drawBuffer(uint8_t* pBuffer) {
 }
 
 void GPGFX_TinySSD1306::drawBuffer(uint8_t* pBuffer, uint8_t pages) {
-        uint16_t bufferSize = MAX_SCREEN_SIZE;
-        uint8_t buffer[bufferSize+1] = {SET_START_LINE};
+    uint8_t buffer[MAX_SCREEN_WIDTH+3] = {SET_START_LINE};
+    uint8_t* source = (pBuffer == NULL) ? frameBuffer : pBuffer;
+
+    uint8_t maxPages = (MAX_SCREEN_HEIGHT / 8);
+    if (pages == 0 || pages > maxPages) {
+        pages = maxPages;
+    }
 
-        uint8_t maxPages = (MAX_SCREEN_HEIGHT / 8);
-        if (pages == 0 || pages > maxPages) {
-            pages = maxPages;
+    // Walk every page once from where the last partial render stopped, but only spend
+    // the page budget on pages that differ from what the panel is already showing
+    uint8_t sent = 0;
+    uint8_t checked = 0;
+    while (checked < maxPages && sent < pages) {
+        uint8_t page = (framePage + checked) % maxPages;
+        checked++;
+
+        uint8_t* pageData = &source[page * MAX_SCREEN_WIDTH];
+        uint8_t* panelData = &panelBuffer[page * MAX_SCREEN_WIDTH];
+
+        bool fullRow = !(panelPages & (1 << page));
+        uint16_t start = 0;
+        uint16_t end = MAX_SCREEN_WIDTH - 1;
+        if (!fullRow) {
+            while (start < MAX_SCREEN_WIDTH && pageData[start] == panelData[start]) {
+                start++;
+            }
+            if (start == MAX_SCREEN_WIDTH) {
+                continue;
+            }
+            while (pageData[end] == panelData[end]) {
+                end--;
+            }
         }
+        uint16_t length = end - start + 1;
 
         if (this->screenType == ScreenAlternatives::SCREEN_132x64) {
-        uint16_t x = 0;
-        for (uint8_t i = 0; i < pages; i++) {
-            uint8_t y = (framePage + i) % maxPages;
-            sendCommand(0xB0 + y);
-            sendCommand(x & 0x0F);
-            sendCommand(0x10 | (x >> 4));
-
-            if (pBuffer == NULL) {
-                memcpy(&buffer[1],&frameBuffer[y*MAX_SCREEN_WIDTH],MAX_SCREEN_WIDTH);
-            } else {
-                memcpy(&buffer[1],&pBuffer[y*MAX_SCREEN_WIDTH],MAX_SCREEN_WIDTH);
+            uint8_t commands[] = {
+                0x00,
+                (uint8_t)(0xB0 + page),
+                (uint8_t)(CommandOps::SET_LOW_COLUMN | (start & 0x0F)),
+                (uint8_t)(CommandOps::SET_HIGH_COLUMN | (start >> 4))
+            };
+            sendCommands(commands, sizeof(commands));
+
+            // a full row also blanks the two extra SH1106 columns
+            if (fullRow) {
+                length += 2;
             }
-
-            _options.i2c->write(_options.address, buffer, MAX_SCREEN_WIDTH+3, false);
+        } else {
+            uint8_t commands[] = {
+                0x00,
+                CommandOps::PAGE_ADDRESS,
+                page,
+                page,
+                CommandOps::COLUMN_ADDRESS,
+                (uint8_t)start,
+                (uint8_t)end
+            };
+            sendCommands(commands, sizeof(commands));
         }
-    } else {
-        for (uint8_t i = 0; i < pages; i++) {
-            uint8_t page = (framePage + i) % maxPages;
-
-            sendCommand(CommandOps::PAGE_ADDRESS);
-            sendCommand(page);
-            sendCommand(page);
-            sendCommand(CommandOps::COLUMN_ADDRESS);
-            sendCommand(0x00);
-            sendCommand(0x7F);
-
-            if (pBuffer == NULL) {
-                memcpy(&buffer[1], &frameBuffer[page * MAX_SCREEN_WIDTH], MAX_SCREEN_WIDTH);
-            } else {
-                memcpy(&buffer[1], &pBuffer[page * MAX_SCREEN_WIDTH], MAX_SCREEN_WIDTH);
-            }
-            _options.i2c->write(_options.address, buffer, MAX_SCREEN_WIDTH + 1, false);
+
+        memcpy(&buffer[1], &pageData[start], end - start + 1);
+        if (_options.i2c->write(_options.address, buffer, length + 1, false) >= 0) {
+            memcpy(&panelData[start], &pageData[start], end - start + 1);
+            panelPages |= (1 << page);
+        } else {
+            // the panel may hold any part of the write, resend the whole page next render
+            panelPages &= ~(1 << page);
         }
+        sent++;
     }
 
-        framePage = (framePage + pages) % maxPages;
+    framePage = (framePage + checked) % maxPages;
 }
 
 void GPGFX_TinySSD1306::rotatePoint(double cx, double cy, double &x, double &y, double angle) {
@@ -0,0 +1,141 @@
+/*
+ * SPDX-License-Identifier: MIT
+ * SPDX-FileCopyrightText: Copyright (c) 2024 OpenStickCommunity (gp2040-ce.info)
+ */
+
+#include "loopstats.h"
+
+#include "pico/platform.h"
+#include "hardware/structs/xip_ctrl.h"
+
+static inline uint32_t bucketForDuration(uint32_t duration) {
+	if (duration < LOOP_STATS_LINEAR_BUCKETS)
+		return duration;
+	uint32_t msb = 31 - __builtin_clz(duration);
+	uint32_t bucket = LOOP_STATS_LINEAR_BUCKETS + ((msb - 3) << 2) + ((duration >> (msb - 2)) & 3);
+	return (bucket < LOOP_STATS_BUCKETS) ? bucket : (LOOP_STATS_BUCKETS - 1);
+}
+
+static inline uint32_t bucketUpperBound(uint32_t bucket) {
+	if (bucket < LOOP_STATS_LINEAR_BUCKETS)
+		return bucket;
+	uint32_t msb = 3 + ((bucket - LOOP_STATS_LINEAR_BUCKETS) >> 2);
+	uint32_t sub = (bucket - LOOP_STATS_LINEAR_BUCKETS) & 3;
+	return ((5 + sub) << (msb - 2)) - 1;
+}
+
+void LoopStageStats::reset() {
+	count = 0;
+	min = UINT32_MAX;
+	max = 0;
+	total = 0;
+	for (uint32_t i = 0; i < LOOP_STATS_BUCKETS; i++)
+		histogram[i] = 0;
+}
+
+void LoopStageStats::record(uint32_t duration) {
+	count++;
+	total += duration;
+	if (duration < min) min = duration;
+	if (duration > max) max = duration;
+	histogram[bucketForDuration(duration)]++;
+}
+
+uint32_t LoopStageStats::percentile(uint32_t pct) const {
+	if (count == 0)
+		return 0;
+
+	uint64_t target = ((uint64_t)count * pct + 99) / 100;
+	uint64_t seen = 0;
+	for (uint32_t i = 0; i < LOOP_STATS_BUCKETS; i++) {
+		seen += histogram[i];
+		if (seen >= target) {
+			// the top bucket is open ended, and no bucket can exceed the observed max
+			uint32_t bound = (i == LOOP_STATS_BUCKETS - 1) ? max : bucketUpperBound(i);
+			return (bound < max) ? bound : max;
+		}
+	}
+	return max;
+}
+
+LoopAddonStats * LoopStats::registerAddon(const std::string & name) {
+	if (!enabled())
+		return nullptr;
+
+	LoopAddonStats * addon = new LoopAddonStats();
+	addon->name = name;
+	addon->core = get_core_num();
+	addons.push_back(addon);
+	return addon;
+}
+
+void LoopStats::reset() {
+	for (uint32_t i = 0; i < LOOP_STAGE_COUNT; i++)
+		stages[i].reset();
+	for (LoopAddonStats * addon : addons) {
+		for (uint32_t i = 0; i < LOOP_ADDON_COUNT; i++)
+			addon->stages[i].reset();
+	}
+	historyIndex = 0;
+	xipMisses.reset();
+	xipHits = 0;
+	xipAccesses = 0;
+	xip_ctrl_hw->ctr_acc = 0;
+	xip_ctrl_hw->ctr_hit = 0;
+}
+
+void LoopStats::recordXipCache() {
+	// The counters clear on any write and keep counting in between. Reading hits before accesses and
+	// clearing accesses before hits means any access landing in between adds to accesses rather than
+	// hits, so the clamp below only guards the invariant.
+	uint32_t hits = xip_ctrl_hw->ctr_hit;
+	uint32_t accesses = xip_ctrl_hw->ctr_acc;
+	xip_ctrl_hw->ctr_acc = 0;
+	xip_ctrl_hw->ctr_hit = 0;
+	if (hits > accesses)
+		hits = accesses;
+
+	xipHits += hits;
+	xipAccesses += accesses;
+	xipMisses.record(accesses - hits);
+}
+
+uint32_t LoopStats::getXipHitPermille() const {
+	return xipAccesses ? (uint32_t)((xipHits * 1000) / xipAccesses) : 0;
+}
+
+uint32_t LoopStats::getHistory(uint32_t * out, uint32_t size) const {
+	uint32_t available = stages[LOOP_STAGE_TOTAL].getCount();
+	if (available > LOOP_STATS_HISTORY) available = LOOP_STATS_HISTORY;
+	if (size > available) size = available;
+
+	// oldest entry sits at historyIndex once the ring has wrapped
+	uint32_t start = (historyIndex + LOOP_STATS_HISTORY - available) % LOOP_STATS_HISTORY;
+	start = (start + (available - size)) % LOOP_STATS_HISTORY;
+	for (uint32_t i = 0; i < size; i++)
+		out[i] = history[(start + i) % LOOP_STATS_HISTORY];
+	return size;
+}
+
+const char * LoopStats::getStageName(LoopStage stage) {
+	switch (stage) {
+		case LOOP_STAGE_TOTAL:       return "loop";
+		case LOOP_STAGE_INPUT:       return "input";
+		case LOOP_STAGE_PREPROCESS:  return "preprocess";
+		case LOOP_STAGE_PROCESS:     return "process";
+		case LOOP_STAGE_DRIVER:      return "driver";
+		case LOOP_STAGE_USB:         return "usb";
+		case LOOP_STAGE_POSTPROCESS: return "postprocess";
+		case LOOP_STAGE_CORE1:       return "core1";
+		default:                     return "";
+	}
+}
+
+const char * LoopStats::getAddonStageName(LoopAddonStage stage) {
+	switch (stage) {
+		case LOOP_ADDON_PREPROCESS:  return "preprocess";
+		case LOOP_ADDON_PROCESS:     return "process";
+		case LOOP_ADDON_POSTPROCESS: return "postprocess";
+		default:                     return "";
+	}
+}
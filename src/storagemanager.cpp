@@ -39,6 +39,25 @@ bool Storage::save()
  * @brief Save the config; if forcing a save is requested, or if USB host is not enabled, this will write to flash.
  */
 bool Storage::save(const bool force) {
+	if (!canSave(force)) {
+		return false;
+	}
+
+	return ConfigUtils::save(config);
+}
+
+/**
+ * @brief Save only the options hotkeys change, as a small overlay on the last full save. Same conditions as save().
+ */
+bool Storage::saveHotOptions(const bool force) {
+	if (!canSave(force)) {
+		return false;
+	}
+
+	return ConfigUtils::saveHotOptions(config);
+}
+
+bool Storage::canSave(const bool force) {
 	// Conditions for saving:
 	//   1. Force = True
 	//   2. Input Mode NOT (PS4/PS5 with USB enabled)
@@ -51,12 +70,13 @@ bool Storage::save(const bool force) {
 		return false;
 	}
 
-	return ConfigUtils::save(config);
+	return true;
 }
 
 void Storage::ResetSettings()
 {
 	EEPROM.reset();
+	EEPROM.flush();
 	watchdog_reboot(0, SRAM_END, 2000);
 }
 
@@ -153,3 +173,25 @@ Gamepad * Storage::GetProcessedGamepad()
 {
 	return processedGamepad;
 }
+
+/**
+ * @brief Publish the processed input state and the aux state written by the input driver (rumble, player LEDs).
+ *
+ * Core0 only. Called once per loop after the USB driver has run.
+ */
+void Storage::PublishProcessedGamepad(const GamepadState & state)
+{
+	processedStateSnapshot.publish(state);
+	processedAuxStateSnapshot.publish(processedGamepad->auxState);
+}
+
+/**
+ * @brief Pull the latest snapshot published by Core0 into Core1's view of the processed gamepad.
+ *
+ * Core1 only. Called once at the top of every Core1 loop.
+ */
+void Storage::SyncProcessedGamepad()
+{
+	processedStateSnapshot.read(processedGamepad->state);
+	processedAuxStateSnapshot.read(processedAuxState);
+}
@@ -1,6 +1,7 @@
 #include "system.h"
 
 #include "usbhostmanager.h"
+#include "FlashPROM.h"
 
 #include <hardware/flash.h>
 #include <hardware/sync.h>
@@ -59,6 +60,9 @@ uint32_t System::getUsedHeap() {
 }
 
 void System::reboot(BootMode bootMode) {
+    // Write out any config change still waiting for the inputs to go idle
+    EEPROM.flush();
+
     // Halt all running USB instances
     USBHostManager::getInstance().shutdown();
 
@@ -8,6 +8,7 @@
 
 #include "tusb.h"
 #include "drivermanager.h"
+#include "usbreportscheduler.h"
 
 static bool usb_mounted;
 static bool usb_suspended;
@@ -35,6 +36,15 @@ void tud_hid_set_report_cb(uint8_t itf, uint8_t report_id, hid_report_type_t rep
 	DriverManager::getInstance().getDriver()->set_report(report_id, report_type, buffer, bufsize);
 }
 
+// Invoked from the USB interrupt for every event queued for tud_task()
+void tud_event_hook_cb(uint8_t rhport, uint32_t eventid, bool in_isr) {
+	(void)rhport;
+	(void)in_isr;
+	if (eventid == DCD_EVENT_XFER_COMPLETE) {
+		USBReportScheduler::getInstance().transferComplete();
+	}
+}
+
 // Invoked when device is mounted
 void tud_mount_cb(void)
 {
@@ -0,0 +1,211 @@
+/*
+ * SPDX-License-Identifier: MIT
+ * SPDX-FileCopyrightText: Copyright (c) 2024 OpenStickCommunity (gp2040-ce.info)
+ */
+
+#include "usbreportscheduler.h"
+#include "hotpath.h"
+
+#include "tusb.h"
+#include "device/usbd_pvt.h"
+
+#include "pico/stdlib.h"
+#include "hardware/structs/usb.h"
+
+// Completions per window used to re-learn the polling interval
+#define INTERVAL_WINDOW 32
+
+static uint32_t gcd(uint32_t a, uint32_t b) {
+	while (b != 0) {
+		uint32_t t = a % b;
+		a = b;
+		b = t;
+	}
+	return a;
+}
+
+USBReportScheduler::USBReportScheduler() :
+	enabled(false),
+	rhport(0),
+	reportEndpoint(0),
+	sofCount(0),
+	sofTime(0),
+	transferPending(false),
+	transferDone(false),
+	completeFrame(0),
+	completePhase(0),
+	samples(0),
+	pollInterval(1),
+	pollPhase(0),
+	lastPollFrame(0),
+	intervalWindow(0),
+	intervalSamples(0),
+	targetFrame(0),
+	servedFrame(0),
+	queuedTarget(0),
+	guard(USB_SCHEDULER_GUARD_START_US),
+	hits(0),
+	misses(0)
+{
+}
+
+void USBReportScheduler::start(uint8_t rhport, const uint8_t * configuration) {
+	// reports go out on the first interrupt IN endpoint of the driver's configuration
+	if (configuration == nullptr)
+		return;
+	const uint8_t * desc = configuration;
+	const uint8_t * end = configuration + tu_le16toh(((const tusb_desc_configuration_t *)configuration)->wTotalLength);
+	while (desc < end && reportEndpoint == 0) {
+		if (tu_desc_type(desc) == TUSB_DESC_ENDPOINT) {
+			const tusb_desc_endpoint_t * endpoint = (const tusb_desc_endpoint_t *)desc;
+			if (endpoint->bmAttributes.xfer == TUSB_XFER_INTERRUPT && tu_edpt_dir(endpoint->bEndpointAddress) == TUSB_DIR_IN)
+				reportEndpoint = tu_edpt_number(endpoint->bEndpointAddress);
+		}
+		desc = tu_desc_next(desc);
+	}
+	if (reportEndpoint == 0)
+		return;
+
+	this->rhport = rhport;
+	enabled = true;
+	usbd_sof_enable(rhport, SOF_CONSUMER_USER, true);
+}
+
+void HOT_PATH_FUNC(USBReportScheduler::sofCallback)(uint8_t rhport, uint32_t frame_count) {
+	(void)rhport;
+	(void)frame_count; // 11-bit, we keep our own running count instead
+	USBReportScheduler & scheduler = getInstance();
+	scheduler.sofTime = time_us_32();
+	scheduler.sofCount = scheduler.sofCount + 1;
+}
+
+void HOT_PATH_FUNC(USBReportScheduler::transferComplete)() {
+	if (!transferPending)
+		return;
+	// the event hook sees every endpoint's completion, EP0 and OUT included. The controller
+	// clears AVAILABLE once the host has taken the report buffer, so count only that one.
+	if (usb_dpram->ep_buf_ctrl[reportEndpoint].in & USB_BUF_CTRL_AVAIL)
+		return;
+	transferPending = false;
+	completePhase = time_us_32() - sofTime;
+	completeFrame = sofCount;
+	transferDone = true;
+}
+
+void HOT_PATH_FUNC(USBReportScheduler::reportQueued)() {
+	if (!enabled)
+		return;
+	// fold in a completion that landed since the last window before it gets superseded
+	updateModel();
+	queuedTarget = targetFrame;
+	transferPending = true;
+}
+
+bool HOT_PATH_FUNC(USBReportScheduler::isReportPending)() {
+	// a suspended or detached host will never complete it
+	return enabled && transferPending && tud_ready() && !tud_suspended();
+}
+
+void HOT_PATH_FUNC(USBReportScheduler::readFrame)(uint32_t & frame, uint32_t & time) {
+	// the SOF interrupt writes the time before the count, so re-read until the count is stable
+	do {
+		frame = sofCount;
+		time = sofTime;
+	} while (frame != sofCount);
+}
+
+bool HOT_PATH_FUNC(USBReportScheduler::isSynced)() {
+	if (!enabled || !tud_ready() || tud_suspended())
+		return false;
+
+	// a bus reset clears the SOF consumers, turn the interrupt back on if SOFs went quiet
+	if ((time_us_32() - sofTime) > (2 * USB_FRAME_US)) {
+		usbd_sof_enable(rhport, SOF_CONSUMER_USER, true);
+		return false;
+	}
+
+	return samples >= USB_SCHEDULER_MIN_SAMPLES;
+}
+
+void HOT_PATH_FUNC(USBReportScheduler::updateModel)() {
+	if (!transferDone)
+		return;
+	transferDone = false;
+
+	uint32_t frame = completeFrame;
+	uint32_t phase = completePhase;
+	if (phase >= USB_FRAME_US)
+		phase = USB_FRAME_US - 1;
+
+	if (samples > 0) {
+		// IN tokens land on multiples of the interval, so the gcd of completion spacings recovers it
+		uint32_t spacing = frame - lastPollFrame;
+		if (spacing > 0 && spacing < 256)
+			intervalWindow = gcd(intervalWindow, spacing);
+		if (++intervalSamples >= INTERVAL_WINDOW || samples < USB_SCHEDULER_MIN_SAMPLES) {
+			if (intervalWindow != 0)
+				pollInterval = intervalWindow;
+			if (intervalSamples >= INTERVAL_WINDOW) {
+				intervalWindow = 0;
+				intervalSamples = 0;
+			}
+		}
+		pollPhase += ((int32_t)(phase - pollPhase)) / 8;
+	} else {
+		pollPhase = phase;
+	}
+
+	if (queuedTarget != 0) {
+		if ((int32_t)(frame - queuedTarget) > 0) {
+			// the report went out a poll late, start sampling earlier
+			misses++;
+			guard += USB_SCHEDULER_GUARD_MISS_STEP_US;
+			if (guard > USB_SCHEDULER_GUARD_MAX_US)
+				guard = USB_SCHEDULER_GUARD_MAX_US;
+			hits = 0;
+		} else if (++hits >= USB_SCHEDULER_GUARD_DECAY_HITS && guard > USB_SCHEDULER_GUARD_MIN_US) {
+			// reports are making it, creep back towards the IN token
+			guard--;
+			hits = 0;
+		}
+	}
+
+	lastPollFrame = frame;
+	samples++;
+}
+
+bool HOT_PATH_FUNC(USBReportScheduler::waitForSendWindow)() {
+	if (!enabled)
+		return true;
+
+	updateModel();
+	targetFrame = 0;
+	if (!isSynced())
+		return true;
+
+	uint32_t frame;
+	uint32_t frameTime;
+	readFrame(frame, frameTime);
+	uint32_t now = time_us_32();
+
+	// first IN token on the host's schedule that hasn't gone by or already been served
+	uint32_t next = lastPollFrame + pollInterval * ((frame - lastPollFrame) / pollInterval);
+	uint32_t target;
+	while (true) {
+		target = frameTime + (int32_t)(next - frame) * USB_FRAME_US + pollPhase - guard;
+		if ((int32_t)(target + guard - now) > 0 && next != servedFrame)
+			break;
+		next += pollInterval;
+	}
+
+	// too early to sample: let the rest of the loop run and check again on the next pass
+	if ((int32_t)(target - now) > USB_SCHEDULER_MAX_SPIN_US)
+		return false;
+
+	while ((int32_t)(target - time_us_32()) > 0) {
+		tight_loop_contents();
+	}
+	targetFrame = next;
+	servedFrame = next;
+	return true;
+}
@@ -8,6 +8,8 @@
 #include "peripheralmanager.h"
 #include "animationstorage.h"
 #include "system.h"
+#include "loopstats.h"
+#include "hotpath.h"
 #include "config_utils.h"
 #include "types.h"
 #include "version.h"
@@ -19,6 +21,7 @@
 #include <memory>
 #include <set>
 
+#include <pico/time.h>
 #include <pico/types.h>
 
 // for hall-effect calibration
@@ -670,6 +673,9 @@ std::string setGamepadOptions()
     readDoc(gamepadOptions.fourWayMode, doc, "fourWayMode");
     readDoc(gamepadOptions.profileNumber, doc, "profileNumber");
     readDoc(gamepadOptions.debounceDelay, doc, "debounceDelay");
+    readDoc(gamepadOptions.debounceReleaseDelay, doc, "debounceReleaseDelay");
+    readDoc(gamepadOptions.debounceMode, doc, "debounceMode");
+    readDoc(gamepadOptions.usbSofSync, doc, "usbSofSync");
     readDoc(gamepadOptions.inputModeB1, doc, "inputModeB1");
     readDoc(gamepadOptions.inputModeB2, doc, "inputModeB2");
     readDoc(gamepadOptions.inputModeB3, doc, "inputModeB3");
@@ -740,6 +746,9 @@ std::string getGamepadOptions()
     writeDoc(doc, "fourWayMode", gamepadOptions.fourWayMode ? 1 : 0);
     writeDoc(doc, "profileNumber", gamepadOptions.profileNumber);
     writeDoc(doc, "debounceDelay", gamepadOptions.debounceDelay);
+    writeDoc(doc, "debounceReleaseDelay", gamepadOptions.debounceReleaseDelay);
+    writeDoc(doc, "debounceMode", gamepadOptions.debounceMode);
+    writeDoc(doc, "usbSofSync", gamepadOptions.usbSofSync ? 1 : 0);
     writeDoc(doc, "inputModeB1", gamepadOptions.inputModeB1);
     writeDoc(doc, "inputModeB2", gamepadOptions.inputModeB2);
     writeDoc(doc, "inputModeB3", gamepadOptions.inputModeB3);
@@ -1941,6 +1950,7 @@ std::string setAddonOptions()
     docToPin(heTriggerOptions.muxADCPin3, doc, "muxADCPin3");
     docToValue(heTriggerOptions.emaSmoothing, doc, "heTriggerSmoothing");
     docToValue(heTriggerOptions.smoothingFactor, doc, "heTriggerSmoothingFactor");
+    docToValue(heTriggerOptions.muxChannelsPerLoop, doc, "muxChannelsPerLoop");
 
     EventManager::getInstance().triggerEvent(new GPStorageSaveEvent(true));
 
@@ -2395,6 +2405,7 @@ std::string getAddonOptions()
     writeDoc(doc, "muxADCPin3", cleanPin(heTriggerOptions.muxADCPin3));
     writeDoc(doc, "heTriggerSmoothing", heTriggerOptions.emaSmoothing);
     writeDoc(doc, "heTriggerSmoothingFactor", heTriggerOptions.smoothingFactor);
+    writeDoc(doc, "muxChannelsPerLoop", heTriggerOptions.muxChannelsPerLoop);
 
     return serialize_json(doc);
 }
@@ -2502,6 +2513,82 @@ std::string getMemoryReport()
     return serialize_json(doc);
 }
 
+static void writeLoopStageStats(JsonObject stage, const LoopStageStats& stats)
+{
+    stage["count"] = stats.getCount();
+    stage["min"] = stats.getMin();
+    stage["avg"] = stats.getAverage();
+    stage["p99"] = stats.percentile(99);
+    stage["max"] = stats.getMax();
+}
+
+// The web API is only reachable in web config mode, where GP2040::runOnce stops after reading
+// the inputs, so only the loop, input and core1 stages are filled in here. Gameplay timings for
+// every stage are shown on the display's stats page instead.
+std::string getLoopStats()
+{
+    const LoopStats& loopStats = LoopStats::getInstance();
+    const std::vector<LoopAddonStats*>& addons = loopStats.getAddons();
+    const size_t stageSize = JSON_OBJECT_SIZE(5);
+    const size_t addonSize = JSON_OBJECT_SIZE(2 + LOOP_ADDON_COUNT) + LOOP_ADDON_COUNT * stageSize + 32;
+    DynamicJsonDocument doc(JSON_OBJECT_SIZE(8)
+        + JSON_OBJECT_SIZE(LOOP_STAGE_COUNT) + LOOP_STAGE_COUNT * stageSize
+        + JSON_OBJECT_SIZE(2) + stageSize
+        + JSON_ARRAY_SIZE(addons.size()) + addons.size() * addonSize
+        + JSON_ARRAY_SIZE(LOOP_STATS_HISTORY));
+
+    writeDoc(doc, "enabled", LoopStats::enabled());
+    writeDoc(doc, "hotPathInRam", HOT_PATH_IN_RAM != 0);
+    writeDoc(doc, "configModeOnly", true);
+
+    // Spread of the loop time, p99 over the best case
+    const LoopStageStats& loop = loopStats.getStage(LOOP_STAGE_TOTAL);
+    writeDoc(doc, "jitter", loop.percentile(99) - loop.getMin());
+
+    JsonObject xipCache = doc.createNestedObject("xipCache");
+    xipCache["hitPermille"] = loopStats.getXipHitPermille();
+    writeLoopStageStats(xipCache.createNestedObject("missesPerLoop"), loopStats.getXipMisses());
+
+    JsonObject stages = doc.createNestedObject("stages");
+    for (uint32_t i = 0; i < LOOP_STAGE_COUNT; i++) {
+        writeLoopStageStats(stages.createNestedObject(LoopStats::getStageName((LoopStage)i)), loopStats.getStage((LoopStage)i));
+    }
+
+    JsonArray addonList = doc.createNestedArray("addons");
+    for (const LoopAddonStats* addon : addons) {
+        JsonObject entry = addonList.createNestedObject();
+        entry["name"] = addon->name;
+        entry["core"] = addon->core;
+        for (uint32_t i = 0; i < LOOP_ADDON_COUNT; i++) {
+            writeLoopStageStats(entry.createNestedObject(LoopStats::getAddonStageName((LoopAddonStage)i)), addon->stages[i]);
+        }
+    }
+
+    static uint32_t history[LOOP_STATS_HISTORY];
+    uint32_t historySize = loopStats.getHistory(history, LOOP_STATS_HISTORY);
+    JsonArray recent = doc.createNestedArray("recent");
+    for (uint32_t i = 0; i < historySize; i++) {
+        recent.add(history[i]);
+    }
+
+    return serialize_json(doc);
+}
+
+std::string getFlashCommitStats()
+{
+    const FlashCommitStats stats = EEPROM.getStats();
+    const uint32_t now = to_ms_since_boot(get_absolute_time());
+    DynamicJsonDocument doc(JSON_OBJECT_SIZE(8));
+    writeDoc(doc, "pending", stats.pending);
+    writeDoc(doc, "pendingMs", stats.pending ? now - stats.pendingSince : 0);
+    writeDoc(doc, "idleWaitMs", EEPROM_IDLE_WAIT);
+    writeDoc(doc, "lastCommitAgoMs", stats.commitCount ? now - stats.lastCommit : 0);
+    writeDoc(doc, "lastCommitDurationUs", stats.lastDuration);
+    writeDoc(doc, "lastCommitDeferralMs", stats.lastDeferral);
+    writeDoc(doc, "commitCount", stats.commitCount);
+    return serialize_json(doc);
+}
+
 static bool _abortGetHeldPins = false;
 
 std::string getHeldPins()
@@ -2682,6 +2769,8 @@ static const std::pair<const char*, HandlerFuncPtr> handlerFuncs[] =
     { "/api/getSplashImage", getSplashImage },
     { "/api/getFirmwareVersion", getFirmwareVersion },
     { "/api/getMemoryReport", getMemoryReport },
+    { "/api/getLoopStats", getLoopStats },
+    { "/api/getFlashCommitStats", getFlashCommitStats },
     { "/api/getHeldPins", getHeldPins },
     { "/api/abortGetHeldPins", abortGetHeldPins },
     { "/api/getUsedPins", getUsedPins },
@@ -116,6 +116,9 @@ app.get('/api/getGamepadOptions', (req, res) => {
 		fnButtonPin: -1,
 		profileNumber: 2,
 		debounceDelay: 5,
+		debounceReleaseDelay: 5,
+		debounceMode: 0,
+		usbSofSync: 0,
 		inputModeB1: 1,
 		inputModeB2: 0,
 		inputModeB3: 2,
@@ -564,6 +567,7 @@ app.get('/api/getAddonsOptions', (req, res) => {
 		muxSelectPin3: -1,
 		heTriggerSmoothing: 0,
 		heTriggerSmoothingFactor: 5,
+		muxChannelsPerLoop: 0,
 		RotaryAddonEnabled: 1,
 		PCF8575AddonEnabled: 1,
 		DRV8833RumbleAddonEnabled: 1,
@@ -864,6 +868,35 @@ app.get('/api/getMemoryReport', (req, res) => {
 	});
 });
 
+app.get('/api/getLoopStats', (req, res) => {
+	const stage = (avg) => ({
+		count: 1000,
+		min: Math.floor(avg * 0.8),
+		avg,
+		p99: Math.floor(avg * 1.5),
+		max: avg * 2,
+	});
+	const unused = { count: 0, min: 0, avg: 0, p99: 0, max: 0 };
+	// web config mode skips everything after the input read
+	return res.send({
+		enabled: true,
+		configModeOnly: true,
+		stages: {
+			loop: stage(420),
+			input: stage(12),
+			preprocess: unused,
+			process: unused,
+			driver: unused,
+			usb: unused,
+			postprocess: unused,
+			core1: stage(900),
+		},
+		// no add-ons are registered in web config mode
+		addons: [],
+		recent: Array.from({ length: 64 }, () => 400 + Math.floor(Math.random() * 60)),
+	});
+});
+
 app.get('/api/getHeldPins', async (req, res) => {
 	await new Promise((resolve) => setTimeout(resolve, 2000));
 	return res.send({
@@ -93,6 +93,10 @@ export const HETriggerScheme = {
 		.number()
 		.label('EMA Smoothing Factor')
 		.validateRangeWhenValue('HETriggerEnabled', 1, 99),
+	muxChannelsPerLoop: yup
+		.number()
+		.label('Channels Scanned Per Loop')
+		.validateRangeWhenValue('HETriggerEnabled', 0, 16),
 };
 
 export const HETriggerState = {
@@ -108,6 +112,7 @@ export const HETriggerState = {
 	muxSelectPin3: -1,
 	heTriggerSmoothing: 0,
 	heTriggerSmoothingFactor: 5,
+	muxChannelsPerLoop: 0,
 };
 
 const options = Object.entries(BUTTON_ACTIONS)
@@ -379,6 +384,20 @@ const HETrigger = ({ values, errors, handleChange, handleCheckbox }: AddonPropTy
 							</option>
 						))}
 					</FormSelect>
+					<FormControl
+						hidden={values.muxChannels < 4}
+						type="number"
+						label={t('HETrigger:channels-per-loop-label')}
+						name="muxChannelsPerLoop"
+						className="form-control-sm"
+						groupClassName="col-sm-3 mb-3"
+						value={values.muxChannelsPerLoop}
+						error={errors.muxChannelsPerLoop}
+						isInvalid={Boolean(errors.muxChannelsPerLoop)}
+						onChange={handleChange}
+						min={0}
+						max={values.muxChannels}
+					/>
 				</Row>
 				<Row className="mb-3">
 					<FormControl
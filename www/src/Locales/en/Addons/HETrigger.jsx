@@ -7,6 +7,7 @@ export default {
 	'4-channels': '４-Channels',
 	'8-channels': '8-Channels',
 	'16-channels': '16-Channels',
+	'channels-per-loop-label': 'Channels Scanned Per Loop (0 = All)',
 	'select-pin-0': 'Select Pin 0',
 	'select-pin-1': 'Select Pin 1',
 	'select-pin-2': 'Select Pin 2',
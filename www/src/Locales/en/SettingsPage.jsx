@@ -59,6 +59,15 @@ export default {
 	},
 	'profile-label': 'Profile',
 	'debounce-delay-label': 'Debounce Delay in milliseconds',
+	'debounce-release-delay-label': 'Release Debounce Delay in milliseconds',
+	'debounce-mode-label': 'Debounce Mode',
+	'usb-sof-sync-label':
+		'Sync input sampling to USB host polling (lower latency, the report is built just before each poll)',
+	'debounce-mode-options': {
+		eager: 'Eager',
+		defer: 'Deferred',
+		integrator: 'Integrator',
+	},
 	'mini-menu-gamepad-input': 'Use Gamepad Input for Display Mini Menu',
 	'ps4-mode-explanation-text':
 		'PS4 mode allows GP2040-CE to run as an authenticated PS4 controller.',
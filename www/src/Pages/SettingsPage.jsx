@@ -275,6 +275,12 @@ const SOCD_MODES = [
 	{ labelKey: 'socd-cleaning-mode-options.off', value: 4 },
 ];
 
+const DEBOUNCE_MODES = [
+	{ labelKey: 'debounce-mode-options.eager', value: 0 },
+	{ labelKey: 'debounce-mode-options.defer', value: 1 },
+	{ labelKey: 'debounce-mode-options.integrator', value: 2 },
+];
+
 const PS4_MODES = [
 	{ labelKey: 'ps4-mode-options.controller', value: 0 },
 	{ labelKey: 'ps4-mode-options.arcadestick', value: 7 },
@@ -469,6 +475,16 @@ const schema = yup.object().shape({
 		.oneOf(AUTHENTICATION_TYPES.map((o) => o.value))
 		.label('X-Input Authentication Type'),
 	debounceDelay: yup.number().required().label('Debounce Delay'),
+	debounceReleaseDelay: yup
+		.number()
+		.required()
+		.label('Debounce Release Delay'),
+	debounceMode: yup
+		.number()
+		.required()
+		.oneOf(DEBOUNCE_MODES.map((o) => o.value))
+		.label('Debounce Mode'),
+	usbSofSync: yup.number().label('Sync Reports to USB Polling'),
 	miniMenuGamepadInput: yup.number().required().label('Mini Menu'),
 	inputModeB1: yup
 		.number()
@@ -538,6 +554,8 @@ const FormContext = ({ setButtonLabels, setKeyMappings }) => {
 		if (!!values.dpadMode) values.dpadMode = parseInt(values.dpadMode);
 		if (!!values.inputMode) values.inputMode = parseInt(values.inputMode);
 		if (!!values.socdMode) values.socdMode = parseInt(values.socdMode);
+		if (!!values.debounceMode)
+			values.debounceMode = parseInt(values.debounceMode);
 		if (!!values.switchTpShareForDs4)
 			values.switchTpShareForDs4 = parseInt(values.switchTpShareForDs4);
 		if (!!values.forcedSetupMode)
@@ -1485,6 +1503,7 @@ export default function SettingsPage() {
 	const translatedInputModeGroups = translateArray(INPUT_MODE_GROUPS);
 	const translatedDpadModes = translateArray(DPAD_MODES);
 	const translatedSocdModes = translateArray(SOCD_MODES);
+	const translatedDebounceModes = translateArray(DEBOUNCE_MODES);
 	const translatedHotkeyActions = translateArray(HOTKEY_ACTIONS);
 	const translatedForcedSetupModes = translateArray(FORCED_SETUP_MODES);
 	// Not currently used but we might add the option at a later date (wheel type, etc.)
@@ -1743,6 +1762,67 @@ export default function SettingsPage() {
 															/>
 														</Col>
 													</Form.Group>
+													<Form.Group className="row mb-3">
+														<Form.Label>
+															{t('SettingsPage:debounce-release-delay-label')}
+														</Form.Label>
+														<Col sm={3}>
+															<Form.Control
+																type="number"
+																name="debounceReleaseDelay"
+																className="form-control-sm"
+																value={values.debounceReleaseDelay}
+																error={errors.debounceReleaseDelay}
+																isInvalid={errors.debounceReleaseDelay}
+																onChange={handleChange}
+																min={0}
+																max={5000}
+															/>
+														</Col>
+													</Form.Group>
+													<Form.Group className="row mb-3">
+														<Form.Label>
+															{t('SettingsPage:debounce-mode-label')}
+														</Form.Label>
+														<Col sm={3}>
+															<Form.Select
+																name="debounceMode"
+																className="form-select-sm"
+																value={values.debounceMode}
+																onChange={handleChange}
+																isInvalid={errors.debounceMode}
+															>
+																{translatedDebounceModes.map((o, i) => (
+																	<option
+																		key={`button-debounceMode-option-${i}`}
+																		value={o.value}
+																	>
+																		{o.label}
+																	</option>
+																))}
+															</Form.Select>
+															<Form.Control.Feedback type="invalid">
+																{errors.debounceMode}
+															</Form.Control.Feedback>
+														</Col>
+													</Form.Group>
+													<Form.Group className="row mb-3">
+														<Col sm={5}>
+															<Form.Check
+																label={t('SettingsPage:usb-sof-sync-label')}
+																type="switch"
+																id="usbSofSync"
+																isInvalid={false}
+																checked={Boolean(values.usbSofSync)}
+																onChange={(e) => {
+																	setFieldValue(
+																		'usbSofSync',
+																		e.target.checked ? 1 : 0,
+																	);
+																}}
+															/>
+														</Col>
+													</Form.Group>
 													<Form.Group className="row mb-5">
 														<Col sm={5}>
 															<Form.Check